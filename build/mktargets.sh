@@ -8,6 +8,7 @@ python build/mktargets.py --directory codec/processing --library processing
 python build/mktargets.py --directory codec/console/dec --binary h264dec
 python build/mktargets.py --directory codec/console/enc --binary h264enc
 python build/mktargets.py --directory codec/console/common --library console_common
+python build/mktargets.py --directory codec/console/bench --binary h264bench
 python build/mktargets.py --directory test/encoder --prefix encoder_unittest
 python build/mktargets.py --directory test/decoder --prefix decoder_unittest
 python build/mktargets.py --directory test/processing --prefix processing_unittest
@@ -141,7 +141,16 @@ typedef enum {
 
   ENCODER_OPTION_IS_LOSSLESS_LINK,            ///< advanced algorithmetic settings
 
-  ENCODER_OPTION_BITS_VARY_PERCENTAGE        ///< bit vary percentage
+  ENCODER_OPTION_BITS_VARY_PERCENTAGE,       ///< bit vary percentage
+  ENCODER_OPTION_THREAD_POOL,                ///< SThreadPoolParam* of the pool running the encoding threads; set before InitializeExt(), got for the defaults
+  ENCODER_OPTION_SIMULCAST_LAYER_THREADING,  ///< bool*, encode the spatial layers of simulcast AVC concurrently, each by an encoder of its own with single-threaded slices (iMultipleThreadIdc ignored), CONSTANT_ID or INCREASING_ID only; set before InitializeExt()
+  ENCODER_OPTION_WAVEFRONT_THREADS,          ///< int*, number of threads mode-deciding the MB rows of single slice layers in wavefront order, the MB syntax written on the calling thread, 0 (default) disables; set before InitializeExt()
+  ENCODER_OPTION_ASYNC_ENCODING,             ///< SEncAsyncParam* to encode the frames submitted by EncodeFrame() on a thread of the encoder; set before InitializeExt()
+  ENCODER_OPTION_RC_LOOKAHEAD,               ///< int*, number of frames analyzed ahead of the frame coded to distribute the bits by their costs, up to 16, 0 (default) disables; the bitstreams are output as many frames later, flushed by EncodeFrame() with NULL; set before InitializeExt()
+  ENCODER_OPTION_TWO_PASS,                   ///< SEncTwoPassParam* to record the statistics of a first pass or to distribute the bits of the whole clip by them in a second pass, RC_QUALITY_MODE or RC_BITRATE_MODE only; set before InitializeExt()
+  ENCODER_OPTION_HIERARCHICAL_ME,            ///< bool*, seed and confine the motion search of P frames with motion vectors found on the pictures downsampled by 4, to follow fast motion at a lower search cost; set before InitializeExt()
+  ENCODER_OPTION_MEMORY_ARENA,               ///< SMemoryArenaParam* to carve the buffers of the encoder from a few large regions; set before InitializeExt()
+  ENCODER_OPTION_MEMORY_USAGE                ///< SMemoryUsage* of the memory allocated by the encoder per tag, only is used in GetOption
 } ENCODER_OPTION;
 
 /**
@@ -165,6 +174,14 @@ typedef enum {
   DECODER_OPTION_PROFILE,               ///< get current AU profile info, only is used in GetOption
   DECODER_OPTION_LEVEL,                 ///< get current AU level info,only is used in GetOption
   DECODER_OPTION_STATISTICS_LOG_INTERVAL,///< set log output interval
+  DECODER_OPTION_NUM_OF_THREADS,        ///< number of decoding threads, frame level multi-threading is used when it is larger than 1, the same threads reconstructing the slices of a multi-slice picture in parallel; slices are reconstructed serially with 1 thread, DecodeFrameNoDelay() avoids the frame delay of the multi-threading, DECODER_OPTION_SLICE_THREADING the frame level multi-threading altogether; set before Initialize()
+  DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER, ///< number of decoded frames still held for output when multi-threading, only is used in GetOption
+  DECODER_OPTION_PICTURE_ALLOCATOR,     ///< SDecPictureAllocator* to decode pictures into buffers owned by the application, NULL to disable; set before Initialize()
+  DECODER_OPTION_THREAD_POOL,           ///< SThreadPoolParam* of the pool running the decoding threads, NULL for the default; set before Initialize(), got for the defaults
+  DECODER_OPTION_GET_STAGE_TIMING,      ///< SDecoderStageTiming* of the time spent in the decoding stages, only is used in GetOption
+  DECODER_OPTION_MEMORY_ARENA,          ///< SMemoryArenaParam* to carve the buffers of the decoder from a few large regions; set before Initialize()
+  DECODER_OPTION_MEMORY_USAGE,          ///< SMemoryUsage* of the memory allocated by the decoder per tag, only is used in GetOption
+  DECODER_OPTION_SLICE_THREADING,       ///< int, 1 to use the threads of DECODER_OPTION_NUM_OF_THREADS for the slices of each picture only: pictures are decoded one at a time, the slices of one reconstructed in parallel, and output with no frame delay; set before Initialize()
 
 } DECODER_OPTION;
 
@@ -589,6 +606,62 @@ typedef struct {
   VIDEO_BITSTREAM_TYPE  eVideoBsType;  ///< video stream type (AVC/SVC)
 } SVideoProperty;
 
+/**
+* @brief Thread pool of an encoder or decoder instance, set by ENCODER_OPTION_THREAD_POOL or DECODER_OPTION_THREAD_POOL
+*
+*        By default all the instances share one process-wide pool. With this parameter an instance uses a pool of its
+*        own, or the pool shared by all the instances given the same non-zero iPoolId, created by the first of them and
+*        destroyed with the last one. The threads of the pool are bound to the CPUs both in uiCpuMask and on NUMA node
+*        iNumaNode, where supported by the platform. Getting the option before setting it gives the defaults, a pool of
+*        the instance bound to no CPU; note that a zero-initialized iNumaNode binds the threads to node 0.
+*/
+typedef struct TagThreadPoolParam {
+  int iPoolId;                          ///< pool shared by the instances of the same id, 0 for a pool of this instance only
+  int iThreadNum;                       ///< number of threads of the pool, 0 for the number of threads of the instance
+  int iNumaNode;                        ///< NUMA node the threads are bound to, -1 (default) for any
+  unsigned long long uiCpuMask[4];      ///< CPUs the threads are bound to, CPU n as bit (n % 64) of uiCpuMask[n / 64], all 0 for any
+} SThreadPoolParam;
+
+/**
+* @brief Arena mode of the memory allocator of an encoder or decoder instance, set by ENCODER_OPTION_MEMORY_ARENA or
+*        DECODER_OPTION_MEMORY_ARENA
+*
+*        The buffers no larger than a quarter of uiRegionSize are carved one after another from regions of uiRegionSize
+*        bytes, so that an instance makes a few large allocations instead of hundreds of small ones. A region is
+*        released when all the buffers carved from it are freed. Larger buffers are allocated separately.
+*/
+typedef struct TagMemoryArenaParam {
+  unsigned int uiRegionSize;            ///< bytes of each region, 0 to allocate every buffer separately (default)
+  bool bHugePages;                      ///< back the regions by huge pages where supported by the platform
+} SMemoryArenaParam;
+
+#define MAX_MEMORY_TAG_NUM      128     ///< allocations beyond this number of distinct tags are counted to the first one
+#define MEMORY_TAG_NAME_LEN     48
+
+/**
+* @brief Memory allocated by an encoder or decoder instance, got by ENCODER_OPTION_MEMORY_USAGE or
+*        DECODER_OPTION_MEMORY_USAGE
+*
+*        Allocations are grouped by the tag naming the buffer in the codec, e.g. "pDecPic" or "pSliceBuffer", so the
+*        subsystem using the memory can be told. The first tag "others" counts the untagged allocations. All the bytes
+*        include the bookkeeping and alignment of each allocation.
+*/
+typedef struct TagMemoryTagUsage {
+  char sTag[MEMORY_TAG_NAME_LEN];       ///< tag of the allocations, truncated if longer
+  unsigned int uiBytes;                 ///< bytes allocated currently
+  unsigned int uiPeakBytes;             ///< peak of uiBytes
+  unsigned int uiBlockNum;              ///< number of the buffers allocated currently
+} SMemoryTagUsage;
+
+typedef struct TagMemoryUsage {
+  unsigned int uiTotalBytes;            ///< bytes allocated currently, the sum of the ones of all the tags
+  unsigned int uiPeakBytes;             ///< peak of uiTotalBytes
+  unsigned int uiArenaBytes;            ///< bytes of the regions reserved in arena mode, 0 otherwise
+  int iRegionNum;                       ///< number of the regions reserved in arena mode
+  int iTagNum;                          ///< number of the tags filled in sTagUsage
+  SMemoryTagUsage sTagUsage[MAX_MEMORY_TAG_NUM];
+} SMemoryUsage;
+
 /**
 * @brief SVC Decoding Parameters, reserved here and potential applicable in the future
 */
@@ -600,10 +673,33 @@ typedef struct TagSVCDecodingParam {
 
   ERROR_CON_IDC eEcActiveIdc;          ///< whether active error concealment feature in decoder
   bool bParseOnly;                     ///< decoder for parse only, no reconstruction. When it is true, SPS/PPS size should not exceed SPS_PPS_BS_SIZE (128). Otherwise, it will return error info
+  bool bZeroCopyInput;                 ///< NALs without emulation prevention bytes are parsed in place instead of copied. The application guarantees each input buffer stays unchanged until its access unit is decoded, at the latest when the first NAL of the next access unit is passed, and that 4 bytes past its end are readable. Ignored when bParseOnly is true
 
   SVideoProperty   sVideoProperty;    ///< video stream property
 } SDecodingParam, *PDecodingParam;
 
+/**
+* @brief Allocator of the picture buffers used by the decoder, set by DECODER_OPTION_PICTURE_ALLOCATOR
+*
+*        pfGetBuffer is called when the decoder starts decoding into a picture buffer. It fills in pData[] with the
+*        I420 planes of a buffer of iWidth x iHeight, where iPadding (luma) and iPadding / 2 (chroma) samples around
+*        each plane are writable as well, iStride[0] of luma and iStride[1] of both chroma planes. The planes must be
+*        16 bytes aligned, iStride[0] a multiple of 32, no less than iWidth + 2 * iPadding, and twice iStride[1]. The same
+*        strides must be returned for all the buffers of the same size. *ppBuffer is the handle passed back when the
+*        buffer is released; it returns 0 on success.
+*
+*        pfReleaseBuffer is called when the decoder will not access the buffer any more, at the latest when the
+*        decoder is uninitialized. The pointers output by DecodeFrame*() refer to these planes, so the application can
+*        keep a decoded picture without copying it by holding its own reference to the buffer until released on
+*        both sides. Both callbacks are called on the thread calling the decoder.
+*/
+typedef struct TagDecPictureAllocator {
+  void* pContext;                      ///< passed to the callbacks
+  int (*pfGetBuffer) (void* pContext, int iWidth, int iHeight, int iPadding, unsigned char* pData[3], int iStride[2],
+                      void** ppBuffer);
+  void (*pfReleaseBuffer) (void* pContext, void* pBuffer);
+} SDecPictureAllocator;
+
 /**
 * @brief Bitstream inforamtion of a layer being encoded
 */
@@ -640,13 +736,53 @@ typedef struct {
 *  @brief Structure for source picture
 */
 typedef struct Source_Picture_s {
-  int       iColorFormat;          ///< color space type
+  int       iColorFormat;          ///< color space type, videoFormatI420, videoFormatNV12 or 32 bit RGB when encoding
   int       iStride[4];            ///< stride for each plane pData
   unsigned char*  pData[4];        ///< plane pData
   int       iPicWidth;             ///< luma picture width in x coordinate
   int       iPicHeight;            ///< luma picture height in y coordinate
   long long uiTimeStamp;           ///< timestamp of the source picture, unit: millisecond
 } SSourcePicture;
+
+/**
+* @brief Asynchronous encoding, set by ENCODER_OPTION_ASYNC_ENCODING
+*
+*        EncodeFrame() copies the source picture and returns without waiting for it to be encoded: the frames are
+*        encoded in the order of submission on a thread of the encoder, so the caller can prepare the next picture
+*        meanwhile. EncodeFrame() blocks only when iMaxFramesInFlight frames are submitted and not output yet.
+*
+*        When pfOnFrameEncoded is set, it is called on the encoding thread for each frame with the result of
+*        encoding it; the bitstream of pBsInfo is valid during the call only. Otherwise the frames are polled:
+*        EncodeFrame() fills in its pBsInfo with the oldest frame encoded if any, returning the result of encoding
+*        that frame, else sets iLayerNum to 0 and eFrameType to videoFrameTypeInvalid. The bitstream output is valid
+*        until the next call to the encoder. EncodeFrame (NULL, pBsInfo) waits for the oldest frame pending and
+*        outputs it, which flushes the encoder when called until no frame is output. In both modes the other calls
+*        to the encoder wait for the frame being encoded first: the options take effect from the next frame encoded,
+*        which may be one submitted already when frames are held for ENCODER_OPTION_RC_LOOKAHEAD, while
+*        ENCODER_OPTION_SVC_ENCODE_PARAM_BASE, ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, ENCODER_OPTION_SPS_PPS_ID_STRATEGY
+*        and ForceIntraFrame() encode all the frames submitted first and take effect from the next frame submitted.
+*
+*        Only the coding moves to the thread: the preprocessing of a frame (downsampling, scene change detection,
+*        adaptive quantization) runs on the same thread right before it is coded, not overlapped with the coding of
+*        the previous frame.
+*/
+typedef struct TagEncAsyncParam {
+  int iMaxFramesInFlight;              ///< frames submitted and not output yet at most, 0 disables the asynchronous encoding
+  void* pContext;                      ///< passed to pfOnFrameEncoded
+  void (*pfOnFrameEncoded) (void* pContext, int iResult, const SFrameBSInfo* pBsInfo);
+} SEncAsyncParam;
+/**
+* @brief Two-pass rate control, set by ENCODER_OPTION_TWO_PASS
+*
+*        The first pass writes the bits, the QP and the complexity of every frame coded into the statistics file.
+*        The second pass encodes the same frames with the same timestamps and layers: it reads the file at
+*        InitializeExt() and allocates the bits of the whole clip by the complexities recorded, the frames without
+*        statistics being rate controlled as in a single pass.
+*/
+typedef struct TagEncTwoPassParam {
+  int iPass;                           ///< 0: single pass (default), 1: first pass, 2: second pass
+  const char* pStatsFileName;          ///< statistics file written by the first pass and read by the second one
+} SEncTwoPassParam;
 /**
 * @brief Structure for bit rate info
 */
@@ -782,6 +918,24 @@ typedef struct TagVideoDecoderStatistics {
   unsigned int iStatisticsLogInterval;                  ///< frame interval of statistics log
 } SDecoderStatistics; // in building, coming soon
 
+/**
+* @brief Time spent in the decoding stages since the decoder was created, got by DECODER_OPTION_GET_STAGE_TIMING
+*
+*        The stages are only timed by a decoder built with WELS_STAGE_TIMING defined (make STAGE_TIMING=Yes), otherwise
+*        the option fails with cmUnsupportedData. Stages running on the decoding threads are not included, so the
+*        timing is only complete for a single threaded decoder. The stages are timed per slice or MB row, except
+*        for the MC which is timed per MB, only with make STAGE_TIMING=MB, and else counted in the reconstruction.
+*        All the times are in microseconds.
+*/
+typedef struct TagDecoderStageTiming {
+  unsigned long long uiNalParseUs;              ///< NAL unit header and slice header parsing
+  unsigned long long uiEntropyDecodeUs;         ///< CAVLC/CABAC decoding of the MB layer
+  unsigned long long uiReconstructionUs;        ///< intra prediction and residual reconstruction, except for the MC
+  unsigned long long uiMcUs;                    ///< motion compensation, 0 unless built with STAGE_TIMING=MB
+  unsigned long long uiDeblockingUs;            ///< deblocking filter
+  unsigned long long uiErrorConcealmentUs;      ///< error concealment
+} SDecoderStageTiming;
+
 /**
 * @brief Structure for sample aspect ratio (SAR) info in VUI
 */
@@ -52,6 +52,8 @@ class CWelsTaskThread;
 
 class IWelsTaskThreadSink {
  public:
+  // next task to be executed by pThread, NULL to let the thread wait till signaled
+  virtual IWelsTask* FetchTask (CWelsTaskThread* pThread) = 0;
   virtual WELS_THREAD_ERROR_CODE OnTaskStart (CWelsTaskThread* pThread, IWelsTask* pTask) = 0;
   virtual WELS_THREAD_ERROR_CODE OnTaskStop (CWelsTaskThread* pThread, IWelsTask* pTask) = 0;
 };
@@ -61,17 +63,18 @@ class CWelsTaskThread : public CWelsThread {
   CWelsTaskThread (IWelsTaskThreadSink* pSink);
   virtual ~CWelsTaskThread();
 
-  WELS_THREAD_ERROR_CODE  SetTask (IWelsTask* pTask);
   virtual void ExecuteTask();
+  // wake up the thread waiting for tasks
+  void         Signal() {
+    SignalThread();
+  }
 
   uintptr_t    GetID() const {
     return m_uiID;
   }
 
  private:
-  CWelsLock   m_cLockTask;
   IWelsTaskThreadSink*   m_pSink;
-  IWelsTask*    m_pTask;
   uintptr_t    m_uiID;
 
   DISALLOW_COPY_AND_ASSIGN (CWelsTaskThread);
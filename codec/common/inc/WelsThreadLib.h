@@ -56,6 +56,7 @@ typedef    LPTHREAD_START_ROUTINE    LPWELS_THREAD_ROUTINE;
 
 typedef    CRITICAL_SECTION          WELS_MUTEX;
 typedef    HANDLE                    WELS_EVENT;
+typedef    CONDITION_VARIABLE        WELS_COND;
 
 #define    WELS_THREAD_ROUTINE_TYPE         DWORD  WINAPI
 #define    WELS_THREAD_ROUTINE_RETURN(rc)   return (DWORD)rc;
@@ -86,6 +87,8 @@ typedef   pthread_cond_t            WELS_EVENT;
 typedef   sem_t*                    WELS_EVENT;
 #endif
 
+typedef   pthread_cond_t            WELS_COND;
+
 #define   WELS_THREAD_ROUTINE_TYPE         void *
 #define   WELS_THREAD_ROUTINE_RETURN(rc)   return (void*)(intptr_t)rc;
 
@@ -118,6 +121,11 @@ WELS_THREAD_ERROR_CODE    WelsEventWaitWithTimeOut (WELS_EVENT* event, uint32_t
 WELS_THREAD_ERROR_CODE    WelsMultipleEventsWaitSingleBlocking (uint32_t nCount, WELS_EVENT* event_list,
     WELS_EVENT* master_event = NULL,WELS_MUTEX *pMutex = NULL);
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* pCond);
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* pCond, WELS_MUTEX* pMutex);
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* pCond);
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* pCond);
+
 WELS_THREAD_ERROR_CODE    WelsThreadCreate (WELS_THREAD_HANDLE* thread,  LPWELS_THREAD_ROUTINE  routine,
     void* arg, WELS_THREAD_ATTR attr);
 
@@ -129,8 +137,58 @@ WELS_THREAD_HANDLE        WelsThreadSelf();
 
 WELS_THREAD_ERROR_CODE    WelsQueryLogicalProcessInfo (WelsLogicalProcessInfo* pInfo);
 
+// CPU n is bit (n & 63) of pCpuMask[n >> 6] in the CPU masks
+#define WELS_CPU_MASK_WORDS 4
+// bind the calling thread to the CPUs in the mask
+WELS_THREAD_ERROR_CODE    WelsThreadSetAffinity (const uint64_t* pCpuMask, int32_t iMaskWords);
+WELS_THREAD_ERROR_CODE    WelsQueryNumaNodeCpus (int32_t iNode, uint64_t* pCpuMask, int32_t iMaskWords);
+
 void WelsSleep (uint32_t dwMilliSecond);
 
+/*
+ *  atomic operations on 32 bits integers, all of them imply a full memory barrier
+ */
+#if defined(_WIN32) || defined(__CYGWIN__)
+// returns the initial value of *pTarget, iExchange is stored only if it was iComparand
+static inline int32_t WelsAtomicCompareExchange (volatile int32_t* pTarget, int32_t iExchange, int32_t iComparand) {
+  return (int32_t)InterlockedCompareExchange ((volatile LONG*)pTarget, (LONG)iExchange, (LONG)iComparand);
+}
+// returns the initial value of *pTarget
+static inline int32_t WelsAtomicExchange (volatile int32_t* pTarget, int32_t iValue) {
+  return (int32_t)InterlockedExchange ((volatile LONG*)pTarget, (LONG)iValue);
+}
+// returns the resulting value of *pTarget
+static inline int32_t WelsAtomicAdd (volatile int32_t* pTarget, int32_t iValue) {
+  return (int32_t)InterlockedExchangeAdd ((volatile LONG*)pTarget, (LONG)iValue) + iValue;
+}
+static inline void WelsMemoryBarrier() {
+  MemoryBarrier();
+}
+#else
+static inline int32_t WelsAtomicCompareExchange (volatile int32_t* pTarget, int32_t iExchange, int32_t iComparand) {
+  return __sync_val_compare_and_swap (pTarget, iComparand, iExchange);
+}
+static inline int32_t WelsAtomicExchange (volatile int32_t* pTarget, int32_t iValue) {
+  int32_t iOld;
+  do {
+    iOld = *pTarget;
+  } while (__sync_val_compare_and_swap (pTarget, iOld, iValue) != iOld);
+  return iOld;
+}
+static inline int32_t WelsAtomicAdd (volatile int32_t* pTarget, int32_t iValue) {
+  return __sync_add_and_fetch (pTarget, iValue);
+}
+static inline void WelsMemoryBarrier() {
+  __sync_synchronize();
+}
+#endif
+
+#if defined(_MSC_VER)
+#define WELS_THREAD_LOCAL __declspec(thread)
+#else
+#define WELS_THREAD_LOCAL __thread
+#endif
+
 #ifdef  __cplusplus
 }
 #endif
@@ -43,14 +43,87 @@
 #define _WELS_THREAD_POOL_H_
 
 #include <stdio.h>
+#include "codec_app_def.h"
 #include "WelsTask.h"
 #include "WelsTaskThread.h"
 #include "WelsList.h"
 
 namespace WelsCommon {
 
+#define WELS_CACHE_LINE_SIZE 64
 
-class  CWelsThreadPool : public CWelsThread, public IWelsTaskThreadSink {
+/*
+ *  CWelsTaskDeque: work-stealing deque of one pool thread, without locking. The owner thread pushes and pops tasks at
+ *  the bottom while the other threads steal them from the top.
+ */
+class CWelsTaskDeque {
+ public:
+  enum {
+    TASK_DEQUE_SIZE = 256,      // power of 2
+  };
+
+  CWelsTaskDeque();
+
+  // called by the owner thread only, false when it is full
+  bool       Push (IWelsTask* pTask);
+  // called by the owner thread only, latest task pushed
+  IWelsTask* Pop();
+  // called by any thread, oldest task pushed
+  IWelsTask* Steal();
+
+ private:
+  volatile int32_t    m_iTop;
+  uint8_t             m_uiPadTop[WELS_CACHE_LINE_SIZE - sizeof (int32_t)];
+  volatile int32_t    m_iBottom;
+  uint8_t             m_uiPadBottom[WELS_CACHE_LINE_SIZE - sizeof (int32_t)];
+  IWelsTask* volatile m_pTasks[TASK_DEQUE_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsTaskDeque);
+};
+
+/*
+ *  CWelsTaskQueue: bounded FIFO of the tasks queued from outside of the pool, pushed and popped by any thread without
+ *  locking
+ */
+class CWelsTaskQueue {
+ public:
+  enum {
+    TASK_QUEUE_SIZE = 1024,     // power of 2
+  };
+
+  CWelsTaskQueue();
+
+  // false when it is full
+  bool       Push (IWelsTask* pTask);
+  IWelsTask* Pop();
+  int32_t    GetSize() const {
+    return (int32_t) ((uint32_t)m_iTail - (uint32_t)m_iHead);
+  }
+
+ private:
+  typedef struct TagTaskCell {
+    volatile int32_t    iSeq;   // position the cell is ready to be pushed to, or that plus 1 once it is filled
+    IWelsTask*          pTask;
+  } STaskCell;
+
+  volatile int32_t    m_iHead;
+  uint8_t             m_uiPadHead[WELS_CACHE_LINE_SIZE - sizeof (int32_t)];
+  volatile int32_t    m_iTail;
+  uint8_t             m_uiPadTail[WELS_CACHE_LINE_SIZE - sizeof (int32_t)];
+  STaskCell           m_sCells[TASK_QUEUE_SIZE];
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsTaskQueue);
+};
+
+/*
+ *  CWelsThreadPool: work-stealing scheduler. Tasks queued from outside of the pool go to a shared FIFO, so they are
+ *  started in the order queued; tasks queued by a task running on the pool go to the deque of its thread. An idle
+ *  thread takes the tasks of its own deque first, then the shared FIFO, then steals from the other threads, and
+ *  sleeps on its event when none is found.
+ *  Besides the process-wide pool sized by SetThreadNum(), pools of given size and CPU affinity are created for the
+ *  instances passing SThreadPoolParam, shared by the instances of the same pool id.
+ */
+class  CWelsThreadPool : public IWelsTaskThreadSink {
  public:
   enum {
     DEFAULT_THREAD_NUM = 4,
@@ -59,20 +132,23 @@ class  CWelsThreadPool : public CWelsThread, public IWelsTaskThreadSink {
   static WELS_THREAD_ERROR_CODE SetThreadNum (int32_t iMaxThreadNum);
 
   static CWelsThreadPool* AddReference();
+  // pool described by pParam, with kiThreadNum threads unless specified by pParam
+  static CWelsThreadPool* AddReference (const SThreadPoolParam* pParam, const int32_t kiThreadNum);
   void RemoveInstance();
 
   static bool IsReferenced();
 
   //IWelsTaskThreadSink
+  virtual IWelsTask* FetchTask (CWelsTaskThread* pThread);
   virtual WELS_THREAD_ERROR_CODE OnTaskStart (CWelsTaskThread* pThread,  IWelsTask* pTask);
   virtual WELS_THREAD_ERROR_CODE OnTaskStop (CWelsTaskThread* pThread,  IWelsTask* pTask);
 
-  //  CWelsThread
-  virtual void ExecuteTask();
-
   WELS_THREAD_ERROR_CODE  QueueTask (IWelsTask* pTask);
   int32_t        GetThreadNum() const {
-    return m_iMaxThreadNum;
+    return m_iPoolSize;
+  }
+  bool           HasCpuAffinity() const {
+    return m_bCpuAffinity;
   }
 
 
@@ -80,38 +156,52 @@ class  CWelsThreadPool : public CWelsThread, public IWelsTaskThreadSink {
   WELS_THREAD_ERROR_CODE Init();
   WELS_THREAD_ERROR_CODE Uninit();
 
-  WELS_THREAD_ERROR_CODE CreateIdleThread();
-  void           DestroyThread (CWelsTaskThread* pThread);
-  WELS_THREAD_ERROR_CODE AddThreadToIdleQueue (CWelsTaskThread* pThread);
-  WELS_THREAD_ERROR_CODE AddThreadToBusyList (CWelsTaskThread* pThread);
-  WELS_THREAD_ERROR_CODE RemoveThreadFromBusyList (CWelsTaskThread* pThread);
-  bool           AddTaskToWaitedList (IWelsTask* pTask);
-  CWelsTaskThread*   GetIdleThread();
-  IWelsTask*         GetWaitedTask();
-  int32_t            GetIdleThreadNum();
-  int32_t            GetBusyThreadNum();
-  int32_t            GetWaitedTaskNum();
-  void               ClearWaitedTasks();
+  WELS_THREAD_ERROR_CODE CreateThreads();
+  void           DestroyThreads();
+  IWelsTask*     FindTask (int32_t iThreadIdx);
+  IWelsTask*     GetOverflowTask();
+  void           WakeUpThread();
+  int32_t        GetThreadIndex (CWelsTaskThread* pThread);
+  int32_t        GetBusyThreadNum();
+  void           ClearWaitedTasks();
 
  private:
-  CWelsThreadPool();
+  CWelsThreadPool (const int32_t kiPoolSize);
   virtual ~CWelsThreadPool();
-  
+
+  void SetCpuAffinity (const SThreadPoolParam* pParam);
+
   WELS_THREAD_ERROR_CODE StopAllRunning();
 
-  static int32_t   m_iRefCount;
+  typedef struct TagPoolThread {
+    CWelsTaskThread*    pThread;
+    CWelsTaskDeque      cTasks;
+    volatile int32_t    iSleeping;      // 1 when the thread found no task and may wait on its event
+  } SPoolThread;
+
   static CWelsLock m_cInitLock;
   static int32_t   m_iMaxThreadNum;
-  static CWelsThreadPool* m_pThreadPoolSelf;
-
-  CWelsNonDuplicatedList<IWelsTask>* m_cWaitedTasks;
-  CWelsNonDuplicatedList<CWelsTaskThread>* m_cIdleThreads;
-  CWelsList<CWelsTaskThread>* m_cBusyThreads;
+  static CWelsThreadPool* m_pThreadPoolSelf;     // process-wide pool
+  static CWelsThreadPool* m_pPrivatePools;       // pools created by SThreadPoolParam
+
+  int32_t          m_iRefCount;
+  int32_t          m_iPoolId;
+  int32_t          m_iPoolSize;
+  CWelsThreadPool* m_pNextPool;
+  bool             m_bCpuAffinity;
+  uint64_t         m_uiCpuMask[WELS_CPU_MASK_WORDS];
+
+  SPoolThread*     m_pThreads;
+  int32_t          m_iThreadNum;        // threads created
+  CWelsTaskQueue*  m_pWaitedTasks;
+  // tasks queued from outside of the pool when m_pWaitedTasks is full
+  CWelsList<IWelsTask>* m_cOverflowTasks;
+  volatile int32_t m_iOverflowNum;
+  volatile int32_t m_iBusyNum;
+  volatile int32_t m_iWakeUpIdx;        // first thread checked by the next wake-up, to spread the tasks
 
   CWelsLock   m_cLockPool;
-  CWelsLock   m_cLockWaitedTasks;
-  CWelsLock   m_cLockIdleTasks;
-  CWelsLock   m_cLockBusyTasks;
+  CWelsLock   m_cLockOverflow;
 
   DISALLOW_COPY_AND_ASSIGN (CWelsThreadPool);
 };
@@ -0,0 +1,113 @@
+/*!
+ * \copy
+ *     Copyright (c)  2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    colorspace_convert.h
+ *
+ * \brief   Conversion of NV12 and 32 bit RGB source pictures into I420
+ *
+ * \date    10/18/2026 Created
+ *************************************************************************************
+ */
+
+#ifndef WELS_COLORSPACE_CONVERT_H_
+#define WELS_COLORSPACE_CONVERT_H_
+
+#include "typedefs.h"
+#include "codec_app_def.h"
+
+/*
+ *  The 32 bit RGB formats are named after their byte order in memory, videoFormatBGRA being B, G, R, A.
+ *  RGB is converted into BT.601 limited range YUV, chroma from the rounded average of each 2x2 block.
+ *  The row functions take the coefficients of a format as int16_t[3][8], the Y, U and V weights of the
+ *  four bytes of a pixel in memory order, twice.
+ */
+typedef void (*PSplitUVRowFunc) (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+typedef void (*PRgb32ToYRowFunc) (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff);
+typedef void (*PRgb32ToUVRowFunc) (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                                   int32_t iWidth, const int16_t* kpCoeff);
+
+typedef struct TagColorspaceConvertFunc {
+  PSplitUVRowFunc   pfSplitUVRow;       // iWidth chroma samples of an interleaved UV row
+  PRgb32ToYRowFunc  pfRgb32ToYRow;      // iWidth pixels, kpCoeff the Y weights
+  PRgb32ToUVRowFunc pfRgb32ToUVRow;     // iWidth chroma samples of two rows, kpCoeff the U then V weights
+} SColorspaceConvertFunc;
+
+void InitColorspaceConvertFunc (SColorspaceConvertFunc* pFuncs, const uint32_t kuiCpuFlag);
+// the row functions with the vector kernels of the CPU, not used by the codec till they are verified
+void InitColorspaceConvertVectorFunc (SColorspaceConvertFunc* pFuncs, const uint32_t kuiCpuFlag);
+
+/*
+ *  whether WelsConvertToI420() takes the color format, with or without videoFormatVFlip
+ */
+bool WelsCanConvertToI420 (const int32_t kiColorFormat);
+
+/*
+ *  convert the iWidth x iHeight area at (iLeft, iTop) of kpSrc into the I420 planes pDst, the size and
+ *  position are rounded down to even, rows are taken bottom up with videoFormatVFlip
+ *  \return 0 - converted; 1 - color format not supported, planes missing or strides too short
+ */
+int32_t WelsConvertToI420 (const SColorspaceConvertFunc* kpFuncs, const SSourcePicture* kpSrc, int32_t iLeft,
+                           int32_t iTop, int32_t iWidth, int32_t iHeight, uint8_t* pDst[3], const int32_t kiDstStride[3]);
+
+void WelsSplitUVRow_c (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+void WelsRgb32ToYRow_c (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff);
+void WelsRgb32ToUVRow_c (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                         int32_t iWidth, const int16_t* kpCoeff);
+
+#if defined(__cplusplus)
+extern "C" {
+#endif//__cplusplus
+
+#if defined(X86_ASM)
+// iWidth a multiple of 16, 8 and 4 respectively
+void WelsSplitUVRow_sse2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+void WelsRgb32ToYRow_sse2 (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff);
+void WelsRgb32ToUVRow_sse2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                            int32_t iWidth, const int16_t* kpCoeff);
+#ifdef HAVE_AVX2
+// iWidth a multiple of 32
+void WelsSplitUVRow_avx2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+#endif
+#endif//X86_ASM
+
+#if defined(HAVE_NEON_AARCH64)
+// iWidth a multiple of 16, 16 and 8 respectively
+void WelsSplitUVRow_AArch64_neon (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+void WelsRgb32ToYRow_AArch64_neon (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff);
+void WelsRgb32ToUVRow_AArch64_neon (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                                    int32_t iWidth, const int16_t* kpCoeff);
+#endif//HAVE_NEON_AARCH64
+
+#if defined(__cplusplus)
+}
+#endif//__cplusplus
+
+#endif//WELS_COLORSPACE_CONVERT_H_
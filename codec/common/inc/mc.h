@@ -42,6 +42,9 @@ typedef void (*PWelsLumaHalfpelMcFunc) (const uint8_t* pSrc, int32_t iSrcStride,
                                         int32_t iWidth, int32_t iHeight);
 typedef void (*PWelsSampleAveragingFunc) (uint8_t*, int32_t, const uint8_t*, int32_t, const uint8_t*, int32_t,
     int32_t, int32_t);
+// explicit weighted prediction in place: pDst = Clip1 (((pDst * iWeight + 2^(iLog2Denom-1)) >> iLog2Denom) + iOffset)
+typedef void (*PWelsWeightedPredFunc) (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                       int32_t iOffset, int32_t iWidth, int32_t iHeight);
 
 typedef struct TagMcFunc {
   PWelsLumaHalfpelMcFunc      pfLumaHalfpelHor;
@@ -51,6 +54,7 @@ typedef struct TagMcFunc {
 
   PWelsMcFunc                 pMcLumaFunc;
   PWelsSampleAveragingFunc    pfSampleAveraging;
+  PWelsWeightedPredFunc       pfWeightedPred;
 } SMcFunc;
 
 namespace WelsCommon {
@@ -304,6 +308,13 @@ void McHorVer22Width4VerLastAlign_sse2 (const uint8_t* pTap, int32_t iTapStride,
 void McHorVer22Width4VerLastUnAlign_sse2 (const uint8_t* pTap, int32_t iTapStride, uint8_t* pDst, int32_t iDstStride,
         int32_t iWidth, int32_t iHeight);
 
+void WeightedPredWidthEq4_sse2 (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                int32_t iOffset, int32_t iHeight);
+void WeightedPredWidthEq8_sse2 (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                int32_t iOffset, int32_t iHeight);
+void WeightedPredWidthEq16_sse2 (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                 int32_t iOffset, int32_t iHeight);
+
 //***************************************************************************//
 //                       SSE3 definition                                     //
 //***************************************************************************//
@@ -336,6 +347,10 @@ void McHorVer20Width9Or17U8ToS16_ssse3 (const uint8_t* pSrc, int32_t iSrcStride,
 //                       AVX2 definition                                     //
 //***************************************************************************//
 #ifdef HAVE_AVX2
+void McChromaWidthEq8_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
+                            const uint8_t* kpABCD, int32_t iHeight);
+void WeightedPredWidthEq16_avx2 (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                 int32_t iOffset, int32_t iHeight);
 void McHorVer02_avx2 (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t iDstStride,
                       int32_t iWidth, int32_t iHeight);
 void McHorVer02Width4S16ToU8_avx2 (const int16_t* pSrc, uint8_t* pDst, int32_t iDstStride, int32_t iHeight);
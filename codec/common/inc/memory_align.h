@@ -34,6 +34,8 @@
 #define WELS_COMMON_MEMORY_ALIGN_H__
 
 #include "typedefs.h"
+#include "codec_app_def.h"
+#include "WelsThreadLib.h"
 
 // NOTE: please do not clean below lines even comment, turn on for potential memory leak verify and memory usage monitor etc.
 //#define MEMORY_CHECK
@@ -49,11 +51,38 @@
 #include <stdio.h>
 #endif//MEMORY_CHECK
 
+// open addressing table of the tags, a power of 2 kept at most half full
+#define MEMORY_TAG_HASH_SIZE    (MAX_MEMORY_TAG_NUM << 1)
+
 namespace WelsCommon {
 
+/*
+ *  region of the arena mode, the header of the region memory, the blocks are carved one after another behind it and
+ *  the region is released with the last one of them unless it is still carved
+ */
+typedef struct TagMemoryRegion {
+  uint32_t                uiSize;
+  uint32_t                uiUsed;         // bytes from the region start, header included
+  int32_t                 iBlockNum;      // blocks carved and not freed yet
+  bool                    bMapped;        // mapped with huge pages advised, otherwise malloc'ed
+  struct TagMemoryRegion* pNext;
+} SMemoryRegion;
+
+/*
+ *  usage of the blocks allocated with the same tag
+ */
+typedef struct TagMemoryTagEntry {
+  char            sTag[MEMORY_TAG_NAME_LEN];
+  uint32_t        uiBytes;
+  uint32_t        uiPeakBytes;
+  uint32_t        uiBlockNum;
+} SMemoryTagEntry;
+
 class CMemoryAlign {
  public:
 CMemoryAlign (const uint32_t kuiCacheLineSize);
+// arena mode: blocks no larger than kuiRegionSize / 4 are carved from regions of kuiRegionSize bytes
+CMemoryAlign (const uint32_t kuiCacheLineSize, const uint32_t kuiRegionSize, const bool kbHugePages);
 virtual ~CMemoryAlign();
 
 void* WelsMallocz (const uint32_t kuiSize, const char* kpTag);
@@ -61,18 +90,36 @@ void* WelsMalloc (const uint32_t kuiSize, const char* kpTag);
 void WelsFree (void* pPointer, const char* kpTag);
 const uint32_t WelsGetCacheLineSize() const;
 const uint32_t WelsGetMemoryUsage() const;
+void WelsGetTagUsage (SMemoryUsage* pUsage);
 
  private:
 // private copy & assign constructors adding to fix klocwork scan issues
 CMemoryAlign (const CMemoryAlign& kcMa);
 CMemoryAlign& operator= (const CMemoryAlign& kcMa);
 
+void Init (const uint32_t kuiCacheLineSize, const uint32_t kuiRegionSize, const bool kbHugePages);
+uint8_t* CarveFromArena (const uint32_t kuiSize);
+SMemoryRegion* AddRegion();
+void ReleaseRegion (SMemoryRegion* pRegion);
+int32_t FindTag (const char* kpTag);
+
  protected:
 uint32_t        m_nCacheLineSize;
 
 #ifdef MEMORY_MONITOR
 uint32_t        m_nMemoryUsageInBytes;
+uint32_t        m_nPeakMemoryUsageInBytes;
+SMemoryTagEntry m_sTags[MAX_MEMORY_TAG_NUM];
+int32_t         m_iTagNum;
+int16_t         m_iTagHash[MEMORY_TAG_HASH_SIZE];  // index in m_sTags by the hash of the tag name, 0 for none
 #endif//MEMORY_MONITOR
+
+uint32_t        m_nRegionSize;
+bool            m_bHugePages;
+SMemoryRegion*  m_pRegions;             // the first one is the region being carved
+uint32_t        m_nArenaBytes;
+int32_t         m_iRegionNum;
+WELS_MUTEX      m_hMutex;
 };
 
 /*!
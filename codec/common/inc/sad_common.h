@@ -73,6 +73,19 @@ void WelsSampleSadFour8x16_sse2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*)
 void WelsSampleSadFour8x8_sse2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
 void WelsSampleSadFour4x4_sse2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
 
+int32_t WelsSampleSad16x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad16x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad8x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+int32_t WelsSampleSad8x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t);
+
+void WelsSampleSadFour16x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+void WelsSampleSadFour16x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+
+void WelsSampleNSad16x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t, int32_t, int32_t*);
+void WelsSampleNSad16x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t, int32_t, int32_t*);
+void WelsSampleNSad8x16_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t, int32_t, int32_t*);
+void WelsSampleNSad8x8_avx2 (uint8_t*, int32_t, uint8_t*, int32_t, int32_t, int32_t, int32_t*);
+
 #endif//X86_ASM
 
 #if defined (HAVE_NEON)
@@ -65,6 +65,7 @@
 #include "WelsThreadLib.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -109,6 +110,30 @@ WELS_THREAD_ERROR_CODE    WelsMutexDestroy (WELS_MUTEX* mutex) {
   return WELS_THREAD_ERROR_OK;
 }
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* pCond) {
+  InitializeConditionVariable (pCond);
+
+  return WELS_THREAD_ERROR_OK;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* pCond, WELS_MUTEX* pMutex) {
+  if (SleepConditionVariableCS (pCond, pMutex, INFINITE))
+    return WELS_THREAD_ERROR_OK;
+
+  return WELS_THREAD_ERROR_GENERAL;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* pCond) {
+  WakeAllConditionVariable (pCond);
+
+  return WELS_THREAD_ERROR_OK;
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* pCond) {
+  // nothing to release for a windows condition variable
+  return WELS_THREAD_ERROR_OK;
+}
+
 #else /* _WIN32 */
 
 WELS_THREAD_ERROR_CODE    WelsMutexInit (WELS_MUTEX*    mutex) {
@@ -127,6 +152,22 @@ WELS_THREAD_ERROR_CODE    WelsMutexDestroy (WELS_MUTEX* mutex) {
   return pthread_mutex_destroy (mutex);
 }
 
+WELS_THREAD_ERROR_CODE    WelsCondInit (WELS_COND* pCond) {
+  return pthread_cond_init (pCond, NULL);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondWait (WELS_COND* pCond, WELS_MUTEX* pMutex) {
+  return pthread_cond_wait (pCond, pMutex);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondBroadcast (WELS_COND* pCond) {
+  return pthread_cond_broadcast (pCond);
+}
+
+WELS_THREAD_ERROR_CODE    WelsCondDestroy (WELS_COND* pCond) {
+  return pthread_cond_destroy (pCond);
+}
+
 #endif /* !_WIN32 */
 
 #if defined(_WIN32) || defined(__CYGWIN__)
@@ -247,6 +288,33 @@ WELS_THREAD_ERROR_CODE    WelsQueryLogicalProcessInfo (WelsLogicalProcessInfo* p
   return WELS_THREAD_ERROR_OK;
 }
 
+WELS_THREAD_ERROR_CODE    WelsThreadSetAffinity (const uint64_t* pCpuMask, int32_t iMaskWords) {
+#ifndef WP80
+  // only the CPUs of processor group 0 are addressed
+  DWORD_PTR uiMask = (DWORD_PTR)pCpuMask[0];
+  if (0 == uiMask || 0 == SetThreadAffinityMask (GetCurrentThread(), uiMask)) {
+    return WELS_THREAD_ERROR_GENERAL;
+  }
+  return WELS_THREAD_ERROR_OK;
+#else
+  return WELS_THREAD_ERROR_GENERAL;
+#endif
+}
+
+WELS_THREAD_ERROR_CODE    WelsQueryNumaNodeCpus (int32_t iNode, uint64_t* pCpuMask, int32_t iMaskWords) {
+#ifndef WP80
+  ULONGLONG uiMask = 0;
+  if (iNode < 0 || iNode > 0xff || !GetNumaNodeProcessorMask ((UCHAR)iNode, &uiMask)) {
+    return WELS_THREAD_ERROR_GENERAL;
+  }
+  memset (pCpuMask, 0, iMaskWords * sizeof (uint64_t));
+  pCpuMask[0] = uiMask;
+  return WELS_THREAD_ERROR_OK;
+#else
+  return WELS_THREAD_ERROR_GENERAL;
+#endif
+}
+
 #else //platform: #ifdef _WIN32
 
 WELS_THREAD_ERROR_CODE    WelsThreadCreate (WELS_THREAD_HANDLE* thread,  LPWELS_THREAD_ROUTINE  routine,
@@ -553,6 +621,65 @@ WELS_THREAD_ERROR_CODE    WelsQueryLogicalProcessInfo (WelsLogicalProcessInfo* p
 #endif//__linux__
 }
 
-#endif
+WELS_THREAD_ERROR_CODE    WelsThreadSetAffinity (const uint64_t* pCpuMask, int32_t iMaskWords) {
+#ifdef __linux__
+  cpu_set_t cpuset;
+  int32_t iCpuNum = 0;
+
+  CPU_ZERO (&cpuset);
+  for (int32_t i = 0; i < iMaskWords * 64 && i < CPU_SETSIZE; i++) {
+    if ((pCpuMask[i >> 6] >> (i & 63)) & 1) {
+      CPU_SET (i, &cpuset);
+      iCpuNum++;
+    }
+  }
+  // 0 for the calling thread
+  if (0 == iCpuNum || 0 != sched_setaffinity (0, sizeof (cpuset), &cpuset)) {
+    return WELS_THREAD_ERROR_GENERAL;
+  }
+  return WELS_THREAD_ERROR_OK;
+#else
+  return WELS_THREAD_ERROR_GENERAL;
+#endif//__linux__
+}
 
+WELS_THREAD_ERROR_CODE    WelsQueryNumaNodeCpus (int32_t iNode, uint64_t* pCpuMask, int32_t iMaskWords) {
+#ifdef __linux__
+  // CPU list of the node as "0-7,16-23"
+  char chPath[64];
+  FILE* pFile = NULL;
+  int32_t iFirst = 0, iLast = 0;
+  char chSep = 0;
+
+  if (iNode < 0) {
+    return WELS_THREAD_ERROR_GENERAL;
+  }
+  snprintf (chPath, sizeof (chPath), "/sys/devices/system/node/node%d/cpulist", iNode);
+  pFile = fopen (chPath, "r");
+  if (NULL == pFile) {
+    return WELS_THREAD_ERROR_GENERAL;
+  }
+
+  memset (pCpuMask, 0, iMaskWords * sizeof (uint64_t));
+  while (1 == fscanf (pFile, "%d", &iFirst)) {
+    iLast = iFirst;
+    if (1 == fscanf (pFile, "%c", &chSep) && '-' == chSep) {
+      if (1 != fscanf (pFile, "%d", &iLast) || 1 != fscanf (pFile, "%c", &chSep)) {
+        chSep = 0;
+      }
+    }
+    for (int32_t i = iFirst; i <= iLast && i < iMaskWords * 64; i++) {
+      pCpuMask[i >> 6] |= ((uint64_t)1) << (i & 63);
+    }
+    if (',' != chSep) {
+      break;
+    }
+  }
+  fclose (pFile);
+  return WELS_THREAD_ERROR_OK;
+#else
+  return WELS_THREAD_ERROR_GENERAL;
+#endif//__linux__
+}
 
+#endif
@@ -37,24 +37,162 @@
  *
  *************************************************************************************
  */
+#include <string.h>
 #include "typedefs.h"
 #include "memory_align.h"
 #include "WelsThreadPool.h"
 
 namespace WelsCommon {
 
-int32_t CWelsThreadPool::m_iRefCount = 0;
 CWelsLock CWelsThreadPool::m_cInitLock;
 int32_t CWelsThreadPool::m_iMaxThreadNum = DEFAULT_THREAD_NUM;
 CWelsThreadPool* CWelsThreadPool::m_pThreadPoolSelf = NULL;
+CWelsThreadPool* CWelsThreadPool::m_pPrivatePools = NULL;
 
-CWelsThreadPool::CWelsThreadPool() :
-  m_cWaitedTasks (NULL), m_cIdleThreads (NULL), m_cBusyThreads (NULL) {
+// pool of the thread running on and its index in the pool, NULL for the threads out of any pool
+static WELS_THREAD_LOCAL CWelsThreadPool* s_pCurPool = NULL;
+static WELS_THREAD_LOCAL int32_t s_iPoolThreadIdx = -1;
+
+///////////////////////////////////work-stealing deque///////////////////////////////////
+/*
+ *  Chase-Lev deque on a fixed size ring. Indexes only increase and are compared by their difference, so that they can
+ *  wrap around. Only the last task is raced for between Pop() and Steal(), through the CAS on the top.
+ */
+CWelsTaskDeque::CWelsTaskDeque() :
+  m_iTop (0), m_iBottom (0) {
+  memset ((void*)m_pTasks, 0, sizeof (m_pTasks));
+}
+
+bool CWelsTaskDeque::Push (IWelsTask* pTask) {
+  const uint32_t kuiBottom = (uint32_t)m_iBottom;
+  const uint32_t kuiTop = (uint32_t)m_iTop;
+  if ((int32_t) (kuiBottom - kuiTop) >= TASK_DEQUE_SIZE) {
+    return false;
+  }
+
+  m_pTasks[kuiBottom & (TASK_DEQUE_SIZE - 1)] = pTask;
+  WelsMemoryBarrier(); // the task is visible before the new bottom
+  m_iBottom = (int32_t) (kuiBottom + 1);
+  return true;
+}
+
+IWelsTask* CWelsTaskDeque::Pop() {
+  const uint32_t kuiBottom = (uint32_t)m_iBottom - 1;
+  m_iBottom = (int32_t)kuiBottom;
+  WelsMemoryBarrier(); // the thieves see the new bottom before the top is read
+  const uint32_t kuiTop = (uint32_t)m_iTop;
+  const int32_t kiSize = (int32_t) (kuiBottom - kuiTop);
+
+  if (kiSize < 0) {
+    m_iBottom = (int32_t) (kuiBottom + 1);
+    return NULL;
+  }
+
+  IWelsTask* pTask = m_pTasks[kuiBottom & (TASK_DEQUE_SIZE - 1)];
+  if (kiSize > 0) {
+    return pTask;
+  }
+  // the last task, which may be stolen at the same time
+  if (WelsAtomicCompareExchange (&m_iTop, (int32_t) (kuiTop + 1), (int32_t)kuiTop) != (int32_t)kuiTop) {
+    pTask = NULL;
+  }
+  m_iBottom = (int32_t) (kuiBottom + 1);
+  return pTask;
+}
+
+IWelsTask* CWelsTaskDeque::Steal() {
+  while (true) {
+    const uint32_t kuiTop = (uint32_t)m_iTop;
+    WelsMemoryBarrier(); // the top is read before the bottom
+    const uint32_t kuiBottom = (uint32_t)m_iBottom;
+    if ((int32_t) (kuiBottom - kuiTop) <= 0) {
+      return NULL;
+    }
+
+    WelsMemoryBarrier(); // the task pushed is read after the bottom
+    IWelsTask* pTask = m_pTasks[kuiTop & (TASK_DEQUE_SIZE - 1)];
+    if (WelsAtomicCompareExchange (&m_iTop, (int32_t) (kuiTop + 1), (int32_t)kuiTop) == (int32_t)kuiTop) {
+      return pTask;
+    }
+    // taken by another thread, retry with the next one
+  }
+}
+
+///////////////////////////////////shared task queue///////////////////////////////////
+/*
+ *  bounded MPMC queue: each cell carries the sequence of the position it is ready for, the head and the tail are
+ *  claimed by CAS, then the cell is handed over by updating its sequence
+ */
+CWelsTaskQueue::CWelsTaskQueue() :
+  m_iHead (0), m_iTail (0) {
+  for (int32_t i = 0; i < TASK_QUEUE_SIZE; i++) {
+    m_sCells[i].iSeq = i;
+    m_sCells[i].pTask = NULL;
+  }
+}
+
+bool CWelsTaskQueue::Push (IWelsTask* pTask) {
+  STaskCell* pCell = NULL;
+  uint32_t uiPos = (uint32_t)m_iTail;
+
+  while (true) {
+    pCell = &m_sCells[uiPos & (TASK_QUEUE_SIZE - 1)];
+    const int32_t kiDiff = (int32_t) ((uint32_t)pCell->iSeq - uiPos);
+    if (kiDiff == 0) {
+      const uint32_t kuiCur = (uint32_t)WelsAtomicCompareExchange (&m_iTail, (int32_t) (uiPos + 1), (int32_t)uiPos);
+      if (kuiCur == uiPos) {
+        break;
+      }
+      uiPos = kuiCur;
+    } else if (kiDiff < 0) {
+      return false; // full
+    } else {
+      uiPos = (uint32_t)m_iTail;
+    }
+  }
+
+  pCell->pTask = pTask;
+  WelsMemoryBarrier(); // the task is visible before the cell is handed over
+  pCell->iSeq = (int32_t) (uiPos + 1);
+  return true;
+}
+
+IWelsTask* CWelsTaskQueue::Pop() {
+  STaskCell* pCell = NULL;
+  uint32_t uiPos = (uint32_t)m_iHead;
+
+  while (true) {
+    pCell = &m_sCells[uiPos & (TASK_QUEUE_SIZE - 1)];
+    const int32_t kiDiff = (int32_t) ((uint32_t)pCell->iSeq - (uiPos + 1));
+    if (kiDiff == 0) {
+      const uint32_t kuiCur = (uint32_t)WelsAtomicCompareExchange (&m_iHead, (int32_t) (uiPos + 1), (int32_t)uiPos);
+      if (kuiCur == uiPos) {
+        break;
+      }
+      uiPos = kuiCur;
+    } else if (kiDiff < 0) {
+      return NULL; // empty, or the next cell is not filled yet
+    } else {
+      uiPos = (uint32_t)m_iHead;
+    }
+  }
+
+  IWelsTask* pTask = pCell->pTask;
+  WelsMemoryBarrier(); // the task is read before the cell is recycled
+  pCell->iSeq = (int32_t) (uiPos + TASK_QUEUE_SIZE);
+  return pTask;
+}
+
+///////////////////////////////////thread pool///////////////////////////////////
+CWelsThreadPool::CWelsThreadPool (const int32_t kiPoolSize) :
+  m_iRefCount (0), m_iPoolId (0), m_iPoolSize (kiPoolSize), m_pNextPool (NULL), m_bCpuAffinity (false),
+  m_pThreads (NULL), m_iThreadNum (0), m_pWaitedTasks (NULL), m_cOverflowTasks (NULL), m_iOverflowNum (0),
+  m_iBusyNum (0), m_iWakeUpIdx (0) {
+  memset (m_uiCpuMask, 0, sizeof (m_uiCpuMask));
 }
 
 
 CWelsThreadPool::~CWelsThreadPool() {
-  //fprintf(stdout, "CWelsThreadPool::~CWelsThreadPool: delete %x, %x, %x\n", m_cWaitedTasks, m_cIdleThreads, m_cBusyThreads);
   if (0 != m_iRefCount) {
     m_iRefCount = 0;
     Uninit();
@@ -64,7 +202,7 @@ CWelsThreadPool::~CWelsThreadPool() {
 WELS_THREAD_ERROR_CODE CWelsThreadPool::SetThreadNum (int32_t iMaxThreadNum) {
   CWelsAutoLock  cLock (m_cInitLock);
 
-  if (m_iRefCount != 0) {
+  if (m_pThreadPoolSelf != NULL) {
     return WELS_THREAD_ERROR_GENERAL;
   }
 
@@ -79,13 +217,10 @@ WELS_THREAD_ERROR_CODE CWelsThreadPool::SetThreadNum (int32_t iMaxThreadNum) {
 CWelsThreadPool* CWelsThreadPool::AddReference() {
   CWelsAutoLock  cLock (m_cInitLock);
   if (m_pThreadPoolSelf == NULL) {
-    m_pThreadPoolSelf = new CWelsThreadPool();
+    m_pThreadPoolSelf = new CWelsThreadPool (m_iMaxThreadNum);
     if (!m_pThreadPoolSelf) {
       return NULL;
     }
-  }
-
-  if (m_iRefCount == 0) {
     if (WELS_THREAD_ERROR_OK != m_pThreadPoolSelf->Init()) {
       m_pThreadPoolSelf->Uninit();
       delete m_pThreadPoolSelf;
@@ -94,103 +229,161 @@ CWelsThreadPool* CWelsThreadPool::AddReference() {
     }
   }
 
-  ////fprintf(stdout, "m_iRefCount=%d, iMaxThreadNum=%d\n", m_iRefCount, m_iMaxThreadNum);
-
-  ++ m_iRefCount;
-  //fprintf(stdout, "m_iRefCount2=%d\n", m_iRefCount);
+  ++ m_pThreadPoolSelf->m_iRefCount;
   return m_pThreadPoolSelf;
 }
 
+CWelsThreadPool* CWelsThreadPool::AddReference (const SThreadPoolParam* pParam, const int32_t kiThreadNum) {
+  if (NULL == pParam) {
+    return NULL;
+  }
+
+  CWelsAutoLock  cLock (m_cInitLock);
+  CWelsThreadPool* pPool = NULL;
+  if (0 != pParam->iPoolId) {
+    for (pPool = m_pPrivatePools; NULL != pPool; pPool = pPool->m_pNextPool) {
+      if (pPool->m_iPoolId == pParam->iPoolId) {
+        ++ pPool->m_iRefCount;
+        return pPool;
+      }
+    }
+  }
+
+  pPool = new CWelsThreadPool (WELS_MAX (1, (pParam->iThreadNum > 0) ? pParam->iThreadNum : kiThreadNum));
+  if (NULL == pPool) {
+    return NULL;
+  }
+  pPool->m_iPoolId = pParam->iPoolId;
+  pPool->SetCpuAffinity (pParam);
+  if (WELS_THREAD_ERROR_OK != pPool->Init()) {
+    pPool->Uninit();
+    delete pPool;
+    return NULL;
+  }
+
+  pPool->m_iRefCount = 1;
+  pPool->m_pNextPool = m_pPrivatePools;
+  m_pPrivatePools = pPool;
+  return pPool;
+}
+
 void CWelsThreadPool::RemoveInstance() {
   CWelsAutoLock  cLock (m_cInitLock);
-  //fprintf(stdout, "m_iRefCount=%d\n", m_iRefCount);
   -- m_iRefCount;
   if (0 == m_iRefCount) {
     StopAllRunning();
     Uninit();
-    if (m_pThreadPoolSelf) {
-      delete m_pThreadPoolSelf;
+    if (this == m_pThreadPoolSelf) {
       m_pThreadPoolSelf = NULL;
+    } else {
+      CWelsThreadPool** ppPool = &m_pPrivatePools;
+      while (NULL != *ppPool && this != *ppPool) {
+        ppPool = & (*ppPool)->m_pNextPool;
+      }
+      if (NULL != *ppPool) {
+        *ppPool = m_pNextPool;
+      }
     }
-    //fprintf(stdout, "m_iRefCount=%d, IdleThreadNum=%d, BusyThreadNum=%d, WaitedTask=%d\n", m_iRefCount, GetIdleThreadNum(), GetBusyThreadNum(), GetWaitedTaskNum());
+    delete this;
   }
 }
 
 
 bool CWelsThreadPool::IsReferenced() {
   CWelsAutoLock  cLock (m_cInitLock);
-  return (m_iRefCount > 0);
+  return (m_pThreadPoolSelf != NULL);
+}
+
+void CWelsThreadPool::SetCpuAffinity (const SThreadPoolParam* pParam) {
+  uint64_t uiNodeMask[WELS_CPU_MASK_WORDS];
+  bool bCpuMask = false;
+  int32_t i;
+
+  for (i = 0; i < WELS_CPU_MASK_WORDS; i++) {
+    m_uiCpuMask[i] = pParam->uiCpuMask[i];
+    bCpuMask |= (0 != m_uiCpuMask[i]);
+  }
+  if (pParam->iNumaNode >= 0
+      && WELS_THREAD_ERROR_OK == WelsQueryNumaNodeCpus (pParam->iNumaNode, uiNodeMask, WELS_CPU_MASK_WORDS)) {
+    for (i = 0; i < WELS_CPU_MASK_WORDS; i++) {
+      m_uiCpuMask[i] = bCpuMask ? (m_uiCpuMask[i] & uiNodeMask[i]) : uiNodeMask[i];
+    }
+  }
+
+  m_bCpuAffinity = false;
+  for (i = 0; i < WELS_CPU_MASK_WORDS; i++) {
+    m_bCpuAffinity |= (0 != m_uiCpuMask[i]);
+  }
 }
 
 
+IWelsTask* CWelsThreadPool::FetchTask (CWelsTaskThread* pThread) {
+  if (s_pCurPool != this) {
+    s_iPoolThreadIdx = GetThreadIndex (pThread);
+    if (s_iPoolThreadIdx < 0) {
+      return NULL;
+    }
+    s_pCurPool = this;
+    // the affinity is set by the thread itself before running the first task
+    if (m_bCpuAffinity) {
+      WelsThreadSetAffinity (m_uiCpuMask, WELS_CPU_MASK_WORDS);
+    }
+  }
+  const int32_t kiThreadIdx = s_iPoolThreadIdx;
+
+  IWelsTask* pTask = FindTask (kiThreadIdx);
+  if (NULL == pTask) {
+    // announce the sleeping before checking again, so that any task queued since then signals this thread
+    WelsAtomicExchange (&m_pThreads[kiThreadIdx].iSleeping, 1);
+    pTask = FindTask (kiThreadIdx);
+    if (NULL == pTask) {
+      return NULL;
+    }
+    // a signal is pending already if it fails, which only leads to a spurious wake-up
+    WelsAtomicCompareExchange (&m_pThreads[kiThreadIdx].iSleeping, 0, 1);
+  }
+
+  WelsAtomicAdd (&m_iBusyNum, 1);
+  return pTask;
+}
+
 WELS_THREAD_ERROR_CODE CWelsThreadPool::OnTaskStart (CWelsTaskThread* pThread, IWelsTask* pTask) {
-  AddThreadToBusyList (pThread);
-  //fprintf(stdout, "CWelsThreadPool::AddThreadToBusyList: Task %x at Thread %x\n", pTask, pThread);
   return WELS_THREAD_ERROR_OK;
 }
 
 WELS_THREAD_ERROR_CODE CWelsThreadPool::OnTaskStop (CWelsTaskThread* pThread, IWelsTask* pTask) {
-  //fprintf(stdout, "CWelsThreadPool::OnTaskStop 0: Task %x at Thread %x Finished\n", pTask, pThread);
-
-  RemoveThreadFromBusyList (pThread);
-  AddThreadToIdleQueue (pThread);
-
   if (pTask && pTask->GetSink()) {
-    //fprintf(stdout, "CWelsThreadPool::OnTaskStop 1: Task %x at Thread %x Finished, m_pSink=%x\n", pTask, pThread, pTask->GetSink());
     pTask->GetSink()->OnTaskExecuted();
-    ////fprintf(stdout, "CWelsThreadPool::OnTaskStop 1: Task %x at Thread %x Finished, m_pSink=%x\n", pTask, pThread, pTask->GetSink());
   }
-  //if (m_pSink) {
-  //  m_pSink->OnTaskExecuted (pTask);
-  //}
-  //fprintf(stdout, "CWelsThreadPool::OnTaskStop 2: Task %x at Thread %x Finished\n", pTask, pThread);
-
-  SignalThread();
 
-  //fprintf(stdout, "ThreadPool: Task %x at Thread %x Finished\n", pTask, pThread);
+  WelsAtomicAdd (&m_iBusyNum, -1);
   return WELS_THREAD_ERROR_OK;
 }
 
 WELS_THREAD_ERROR_CODE CWelsThreadPool::Init() {
-  //fprintf(stdout, "Enter WelsThreadPool Init\n");
-
   CWelsAutoLock  cLock (m_cLockPool);
 
-  m_cWaitedTasks = new CWelsNonDuplicatedList<IWelsTask>();
-  m_cIdleThreads = new CWelsNonDuplicatedList<CWelsTaskThread>();
-  m_cBusyThreads = new CWelsList<CWelsTaskThread>();
-  if (NULL == m_cWaitedTasks || NULL == m_cIdleThreads || NULL == m_cBusyThreads) {
-    return WELS_THREAD_ERROR_GENERAL;
-  }
-
-  for (int32_t i = 0; i < m_iMaxThreadNum; i++) {
-    if (WELS_THREAD_ERROR_OK != CreateIdleThread()) {
-      return WELS_THREAD_ERROR_GENERAL;
-    }
-  }
-
-  if (WELS_THREAD_ERROR_OK != Start()) {
+  m_pWaitedTasks = new CWelsTaskQueue();
+  m_cOverflowTasks = new CWelsList<IWelsTask>();
+  m_pThreads = new SPoolThread[m_iPoolSize];
+  if (NULL == m_pWaitedTasks || NULL == m_cOverflowTasks || NULL == m_pThreads) {
     return WELS_THREAD_ERROR_GENERAL;
   }
+  m_iOverflowNum = 0;
+  m_iBusyNum = 0;
+  m_iWakeUpIdx = 0;
 
-  return WELS_THREAD_ERROR_OK;
+  return CreateThreads();
 }
 
 WELS_THREAD_ERROR_CODE CWelsThreadPool::StopAllRunning() {
-  WELS_THREAD_ERROR_CODE iReturn = WELS_THREAD_ERROR_OK;
-
   ClearWaitedTasks();
 
   while (GetBusyThreadNum() > 0) {
-    //WELS_INFO_TRACE ("CWelsThreadPool::Uninit - Waiting all thread to exit");
     WelsSleep (10);
   }
 
-  if (GetIdleThreadNum() != m_iMaxThreadNum) {
-    iReturn = WELS_THREAD_ERROR_GENERAL;
-  }
-
-  return iReturn;
+  return WELS_THREAD_ERROR_OK;
 }
 
 WELS_THREAD_ERROR_CODE CWelsThreadPool::Uninit() {
@@ -202,173 +395,151 @@ WELS_THREAD_ERROR_CODE CWelsThreadPool::Uninit() {
     return iReturn;
   }
 
-  m_cLockIdleTasks.Lock();
-  while (m_cIdleThreads->size() > 0) {
-    DestroyThread (m_cIdleThreads->begin());
-    m_cIdleThreads->pop_front();
-  }
-  m_cLockIdleTasks.Unlock();
-
-  Kill();
+  DestroyThreads();
 
-  WELS_DELETE_OP (m_cWaitedTasks);
-  WELS_DELETE_OP (m_cIdleThreads);
-  WELS_DELETE_OP (m_cBusyThreads);
+  WELS_DELETE_OP (m_pWaitedTasks);
+  WELS_DELETE_OP (m_cOverflowTasks);
 
   return iReturn;
 }
 
-void CWelsThreadPool::ExecuteTask() {
-  //fprintf(stdout, "ThreadPool: scheduled tasks: ExecuteTask\n");
-  CWelsTaskThread* pThread = NULL;
-  IWelsTask*    pTask = NULL;
-  while (GetWaitedTaskNum() > 0) {
-    //fprintf(stdout, "ThreadPool:  ExecuteTask: waiting task %d\n", GetWaitedTaskNum());
-    pThread = GetIdleThread();
-    if (pThread == NULL) {
-      //fprintf(stdout, "ThreadPool:  ExecuteTask: no IdleThread\n");
-
-      break;
-    }
-    pTask = GetWaitedTask();
-    //fprintf(stdout, "ThreadPool:  ExecuteTask = %x at thread %x\n", pTask, pThread);
-    if (pTask) {
-      pThread->SetTask (pTask);
-    } else {
-      AddThreadToIdleQueue (pThread);
+WELS_THREAD_ERROR_CODE CWelsThreadPool::QueueTask (IWelsTask* pTask) {
+  const int32_t kiThreadIdx = s_iPoolThreadIdx;
+
+  if (s_pCurPool == this && kiThreadIdx < m_iThreadNum && m_pThreads[kiThreadIdx].cTasks.Push (pTask)) {
+    // queued by a task running on the pool, kept local unless stolen
+  } else if (0 != m_iOverflowNum || !m_pWaitedTasks->Push (pTask)) {
+    // the overflow is used till drained to keep the order of the tasks
+    CWelsAutoLock  cLock (m_cLockOverflow);
+    if (!m_cOverflowTasks->push_back (pTask)) {
+      return WELS_THREAD_ERROR_GENERAL;
     }
+    WelsAtomicAdd (&m_iOverflowNum, 1);
   }
+
+  WakeUpThread();
+  return WELS_THREAD_ERROR_OK;
 }
 
-WELS_THREAD_ERROR_CODE CWelsThreadPool::QueueTask (IWelsTask* pTask) {
-  CWelsAutoLock  cLock (m_cLockPool);
+WELS_THREAD_ERROR_CODE CWelsThreadPool::CreateThreads() {
+  int32_t i;
 
-  //fprintf(stdout, "CWelsThreadPool::QueueTask: %d, pTask=%x\n", m_iRefCount, pTask);
-  if (GetWaitedTaskNum() == 0) {
-    CWelsTaskThread* pThread = GetIdleThread();
+  for (i = 0; i < m_iPoolSize; i++) {
+    m_pThreads[i].pThread = NULL;
+    m_pThreads[i].iSleeping = 1;
+  }
 
-    if (pThread != NULL) {
-      //fprintf(stdout, "ThreadPool:  ExecuteTask = %x at thread %x\n", pTask, pThread);
-      pThread->SetTask (pTask);
+  for (i = 0; i < m_iPoolSize; i++) {
+    CWelsTaskThread* pThread = new CWelsTaskThread (this);
+    if (NULL == pThread) {
+      return WELS_THREAD_ERROR_GENERAL;
+    }
+    m_pThreads[i].pThread = pThread;
+    m_iThreadNum = i + 1;
 
-      return WELS_THREAD_ERROR_OK;
+    if (WELS_THREAD_ERROR_OK != pThread->Start()) {
+      return WELS_THREAD_ERROR_GENERAL;
     }
   }
-  //fprintf(stdout, "ThreadPool:  AddTaskToWaitedList: %x\n", pTask);
-  if (false == AddTaskToWaitedList (pTask)) {
-    return WELS_THREAD_ERROR_GENERAL;
-  }
 
-  //fprintf(stdout, "ThreadPool:  SignalThread: %x\n", pTask);
-  SignalThread();
   return WELS_THREAD_ERROR_OK;
 }
 
-WELS_THREAD_ERROR_CODE CWelsThreadPool::CreateIdleThread() {
-  CWelsTaskThread* pThread = new CWelsTaskThread (this);
-
-  if (NULL == pThread) {
-    return WELS_THREAD_ERROR_GENERAL;
+void CWelsThreadPool::DestroyThreads() {
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    m_pThreads[i].pThread->Kill();
+    WELS_DELETE_OP (m_pThreads[i].pThread);
   }
+  m_iThreadNum = 0;
 
-  if (WELS_THREAD_ERROR_OK != pThread->Start()) {
-    return WELS_THREAD_ERROR_GENERAL;
+  if (NULL != m_pThreads) {
+    delete [] m_pThreads;
+    m_pThreads = NULL;
   }
-  //fprintf(stdout, "ThreadPool:  AddThreadToIdleQueue: %x\n", pThread);
-  AddThreadToIdleQueue (pThread);
-
-  return WELS_THREAD_ERROR_OK;
 }
 
-void  CWelsThreadPool::DestroyThread (CWelsTaskThread* pThread) {
-  pThread->Kill();
-  WELS_DELETE_OP (pThread);
+IWelsTask* CWelsThreadPool::FindTask (int32_t iThreadIdx) {
+  IWelsTask* pTask = m_pThreads[iThreadIdx].cTasks.Pop();
 
-  return;
-}
+  if (NULL == pTask) {
+    pTask = m_pWaitedTasks->Pop();
+  }
+  if (NULL == pTask && 0 != m_iOverflowNum) {
+    pTask = GetOverflowTask();
+  }
+  for (int32_t i = 1; NULL == pTask && i < m_iThreadNum; i++) {
+    pTask = m_pThreads[ (iThreadIdx + i) % m_iThreadNum].cTasks.Steal();
+  }
 
-WELS_THREAD_ERROR_CODE CWelsThreadPool::AddThreadToIdleQueue (CWelsTaskThread* pThread) {
-  CWelsAutoLock cLock (m_cLockIdleTasks);
-  m_cIdleThreads->push_back (pThread);
-  return WELS_THREAD_ERROR_OK;
+  return pTask;
 }
 
-WELS_THREAD_ERROR_CODE CWelsThreadPool::AddThreadToBusyList (CWelsTaskThread* pThread) {
-  CWelsAutoLock cLock (m_cLockBusyTasks);
-  m_cBusyThreads->push_back (pThread);
-  return WELS_THREAD_ERROR_OK;
-}
+IWelsTask* CWelsThreadPool::GetOverflowTask() {
+  CWelsAutoLock  cLock (m_cLockOverflow);
 
-WELS_THREAD_ERROR_CODE CWelsThreadPool::RemoveThreadFromBusyList (CWelsTaskThread* pThread) {
-  CWelsAutoLock cLock (m_cLockBusyTasks);
-  if (m_cBusyThreads->erase (pThread)) {
-    return WELS_THREAD_ERROR_OK;
-  } else {
-    return WELS_THREAD_ERROR_GENERAL;
+  IWelsTask* pTask = m_cOverflowTasks->begin();
+  if (NULL != pTask) {
+    m_cOverflowTasks->pop_front();
+    WelsAtomicAdd (&m_iOverflowNum, -1);
   }
+  return pTask;
 }
 
-bool  CWelsThreadPool::AddTaskToWaitedList (IWelsTask* pTask) {
-  CWelsAutoLock  cLock (m_cLockWaitedTasks);
+void CWelsThreadPool::WakeUpThread() {
+  WelsMemoryBarrier(); // the task queued is visible before the sleeping flags are read
 
-  return m_cWaitedTasks->push_back (pTask);
-}
+  // the start is only a hint to spread the tasks, no matter if it is raced
+  const int32_t kiStart = (int32_t) ((uint32_t)m_iWakeUpIdx % (uint32_t)m_iThreadNum);
+  m_iWakeUpIdx = kiStart + 1;
 
-CWelsTaskThread*   CWelsThreadPool::GetIdleThread() {
-  CWelsAutoLock cLock (m_cLockIdleTasks);
-
-  if (NULL == m_cIdleThreads || m_cIdleThreads->size() == 0) {
-    return NULL;
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    SPoolThread* pPoolThread = &m_pThreads[ (kiStart + i) % m_iThreadNum];
+    if (0 != pPoolThread->iSleeping && 1 == WelsAtomicCompareExchange (&pPoolThread->iSleeping, 0, 1)) {
+      pPoolThread->pThread->Signal();
+      return;
+    }
   }
-
-  //fprintf(stdout, "CWelsThreadPool::GetIdleThread=%d\n", m_cIdleThreads->size());
-
-  CWelsTaskThread* pThread = m_cIdleThreads->begin();
-  m_cIdleThreads->pop_front();
-  return pThread;
-}
-
-int32_t  CWelsThreadPool::GetBusyThreadNum() {
-  return (m_cBusyThreads?m_cBusyThreads->size():0);
+  // all the threads are busy, one of them will find the task before sleeping
 }
 
-int32_t  CWelsThreadPool::GetIdleThreadNum() {
-  return (m_cIdleThreads?m_cIdleThreads->size():0);
+int32_t CWelsThreadPool::GetThreadIndex (CWelsTaskThread* pThread) {
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    if (m_pThreads[i].pThread == pThread) {
+      return i;
+    }
+  }
+  return -1;
 }
 
-int32_t  CWelsThreadPool::GetWaitedTaskNum() {
-  return (m_cWaitedTasks?m_cWaitedTasks->size():0);
+int32_t  CWelsThreadPool::GetBusyThreadNum() {
+  return m_iBusyNum;
 }
 
-IWelsTask* CWelsThreadPool::GetWaitedTask() {
-  CWelsAutoLock lock (m_cLockWaitedTasks);
+void  CWelsThreadPool::ClearWaitedTasks() {
+  IWelsTask* pTask = NULL;
 
-  if (NULL==m_cWaitedTasks || m_cWaitedTasks->size() == 0) {
-    return NULL;
+  if (NULL != m_pWaitedTasks) {
+    while (NULL != (pTask = m_pWaitedTasks->Pop())) {
+      if (pTask->GetSink()) {
+        pTask->GetSink()->OnTaskCancelled();
+      }
+    }
   }
-
-  IWelsTask* pTask = m_cWaitedTasks->begin();
-
-  m_cWaitedTasks->pop_front();
-
-  return pTask;
-}
-
-void  CWelsThreadPool::ClearWaitedTasks() {
-  CWelsAutoLock cLock (m_cLockWaitedTasks);
-  if (NULL == m_cWaitedTasks) {
-    return;
+  if (NULL != m_cOverflowTasks) {
+    while (NULL != (pTask = GetOverflowTask())) {
+      if (pTask->GetSink()) {
+        pTask->GetSink()->OnTaskCancelled();
+      }
+    }
   }
-  IWelsTask* pTask = NULL;
-  while (0 != m_cWaitedTasks->size()) {
-    pTask = m_cWaitedTasks->begin();
-    if (pTask->GetSink()) {
-      pTask->GetSink()->OnTaskCancelled();
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    while (NULL != (pTask = m_pThreads[i].cTasks.Steal())) {
+      if (pTask->GetSink()) {
+        pTask->GetSink()->OnTaskCancelled();
+      }
     }
-    m_cWaitedTasks->pop_front();
   }
 }
 
 }
 
-
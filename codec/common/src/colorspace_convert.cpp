@@ -0,0 +1,242 @@
+/*!
+ * \copy
+ *     Copyright (c)  2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    colorspace_convert.cpp
+ *
+ * \brief   Conversion of NV12 and 32 bit RGB source pictures into I420
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include <string.h>
+#include "colorspace_convert.h"
+#include "cpu_core.h"
+
+namespace {
+
+// Y, U and V weights of the bytes of a pixel in memory order, twice, for BGRA, RGBA, ARGB and ABGR
+const int16_t g_kiRgb32Coeff[4][3][8] = {
+  {
+    {  25, 129,  66,   0,  25, 129,  66,   0 },
+    { 112, -74, -38,   0, 112, -74, -38,   0 },
+    { -18, -94, 112,   0, -18, -94, 112,   0 }
+  }, {
+    {  66, 129,  25,   0,  66, 129,  25,   0 },
+    { -38, -74, 112,   0, -38, -74, 112,   0 },
+    { 112, -94, -18,   0, 112, -94, -18,   0 }
+  }, {
+    {   0,  66, 129,  25,   0,  66, 129,  25 },
+    {   0, -38, -74, 112,   0, -38, -74, 112 },
+    {   0, 112, -94, -18,   0, 112, -94, -18 }
+  }, {
+    {   0,  25, 129,  66,   0,  25, 129,  66 },
+    {   0, 112, -74, -38,   0, 112, -74, -38 },
+    {   0, -18, -94, 112,   0, -18, -94, 112 }
+  }
+};
+
+const int16_t* GetRgb32Coeff (const int32_t kiFormat) {
+  switch (kiFormat) {
+  case videoFormatBGRA:
+    return &g_kiRgb32Coeff[0][0][0];
+  case videoFormatRGBA:
+    return &g_kiRgb32Coeff[1][0][0];
+  case videoFormatARGB:
+    return &g_kiRgb32Coeff[2][0][0];
+  case videoFormatABGR:
+    return &g_kiRgb32Coeff[3][0][0];
+  default:
+    return NULL;
+  }
+}
+
+inline int32_t Avg2 (const int32_t kiA, const int32_t kiB) {
+  return (kiA + kiB + 1) >> 1;
+}
+
+// the simd kernels take whole blocks of kiBlock samples, the c version the rest of the row
+template<PSplitUVRowFunc pfSplitUVRow, int32_t kiBlock>
+void WelsSplitUVRow_ (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth) {
+  const int32_t kiBulk = iWidth & ~ (kiBlock - 1);
+  if (kiBulk > 0)
+    pfSplitUVRow (pDstU, pDstV, kpSrcUV, kiBulk);
+  WelsSplitUVRow_c (pDstU + kiBulk, pDstV + kiBulk, kpSrcUV + 2 * kiBulk, iWidth - kiBulk);
+}
+
+template<PRgb32ToYRowFunc pfRgb32ToYRow, int32_t kiBlock>
+void WelsRgb32ToYRow_ (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff) {
+  const int32_t kiBulk = iWidth & ~ (kiBlock - 1);
+  if (kiBulk > 0)
+    pfRgb32ToYRow (pDstY, kpSrc, kiBulk, kpCoeff);
+  WelsRgb32ToYRow_c (pDstY + kiBulk, kpSrc + 4 * kiBulk, iWidth - kiBulk, kpCoeff);
+}
+
+template<PRgb32ToUVRowFunc pfRgb32ToUVRow, int32_t kiBlock>
+void WelsRgb32ToUVRow_ (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                        int32_t iWidth, const int16_t* kpCoeff) {
+  const int32_t kiBulk = iWidth & ~ (kiBlock - 1);
+  if (kiBulk > 0)
+    pfRgb32ToUVRow (pDstU, pDstV, kpSrc0, kpSrc1, kiBulk, kpCoeff);
+  WelsRgb32ToUVRow_c (pDstU + kiBulk, pDstV + kiBulk, kpSrc0 + 8 * kiBulk, kpSrc1 + 8 * kiBulk, iWidth - kiBulk,
+                      kpCoeff);
+}
+
+} // anon ns.
+
+void WelsSplitUVRow_c (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth) {
+  for (int32_t i = 0; i < iWidth; i++) {
+    pDstU[i] = kpSrcUV[2 * i];
+    pDstV[i] = kpSrcUV[2 * i + 1];
+  }
+}
+
+void WelsRgb32ToYRow_c (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff) {
+  for (int32_t i = 0; i < iWidth; i++, kpSrc += 4) {
+    pDstY[i] = (kpCoeff[0] * kpSrc[0] + kpCoeff[1] * kpSrc[1] + kpCoeff[2] * kpSrc[2] + kpCoeff[3] * kpSrc[3] +
+                0x1080) >> 8;
+  }
+}
+
+void WelsRgb32ToUVRow_c (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+                         int32_t iWidth, const int16_t* kpCoeff) {
+  for (int32_t i = 0; i < iWidth; i++, kpSrc0 += 8, kpSrc1 += 8) {
+    int32_t iSumU = 0x8080;
+    int32_t iSumV = 0x8080;
+    for (int32_t j = 0; j < 4; j++) {
+      const int32_t kiAvg = Avg2 (Avg2 (kpSrc0[j], kpSrc1[j]), Avg2 (kpSrc0[4 + j], kpSrc1[4 + j]));
+      iSumU += kpCoeff[j] * kiAvg;
+      iSumV += kpCoeff[8 + j] * kiAvg;
+    }
+    pDstU[i] = iSumU >> 8;
+    pDstV[i] = iSumV >> 8;
+  }
+}
+
+void InitColorspaceConvertFunc (SColorspaceConvertFunc* pFuncs, const uint32_t kuiCpuFlag) {
+  // the kernels of InitColorspaceConvertVectorFunc() are left out till test/common/ColorspaceConvert.cpp passes with
+  // them on SSE2, AVX2 and NEON hosts
+  pFuncs->pfSplitUVRow   = WelsSplitUVRow_c;
+  pFuncs->pfRgb32ToYRow  = WelsRgb32ToYRow_c;
+  pFuncs->pfRgb32ToUVRow = WelsRgb32ToUVRow_c;
+}
+
+void InitColorspaceConvertVectorFunc (SColorspaceConvertFunc* pFuncs, const uint32_t kuiCpuFlag) {
+  InitColorspaceConvertFunc (pFuncs, kuiCpuFlag);
+
+#if defined(X86_ASM)
+  if (kuiCpuFlag & WELS_CPU_SSE2) {
+    pFuncs->pfSplitUVRow   = WelsSplitUVRow_<WelsSplitUVRow_sse2, 16>;
+    pFuncs->pfRgb32ToYRow  = WelsRgb32ToYRow_<WelsRgb32ToYRow_sse2, 8>;
+    pFuncs->pfRgb32ToUVRow = WelsRgb32ToUVRow_<WelsRgb32ToUVRow_sse2, 4>;
+  }
+#ifdef HAVE_AVX2
+  if (kuiCpuFlag & WELS_CPU_AVX2) {
+    pFuncs->pfSplitUVRow   = WelsSplitUVRow_<WelsSplitUVRow_avx2, 32>;
+  }
+#endif
+#endif//X86_ASM
+
+#if defined(HAVE_NEON_AARCH64)
+  if (kuiCpuFlag & WELS_CPU_NEON) {
+    pFuncs->pfSplitUVRow   = WelsSplitUVRow_<WelsSplitUVRow_AArch64_neon, 16>;
+    pFuncs->pfRgb32ToYRow  = WelsRgb32ToYRow_<WelsRgb32ToYRow_AArch64_neon, 16>;
+    pFuncs->pfRgb32ToUVRow = WelsRgb32ToUVRow_<WelsRgb32ToUVRow_AArch64_neon, 8>;
+  }
+#endif//HAVE_NEON_AARCH64
+}
+
+bool WelsCanConvertToI420 (const int32_t kiColorFormat) {
+  const int32_t kiFormat = kiColorFormat & (~videoFormatVFlip);
+  return videoFormatNV12 == kiFormat || NULL != GetRgb32Coeff (kiFormat);
+}
+
+int32_t WelsConvertToI420 (const SColorspaceConvertFunc* kpFuncs, const SSourcePicture* kpSrc, int32_t iLeft,
+                           int32_t iTop, int32_t iWidth, int32_t iHeight, uint8_t* pDst[3], const int32_t kiDstStride[3]) {
+  const int32_t kiFormat = kpSrc->iColorFormat & (~videoFormatVFlip);
+  const bool kbVFlip     = (kpSrc->iColorFormat & videoFormatVFlip) != 0;
+  const int16_t* kpCoeff = GetRgb32Coeff (kiFormat);
+  if (videoFormatNV12 != kiFormat && NULL == kpCoeff)
+    return 1;
+
+  iLeft   &= ~1;
+  iTop    &= ~1;
+  iWidth  &= ~1;
+  iHeight &= ~1;
+  const int32_t kiRowBytes = (videoFormatNV12 == kiFormat) ? iLeft + iWidth : (iLeft + iWidth) << 2;
+  if (NULL == kpSrc->pData[0] || kpSrc->iStride[0] < kiRowBytes)
+    return 1;
+  if (videoFormatNV12 == kiFormat && (NULL == kpSrc->pData[1] || kpSrc->iStride[1] < iLeft + iWidth))
+    return 1;
+  if (kiDstStride[0] < iWidth || kiDstStride[1] < (iWidth >> 1) || kiDstStride[2] < (iWidth >> 1))
+    return 1;
+
+  uint8_t* pDstY = pDst[0];
+  uint8_t* pDstU = pDst[1];
+  uint8_t* pDstV = pDst[2];
+  // the rows of the area top down, they are stored bottom up with videoFormatVFlip
+  const int32_t kiSrcStride = kbVFlip ? -kpSrc->iStride[0] : kpSrc->iStride[0];
+  const uint8_t* pSrc = kpSrc->pData[0] + (kbVFlip ? kpSrc->iPicHeight - 1 - iTop : iTop) * kpSrc->iStride[0];
+
+  if (videoFormatNV12 == kiFormat) {
+    const int32_t kiChromaHeight = (kpSrc->iPicHeight + 1) >> 1;
+    const int32_t kiSrcStrideUV  = kbVFlip ? -kpSrc->iStride[1] : kpSrc->iStride[1];
+    const uint8_t* pSrcUV = kpSrc->pData[1] + (kbVFlip ? kiChromaHeight - 1 - (iTop >> 1) : iTop >> 1) *
+                            kpSrc->iStride[1] + iLeft;
+    pSrc += iLeft;
+    for (int32_t i = 0; i < iHeight; i++) {
+      memcpy (pDstY, pSrc, iWidth);
+      pDstY += kiDstStride[0];
+      pSrc  += kiSrcStride;
+    }
+    for (int32_t i = 0; i < (iHeight >> 1); i++) {
+      kpFuncs->pfSplitUVRow (pDstU, pDstV, pSrcUV, iWidth >> 1);
+      pDstU  += kiDstStride[1];
+      pDstV  += kiDstStride[2];
+      pSrcUV += kiSrcStrideUV;
+    }
+    return 0;
+  }
+
+  // each pair of rows is read once for both luma and chroma
+  pSrc += iLeft << 2;
+  for (int32_t i = 0; i < iHeight; i += 2) {
+    kpFuncs->pfRgb32ToYRow (pDstY, pSrc, iWidth, kpCoeff);
+    kpFuncs->pfRgb32ToYRow (pDstY + kiDstStride[0], pSrc + kiSrcStride, iWidth, kpCoeff);
+    kpFuncs->pfRgb32ToUVRow (pDstU, pDstV, pSrc, pSrc + kiSrcStride, iWidth >> 1, kpCoeff + 8);
+    pDstY += kiDstStride[0] << 1;
+    pDstU += kiDstStride[1];
+    pDstV += kiDstStride[2];
+    pSrc  += kiSrcStride << 1;
+  }
+  return 0;
+}
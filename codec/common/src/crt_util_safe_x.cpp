@@ -249,6 +249,10 @@ char* WelsStrcat (char* pDest, uint32_t uiSizeInBytes, const char* kpSrc) {
   return pDest;
 }
 
+int32_t WelsFread (void* pBuffer, int32_t iSize, int32_t iCount, WelsFileHandle* pFp) {
+  return (int32_t)fread (pBuffer, iSize, iCount, pFp);
+}
+
 int32_t WelsFwrite (const void* kpBuffer, int32_t iSize, int32_t iCount, WelsFileHandle* pFp) {
   return (int32_t)fwrite (kpBuffer, iSize, iCount, pFp);
 }
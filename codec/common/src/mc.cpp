@@ -377,6 +377,27 @@ void McChroma_c (const uint8_t* pSrc, int32_t iSrcStride, uint8_t* pDst, int32_t
     McChromaWithFragMv_c (pSrc, iSrcStride, pDst, iDstStride, iMvX, iMvY, iWidth, iHeight);
 }
 
+void WeightedPred_c (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight, int32_t iOffset,
+                     int32_t iWidth, int32_t iHeight) {
+  int32_t i, j;
+  if (iLog2Denom >= 1) {
+    const int32_t kiRound = 1 << (iLog2Denom - 1);
+    for (i = 0; i < iHeight; i++) {
+      for (j = 0; j < iWidth; j++) {
+        pDst[j] = WelsClip1 (((pDst[j] * iWeight + kiRound) >> iLog2Denom) + iOffset);
+      }
+      pDst += iDstStride;
+    }
+  } else {
+    for (i = 0; i < iHeight; i++) {
+      for (j = 0; j < iWidth; j++) {
+        pDst[j] = WelsClip1 (pDst[j] * iWeight + iOffset);
+      }
+      pDst += iDstStride;
+    }
+  }
+}
+
 #if defined(X86_ASM)
 //***************************************************************************//
 //                       SSE2 implement                          //
@@ -1668,6 +1689,7 @@ void WelsCommon::InitMcFunc (SMcFunc* pMcFuncs, uint32_t uiCpuFlag) {
   pMcFuncs->pfSampleAveraging = PixelAvg_c;
   pMcFuncs->pMcChromaFunc     = McChroma_c;
   pMcFuncs->pMcLumaFunc       = McLuma_c;
+  pMcFuncs->pfWeightedPred    = WeightedPred_c;
 
 #if defined (X86_ASM)
   if (uiCpuFlag & WELS_CPU_SSE2) {
@@ -1692,6 +1714,8 @@ void WelsCommon::InitMcFunc (SMcFunc* pMcFuncs, uint32_t uiCpuFlag) {
     pMcFuncs->pfLumaHalfpelVer  = McHorVer02_avx2;
     pMcFuncs->pfLumaHalfpelCen  = McHorVer22Width5Or9Or17_avx2;
     pMcFuncs->pMcLumaFunc       = McLuma_avx2;
+    // WeightedPredWidthEq*_sse2/_avx2 and McChromaWidthEq8_avx2 are left out of the dispatch till the asm is assembled
+    // and McWeightedPred.X86Kernels passes on SSE2 and AVX2 hosts
   }
 #endif
 #endif //(X86_ASM)
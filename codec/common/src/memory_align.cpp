@@ -32,6 +32,9 @@
 
 #include <stdlib.h>
 #include <string.h>
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
 #include "memory_align.h"
 #include "macros.h"
 
@@ -44,26 +47,61 @@ static int32_t  g_iMemoryLength;
 #endif
 
 
-CMemoryAlign::CMemoryAlign (const uint32_t kuiCacheLineSize)
-#ifdef MEMORY_MONITOR
-  : m_nMemoryUsageInBytes (0)
-#endif//MEMORY_MONITOR
-{
+// block layout: [padding][block info, CMemoryAlign only][payload size][malloc'ed buffer or arena region][payload]
+#define MEMORY_BLOCK_INFO_SIZE          ((int32_t) sizeof (uint32_t))
+#define MEMORY_BLOCK_HEADER_SIZE        (sizeof (void**) + sizeof (int32_t) + MEMORY_BLOCK_INFO_SIZE)
+#define MEMORY_BLOCK_ARENA              0x80000000      // block carved from an arena region, otherwise the tag index
+#define MEMORY_BLOCK_SIZE(p)            (* ((int32_t*) ((uint8_t*) (p) - sizeof (void**) - sizeof (int32_t))))
+#define MEMORY_BLOCK_INFO(p)            (* ((uint32_t*) ((uint8_t*) (p) - MEMORY_BLOCK_HEADER_SIZE)))
+#define MEMORY_BLOCK_ORIGIN(p)          (* (((void**) (p)) - 1))
+
+#define MIN_MEMORY_REGION_SIZE          (64 << 10)
+#define MAX_MEMORY_REGION_SIZE          (1 << 30)
+#define HUGE_PAGE_SIZE                  (2 << 20)
+
+CMemoryAlign::CMemoryAlign (const uint32_t kuiCacheLineSize) {
+  Init (kuiCacheLineSize, 0, false);
+}
+
+CMemoryAlign::CMemoryAlign (const uint32_t kuiCacheLineSize, const uint32_t kuiRegionSize, const bool kbHugePages) {
+  Init (kuiCacheLineSize, kuiRegionSize, kbHugePages);
+}
+
+void CMemoryAlign::Init (const uint32_t kuiCacheLineSize, const uint32_t kuiRegionSize, const bool kbHugePages) {
   if ((kuiCacheLineSize == 0) || (kuiCacheLineSize & 0x0f))
     m_nCacheLineSize = 0x10;
   else
     m_nCacheLineSize = kuiCacheLineSize;
+
+#ifdef MEMORY_MONITOR
+  m_nMemoryUsageInBytes     = 0;
+  m_nPeakMemoryUsageInBytes = 0;
+  memset (m_sTags, 0, sizeof (m_sTags));
+  strcpy (m_sTags[0].sTag, "others");
+  m_iTagNum                 = 1;
+  memset (m_iTagHash, 0, sizeof (m_iTagHash));
+#endif//MEMORY_MONITOR
+
+  m_nRegionSize = (kuiRegionSize > 0) ? WELS_CLIP3 (kuiRegionSize, MIN_MEMORY_REGION_SIZE, MAX_MEMORY_REGION_SIZE) : 0;
+  m_bHugePages  = kbHugePages;
+  m_pRegions    = NULL;
+  m_nArenaBytes = 0;
+  m_iRegionNum  = 0;
+  WelsMutexInit (&m_hMutex);
 }
 
 CMemoryAlign::~CMemoryAlign() {
 #ifdef MEMORY_MONITOR
   assert (m_nMemoryUsageInBytes == 0);
 #endif//MEMORY_MONITOR
+  while (NULL != m_pRegions)
+    ReleaseRegion (m_pRegions);
+  WelsMutexDestroy (&m_hMutex);
 }
 
-void* WelsMalloc (const uint32_t kuiSize, const char* kpTag, const uint32_t kiAlign) {
+void* WelsMalloc (const uint32_t kuiSize, const char* kpTag, const uint32_t kiAlign, const int32_t kiInfoSize) {
   const int32_t kiSizeOfVoidPointer     = sizeof (void**);
-  const int32_t kiSizeOfInt             = sizeof (int32_t);
+  const int32_t kiSizeOfInt             = sizeof (int32_t) + kiInfoSize;
   const int32_t kiAlignedBytes          = kiAlign - 1;
   const int32_t kiTrialRequestedSize    = kuiSize + kiAlignedBytes + kiSizeOfVoidPointer + kiSizeOfInt;
   const int32_t kiActualRequestedSize   = kiTrialRequestedSize;
@@ -93,7 +131,7 @@ void* WelsMalloc (const uint32_t kuiSize, const char* kpTag, const uint32_t kiAl
   pAlignedBuffer = pBuf + kiAlignedBytes + kiSizeOfVoidPointer + kiSizeOfInt;
   pAlignedBuffer -= ((uintptr_t) pAlignedBuffer & kiAlignedBytes);
   * ((void**) (pAlignedBuffer - kiSizeOfVoidPointer)) = pBuf;
-  * ((int32_t*) (pAlignedBuffer - (kiSizeOfVoidPointer + kiSizeOfInt))) = kiPayloadSize;
+  * ((int32_t*) (pAlignedBuffer - (kiSizeOfVoidPointer + sizeof (int32_t)))) = kiPayloadSize;
 
   return pAlignedBuffer;
 }
@@ -126,36 +164,169 @@ void* CMemoryAlign::WelsMallocz (const uint32_t kuiSize, const char* kpTag) {
 }
 
 void* CMemoryAlign::WelsMalloc (const uint32_t kuiSize, const char* kpTag) {
-  void* pPointer = WelsCommon::WelsMalloc (kuiSize, kpTag, m_nCacheLineSize);
+  uint8_t* pPointer = NULL;
+  uint32_t uiInfo = 0;
+  WelsMutexLock (&m_hMutex);
+  if ((m_nRegionSize > 0) && (kuiSize <= (m_nRegionSize >> 2))) {
+    pPointer = CarveFromArena (kuiSize);
+    uiInfo = (NULL != pPointer) ? MEMORY_BLOCK_ARENA : 0;
+  }
+  if (NULL == pPointer)
+    pPointer = (uint8_t*) WelsCommon::WelsMalloc (kuiSize, kpTag, m_nCacheLineSize, MEMORY_BLOCK_INFO_SIZE);
+  if (NULL == pPointer) {
+    WelsMutexUnlock (&m_hMutex);
+    return NULL;
+  }
 #ifdef MEMORY_MONITOR
-  if (pPointer != NULL) {
-    const int32_t kiMemoryLength = * ((int32_t*) ((uint8_t*)pPointer - sizeof (void**) - sizeof (
-                                        int32_t))) + m_nCacheLineSize - 1 + sizeof (void**) + sizeof (int32_t);
-    m_nMemoryUsageInBytes += kiMemoryLength;
+  const int32_t kiTagIdx = FindTag (kpTag);
+  const int32_t kiMemoryLength = kuiSize + m_nCacheLineSize - 1 + MEMORY_BLOCK_HEADER_SIZE;
+  SMemoryTagEntry* pTag = &m_sTags[kiTagIdx];
+  pTag->uiBytes += kiMemoryLength;
+  pTag->uiPeakBytes = WELS_MAX (pTag->uiPeakBytes, pTag->uiBytes);
+  ++ pTag->uiBlockNum;
+  m_nMemoryUsageInBytes += kiMemoryLength;
+  m_nPeakMemoryUsageInBytes = WELS_MAX (m_nPeakMemoryUsageInBytes, m_nMemoryUsageInBytes);
+  uiInfo |= kiTagIdx;
 #ifdef MEMORY_CHECK
-    g_iMemoryLength = kiMemoryLength;
+  g_iMemoryLength = kiMemoryLength;
 #endif
-  }
 #endif//MEMORY_MONITOR
+  MEMORY_BLOCK_INFO (pPointer) = uiInfo;
+  WelsMutexUnlock (&m_hMutex);
   return pPointer;
 }
 
 void CMemoryAlign::WelsFree (void* pPointer, const char* kpTag) {
+  if (NULL == pPointer)
+    return;
+  WelsMutexLock (&m_hMutex);
+  const uint32_t kuiInfo = MEMORY_BLOCK_INFO (pPointer);
 #ifdef MEMORY_MONITOR
-  if (pPointer) {
-    const int32_t kiMemoryLength = * ((int32_t*) ((uint8_t*)pPointer - sizeof (void**) - sizeof (
-                                        int32_t))) + m_nCacheLineSize - 1 + sizeof (void**) + sizeof (int32_t);
-    m_nMemoryUsageInBytes -= kiMemoryLength;
+  const int32_t kiMemoryLength = MEMORY_BLOCK_SIZE (pPointer) + m_nCacheLineSize - 1 + MEMORY_BLOCK_HEADER_SIZE;
+  SMemoryTagEntry* pTag = &m_sTags[kuiInfo & ~MEMORY_BLOCK_ARENA];
+  pTag->uiBytes -= kiMemoryLength;
+  -- pTag->uiBlockNum;
+  m_nMemoryUsageInBytes -= kiMemoryLength;
 #ifdef MEMORY_CHECK
-    g_iMemoryLength = kiMemoryLength;
+  g_iMemoryLength = kiMemoryLength;
 #endif
-  }
 #endif//MEMORY_MONITOR
-  WelsCommon::WelsFree (pPointer, kpTag);
+  if (kuiInfo & MEMORY_BLOCK_ARENA) {
+    SMemoryRegion* pRegion = (SMemoryRegion*) MEMORY_BLOCK_ORIGIN (pPointer);
+    if (0 == -- pRegion->iBlockNum) {
+      if (pRegion == m_pRegions)
+        pRegion->uiUsed = sizeof (SMemoryRegion); // still carved, from the start again
+      else
+        ReleaseRegion (pRegion);
+    }
+  } else {
+    WelsCommon::WelsFree (pPointer, kpTag);
+  }
+  WelsMutexUnlock (&m_hMutex);
 }
 
+uint8_t* CMemoryAlign::CarveFromArena (const uint32_t kuiSize) {
+  const uintptr_t kuiAlignMask = m_nCacheLineSize - 1;
+  SMemoryRegion* pRegion = m_pRegions;
+  for (int32_t i = 0; i < 2; i++) {
+    if (NULL != pRegion) {
+      uintptr_t uiPointer = (uintptr_t) pRegion + pRegion->uiUsed + MEMORY_BLOCK_HEADER_SIZE;
+      uiPointer = (uiPointer + kuiAlignMask) & ~kuiAlignMask;
+      const uint32_t kuiEnd = (uint32_t) (uiPointer - (uintptr_t) pRegion) + kuiSize;
+      if (kuiEnd <= pRegion->uiSize) {
+        uint8_t* pPointer = (uint8_t*) uiPointer;
+        pRegion->uiUsed = kuiEnd;
+        ++ pRegion->iBlockNum;
+        MEMORY_BLOCK_ORIGIN (pPointer) = pRegion;
+        MEMORY_BLOCK_SIZE (pPointer) = kuiSize;
+        return pPointer;
+      }
+    }
+    // the region full is left to be released with its last block
+    pRegion = AddRegion();
+  }
+  return NULL;
+}
+
+SMemoryRegion* CMemoryAlign::AddRegion() {
+  uint32_t uiSize = m_nRegionSize;
+  SMemoryRegion* pRegion = NULL;
+  bool bMapped = false;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (m_bHugePages) {
+    // map one more huge page to trim the region to the huge page boundaries, where the huge pages can be used
+    uiSize = WELS_ALIGN (m_nRegionSize, HUGE_PAGE_SIZE);
+    uint8_t* pMap = (uint8_t*) mmap (NULL, uiSize + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                                     -1, 0);
+    if (MAP_FAILED != pMap) {
+      uint8_t* pStart = (uint8_t*) WELS_ALIGN ((uintptr_t) pMap, HUGE_PAGE_SIZE);
+      if (pStart > pMap)
+        munmap (pMap, pStart - pMap);
+      munmap (pStart + uiSize, pMap + HUGE_PAGE_SIZE - pStart);
+      madvise (pStart, uiSize, MADV_HUGEPAGE);
+      pRegion = (SMemoryRegion*) pStart;
+      bMapped = true;
+    }
+  }
+#endif
+  if (NULL == pRegion) {
+    uiSize = m_nRegionSize;
+    pRegion = (SMemoryRegion*) malloc (uiSize);
+    if (NULL == pRegion)
+      return NULL;
+  }
+  pRegion->uiSize       = uiSize;
+  pRegion->uiUsed       = sizeof (SMemoryRegion);
+  pRegion->iBlockNum    = 0;
+  pRegion->bMapped      = bMapped;
+  pRegion->pNext        = m_pRegions;
+  m_pRegions            = pRegion;
+  m_nArenaBytes        += uiSize;
+  ++ m_iRegionNum;
+  return pRegion;
+}
+
+void CMemoryAlign::ReleaseRegion (SMemoryRegion* pRegion) {
+  SMemoryRegion** ppLink = &m_pRegions;
+  while (*ppLink != pRegion)
+    ppLink = & (*ppLink)->pNext;
+  *ppLink = pRegion->pNext;
+  m_nArenaBytes -= pRegion->uiSize;
+  -- m_iRegionNum;
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (pRegion->bMapped) {
+    munmap (pRegion, pRegion->uiSize);
+    return;
+  }
+#endif
+  free (pRegion);
+}
+
+#ifdef MEMORY_MONITOR
+int32_t CMemoryAlign::FindTag (const char* kpTag) {
+  if (NULL == kpTag)
+    return 0;
+  // names are copied since the tags are not always literals, FNV-1a hash of the name as far as it is kept
+  uint32_t uiHash = 2166136261u;
+  for (int32_t i = 0; i < MEMORY_TAG_NAME_LEN - 1 && kpTag[i]; i++)
+    uiHash = (uiHash ^ (uint8_t) kpTag[i]) * 16777619u;
+  uint32_t uiSlot = uiHash & (MEMORY_TAG_HASH_SIZE - 1);
+  while (0 != m_iTagHash[uiSlot]) {
+    const int32_t kiTagIdx = m_iTagHash[uiSlot];
+    if (0 == strncmp (m_sTags[kiTagIdx].sTag, kpTag, MEMORY_TAG_NAME_LEN - 1))
+      return kiTagIdx;
+    uiSlot = (uiSlot + 1) & (MEMORY_TAG_HASH_SIZE - 1);
+  }
+  if (m_iTagNum >= MAX_MEMORY_TAG_NUM)
+    return 0;
+  strncpy (m_sTags[m_iTagNum].sTag, kpTag, MEMORY_TAG_NAME_LEN - 1);
+  m_iTagHash[uiSlot] = m_iTagNum;
+  return m_iTagNum++;
+}
+#endif//MEMORY_MONITOR
+
 void* WelsMallocz (const uint32_t kuiSize, const char* kpTag) {
-  void* pPointer = WelsMalloc (kuiSize, kpTag, 16);
+  void* pPointer = WelsMalloc (kuiSize, kpTag, 16, 0);
   if (NULL == pPointer) {
     return NULL;
   }
@@ -171,4 +342,24 @@ const uint32_t CMemoryAlign::WelsGetMemoryUsage() const {
   return m_nMemoryUsageInBytes;
 }
 
+void CMemoryAlign::WelsGetTagUsage (SMemoryUsage* pUsage) {
+  memset (pUsage, 0, sizeof (SMemoryUsage));
+  WelsMutexLock (&m_hMutex);
+#ifdef MEMORY_MONITOR
+  pUsage->uiTotalBytes  = m_nMemoryUsageInBytes;
+  pUsage->uiPeakBytes   = m_nPeakMemoryUsageInBytes;
+  pUsage->iTagNum       = m_iTagNum;
+  for (int32_t i = 0; i < m_iTagNum; i++) {
+    SMemoryTagUsage* pTagUsage = &pUsage->sTagUsage[i];
+    memcpy (pTagUsage->sTag, m_sTags[i].sTag, MEMORY_TAG_NAME_LEN);
+    pTagUsage->uiBytes      = m_sTags[i].uiBytes;
+    pTagUsage->uiPeakBytes  = m_sTags[i].uiPeakBytes;
+    pTagUsage->uiBlockNum   = m_sTags[i].uiBlockNum;
+  }
+#endif//MEMORY_MONITOR
+  pUsage->uiArenaBytes  = m_nArenaBytes;
+  pUsage->iRegionNum    = m_iRegionNum;
+  WelsMutexUnlock (&m_hMutex);
+}
+
 } // end of namespace WelsCommon
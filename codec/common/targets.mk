@@ -1,5 +1,6 @@
 COMMON_SRCDIR=codec/common
 COMMON_CPP_SRCS=\
+	$(COMMON_SRCDIR)/src/colorspace_convert.cpp\
 	$(COMMON_SRCDIR)/src/common_tables.cpp\
 	$(COMMON_SRCDIR)/src/copy_mb.cpp\
 	$(COMMON_SRCDIR)/src/cpu.cpp\
@@ -20,6 +21,7 @@ COMMON_CPP_SRCS=\
 COMMON_OBJS += $(COMMON_CPP_SRCS:.cpp=.$(OBJ))
 
 COMMON_ASM_SRCS=\
+	$(COMMON_SRCDIR)/x86/colorspace_convert.asm\
 	$(COMMON_SRCDIR)/x86/cpuid.asm\
 	$(COMMON_SRCDIR)/x86/dct.asm\
 	$(COMMON_SRCDIR)/x86/deblock.asm\
@@ -51,6 +53,7 @@ endif
 OBJS += $(COMMON_OBJSARM)
 
 COMMON_ASM_ARM64_SRCS=\
+	$(COMMON_SRCDIR)/arm64/colorspace_convert_aarch64_neon.S\
 	$(COMMON_SRCDIR)/arm64/copy_mb_aarch64_neon.S\
 	$(COMMON_SRCDIR)/arm64/deblocking_aarch64_neon.S\
 	$(COMMON_SRCDIR)/arm64/expand_picture_aarch64_neon.S\
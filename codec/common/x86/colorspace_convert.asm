@@ -0,0 +1,221 @@
+;*!
+;* \copy
+;*     Copyright (c)  2016, Cisco Systems
+;*     All rights reserved.
+;*
+;*     Redistribution and use in source and binary forms, with or without
+;*     modification, are permitted provided that the following conditions
+;*     are met:
+;*
+;*        ?Redistributions of source code must retain the above copyright
+;*          notice, this list of conditions and the following disclaimer.
+;*
+;*        ?Redistributions in binary form must reproduce the above copyright
+;*          notice, this list of conditions and the following disclaimer in
+;*          the documentation and/or other materials provided with the
+;*          distribution.
+;*
+;*     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+;*     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+;*     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+;*     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+;*     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+;*     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+;*     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+;*     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+;*     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+;*     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+;*     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+;*     POSSIBILITY OF SUCH DAMAGE.
+;*
+;*
+;*  colorspace_convert.asm
+;*
+;*  Abstract
+;*      rows of NV12 and 32 bit RGB source pictures into I420
+;*
+;*  History
+;*      10/18/2026 Created
+;*
+;*
+;*************************************************************************/
+
+%include "asm_inc.asm"
+
+SECTION .text
+
+;***********************************************************************
+; sum the dword pairs of %1 and %2 into the 4 dwords of %1, %3 clobbered
+;***********************************************************************
+%macro SSE2_SumDwordPairs 3
+    movdqa  %3, %1
+    shufps  %1, %2, 88h
+    shufps  %3, %2, 0DDh
+    paddd   %1, %3
+%endmacro
+
+;***********************************************************************
+;void WelsSplitUVRow_sse2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+;   iWidth a multiple of 16
+;***********************************************************************
+WELS_EXTERN WelsSplitUVRow_sse2
+    %assign push_num 0
+    LOAD_4_PARA
+    SIGN_EXTENSION r3, r3d
+    pcmpeqw xmm5, xmm5
+    psrlw   xmm5, 8
+.loop:
+    movdqu  xmm0, [r2]
+    movdqu  xmm1, [r2 + 16]
+    movdqa  xmm2, xmm0
+    movdqa  xmm3, xmm1
+    pand    xmm0, xmm5
+    pand    xmm1, xmm5
+    psrlw   xmm2, 8
+    psrlw   xmm3, 8
+    packuswb xmm0, xmm1
+    packuswb xmm2, xmm3
+    movdqu  [r0], xmm0
+    movdqu  [r1], xmm2
+    add     r0, 16
+    add     r1, 16
+    add     r2, 32
+    sub     r3, 16
+    jg      .loop
+    LOAD_4_PARA_POP
+    ret
+
+;***********************************************************************
+;void WelsRgb32ToYRow_sse2 (uint8_t* pDstY, const uint8_t* kpSrc, int32_t iWidth, const int16_t* kpCoeff);
+;   iWidth a multiple of 8
+;***********************************************************************
+WELS_EXTERN WelsRgb32ToYRow_sse2
+    %assign push_num 0
+    LOAD_4_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION r2, r2d
+    movdqu  xmm6, [r3]
+    mov     r3d, 1080h
+    movd    xmm5, r3d
+    pshufd  xmm5, xmm5, 0
+    pxor    xmm7, xmm7
+.loop:
+    movdqu  xmm0, [r1]
+    movdqu  xmm2, [r1 + 16]
+    movdqa  xmm1, xmm0
+    movdqa  xmm3, xmm2
+    punpcklbw xmm0, xmm7
+    punpckhbw xmm1, xmm7
+    punpcklbw xmm2, xmm7
+    punpckhbw xmm3, xmm7
+    pmaddwd xmm0, xmm6
+    pmaddwd xmm1, xmm6
+    pmaddwd xmm2, xmm6
+    pmaddwd xmm3, xmm6
+    SSE2_SumDwordPairs xmm0, xmm1, xmm4
+    SSE2_SumDwordPairs xmm2, xmm3, xmm4
+    paddd   xmm0, xmm5
+    paddd   xmm2, xmm5
+    psrld   xmm0, 8
+    psrld   xmm2, 8
+    packssdw xmm0, xmm2
+    packuswb xmm0, xmm0
+    movq    [r0], xmm0
+    add     r0, 8
+    add     r1, 32
+    sub     r2, 8
+    jg      .loop
+    POP_XMM
+    LOAD_4_PARA_POP
+    ret
+
+;***********************************************************************
+;void WelsRgb32ToUVRow_sse2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrc0, const uint8_t* kpSrc1,
+;                            int32_t iWidth, const int16_t* kpCoeff);
+;   iWidth a multiple of 4
+;***********************************************************************
+WELS_EXTERN WelsRgb32ToUVRow_sse2
+    %assign push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION r4, r4d
+    movdqu  xmm6, [r5]
+    movdqu  xmm7, [r5 + 16]
+    mov     r5d, 8080h
+    movd    xmm5, r5d
+    pshufd  xmm5, xmm5, 0
+.loop:
+    movdqu  xmm0, [r2]
+    movdqu  xmm1, [r2 + 16]
+    movdqu  xmm2, [r3]
+    movdqu  xmm3, [r3 + 16]
+    pavgb   xmm0, xmm2
+    pavgb   xmm1, xmm3
+    movdqa  xmm2, xmm0
+    shufps  xmm0, xmm1, 88h
+    shufps  xmm2, xmm1, 0DDh
+    pavgb   xmm0, xmm2
+    pxor    xmm4, xmm4
+    movdqa  xmm1, xmm0
+    punpcklbw xmm0, xmm4
+    punpckhbw xmm1, xmm4
+    movdqa  xmm2, xmm0
+    movdqa  xmm3, xmm1
+    pmaddwd xmm0, xmm6
+    pmaddwd xmm1, xmm6
+    pmaddwd xmm2, xmm7
+    pmaddwd xmm3, xmm7
+    SSE2_SumDwordPairs xmm0, xmm1, xmm4
+    SSE2_SumDwordPairs xmm2, xmm3, xmm4
+    paddd   xmm0, xmm5
+    paddd   xmm2, xmm5
+    psrld   xmm0, 8
+    psrld   xmm2, 8
+    packssdw xmm0, xmm2
+    packuswb xmm0, xmm0
+    movd    [r0], xmm0
+    psrlq   xmm0, 32
+    movd    [r1], xmm0
+    add     r0, 4
+    add     r1, 4
+    add     r2, 32
+    add     r3, 32
+    sub     r4, 4
+    jg      .loop
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+%ifdef HAVE_AVX2
+;***********************************************************************
+;void WelsSplitUVRow_avx2 (uint8_t* pDstU, uint8_t* pDstV, const uint8_t* kpSrcUV, int32_t iWidth);
+;   iWidth a multiple of 32
+;***********************************************************************
+WELS_EXTERN WelsSplitUVRow_avx2
+    %assign push_num 0
+    LOAD_4_PARA
+    SIGN_EXTENSION r3, r3d
+    vpcmpeqw ymm5, ymm5, ymm5
+    vpsrlw  ymm5, ymm5, 8
+.loop:
+    vmovdqu ymm0, [r2]
+    vmovdqu ymm1, [r2 + 32]
+    vpsrlw  ymm2, ymm0, 8
+    vpsrlw  ymm3, ymm1, 8
+    vpand   ymm0, ymm0, ymm5
+    vpand   ymm1, ymm1, ymm5
+    vpackuswb ymm0, ymm0, ymm1
+    vpackuswb ymm2, ymm2, ymm3
+    vpermq  ymm0, ymm0, 0D8h
+    vpermq  ymm2, ymm2, 0D8h
+    vmovdqu [r0], ymm0
+    vmovdqu [r1], ymm2
+    add     r0, 32
+    add     r1, 32
+    add     r2, 64
+    sub     r3, 32
+    jg      .loop
+    vzeroupper
+    LOAD_4_PARA_POP
+    ret
+%endif
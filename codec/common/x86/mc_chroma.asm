@@ -32,7 +32,7 @@
 ;*  mc_chroma.asm
 ;*
 ;*  Abstract
-;*      mmx motion compensation for chroma
+;*      mmx motion compensation for chroma, and explicit weighted prediction
 ;*
 ;*  History
 ;*      10/13/2004 Created
@@ -311,3 +311,221 @@ WELS_EXTERN McChromaWidthEq8_ssse3
     ret
 
 
+;***********************************************************************
+; void WeightedPredWidthEq4_sse2 (uint8_t* pDst,
+;                                 int32_t iDstStride,
+;                                 int32_t iLog2Denom,
+;                                 int32_t iWeight,
+;                                 int32_t iOffset,
+;                                 int32_t iHeight);
+;***********************************************************************
+; pDst = Clip1 (((pDst * iWeight + ((1 << iLog2Denom) >> 1)) >> iLog2Denom) + iOffset), the products of the samples
+; and the weights in [-128, 127] fit in signed words
+%macro WEIGHTED_PRED_INIT_SSE2 0
+    movd       xmm4, r2d
+    movd       xmm5, r3d
+    pshuflw    xmm5, xmm5, 0
+    punpcklqdq xmm5, xmm5
+    movd       xmm6, r4d
+    pshuflw    xmm6, xmm6, 0
+    punpcklqdq xmm6, xmm6
+    pcmpeqw    xmm7, xmm7
+    psrlw      xmm7, 15
+    psllw      xmm7, xmm4
+    psrlw      xmm7, 1
+    pxor       xmm3, xmm3
+%endmacro
+
+; %1 words of the samples
+%macro WEIGHTED_PRED_WORDS_SSE2 1
+    pmullw     %1, xmm5
+    paddw      %1, xmm7
+    psraw      %1, xmm4
+    paddsw     %1, xmm6
+%endmacro
+
+WELS_EXTERN WeightedPredWidthEq4_sse2
+    %assign  push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION  r1, r1d
+    SIGN_EXTENSION  r5, r5d
+    WEIGHTED_PRED_INIT_SSE2
+.yloop:
+    movd       xmm0, [r0]
+    punpcklbw  xmm0, xmm3
+    WEIGHTED_PRED_WORDS_SSE2 xmm0
+    packuswb   xmm0, xmm0
+    movd       [r0], xmm0
+    add        r0, r1
+    dec        r5
+    jnz        .yloop
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+;***********************************************************************
+; void WeightedPredWidthEq8_sse2 (uint8_t* pDst,
+;                                 int32_t iDstStride,
+;                                 int32_t iLog2Denom,
+;                                 int32_t iWeight,
+;                                 int32_t iOffset,
+;                                 int32_t iHeight);
+;***********************************************************************
+WELS_EXTERN WeightedPredWidthEq8_sse2
+    %assign  push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION  r1, r1d
+    SIGN_EXTENSION  r5, r5d
+    WEIGHTED_PRED_INIT_SSE2
+.yloop:
+    movq       xmm0, [r0]
+    punpcklbw  xmm0, xmm3
+    WEIGHTED_PRED_WORDS_SSE2 xmm0
+    packuswb   xmm0, xmm0
+    movq       [r0], xmm0
+    add        r0, r1
+    dec        r5
+    jnz        .yloop
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+;***********************************************************************
+; void WeightedPredWidthEq16_sse2 (uint8_t* pDst,
+;                                  int32_t iDstStride,
+;                                  int32_t iLog2Denom,
+;                                  int32_t iWeight,
+;                                  int32_t iOffset,
+;                                  int32_t iHeight);
+;***********************************************************************
+WELS_EXTERN WeightedPredWidthEq16_sse2
+    %assign  push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION  r1, r1d
+    SIGN_EXTENSION  r5, r5d
+    WEIGHTED_PRED_INIT_SSE2
+.yloop:
+    movdqu     xmm0, [r0]
+    movdqa     xmm1, xmm0
+    punpcklbw  xmm0, xmm3
+    punpckhbw  xmm1, xmm3
+    WEIGHTED_PRED_WORDS_SSE2 xmm0
+    WEIGHTED_PRED_WORDS_SSE2 xmm1
+    packuswb   xmm0, xmm1
+    movdqu     [r0], xmm0
+    add        r0, r1
+    dec        r5
+    jnz        .yloop
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+
+%ifdef HAVE_AVX2
+
+;***********************************************************************
+; void McChromaWidthEq8_avx2 (const uint8_t *pSrc,
+;                             int32_t iSrcStride,
+;                             uint8_t *pDst,
+;                             int32_t iDstStride,
+;                             const uint8_t *pABCD,
+;                             int32_t iHeigh);
+;***********************************************************************
+; two rows per iteration, the low lane for the even row and the high lane for the odd row
+WELS_EXTERN McChromaWidthEq8_avx2
+    %assign  push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION  r1, r1d
+    SIGN_EXTENSION  r3, r3d
+    SIGN_EXTENSION  r5, r5d
+
+    vpbroadcastw ymm5, [r4]
+    vpbroadcastw ymm6, [r4 + 2]
+    vpcmpeqw     ymm7, ymm7, ymm7
+    vpsrlw       ymm7, ymm7, 15
+    vpsllw       ymm7, ymm7, 5
+
+    ; pairs of the horizontal neighbours of row 0
+    vmovdqu      xmm0, [r0]
+    vpsrldq      xmm1, xmm0, 1
+    vpunpcklbw   xmm0, xmm0, xmm1
+.hloop_chroma:
+    vmovdqu      xmm2, [r0 + r1]
+    lea          r0, [r0 + 2 * r1]
+    vinserti128  ymm2, ymm2, [r0], 1
+    vpsrldq      ymm1, ymm2, 1
+    vpunpcklbw   ymm2, ymm2, ymm1        ; pairs of rows y + 1 and y + 2
+    vinserti128  ymm0, ymm0, xmm2, 1     ; pairs of rows y and y + 1
+    vpmaddubsw   ymm0, ymm0, ymm5
+    vpmaddubsw   ymm1, ymm2, ymm6
+    vpaddw       ymm0, ymm0, ymm1
+    vpaddw       ymm0, ymm0, ymm7
+    vpsrlw       ymm0, ymm0, 6
+    vpackuswb    ymm0, ymm0, ymm0
+    vmovq        [r2], xmm0
+    vextracti128 xmm0, ymm0, 1
+    vmovq        [r2 + r3], xmm0
+    vextracti128 xmm0, ymm2, 1           ; pairs of row y + 2 for the next rows
+    lea          r2, [r2 + 2 * r3]
+    sub          r5, 2
+    jnz          .hloop_chroma
+
+    vzeroupper
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+;***********************************************************************
+; void WeightedPredWidthEq16_avx2 (uint8_t* pDst,
+;                                  int32_t iDstStride,
+;                                  int32_t iLog2Denom,
+;                                  int32_t iWeight,
+;                                  int32_t iOffset,
+;                                  int32_t iHeight);
+;***********************************************************************
+; two rows per iteration, iHeight is even
+WELS_EXTERN WeightedPredWidthEq16_avx2
+    %assign  push_num 0
+    LOAD_6_PARA
+    PUSH_XMM 8
+    SIGN_EXTENSION  r1, r1d
+    SIGN_EXTENSION  r5, r5d
+
+    vmovd        xmm4, r2d
+    vmovd        xmm5, r3d
+    vpbroadcastw ymm5, xmm5
+    vmovd        xmm6, r4d
+    vpbroadcastw ymm6, xmm6
+    vpcmpeqw     ymm7, ymm7, ymm7
+    vpsrlw       ymm7, ymm7, 15
+    vpsllw       ymm7, ymm7, xmm4
+    vpsrlw       ymm7, ymm7, 1
+.yloop:
+    vpmovzxbw    ymm0, [r0]
+    vpmovzxbw    ymm1, [r0 + r1]
+    vpmullw      ymm0, ymm0, ymm5
+    vpmullw      ymm1, ymm1, ymm5
+    vpaddw       ymm0, ymm0, ymm7
+    vpaddw       ymm1, ymm1, ymm7
+    vpsraw       ymm0, ymm0, xmm4
+    vpsraw       ymm1, ymm1, xmm4
+    vpaddsw      ymm0, ymm0, ymm6
+    vpaddsw      ymm1, ymm1, ymm6
+    vpackuswb    ymm0, ymm0, ymm1
+    vpermq       ymm0, ymm0, 11011000b
+    vmovdqu      [r0], xmm0
+    vextracti128 [r0 + r1], ymm0, 1
+    lea          r0, [r0 + 2 * r1]
+    sub          r5, 2
+    jnz          .yloop
+
+    vzeroupper
+    POP_XMM
+    LOAD_6_PARA_POP
+    ret
+
+%endif ; HAVE_AVX2
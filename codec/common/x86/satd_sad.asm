@@ -2697,6 +2697,425 @@ WELS_EXTERN WelsSampleSadFour4x4_sse2
 ;
 ;***********************************************************************
 
+;***********************************************************************
+;
+;Pixel_sad_wxh_avx2 BEGIN
+;
+;***********************************************************************
+
+%ifdef HAVE_AVX2
+; out=%1 pRow0=%2 pRow1=%3, two 16 wide rows per ymm
+%macro AVX2_Load16x2 3
+    vmovdqu          x%1, [%2]
+    vinserti128      y%1, y%1, [%3], 1
+%endmacro
+
+; out=%1 pSrc=%2 iStride=%3 3*iStride=%4 mm_clobber=%5, four 8 wide rows per ymm
+%macro AVX2_Load8x4 5
+    vmovq            x%1, [%2]
+    vmovhps          x%1, x%1, [%2 + %3]
+    vmovq            x%5, [%2 + 2 * %3]
+    vmovhps          x%5, x%5, [%2 + %4]
+    vinserti128      y%1, y%1, x%5, 1
+%endmacro
+
+; d_out=%1 mm_in=%2 mm_clobber=%3
+%macro AVX2_SumSadHorizon 3
+    vextracti128     x%3, y%2, 1
+    vpaddd           x%2, x%2, x%3
+    vpunpckhqdq      x%3, x%2, x%2
+    vpaddd           x%2, x%2, x%3
+    vmovd            %1, x%2
+%endmacro
+
+;***********************************************************************
+;
+;int32_t WelsSampleSad16x16_avx2( uint8_t *, int32_t, uint8_t *, int32_t, );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSad16x16_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r4
+    %assign push_num 1
+%endif
+    mov r4, 4                      ; loop cnt
+    jmp WelsSampleSad16x4N_avx2
+
+;***********************************************************************
+;
+;int32_t WelsSampleSad16x8_avx2( uint8_t *, int32_t, uint8_t *, int32_t, );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSad16x8_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r4
+    %assign push_num 1
+%endif
+    mov r4, 2                      ; loop cnt
+                                   ; fall through
+WelsSampleSad16x4N_avx2:
+%ifdef X86_32
+    push r5
+    push r6
+    %assign push_num push_num+2
+%endif
+    LOAD_4_PARA
+    PUSH_XMM 4
+    SIGN_EXTENSION r1, r1d
+    SIGN_EXTENSION r3, r3d
+    lea          r5, [3 * r1]
+    lea          r6, [3 * r3]
+    vpxor        ymm3, ymm3, ymm3
+.loop:
+    AVX2_Load16x2 mm0, r0, r0 + r1
+    AVX2_Load16x2 mm1, r2, r2 + r3
+    vpsadbw      ymm0, ymm0, ymm1
+    vpaddd       ymm3, ymm3, ymm0
+    AVX2_Load16x2 mm1, r0 + 2 * r1, r0 + r5
+    AVX2_Load16x2 mm2, r2 + 2 * r3, r2 + r6
+    vpsadbw      ymm1, ymm1, ymm2
+    vpaddd       ymm3, ymm3, ymm1
+    lea          r0, [r0 + 4 * r1]
+    lea          r2, [r2 + 4 * r3]
+    sub          r4, 1
+    ja           .loop
+    AVX2_SumSadHorizon retrd, mm3, mm0
+    vzeroupper
+    POP_XMM
+    LOAD_4_PARA_POP
+%ifdef X86_32
+    pop r6
+    pop r5
+    pop r4
+%endif
+    ret
+
+;***********************************************************************
+;
+;int32_t WelsSampleSad8x16_avx2( uint8_t *, int32_t, uint8_t *, int32_t, );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSad8x16_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r4
+    %assign push_num 1
+%endif
+    mov r4, 4                      ; loop cnt
+    jmp WelsSampleSad8x4N_avx2
+
+;***********************************************************************
+;
+;int32_t WelsSampleSad8x8_avx2( uint8_t *, int32_t, uint8_t *, int32_t, );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSad8x8_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r4
+    %assign push_num 1
+%endif
+    mov r4, 2                      ; loop cnt
+                                   ; fall through
+WelsSampleSad8x4N_avx2:
+%ifdef X86_32
+    push r5
+    push r6
+    %assign push_num push_num+2
+%endif
+    LOAD_4_PARA
+    PUSH_XMM 4
+    SIGN_EXTENSION r1, r1d
+    SIGN_EXTENSION r3, r3d
+    lea          r5, [3 * r1]
+    lea          r6, [3 * r3]
+    vpxor        ymm3, ymm3, ymm3
+.loop:
+    AVX2_Load8x4 mm0, r0, r1, r5, mm2
+    AVX2_Load8x4 mm1, r2, r3, r6, mm2
+    vpsadbw      ymm0, ymm0, ymm1
+    vpaddd       ymm3, ymm3, ymm0
+    lea          r0, [r0 + 4 * r1]
+    lea          r2, [r2 + 4 * r3]
+    sub          r4, 1
+    ja           .loop
+    AVX2_SumSadHorizon retrd, mm3, mm0
+    vzeroupper
+    POP_XMM
+    LOAD_4_PARA_POP
+%ifdef X86_32
+    pop r6
+    pop r5
+    pop r4
+%endif
+    ret
+
+;***********************************************************************
+;
+;void WelsSampleSadFour16x16_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSadFour16x16_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r5
+    %assign push_num 1
+%endif
+    mov r5, 16                     ; loop cnt
+    jmp WelsSampleSadFour16xN_avx2
+
+;***********************************************************************
+;
+;void WelsSampleSadFour16x8_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleSadFour16x8_avx2
+    %assign push_num 0
+%ifdef X86_32
+    push r5
+    %assign push_num 1
+%endif
+    mov r5, 8                      ; loop cnt
+                                   ; fall through
+WelsSampleSadFour16xN_avx2:
+%ifdef X86_32
+    push r6
+    %assign push_num push_num+1
+%endif
+    LOAD_5_PARA
+    PUSH_XMM 4
+    SIGN_EXTENSION r1, r1d
+    SIGN_EXTENSION r3, r3d
+    mov          r6, r2
+    sub          r6, r3            ; row of the up candidate
+    vpxor        ymm2, ymm2, ymm2  ; sad of up | down
+    vpxor        ymm3, ymm3, ymm3  ; sad of left | right
+.loop:
+    ; two candidates per ymm against the source row broadcast to both lanes
+    vbroadcasti128 ymm0, [r0]
+    AVX2_Load16x2 mm1, r6, r6 + 2 * r3
+    vpsadbw      ymm1, ymm1, ymm0
+    vpaddd       ymm2, ymm2, ymm1
+    AVX2_Load16x2 mm1, r6 + r3 - 1, r6 + r3 + 1
+    vpsadbw      ymm1, ymm1, ymm0
+    vpaddd       ymm3, ymm3, ymm1
+    add          r0, r1
+    add          r6, r3
+    sub          r5, 1
+    ja           .loop
+    vpshufd      ymm0, ymm2, 04Eh
+    vpaddd       ymm2, ymm2, ymm0  ; up, 0, up, 0 | down, 0, down, 0
+    vpshufd      ymm1, ymm3, 04Eh
+    vpaddd       ymm3, ymm3, ymm1  ; left, 0, left, 0 | right, 0, right, 0
+    vpunpckldq   ymm2, ymm2, ymm3  ; up, left | down, right
+    vextracti128 xmm3, ymm2, 1
+    vpunpckldq   xmm2, xmm2, xmm3  ; up, down, left, right
+    vmovdqu      [r4], xmm2
+    vzeroupper
+    POP_XMM
+    LOAD_5_PARA_POP
+%ifdef X86_32
+    pop r6
+    pop r5
+%endif
+    ret
+
+%ifndef X86_32
+; the N candidates kernels keep the whole source block in registers, which x86_32 lacks
+
+; accumulate into ymm0 the sad of the 16x4 block at r0 (stride r3, 3*stride r1) against the rows held by %1,%2
+%macro AVX2_NSadAcc16x4 2
+    AVX2_Load16x2 mm1, r0, r0 + r3
+    vpsadbw      ymm1, ymm1, y%1
+    vpaddd       ymm0, ymm0, ymm1
+    AVX2_Load16x2 mm2, r0 + 2 * r3, r0 + r1
+    vpsadbw      ymm2, ymm2, y%2
+    vpaddd       ymm0, ymm0, ymm2
+    lea          r0, [r0 + 4 * r3]
+%endmacro
+
+; accumulate into ymm0 the sad of the 8x4 block at r0 (stride r3, 3*stride r1) against the rows held by %1
+%macro AVX2_NSadAcc8x4 1
+    AVX2_Load8x4 mm1, r0, r3, r1, mm2
+    vpsadbw      ymm1, ymm1, y%1
+    vpaddd       ymm0, ymm0, ymm1
+    lea          r0, [r0 + 4 * r3]
+%endmacro
+
+; out=%1 mm_clobber=%2, load four 8 wide rows at r0 (stride r1) and advance r0
+%macro AVX2_Load8x4Step 2
+    vmovq        x%1, [r0]
+    vmovhps      x%1, x%1, [r0 + r1]
+    lea          r0, [r0 + 2 * r1]
+    vmovq        x%2, [r0]
+    vmovhps      x%2, x%2, [r0 + r1]
+    lea          r0, [r0 + 2 * r1]
+    vinserti128  y%1, y%1, x%2, 1
+%endmacro
+
+%macro AVX2_NSadPrologue 1
+    %assign push_num 0
+    LOAD_7_PARA
+    PUSH_XMM %1
+    SIGN_EXTENSION r1, r1d
+    SIGN_EXTENSION r3, r3d
+    SIGN_EXTENSION r4, r4d
+    SIGN_EXTENSION r5, r5d
+%endmacro
+
+%macro AVX2_NSadEpilogue 0
+    vzeroupper
+    POP_XMM
+    LOAD_7_PARA_POP
+    ret
+%endmacro
+
+;***********************************************************************
+;
+;void WelsSampleNSad16x16_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t iStep, int32_t iNum, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleNSad16x16_avx2
+    AVX2_NSadPrologue 12
+    AVX2_Load16x2 mm4, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm5, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm6, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm7, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm8, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm9, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm10, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm11, r0, r0 + r1
+    lea          r1, [3 * r3]
+    test         r5, r5
+    jle          .end
+.loop:
+    mov          r0, r2
+    vpxor        ymm0, ymm0, ymm0
+    AVX2_NSadAcc16x4 mm4, mm5
+    AVX2_NSadAcc16x4 mm6, mm7
+    AVX2_NSadAcc16x4 mm8, mm9
+    AVX2_NSadAcc16x4 mm10, mm11
+    AVX2_SumSadHorizon [r6], mm0, mm1
+    add          r2, r4
+    add          r6, 4
+    sub          r5, 1
+    jg           .loop
+.end:
+    AVX2_NSadEpilogue
+
+;***********************************************************************
+;
+;void WelsSampleNSad16x8_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t iStep, int32_t iNum, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleNSad16x8_avx2
+    AVX2_NSadPrologue 8
+    AVX2_Load16x2 mm4, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm5, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm6, r0, r0 + r1
+    lea          r0, [r0 + 2 * r1]
+    AVX2_Load16x2 mm7, r0, r0 + r1
+    lea          r1, [3 * r3]
+    test         r5, r5
+    jle          .end
+.loop:
+    mov          r0, r2
+    vpxor        ymm0, ymm0, ymm0
+    AVX2_NSadAcc16x4 mm4, mm5
+    AVX2_NSadAcc16x4 mm6, mm7
+    AVX2_SumSadHorizon [r6], mm0, mm1
+    add          r2, r4
+    add          r6, 4
+    sub          r5, 1
+    jg           .loop
+.end:
+    AVX2_NSadEpilogue
+
+;***********************************************************************
+;
+;void WelsSampleNSad8x16_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t iStep, int32_t iNum, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleNSad8x16_avx2
+    AVX2_NSadPrologue 8
+    AVX2_Load8x4Step mm4, mm0
+    AVX2_Load8x4Step mm5, mm0
+    AVX2_Load8x4Step mm6, mm0
+    AVX2_Load8x4Step mm7, mm0
+    lea          r1, [3 * r3]
+    test         r5, r5
+    jle          .end
+.loop:
+    mov          r0, r2
+    vpxor        ymm0, ymm0, ymm0
+    AVX2_NSadAcc8x4 mm4
+    AVX2_NSadAcc8x4 mm5
+    AVX2_NSadAcc8x4 mm6
+    AVX2_NSadAcc8x4 mm7
+    AVX2_SumSadHorizon [r6], mm0, mm1
+    add          r2, r4
+    add          r6, 4
+    sub          r5, 1
+    jg           .loop
+.end:
+    AVX2_NSadEpilogue
+
+;***********************************************************************
+;
+;void WelsSampleNSad8x8_avx2( uint8_t *, int32_t, uint8_t *, int32_t, int32_t iStep, int32_t iNum, int32_t * );
+;
+;***********************************************************************
+
+WELS_EXTERN WelsSampleNSad8x8_avx2
+    AVX2_NSadPrologue 6
+    AVX2_Load8x4Step mm4, mm0
+    AVX2_Load8x4Step mm5, mm0
+    lea          r1, [3 * r3]
+    test         r5, r5
+    jle          .end
+.loop:
+    mov          r0, r2
+    vpxor        ymm0, ymm0, ymm0
+    AVX2_NSadAcc8x4 mm4
+    AVX2_NSadAcc8x4 mm5
+    AVX2_SumSadHorizon [r6], mm0, mm1
+    add          r2, r4
+    add          r6, 4
+    sub          r5, 1
+    jg           .loop
+.end:
+    AVX2_NSadEpilogue
+
+%endif ; X86_32
+
+%endif ; HAVE_AVX2
+
+;***********************************************************************
+;
+;Pixel_sad_wxh_avx2 END
+;
+;***********************************************************************
+
 ;***********************************************************************
 ;   int32_t WelsSampleSad4x4_mmx (uint8_t *, int32_t, uint8_t *, int32_t )
 ;***********************************************************************
@@ -0,0 +1,376 @@
+/*!
+ * \copy
+ *     Copyright (c)  2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * h264bench.cpp:       decoding benchmark, reports fps, time per MB and the time spent in the decoding stages
+ */
+
+#if defined (_WIN32)
+#define _CRT_SECURE_NO_WARNINGS
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "codec_def.h"
+#include "codec_app_def.h"
+#include "codec_api.h"
+#include "typedefs.h"
+#include "measure_time.h"
+#include "ls_defines.h"
+#include "cpu.h"
+#include "au_parser.h"
+
+using namespace std;
+using namespace WelsDec;
+
+#define BENCH_STAGE_NUM 6
+#define BENCH_SCAN_PASS 200
+#define BENCH_INPUT_PADDING 4           // readable bytes past the end of the input, required by bZeroCopyInput
+
+static const char* kpStageName[BENCH_STAGE_NUM] = {
+  "nal", "entropy", "recon", "mc", "deblock", "ec"
+};
+
+typedef struct TagBenchResult {
+  int64_t iDecodeUs;                    // time spent in the decoding calls
+  int64_t iFrameNum;
+  int64_t iMbNum;
+  int64_t iStageUs[BENCH_STAGE_NUM];
+  bool    bStageTiming;
+} SBenchResult;
+
+static void PrintUsage() {
+  fprintf (stderr, "Usage: h264bench [-n loops] [-t threads] [-zerocopy] [-scan] file.264 ...\n");
+  fprintf (stderr, "  -n  decode each file n times, 5 by default\n");
+  fprintf (stderr, "  -t  number of decoding threads, 1 by default; the stage breakdown is only complete with 1\n");
+  fprintf (stderr, "  -zerocopy  parse the NALs without emulation prevention bytes in place\n");
+  fprintf (stderr, "  -scan  time the start code and emulation prevention removal alone, %d passes per loop,\n",
+           BENCH_SCAN_PASS);
+  fprintf (stderr, "         byte by byte against the C and the SIMD scan of the decoder\n");
+  fprintf (stderr, "The stage breakdown requires the library built with STAGE_TIMING=Yes, or MB to split off the MC.\n");
+}
+
+static bool ReadFile (const char* kpFileName, vector<uint8_t>& vBuf) {
+  FILE* pFile = fopen (kpFileName, "rb");
+  if (pFile == NULL) {
+    return false;
+  }
+  fseek (pFile, 0L, SEEK_END);
+  long iFileSize = ftell (pFile);
+  fseek (pFile, 0L, SEEK_SET);
+  if (iFileSize <= 0) {
+    fclose (pFile);
+    return false;
+  }
+  vBuf.assign (iFileSize + BENCH_INPUT_PADDING, 0);
+  bool bRet = (fread (&vBuf[0], 1, iFileSize, pFile) == (size_t)iFileSize);
+  fclose (pFile);
+  return bRet;
+}
+
+// NAL units are located before the timing starts, so the decoding calls are the only thing timed
+static void SplitNals (const vector<uint8_t>& vBuf, vector<int32_t>& vNalPos) {
+  const int32_t kiSize = (int32_t)vBuf.size() - BENCH_INPUT_PADDING;
+  vNalPos.clear();
+  for (int32_t i = 0; i + 2 < kiSize; ++i) {
+    if (vBuf[i] == 0 && vBuf[i + 1] == 0 && vBuf[i + 2] == 1) {
+      // a 4-byte start code belongs to the NAL following it
+      vNalPos.push_back ((i > 0 && vBuf[i - 1] == 0) ? i - 1 : i);
+      i += 2;
+    }
+  }
+  if (vNalPos.empty() || vNalPos[0] != 0) {
+    vNalPos.insert (vNalPos.begin(), 0);
+  }
+  vNalPos.push_back (kiSize);
+}
+
+static void CountOutput (const SBufferInfo& kDstInfo, SBenchResult& sResult) {
+  if (kDstInfo.iBufferStatus == 1) {
+    const int32_t kiWidth = kDstInfo.UsrData.sSystemBuffer.iWidth;
+    const int32_t kiHeight = kDstInfo.UsrData.sSystemBuffer.iHeight;
+    ++sResult.iFrameNum;
+    sResult.iMbNum += ((kiWidth + 15) >> 4) * ((kiHeight + 15) >> 4);
+  }
+}
+
+static bool DecodeOnce (const vector<uint8_t>& vBuf, const vector<int32_t>& vNalPos, const int32_t kiThreadNum,
+                        const bool kbZeroCopy, SBenchResult& sResult) {
+  ISVCDecoder* pDecoder = NULL;
+  if (WelsCreateDecoder (&pDecoder) != 0 || pDecoder == NULL) {
+    return false;
+  }
+  int32_t iThreadNum = kiThreadNum;
+  pDecoder->SetOption (DECODER_OPTION_NUM_OF_THREADS, &iThreadNum);
+  SDecodingParam sDecParam;
+  memset (&sDecParam, 0, sizeof (SDecodingParam));
+  sDecParam.uiTargetDqLayer = (uint8_t) - 1;
+  sDecParam.eEcActiveIdc = ERROR_CON_SLICE_COPY;
+  sDecParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+  sDecParam.bZeroCopyInput = kbZeroCopy;
+  if (pDecoder->Initialize (&sDecParam) != 0) {
+    WelsDestroyDecoder (pDecoder);
+    return false;
+  }
+
+  uint8_t* pData[3] = {NULL};
+  SBufferInfo sDstInfo;
+  int64_t iStart = WelsTime();
+  for (size_t i = 0; i + 1 < vNalPos.size(); ++i) {
+    memset (&sDstInfo, 0, sizeof (SBufferInfo));
+    sDstInfo.uiInBsTimeStamp = i;
+    if (kiThreadNum > 1) {
+      pDecoder->DecodeFrame2 (&vBuf[vNalPos[i]], vNalPos[i + 1] - vNalPos[i], pData, &sDstInfo);
+    } else {
+      pDecoder->DecodeFrameNoDelay (&vBuf[vNalPos[i]], vNalPos[i + 1] - vNalPos[i], pData, &sDstInfo);
+    }
+    CountOutput (sDstInfo, sResult);
+  }
+  int32_t iEndOfStream = 1;
+  pDecoder->SetOption (DECODER_OPTION_END_OF_STREAM, &iEndOfStream);
+  int32_t iRemainingFrames = 1;
+  while (iRemainingFrames > 0) {
+    memset (&sDstInfo, 0, sizeof (SBufferInfo));
+    pDecoder->DecodeFrame2 (NULL, 0, pData, &sDstInfo);
+    CountOutput (sDstInfo, sResult);
+    iRemainingFrames = 0;
+    pDecoder->GetOption (DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER, &iRemainingFrames);
+  }
+  sResult.iDecodeUs += WelsTime() - iStart;
+
+  SDecoderStageTiming sStageTiming;
+  memset (&sStageTiming, 0, sizeof (SDecoderStageTiming));
+  sResult.bStageTiming = (pDecoder->GetOption (DECODER_OPTION_GET_STAGE_TIMING, &sStageTiming) == cmResultSuccess);
+  sResult.iStageUs[0] += sStageTiming.uiNalParseUs;
+  sResult.iStageUs[1] += sStageTiming.uiEntropyDecodeUs;
+  sResult.iStageUs[2] += sStageTiming.uiReconstructionUs;
+  sResult.iStageUs[3] += sStageTiming.uiMcUs;
+  sResult.iStageUs[4] += sStageTiming.uiDeblockingUs;
+  sResult.iStageUs[5] += sStageTiming.uiErrorConcealmentUs;
+
+  pDecoder->Uninitialize();
+  WelsDestroyDecoder (pDecoder);
+  return true;
+}
+
+// start code and emulation prevention removal the way WelsDecodeBs does it, the start codes are dropped,
+// pfScan NULL walks the input one byte at a time as the decoder used to
+static int32_t UnescapeBs (const uint8_t* kpSrc, const int32_t kiSrcLen, uint8_t* pDst, PScanNalEscapeFunc pfScan) {
+  int32_t iSrcIdx = 0;
+  int32_t iDstIdx = 0;
+  while (iSrcIdx < kiSrcLen) {
+    if ((2 + iSrcIdx < kiSrcLen) && (0 == LD16 (kpSrc + iSrcIdx)) && (kpSrc[2 + iSrcIdx] <= 0x03)) {
+      if (kpSrc[2 + iSrcIdx] == 0x03) {
+        ST16 (pDst + iDstIdx, 0);
+        iDstIdx += 2;
+        iSrcIdx += 3;
+      } else if (kpSrc[2 + iSrcIdx] == 0x01) {
+        iSrcIdx += 3;
+      } else {
+        pDst[iDstIdx++] = kpSrc[iSrcIdx++];
+      }
+      continue;
+    }
+    if (pfScan == NULL) {
+      pDst[iDstIdx++] = kpSrc[iSrcIdx++];
+    } else {
+      const int32_t kiRunLen = pfScan (kpSrc + iSrcIdx, kiSrcLen - iSrcIdx);
+      memcpy (pDst + iDstIdx, kpSrc + iSrcIdx, kiRunLen);
+      iDstIdx += kiRunLen;
+      iSrcIdx += kiRunLen;
+    }
+  }
+  return iDstIdx;
+}
+
+// MB/s of the byte by byte walk, the C scan and the vector scan of this CPU (C if none), 0 if the outputs differ
+static bool ScanOnce (const vector<uint8_t>& vBuf, const int32_t kiPassNum, double dMbps[3]) {
+  PScanNalEscapeFunc pfScan[3] = {NULL, WelsScanNalEscape_c, GetNalScanVectorFunc (WelsCPUFeatureDetect (NULL))};
+  if (pfScan[2] == NULL) {
+    pfScan[2] = WelsScanNalEscape_c;
+  }
+
+  const int32_t kiSrcLen = (int32_t)vBuf.size() - BENCH_INPUT_PADDING;
+  vector<uint8_t> vRef (kiSrcLen + 4), vDst (kiSrcLen + 4);
+  const int32_t kiRefLen = UnescapeBs (&vBuf[0], kiSrcLen, &vRef[0], NULL);
+  for (int32_t i = 0; i < 3; ++i) {
+    int64_t iStart = WelsTime();
+    int32_t iDstLen = 0;
+    for (int32_t iPass = 0; iPass < kiPassNum; ++iPass) {
+      iDstLen = UnescapeBs (&vBuf[0], kiSrcLen, &vDst[0], pfScan[i]);
+    }
+    const int64_t kiUs = WelsTime() - iStart;
+    const bool kbSame = (iDstLen == kiRefLen) && !memcmp (&vDst[0], &vRef[0], kiRefLen);
+    dMbps[i] = (kbSame && kiUs > 0) ? (double)kiSrcLen * kiPassNum / kiUs : 0.0;
+  }
+  return true;
+}
+
+static void PrintHeader() {
+  printf ("%-40s %7s %9s %8s", "file", "frames", "fps", "ns/MB");
+  for (int32_t i = 0; i < BENCH_STAGE_NUM; ++i) {
+    printf (" %7s%%", kpStageName[i]);
+  }
+  printf (" %7s%%\n", "other");
+}
+
+static void PrintResult (const char* kpName, const SBenchResult& kResult) {
+  const double kdSeconds = kResult.iDecodeUs / 1e6;
+  printf ("%-40s %7lld %9.1f %8.0f", kpName, (long long)kResult.iFrameNum,
+          kdSeconds > 0 ? kResult.iFrameNum / kdSeconds : 0.0,
+          kResult.iMbNum > 0 ? kResult.iDecodeUs * 1e3 / kResult.iMbNum : 0.0);
+  if (!kResult.bStageTiming || kResult.iDecodeUs <= 0) {
+    for (int32_t i = 0; i <= BENCH_STAGE_NUM; ++i) {
+      printf (" %8s", "-");
+    }
+    printf ("\n");
+    return;
+  }
+  int64_t iOtherUs = kResult.iDecodeUs;
+  for (int32_t i = 0; i < BENCH_STAGE_NUM; ++i) {
+    printf (" %7.1f%%", kResult.iStageUs[i] * 100.0 / kResult.iDecodeUs);
+    iOtherUs -= kResult.iStageUs[i];
+  }
+  printf (" %7.1f%%\n", (iOtherUs > 0 ? iOtherUs : 0) * 100.0 / kResult.iDecodeUs);
+}
+
+static const char* BaseName (const char* kpFileName) {
+  const char* kpName = strrchr (kpFileName, '/');
+  return (kpName != NULL) ? kpName + 1 : kpFileName;
+}
+
+static int RunScanBench (const vector<const char*>& vFiles, const int32_t kiPassNum) {
+  printf ("scanning %d time(s), MB/s of the input\n", kiPassNum);
+  printf ("%-40s %9s %9s %9s %9s\n", "file", "bytes", "bytewise", "c", "simd");
+  int32_t iRet = 0;
+  vector<uint8_t> vBuf;
+  double dTotalUs[3] = {0.0, 0.0, 0.0};
+  int64_t iTotalBytes = 0;
+  for (size_t iFile = 0; iFile < vFiles.size(); ++iFile) {
+    double dMbps[3];
+    if (!ReadFile (vFiles[iFile], vBuf) || !ScanOnce (vBuf, kiPassNum, dMbps)) {
+      fprintf (stderr, "Can not scan %s\n", vFiles[iFile]);
+      iRet = 1;
+      continue;
+    }
+    const int32_t kiFileSize = (int32_t)vBuf.size() - BENCH_INPUT_PADDING;
+    printf ("%-40s %9d %9.1f %9.1f %9.1f\n", BaseName (vFiles[iFile]), kiFileSize, dMbps[0], dMbps[1], dMbps[2]);
+    if (dMbps[0] <= 0.0 || dMbps[1] <= 0.0 || dMbps[2] <= 0.0) {
+      fprintf (stderr, "Scan output differs or was not timed for %s\n", vFiles[iFile]);
+      iRet = 1;
+      continue;
+    }
+    iTotalBytes += kiFileSize;
+    for (int32_t i = 0; i < 3; ++i) {
+      dTotalUs[i] += (double)kiFileSize * kiPassNum / dMbps[i];
+    }
+  }
+  printf ("%-40s %9lld %9.1f %9.1f %9.1f\n", "total", (long long)iTotalBytes,
+          dTotalUs[0] > 0 ? iTotalBytes * kiPassNum / dTotalUs[0] : 0.0,
+          dTotalUs[1] > 0 ? iTotalBytes * kiPassNum / dTotalUs[1] : 0.0,
+          dTotalUs[2] > 0 ? iTotalBytes * kiPassNum / dTotalUs[2] : 0.0);
+  return iRet;
+}
+
+int main (int iArgC, char* pArgV[]) {
+  int32_t iLoopNum = 5;
+  int32_t iThreadNum = 1;
+  bool bScan = false;
+  bool bZeroCopy = false;
+  vector<const char*> vFiles;
+
+  for (int32_t i = 1; i < iArgC; ++i) {
+    if (!strcmp (pArgV[i], "-n") && i + 1 < iArgC) {
+      iLoopNum = atoi (pArgV[++i]);
+    } else if (!strcmp (pArgV[i], "-t") && i + 1 < iArgC) {
+      iThreadNum = atoi (pArgV[++i]);
+    } else if (!strcmp (pArgV[i], "-zerocopy")) {
+      bZeroCopy = true;
+    } else if (!strcmp (pArgV[i], "-scan")) {
+      bScan = true;
+    } else if (pArgV[i][0] == '-') {
+      PrintUsage();
+      return 1;
+    } else {
+      vFiles.push_back (pArgV[i]);
+    }
+  }
+  if (vFiles.empty() || iLoopNum <= 0 || iThreadNum <= 0) {
+    PrintUsage();
+    return 1;
+  }
+
+  if (bScan) {
+    return RunScanBench (vFiles, iLoopNum * BENCH_SCAN_PASS);
+  }
+
+  printf ("decoding %d time(s) with %d thread(s)%s\n", iLoopNum, iThreadNum, bZeroCopy ? ", zero copy input" : "");
+  PrintHeader();
+
+  SBenchResult sTotal;
+  memset (&sTotal, 0, sizeof (SBenchResult));
+  sTotal.bStageTiming = true;
+  int32_t iRet = 0;
+  vector<uint8_t> vBuf;
+  vector<int32_t> vNalPos;
+  for (size_t iFile = 0; iFile < vFiles.size(); ++iFile) {
+    const char* kpName = BaseName (vFiles[iFile]);
+    if (!ReadFile (vFiles[iFile], vBuf)) {
+      fprintf (stderr, "Can not read %s\n", vFiles[iFile]);
+      iRet = 1;
+      continue;
+    }
+    SplitNals (vBuf, vNalPos);
+
+    SBenchResult sResult;
+    memset (&sResult, 0, sizeof (SBenchResult));
+    for (int32_t iLoop = 0; iLoop < iLoopNum; ++iLoop) {
+      if (!DecodeOnce (vBuf, vNalPos, iThreadNum, bZeroCopy, sResult)) {
+        fprintf (stderr, "Can not create the decoder for %s\n", vFiles[iFile]);
+        iRet = 1;
+        break;
+      }
+    }
+    PrintResult (kpName, sResult);
+
+    sTotal.iDecodeUs += sResult.iDecodeUs;
+    sTotal.iFrameNum += sResult.iFrameNum;
+    sTotal.iMbNum += sResult.iMbNum;
+    sTotal.bStageTiming = sTotal.bStageTiming && sResult.bStageTiming;
+    for (int32_t i = 0; i < BENCH_STAGE_NUM; ++i) {
+      sTotal.iStageUs[i] += sResult.iStageUs[i];
+    }
+  }
+  PrintResult ("total", sTotal);
+  if (!sTotal.bStageTiming) {
+    printf ("stage timing is not compiled in, rebuild with STAGE_TIMING=Yes for the breakdown\n");
+  }
+  return iRet;
+}
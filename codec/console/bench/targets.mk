@@ -0,0 +1,16 @@
+H264BENCH_SRCDIR=codec/console/bench
+H264BENCH_CPP_SRCS=\
+	$(H264BENCH_SRCDIR)/src/h264bench.cpp\
+
+H264BENCH_OBJS += $(H264BENCH_CPP_SRCS:.cpp=.$(OBJ))
+
+OBJS += $(H264BENCH_OBJS)
+
+$(H264BENCH_SRCDIR)/%.$(OBJ): $(H264BENCH_SRCDIR)/%.cpp
+	$(QUIET_CXX)$(CXX) $(CFLAGS) $(CXXFLAGS) $(INCLUDES) $(H264BENCH_CFLAGS) $(H264BENCH_INCLUDES) -c $(CXX_O) $<
+
+h264bench$(EXEEXT): $(H264BENCH_OBJS) $(H264BENCH_DEPS)
+	$(QUIET_CXX)$(CXX) $(CXX_LINK_O) $(H264BENCH_OBJS) $(H264BENCH_LDFLAGS) $(LDFLAGS)
+
+binaries: h264bench$(EXEEXT)
+BINARIES += h264bench$(EXEEXT)
@@ -102,6 +102,9 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
   int32_t iLastWidth = 0, iLastHeight = 0;
   int32_t iFrameCount = 0;
   int32_t iEndOfStreamFlag = 0;
+  int32_t iThreadCount = 1;
+  int32_t iSliceThreading = 0;
+  int32_t iRemainingFrames;
   //for coverage test purpose
   int32_t iErrorConMethod = (int32_t) ERROR_CON_SLICE_MV_COPY_CROSS_IDR_FREEZE_RES_CHANGE;
   pDecoder->SetOption (DECODER_OPTION_ERROR_CON_IDC, &iErrorConMethod);
@@ -110,6 +113,8 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
   double dElapsed = 0;
 
   if (pDecoder == NULL) return;
+  pDecoder->GetOption (DECODER_OPTION_NUM_OF_THREADS, &iThreadCount);
+  pDecoder->GetOption (DECODER_OPTION_SLICE_THREADING, &iSliceThreading);
   if (kpH264FileName) {
     pH264File = fopen (kpH264FileName, "rb");
     if (pH264File == NULL) {
@@ -219,7 +224,10 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
     memset (&sDstBufInfo, 0, sizeof (SBufferInfo));
     sDstBufInfo.uiInBsTimeStamp = uiTimeStamp;
 #ifndef NO_DELAY_DECODING
-    pDecoder->DecodeFrameNoDelay (pBuf + iBufPos, iSliceSize, pData, &sDstBufInfo);
+    if (iThreadCount > 1 && !iSliceThreading) // output is delayed by the frame level multi-threading anyway
+      pDecoder->DecodeFrame2 (pBuf + iBufPos, iSliceSize, pData, &sDstBufInfo);
+    else
+      pDecoder->DecodeFrameNoDelay (pBuf + iBufPos, iSliceSize, pData, &sDstBufInfo);
 #else
     pDecoder->DecodeFrame2 (pBuf + iBufPos, iSliceSize, pData, &sDstBufInfo);
 #endif
@@ -284,6 +292,42 @@ void H264DecodeInstance (ISVCDecoder* pDecoder, const char* kpH264FileName, cons
     ++ iSliceIndex;
   }
 
+  // flush the frames still held by the multi-threading decoder, the last access unit is decoded by the first call
+  iRemainingFrames = (iThreadCount > 1 && !iSliceThreading) ? 1 : 0;
+  while (iRemainingFrames > 0) {
+    iStart = WelsTime();
+    pData[0] = NULL;
+    pData[1] = NULL;
+    pData[2] = NULL;
+    memset (&sDstBufInfo, 0, sizeof (SBufferInfo));
+    sDstBufInfo.uiInBsTimeStamp = uiTimeStamp;
+    pDecoder->DecodeFrame2 (NULL, 0, pData, &sDstBufInfo);
+    if (sDstBufInfo.iBufferStatus == 1) {
+      pDst[0] = pData[0];
+      pDst[1] = pData[1];
+      pDst[2] = pData[2];
+    }
+    iEnd    = WelsTime();
+    iTotal += iEnd - iStart;
+    if (sDstBufInfo.iBufferStatus == 1) {
+      cOutputModule.Process ((void**)pDst, &sDstBufInfo, pYuvFile);
+      iWidth  = sDstBufInfo.UsrData.sSystemBuffer.iWidth;
+      iHeight = sDstBufInfo.UsrData.sSystemBuffer.iHeight;
+
+      if (pOptionFile != NULL) {
+        if (iWidth != iLastWidth && iHeight != iLastHeight) {
+          fwrite (&iFrameCount, sizeof (iFrameCount), 1, pOptionFile);
+          fwrite (&iWidth , sizeof (iWidth) , 1, pOptionFile);
+          fwrite (&iHeight, sizeof (iHeight), 1, pOptionFile);
+          iLastWidth  = iWidth;
+          iLastHeight = iHeight;
+        }
+      }
+      ++ iFrameCount;
+    }
+    pDecoder->GetOption (DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER, &iRemainingFrames);
+  }
+
   if (fpTrack) {
     fclose (fpTrack);
     fpTrack = NULL;
@@ -331,6 +375,8 @@ int32_t main (int32_t iArgC, char* pArgV[]) {
   SDecodingParam sDecParam = {0};
   string strInputFile (""), strOutputFile (""), strOptionFile (""), strLengthFile ("");
   int iLevelSetting = (int) WELS_LOG_WARNING;
+  int iThreadCount = 1;
+  int iSliceThreading = 0;
 
   sDecParam.sVideoProperty.size = sizeof (sDecParam.sVideoProperty);
 
@@ -419,6 +465,19 @@ int32_t main (int32_t iArgC, char* pArgV[]) {
             printf ("lenght file not specified.\n");
             return 1;
           }
+        } else if (!strcmp (cmd, "-threads")) {
+          if (i + 1 < iArgC)
+            iThreadCount = atoi (pArgV[++i]);
+          else {
+            printf ("thread number not specified.\n");
+            return 1;
+          }
+        } else if (!strcmp (cmd, "-slicethreads")) {
+          // the threads reconstruct the slices of each picture, without the frame delay
+          iSliceThreading = 1;
+        } else if (!strcmp (cmd, "-zerocopy")) {
+          // the whole file is kept in memory, followed by a start code
+          sDecParam.bZeroCopyInput = true;
         }
       }
     }
@@ -444,6 +503,10 @@ int32_t main (int32_t iArgC, char* pArgV[]) {
   if (iLevelSetting >= 0) {
     pDecoder->SetOption (DECODER_OPTION_TRACE_LEVEL, &iLevelSetting);
   }
+  if (iThreadCount > 1) {
+    pDecoder->SetOption (DECODER_OPTION_NUM_OF_THREADS, &iThreadCount);
+    pDecoder->SetOption (DECODER_OPTION_SLICE_THREADING, &iSliceThreading);
+  }
 
   if (pDecoder->Initialize (&sDecParam)) {
     printf ("Decoder initialization failed.\n");
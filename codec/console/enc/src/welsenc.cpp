@@ -120,6 +120,14 @@ static void    SigIntHandler (int a) {
   g_iCtrlC = 1;
 }
 static int     g_LevelSetting = WELS_LOG_ERROR;
+static bool    g_bSimulcastLayerThreading = false;
+static int32_t g_iWavefrontThreadNum = 0;
+static int32_t g_iAsyncFrameNum = 0;
+static int32_t g_iLookaheadDepth = 0;
+static int32_t g_iTwoPass = 0;
+static char    g_sTwoPassStatsFile[256] = "welsenc_2pass.stats";
+static bool    g_bHierarchicalMe = false;
+static SMemoryArenaParam g_sMemoryArena = { 0, false };
 
 int ParseLayerConfig (CReadConfig& cRdLayerCfg, const int iLayer, SEncParamExt& pSvcParam, SFilesSet& sFileSet) {
   if (!cRdLayerCfg.ExistFile()) {
@@ -406,6 +414,15 @@ void PrintHelp() {
   printf ("  -ltrnum      Control the number of long term reference((1-4):screen LTR,(1-2):video LTR \n");
   printf ("  -threadIdc   0: auto(dynamic imp. internal encoder); 1: multiple threads imp. disabled; > 1: count number of threads \n");
   printf ("  -loadbalancing   0: turn off loadbalancing between slices when multi-threading available; 1: (default value) turn on loadbalancing between slices when multi-threading available\n");
+  printf ("  -slthreads   0: (default value) encode simulcast layers one after another; 1: encode simulcast layers concurrently\n");
+  printf ("  -wfthreads   0: (default value) disabled; > 0: count of threads mode-deciding the MB rows of single slice layers in wavefront order\n");
+  printf ("  -async       0: (default value) synchronous encoding; > 0: count of frames encoded asynchronously while the next ones are read\n");
+  printf ("  -lookahead   0: (default value) disabled; > 0: count of frames analyzed ahead of the frame encoded by the rate control\n");
+  printf ("  -pass        0: (default value) single pass; 1: first pass writing the statistics file; 2: second pass reading it\n");
+  printf ("  -stats       statistics file of the two-pass rate control, welsenc_2pass.stats by default\n");
+  printf ("  -hme         (0: default value) 1: seed the motion search with a search on the downsampled pictures\n");
+  printf ("  -arena       0: (default value) disabled; > 0: size in KB of the regions the encoder buffers are carved from\n");
+  printf ("  -hugepages   (0: default value) 1: back the regions of -arena by huge pages\n");
   printf ("  -deblockIdc  Loop filter idc (0: on, 1: off, \n");
   printf ("  -alphaOffset AlphaOffset(-6..+6): valid range \n");
   printf ("  -betaOffset  BetaOffset (-6..+6): valid range\n");
@@ -524,6 +541,24 @@ int ParseCommandLine (int argc, char** argv, SSourcePicture* pSrcPic, SEncParamE
       pSvcParam.iMultipleThreadIdc = atoi (argv[n++]);
     else if (!strcmp (pCommand, "-loadbalancing") && (n + 1 < argc)) {
       pSvcParam.bUseLoadBalancing = (atoi (argv[n++])) ? true : false;
+    } else if (!strcmp (pCommand, "-slthreads") && (n < argc)) {
+      g_bSimulcastLayerThreading = (atoi (argv[n++])) ? true : false;
+    } else if (!strcmp (pCommand, "-wfthreads") && (n < argc)) {
+      g_iWavefrontThreadNum = atoi (argv[n++]);
+    } else if (!strcmp (pCommand, "-async") && (n < argc)) {
+      g_iAsyncFrameNum = atoi (argv[n++]);
+    } else if (!strcmp (pCommand, "-lookahead") && (n < argc)) {
+      g_iLookaheadDepth = atoi (argv[n++]);
+    } else if (!strcmp (pCommand, "-pass") && (n < argc)) {
+      g_iTwoPass = atoi (argv[n++]);
+    } else if (!strcmp (pCommand, "-stats") && (n < argc)) {
+      strncpy (g_sTwoPassStatsFile, argv[n++], sizeof (g_sTwoPassStatsFile) - 1); // confirmed_safe_unsafe_usage
+    } else if (!strcmp (pCommand, "-hme") && (n < argc)) {
+      g_bHierarchicalMe = (atoi (argv[n++]) != 0);
+    } else if (!strcmp (pCommand, "-arena") && (n < argc)) {
+      g_sMemoryArena.uiRegionSize = atoi (argv[n++]) << 10;
+    } else if (!strcmp (pCommand, "-hugepages") && (n < argc)) {
+      g_sMemoryArena.bHugePages = (atoi (argv[n++]) != 0);
     } else if (!strcmp (pCommand, "-deblockIdc") && (n < argc))
       pSvcParam.iLoopFilterDisableIdc = atoi (argv[n++]);
 
@@ -791,6 +826,23 @@ int ProcessEncoding (ISVCEncoder* pPtrEnc, int argc, char** argv, bool bConfigFi
     goto INSIDE_MEM_FREE;
   }
   pPtrEnc->SetOption (ENCODER_OPTION_TRACE_LEVEL, &g_LevelSetting);
+  pPtrEnc->SetOption (ENCODER_OPTION_SIMULCAST_LAYER_THREADING, &g_bSimulcastLayerThreading);
+  pPtrEnc->SetOption (ENCODER_OPTION_WAVEFRONT_THREADS, &g_iWavefrontThreadNum);
+  if (g_iAsyncFrameNum > 0) {
+    SEncAsyncParam sAsyncParam;
+    memset (&sAsyncParam, 0, sizeof (sAsyncParam));
+    sAsyncParam.iMaxFramesInFlight = g_iAsyncFrameNum;
+    pPtrEnc->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+  }
+  pPtrEnc->SetOption (ENCODER_OPTION_RC_LOOKAHEAD, &g_iLookaheadDepth);
+  if (g_iTwoPass > 0) {
+    SEncTwoPassParam sTwoPassParam;
+    sTwoPassParam.iPass = g_iTwoPass;
+    sTwoPassParam.pStatsFileName = g_sTwoPassStatsFile;
+    pPtrEnc->SetOption (ENCODER_OPTION_TWO_PASS, &sTwoPassParam);
+  }
+  pPtrEnc->SetOption (ENCODER_OPTION_HIERARCHICAL_ME, &g_bHierarchicalMe);
+  pPtrEnc->SetOption (ENCODER_OPTION_MEMORY_ARENA, &g_sMemoryArena);
   //finish reading the configurations
   iSourceWidth = pSrcPic->iPicWidth;
   iSourceHeight = pSrcPic->iPicHeight;
@@ -891,26 +943,33 @@ int ProcessEncoding (ISVCEncoder* pPtrEnc, int argc, char** argv, bool bConfigFi
   }
 
   iFrameIdx = 0;
-  while (iFrameIdx < iTotalFrameMax && (((int32_t)fs.uiFrameToBeCoded <= 0)
-                                        || (iFrameIdx < (int32_t)fs.uiFrameToBeCoded))) {
-
+  while (true) {
+    bool bCanBeRead = false;
+    if (iFrameIdx < iTotalFrameMax && (((int32_t)fs.uiFrameToBeCoded <= 0)
+                                       || (iFrameIdx < (int32_t)fs.uiFrameToBeCoded))) {
 #ifdef ONLY_ENC_FRAMES_NUM
-    // Only encoded some limited frames here
-    if (iActualFrameEncodedCount >= ONLY_ENC_FRAMES_NUM) {
-      break;
-    }
+      // Only encoded some limited frames here
+      if (iActualFrameEncodedCount < ONLY_ENC_FRAMES_NUM)
 #endif//ONLY_ENC_FRAMES_NUM
-    bool bCanBeRead = false;
-    bCanBeRead = (fread (pYUV, 1, kiPicResSize, pFileYUV) == kiPicResSize);
+        bCanBeRead = (fread (pYUV, 1, kiPicResSize, pFileYUV) == kiPicResSize);
+    }
 
-    if (!bCanBeRead)
+    // the frames encoded asynchronously or held by the lookahead are flushed at the end
+    if (!bCanBeRead && g_iAsyncFrameNum <= 0 && g_iLookaheadDepth <= 0)
       break;
     // To encoder this frame
     iStart = WelsTime();
     pSrcPic->uiTimeStamp = WELS_ROUND (iFrameIdx * (1000 / sSvcParam.fMaxFrameRate));
-    int iEncFrames = pPtrEnc->EncodeFrame (pSrcPic, &sFbi);
+    int iEncFrames = pPtrEnc->EncodeFrame (bCanBeRead ? pSrcPic : NULL, &sFbi);
     iTotal += WelsTime() - iStart;
-    ++ iFrameIdx;
+    if (bCanBeRead)
+      ++ iFrameIdx;
+    if (videoFrameTypeInvalid == sFbi.eFrameType && iEncFrames == cmResultSuccess) {
+      // no frame output yet, or none left
+      if (!bCanBeRead)
+        break;
+      continue;
+    }
     if (videoFrameTypeSkip == sFbi.eFrameType) {
       continue;
     }
@@ -64,6 +64,47 @@ namespace WelsDec {
  */
 uint8_t* DetectStartCodePrefix (const uint8_t* kpBuf, int32_t* pOffset, int32_t iBufSize);
 
+/*!
+ *************************************************************************************
+ * \brief   Scan for the next start code or emulation prevention candidate,
+ *          i.e. 0x00 0x00 followed by a byte no greater than 0x03
+ *
+ * \param   kpSrc       bitstream payload buffer
+ * \param   iSrcLen     count size of buffer
+ *
+ * \return  offset of the first candidate, iSrcLen if there is none; the bytes
+ *          before it carry no escape and may be copied as they are
+ *
+ * \note    N/A
+ *************************************************************************************
+ */
+int32_t WelsScanNalEscape_c (const uint8_t* kpSrc, int32_t iSrcLen);
+
+#if defined(__cplusplus)
+extern "C" {
+#endif//__cplusplus
+
+/* Offset of the first 0x00 0x00 pair within the whole 16 byte blocks of kpSrc that
+ * can be read one byte ahead, the size of these blocks if there is none */
+#if defined(X86_ASM)
+int32_t WelsScanZeroPair_sse2 (const uint8_t* kpSrc, int32_t iSrcLen);
+#if defined(HAVE_AVX2)
+int32_t WelsScanZeroPair_avx2 (const uint8_t* kpSrc, int32_t iSrcLen);
+#endif
+#endif//X86_ASM
+
+#if defined(HAVE_NEON_AARCH64)
+int32_t WelsScanZeroPair_AArch64_neon (const uint8_t* kpSrc, int32_t iSrcLen);
+#endif//HAVE_NEON_AARCH64
+
+#if defined(__cplusplus)
+}
+#endif//__cplusplus
+
+// the vector scan for the CPU, NULL if there is none
+PScanNalEscapeFunc GetNalScanVectorFunc (uint32_t uiCpuFlag);
+void InitNalScanFunc (PWelsDecoderContext pCtx, uint32_t uiCpuFlag);
+
 /*!
  *************************************************************************************
  * \brief   to parse network abstraction layer unit,
@@ -78,6 +78,18 @@ static const uint8_t g_kRenormTable256[256] = {
   1, 1, 1, 1, 1, 1, 1, 1
 };
 
+// renorm shift indexed by (uiRange >> 3), valid for the range of 4 up to 511 found after decoding a regular bin
+static const uint8_t g_kRenormTable64[64] = {
+  6, 5, 4, 4, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2,
+  1, 1, 1, 1, 1, 1, 1, 1,
+  1, 1, 1, 1, 1, 1, 1, 1,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0,
+  0, 0, 0, 0, 0, 0, 0, 0
+};
+
 
 //1. CABAC context initialization
 void WelsCabacGlobalInit(PWelsDecoderContext pCabacCtx);
@@ -101,6 +113,64 @@ int32_t DecodeExpBypassCabac (PWelsCabacDecEngine pDecEngine, int32_t iCount, ui
 uint32_t DecodeUEGLevelCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t& uiBinVal);
 int32_t DecodeUEGMvCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t iMaxC,  uint32_t& uiCode);
 
+//6. inlined decoding of the residual hot path, bit exact with DecodeBinCabac () and DecodeBypassCabac ().
+//   The MPS/LPS decision selects the new offset and range by masks instead of branches, a single table lookup gives
+//   the renorm shift of both cases, and the 64-bit offset window is refilled 32 bits at a time only when exhausted.
+static inline int32_t RefillCabacInline (PWelsCabacDecEngine pDecEngine) {
+  uint32_t uiVal = 0;
+  int32_t iNumBitsRead = 0;
+  int32_t iErrorInfo = Read32BitsCabac (pDecEngine, uiVal, iNumBitsRead);
+  pDecEngine->uiOffset = (pDecEngine->uiOffset << iNumBitsRead) | uiVal;
+  pDecEngine->iBitsLeft += iNumBitsRead;
+  if (iErrorInfo && pDecEngine->iBitsLeft < 0) {
+    return iErrorInfo;
+  }
+  return ERR_NONE;
+}
+
+static inline int32_t DecodeBinCabacInline (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t& uiBinVal) {
+  const uint32_t uiState = pBinCtx->uiState;
+  const uint32_t uiMps = pBinCtx->uiMPS;
+  const uint64_t uiRangeLps = g_kuiCabacRangeLps[uiState][ (pDecEngine->uiRange >> 6) & 0x03];
+  uint64_t uiRange = pDecEngine->uiRange - uiRangeLps;
+  const uint64_t uiScaledRange = uiRange << pDecEngine->iBitsLeft;
+  const uint64_t uiLpsMask = 0 - (uint64_t) (pDecEngine->uiOffset >= uiScaledRange); // all ones for LPS
+  const uint32_t uiLps = (uint32_t) (uiLpsMask & 0x01);
+
+  pDecEngine->uiOffset -= uiScaledRange & uiLpsMask;
+  uiRange ^= (uiRange ^ uiRangeLps) & uiLpsMask;
+  uiBinVal = uiMps ^ uiLps;
+  pBinCtx->uiMPS = (uint8_t) (uiMps ^ (uiLps & (uiState == 0)));
+  pBinCtx->uiState = g_kuiStateTransTable[uiState][uiLps ^ 0x01];
+
+  const int32_t iRenorm = g_kRenormTable64[uiRange >> 3];
+  pDecEngine->uiRange = uiRange << iRenorm;
+  pDecEngine->iBitsLeft -= iRenorm;
+  if (pDecEngine->iBitsLeft > 0) {
+    return ERR_NONE;
+  }
+  return RefillCabacInline (pDecEngine);
+}
+
+static inline int32_t DecodeBypassCabacInline (PWelsCabacDecEngine pDecEngine, uint32_t& uiBinVal) {
+  if (pDecEngine->iBitsLeft <= 0) {
+    uint32_t uiVal = 0;
+    int32_t iNumBitsRead = 0;
+    int32_t iErrorInfo = Read32BitsCabac (pDecEngine, uiVal, iNumBitsRead);
+    pDecEngine->uiOffset = (pDecEngine->uiOffset << iNumBitsRead) | uiVal;
+    pDecEngine->iBitsLeft = iNumBitsRead;
+    if (iErrorInfo && iNumBitsRead == 0) {
+      return iErrorInfo;
+    }
+  }
+  --pDecEngine->iBitsLeft;
+  const uint64_t uiScaledRange = pDecEngine->uiRange << pDecEngine->iBitsLeft;
+  const uint64_t uiOneMask = 0 - (uint64_t) (pDecEngine->uiOffset >= uiScaledRange);
+  pDecEngine->uiOffset -= uiScaledRange & uiOneMask;
+  uiBinVal = (uint32_t) (uiOneMask & 0x01);
+  return ERR_NONE;
+}
+
 #define WELS_CABAC_HALF    0x01FE
 #define WELS_CABAC_QUARTER 0x0100
 #define WELS_CABAC_FALSE_RETURN(iErrorInfo) \
@@ -66,6 +66,18 @@ void  DeblockingInit (PDeblockingFunc pDeblockingFunc,  int32_t iCpu);
  */
 void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb);
 
+/*!
+ * \brief   deblocking filtering of MBs within target slice
+ *
+ * \param   pCtx        Wels decoder context
+ * \param   kiFirstMbXy first MB to be filtered
+ * \param   kiMbNum     number of MBs to be filtered
+ *
+ * \return  NONE
+ */
+void WelsDeblockingFilterMbRange (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb,
+                                  const int32_t kiFirstMbXy, const int32_t kiMbNum);
+
 /*!
  * \brief   pixel deblocking filtering
  *
@@ -50,6 +50,10 @@ int32_t WelsDecodeMbCabacISliceBaseMode0(PWelsDecoderContext pCtx, uint32_t& uiE
 int32_t WelsDecodeMbCabacPSliceBaseMode0(PWelsDecoderContext pCtx, PWelsNeighAvail pNeighAvail, uint32_t& uiEosFlag);
 
 int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx); //construction based on slice
+int32_t WelsTargetSliceMarkDecoded (PWelsDecoderContext pCtx); //MB accounting of slice whose construction is deferred
+//deferred construction of slice, by MB rows. kbParallel: slices are reconstructed concurrently, so only the slices
+//not filtered across slice boundaries are deblocked here, the others are left to the caller
+int32_t WelsTargetSliceReconstruction (PWelsDecoderContext pCtx, const bool kbParallel);
 
 int32_t WelsDecodeSlice (PWelsDecoderContext pCtx, bool bFirstSliceInLayer, PNalUnit pNalCur);
 
@@ -56,13 +56,47 @@
 #include "expand_pic.h"
 #include "mc.h"
 #include "memory_align.h"
+#include "measure_time.h"
 
 namespace WelsDec {
+class CWelsDecTaskManage;
+class CWelsDecFrameTask;
+
 #define MAX_PRED_MODE_ID_I16x16  3
 #define MAX_PRED_MODE_ID_CHROMA  3
 #define MAX_PRED_MODE_ID_I4x4    8
 #define  WELS_QP_MAX    51
 
+/*
+ *  decoding stages timed per slice or MB row when built with WELS_STAGE_TIMING, the reconstruction includes the MC
+ *  and the deblocking done along with it. The MC is timed per MB, so only with WELS_STAGE_TIMING_MB defined as well.
+ */
+enum EDecStage {
+  DEC_STAGE_NAL_PARSE = 0,
+  DEC_STAGE_ENTROPY_DECODE,
+  DEC_STAGE_RECONSTRUCTION,
+  DEC_STAGE_MC,
+  DEC_STAGE_DEBLOCKING,
+  DEC_STAGE_ERROR_CONCEALMENT,
+  DEC_STAGE_NUM
+};
+
+#ifdef WELS_STAGE_TIMING
+#define WELS_STAGE_TIMING_BEGIN(iStart) const int64_t iStart = WelsTime()
+#define WELS_STAGE_TIMING_END(pCtx, eStage, iStart) ((pCtx)->iStageTime[eStage] += WelsTime() - (iStart))
+#else
+#define WELS_STAGE_TIMING_BEGIN(iStart)
+#define WELS_STAGE_TIMING_END(pCtx, eStage, iStart)
+#endif
+
+#if defined(WELS_STAGE_TIMING) && defined(WELS_STAGE_TIMING_MB)
+#define WELS_MB_TIMING_BEGIN(iStart) WELS_STAGE_TIMING_BEGIN (iStart)
+#define WELS_MB_TIMING_END(pCtx, eStage, iStart) WELS_STAGE_TIMING_END (pCtx, eStage, iStart)
+#else
+#define WELS_MB_TIMING_BEGIN(iStart)
+#define WELS_MB_TIMING_END(pCtx, eStage, iStart)
+#endif
+
 #define LONG_TERM_REF
 typedef struct SWels_Cabac_Element {
   uint8_t uiState;
@@ -137,6 +171,7 @@ typedef struct TagPpsBsInfo {
 typedef void (*PGetIntraPredFunc) (uint8_t* pPred, const int32_t kiLumaStride);
 typedef void (*PIdctResAddPredFunc) (uint8_t* pPred, const int32_t kiStride, int16_t* pRs);
 typedef void (*PIdctFourResAddPredFunc) (uint8_t* pPred, int32_t iStride, int16_t* pRs, const int8_t* pNzc);
+typedef int32_t (*PScanNalEscapeFunc) (const uint8_t* kpSrc, int32_t iSrcLen);
 typedef void (*PExpandPictureFunc) (uint8_t* pDst, const int32_t kiStride, const int32_t kiPicWidth,
                                     const int32_t kiPicHeight);
 
@@ -227,6 +262,38 @@ enum {
   OVERWRITE_SUBSETSPS = 1 << 2
 };
 
+/*
+ *  SMbData: MB level data arrays of a picture, which are filled by parsing and used by reconstruction
+ */
+typedef struct TagMbData {
+  int16_t*  pMbType[LAYER_NUM_EXCHANGEABLE];                      /* mb type */
+  int16_t (*pMv[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM][MV_A]; //[LAYER_NUM_EXCHANGEABLE   MB_BLOCK4x4_NUM*]
+  int8_t (*pRefIndex[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM];
+  bool*   pNoSubMbPartSizeLessThan8x8Flag[LAYER_NUM_EXCHANGEABLE];
+  bool*   pTransformSize8x8Flag[LAYER_NUM_EXCHANGEABLE];
+  int8_t* pLumaQp[LAYER_NUM_EXCHANGEABLE];        /*mb luma_qp*/
+  int8_t  (*pChromaQp[LAYER_NUM_EXCHANGEABLE])[2];                                        /*mb chroma_qp*/
+  int16_t (*pMvd[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM][MV_A]; //[LAYER_NUM_EXCHANGEABLE   MB_BLOCK4x4_NUM*]
+  uint16_t* pCbfDc[LAYER_NUM_EXCHANGEABLE];
+  int8_t  (*pNzc[LAYER_NUM_EXCHANGEABLE])[24];
+  int8_t  (*pNzcRs[LAYER_NUM_EXCHANGEABLE])[24];
+  int16_t (*pScaledTCoeff[LAYER_NUM_EXCHANGEABLE])[MB_COEFF_LIST_SIZE]; /*need be aligned*/
+  int8_t  (*pIntraPredMode[LAYER_NUM_EXCHANGEABLE])[8]; //0~3 top4x4 ; 4~6 left 4x4; 7 intra16x16
+  int8_t (*pIntra4x4FinalMode[LAYER_NUM_EXCHANGEABLE])[MB_BLOCK4x4_NUM];
+  uint8_t* pIntraNxNAvailFlag[LAYER_NUM_EXCHANGEABLE];
+  int8_t*  pChromaPredMode[LAYER_NUM_EXCHANGEABLE];
+  int8_t*  pCbp[LAYER_NUM_EXCHANGEABLE];
+  uint8_t (*pMotionPredFlag[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_PARTITION_SIZE]; // 8x8
+  int8_t (*pSubMbType[LAYER_NUM_EXCHANGEABLE])[MB_SUB_PARTITION_SIZE];
+  int32_t* pSliceIdc[LAYER_NUM_EXCHANGEABLE];         // using int32_t for slice_idc
+  int8_t*  pResidualPredFlag[LAYER_NUM_EXCHANGEABLE];
+  int8_t*  pInterPredictionDoneFlag[LAYER_NUM_EXCHANGEABLE];
+  bool*    pMbCorrectlyDecodedFlag[LAYER_NUM_EXCHANGEABLE];
+  bool*    pMbRefConcealedFlag[LAYER_NUM_EXCHANGEABLE];
+  uint32_t iMbWidth;
+  uint32_t iMbHeight;
+} SMbData, *PMbData;
+
 /*
  *  SWelsDecoderContext: to maintail all modules data over decoder@framework
  */
@@ -268,34 +335,7 @@ typedef struct TagWelsDecoderContext {
   int32_t
   iDecBlockOffsetArray[24];     // address talbe for sub 4x4 block in intra4x4_mb, so no need to caculta the address every time.
 
-  struct {
-    int16_t*  pMbType[LAYER_NUM_EXCHANGEABLE];                      /* mb type */
-    int16_t (*pMv[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM][MV_A]; //[LAYER_NUM_EXCHANGEABLE   MB_BLOCK4x4_NUM*]
-    int8_t (*pRefIndex[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM];
-    bool*   pNoSubMbPartSizeLessThan8x8Flag[LAYER_NUM_EXCHANGEABLE];
-    bool*   pTransformSize8x8Flag[LAYER_NUM_EXCHANGEABLE];
-    int8_t* pLumaQp[LAYER_NUM_EXCHANGEABLE];        /*mb luma_qp*/
-    int8_t  (*pChromaQp[LAYER_NUM_EXCHANGEABLE])[2];                                        /*mb chroma_qp*/
-    int16_t (*pMvd[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_BLOCK4x4_NUM][MV_A]; //[LAYER_NUM_EXCHANGEABLE   MB_BLOCK4x4_NUM*]
-    uint16_t* pCbfDc[LAYER_NUM_EXCHANGEABLE];
-    int8_t  (*pNzc[LAYER_NUM_EXCHANGEABLE])[24];
-    int8_t  (*pNzcRs[LAYER_NUM_EXCHANGEABLE])[24];
-    int16_t (*pScaledTCoeff[LAYER_NUM_EXCHANGEABLE])[MB_COEFF_LIST_SIZE]; /*need be aligned*/
-    int8_t  (*pIntraPredMode[LAYER_NUM_EXCHANGEABLE])[8]; //0~3 top4x4 ; 4~6 left 4x4; 7 intra16x16
-    int8_t (*pIntra4x4FinalMode[LAYER_NUM_EXCHANGEABLE])[MB_BLOCK4x4_NUM];
-    uint8_t* pIntraNxNAvailFlag[LAYER_NUM_EXCHANGEABLE];
-    int8_t*  pChromaPredMode[LAYER_NUM_EXCHANGEABLE];
-    int8_t*  pCbp[LAYER_NUM_EXCHANGEABLE];
-    uint8_t (*pMotionPredFlag[LAYER_NUM_EXCHANGEABLE][LIST_A])[MB_PARTITION_SIZE]; // 8x8
-    int8_t (*pSubMbType[LAYER_NUM_EXCHANGEABLE])[MB_SUB_PARTITION_SIZE];
-    int32_t* pSliceIdc[LAYER_NUM_EXCHANGEABLE];         // using int32_t for slice_idc
-    int8_t*  pResidualPredFlag[LAYER_NUM_EXCHANGEABLE];
-    int8_t*  pInterPredictionDoneFlag[LAYER_NUM_EXCHANGEABLE];
-    bool*    pMbCorrectlyDecodedFlag[LAYER_NUM_EXCHANGEABLE];
-    bool*    pMbRefConcealedFlag[LAYER_NUM_EXCHANGEABLE];
-    uint32_t iMbWidth;
-    uint32_t iMbHeight;
-  } sMb;
+  SMbData                       sMb;
 
 // reconstruction picture
   PPicture                      pDec;                   //pointer to current picture being reconstructed
@@ -395,6 +435,9 @@ typedef struct TagWelsDecoderContext {
   PGetIntraPred8x8Func pGetI8x8LumaPredFunc[14];
   PIdctResAddPredFunc  pIdctResAddPredFunc8x8;
 
+//Start code and emulation prevention scan over the input bitstream
+  PScanNalEscapeFunc  pScanNalEscapeFunc;
+
 //For error concealment
   SCopyFunc sCopyFunc;
   /* For Deblocking */
@@ -449,6 +492,15 @@ typedef struct TagWelsDecoderContext {
   bool bDequantCoeff4x4Init;
   bool bUseScalingList;
   CMemoryAlign*     pMemAlign;
+// For frame level multi-threading
+  int32_t iThreadCount;                 // number of decoding threads, frame level multi-threading is used when larger than 1
+  bool bSliceThreading;                 // threads only reconstruct the slices of the picture being decoded, no frame tasks
+  CWelsDecTaskManage* pTaskManage;      // decoding tasks manager, NULL for single thread
+  CWelsDecFrameTask* pFrameTask;        // task running on the context, only set in the context copies of tasks
+  SDecPictureAllocator sPicAllocator;   // application allocator of picture buffers, used when pfGetBuffer is set
+  SThreadPoolParam sThreadPoolParam;    // thread pool of the decoding tasks, the global pool used when not bThreadPoolParam
+  bool bThreadPoolParam;
+  int64_t iStageTime[DEC_STAGE_NUM];    // accumulated time of the decoding stages in microseconds, see EDecStage
 } SWelsDecoderContext, *PWelsDecoderContext;
 
 static inline void ResetActiveSPSForEachLayer (PWelsDecoderContext pCtx) {
@@ -98,6 +98,21 @@ int32_t WelsInitStaticMemory (PWelsDecoderContext pCtx);
  */
 void WelsFreeStaticMemory (PWelsDecoderContext pCtx);
 
+/*!
+ * \brief   request memory of MB data (pMbData->iMbWidth x pMbData->iMbHeight MBs) for the layer kiIdx
+ */
+int32_t InitialMbData (CMemoryAlign* pMa, SMbData* pMbData, const int32_t kiIdx);
+
+/*!
+ * \brief   free memory of MB data for the layer kiIdx
+ */
+void UninitialMbData (CMemoryAlign* pMa, SMbData* pMbData, const int32_t kiIdx);
+
+/*!
+ * \brief   set the MB data pointers of pCurDq to the MB data of the picture being decoded
+ */
+void InitCurDqLayerData (PWelsDecoderContext pCtx, PDqLayer pCurDq);
+
 /*!
  * \brief   request memory when maximal picture width and height are available
  */
@@ -35,6 +35,7 @@
 #define WELS_PICTURE_H__
 
 #include "typedefs.h"
+#include "codec_app_def.h"
 
 namespace WelsDec {
 
@@ -63,7 +64,7 @@ int32_t         iFramePoc;              // frame POC
 /*******************************sef_definition for misc use****************************/
 bool            bUsedAsRef;                                                     //for ref pic management
 bool            bIsLongRef;     // long term reference frame flag       //for ref pic management
-uint8_t         uiRefCount;
+uint8_t         uiRefCount;     // number of in-flight decoding tasks holding this picture, it can not be reused before released
 bool            bAvailableFlag; // indicate whether it is available in this picture memory block.
 
 bool            bIsComplete;    // indicate whether current picture is complete, not from EC
@@ -82,6 +83,14 @@ bool bNewSeqBegin;
 int32_t iMbEcedNum;
 int32_t iMbEcedPropNum;
 int32_t iMbNum;
+
+/*******************************for frame level multi-threading****************************/
+bool            bRecInProgress;  // reconstruction of this picture is still running on a decoding task
+int32_t         iReadyMbRows;    // MB rows finished (deblocked and padded), iMbHeight + 1 when bottom padding is done also
+
+/*******************************for picture buffers owned by application****************************/
+SDecPictureAllocator* pAllocator; // allocator of the planes, NULL when the planes are in pBuffer[0]
+void*           pUserBuffer;      // buffer got from pAllocator, released when the picture is reused or freed
 } SPicture, *PPicture; // "Picture" declaration is comflict with Mac system
 
 } // namespace WelsDec
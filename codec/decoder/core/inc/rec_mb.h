@@ -65,6 +65,9 @@ typedef struct TagMCRefMember {
 
   int32_t iPicWidth;
   int32_t iPicHeight;
+
+  PPicture pRefPic;
+  CWelsDecFrameTask* pFrameTask; // not NULL when the reference picture may be still under reconstruction
 } sMCRefMember;
 
 void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iYOffset, SMcFunc* pMCFunc,
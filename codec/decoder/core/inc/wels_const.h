@@ -62,4 +62,6 @@
 #define MAX_ACCESS_UNIT_CAPACITY 7077888 //Maximum AU size in bytes for level 5.2 for single frame
 #define MAX_MACROBLOCK_CAPACITY 5000 //Maximal legal MB capacity, 15000 bits is enough
 
+#define MAX_THREADS_NUM 16 //maximal number of decoding threads for frame level multi-threading
+
 #endif//WELS_CONST_H__
@@ -0,0 +1,259 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_decoder_thread.h
+ *
+ * \brief   multi-threading of decoder, in two modes sharing the tasks below: slices are parsed on the calling
+ *          thread and recorded, their reconstruction is deferred to the end of the picture.
+ *          Frame threading: the picture is reconstructed by a frame task queued to the thread pool while the next
+ *          ones are parsed, so pictures are output with a delay of thread number frames.
+ *          Slice threading (DECODER_OPTION_SLICE_THREADING): the frame task runs on the calling thread as soon as
+ *          the picture is parsed, nothing is queued but the slice tasks, so pictures are output with no delay.
+ *          In both modes the slices of one picture are reconstructed in parallel by slice tasks of the pool
+ *          helping the frame task, then deblocked across their boundaries in decoding order.
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELS_DECODER_THREAD_H__
+#define WELS_DECODER_THREAD_H__
+
+#include "typedefs.h"
+#include "WelsThreadLib.h"
+#include "WelsThreadPool.h"
+#include "decoder_context.h"
+
+namespace WelsDec {
+
+/*
+ *  SSliceReconInfo: snapshot of a parsed slice, all what the reconstruction of the slice needs
+ */
+typedef struct TagSliceReconInfo {
+  SDqLayer              sDqLayer;               // MB data pointers refer to the MB data owned by the frame task
+  SSps                  sSps;
+  SPps                  sPps;
+  SPredWeightTabSyn     sPredWeightTable;
+  PPicture              pRefList[MAX_DPB_COUNT];        // LIST_0 reference pictures of the slice
+} SSliceReconInfo, *PSliceReconInfo;
+
+class CWelsDecTaskManage;
+
+/*
+ *  CWelsDecFrameTask: reconstruction, deblocking and padding of one picture
+ */
+class CWelsDecFrameTask : public WelsCommon::IWelsTask, public WelsCommon::IWelsTaskSink {
+ public:
+  CWelsDecFrameTask (CWelsDecTaskManage* pManage);
+  virtual ~CWelsDecFrameTask();
+
+  int32_t Init (CMemoryAlign* pMa);
+  void    Uninit (CMemoryAlign* pMa);
+
+  //IWelsTask
+  virtual int Execute();
+
+  //IWelsTaskSink
+  virtual int OnTaskExecuted();
+  virtual int OnTaskCancelled();
+
+  // called by the slice reconstruction when MBs [kiFirstMbXy, kiEndMbXy) get their final pixels except for the bottom
+  // rows which may be still modified by the deblocking of the MB row below
+  void    OnMbsFiltered (const int32_t kiFirstMbXy, const int32_t kiEndMbXy);
+  // called by the motion compensation, block till the MB rows [0, kiMbRows) of the reference picture are ready
+  void    WaitRefPicRows (PPicture pRefPic, const int32_t kiMbRows);
+
+ private:
+  friend class CWelsDecTaskManage;
+  friend class CWelsDecSliceTask;
+
+  int32_t PrepareContext (PWelsDecoderContext pSrcCtx);
+  int32_t ReconstructSlices();
+  int32_t ReconstructSlicesParallel();
+  int32_t ReconstructSlice (PWelsDecoderContext pCtx, const int32_t kiIdx, const bool kbParallel);
+  // called by the frame task and by the slice tasks helping it, until no slice is left
+  void    ReconstructNextSlices (PWelsDecoderContext pCtx);
+  void    PadRows (const int32_t kiFirstRow, const int32_t kiEndRow);
+  void    PadTopBottom (const bool kbTop);
+  void    PublishRows (const int32_t kiMbRows);
+  int32_t AddRefPic (PPicture pRefPic);
+  void    ReleasePictures();
+
+  CWelsDecTaskManage*   m_pManage;
+  PWelsDecoderContext   m_pCtx;                 // context copy used by the reconstruction of the task
+  SMbData               m_sMbData;              // MB data of the picture, filled by parsing
+
+  PPicture              m_pPic;                 // picture to be reconstructed
+  PSliceReconInfo       m_pSlices;
+  int32_t               m_iSliceNum;
+  int32_t               m_iSliceCapacity;
+  int32_t               m_iNextSlice;           // next slice to be reconstructed in parallel, under the lock
+  int32_t               m_iSliceError;
+  PPicture              m_pRefPic[MAX_DPB_COUNT];       // reference pictures held by the task
+  int32_t               m_iRefPicNum;
+
+  bool                  m_bSync;                // picture is reconstructed on the calling thread
+  bool                  m_bRef;                 // picture is used as reference, so the padding is required
+  bool                  m_bDone;
+  int32_t               m_iErrorCode;
+
+  int32_t               m_iFilteredMbXy;        // MBs before it have been deblocked
+  int32_t               m_iPaddedRows;
+
+  // cache of reference picture rows known as ready, to bypass the locking for most of MC blocks
+  PPicture              m_pReadyRefPic[MAX_DPB_COUNT];
+  int32_t               m_iReadyRefRows[MAX_DPB_COUNT];
+  int32_t               m_iReadyRefNum;
+
+  // output information stored at the end of parsing, returned when the task is popped
+  bool                  m_bOutput;
+  uint8_t*              m_pDst[3];
+  SBufferInfo           m_sDstInfo;
+  uint8_t*              m_pOutBuffer;           // output picture copy when picture buffers are reallocated
+  int32_t               m_iOutBufferSize;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsDecFrameTask);
+};
+
+/*
+ *  CWelsDecSliceTask: reconstruction of slices on behalf of a frame task, with its own context copy
+ */
+class CWelsDecSliceTask : public WelsCommon::IWelsTask, public WelsCommon::IWelsTaskSink {
+ public:
+  CWelsDecSliceTask (CWelsDecTaskManage* pManage);
+  virtual ~CWelsDecSliceTask();
+
+  int32_t Init (CMemoryAlign* pMa);
+  void    Uninit (CMemoryAlign* pMa);
+
+  //IWelsTask
+  virtual int Execute();
+
+  //IWelsTaskSink
+  virtual int OnTaskExecuted();
+  virtual int OnTaskCancelled();
+
+ private:
+  friend class CWelsDecTaskManage;
+
+  CWelsDecTaskManage*   m_pManage;
+  PWelsDecoderContext   m_pCtx;
+  CWelsDecFrameTask*    m_pFrameTask;           // frame task helped, NULL if revoked before the task started
+  bool                  m_bBusy;                // queued to the thread pool and not executed yet
+  bool                  m_bRunning;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsDecSliceTask);
+};
+
+/*
+ *  CWelsDecTaskManage: frame tasks management, all the interfaces are called on the decoding thread except for
+ *  the ones used by the frame tasks
+ */
+class CWelsDecTaskManage {
+ public:
+  CWelsDecTaskManage();
+  virtual ~CWelsDecTaskManage();
+
+  static CWelsDecTaskManage* CreateTaskManage (PWelsDecoderContext pCtx, const int32_t kiThreadNum);
+  static void DestroyTaskManage (CWelsDecTaskManage** ppTaskManage);
+
+  // MB data of the picture currently being parsed, NULL if none
+  SMbData*  GetMbData();
+  // bind a frame task to pCtx->pDec at the start of picture decoding
+  int32_t   StartPicture (PWelsDecoderContext pCtx);
+  // record the slice parsed for later reconstruction, or reconstruct it right away when it can not be deferred
+  int32_t   ConstructSlice (PWelsDecoderContext pCtx);
+  // reconstruct the current picture on the calling thread, required before error concealment
+  void      SyncPicture (PWelsDecoderContext pCtx);
+  // called when parsing of pCtx->pDec finished, just before it is set to NULL
+  void      FinishPicture (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferInfo* pDstInfo, const bool kbRef);
+  // wait for all the tasks queued, reference pictures held by them are released
+  void      WaitForTasks();
+  // release all the pictures held since picture buffers will be reallocated, outputs pending are kept as copies
+  void      DetachPictures();
+  // pop the oldest picture decoded when more than the thread number are pending or when flushing, with slice
+  // threading as soon as it is decoded
+  bool      GetOutput (uint8_t** ppDst, SBufferInfo* pDstInfo, const bool kbFlush);
+  int32_t   GetPendingNum();
+  int32_t   GetThreadNum() {
+    return m_iThreadNum;
+  }
+  bool      IsSliceThreading() {
+    return m_bSliceThreading;
+  }
+
+ private:
+  friend class CWelsDecFrameTask;
+  friend class CWelsDecSliceTask;
+
+  int32_t   Init (PWelsDecoderContext pCtx, const int32_t kiThreadNum);
+  void      Uninit();
+
+  bool      CanDeferSlice (PWelsDecoderContext pCtx);
+  void      WaitTask (CWelsDecFrameTask* pTask);
+  void      PopTask();
+  void      ReleaseTask (CWelsDecFrameTask* pTask);
+  int32_t   SaveOutput (CWelsDecFrameTask* pTask);
+
+  // called by the frame tasks
+  void      SetReadyRows (PPicture pPic, const int32_t kiMbRows, const bool kbComplete);
+  int32_t   WaitReadyRows (PPicture pPic, const int32_t kiMbRows);
+  void      OnTaskDone (CWelsDecFrameTask* pTask);
+  // queue up to kiMaxNum idle slice tasks to help pFrameTask, returns the number queued
+  int32_t   StartSliceTasks (CWelsDecFrameTask* pFrameTask, const int32_t kiMaxNum);
+  // revoke the slice tasks not started yet and wait for the running ones
+  void      StopSliceTasks (CWelsDecFrameTask* pFrameTask);
+  CWelsDecFrameTask* BeginSliceTask (CWelsDecSliceTask* pTask);
+  void      OnSliceTaskDone (CWelsDecSliceTask* pTask);
+
+  PWelsDecoderContext           m_pCtx;
+  WelsCommon::CWelsThreadPool*  m_pThreadPool;
+  int32_t                       m_iThreadNum;
+  bool                          m_bSliceThreading;      // frame tasks executed on the calling thread, never queued
+
+  CWelsDecFrameTask*            m_pTasks[MAX_THREADS_NUM + 2];
+  int32_t                       m_iTaskNum;
+  CWelsDecFrameTask*            m_pPending[MAX_THREADS_NUM + 2];  // in decoding order
+  int32_t                       m_iPendingNum;
+  CWelsDecFrameTask*            m_pCurTask;     // task of the picture being parsed
+  CWelsDecSliceTask*            m_pSliceTasks[MAX_THREADS_NUM];
+  int32_t                       m_iSliceTaskNum;
+
+  WELS_MUTEX                    m_hMutex;
+  WELS_COND                     m_hCond;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsDecTaskManage);
+};
+
+} // namespace WelsDec
+
+#endif//WELS_DECODER_THREAD_H__
@@ -45,6 +45,7 @@
 #include "decoder_core.h"
 #include "bit_stream.h"
 #include "memory_align.h"
+#include "cpu_core.h"
 
 namespace WelsDec {
 /*!
@@ -86,6 +87,75 @@ uint8_t* DetectStartCodePrefix (const uint8_t* kpBuf, int32_t* pOffset, int32_t
   return NULL;
 }
 
+int32_t WelsScanNalEscape_c (const uint8_t* kpSrc, int32_t iSrcLen) {
+  int32_t iIdx = 0;
+  while (iIdx + 2 < iSrcLen) {
+    // no candidate starts within 8 bytes holding no zero byte
+    if (iIdx + 8 <= iSrcLen) {
+      const uint64_t kuiWord = LD64 (kpSrc + iIdx);
+      if (0 == ((kuiWord - 0x0101010101010101ULL) & ~kuiWord & 0x8080808080808080ULL)) {
+        iIdx += 8;
+        continue;
+      }
+    }
+    const int32_t kiEnd = WELS_MIN (iIdx + 8, iSrcLen - 2);
+    for (; iIdx < kiEnd; ++ iIdx) {
+      if (0 == kpSrc[iIdx] && 0 == kpSrc[iIdx + 1] && kpSrc[iIdx + 2] <= 0x03)
+        return iIdx;
+    }
+  }
+  return iSrcLen;
+}
+
+namespace {
+
+typedef int32_t (*PScanZeroPairFunc) (const uint8_t* kpSrc, int32_t iSrcLen);
+
+/* the kernel skips the runs without any 0x00 0x00 pair, the rare pairs followed by
+ * a byte above 0x03 and the tail shorter than one vector block are checked here */
+template<PScanZeroPairFunc pfScanZeroPair>
+int32_t WelsScanNalEscape_ (const uint8_t* kpSrc, int32_t iSrcLen) {
+  int32_t iIdx = 0;
+  while (iIdx + 2 < iSrcLen) {
+    iIdx += pfScanZeroPair (kpSrc + iIdx, iSrcLen - 1 - iIdx);
+    if (iIdx + 2 >= iSrcLen || 0 != kpSrc[iIdx] || 0 != kpSrc[iIdx + 1])
+      break;
+    if (kpSrc[iIdx + 2] <= 0x03)
+      return iIdx;
+    iIdx += 3;
+  }
+  return iIdx + WelsScanNalEscape_c (kpSrc + iIdx, iSrcLen - iIdx);
+}
+
+} // anon ns
+
+PScanNalEscapeFunc GetNalScanVectorFunc (uint32_t uiCpuFlag) {
+  PScanNalEscapeFunc pfScan = NULL;
+#if defined(X86_ASM)
+  if (uiCpuFlag & WELS_CPU_SSE2) {
+    pfScan = WelsScanNalEscape_<WelsScanZeroPair_sse2>;
+  }
+#if defined(HAVE_AVX2)
+  if (uiCpuFlag & WELS_CPU_AVX2) {
+    pfScan = WelsScanNalEscape_<WelsScanZeroPair_avx2>;
+  }
+#endif
+#endif//X86_ASM
+
+#if defined(HAVE_NEON_AARCH64)
+  if (uiCpuFlag & WELS_CPU_NEON) {
+    pfScan = WelsScanNalEscape_<WelsScanZeroPair_AArch64_neon>;
+  }
+#endif//HAVE_NEON_AARCH64
+  return pfScan;
+}
+
+void InitNalScanFunc (PWelsDecoderContext pCtx, uint32_t uiCpuFlag) {
+  // the vector scans of GetNalScanVectorFunc() are not installed till the decoder output tests pass with them on
+  // SSE2, AVX2 and NEON hosts, a wrong skip corrupts every input
+  pCtx->pScanNalEscapeFunc = WelsScanNalEscape_c;
+}
+
 /*!
  *************************************************************************************
  * \brief   to parse nal unit
@@ -136,79 +136,11 @@ int32_t Read32BitsCabac (PWelsCabacDecEngine pDecEngine, uint32_t& uiValue, int3
 }
 
 int32_t DecodeBinCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t& uiBinVal) {
-  int32_t iErrorInfo = ERR_NONE;
-  uint32_t uiState = pBinCtx->uiState;
-  uiBinVal = pBinCtx->uiMPS;
-  uint64_t uiOffset = pDecEngine->uiOffset;
-  uint64_t uiRange = pDecEngine->uiRange;
-
-  int32_t iRenorm = 1;
-  uint32_t uiRangeLPS = g_kuiCabacRangeLps[uiState][ (uiRange >> 6) & 0x03];
-  uiRange -= uiRangeLPS;
-  if (uiOffset >= (uiRange << pDecEngine->iBitsLeft)) { //LPS
-    uiOffset -= (uiRange << pDecEngine->iBitsLeft);
-    uiBinVal ^= 0x0001;
-    if (!uiState)
-      pBinCtx->uiMPS ^= 0x01;
-    pBinCtx->uiState = g_kuiStateTransTable[uiState][0];
-    iRenorm = g_kRenormTable256[uiRangeLPS];
-    uiRange = (uiRangeLPS << iRenorm);
-  } else {  //MPS
-    pBinCtx->uiState = g_kuiStateTransTable[uiState][1];
-    if (uiRange >= WELS_CABAC_QUARTER) {
-      pDecEngine->uiRange = uiRange;
-      return ERR_NONE;
-    } else {
-      uiRange <<= 1;
-    }
-  }
-  //Renorm
-  pDecEngine->uiRange = uiRange;
-  pDecEngine->iBitsLeft -= iRenorm;
-  if (pDecEngine->iBitsLeft > 0) {
-    pDecEngine->uiOffset = uiOffset;
-    return ERR_NONE;
-  }
-  uint32_t uiVal = 0;
-  int32_t iNumBitsRead = 0;
-  iErrorInfo = Read32BitsCabac (pDecEngine, uiVal, iNumBitsRead);
-  pDecEngine->uiOffset = (uiOffset << iNumBitsRead) | uiVal;
-  pDecEngine->iBitsLeft += iNumBitsRead;
-  if (iErrorInfo && pDecEngine->iBitsLeft < 0) {
-    return iErrorInfo;
-  }
-  return ERR_NONE;
+  return DecodeBinCabacInline (pDecEngine, pBinCtx, uiBinVal);
 }
 
 int32_t DecodeBypassCabac (PWelsCabacDecEngine pDecEngine, uint32_t& uiBinVal) {
-  int32_t iErrorInfo = ERR_NONE;
-  int32_t iBitsLeft = pDecEngine->iBitsLeft;
-  uint64_t uiOffset = pDecEngine->uiOffset;
-  uint64_t uiRangeValue;
-
-
-  if (iBitsLeft <= 0) {
-    uint32_t uiVal = 0;
-    int32_t iNumBitsRead = 0;
-    iErrorInfo = Read32BitsCabac (pDecEngine, uiVal, iNumBitsRead);
-    uiOffset = (uiOffset << iNumBitsRead) | uiVal;
-    iBitsLeft = iNumBitsRead;
-    if (iErrorInfo && iBitsLeft == 0) {
-      return iErrorInfo;
-    }
-  }
-  iBitsLeft--;
-  uiRangeValue = (pDecEngine->uiRange << iBitsLeft);
-  if (uiOffset >= uiRangeValue) {
-    pDecEngine->iBitsLeft = iBitsLeft;
-    pDecEngine->uiOffset = uiOffset - uiRangeValue;
-    uiBinVal = 1;
-    return ERR_NONE;
-  }
-  pDecEngine->iBitsLeft = iBitsLeft;
-  pDecEngine->uiOffset = uiOffset;
-  uiBinVal = 0;
-  return ERR_NONE;
+  return DecodeBypassCabacInline (pDecEngine, uiBinVal);
 }
 
 int32_t DecodeTerminateCabac (PWelsCabacDecEngine pDecEngine, uint32_t& uiBinVal) {
@@ -247,7 +179,7 @@ int32_t DecodeTerminateCabac (PWelsCabacDecEngine pDecEngine, uint32_t& uiBinVal
 int32_t DecodeUnaryBinCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, int32_t iCtxOffset,
                              uint32_t& uiSymVal) {
   uiSymVal = 0;
-  WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx, uiSymVal));
+  WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx, uiSymVal));
   if (uiSymVal == 0) {
     return ERR_NONE;
   } else {
@@ -255,7 +187,7 @@ int32_t DecodeUnaryBinCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinC
     pBinCtx += iCtxOffset;
     uiSymVal = 0;
     do {
-      WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx, uiCode));
+      WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx, uiCode));
       ++uiSymVal;
     } while (uiCode != 0);
     return ERR_NONE;
@@ -268,7 +200,7 @@ int32_t DecodeExpBypassCabac (PWelsCabacDecEngine pDecEngine, int32_t iCount, ui
   int32_t iSymTmp2 = 0;
   uiSymVal = 0;
   do {
-    WELS_READ_VERIFY (DecodeBypassCabac (pDecEngine, uiCode));
+    WELS_READ_VERIFY (DecodeBypassCabacInline (pDecEngine, uiCode));
     if (uiCode == 1) {
       iSymTmp += (1 << iCount);
       ++iCount;
@@ -279,7 +211,7 @@ int32_t DecodeExpBypassCabac (PWelsCabacDecEngine pDecEngine, int32_t iCount, ui
   }
 
   while (iCount--) {
-    WELS_READ_VERIFY (DecodeBypassCabac (pDecEngine, uiCode));
+    WELS_READ_VERIFY (DecodeBypassCabacInline (pDecEngine, uiCode));
     if (uiCode == 1) {
       iSymTmp2 |= (1 << iCount);
     }
@@ -290,14 +222,14 @@ int32_t DecodeExpBypassCabac (PWelsCabacDecEngine pDecEngine, int32_t iCount, ui
 
 uint32_t DecodeUEGLevelCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t& uiCode) {
   uiCode = 0;
-  WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx, uiCode));
+  WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx, uiCode));
   if (uiCode == 0)
     return ERR_NONE;
   else {
     uint32_t uiTmp, uiCount = 1;
     uiCode = 0;
     do {
-      WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx, uiTmp));
+      WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx, uiTmp));
       ++uiCode;
       ++uiCount;
     } while (uiTmp != 0 && uiCount != 13);
@@ -312,14 +244,14 @@ uint32_t DecodeUEGLevelCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBin
 }
 
 int32_t DecodeUEGMvCabac (PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pBinCtx, uint32_t iMaxBin,  uint32_t& uiCode) {
-  WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx + g_kMvdBinPos2Ctx[0], uiCode));
+  WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx + g_kMvdBinPos2Ctx[0], uiCode));
   if (uiCode == 0)
     return ERR_NONE;
   else {
     uint32_t uiTmp, uiCount = 1;
     uiCode = 0;
     do {
-      WELS_READ_VERIFY (DecodeBinCabac (pDecEngine, pBinCtx + g_kMvdBinPos2Ctx[uiCount++], uiTmp));
+      WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pBinCtx + g_kMvdBinPos2Ctx[uiCount++], uiTmp));
       uiCode++;
     } while (uiTmp != 0 && uiCount != 8);
 
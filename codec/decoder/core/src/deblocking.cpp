@@ -277,6 +277,41 @@ void static inline DeblockingBSInsideMBNormal (PDqLayer pCurDqLayer, uint8_t nBS
   }
 }
 
+// P_16x8 and P_8x16 carry one ref and mv per partition, so only the edge between the two partitions
+// needs the mv check, the other inside edges are decided by the nnz alone as for P_16x16
+void static inline DeblockingBSInsidePartitionMb (PDqLayer pCurDqLayer, uint8_t nBS[2][4][4], int8_t* pNnzTab,
+    int32_t iMbXy, int32_t iEdgeDir) {
+  int8_t* iRefIndex = pCurDqLayer->pRefIndex[LIST_0][iMbXy];
+  uint8_t (*pBS)[4] = nBS[iEdgeDir];
+
+  if (pCurDqLayer->pTransformSize8x8Flag[iMbXy]) {
+    int8_t i8x8NnzTab[4];
+    DeblockingBSInsideMBAvsbase8x8 (pNnzTab, nBS, 1);
+    for (int32_t i = 0; i < 4; i++) {
+      int32_t iBlkIdx = i << 2;
+      i8x8NnzTab[i] = (pNnzTab[g_kuiMbCountScan4Idx[iBlkIdx]] | pNnzTab[g_kuiMbCountScan4Idx[iBlkIdx + 1]] |
+                       pNnzTab[g_kuiMbCountScan4Idx[iBlkIdx + 2]] | pNnzTab[g_kuiMbCountScan4Idx[iBlkIdx + 3]]);
+    }
+    // 8x8 blocks 0|1 over 2|3; the second 8x8 of the edge is one to the right for vertical, two down for horizontal
+    int32_t iNextBlk = iEdgeDir ? 2 : 1;
+    int32_t iLastBlk = iEdgeDir ? 1 : 2;
+    pBS[2][0] = pBS[2][1] = BS_EDGE ((i8x8NnzTab[0] | i8x8NnzTab[iNextBlk]), iRefIndex, pCurDqLayer->pMv[LIST_0][iMbXy],
+                                     g_kuiMbCountScan4Idx[iNextBlk << 2], g_kuiMbCountScan4Idx[0]);
+    pBS[2][2] = pBS[2][3] = BS_EDGE ((i8x8NnzTab[iLastBlk] | i8x8NnzTab[3]), iRefIndex, pCurDqLayer->pMv[LIST_0][iMbXy],
+                                     g_kuiMbCountScan4Idx[3 << 2], g_kuiMbCountScan4Idx[iLastBlk << 2]);
+  } else {
+    DeblockingBSInsideMBAvsbase (pNnzTab, nBS, 1);
+    // 4x4 block i of the edge and its neighbour across it
+    int32_t iStep = iEdgeDir ? 1 : 4;
+    int32_t iCross = iEdgeDir ? 4 : 1;
+    for (int32_t i = 0; i < 4; i++) {
+      int32_t iIdx = 2 * iCross + i * iStep;
+      pBS[2][i] = BS_EDGE ((pNnzTab[iIdx] | pNnzTab[iIdx - iCross]), iRefIndex, pCurDqLayer->pMv[LIST_0][iMbXy], iIdx,
+                           iIdx - iCross);
+    }
+  }
+}
+
 uint32_t DeblockingBsMarginalMBAvcbase (PDqLayer pCurDqLayer, int32_t iEdge, int32_t iNeighMb, int32_t iMbXy) {
   int32_t i, j;
   uint32_t uiBSx4;
@@ -852,6 +887,9 @@ void WelsDeblockingMb (PDqLayer pCurDqLayer, PDeblockingFilter  pFilter, int32_t
         } else {
           DeblockingBSInsideMBAvsbase8x8 (pCurDqLayer->pNzc[iMbXyIndex], nBS, 1);
         }
+      } else if (iCurMbType == MB_TYPE_16x8 || iCurMbType == MB_TYPE_8x16) {
+        DeblockingBSInsidePartitionMb (pCurDqLayer, nBS, pCurDqLayer->pNzc[iMbXyIndex], iMbXyIndex,
+                                       iCurMbType == MB_TYPE_16x8);
       } else {
         DeblockingBSInsideMBNormal (pCurDqLayer, nBS, pCurDqLayer->pNzc[iMbXyIndex], iMbXyIndex);
       }
@@ -872,6 +910,14 @@ void WelsDeblockingMb (PDqLayer pCurDqLayer, PDeblockingFilter  pFilter, int32_t
  * \return  NONE
  */
 void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb) {
+  PSlice pCurSlice = &pCtx->pCurDqLayer->sLayerInfo.sSliceInLayer;
+
+  WelsDeblockingFilterMbRange (pCtx, pDeblockMb, pCurSlice->sSliceHeaderExt.sSliceHeader.iFirstMbInSlice,
+                               pCurSlice->iTotalMbInCurSlice);
+}
+
+void WelsDeblockingFilterMbRange (PWelsDecoderContext pCtx, PDeblockingFilterMbFunc pDeblockMb,
+                                  const int32_t kiFirstMbXy, const int32_t kiMbNum) {
   PDqLayer pCurDqLayer = pCtx->pCurDqLayer;
   PSliceHeaderExt pSliceHeaderExt = &pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt;
   int32_t iMbWidth  = pCurDqLayer->iMbWidth;
@@ -881,7 +927,7 @@ void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFun
   memset (&pFilter, 0, sizeof (pFilter));
   PFmo pFmo = pCtx->pFmo;
   int32_t iNextMbXyIndex = 0;
-  int32_t iTotalNumMb = pCurDqLayer->sLayerInfo.sSliceInLayer.iTotalMbInCurSlice;
+  int32_t iTotalNumMb = kiMbNum;
   int32_t iCountNumMb = 0;
   int32_t iBoundryFlag;
   int32_t iFilterIdc = pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.uiDisableDeblockingFilterIdc;
@@ -903,7 +949,7 @@ void WelsDeblockingFilterSlice (PWelsDecoderContext pCtx, PDeblockingFilterMbFun
 
   /* Step2: macroblock deblocking */
   if (0 == iFilterIdc || 2 == iFilterIdc) {
-    iNextMbXyIndex = pSliceHeaderExt->sSliceHeader.iFirstMbInSlice;
+    iNextMbXyIndex = kiFirstMbXy;
     pCurDqLayer->iMbX  = iNextMbXyIndex % iMbWidth;
     pCurDqLayer->iMbY  = iNextMbXyIndex / iMbWidth;
     pCurDqLayer->iMbXyIndex = iNextMbXyIndex;
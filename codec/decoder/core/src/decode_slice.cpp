@@ -47,11 +47,24 @@
 #include "parse_mb_syn_cabac.h"
 #include "rec_mb.h"
 #include "mv_pred.h"
+#include "wels_decoder_thread.h"
 
 #include "cpu_core.h"
 
 namespace WelsDec {
 
+static inline void FilterReconstructedMbs (PWelsDecoderContext pCtx, const int32_t kiFirstMbXy,
+    const int32_t kiEndMbXy, const bool kbDeblocking) {
+  if (kbDeblocking) {
+    WELS_STAGE_TIMING_BEGIN (iDeblockingStart);
+    WelsDeblockingFilterMbRange (pCtx, WelsDeblockingMb, kiFirstMbXy, kiEndMbXy - kiFirstMbXy);
+    WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_DEBLOCKING, iDeblockingStart);
+  }
+  if (NULL != pCtx->pFrameTask) {
+    pCtx->pFrameTask->OnMbsFiltered (kiFirstMbXy, kiEndMbXy);
+  }
+}
+
 int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
   PDqLayer pCurLayer = pCtx->pCurDqLayer;
   PSlice pCurSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
@@ -69,6 +82,14 @@ int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
   int32_t iCountNumMb = 0;
   PDeblockingFilterMbFunc pDeblockMb;
 
+  // MB row N-1 is deblocked once row N is reconstructed, while it is still in cache. Intra prediction of row N
+  // needs the unfiltered samples of row N-1, so a lag of one row keeps the result the same as filtering the slice
+  // afterwards. FMO slices are not in raster scan, they are filtered as a whole.
+  const bool kbRowDeblocking = (pSliceHeader->pPps->uiNumSliceGroups <= 1) && !pCtx->pParam->bParseOnly
+                               && ((pCurSlice->eSliceType == I_SLICE) || (pCurSlice->eSliceType == P_SLICE))
+                               && (1 != pSliceHeader->uiDisableDeblockingFilterIdc);
+  int32_t iFilteredMbXy;
+
   if (!pCtx->bAvcBasedFlag && iCurLayerWidth != pCtx->iCurSeqIntervalMaxPicWidth) {
     return ERR_INFO_WIDTH_MISMATCH;
   }
@@ -77,6 +98,7 @@ int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
   pCurLayer->iMbX  = iNextMbXyIndex % pCurLayer->iMbWidth;
   pCurLayer->iMbY  = iNextMbXyIndex / pCurLayer->iMbWidth;
   pCurLayer->iMbXyIndex = iNextMbXyIndex;
+  iFilteredMbXy = iNextMbXyIndex;
 
   if (0 == iNextMbXyIndex) {
     pCurLayer->pDec->iSpsId = pCtx->pSps->iSpsId;
@@ -98,6 +120,13 @@ int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
 
         return ERR_INFO_MB_RECON_FAIL;
       }
+      if (kbRowDeblocking && pCurLayer->iMbX == pCurLayer->iMbWidth - 1) {
+        const int32_t kiRowStartMbXy = iNextMbXyIndex + 1 - pCurLayer->iMbWidth;
+        if (kiRowStartMbXy > iFilteredMbXy) {
+          FilterReconstructedMbs (pCtx, iFilteredMbXy, kiRowStartMbXy, true);
+          iFilteredMbXy = kiRowStartMbXy;
+        }
+      }
     }
 
     ++iCountNumMb;
@@ -139,17 +168,117 @@ int32_t WelsTargetSliceConstruction (PWelsDecoderContext pCtx) {
 
   pDeblockMb = WelsDeblockingMb;
 
-  if (1 == pSliceHeader->uiDisableDeblockingFilterIdc
+  if (kbRowDeblocking) {
+    if (pSliceHeader->iFirstMbInSlice + iCountNumMb > iFilteredMbXy) {
+      FilterReconstructedMbs (pCtx, iFilteredMbXy, pSliceHeader->iFirstMbInSlice + iCountNumMb, true);
+    }
+  } else if (1 == pSliceHeader->uiDisableDeblockingFilterIdc
       || pCtx->pCurDqLayer->sLayerInfo.sSliceInLayer.iTotalMbInCurSlice <= 0) {
     return ERR_NONE;//NO_SUPPORTED_FILTER_IDX
   } else {
+    WELS_STAGE_TIMING_BEGIN (iDeblockingStart);
     WelsDeblockingFilterSlice (pCtx, pDeblockMb);
+    WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_DEBLOCKING, iDeblockingStart);
   }
   // any other filter_idc not supported here, 7/22/2010
 
   return ERR_NONE;
 }
 
+/*
+ * accounting of MBs of the slice parsed, the same as WelsTargetSliceConstruction() does while the reconstruction
+ * is left to WelsTargetSliceReconstruction(). Only used for slices of single slice group.
+ */
+int32_t WelsTargetSliceMarkDecoded (PWelsDecoderContext pCtx) {
+  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+  PSlice pCurSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
+  PSliceHeader pSliceHeader = &pCurSlice->sSliceHeaderExt.sSliceHeader;
+
+  int32_t iTotalMbTargetLayer = pSliceHeader->pSps->uiTotalMbCount;
+  int32_t iNextMbXyIndex = pSliceHeader->iFirstMbInSlice;
+  int32_t iCountNumMb = 0;
+
+  if (0 == iNextMbXyIndex) {
+    pCurLayer->pDec->iSpsId = pCtx->pSps->iSpsId;
+    pCurLayer->pDec->iPpsId = pCtx->pPps->iPpsId;
+
+    pCurLayer->pDec->uiQualityId = pCurLayer->sLayerInfo.sNalHeaderExt.uiQualityId;
+  }
+
+  while (iCountNumMb < pCurSlice->iTotalMbInCurSlice && iNextMbXyIndex < iTotalMbTargetLayer) {
+    ++iCountNumMb;
+    if (!pCurLayer->pMbCorrectlyDecodedFlag[iNextMbXyIndex]) { //already con-ed, overwrite
+      pCurLayer->pMbCorrectlyDecodedFlag[iNextMbXyIndex] = true;
+      pCtx->pDec->iMbEcedPropNum += (pCurLayer->pMbRefConcealedFlag[iNextMbXyIndex] ? 1 : 0);
+      ++pCtx->iTotalNumMbRec;
+    }
+
+    if (pCtx->iTotalNumMbRec > iTotalMbTargetLayer) {
+      WelsLog (& (pCtx->sLogCtx), WELS_LOG_WARNING,
+               "WelsTargetSliceMarkDecoded():::pCtx->iTotalNumMbRec:%d, iTotalMbTargetLayer:%d",
+               pCtx->iTotalNumMbRec, iTotalMbTargetLayer);
+
+      return ERR_INFO_MB_NUM_EXCEED_FAIL;
+    }
+    ++iNextMbXyIndex;
+  }
+
+  pCtx->pDec->iWidthInPixel  = pCurLayer->iMbWidth << 4;
+  pCtx->pDec->iHeightInPixel = pCurLayer->iMbHeight << 4;
+
+  return ERR_NONE;
+}
+
+/*
+ * reconstruction of the slice recorded, each MB row is deblocked once the MB row below has been reconstructed so
+ * that the rows finished can be referred by other pictures before the whole picture is done.
+ * When slices are reconstructed in parallel, the deblocking across slice boundaries has to wait for the neighbouring
+ * slices, only slices with disable_deblocking_filter_idc 2 are self-contained.
+ */
+int32_t WelsTargetSliceReconstruction (PWelsDecoderContext pCtx, const bool kbParallel) {
+  PDqLayer pCurLayer = pCtx->pCurDqLayer;
+  PSlice pCurSlice = &pCurLayer->sLayerInfo.sSliceInLayer;
+  PSliceHeader pSliceHeader = &pCurSlice->sSliceHeaderExt.sSliceHeader;
+
+  const int32_t kiMbWidth = pCurLayer->iMbWidth;
+  const int32_t kiFirstMbXy = pSliceHeader->iFirstMbInSlice;
+  const int32_t kiEndMbXy = WELS_MIN (kiFirstMbXy + pCurSlice->iTotalMbInCurSlice,
+                                      (int32_t)pSliceHeader->pSps->uiTotalMbCount);
+  const bool kbDeblocking = ((pCurSlice->eSliceType == I_SLICE) || (pCurSlice->eSliceType == P_SLICE))
+                            && (kbParallel ? (2 == pSliceHeader->uiDisableDeblockingFilterIdc)
+                                : (1 != pSliceHeader->uiDisableDeblockingFilterIdc));
+  int32_t iFilteredMbXy = kiFirstMbXy;
+
+  for (int32_t iMbXy = kiFirstMbXy; iMbXy < kiEndMbXy; ++iMbXy) {
+    pCurLayer->iMbX  = iMbXy % kiMbWidth;
+    pCurLayer->iMbY  = iMbXy / kiMbWidth;
+    pCurLayer->iMbXyIndex = iMbXy;
+
+    if (WelsTargetMbConstruction (pCtx)) {
+      WelsLog (& (pCtx->sLogCtx), WELS_LOG_WARNING,
+               "WelsTargetSliceReconstruction():::MB(%d, %d) construction error. pCurSlice_type:%d",
+               pCurLayer->iMbX, pCurLayer->iMbY, pCurSlice->eSliceType);
+
+      return ERR_INFO_MB_RECON_FAIL;
+    }
+
+    if (pCurLayer->iMbX == kiMbWidth - 1) {
+      // MBs above the current row are not referred by the intra prediction any more
+      const int32_t kiRowStartMbXy = iMbXy + 1 - kiMbWidth;
+      if (kiRowStartMbXy > iFilteredMbXy) {
+        FilterReconstructedMbs (pCtx, iFilteredMbXy, kiRowStartMbXy, kbDeblocking);
+        iFilteredMbXy = kiRowStartMbXy;
+      }
+    }
+  }
+
+  if (kiEndMbXy > iFilteredMbXy) {
+    FilterReconstructedMbs (pCtx, iFilteredMbXy, kiEndMbXy, kbDeblocking);
+  }
+
+  return ERR_NONE;
+}
+
 int32_t WelsMbInterSampleConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer,
                                        uint8_t* pDstY, uint8_t* pDstU, uint8_t* pDstV, int32_t iStrideL, int32_t iStrideC) {
   int32_t iMbXy = pCurLayer->iMbXyIndex;
@@ -195,7 +324,9 @@ int32_t WelsMbInterConstruction (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   pDstCb = pCurLayer->pDec->pData[1] + ((iMbY * iChromaStride + iMbX) << 3);
   pDstCr = pCurLayer->pDec->pData[2] + ((iMbY * iChromaStride + iMbX) << 3);
 
+  WELS_MB_TIMING_BEGIN (iMcStart);
   GetInterPred (pDstY, pDstCb, pDstCr, pCtx);
+  WELS_MB_TIMING_END (pCtx, DEC_STAGE_MC, iMcStart);
   WelsMbInterSampleConstruction (pCtx, pCurLayer, pDstY, pDstCb, pDstCr, iLumaStride, iChromaStride);
 
   pCtx->sBlockFunc.pWelsSetNonZeroCountFunc (
@@ -273,7 +404,9 @@ int32_t WelsMbInterPrediction (PWelsDecoderContext pCtx, PDqLayer pCurLayer) {
   pDstCb = pCurLayer->pDec->pData[1] + ((iMbY * iChromaStride + iMbX) << 3);
   pDstCr = pCurLayer->pDec->pData[2] + ((iMbY * iChromaStride + iMbX) << 3);
 
+  WELS_MB_TIMING_BEGIN (iMcStart);
   GetInterPred (pDstY, pDstCb, pDstCr, pCtx);
+  WELS_MB_TIMING_END (pCtx, DEC_STAGE_MC, iMcStart);
 
   return ERR_NONE;
 }
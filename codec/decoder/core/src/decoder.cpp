@@ -52,6 +52,7 @@
 #include "decode_slice.h"
 #include "error_concealment.h"
 #include "memory_align.h"
+#include "wels_decoder_thread.h"
 
 namespace WelsDec {
 
@@ -341,6 +342,10 @@ static inline int32_t GetTargetRefListSize (PWelsDecoderContext pCtx) {
   } else {
     iNumRefFrames = pCtx->pSps->iNumRefFrames + 2;
   }
+  // pictures held by the frame tasks queued or waiting for output, only the one output with slice threading
+  if ((pCtx != NULL) && (pCtx->pTaskManage != NULL)) {
+    iNumRefFrames += pCtx->pTaskManage->IsSliceThreading() ? 1 : pCtx->iThreadCount + 1;
+  }
 
 #ifdef LONG_TERM_REF
   //pic_queue size minimum set 2
@@ -381,6 +386,11 @@ int32_t WelsRequestMem (PWelsDecoderContext pCtx, const int32_t kiMbWidth, const
   WELS_VERIFY_RETURN_IF (ERR_NONE, pCtx->bHaveGotMemory && (kiPicWidth == pCtx->iImgWidthInPixel
                          && kiPicHeight == pCtx->iImgHeightInPixel) && (!bNeedChangePicQueue)) // have same scaled buffer
 
+  // pictures can not be freed while frame tasks are using them
+  if (pCtx->pTaskManage != NULL) {
+    pCtx->pTaskManage->DetachPictures();
+  }
+
   // sync update pRefList
   WelsResetRefPic (pCtx); // added to sync update ref list due to pictures are free
 
@@ -571,7 +581,20 @@ int32_t WelsInitDecoder (PWelsDecoderContext pCtx, SLogContext* pLogCtx) {
   }
 
   // open decoder
-  return WelsOpenDecoder (pCtx, pLogCtx);
+  int32_t iRet = WelsOpenDecoder (pCtx, pLogCtx);
+  if (ERR_NONE != iRet) {
+    return iRet;
+  }
+
+  // frame level or slice level multi-threading, reconstruction is not required for parse only
+  if (pCtx->iThreadCount > 1 && !pCtx->pParam->bParseOnly) {
+    pCtx->pTaskManage = CWelsDecTaskManage::CreateTaskManage (pCtx, pCtx->iThreadCount);
+    if (NULL == pCtx->pTaskManage) {
+      WelsLog (pLogCtx, WELS_LOG_WARNING, "WelsInitDecoder(), frame tasks creation failed, decode in single thread.");
+      pCtx->iThreadCount = 1;
+    }
+  }
+  return ERR_NONE;
 }
 
 /*!
@@ -586,6 +609,9 @@ int32_t WelsInitDecoder (PWelsDecoderContext pCtx, SLogContext* pLogCtx) {
  *************************************************************************************
  */
 void WelsEndDecoder (PWelsDecoderContext pCtx) {
+  // frame tasks have to be finished before pictures are freed
+  CWelsDecTaskManage::DestroyTaskManage (&pCtx->pTaskManage);
+
   // close decoder
   WelsCloseDecoder (pCtx);
 }
@@ -657,8 +683,26 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
     pDstNal = pRawData->pCurPos;
 
     bool bNalStartBytes = false;
+    // a NAL without emulation prevention byte is parsed where it is in the input, if the application allows it
+    const bool kbZeroCopy = pCtx->pParam->bZeroCopyInput && !pCtx->pParam->bParseOnly;
+    bool bNalInPlace = false;
 
     while (iSrcConsumed < iSrcLength) {
+      if (kbZeroCopy && 0 == iSrcIdx) {
+        // the NAL holds no escape if its first candidate is the next start code (or the zero bytes before it)
+        const int32_t kiSrcLeft = iSrcLength - iSrcConsumed;
+        const int32_t kiRunLen = pCtx->pScanNalEscapeFunc (pSrcNal, kiSrcLeft);
+        bNalInPlace = (kiRunLen == kiSrcLeft) || (pSrcNal[2 + kiRunLen] <= 0x01);
+        if (!bNalInPlace) {
+          memcpy (pDstNal, pSrcNal, kiRunLen);
+        }
+        iDstIdx      = kiRunLen;
+        iSrcIdx      = kiRunLen;
+        iSrcConsumed += kiRunLen;
+        if (kiRunLen > 0) {
+          continue;
+        }
+      }
       if ((2 + iSrcConsumed < iSrcLength) && (0 == LD16 (pSrcNal + iSrcIdx)) && (pSrcNal[2 + iSrcIdx] <= 0x03)) {
         if (bNalStartBytes && (pSrcNal[2 + iSrcIdx] != 0x00 && pSrcNal[2 + iSrcIdx] != 0x01)) {
           pCtx->iErrorCode |= dsBitstreamError;
@@ -669,7 +713,11 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
           pCtx->iErrorCode |= dsBitstreamError;
           return pCtx->iErrorCode;
         } else if (pSrcNal[2 + iSrcIdx] == 0x00) {
-          pDstNal[iDstIdx++] = pSrcNal[iSrcIdx++];
+          if (!bNalInPlace) {
+            pDstNal[iDstIdx] = pSrcNal[iSrcIdx];
+          }
+          iDstIdx++;
+          iSrcIdx++;
           iSrcConsumed++;
           bNalStartBytes = true;
         } else if (pSrcNal[2 + iSrcIdx] == 0x03) {
@@ -686,9 +734,14 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
           bNalStartBytes = false;
 
           iConsumedBytes = 0;
-          pDstNal[iDstIdx] = pDstNal[iDstIdx + 1] = pDstNal[iDstIdx + 2] = pDstNal[iDstIdx + 3] =
-                               0; // set 4 reserved bytes to zero
-          pNalPayload = ParseNalHeader (pCtx, &pCtx->sCurNalHead, pDstNal, iDstIdx, pSrcNal - 3, iSrcIdx + 3, &iConsumedBytes);
+          if (!bNalInPlace) {
+            pDstNal[iDstIdx] = pDstNal[iDstIdx + 1] = pDstNal[iDstIdx + 2] = pDstNal[iDstIdx + 3] =
+                                 0; // set 4 reserved bytes to zero
+          }
+          WELS_STAGE_TIMING_BEGIN (iNalParseStart);
+          pNalPayload = ParseNalHeader (pCtx, &pCtx->sCurNalHead, bNalInPlace ? pSrcNal : pDstNal, iDstIdx, pSrcNal - 3,
+                                        iSrcIdx + 3, &iConsumedBytes);
+          WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_NAL_PARSE, iNalParseStart);
           if (pNalPayload) { //parse correct
             if (IS_PARAM_SETS_NALS (pCtx->sCurNalHead.eNalUnitType)) {
               iRet = ParseNonVclNal (pCtx, pNalPayload, iDstIdx - iConsumedBytes, pSrcNal - 3, iSrcIdx + 3);
@@ -722,7 +775,9 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
             return pCtx->iErrorCode;
           }
 
-          pDstNal += (iDstIdx + 4); //init, increase 4 reserved zero bytes, used to store the next NAL
+          if (!bNalInPlace) {
+            pDstNal += (iDstIdx + 4); //init, increase 4 reserved zero bytes, used to store the next NAL
+          }
           if ((iSrcLength - iSrcConsumed + 4) > (pRawData->pEnd - pDstNal)) {
             pDstNal = pRawData->pCurPos = pRawData->pHead;
           } else {
@@ -736,17 +791,28 @@ int32_t WelsDecodeBs (PWelsDecoderContext pCtx, const uint8_t* kpBsBuf, const in
         }
         continue;
       }
-      pDstNal[iDstIdx++] = pSrcNal[iSrcIdx++];
-      iSrcConsumed++;
+      // copy the run up to the next start code or emulation prevention candidate at once
+      const int32_t kiRunLen = pCtx->pScanNalEscapeFunc (pSrcNal + iSrcIdx, iSrcLength - iSrcConsumed);
+      if (!bNalInPlace) {
+        memcpy (pDstNal + iDstIdx, pSrcNal + iSrcIdx, kiRunLen);
+      }
+      iDstIdx      += kiRunLen;
+      iSrcIdx      += kiRunLen;
+      iSrcConsumed += kiRunLen;
     }
 
     //last NAL decoding
 
     iConsumedBytes = 0;
-    pDstNal[iDstIdx] = pDstNal[iDstIdx + 1] = pDstNal[iDstIdx + 2] = pDstNal[iDstIdx + 3] =
-                         0; // set 4 reserved bytes to zero
-    pRawData->pCurPos = pDstNal + iDstIdx + 4; //init, increase 4 reserved zero bytes, used to store the next NAL
-    pNalPayload = ParseNalHeader (pCtx, &pCtx->sCurNalHead, pDstNal, iDstIdx, pSrcNal - 3, iSrcIdx + 3, &iConsumedBytes);
+    if (!bNalInPlace) {
+      pDstNal[iDstIdx] = pDstNal[iDstIdx + 1] = pDstNal[iDstIdx + 2] = pDstNal[iDstIdx + 3] =
+                           0; // set 4 reserved bytes to zero
+      pRawData->pCurPos = pDstNal + iDstIdx + 4; //init, increase 4 reserved zero bytes, used to store the next NAL
+    }
+    WELS_STAGE_TIMING_BEGIN (iNalParseStart);
+    pNalPayload = ParseNalHeader (pCtx, &pCtx->sCurNalHead, bNalInPlace ? pSrcNal : pDstNal, iDstIdx, pSrcNal - 3,
+                                  iSrcIdx + 3, &iConsumedBytes);
+    WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_NAL_PARSE, iNalParseStart);
     if (pNalPayload) { //parse correct
       if (IS_PARAM_SETS_NALS (pCtx->sCurNalHead.eNalUnitType)) {
         iRet = ParseNonVclNal (pCtx, pNalPayload, iDstIdx - iConsumedBytes, pSrcNal - 3, iSrcIdx + 3);
@@ -847,6 +913,7 @@ void InitDecFuncs (PWelsDecoderContext pCtx, uint32_t uiCpuFlag) {
   InitMcFunc (& (pCtx->sMcFunc), uiCpuFlag);
   InitExpandPictureFunc (& (pCtx->sExpandPicFunc), uiCpuFlag);
   DeblockingInit (&pCtx->sDeblockingFunc, uiCpuFlag);
+  InitNalScanFunc (pCtx, uiCpuFlag);
 }
 
 namespace {
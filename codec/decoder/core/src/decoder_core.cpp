@@ -42,6 +42,7 @@
 #include "decode_mb_aux.h"
 #include "memory_align.h"
 #include "error_concealment.h"
+#include "wels_decoder_thread.h"
 
 namespace WelsDec {
 static inline int32_t DecodeFrameConstruction (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferInfo* pDstInfo) {
@@ -287,7 +288,8 @@ inline void    HandleReferenceLost (PWelsDecoderContext pCtx, PNalUnit pCurNal)
 }
 
 inline int32_t  WelsDecodeConstructSlice (PWelsDecoderContext pCtx, PNalUnit pCurNal) {
-  int32_t  iRet = WelsTargetSliceConstruction (pCtx);
+  int32_t  iRet = (NULL != pCtx->pTaskManage) ? pCtx->pTaskManage->ConstructSlice (pCtx) : WelsTargetSliceConstruction (
+                    pCtx);
 
   if (iRet) {
     HandleReferenceLostL0 (pCtx, pCurNal);
@@ -580,6 +582,10 @@ int32_t ExpandBsBuffer (PWelsDecoderContext pCtx, const int kiSrcLen) {
   //Calculate and set the bs start and end position
   for (uint32_t i = 0; i <= pCtx->pAccessUnitList->uiActualUnitsNum; i++) {
     PBitStringAux pSliceBitsRead = &pCtx->pAccessUnitList->pNalUnitsList[i]->sNalData.sVclNal.sSliceBitsRead;
+    if (pSliceBitsRead->pStartBuf < pCtx->sRawData.pHead
+        || pSliceBitsRead->pStartBuf >= pCtx->sRawData.pHead + pCtx->iMaxBsBufferSizeInByte) {
+      continue; // read in place from the input, see bZeroCopyInput
+    }
     pSliceBitsRead->pStartBuf = pSliceBitsRead->pStartBuf - pCtx->sRawData.pHead + pNewBsBuff;
     pSliceBitsRead->pEndBuf   = pSliceBitsRead->pEndBuf   - pCtx->sRawData.pHead + pNewBsBuff;
     pSliceBitsRead->pCurBuf   = pSliceBitsRead->pCurBuf   - pCtx->sRawData.pHead + pNewBsBuff;
@@ -1367,279 +1373,280 @@ int32_t UpdateAccessUnit (PWelsDecoderContext pCtx) {
   return ERR_NONE;
 }
 
-int32_t InitialDqLayersContext (PWelsDecoderContext pCtx, const int32_t kiMaxWidth, const int32_t kiMaxHeight) {
-  int32_t i = 0;
+/*!
+ * \brief   allocate MB level data arrays with index kiIdx, dimension taken from pMbData->iMbWidth/iMbHeight
+ */
+int32_t InitialMbData (CMemoryAlign* pMa, SMbData* pMbData, const int32_t kiIdx) {
+  const int32_t kiMbNum = pMbData->iMbWidth * pMbData->iMbHeight;
+
+  pMbData->pMbType[kiIdx] = (int16_t*)pMa->WelsMallocz (kiMbNum * sizeof (int16_t), "pCtx->sMb.pMbType[]");
+  pMbData->pMv[kiIdx][0] = (int16_t (*)[16][2])pMa->WelsMallocz (kiMbNum * sizeof (int16_t) * MV_A * MB_BLOCK4x4_NUM,
+                           "pCtx->sMb.pMv[][]");
+  pMbData->pRefIndex[kiIdx][0] = (int8_t (*)[MB_BLOCK4x4_NUM])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) *
+                                 MB_BLOCK4x4_NUM, "pCtx->sMb.pRefIndex[][]");
+  pMbData->pLumaQp[kiIdx] = (int8_t*)pMa->WelsMallocz (kiMbNum * sizeof (int8_t), "pCtx->sMb.pLumaQp[]");
+  pMbData->pNoSubMbPartSizeLessThan8x8Flag[kiIdx] = (bool*)pMa->WelsMallocz (kiMbNum * sizeof (bool),
+      "pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[]");
+  pMbData->pTransformSize8x8Flag[kiIdx] = (bool*)pMa->WelsMallocz (kiMbNum * sizeof (bool),
+                                          "pCtx->sMb.pTransformSize8x8Flag[]");
+  pMbData->pChromaQp[kiIdx] = (int8_t (*)[2])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) * 2, "pCtx->sMb.pChromaQp[]");
+  pMbData->pMvd[kiIdx][0] = (int16_t (*)[16][2])pMa->WelsMallocz (kiMbNum * sizeof (int16_t) * MV_A * MB_BLOCK4x4_NUM,
+                            "pCtx->sMb.pMvd[][]");
+  pMbData->pCbfDc[kiIdx] = (uint16_t*)pMa->WelsMallocz (kiMbNum * sizeof (uint16_t), "pCtx->sMb.pCbfDc[]");
+  pMbData->pNzc[kiIdx] = (int8_t (*)[24])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) * 24, "pCtx->sMb.pNzc[]");
+  pMbData->pNzcRs[kiIdx] = (int8_t (*)[24])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) * 24, "pCtx->sMb.pNzcRs[]");
+  pMbData->pScaledTCoeff[kiIdx] = (int16_t (*)[MB_COEFF_LIST_SIZE])pMa->WelsMallocz (kiMbNum * sizeof (int16_t) *
+                                  MB_COEFF_LIST_SIZE, "pCtx->sMb.pScaledTCoeff[]");
+  pMbData->pIntraPredMode[kiIdx] = (int8_t (*)[8])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) * 8,
+                                   "pCtx->sMb.pIntraPredMode[]");
+  pMbData->pIntra4x4FinalMode[kiIdx] = (int8_t (*)[MB_BLOCK4x4_NUM])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) *
+                                       MB_BLOCK4x4_NUM, "pCtx->sMb.pIntra4x4FinalMode[]");
+  pMbData->pIntraNxNAvailFlag[kiIdx] = (uint8_t (*))pMa->WelsMallocz (kiMbNum * sizeof (int8_t),
+                                       "pCtx->sMb.pIntraNxNAvailFlag");
+  pMbData->pChromaPredMode[kiIdx] = (int8_t*)pMa->WelsMallocz (kiMbNum * sizeof (int8_t),
+                                    "pCtx->sMb.pChromaPredMode[]");
+  pMbData->pCbp[kiIdx] = (int8_t*)pMa->WelsMallocz (kiMbNum * sizeof (int8_t), "pCtx->sMb.pCbp[]");
+  pMbData->pSubMbType[kiIdx] = (int8_t (*)[MB_PARTITION_SIZE])pMa->WelsMallocz (kiMbNum * sizeof (int8_t) *
+                               MB_PARTITION_SIZE, "pCtx->sMb.pSubMbType[]");
+  pMbData->pSliceIdc[kiIdx] = (int32_t*) pMa->WelsMallocz (kiMbNum * sizeof (int32_t),
+                              "pCtx->sMb.pSliceIdc[]"); // using int32_t for slice_idc, 4/21/2010
+  pMbData->pResidualPredFlag[kiIdx] = (int8_t*) pMa->WelsMallocz (kiMbNum * sizeof (int8_t),
+                                      "pCtx->sMb.pResidualPredFlag[]");
+  pMbData->pInterPredictionDoneFlag[kiIdx] = (int8_t*) pMa->WelsMallocz (kiMbNum * sizeof (int8_t),
+      "pCtx->sMb.pInterPredictionDoneFlag[]");
+
+  pMbData->pMbCorrectlyDecodedFlag[kiIdx] = (bool*) pMa->WelsMallocz (kiMbNum * sizeof (bool),
+      "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
+  pMbData->pMbRefConcealedFlag[kiIdx] = (bool*) pMa->WelsMallocz (kiMbNum * sizeof (bool),
+                                        "pCtx->pMbRefConcealedFlag[]");
+
+  // check memory block valid due above allocated..
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY,
+                         ((NULL == pMbData->pMbType[kiIdx]) ||
+                          (NULL == pMbData->pMv[kiIdx][0]) ||
+                          (NULL == pMbData->pRefIndex[kiIdx][0]) ||
+                          (NULL == pMbData->pLumaQp[kiIdx]) ||
+                          (NULL == pMbData->pNoSubMbPartSizeLessThan8x8Flag[kiIdx]) ||
+                          (NULL == pMbData->pTransformSize8x8Flag[kiIdx]) ||
+                          (NULL == pMbData->pChromaQp[kiIdx]) ||
+                          (NULL == pMbData->pMvd[kiIdx][0]) ||
+                          (NULL == pMbData->pCbfDc[kiIdx]) ||
+                          (NULL == pMbData->pNzc[kiIdx]) ||
+                          (NULL == pMbData->pNzcRs[kiIdx]) ||
+                          (NULL == pMbData->pScaledTCoeff[kiIdx]) ||
+                          (NULL == pMbData->pIntraPredMode[kiIdx]) ||
+                          (NULL == pMbData->pIntra4x4FinalMode[kiIdx]) ||
+                          (NULL == pMbData->pIntraNxNAvailFlag[kiIdx]) ||
+                          (NULL == pMbData->pChromaPredMode[kiIdx]) ||
+                          (NULL == pMbData->pCbp[kiIdx]) ||
+                          (NULL == pMbData->pSubMbType[kiIdx]) ||
+                          (NULL == pMbData->pSliceIdc[kiIdx]) ||
+                          (NULL == pMbData->pResidualPredFlag[kiIdx]) ||
+                          (NULL == pMbData->pInterPredictionDoneFlag[kiIdx]) ||
+                          (NULL == pMbData->pMbRefConcealedFlag[kiIdx]) ||
+                          (NULL == pMbData->pMbCorrectlyDecodedFlag[kiIdx])
+                         )
+                        )
+
+  memset (pMbData->pSliceIdc[kiIdx], 0xff, (kiMbNum * sizeof (int32_t)));
 
-  WELS_VERIFY_RETURN_IF (ERR_INFO_INVALID_PARAM, (NULL == pCtx || kiMaxWidth <= 0 || kiMaxHeight <= 0))
-  pCtx->sMb.iMbWidth  = (kiMaxWidth + 15) >> 4;
-  pCtx->sMb.iMbHeight = (kiMaxHeight + 15) >> 4;
+  return ERR_NONE;
+}
 
-  if (pCtx->bInitialDqLayersMem && kiMaxWidth <= pCtx->iPicWidthReq
-      && kiMaxHeight <= pCtx->iPicHeightReq) // have same dimension memory, skipped
-    return ERR_NONE;
+/*!
+ * \brief   free MB level data arrays with index kiIdx
+ */
+void UninitialMbData (CMemoryAlign* pMa, SMbData* pMbData, const int32_t kiIdx) {
+  if (pMbData->pMbType[kiIdx]) {
+    pMa->WelsFree (pMbData->pMbType[kiIdx], "pCtx->sMb.pMbType[]");
 
-  CMemoryAlign* pMa = pCtx->pMemAlign;
+    pMbData->pMbType[kiIdx] = NULL;
+  }
 
-  UninitialDqLayersContext (pCtx);
+  if (pMbData->pMv[kiIdx][0]) {
+    pMa->WelsFree (pMbData->pMv[kiIdx][0], "pCtx->sMb.pMv[][]");
 
-  do {
-    PDqLayer pDq = (PDqLayer)pMa->WelsMallocz (sizeof (SDqLayer), "PDqLayer");
+    pMbData->pMv[kiIdx][0] = NULL;
+  }
 
-    if (pDq == NULL)
-      return ERR_INFO_OUT_OF_MEMORY;
+  if (pMbData->pRefIndex[kiIdx][0]) {
+    pMa->WelsFree (pMbData->pRefIndex[kiIdx][0], "pCtx->sMb.pRefIndex[][]");
 
-    pCtx->pDqLayersList[i] = pDq; //to keep consistence with in UninitialDqLayersContext()
-    memset (pDq, 0, sizeof (SDqLayer));
+    pMbData->pRefIndex[kiIdx][0] = NULL;
+  }
 
-    pCtx->sMb.pMbType[i] = (int16_t*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int16_t),
-                           "pCtx->sMb.pMbType[]");
-    pCtx->sMb.pMv[i][0] = (int16_t (*)[16][2])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-                            int16_t) * MV_A * MB_BLOCK4x4_NUM, "pCtx->sMb.pMv[][]");
-    pCtx->sMb.pRefIndex[i][0] = (int8_t (*)[MB_BLOCK4x4_NUM])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
-                                sizeof (
-                                  int8_t) * MB_BLOCK4x4_NUM, "pCtx->sMb.pRefIndex[][]");
-    pCtx->sMb.pLumaQp[i] = (int8_t*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
-                           "pCtx->sMb.pLumaQp[]");
-    pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[i] = (bool*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
-        sizeof (
-          bool),
-        "pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[]");
-    pCtx->sMb.pTransformSize8x8Flag[i] = (bool*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (bool),
-                                         "pCtx->sMb.pTransformSize8x8Flag[]");
-    pCtx->sMb.pChromaQp[i] = (int8_t (*)[2])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-                               int8_t) * 2,
-                             "pCtx->sMb.pChromaQp[]");
-    pCtx->sMb.pMvd[i][0] = (int16_t (*)[16][2])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-                             int16_t) * MV_A * MB_BLOCK4x4_NUM, "pCtx->sMb.pMvd[][]");
-    pCtx->sMb.pCbfDc[i] = (uint16_t*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (uint16_t),
-                          "pCtx->sMb.pCbfDc[]");
-    pCtx->sMb.pNzc[i] = (int8_t (*)[24])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
-                        "pCtx->sMb.pNzc[]");
-    pCtx->sMb.pNzcRs[i] = (int8_t (*)[24])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t) * 24,
-                          "pCtx->sMb.pNzcRs[]");
-    pCtx->sMb.pScaledTCoeff[i] = (int16_t (*)[MB_COEFF_LIST_SIZE])pMa->WelsMallocz (pCtx->sMb.iMbWidth *
-                                 pCtx->sMb.iMbHeight *
-                                 sizeof (int16_t) * MB_COEFF_LIST_SIZE, "pCtx->sMb.pScaledTCoeff[]");
-    pCtx->sMb.pIntraPredMode[i] = (int8_t (*)[8])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-                                    int8_t) * 8,
-                                  "pCtx->sMb.pIntraPredMode[]");
-    pCtx->sMb.pIntra4x4FinalMode[i] = (int8_t (*)[MB_BLOCK4x4_NUM])pMa->WelsMallocz (pCtx->sMb.iMbWidth *
-                                      pCtx->sMb.iMbHeight *
-                                      sizeof (int8_t) * MB_BLOCK4x4_NUM, "pCtx->sMb.pIntra4x4FinalMode[]");
-    pCtx->sMb.pIntraNxNAvailFlag[i] = (uint8_t (*))pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-                                        int8_t),
-                                      "pCtx->sMb.pIntraNxNAvailFlag");
-    pCtx->sMb.pChromaPredMode[i] = (int8_t*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
-                                   "pCtx->sMb.pChromaPredMode[]");
-    pCtx->sMb.pCbp[i] = (int8_t*)pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
-                        "pCtx->sMb.pCbp[]");
-    pCtx->sMb.pSubMbType[i] = (int8_t (*)[MB_PARTITION_SIZE])pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight *
-                              sizeof (
-                                int8_t) * MB_PARTITION_SIZE, "pCtx->sMb.pSubMbType[]");
-    pCtx->sMb.pSliceIdc[i] = (int32_t*) pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t),
-                             "pCtx->sMb.pSliceIdc[]"); // using int32_t for slice_idc, 4/21/2010
-    pCtx->sMb.pResidualPredFlag[i] = (int8_t*) pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int8_t),
-                                     "pCtx->sMb.pResidualPredFlag[]");
-    pCtx->sMb.pInterPredictionDoneFlag[i] = (int8_t*) pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-        int8_t), "pCtx->sMb.pInterPredictionDoneFlag[]");
-
-    pCtx->sMb.pMbCorrectlyDecodedFlag[i] = (bool*) pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (
-        bool),
-                                           "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
-    pCtx->sMb.pMbRefConcealedFlag[i] = (bool*) pMa->WelsMallocz (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (bool),
-                                       "pCtx->pMbRefConcealedFlag[]");
-
-    // check memory block valid due above allocated..
-    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY,
-                           ((NULL == pCtx->sMb.pMbType[i]) ||
-                            (NULL == pCtx->sMb.pMv[i][0]) ||
-                            (NULL == pCtx->sMb.pRefIndex[i][0]) ||
-                            (NULL == pCtx->sMb.pLumaQp[i]) ||
-                            (NULL == pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[i]) ||
-                            (NULL == pCtx->sMb.pTransformSize8x8Flag[i]) ||
-                            (NULL == pCtx->sMb.pChromaQp[i]) ||
-                            (NULL == pCtx->sMb.pMvd[i][0]) ||
-                            (NULL == pCtx->sMb.pCbfDc[i]) ||
-                            (NULL == pCtx->sMb.pNzc[i]) ||
-                            (NULL == pCtx->sMb.pNzcRs[i]) ||
-                            (NULL == pCtx->sMb.pScaledTCoeff[i]) ||
-                            (NULL == pCtx->sMb.pIntraPredMode[i]) ||
-                            (NULL == pCtx->sMb.pIntra4x4FinalMode[i]) ||
-                            (NULL == pCtx->sMb.pIntraNxNAvailFlag[i]) ||
-                            (NULL == pCtx->sMb.pChromaPredMode[i]) ||
-                            (NULL == pCtx->sMb.pCbp[i]) ||
-                            (NULL == pCtx->sMb.pSubMbType[i]) ||
-                            (NULL == pCtx->sMb.pSliceIdc[i]) ||
-                            (NULL == pCtx->sMb.pResidualPredFlag[i]) ||
-                            (NULL == pCtx->sMb.pInterPredictionDoneFlag[i]) ||
-                            (NULL == pCtx->sMb.pMbRefConcealedFlag[i]) ||
-                            (NULL == pCtx->sMb.pMbCorrectlyDecodedFlag[i])
-                           )
-                          )
-
-    memset (pCtx->sMb.pSliceIdc[i], 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
+  if (pMbData->pNoSubMbPartSizeLessThan8x8Flag[kiIdx]) {
+    pMa->WelsFree (pMbData->pNoSubMbPartSizeLessThan8x8Flag[kiIdx], "pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[]");
 
-    ++ i;
-  } while (i < LAYER_NUM_EXCHANGEABLE);
+    pMbData->pNoSubMbPartSizeLessThan8x8Flag[kiIdx] = NULL;
+  }
 
-  pCtx->bInitialDqLayersMem     = true;
-  pCtx->iPicWidthReq            = kiMaxWidth;
-  pCtx->iPicHeightReq           = kiMaxHeight;
+  if (pMbData->pTransformSize8x8Flag[kiIdx]) {
+    pMa->WelsFree (pMbData->pTransformSize8x8Flag[kiIdx], "pCtx->sMb.pTransformSize8x8Flag[]");
 
-  return ERR_NONE;
-}
+    pMbData->pTransformSize8x8Flag[kiIdx] = NULL;
+  }
 
-void UninitialDqLayersContext (PWelsDecoderContext pCtx) {
-  int32_t i = 0;
-  CMemoryAlign* pMa = pCtx->pMemAlign;
+  if (pMbData->pLumaQp[kiIdx]) {
+    pMa->WelsFree (pMbData->pLumaQp[kiIdx], "pCtx->sMb.pLumaQp[]");
 
-  do {
-    PDqLayer pDq = pCtx->pDqLayersList[i];
-    if (pDq == NULL) {
-      ++ i;
-      continue;
-    }
+    pMbData->pLumaQp[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pMbType[i]) {
-      pMa->WelsFree (pCtx->sMb.pMbType[i], "pCtx->sMb.pMbType[]");
+  if (pMbData->pChromaQp[kiIdx]) {
+    pMa->WelsFree (pMbData->pChromaQp[kiIdx], "pCtx->sMb.pChromaQp[]");
 
-      pCtx->sMb.pMbType[i] = NULL;
-    }
+    pMbData->pChromaQp[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pMv[i][0]) {
-      pMa->WelsFree (pCtx->sMb.pMv[i][0], "pCtx->sMb.pMv[][]");
+  if (pMbData->pMvd[kiIdx][0]) {
+    pMa->WelsFree (pMbData->pMvd[kiIdx][0], "pCtx->sMb.pMvd[][]");
+    pMbData->pMvd[kiIdx][0] = NULL;
+  }
 
-      pCtx->sMb.pMv[i][0] = NULL;
-    }
+  if (pMbData->pCbfDc[kiIdx]) {
+    pMa->WelsFree (pMbData->pCbfDc[kiIdx], "pCtx->sMb.pCbfDc[]");
+    pMbData->pCbfDc[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pRefIndex[i][0]) {
-      pMa->WelsFree (pCtx->sMb.pRefIndex[i][0], "pCtx->sMb.pRefIndex[][]");
+  if (pMbData->pNzc[kiIdx]) {
+    pMa->WelsFree (pMbData->pNzc[kiIdx], "pCtx->sMb.pNzc[]");
 
-      pCtx->sMb.pRefIndex[i][0] = NULL;
-    }
+    pMbData->pNzc[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[i]) {
-      pMa->WelsFree (pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[i], "pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[]");
+  if (pMbData->pNzcRs[kiIdx]) {
+    pMa->WelsFree (pMbData->pNzcRs[kiIdx], "pCtx->sMb.pNzcRs[]");
 
-      pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[i] = NULL;
-    }
+    pMbData->pNzcRs[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pTransformSize8x8Flag[i]) {
-      pMa->WelsFree (pCtx->sMb.pTransformSize8x8Flag[i], "pCtx->sMb.pTransformSize8x8Flag[]");
+  if (pMbData->pScaledTCoeff[kiIdx]) {
+    pMa->WelsFree (pMbData->pScaledTCoeff[kiIdx], "pCtx->sMb.pScaledTCoeff[]");
 
-      pCtx->sMb.pTransformSize8x8Flag[i] = NULL;
-    }
+    pMbData->pScaledTCoeff[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pLumaQp[i]) {
-      pMa->WelsFree (pCtx->sMb.pLumaQp[i], "pCtx->sMb.pLumaQp[]");
+  if (pMbData->pIntraPredMode[kiIdx]) {
+    pMa->WelsFree (pMbData->pIntraPredMode[kiIdx], "pCtx->sMb.pIntraPredMode[]");
 
-      pCtx->sMb.pLumaQp[i] = NULL;
-    }
+    pMbData->pIntraPredMode[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pChromaQp[i]) {
-      pMa->WelsFree (pCtx->sMb.pChromaQp[i], "pCtx->sMb.pChromaQp[]");
+  if (pMbData->pIntra4x4FinalMode[kiIdx]) {
+    pMa->WelsFree (pMbData->pIntra4x4FinalMode[kiIdx], "pCtx->sMb.pIntra4x4FinalMode[]");
 
-      pCtx->sMb.pChromaQp[i] = NULL;
-    }
+    pMbData->pIntra4x4FinalMode[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pMvd[i][0]) {
-      pMa->WelsFree (pCtx->sMb.pMvd[i][0], "pCtx->sMb.pMvd[][]");
-      pCtx->sMb.pMvd[i][0] = NULL;
-    }
+  if (pMbData->pIntraNxNAvailFlag[kiIdx]) {
+    pMa->WelsFree (pMbData->pIntraNxNAvailFlag[kiIdx], "pCtx->sMb.pIntraNxNAvailFlag");
 
-    if (pCtx->sMb.pCbfDc[i]) {
-      pMa->WelsFree (pCtx->sMb.pCbfDc[i], "pCtx->sMb.pCbfDc[]");
-      pCtx->sMb.pCbfDc[i] = NULL;
-    }
+    pMbData->pIntraNxNAvailFlag[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pNzc[i]) {
-      pMa->WelsFree (pCtx->sMb.pNzc[i], "pCtx->sMb.pNzc[]");
+  if (pMbData->pChromaPredMode[kiIdx]) {
+    pMa->WelsFree (pMbData->pChromaPredMode[kiIdx], "pCtx->sMb.pChromaPredMode[]");
 
-      pCtx->sMb.pNzc[i] = NULL;
-    }
+    pMbData->pChromaPredMode[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pNzcRs[i]) {
-      pMa->WelsFree (pCtx->sMb.pNzcRs[i], "pCtx->sMb.pNzcRs[]");
+  if (pMbData->pCbp[kiIdx]) {
+    pMa->WelsFree (pMbData->pCbp[kiIdx], "pCtx->sMb.pCbp[]");
 
-      pCtx->sMb.pNzcRs[i] = NULL;
-    }
+    pMbData->pCbp[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pScaledTCoeff[i]) {
-      pMa->WelsFree (pCtx->sMb.pScaledTCoeff[i], "pCtx->sMb.pScaledTCoeff[]");
+  //      if (pMbData->pMotionPredFlag[kiIdx])
+  //{
+  //  pMa->WelsFree( pMbData->pMotionPredFlag[kiIdx], "pCtx->sMb.pMotionPredFlag[]" );
 
-      pCtx->sMb.pScaledTCoeff[i] = NULL;
-    }
+  //  pMbData->pMotionPredFlag[kiIdx] = NULL;
+  //}
 
-    if (pCtx->sMb.pIntraPredMode[i]) {
-      pMa->WelsFree (pCtx->sMb.pIntraPredMode[i], "pCtx->sMb.pIntraPredMode[]");
+  if (pMbData->pSubMbType[kiIdx]) {
+    pMa->WelsFree (pMbData->pSubMbType[kiIdx], "pCtx->sMb.pSubMbType[]");
 
-      pCtx->sMb.pIntraPredMode[i] = NULL;
-    }
+    pMbData->pSubMbType[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pIntra4x4FinalMode[i]) {
-      pMa->WelsFree (pCtx->sMb.pIntra4x4FinalMode[i], "pCtx->sMb.pIntra4x4FinalMode[]");
+  if (pMbData->pSliceIdc[kiIdx]) {
+    pMa->WelsFree (pMbData->pSliceIdc[kiIdx], "pCtx->sMb.pSliceIdc[]");
 
-      pCtx->sMb.pIntra4x4FinalMode[i] = NULL;
-    }
+    pMbData->pSliceIdc[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pIntraNxNAvailFlag[i]) {
-      pMa->WelsFree (pCtx->sMb.pIntraNxNAvailFlag[i], "pCtx->sMb.pIntraNxNAvailFlag");
+  if (pMbData->pResidualPredFlag[kiIdx]) {
+    pMa->WelsFree (pMbData->pResidualPredFlag[kiIdx], "pCtx->sMb.pResidualPredFlag[]");
 
-      pCtx->sMb.pIntraNxNAvailFlag[i] = NULL;
-    }
+    pMbData->pResidualPredFlag[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pChromaPredMode[i]) {
-      pMa->WelsFree (pCtx->sMb.pChromaPredMode[i], "pCtx->sMb.pChromaPredMode[]");
+  if (pMbData->pInterPredictionDoneFlag[kiIdx]) {
+    pMa->WelsFree (pMbData->pInterPredictionDoneFlag[kiIdx], "pCtx->sMb.pInterPredictionDoneFlag[]");
 
-      pCtx->sMb.pChromaPredMode[i] = NULL;
-    }
+    pMbData->pInterPredictionDoneFlag[kiIdx] = NULL;
+  }
 
-    if (pCtx->sMb.pCbp[i]) {
-      pMa->WelsFree (pCtx->sMb.pCbp[i], "pCtx->sMb.pCbp[]");
+  if (pMbData->pMbCorrectlyDecodedFlag[kiIdx]) {
+    pMa->WelsFree (pMbData->pMbCorrectlyDecodedFlag[kiIdx], "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
+    pMbData->pMbCorrectlyDecodedFlag[kiIdx] = NULL;
+  }
 
-      pCtx->sMb.pCbp[i] = NULL;
-    }
+  if (pMbData->pMbRefConcealedFlag[kiIdx]) {
+    pMa->WelsFree (pMbData->pMbRefConcealedFlag[kiIdx], "pCtx->sMb.pMbRefConcealedFlag[]");
+    pMbData->pMbRefConcealedFlag[kiIdx] = NULL;
+  }
+}
 
-    //      if (pCtx->sMb.pMotionPredFlag[i])
-    //{
-    //  pMa->WelsFree( pCtx->sMb.pMotionPredFlag[i], "pCtx->sMb.pMotionPredFlag[]" );
+int32_t InitialDqLayersContext (PWelsDecoderContext pCtx, const int32_t kiMaxWidth, const int32_t kiMaxHeight) {
+  int32_t i = 0;
 
-    //  pCtx->sMb.pMotionPredFlag[i] = NULL;
-    //}
+  WELS_VERIFY_RETURN_IF (ERR_INFO_INVALID_PARAM, (NULL == pCtx || kiMaxWidth <= 0 || kiMaxHeight <= 0))
+  pCtx->sMb.iMbWidth  = (kiMaxWidth + 15) >> 4;
+  pCtx->sMb.iMbHeight = (kiMaxHeight + 15) >> 4;
 
-    if (pCtx->sMb.pSubMbType[i]) {
-      pMa->WelsFree (pCtx->sMb.pSubMbType[i], "pCtx->sMb.pSubMbType[]");
+  if (pCtx->bInitialDqLayersMem && kiMaxWidth <= pCtx->iPicWidthReq
+      && kiMaxHeight <= pCtx->iPicHeightReq) // have same dimension memory, skipped
+    return ERR_NONE;
 
-      pCtx->sMb.pSubMbType[i] = NULL;
-    }
+  CMemoryAlign* pMa = pCtx->pMemAlign;
 
-    if (pCtx->sMb.pSliceIdc[i]) {
-      pMa->WelsFree (pCtx->sMb.pSliceIdc[i], "pCtx->sMb.pSliceIdc[]");
+  UninitialDqLayersContext (pCtx);
 
-      pCtx->sMb.pSliceIdc[i] = NULL;
-    }
+  do {
+    PDqLayer pDq = (PDqLayer)pMa->WelsMallocz (sizeof (SDqLayer), "PDqLayer");
 
-    if (pCtx->sMb.pResidualPredFlag[i]) {
-      pMa->WelsFree (pCtx->sMb.pResidualPredFlag[i], "pCtx->sMb.pResidualPredFlag[]");
+    if (pDq == NULL)
+      return ERR_INFO_OUT_OF_MEMORY;
 
-      pCtx->sMb.pResidualPredFlag[i] = NULL;
-    }
+    pCtx->pDqLayersList[i] = pDq; //to keep consistence with in UninitialDqLayersContext()
+    memset (pDq, 0, sizeof (SDqLayer));
 
-    if (pCtx->sMb.pInterPredictionDoneFlag[i]) {
-      pMa->WelsFree (pCtx->sMb.pInterPredictionDoneFlag[i], "pCtx->sMb.pInterPredictionDoneFlag[]");
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, ERR_NONE != InitialMbData (pMa, &pCtx->sMb, i))
 
-      pCtx->sMb.pInterPredictionDoneFlag[i] = NULL;
-    }
+    ++ i;
+  } while (i < LAYER_NUM_EXCHANGEABLE);
 
-    if (pCtx->sMb.pMbCorrectlyDecodedFlag[i]) {
-      pMa->WelsFree (pCtx->sMb.pMbCorrectlyDecodedFlag[i], "pCtx->sMb.pMbCorrectlyDecodedFlag[]");
-      pCtx->sMb.pMbCorrectlyDecodedFlag[i] = NULL;
-    }
+  pCtx->bInitialDqLayersMem     = true;
+  pCtx->iPicWidthReq            = kiMaxWidth;
+  pCtx->iPicHeightReq           = kiMaxHeight;
+
+  return ERR_NONE;
+}
+
+void UninitialDqLayersContext (PWelsDecoderContext pCtx) {
+  int32_t i = 0;
+  CMemoryAlign* pMa = pCtx->pMemAlign;
 
-    if (pCtx->sMb.pMbRefConcealedFlag[i]) {
-      pMa->WelsFree (pCtx->sMb.pMbRefConcealedFlag[i], "pCtx->sMb.pMbRefConcealedFlag[]");
-      pCtx->sMb.pMbRefConcealedFlag[i] = NULL;
+  do {
+    PDqLayer pDq = pCtx->pDqLayersList[i];
+    if (pDq == NULL) {
+      ++ i;
+      continue;
     }
+
+    UninitialMbData (pMa, &pCtx->sMb, i);
     pMa->WelsFree (pDq, "pDq");
 
     pDq = NULL;
@@ -2223,29 +2230,34 @@ int32_t InitRefPicList (PWelsDecoderContext pCtx, const uint8_t kuiNRi, int32_t
 
 void InitCurDqLayerData (PWelsDecoderContext pCtx, PDqLayer pCurDq) {
   if (NULL != pCtx && NULL != pCurDq) {
-    pCurDq->pMbType         = pCtx->sMb.pMbType[0];
-    pCurDq->pSliceIdc       = pCtx->sMb.pSliceIdc[0];
-    pCurDq->pMv[0]          = pCtx->sMb.pMv[0][0];
-    pCurDq->pRefIndex[0]    = pCtx->sMb.pRefIndex[0][0];
-    pCurDq->pNoSubMbPartSizeLessThan8x8Flag = pCtx->sMb.pNoSubMbPartSizeLessThan8x8Flag[0];
-    pCurDq->pTransformSize8x8Flag = pCtx->sMb.pTransformSize8x8Flag[0];
-    pCurDq->pLumaQp         = pCtx->sMb.pLumaQp[0];
-    pCurDq->pChromaQp       = pCtx->sMb.pChromaQp[0];
-    pCurDq->pMvd[0]         = pCtx->sMb.pMvd[0][0];
-    pCurDq->pCbfDc          = pCtx->sMb.pCbfDc[0];
-    pCurDq->pNzc            = pCtx->sMb.pNzc[0];
-    pCurDq->pNzcRs          = pCtx->sMb.pNzcRs[0];
-    pCurDq->pScaledTCoeff   = pCtx->sMb.pScaledTCoeff[0];
-    pCurDq->pIntraPredMode  = pCtx->sMb.pIntraPredMode[0];
-    pCurDq->pIntra4x4FinalMode = pCtx->sMb.pIntra4x4FinalMode[0];
-    pCurDq->pIntraNxNAvailFlag = pCtx->sMb.pIntraNxNAvailFlag[0];
-    pCurDq->pChromaPredMode = pCtx->sMb.pChromaPredMode[0];
-    pCurDq->pCbp            = pCtx->sMb.pCbp[0];
-    pCurDq->pSubMbType      = pCtx->sMb.pSubMbType[0];
-    pCurDq->pInterPredictionDoneFlag = pCtx->sMb.pInterPredictionDoneFlag[0];
-    pCurDq->pResidualPredFlag = pCtx->sMb.pResidualPredFlag[0];
-    pCurDq->pMbCorrectlyDecodedFlag = pCtx->sMb.pMbCorrectlyDecodedFlag[0];
-    pCurDq->pMbRefConcealedFlag = pCtx->sMb.pMbRefConcealedFlag[0];
+    // with frame level multi-threading, every picture being decoded owns its MB data
+    SMbData* pMbData = (NULL != pCtx->pTaskManage) ? pCtx->pTaskManage->GetMbData() : NULL;
+    if (NULL == pMbData) {
+      pMbData = &pCtx->sMb;
+    }
+    pCurDq->pMbType         = pMbData->pMbType[0];
+    pCurDq->pSliceIdc       = pMbData->pSliceIdc[0];
+    pCurDq->pMv[0]          = pMbData->pMv[0][0];
+    pCurDq->pRefIndex[0]    = pMbData->pRefIndex[0][0];
+    pCurDq->pNoSubMbPartSizeLessThan8x8Flag = pMbData->pNoSubMbPartSizeLessThan8x8Flag[0];
+    pCurDq->pTransformSize8x8Flag = pMbData->pTransformSize8x8Flag[0];
+    pCurDq->pLumaQp         = pMbData->pLumaQp[0];
+    pCurDq->pChromaQp       = pMbData->pChromaQp[0];
+    pCurDq->pMvd[0]         = pMbData->pMvd[0][0];
+    pCurDq->pCbfDc          = pMbData->pCbfDc[0];
+    pCurDq->pNzc            = pMbData->pNzc[0];
+    pCurDq->pNzcRs          = pMbData->pNzcRs[0];
+    pCurDq->pScaledTCoeff   = pMbData->pScaledTCoeff[0];
+    pCurDq->pIntraPredMode  = pMbData->pIntraPredMode[0];
+    pCurDq->pIntra4x4FinalMode = pMbData->pIntra4x4FinalMode[0];
+    pCurDq->pIntraNxNAvailFlag = pMbData->pIntraNxNAvailFlag[0];
+    pCurDq->pChromaPredMode = pMbData->pChromaPredMode[0];
+    pCurDq->pCbp            = pMbData->pCbp[0];
+    pCurDq->pSubMbType      = pMbData->pSubMbType[0];
+    pCurDq->pInterPredictionDoneFlag = pMbData->pInterPredictionDoneFlag[0];
+    pCurDq->pResidualPredFlag = pMbData->pResidualPredFlag[0];
+    pCurDq->pMbCorrectlyDecodedFlag = pMbData->pMbCorrectlyDecodedFlag[0];
+    pCurDq->pMbRefConcealedFlag = pMbData->pMbRefConcealedFlag[0];
   }
 }
 
@@ -2290,6 +2302,10 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
 
     if (pCtx->pDec == NULL) {
       pCtx->pDec = PrefetchPic (pCtx->pPicBuff[0]);
+      if (NULL == pCtx->pDec && NULL != pCtx->pTaskManage) { // all the pictures free may be held by frame tasks
+        pCtx->pTaskManage->DetachPictures();
+        pCtx->pDec = PrefetchPic (pCtx->pPicBuff[0]);
+      }
       if (pCtx->iTotalNumMbRec != 0)
         pCtx->iTotalNumMbRec = 0;
 
@@ -2308,8 +2324,18 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
     pCtx->pDec->uiTimeStamp = pNalCur->uiTimeStamp;
 
     if (pCtx->iTotalNumMbRec == 0) { //Picture start to decode
-      for (int32_t i = 0; i < LAYER_NUM_EXCHANGEABLE; ++ i)
-        memset (pCtx->sMb.pSliceIdc[i], 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
+      if (NULL != pCtx->pTaskManage) {
+        iRet = pCtx->pTaskManage->StartPicture (pCtx);
+        if (ERR_NONE != iRet) {
+          WelsLog (& (pCtx->sLogCtx), WELS_LOG_ERROR, "DecodeCurrentAccessUnit()::StartPicture ERROR, MB data alloc failed.");
+          pCtx->iErrorCode |= dsOutOfMemory;
+          pCtx->pDec = NULL;
+          return iRet;
+        }
+      } else {
+        for (int32_t i = 0; i < LAYER_NUM_EXCHANGEABLE; ++ i)
+          memset (pCtx->sMb.pSliceIdc[i], 0xff, (pCtx->sMb.iMbWidth * pCtx->sMb.iMbHeight * sizeof (int32_t)));
+      }
       memset (pCtx->pCurDqLayer->pMbCorrectlyDecodedFlag, 0, pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight * sizeof (bool));
       memset (pCtx->pCurDqLayer->pMbRefConcealedFlag, 0, pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight * sizeof (bool));
       pCtx->pDec->iMbNum = pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight;
@@ -2425,7 +2451,9 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
           }
         }
 
+        WELS_STAGE_TIMING_BEGIN (iEntropyStart);
         iRet = WelsDecodeSlice (pCtx, bFreshSliceAvailable, pNalCur);
+        WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_ENTROPY_DECODE, iEntropyStart);
 
         //Output good store_base reconstruction when enhancement quality layer occurred error for MGS key picture case
         if (iRet != ERR_NONE) {
@@ -2442,7 +2470,10 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
         }
 
         if (bReconstructSlice) {
-          if ((iRet = WelsDecodeConstructSlice (pCtx, pNalCur)) != ERR_NONE) {
+          WELS_STAGE_TIMING_BEGIN (iReconStart);
+          iRet = WelsDecodeConstructSlice (pCtx, pNalCur);
+          WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_RECONSTRUCTION, iReconStart);
+          if (iRet != ERR_NONE) {
             pCtx->pDec->bIsComplete = false; // reconstruction error, directly set the flag false
             return iRet;
           }
@@ -2495,7 +2526,12 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
         if (!pCtx->pParam->bParseOnly) {
           //Do error concealment here
           if ((NeedErrorCon (pCtx)) && (pCtx->pParam->eEcActiveIdc != ERROR_CON_DISABLE)) {
+            if (NULL != pCtx->pTaskManage) { // error concealment works on the reconstructed MBs
+              pCtx->pTaskManage->SyncPicture (pCtx);
+            }
+            WELS_STAGE_TIMING_BEGIN (iEcStart);
             ImplementErrorCon (pCtx);
+            WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_ERROR_CONCEALMENT, iEcStart);
             pCtx->iTotalNumMbRec = pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight;
             pCtx->pDec->iSpsId = pCtx->pSps->iSpsId;
             pCtx->pDec->iPpsId = pCtx->pPps->iPpsId;
@@ -2514,15 +2550,21 @@ int32_t DecodeCurrentAccessUnit (PWelsDecoderContext pCtx, uint8_t** ppDst, SBuf
           if (iRet == ERR_INFO_DUPLICATE_FRAME_NUM)
             pCtx->iErrorCode |= dsBitstreamError;
           if (pCtx->pParam->eEcActiveIdc == ERROR_CON_DISABLE) {
+            if (NULL != pCtx->pTaskManage) {
+              pCtx->pTaskManage->FinishPicture (pCtx, ppDst, pDstInfo, false);
+            }
             pCtx->pDec = NULL;
             return iRet;
           }
         }
-        if (!pCtx->pParam->bParseOnly)
+        if (!pCtx->pParam->bParseOnly && NULL == pCtx->pTaskManage) // padded by the frame task otherwise
           ExpandReferencingPicture (pCtx->pDec->pData, pCtx->pDec->iWidthInPixel, pCtx->pDec->iHeightInPixel,
                                     pCtx->pDec->iLinesize,
                                     pCtx->sExpandPicFunc.pfExpandLumaPicture, pCtx->sExpandPicFunc.pfExpandChromaPicture);
       }
+      if (NULL != pCtx->pTaskManage) {
+        pCtx->pTaskManage->FinishPicture (pCtx, ppDst, pDstInfo, uiNalRefIdc > 0);
+      }
       pCtx->pDec = NULL; //after frame decoding, always set to NULL
     }
 
@@ -2564,7 +2606,12 @@ bool CheckAndFinishLastPic (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferIn
   //Do Error Concealment here
   if (bAuBoundaryFlag && (pCtx->iTotalNumMbRec != 0) && NeedErrorCon (pCtx)) { //AU ready but frame not completely reconed
     if (pCtx->pParam->eEcActiveIdc != ERROR_CON_DISABLE) {
+      if (NULL != pCtx->pTaskManage) { // error concealment works on the reconstructed MBs
+        pCtx->pTaskManage->SyncPicture (pCtx);
+      }
+      WELS_STAGE_TIMING_BEGIN (iEcStart);
       ImplementErrorCon (pCtx);
+      WELS_STAGE_TIMING_END (pCtx, DEC_STAGE_ERROR_CONCEALMENT, iEcStart);
       pCtx->iTotalNumMbRec = pCtx->pSps->iMbWidth * pCtx->pSps->iMbHeight;
       pCtx->pDec->iSpsId = pCtx->pSps->iSpsId;
       pCtx->pDec->iPpsId = pCtx->pPps->iPpsId;
@@ -2587,6 +2634,9 @@ bool CheckAndFinishLastPic (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferIn
         return false;
       }
     }
+    if (NULL != pCtx->pTaskManage) {
+      pCtx->pTaskManage->FinishPicture (pCtx, ppDst, pDstInfo, false);
+    }
     pCtx->pDec = NULL;
     if (pAu->pNalUnitsList[pAu->uiStartPos]->sNalHeaderExt.sNalUnitHeader.uiNalRefIdc > 0)
       pCtx->iPrevFrameNum = pCtx->sLastSliceHeader.iFrameNum; //save frame_num
@@ -389,6 +389,8 @@ void DoErrorConSliceMVCopy (PWelsDecoderContext pCtx) {
     sMCRefMem.iDstLineChroma = pDstPic->iLinesize[1];
     sMCRefMem.iPicWidth = pDstPic->iWidthInPixel;
     sMCRefMem.iPicHeight = pDstPic->iHeightInPixel;
+    sMCRefMem.pRefPic = pSrcPic;
+    sMCRefMem.pFrameTask = NULL; // error concealment is done after all the frame tasks finished
     if (pDstPic == pSrcPic) {
       // output error info, EC will be ignored in DoMbECMvCopy
       WelsLog (& (pCtx->sLogCtx), WELS_LOG_WARNING, "DoErrorConSliceMVCopy()::EC memcpy overlap.");
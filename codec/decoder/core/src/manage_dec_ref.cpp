@@ -42,6 +42,7 @@
 #include "manage_dec_ref.h"
 #include "error_concealment.h"
 #include "error_code.h"
+#include "wels_decoder_thread.h"
 
 namespace WelsDec {
 
@@ -132,6 +133,9 @@ int32_t WelsInitRefList (PWelsDecoderContext pCtx, int32_t iPoc) {
         bCopyPrevious = bCopyPrevious && (pRef->iWidthInPixel == pCtx->pPreviousDecodedPictureInDpb->iWidthInPixel)
                         && (pRef->iHeightInPixel == pCtx->pPreviousDecodedPictureInDpb->iHeightInPixel);
 
+        if (NULL != pCtx->pTaskManage) { // the previous picture may be still under reconstruction
+          pCtx->pTaskManage->WaitForTasks();
+        }
         if (!bCopyPrevious) {
           memset (pRef->pData[0], 128, pRef->iLinesize[0] * pRef->iHeightInPixel);
           memset (pRef->pData[1], 128, pRef->iLinesize[1] * pRef->iHeightInPixel / 2);
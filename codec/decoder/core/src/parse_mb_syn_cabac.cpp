@@ -780,82 +780,82 @@ int32_t ParseCbfInfoCabac (PWelsNeighAvail pNeighAvail, uint8_t* pNzcCache, int3
   return ERR_NONE;
 }
 
-int32_t ParseSignificantMapCabac (int32_t* pSignificantMap, int32_t iResProperty, PWelsDecoderContext pCtx,
-                                  uint32_t& uiCoeffNum) {
+// the 4x4 and 8x8 block categories get their own copy of the loop through the constant kb8x8
+static inline int32_t ParseSignificantMapLoopCabac (int32_t* pSignificantMap, uint8_t* pSignificantPos,
+    PWelsCabacDecEngine pDecEngine, PWelsCabacCtx pMapCtx, PWelsCabacCtx pLastCtx, const int32_t kiMaxPos, const bool kb8x8,
+    uint32_t& uiCoeffNum) {
   uint32_t uiCode;
+  uint32_t uiNum = 0;
 
-  PWelsCabacCtx pMapCtx  = pCtx->pCabacCtx + (iResProperty == LUMA_DC_AC_8 ? NEW_CTX_OFFSET_MAP_8x8 : NEW_CTX_OFFSET_MAP)
-                           + g_kBlockCat2CtxOffsetMap [iResProperty];
-  PWelsCabacCtx pLastCtx = pCtx->pCabacCtx + (iResProperty == LUMA_DC_AC_8 ? NEW_CTX_OFFSET_LAST_8x8 :
-                           NEW_CTX_OFFSET_LAST) + g_kBlockCat2CtxOffsetLast[iResProperty];
-
-
-  int32_t i;
-  uiCoeffNum = 0;
-  int32_t i0 = 0;
-  int32_t i1 = g_kMaxPos[iResProperty];
-
-  int32_t iCtx;
-
-  for (i = i0; i < i1; ++i) {
-    iCtx = (iResProperty == LUMA_DC_AC_8 ? g_kuiIdx2CtxSignificantCoeffFlag8x8[i] : i);
+  for (int32_t i = 0; i < kiMaxPos; ++i) {
     //read significant
-    WELS_READ_VERIFY (DecodeBinCabac (pCtx->pCabacDecEngine, pMapCtx + iCtx, uiCode));
+    WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pMapCtx + (kb8x8 ? g_kuiIdx2CtxSignificantCoeffFlag8x8[i] : i),
+                                            uiCode));
     if (uiCode) {
-      * (pSignificantMap++) = 1;
-      ++ uiCoeffNum;
+      pSignificantMap[i] = 1;
+      pSignificantPos[uiNum++] = (uint8_t)i;
       //read last significant
-      iCtx = (iResProperty == LUMA_DC_AC_8 ? g_kuiIdx2CtxLastSignificantCoeffFlag8x8[i] : i);
-      WELS_READ_VERIFY (DecodeBinCabac (pCtx->pCabacDecEngine, pLastCtx + iCtx, uiCode));
+      WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pLastCtx + (kb8x8 ? g_kuiIdx2CtxLastSignificantCoeffFlag8x8[i] :
+                                              i), uiCode));
       if (uiCode) {
-        memset (pSignificantMap, 0, (i1 - i) * sizeof (int32_t));
+        uiCoeffNum = uiNum;
         return ERR_NONE;
       }
-    } else
-      * (pSignificantMap++) = 0;
+    }
   }
 
   //deal with last pSignificantMap if no data
-  //if(i < i1+1)
-  {
-    *pSignificantMap = 1;
-    ++uiCoeffNum;
-  }
-
+  pSignificantMap[kiMaxPos] = 1;
+  pSignificantPos[uiNum++] = (uint8_t)kiMaxPos;
+  uiCoeffNum = uiNum;
   return ERR_NONE;
 }
 
-int32_t ParseSignificantCoeffCabac (int32_t* pSignificant, int32_t iResProperty, PWelsDecoderContext pCtx) {
+int32_t ParseSignificantMapCabac (int32_t* pSignificantMap, uint8_t* pSignificantPos, int32_t iResProperty,
+                                  PWelsDecoderContext pCtx, uint32_t& uiCoeffNum) {
+  uiCoeffNum = 0;
+  if (iResProperty == LUMA_DC_AC_8) {
+    return ParseSignificantMapLoopCabac (pSignificantMap, pSignificantPos, pCtx->pCabacDecEngine,
+                                         pCtx->pCabacCtx + NEW_CTX_OFFSET_MAP_8x8 + g_kBlockCat2CtxOffsetMap[iResProperty],
+                                         pCtx->pCabacCtx + NEW_CTX_OFFSET_LAST_8x8 + g_kBlockCat2CtxOffsetLast[iResProperty],
+                                         g_kMaxPos[iResProperty], true, uiCoeffNum);
+  }
+  return ParseSignificantMapLoopCabac (pSignificantMap, pSignificantPos, pCtx->pCabacDecEngine,
+                                       pCtx->pCabacCtx + NEW_CTX_OFFSET_MAP + g_kBlockCat2CtxOffsetMap[iResProperty],
+                                       pCtx->pCabacCtx + NEW_CTX_OFFSET_LAST + g_kBlockCat2CtxOffsetLast[iResProperty],
+                                       g_kMaxPos[iResProperty], false, uiCoeffNum);
+}
+
+int32_t ParseSignificantCoeffCabac (int32_t* pSignificant, const uint8_t* pSignificantPos, uint32_t uiCoeffNum,
+                                    int32_t iResProperty, PWelsDecoderContext pCtx) {
   uint32_t uiCode;
+  PWelsCabacDecEngine pDecEngine = pCtx->pCabacDecEngine;
   PWelsCabacCtx pOneCtx = pCtx->pCabacCtx + (iResProperty == LUMA_DC_AC_8 ? NEW_CTX_OFFSET_ONE_8x8 : NEW_CTX_OFFSET_ONE) +
                           g_kBlockCat2CtxOffsetOne[iResProperty];
   PWelsCabacCtx pAbsCtx = pCtx->pCabacCtx + (iResProperty == LUMA_DC_AC_8 ? NEW_CTX_OFFSET_ABS_8x8 : NEW_CTX_OFFSET_ABS) +
                           g_kBlockCat2CtxOffsetAbs[iResProperty];
 
   const int16_t iMaxType = g_kMaxC2[iResProperty];
-  int32_t i = g_kMaxPos[iResProperty];
-  int32_t* pCoff = pSignificant + i;
   int32_t c1 = 1;
   int32_t c2 = 0;
-  for (; i >= 0; --i) {
-    if (*pCoff != 0) {
-      WELS_READ_VERIFY (DecodeBinCabac (pCtx->pCabacDecEngine, pOneCtx + c1, uiCode));
+  //only the significant coefficients are visited, in reverse scan order
+  for (int32_t i = (int32_t)uiCoeffNum - 1; i >= 0; --i) {
+    int32_t* pCoff = pSignificant + pSignificantPos[i];
+    WELS_READ_VERIFY (DecodeBinCabacInline (pDecEngine, pOneCtx + c1, uiCode));
+    *pCoff += uiCode;
+    if (*pCoff == 2) {
+      WELS_READ_VERIFY (DecodeUEGLevelCabac (pDecEngine, pAbsCtx + c2, uiCode));
       *pCoff += uiCode;
-      if (*pCoff == 2) {
-        WELS_READ_VERIFY (DecodeUEGLevelCabac (pCtx->pCabacDecEngine, pAbsCtx + c2, uiCode));
-        *pCoff += uiCode;
-        ++c2;
-        c2 = WELS_MIN (c2, iMaxType);
-        c1 = 0;
-      } else if (c1) {
-        ++c1;
-        c1 = WELS_MIN (c1, 4);
-      }
-      WELS_READ_VERIFY (DecodeBypassCabac (pCtx->pCabacDecEngine, uiCode));
-      if (uiCode)
-        *pCoff = - *pCoff;
+      ++c2;
+      c2 = WELS_MIN (c2, iMaxType);
+      c1 = 0;
+    } else if (c1) {
+      ++c1;
+      c1 = WELS_MIN (c1, 4);
     }
-    pCoff--;
+    WELS_READ_VERIFY (DecodeBypassCabacInline (pDecEngine, uiCode));
+    if (uiCode)
+      *pCoff = - *pCoff;
   }
   return ERR_NONE;
 }
@@ -866,6 +866,7 @@ int32_t ParseResidualBlockCabac8x8 (PWelsNeighAvail pNeighAvail, uint8_t* pNonZe
   uint32_t uiTotalCoeffNum = 0;
   uint32_t uiCbpBit;
   int32_t pSignificantMap[64] = {0};
+  uint8_t pSignificantPos[64];
 
   int32_t iMbResProperty = 0;
   GetMbResProperty (&iMbResProperty, &iResProperty, false);
@@ -874,8 +875,8 @@ int32_t ParseResidualBlockCabac8x8 (PWelsNeighAvail pNeighAvail, uint8_t* pNonZe
 
   uiCbpBit = 1; // for 8x8, MaxNumCoeff == 64 && uiCbpBit == 1
   if (uiCbpBit) { //has coeff
-    WELS_READ_VERIFY (ParseSignificantMapCabac (pSignificantMap, iResProperty, pCtx, uiTotalCoeffNum));
-    WELS_READ_VERIFY (ParseSignificantCoeffCabac (pSignificantMap, iResProperty, pCtx));
+    WELS_READ_VERIFY (ParseSignificantMapCabac (pSignificantMap, pSignificantPos, iResProperty, pCtx, uiTotalCoeffNum));
+    WELS_READ_VERIFY (ParseSignificantCoeffCabac (pSignificantMap, pSignificantPos, uiTotalCoeffNum, iResProperty, pCtx));
   }
 
   pNonZeroCountCache[g_kCacheNzcScanIdx[iIndex]] =
@@ -908,6 +909,7 @@ int32_t ParseResidualBlockCabac (PWelsNeighAvail pNeighAvail, uint8_t* pNonZeroC
   uint32_t uiTotalCoeffNum = 0;
   uint32_t uiCbpBit;
   int32_t pSignificantMap[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  uint8_t pSignificantPos[16];
 
   int32_t iMbResProperty = 0;
   GetMbResProperty (&iMbResProperty, &iResProperty, false);
@@ -916,8 +918,8 @@ int32_t ParseResidualBlockCabac (PWelsNeighAvail pNeighAvail, uint8_t* pNonZeroC
 
   WELS_READ_VERIFY (ParseCbfInfoCabac (pNeighAvail, pNonZeroCountCache, iIndex, iResProperty, pCtx, uiCbpBit));
   if (uiCbpBit) { //has coeff
-    WELS_READ_VERIFY (ParseSignificantMapCabac (pSignificantMap, iResProperty, pCtx, uiTotalCoeffNum));
-    WELS_READ_VERIFY (ParseSignificantCoeffCabac (pSignificantMap, iResProperty, pCtx));
+    WELS_READ_VERIFY (ParseSignificantMapCabac (pSignificantMap, pSignificantPos, iResProperty, pCtx, uiTotalCoeffNum));
+    WELS_READ_VERIFY (ParseSignificantCoeffCabac (pSignificantMap, pSignificantPos, uiTotalCoeffNum, iResProperty, pCtx));
   }
 
   iCurNzCacheIdx = g_kCacheNzcScanIdx[iIndex];
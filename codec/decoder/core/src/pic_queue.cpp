@@ -88,6 +88,13 @@ PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kiPicWidth, const
     pPic->pData[0] = pPic->pData[1] = pPic->pData[2] = NULL;
     pPic->iLinesize[0] = iPicWidth;
     pPic->iLinesize[1] = pPic->iLinesize[2] = iPicChromaWidth;
+  } else if (NULL != pCtx->sPicAllocator.pfGetBuffer) {
+    // planes are got from the application each time the picture is prefetched for decoding
+    pPic->pAllocator   = &pCtx->sPicAllocator;
+    pPic->pBuffer[0] = pPic->pBuffer[1] = pPic->pBuffer[2] = NULL;
+    pPic->pData[0] = pPic->pData[1] = pPic->pData[2] = NULL;
+    pPic->iLinesize[0] = iPicWidth;
+    pPic->iLinesize[1] = pPic->iLinesize[2] = iPicChromaWidth;
   } else {
     pPic->pBuffer[0] = static_cast<uint8_t*> (pMa->WelsMallocz (iLumaSize /* luma */
                        + (iChromaSize << 1) /* Cb,Cr */, "_pic->buffer[0]"));
@@ -111,9 +118,52 @@ PPicture AllocPicture (PWelsDecoderContext pCtx, const int32_t kiPicWidth, const
   return pPic;
 }
 
+static void ReleasePicBuffer (PPicture pPic) {
+  if (NULL != pPic->pUserBuffer) {
+    pPic->pAllocator->pfReleaseBuffer (pPic->pAllocator->pContext, pPic->pUserBuffer);
+    pPic->pUserBuffer = NULL;
+  }
+  pPic->pData[0] = pPic->pData[1] = pPic->pData[2] = NULL;
+}
+
+/*
+ *  get new planes from the application allocator, the previous ones are released since the picture content is not
+ *  used any more once the picture is reused, while the application may still hold them for output
+ */
+static bool RenewPicBuffer (PPicture pPic) {
+  uint8_t* pData[3] = { NULL, NULL, NULL };
+  int32_t iStride[2] = { 0, 0 };
+  void* pBuffer = NULL;
+
+  ReleasePicBuffer (pPic);
+  if (0 != pPic->pAllocator->pfGetBuffer (pPic->pAllocator->pContext, pPic->iWidthInPixel, pPic->iHeightInPixel,
+                                          PADDING_LENGTH, pData, iStride, &pBuffer))
+    return false;
+
+  if (NULL == pData[0] || NULL == pData[1] || NULL == pData[2]
+      || (((uintptr_t)pData[0] | (uintptr_t)pData[1] | (uintptr_t)pData[2]) & 15) != 0
+      || (iStride[0] & 31) != 0 || iStride[0] < pPic->iWidthInPixel + (PADDING_LENGTH << 1)
+      || iStride[0] != (iStride[1] << 1)) {
+    if (NULL != pBuffer)
+      pPic->pAllocator->pfReleaseBuffer (pPic->pAllocator->pContext, pBuffer);
+    return false;
+  }
+  pPic->pUserBuffer  = pBuffer;
+  pPic->pData[0]     = pData[0];
+  pPic->pData[1]     = pData[1];
+  pPic->pData[2]     = pData[2];
+  pPic->iLinesize[0] = iStride[0];
+  pPic->iLinesize[1] = pPic->iLinesize[2] = iStride[1];
+  return true;
+}
+
 void FreePicture (PPicture pPic, CMemoryAlign* pMa) {
   if (NULL != pPic) {
 
+    if (NULL != pPic->pAllocator) {
+      ReleasePicBuffer (pPic);
+    }
+
     if (pPic->pBuffer[0]) {
       pMa->WelsFree (pPic->pBuffer[0], "pPic->pBuffer[0]");
     }
@@ -133,24 +183,28 @@ PPicture PrefetchPic (PPicBuff pPicBuf) {
 
   for (iPicIdx = pPicBuf->iCurrentIdx + 1; iPicIdx < pPicBuf->iCapacity ; ++iPicIdx) {
     if (pPicBuf->ppPic[iPicIdx] != NULL && pPicBuf->ppPic[iPicIdx]->bAvailableFlag
-        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef) {
+        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef && 0 == pPicBuf->ppPic[iPicIdx]->uiRefCount) {
       pPic = pPicBuf->ppPic[iPicIdx];
       break;
     }
   }
   if (pPic != NULL) {
     pPicBuf->iCurrentIdx = iPicIdx;
+    if (NULL != pPic->pAllocator && !RenewPicBuffer (pPic))
+      return NULL;
     return pPic;
   }
   for (iPicIdx = 0 ; iPicIdx <= pPicBuf->iCurrentIdx ; ++iPicIdx) {
     if (pPicBuf->ppPic[iPicIdx] != NULL && pPicBuf->ppPic[iPicIdx]->bAvailableFlag
-        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef) {
+        && !pPicBuf->ppPic[iPicIdx]->bUsedAsRef && 0 == pPicBuf->ppPic[iPicIdx]->uiRefCount) {
       pPic = pPicBuf->ppPic[iPicIdx];
       break;
     }
   }
 
   pPicBuf->iCurrentIdx = iPicIdx;
+  if (NULL != pPic && NULL != pPic->pAllocator && !RenewPicBuffer (pPic))
+    return NULL;
   return pPic;
 }
 
@@ -41,6 +41,7 @@
 
 #include "rec_mb.h"
 #include "decode_slice.h"
+#include "wels_decoder_thread.h"
 
 namespace WelsDec {
 
@@ -227,6 +228,7 @@ static inline void GetRefPic (sMCRefMember* pMCRefMem, PWelsDecoderContext pCtx,
   pMCRefMem->pSrcY = pRefPic->pData[0];
   pMCRefMem->pSrcU = pRefPic->pData[1];
   pMCRefMem->pSrcV = pRefPic->pData[2];
+  pMCRefMem->pRefPic = pRefPic;
 }
 
 
@@ -242,6 +244,17 @@ void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iYOffset, SMcFun
   iFullMVy = WELS_CLIP3 (iFullMVy, ((-PADDING_LENGTH + 2) * (1 << 2)),
                          ((pMCRefMem->iPicHeight + PADDING_LENGTH - 19) * (1 << 2)));
 
+  if (NULL != pMCRefMem->pFrameTask) {
+    // lowest lines read by the 6-tap luma and the bilinear chroma interpolation
+    const int32_t kiLumaLastLine   = (iFullMVy >> 2) + iBlkHeight + 2;
+    const int32_t kiChromaLastLine = (iFullMVy >> 3) + (iBlkHeight >> 1);
+    int32_t iMbRows = WELS_MAX (kiLumaLastLine >> 4, kiChromaLastLine >> 3) + 1;
+    if (kiLumaLastLine >= pMCRefMem->iPicHeight || kiChromaLastLine >= (pMCRefMem->iPicHeight >> 1)) {
+      iMbRows = (pMCRefMem->iPicHeight >> 4) + 1; // bottom padding required
+    }
+    pMCRefMem->pFrameTask->WaitRefPicRows (pMCRefMem->pRefPic, WELS_MAX (iMbRows, 1));
+  }
+
   int32_t iSrcPixOffsetLuma = (iFullMVx >> 2) + (iFullMVy >> 2) * pMCRefMem->iSrcLineLuma;
   int32_t iSrcPixOffsetChroma = (iFullMVx >> 3) + (iFullMVy >> 3) * pMCRefMem->iSrcLineChroma;
 
@@ -264,70 +277,25 @@ void BaseMC (sMCRefMember* pMCRefMem, int32_t iXOffset, int32_t iYOffset, SMcFun
 
 }
 
-void WeightPrediction (PDqLayer pCurDqLayer, sMCRefMember* pMCRefMem, int32_t iRefIdx, int32_t iBlkWidth,
-                       int32_t iBlkHeight) {
-
-
+void WeightPrediction (PDqLayer pCurDqLayer, sMCRefMember* pMCRefMem, SMcFunc* pMCFunc, int32_t iRefIdx,
+                       int32_t iBlkWidth, int32_t iBlkHeight) {
+  const PPredWeightTabSyn kpWeightTable = pCurDqLayer->pPredWeightTable;
   int32_t iLog2denom, iWoc, iOoc;
-  int32_t iPredTemp, iLineStride;
-  int32_t iPixel = 0;
-  uint8_t* pDst;
   //luma
-  iLog2denom = pCurDqLayer->pPredWeightTable->uiLumaLog2WeightDenom;
-  iWoc = pCurDqLayer->pPredWeightTable->sPredList[LIST_0].iLumaWeight[iRefIdx];
-  iOoc = pCurDqLayer->pPredWeightTable->sPredList[LIST_0].iLumaOffset[iRefIdx];
-  iLineStride = pMCRefMem->iDstLineLuma;
-
-  for (int i = 0; i < iBlkHeight; i++) {
-    for (int j = 0; j < iBlkWidth; j++) {
-      iPixel = j + i * (iLineStride);
-      if (iLog2denom >= 1) {
-        iPredTemp = ((pMCRefMem->pDstY[iPixel] * iWoc + (1 << (iLog2denom - 1))) >> iLog2denom) + iOoc;
-
-        pMCRefMem->pDstY[iPixel] = WELS_CLIP3 (iPredTemp, 0, 255);
-      } else {
-        iPredTemp = pMCRefMem->pDstY[iPixel] * iWoc + iOoc;
-
-        pMCRefMem->pDstY[iPixel] = WELS_CLIP3 (iPredTemp, 0, 255);
-
-      }
-    }
-  }
-
+  iLog2denom = kpWeightTable->uiLumaLog2WeightDenom;
+  iWoc = kpWeightTable->sPredList[LIST_0].iLumaWeight[iRefIdx];
+  iOoc = kpWeightTable->sPredList[LIST_0].iLumaOffset[iRefIdx];
+  pMCFunc->pfWeightedPred (pMCRefMem->pDstY, pMCRefMem->iDstLineLuma, iLog2denom, iWoc, iOoc, iBlkWidth, iBlkHeight);
 
   //UV
   iBlkWidth = iBlkWidth >> 1;
   iBlkHeight = iBlkHeight >> 1;
-  iLog2denom = pCurDqLayer->pPredWeightTable->uiChromaLog2WeightDenom;
-  iLineStride = pMCRefMem->iDstLineChroma;
-
+  iLog2denom = kpWeightTable->uiChromaLog2WeightDenom;
   for (int i = 0; i < 2; i++) {
-
-
-    //iLog2denom = pCurDqLayer->pPredWeightTable->uiChromaLog2WeightDenom;
-    iWoc =  pCurDqLayer->pPredWeightTable->sPredList[LIST_0].iChromaWeight[iRefIdx][i];
-    iOoc = pCurDqLayer->pPredWeightTable->sPredList[LIST_0].iChromaOffset[iRefIdx][i];
-    pDst = i ? pMCRefMem->pDstV : pMCRefMem->pDstU;
-    //iLineStride = pMCRefMem->iDstLineChroma;
-
-    for (int i = 0; i < iBlkHeight ; i++) {
-      for (int j = 0; j < iBlkWidth; j++) {
-        iPixel = j + i * (iLineStride);
-        if (iLog2denom >= 1) {
-          iPredTemp = ((pDst[iPixel] * iWoc + (1 << (iLog2denom - 1))) >> iLog2denom) + iOoc;
-
-          pDst[iPixel] = WELS_CLIP3 (iPredTemp, 0, 255);
-        } else {
-          iPredTemp = pDst[iPixel] * iWoc + iOoc;
-
-          pDst[iPixel] = WELS_CLIP3 (iPredTemp, 0, 255);
-
-        }
-      }
-
-    }
-
-
+    iWoc = kpWeightTable->sPredList[LIST_0].iChromaWeight[iRefIdx][i];
+    iOoc = kpWeightTable->sPredList[LIST_0].iChromaOffset[iRefIdx][i];
+    pMCFunc->pfWeightedPred (i ? pMCRefMem->pDstV : pMCRefMem->pDstU, pMCRefMem->iDstLineChroma, iLog2denom, iWoc, iOoc,
+                             iBlkWidth, iBlkHeight);
   }
 }
 
@@ -354,6 +322,8 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
   pMCRefMem.iPicWidth = (pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iMbWidth << 4);
   pMCRefMem.iPicHeight = (pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader.iMbHeight << 4);
 
+  pMCRefMem.pFrameTask = pCtx->pFrameTask;
+
   pMCRefMem.pDstY = pPredY;
   pMCRefMem.pDstU = pPredCb;
   pMCRefMem.pDstV = pPredCr;
@@ -373,7 +343,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 
     if (pCurDqLayer->bUseWeightPredictionFlag) {
       iRefIndex = pCurDqLayer->pRefIndex[0][iMBXY][0];
-      WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 16, 16);
+      WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 16, 16);
     }
     break;
   case MB_TYPE_16x8:
@@ -384,7 +354,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 
     if (pCurDqLayer->bUseWeightPredictionFlag) {
       iRefIndex = pCurDqLayer->pRefIndex[0][iMBXY][0];
-      WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 16, 8);
+      WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 16, 8);
     }
 
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][8][0];
@@ -397,7 +367,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 
     if (pCurDqLayer->bUseWeightPredictionFlag) {
       iRefIndex = pCurDqLayer->pRefIndex[0][iMBXY][8];
-      WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 16, 8);
+      WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 16, 8);
     }
     break;
   case MB_TYPE_8x16:
@@ -407,7 +377,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
     BaseMC (&pMCRefMem, iMBOffsetX, iMBOffsetY, pMCFunc, 8, 16, iMVs);
     if (pCurDqLayer->bUseWeightPredictionFlag) {
       iRefIndex = pCurDqLayer->pRefIndex[0][iMBXY][0];
-      WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 8, 16);
+      WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 8, 16);
     }
 
     iMVs[0] = pCurDqLayer->pMv[0][iMBXY][2][0];
@@ -420,7 +390,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
 
     if (pCurDqLayer->bUseWeightPredictionFlag) {
       iRefIndex = pCurDqLayer->pRefIndex[0][iMBXY][2];
-      WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 8, 16);
+      WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 8, 16);
     }
     break;
   case MB_TYPE_8x8:
@@ -452,7 +422,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
         BaseMC (&pMCRefMem, iXOffset, iYOffset, pMCFunc, 8, 8, iMVs);
         if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-          WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 8, 8);
+          WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 8, 8);
         }
 
         break;
@@ -462,7 +432,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
         BaseMC (&pMCRefMem, iXOffset, iYOffset, pMCFunc, 8, 4, iMVs);
         if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-          WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 8, 4);
+          WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 8, 4);
         }
 
 
@@ -474,7 +444,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
         BaseMC (&pMCRefMem, iXOffset, iYOffset + 4, pMCFunc, 8, 4, iMVs);
         if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-          WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 8, 4);
+          WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 8, 4);
         }
 
         break;
@@ -484,7 +454,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
         BaseMC (&pMCRefMem, iXOffset, iYOffset, pMCFunc, 4, 8, iMVs);
         if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-          WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 4, 8);
+          WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 4, 8);
         }
 
 
@@ -496,7 +466,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
         BaseMC (&pMCRefMem, iXOffset + 4, iYOffset, pMCFunc, 4, 8, iMVs);
         if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-          WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 4, 8);
+          WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 4, 8);
         }
 
         break;
@@ -518,7 +488,7 @@ void GetInterPred (uint8_t* pPredY, uint8_t* pPredCb, uint8_t* pPredCr, PWelsDec
           BaseMC (&pMCRefMem, iXOffset + iBlk4X, iYOffset + iBlk4Y, pMCFunc, 4, 4, iMVs);
           if (pCurDqLayer->bUseWeightPredictionFlag) {
 
-            WeightPrediction (pCurDqLayer, &pMCRefMem, iRefIndex, 4, 4);
+            WeightPrediction (pCurDqLayer, &pMCRefMem, pMCFunc, iRefIndex, 4, 4);
           }
 
         }
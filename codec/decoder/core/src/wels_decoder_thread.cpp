@@ -0,0 +1,943 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_decoder_thread.cpp
+ *
+ * \brief   frame level multi-threading of decoder
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include "wels_decoder_thread.h"
+#include "decoder_core.h"
+#include "decode_slice.h"
+#include "deblocking.h"
+#include "expand_pic.h"
+#include "error_code.h"
+#include "memory_align.h"
+
+namespace WelsDec {
+
+#define SLICE_RECORD_STEP 16
+
+//////////////////////////////////////////////////////////////////////
+// CWelsDecFrameTask
+//////////////////////////////////////////////////////////////////////
+
+CWelsDecFrameTask::CWelsDecFrameTask (CWelsDecTaskManage* pManage)
+  : IWelsTask (this),
+    m_pManage (pManage),
+    m_pCtx (NULL),
+    m_pPic (NULL),
+    m_pSlices (NULL),
+    m_iSliceNum (0),
+    m_iSliceCapacity (0),
+    m_iNextSlice (0),
+    m_iSliceError (ERR_NONE),
+    m_iRefPicNum (0),
+    m_bSync (false),
+    m_bRef (false),
+    m_bDone (true),
+    m_iErrorCode (ERR_NONE),
+    m_iFilteredMbXy (0),
+    m_iPaddedRows (0),
+    m_iReadyRefNum (0),
+    m_bOutput (false),
+    m_pOutBuffer (NULL),
+    m_iOutBufferSize (0) {
+  memset (&m_sMbData, 0, sizeof (m_sMbData));
+  memset (m_pRefPic, 0, sizeof (m_pRefPic));
+  memset (m_pDst, 0, sizeof (m_pDst));
+  memset (&m_sDstInfo, 0, sizeof (m_sDstInfo));
+}
+
+CWelsDecFrameTask::~CWelsDecFrameTask() {
+}
+
+int32_t CWelsDecFrameTask::Init (CMemoryAlign* pMa) {
+  m_pCtx = (PWelsDecoderContext)pMa->WelsMallocz (sizeof (SWelsDecoderContext), "CWelsDecFrameTask::m_pCtx");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, (NULL == m_pCtx))
+  return ERR_NONE;
+}
+
+void CWelsDecFrameTask::Uninit (CMemoryAlign* pMa) {
+  UninitialMbData (pMa, &m_sMbData, 0);
+  memset (&m_sMbData, 0, sizeof (m_sMbData));
+  if (m_pSlices) {
+    pMa->WelsFree (m_pSlices, "CWelsDecFrameTask::m_pSlices");
+    m_pSlices = NULL;
+  }
+  m_iSliceCapacity = 0;
+  if (m_pOutBuffer) {
+    pMa->WelsFree (m_pOutBuffer, "CWelsDecFrameTask::m_pOutBuffer");
+    m_pOutBuffer = NULL;
+  }
+  m_iOutBufferSize = 0;
+  if (m_pCtx) {
+    pMa->WelsFree (m_pCtx, "CWelsDecFrameTask::m_pCtx");
+    m_pCtx = NULL;
+  }
+}
+
+int CWelsDecFrameTask::Execute() {
+  const int32_t kiMbHeight = m_pPic->iHeightInPixel >> 4;
+
+  m_iReadyRefNum = 0;
+  m_iErrorCode = ReconstructSlices();
+
+  if (m_bRef) {
+    if (m_iPaddedRows < kiMbHeight) {
+      const bool kbTopPadding = (0 == m_iPaddedRows);
+      PadRows (m_iPaddedRows, kiMbHeight);
+      if (kbTopPadding) {
+        PadTopBottom (true);
+      }
+    }
+    PadTopBottom (false);
+  }
+  m_pManage->SetReadyRows (m_pPic, kiMbHeight + 1, true);
+
+  return m_iErrorCode;
+}
+
+int CWelsDecFrameTask::OnTaskExecuted() {
+  m_pManage->OnTaskDone (this);
+  return ERR_NONE;
+}
+
+int CWelsDecFrameTask::OnTaskCancelled() {
+  m_pManage->OnTaskDone (this);
+  return ERR_NONE;
+}
+
+void CWelsDecFrameTask::OnMbsFiltered (const int32_t kiFirstMbXy, const int32_t kiEndMbXy) {
+  if (kiFirstMbXy != m_iFilteredMbXy) { // slices out of order, the picture is published when it is done
+    return;
+  }
+  m_iFilteredMbXy = kiEndMbXy;
+  if (m_bSync || !m_bRef) {
+    return;
+  }
+
+  // the last MB row filtered may be still modified by the deblocking of the row below
+  const int32_t kiMbWidth  = m_pPic->iWidthInPixel >> 4;
+  const int32_t kiReadyRows = m_iFilteredMbXy / kiMbWidth - 1;
+  if (kiReadyRows > m_iPaddedRows) {
+    const bool kbTopPadding = (0 == m_iPaddedRows);
+    PadRows (m_iPaddedRows, kiReadyRows);
+    if (kbTopPadding) {
+      PadTopBottom (true);
+    }
+    m_iPaddedRows = kiReadyRows;
+    PublishRows (kiReadyRows);
+  }
+}
+
+void CWelsDecFrameTask::WaitRefPicRows (PPicture pRefPic, const int32_t kiMbRows) {
+  int32_t i = 0;
+  for (i = 0; i < m_iReadyRefNum; ++ i) {
+    if (m_pReadyRefPic[i] == pRefPic) {
+      if (m_iReadyRefRows[i] >= kiMbRows) {
+        return;
+      }
+      break;
+    }
+  }
+
+  const int32_t kiReadyRows = m_pManage->WaitReadyRows (pRefPic, kiMbRows);
+  if (i == m_iReadyRefNum) {
+    if (m_iReadyRefNum >= MAX_DPB_COUNT) {
+      return;
+    }
+    m_pReadyRefPic[m_iReadyRefNum++] = pRefPic;
+  }
+  m_iReadyRefRows[i] = kiReadyRows;
+}
+
+int32_t CWelsDecFrameTask::PrepareContext (PWelsDecoderContext pSrcCtx) {
+  memcpy (m_pCtx, pSrcCtx, sizeof (SWelsDecoderContext)); //confirmed_safe_unsafe_usage
+  m_pCtx->pDec         = m_pPic;
+  m_pCtx->pCurDqLayer  = NULL;
+  m_pCtx->pTaskManage  = NULL;
+  m_pCtx->pFrameTask   = m_bSync ? NULL : this; // all the reference pictures are ready when synchronized
+  return ERR_NONE;
+}
+
+int32_t CWelsDecFrameTask::ReconstructSlices() {
+  int32_t iRet = ERR_NONE;
+  for (int32_t i = 0; i < m_iSliceNum; ++ i) {
+    PSliceReconInfo pSlice = &m_pSlices[i];
+    PDqLayer pDqLayer = &pSlice->sDqLayer;
+    PSliceHeader pSh = &pDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader;
+
+    // the snapshot could have been moved since recorded
+    pDqLayer->sLayerInfo.pSps = pSh->pSps = &pSlice->sSps;
+    pDqLayer->sLayerInfo.pPps = pSh->pPps = &pSlice->sPps;
+    pDqLayer->pPredWeightTable = &pSlice->sPredWeightTable;
+    pDqLayer->pDec = m_pPic;
+  }
+
+  if (!m_bSync && m_iSliceNum > 1 && m_pManage->m_iSliceTaskNum > 0) {
+    iRet = ReconstructSlicesParallel();
+  } else {
+    for (int32_t i = 0; i < m_iSliceNum && ERR_NONE == iRet; ++ i) {
+      iRet = ReconstructSlice (m_pCtx, i, false);
+    }
+  }
+  m_iSliceNum = 0;
+  return iRet;
+}
+
+/*
+ * slices do not refer to each other but through the deblocking, so they are reconstructed concurrently and the
+ * deblocking across slice boundaries is done afterwards in decoding order, which is bit exact with the sequential
+ * reconstruction
+ */
+int32_t CWelsDecFrameTask::ReconstructSlicesParallel() {
+  CWelsDecFrameTask* pFrameTask = m_pCtx->pFrameTask;
+
+  // the slice tasks do not wait for the reference rows one by one, the reference pictures have to be complete
+  for (int32_t i = 0; i < m_iRefPicNum; ++ i) {
+    m_pManage->WaitReadyRows (m_pRefPic[i], (m_pRefPic[i]->iHeightInPixel >> 4) + 1);
+  }
+
+  m_pCtx->pFrameTask = NULL;
+  m_iNextSlice  = 0;
+  m_iSliceError = ERR_NONE;
+  m_pManage->StartSliceTasks (this, m_iSliceNum - 1);
+  ReconstructNextSlices (m_pCtx);
+  m_pManage->StopSliceTasks (this);
+  m_pCtx->pFrameTask = pFrameTask;
+
+  if (ERR_NONE != m_iSliceError) {
+    return m_iSliceError;
+  }
+
+  for (int32_t i = 0; i < m_iSliceNum; ++ i) {
+    PDqLayer pDqLayer = &m_pSlices[i].sDqLayer;
+    PSlice pSlice = &pDqLayer->sLayerInfo.sSliceInLayer;
+    PSliceHeader pSh = &pSlice->sSliceHeaderExt.sSliceHeader;
+    if (0 == pSh->uiDisableDeblockingFilterIdc) {
+      m_pCtx->pCurDqLayer = pDqLayer;
+      WelsDeblockingFilterSlice (m_pCtx, WelsDeblockingMb);
+    }
+    if (NULL != pFrameTask) {
+      OnMbsFiltered (pSh->iFirstMbInSlice, WELS_MIN (pSh->iFirstMbInSlice + pSlice->iTotalMbInCurSlice,
+                     (int32_t)pSh->pSps->uiTotalMbCount));
+    }
+  }
+  return ERR_NONE;
+}
+
+int32_t CWelsDecFrameTask::ReconstructSlice (PWelsDecoderContext pCtx, const int32_t kiIdx, const bool kbParallel) {
+  PSliceReconInfo pSlice = &m_pSlices[kiIdx];
+
+  pCtx->pCurDqLayer = &pSlice->sDqLayer;
+  memcpy (pCtx->sRefPic.pRefList[LIST_0], pSlice->pRefList, sizeof (pSlice->pRefList)); //confirmed_safe_unsafe_usage
+
+  const int32_t kiRet = WelsTargetSliceReconstruction (pCtx, kbParallel);
+  if (ERR_NONE != kiRet) {
+    WelsLog (& (pCtx->sLogCtx), WELS_LOG_WARNING, "CWelsDecFrameTask::ReconstructSlice() failed (%d) in slice %d",
+             kiRet, kiIdx);
+  }
+  return kiRet;
+}
+
+void CWelsDecFrameTask::ReconstructNextSlices (PWelsDecoderContext pCtx) {
+  while (true) {
+    WelsMutexLock (&m_pManage->m_hMutex);
+    const int32_t kiIdx = (ERR_NONE == m_iSliceError) ? m_iNextSlice++ : m_iSliceNum;
+    WelsMutexUnlock (&m_pManage->m_hMutex);
+    if (kiIdx >= m_iSliceNum) {
+      return;
+    }
+
+    const int32_t kiRet = ReconstructSlice (pCtx, kiIdx, true);
+    if (ERR_NONE != kiRet) {
+      WelsMutexLock (&m_pManage->m_hMutex);
+      m_iSliceError = kiRet;
+      WelsMutexUnlock (&m_pManage->m_hMutex);
+    }
+  }
+}
+
+void CWelsDecFrameTask::PadRows (const int32_t kiFirstRow, const int32_t kiEndRow) {
+  const int32_t kiWidth = m_pPic->iWidthInPixel;
+  const int32_t kiPadding = PADDING_LENGTH;
+  for (int32_t iPlane = 0; iPlane < 3; ++ iPlane) {
+    const int32_t kiShift = iPlane ? 1 : 0;
+    const int32_t kiStride = m_pPic->iLinesize[iPlane];
+    const int32_t kiPlaneWidth = kiWidth >> kiShift;
+    const int32_t kiPlanePadding = kiPadding >> kiShift;
+    const int32_t kiEndLine = (kiEndRow << 4) >> kiShift;
+    uint8_t* pLine = m_pPic->pData[iPlane] + ((kiFirstRow << 4) >> kiShift) * kiStride;
+    for (int32_t iLine = (kiFirstRow << 4) >> kiShift; iLine < kiEndLine; ++ iLine) {
+      memset (pLine - kiPlanePadding, pLine[0], kiPlanePadding);
+      memset (pLine + kiPlaneWidth, pLine[kiPlaneWidth - 1], kiPlanePadding);
+      pLine += kiStride;
+    }
+  }
+}
+
+void CWelsDecFrameTask::PadTopBottom (const bool kbTop) {
+  const int32_t kiPadding = PADDING_LENGTH;
+  for (int32_t iPlane = 0; iPlane < 3; ++ iPlane) {
+    const int32_t kiShift = iPlane ? 1 : 0;
+    const int32_t kiStride = m_pPic->iLinesize[iPlane];
+    const int32_t kiPlanePadding = kiPadding >> kiShift;
+    const int32_t kiLineLen = (m_pPic->iWidthInPixel >> kiShift) + (kiPlanePadding << 1);
+    const int32_t kiStep = kbTop ? -kiStride : kiStride;
+    // the edge line with its left and right padding done
+    uint8_t* pEdge = m_pPic->pData[iPlane] - kiPlanePadding;
+    if (!kbTop) {
+      pEdge += ((m_pPic->iHeightInPixel >> kiShift) - 1) * kiStride;
+    }
+    uint8_t* pLine = pEdge;
+    for (int32_t i = 0; i < kiPlanePadding; ++ i) {
+      pLine += kiStep;
+      memcpy (pLine, pEdge, kiLineLen); //confirmed_safe_unsafe_usage
+    }
+  }
+}
+
+void CWelsDecFrameTask::PublishRows (const int32_t kiMbRows) {
+  m_pManage->SetReadyRows (m_pPic, kiMbRows, false);
+}
+
+int32_t CWelsDecFrameTask::AddRefPic (PPicture pRefPic) {
+  if (NULL == pRefPic) {
+    return ERR_NONE;
+  }
+  for (int32_t i = 0; i < m_iRefPicNum; ++ i) {
+    if (m_pRefPic[i] == pRefPic) {
+      return ERR_NONE;
+    }
+  }
+  if (m_iRefPicNum >= MAX_DPB_COUNT) {
+    return ERR_INFO_REF_COUNT_OVERFLOW;
+  }
+  m_pRefPic[m_iRefPicNum++] = pRefPic;
+  ++ pRefPic->uiRefCount;
+  return ERR_NONE;
+}
+
+void CWelsDecFrameTask::ReleasePictures() {
+  for (int32_t i = 0; i < m_iRefPicNum; ++ i) {
+    -- m_pRefPic[i]->uiRefCount;
+    m_pRefPic[i] = NULL;
+  }
+  m_iRefPicNum = 0;
+}
+
+//////////////////////////////////////////////////////////////////////
+// CWelsDecSliceTask
+//////////////////////////////////////////////////////////////////////
+
+CWelsDecSliceTask::CWelsDecSliceTask (CWelsDecTaskManage* pManage)
+  : IWelsTask (this),
+    m_pManage (pManage),
+    m_pCtx (NULL),
+    m_pFrameTask (NULL),
+    m_bBusy (false),
+    m_bRunning (false) {
+}
+
+CWelsDecSliceTask::~CWelsDecSliceTask() {
+}
+
+int32_t CWelsDecSliceTask::Init (CMemoryAlign* pMa) {
+  m_pCtx = (PWelsDecoderContext)pMa->WelsMallocz (sizeof (SWelsDecoderContext), "CWelsDecSliceTask::m_pCtx");
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, (NULL == m_pCtx))
+  return ERR_NONE;
+}
+
+void CWelsDecSliceTask::Uninit (CMemoryAlign* pMa) {
+  if (m_pCtx) {
+    pMa->WelsFree (m_pCtx, "CWelsDecSliceTask::m_pCtx");
+    m_pCtx = NULL;
+  }
+}
+
+int CWelsDecSliceTask::Execute() {
+  CWelsDecFrameTask* pFrameTask = m_pManage->BeginSliceTask (this);
+  if (NULL != pFrameTask) {
+    pFrameTask->ReconstructNextSlices (m_pCtx);
+  }
+  return ERR_NONE;
+}
+
+int CWelsDecSliceTask::OnTaskExecuted() {
+  m_pManage->OnSliceTaskDone (this);
+  return ERR_NONE;
+}
+
+int CWelsDecSliceTask::OnTaskCancelled() {
+  m_pManage->OnSliceTaskDone (this);
+  return ERR_NONE;
+}
+
+//////////////////////////////////////////////////////////////////////
+// CWelsDecTaskManage
+//////////////////////////////////////////////////////////////////////
+
+CWelsDecTaskManage::CWelsDecTaskManage()
+  : m_pCtx (NULL),
+    m_pThreadPool (NULL),
+    m_iThreadNum (0),
+    m_bSliceThreading (false),
+    m_iTaskNum (0),
+    m_iPendingNum (0),
+    m_pCurTask (NULL),
+    m_iSliceTaskNum (0) {
+  memset (m_pTasks, 0, sizeof (m_pTasks));
+  memset (m_pPending, 0, sizeof (m_pPending));
+  memset (m_pSliceTasks, 0, sizeof (m_pSliceTasks));
+  WelsMutexInit (&m_hMutex);
+  WelsCondInit (&m_hCond);
+}
+
+CWelsDecTaskManage::~CWelsDecTaskManage() {
+  WelsCondDestroy (&m_hCond);
+  WelsMutexDestroy (&m_hMutex);
+}
+
+CWelsDecTaskManage* CWelsDecTaskManage::CreateTaskManage (PWelsDecoderContext pCtx, const int32_t kiThreadNum) {
+  if (NULL == pCtx) {
+    return NULL;
+  }
+
+  CWelsDecTaskManage* pTaskManage;
+  pTaskManage = WELS_NEW_OP (CWelsDecTaskManage(), CWelsDecTaskManage);
+  WELS_VERIFY_RETURN_IF (NULL, NULL == pTaskManage)
+
+  if (ERR_NONE != pTaskManage->Init (pCtx, kiThreadNum)) {
+    pTaskManage->Uninit();
+    WELS_DELETE_OP (pTaskManage);
+  }
+  return pTaskManage;
+}
+
+void CWelsDecTaskManage::DestroyTaskManage (CWelsDecTaskManage** ppTaskManage) {
+  if (NULL != ppTaskManage && NULL != *ppTaskManage) {
+    (*ppTaskManage)->Uninit();
+    WELS_DELETE_OP (*ppTaskManage);
+  }
+}
+
+int32_t CWelsDecTaskManage::Init (PWelsDecoderContext pCtx, const int32_t kiThreadNum) {
+  m_pCtx = pCtx;
+  m_iThreadNum = WELS_CLIP3 (kiThreadNum, 1, MAX_THREADS_NUM);
+  m_bSliceThreading = pCtx->bSliceThreading;
+
+  // the calling thread reconstructs slices along with the pool when no frame task is queued
+  const int32_t kiPoolThreadNum = m_bSliceThreading ? WELS_MAX (m_iThreadNum - 1, 1) : m_iThreadNum;
+  if (pCtx->bThreadPoolParam) {
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference (&pCtx->sThreadPoolParam, kiPoolThreadNum);
+  } else {
+    if (WELS_THREAD_ERROR_OK != WelsCommon::CWelsThreadPool::SetThreadNum (kiPoolThreadNum)) {
+      WelsLog (& (pCtx->sLogCtx), WELS_LOG_INFO,
+               "CWelsDecTaskManage::Init(), thread pool created already, thread number %d ignored", kiPoolThreadNum);
+    }
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference();
+  }
+  WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == m_pThreadPool)
+
+  // one more for the picture being parsed and one more for the output, the frame tasks queued aside
+  m_iTaskNum = m_bSliceThreading ? 2 : m_iThreadNum + 2;
+  for (int32_t i = 0; i < m_iTaskNum; ++ i) {
+    m_pTasks[i] = WELS_NEW_OP (CWelsDecFrameTask (this), CWelsDecFrameTask);
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == m_pTasks[i])
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, ERR_NONE != m_pTasks[i]->Init (pCtx->pMemAlign))
+  }
+
+  // the frame task reconstructs slices as well, so one less
+  m_iSliceTaskNum = m_iThreadNum - 1;
+  for (int32_t i = 0; i < m_iSliceTaskNum; ++ i) {
+    m_pSliceTasks[i] = WELS_NEW_OP (CWelsDecSliceTask (this), CWelsDecSliceTask);
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == m_pSliceTasks[i])
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, ERR_NONE != m_pSliceTasks[i]->Init (pCtx->pMemAlign))
+  }
+  return ERR_NONE;
+}
+
+void CWelsDecTaskManage::Uninit() {
+  if (NULL != m_pCurTask) {
+    ReleaseTask (m_pCurTask);
+    m_pCurTask = NULL;
+  }
+  WaitForTasks();
+  while (m_iPendingNum > 0) {
+    PopTask();
+  }
+
+  for (int32_t i = 0; i < m_iTaskNum; ++ i) {
+    if (NULL != m_pTasks[i]) {
+      m_pTasks[i]->Uninit (m_pCtx->pMemAlign);
+      WELS_DELETE_OP (m_pTasks[i]);
+    }
+  }
+  m_iTaskNum = 0;
+
+  // slice tasks revoked may be still queued
+  WelsMutexLock (&m_hMutex);
+  for (int32_t i = 0; i < m_iSliceTaskNum; ++ i) {
+    while (NULL != m_pSliceTasks[i] && m_pSliceTasks[i]->m_bBusy) {
+      WelsCondWait (&m_hCond, &m_hMutex);
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+  for (int32_t i = 0; i < m_iSliceTaskNum; ++ i) {
+    if (NULL != m_pSliceTasks[i]) {
+      m_pSliceTasks[i]->Uninit (m_pCtx->pMemAlign);
+      WELS_DELETE_OP (m_pSliceTasks[i]);
+    }
+  }
+  m_iSliceTaskNum = 0;
+
+  if (NULL != m_pThreadPool) {
+    m_pThreadPool->RemoveInstance();
+    m_pThreadPool = NULL;
+  }
+}
+
+SMbData* CWelsDecTaskManage::GetMbData() {
+  return (NULL != m_pCurTask) ? &m_pCurTask->m_sMbData : NULL;
+}
+
+int32_t CWelsDecTaskManage::StartPicture (PWelsDecoderContext pCtx) {
+  PPicture pPic = pCtx->pDec;
+  CWelsDecFrameTask* pTask = m_pCurTask;
+
+  if (NULL != pTask && pTask->m_pPic != pPic) { // the picture bound was dropped
+    ReleaseTask (pTask);
+    pTask = m_pCurTask = NULL;
+  }
+
+  if (NULL == pTask) {
+    for (int32_t i = 0; i < m_iTaskNum && NULL == pTask; ++ i) {
+      bool bPending = false;
+      for (int32_t j = 0; j < m_iPendingNum && !bPending; ++ j) {
+        bPending = (m_pPending[j] == m_pTasks[i]);
+      }
+      if (!bPending && NULL == m_pTasks[i]->m_pPic) {
+        pTask = m_pTasks[i];
+      }
+    }
+    if (NULL == pTask) { // output not retrieved in time, the oldest one is dropped
+      WaitTask (m_pPending[0]);
+      pTask = m_pPending[0];
+      PopTask();
+    }
+    pTask->m_pPic = pPic;
+    ++ pPic->uiRefCount;
+    m_pCurTask = pTask;
+  }
+
+  pTask->ReleasePictures();
+  pTask->m_iSliceNum      = 0;
+  pTask->m_bSync          = false;
+  pTask->m_bRef           = false;
+  pTask->m_bDone          = false;
+  pTask->m_iErrorCode     = ERR_NONE;
+  pTask->m_iFilteredMbXy  = 0;
+  pTask->m_iPaddedRows    = 0;
+  pTask->m_bOutput        = false;
+
+  SMbData* pMbData = &pTask->m_sMbData;
+  if (pMbData->iMbWidth != pCtx->sMb.iMbWidth || pMbData->iMbHeight != pCtx->sMb.iMbHeight) {
+    UninitialMbData (pCtx->pMemAlign, pMbData, 0);
+    pMbData->iMbWidth  = pCtx->sMb.iMbWidth;
+    pMbData->iMbHeight = pCtx->sMb.iMbHeight;
+    if (ERR_NONE != InitialMbData (pCtx->pMemAlign, pMbData, 0)) {
+      UninitialMbData (pCtx->pMemAlign, pMbData, 0);
+      pMbData->iMbWidth = pMbData->iMbHeight = 0;
+      ReleaseTask (pTask);
+      m_pCurTask = NULL;
+      return ERR_INFO_OUT_OF_MEMORY;
+    }
+  }
+  memset (pMbData->pSliceIdc[0], 0xff, (pMbData->iMbWidth * pMbData->iMbHeight * sizeof (int32_t)));
+
+  WelsMutexLock (&m_hMutex);
+  pPic->bRecInProgress = true;
+  pPic->iReadyMbRows   = 0;
+  WelsMutexUnlock (&m_hMutex);
+
+  InitCurDqLayerData (pCtx, pCtx->pCurDqLayer);
+  return ERR_NONE;
+}
+
+bool CWelsDecTaskManage::CanDeferSlice (PWelsDecoderContext pCtx) {
+  CWelsDecFrameTask* pTask = m_pCurTask;
+  PDqLayer pCurDq = pCtx->pCurDqLayer;
+  PSlice pCurSlice = &pCurDq->sLayerInfo.sSliceInLayer;
+  PSliceHeader pSh = &pCurSlice->sSliceHeaderExt.sSliceHeader;
+
+  if (NULL == pTask || pTask->m_pPic != pCtx->pDec || pTask->m_bSync) {
+    return false;
+  }
+  // SVC, FMO and the slices with errors are reconstructed on the calling thread as before
+  if (dsErrorFree != pCtx->iErrorCode || pCtx->bRPLRError || !pCtx->bAvcBasedFlag || 0 != pCurDq->uiLayerDqId
+      || pSh->pPps->uiNumSliceGroups > 1 || pCurSlice->iTotalMbInCurSlice <= 0
+      || (pCurSlice->eSliceType != I_SLICE && pCurSlice->eSliceType != P_SLICE)
+      || pCtx->iTotalNumMbRec + pCurSlice->iTotalMbInCurSlice > (int32_t)pSh->pSps->uiTotalMbCount) {
+    return false;
+  }
+  if (pCurSlice->eSliceType == P_SLICE) {
+    int32_t iNewRefNum = 0;
+    for (int32_t i = 0; i < pCtx->sRefPic.uiRefCount[LIST_0]; ++ i) {
+      PPicture pRefPic = pCtx->sRefPic.pRefList[LIST_0][i];
+      bool bHeld = (NULL == pRefPic);
+      for (int32_t j = 0; j < pTask->m_iRefPicNum && !bHeld; ++ j) {
+        bHeld = (pTask->m_pRefPic[j] == pRefPic);
+      }
+      iNewRefNum += bHeld ? 0 : 1;
+    }
+    if (pTask->m_iRefPicNum + iNewRefNum > MAX_DPB_COUNT) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int32_t CWelsDecTaskManage::ConstructSlice (PWelsDecoderContext pCtx) {
+  CWelsDecFrameTask* pTask = m_pCurTask;
+  if (!CanDeferSlice (pCtx)) {
+    SyncPicture (pCtx);
+    return WelsTargetSliceConstruction (pCtx);
+  }
+
+  if (pTask->m_iSliceNum >= pTask->m_iSliceCapacity) {
+    // grow geometrically, pictures coded with one slice per MB row or even per MB are common
+    const int32_t kiCapacity = WELS_MAX (SLICE_RECORD_STEP, pTask->m_iSliceCapacity << 1);
+    PSliceReconInfo pSlices = (PSliceReconInfo)pCtx->pMemAlign->WelsMallocz (kiCapacity * sizeof (SSliceReconInfo),
+                              "CWelsDecFrameTask::m_pSlices");
+    if (NULL == pSlices) {
+      SyncPicture (pCtx);
+      return WelsTargetSliceConstruction (pCtx);
+    }
+    if (NULL != pTask->m_pSlices) {
+      memcpy (pSlices, pTask->m_pSlices, pTask->m_iSliceNum * sizeof (SSliceReconInfo)); //confirmed_safe_unsafe_usage
+      pCtx->pMemAlign->WelsFree (pTask->m_pSlices, "CWelsDecFrameTask::m_pSlices");
+    }
+    pTask->m_pSlices = pSlices;
+    pTask->m_iSliceCapacity = kiCapacity;
+  }
+
+  PSliceReconInfo pSlice = &pTask->m_pSlices[pTask->m_iSliceNum];
+  PSliceHeader pSh = &pCtx->pCurDqLayer->sLayerInfo.sSliceInLayer.sSliceHeaderExt.sSliceHeader;
+  memcpy (&pSlice->sDqLayer, pCtx->pCurDqLayer, sizeof (SDqLayer)); //confirmed_safe_unsafe_usage
+  memcpy (&pSlice->sSps, pSh->pSps, sizeof (SSps)); //confirmed_safe_unsafe_usage
+  memcpy (&pSlice->sPps, pSh->pPps, sizeof (SPps)); //confirmed_safe_unsafe_usage
+  memcpy (&pSlice->sPredWeightTable, &pSh->sPredWeightTable, sizeof (SPredWeightTabSyn)); //confirmed_safe_unsafe_usage
+  memcpy (pSlice->pRefList, pCtx->sRefPic.pRefList[LIST_0], sizeof (pSlice->pRefList)); //confirmed_safe_unsafe_usage
+  if (pSh->eSliceType == P_SLICE) {
+    for (int32_t i = 0; i < pCtx->sRefPic.uiRefCount[LIST_0]; ++ i) {
+      pTask->AddRefPic (pCtx->sRefPic.pRefList[LIST_0][i]);
+    }
+  }
+  ++ pTask->m_iSliceNum;
+
+  return WelsTargetSliceMarkDecoded (pCtx);
+}
+
+void CWelsDecTaskManage::SyncPicture (PWelsDecoderContext pCtx) {
+  CWelsDecFrameTask* pTask = m_pCurTask;
+  if (NULL == pTask || pTask->m_bSync) {
+    return;
+  }
+
+  WaitForTasks();
+  pTask->m_bSync = true;
+  if (pTask->m_iSliceNum > 0) {
+    pTask->PrepareContext (pCtx);
+    if (ERR_NONE != pTask->ReconstructSlices()) {
+      pTask->m_pPic->bIsComplete = false;
+    }
+  }
+  pTask->ReleasePictures();
+}
+
+void CWelsDecTaskManage::FinishPicture (PWelsDecoderContext pCtx, uint8_t** ppDst, SBufferInfo* pDstInfo,
+                                        const bool kbRef) {
+  CWelsDecFrameTask* pTask = m_pCurTask;
+  if (NULL == pTask) {
+    return;
+  }
+  m_pCurTask = NULL;
+  if (pTask->m_pPic != pCtx->pDec) {
+    ReleaseTask (pTask);
+    return;
+  }
+
+  pTask->m_bRef = kbRef;
+  pTask->m_bOutput = (NULL != pDstInfo) && (1 == pDstInfo->iBufferStatus);
+  if (pTask->m_bOutput) {
+    pTask->m_pDst[0] = ppDst[0];
+    pTask->m_pDst[1] = ppDst[1];
+    pTask->m_pDst[2] = ppDst[2];
+    memcpy (&pTask->m_sDstInfo, pDstInfo, sizeof (SBufferInfo)); //confirmed_safe_unsafe_usage
+  }
+  m_pPending[m_iPendingNum++] = pTask;
+
+  if (pTask->m_bSync || 0 == pTask->m_iSliceNum) {
+    if (kbRef) {
+      ExpandReferencingPicture (pTask->m_pPic->pData, pTask->m_pPic->iWidthInPixel, pTask->m_pPic->iHeightInPixel,
+                                pTask->m_pPic->iLinesize,
+                                pCtx->sExpandPicFunc.pfExpandLumaPicture, pCtx->sExpandPicFunc.pfExpandChromaPicture);
+    }
+    pTask->ReleasePictures();
+    SetReadyRows (pTask->m_pPic, (pTask->m_pPic->iHeightInPixel >> 4) + 1, true);
+    OnTaskDone (pTask);
+    return;
+  }
+
+  pTask->PrepareContext (pCtx);
+  // with slice threading the picture is reconstructed before the next one is parsed, by the calling thread helped
+  // by the slice tasks
+  if (m_bSliceThreading || WELS_THREAD_ERROR_OK != m_pThreadPool->QueueTask (pTask)) {
+    pTask->Execute();
+    pTask->OnTaskExecuted();
+  }
+}
+
+void CWelsDecTaskManage::WaitForTasks() {
+  for (int32_t i = 0; i < m_iPendingNum; ++ i) {
+    WaitTask (m_pPending[i]);
+    m_pPending[i]->ReleasePictures();
+  }
+}
+
+void CWelsDecTaskManage::DetachPictures() {
+  if (NULL != m_pCurTask) {
+    ReleaseTask (m_pCurTask);
+    m_pCurTask = NULL;
+  }
+  WaitForTasks();
+  for (int32_t i = 0; i < m_iPendingNum; ++ i) {
+    CWelsDecFrameTask* pTask = m_pPending[i];
+    if (pTask->m_bOutput && NULL != pTask->m_pPic && ERR_NONE != SaveOutput (pTask)) {
+      pTask->m_bOutput = false;
+    }
+    ReleaseTask (pTask);
+  }
+}
+
+bool CWelsDecTaskManage::GetOutput (uint8_t** ppDst, SBufferInfo* pDstInfo, const bool kbFlush) {
+  const int32_t kiDelay = m_bSliceThreading ? 0 : m_iThreadNum;
+  while (m_iPendingNum > 0 && (kbFlush || m_iPendingNum > kiDelay)) {
+    CWelsDecFrameTask* pTask = m_pPending[0];
+    WaitTask (pTask);
+    const bool kbOutput = pTask->m_bOutput;
+    if (kbOutput) {
+      unsigned long long uiInBsTimeStamp = pDstInfo->uiInBsTimeStamp;
+      ppDst[0] = pTask->m_pDst[0];
+      ppDst[1] = pTask->m_pDst[1];
+      ppDst[2] = pTask->m_pDst[2];
+      memcpy (pDstInfo, &pTask->m_sDstInfo, sizeof (SBufferInfo)); //confirmed_safe_unsafe_usage
+      pDstInfo->uiInBsTimeStamp = uiInBsTimeStamp;
+    }
+    PopTask();
+    if (kbOutput) {
+      return true;
+    }
+  }
+  return false;
+}
+
+int32_t CWelsDecTaskManage::GetPendingNum() {
+  return m_iPendingNum;
+}
+
+void CWelsDecTaskManage::WaitTask (CWelsDecFrameTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  while (!pTask->m_bDone) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  WelsMutexUnlock (&m_hMutex);
+}
+
+void CWelsDecTaskManage::PopTask() {
+  CWelsDecFrameTask* pTask = m_pPending[0];
+  -- m_iPendingNum;
+  for (int32_t i = 0; i < m_iPendingNum; ++ i) {
+    m_pPending[i] = m_pPending[i + 1];
+  }
+  m_pPending[m_iPendingNum] = NULL;
+  ReleaseTask (pTask);
+}
+
+void CWelsDecTaskManage::ReleaseTask (CWelsDecFrameTask* pTask) {
+  pTask->ReleasePictures();
+  pTask->m_iSliceNum = 0;
+  if (NULL != pTask->m_pPic) {
+    if (ERR_NONE != pTask->m_iErrorCode) {
+      pTask->m_pPic->bIsComplete = false;
+    }
+    WelsMutexLock (&m_hMutex);
+    pTask->m_pPic->bRecInProgress = false;
+    WelsMutexUnlock (&m_hMutex);
+    -- pTask->m_pPic->uiRefCount;
+    pTask->m_pPic = NULL;
+  }
+}
+
+int32_t CWelsDecTaskManage::SaveOutput (CWelsDecFrameTask* pTask) {
+  CMemoryAlign* pMa = m_pCtx->pMemAlign;
+  SSysMEMBuffer* pSysBuf = &pTask->m_sDstInfo.UsrData.sSystemBuffer;
+  const int32_t kiWidth = pSysBuf->iWidth;
+  const int32_t kiHeight = pSysBuf->iHeight;
+  const int32_t kiLumaSize = kiWidth * kiHeight;
+  const int32_t kiSize = kiLumaSize + (kiLumaSize >> 1);
+
+  if (kiSize > pTask->m_iOutBufferSize) {
+    if (NULL != pTask->m_pOutBuffer) {
+      pMa->WelsFree (pTask->m_pOutBuffer, "CWelsDecFrameTask::m_pOutBuffer");
+    }
+    pTask->m_pOutBuffer = (uint8_t*)pMa->WelsMallocz (kiSize, "CWelsDecFrameTask::m_pOutBuffer");
+    pTask->m_iOutBufferSize = (NULL == pTask->m_pOutBuffer) ? 0 : kiSize;
+    WELS_VERIFY_RETURN_IF (ERR_INFO_OUT_OF_MEMORY, NULL == pTask->m_pOutBuffer)
+  }
+
+  uint8_t* pDst[3] = {pTask->m_pOutBuffer, pTask->m_pOutBuffer + kiLumaSize,
+                      pTask->m_pOutBuffer + kiLumaSize + (kiLumaSize >> 2)
+                     };
+  for (int32_t iPlane = 0; iPlane < 3; ++ iPlane) {
+    const int32_t kiShift = iPlane ? 1 : 0;
+    const int32_t kiSrcStride = pSysBuf->iStride[kiShift];
+    const int32_t kiPlaneWidth = kiWidth >> kiShift;
+    const int32_t kiPlaneHeight = kiHeight >> kiShift;
+    for (int32_t i = 0; i < kiPlaneHeight; ++ i) {
+      memcpy (pDst[iPlane] + i * kiPlaneWidth, pTask->m_pDst[iPlane] + i * kiSrcStride, kiPlaneWidth); //confirmed_safe_unsafe_usage
+    }
+    pTask->m_pDst[iPlane] = pDst[iPlane];
+  }
+  pSysBuf->iStride[0] = kiWidth;
+  pSysBuf->iStride[1] = kiWidth >> 1;
+  return ERR_NONE;
+}
+
+void CWelsDecTaskManage::SetReadyRows (PPicture pPic, const int32_t kiMbRows, const bool kbComplete) {
+  WelsMutexLock (&m_hMutex);
+  pPic->iReadyMbRows = kiMbRows;
+  if (kbComplete) {
+    pPic->bRecInProgress = false;
+  }
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+int32_t CWelsDecTaskManage::WaitReadyRows (PPicture pPic, const int32_t kiMbRows) {
+  int32_t iReadyRows;
+  WelsMutexLock (&m_hMutex);
+  while (pPic->bRecInProgress && pPic->iReadyMbRows < kiMbRows) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  iReadyRows = pPic->bRecInProgress ? pPic->iReadyMbRows : 0x7fffffff;
+  WelsMutexUnlock (&m_hMutex);
+  return iReadyRows;
+}
+
+void CWelsDecTaskManage::OnTaskDone (CWelsDecFrameTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  pTask->m_bDone = true;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+int32_t CWelsDecTaskManage::StartSliceTasks (CWelsDecFrameTask* pFrameTask, const int32_t kiMaxNum) {
+  int32_t iNum = 0;
+  for (int32_t i = 0; i < m_iSliceTaskNum && iNum < kiMaxNum; ++ i) {
+    CWelsDecSliceTask* pTask = m_pSliceTasks[i];
+    bool bIdle;
+
+    WelsMutexLock (&m_hMutex);
+    bIdle = !pTask->m_bBusy;
+    if (bIdle) {
+      pTask->m_bBusy      = true;
+      pTask->m_bRunning   = false;
+      pTask->m_pFrameTask = pFrameTask;
+    }
+    WelsMutexUnlock (&m_hMutex);
+    if (!bIdle) {
+      continue;
+    }
+
+    // copied before queued, the context of the frame task is modified as soon as it starts reconstructing
+    memcpy (pTask->m_pCtx, pFrameTask->m_pCtx, sizeof (SWelsDecoderContext)); //confirmed_safe_unsafe_usage
+    if (WELS_THREAD_ERROR_OK != m_pThreadPool->QueueTask (pTask)) {
+      WelsMutexLock (&m_hMutex);
+      pTask->m_bBusy      = false;
+      pTask->m_pFrameTask = NULL;
+      WelsMutexUnlock (&m_hMutex);
+      break;
+    }
+    ++ iNum;
+  }
+  return iNum;
+}
+
+void CWelsDecTaskManage::StopSliceTasks (CWelsDecFrameTask* pFrameTask) {
+  WelsMutexLock (&m_hMutex);
+  for (int32_t i = 0; i < m_iSliceTaskNum; ++ i) {
+    CWelsDecSliceTask* pTask = m_pSliceTasks[i];
+    if (pTask->m_pFrameTask == pFrameTask) {
+      if (!pTask->m_bRunning) {
+        pTask->m_pFrameTask = NULL;
+      }
+      while (pTask->m_pFrameTask == pFrameTask) {
+        WelsCondWait (&m_hCond, &m_hMutex);
+      }
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+}
+
+CWelsDecFrameTask* CWelsDecTaskManage::BeginSliceTask (CWelsDecSliceTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  CWelsDecFrameTask* pFrameTask = pTask->m_pFrameTask;
+  pTask->m_bRunning = (NULL != pFrameTask);
+  WelsMutexUnlock (&m_hMutex);
+  return pFrameTask;
+}
+
+void CWelsDecTaskManage::OnSliceTaskDone (CWelsDecSliceTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  pTask->m_pFrameTask = NULL;
+  pTask->m_bRunning   = false;
+  pTask->m_bBusy      = false;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+} // namespace WelsDec
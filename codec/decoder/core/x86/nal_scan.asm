@@ -0,0 +1,130 @@
+;*!
+;* \copy
+;*     Copyright (c)  2016, Cisco Systems
+;*     All rights reserved.
+;*
+;*     Redistribution and use in source and binary forms, with or without
+;*     modification, are permitted provided that the following conditions
+;*     are met:
+;*
+;*        ?Redistributions of source code must retain the above copyright
+;*          notice, this list of conditions and the following disclaimer.
+;*
+;*        ?Redistributions in binary form must reproduce the above copyright
+;*          notice, this list of conditions and the following disclaimer in
+;*          the documentation and/or other materials provided with the
+;*          distribution.
+;*
+;*     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+;*     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+;*     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+;*     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+;*     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+;*     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+;*     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+;*     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+;*     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+;*     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+;*     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+;*     POSSIBILITY OF SUCH DAMAGE.
+;*
+;*
+;*  nal_scan.asm
+;*
+;*  Abstract
+;*      scan of the input bitstream for start code / emulation prevention candidates
+;*
+;*  History
+;*      10/18/2026 Created
+;*
+;*
+;*************************************************************************/
+
+%include "asm_inc.asm"
+
+SECTION .text
+
+;***********************************************************************
+;int32_t WelsScanZeroPair_sse2 (const uint8_t* kpSrc, int32_t iSrcLen);
+;   returns the offset of the first 0x00 0x00 pair within the whole 16 byte
+;   blocks of the first iSrcLen - 1 bytes, the size of these blocks if none
+;***********************************************************************
+WELS_EXTERN WelsScanZeroPair_sse2
+%ifdef X86_32
+    push    r3
+    %assign push_num 1
+%else
+    %assign push_num 0
+%endif
+    LOAD_2_PARA
+    SIGN_EXTENSION r1, r1d
+    xor     r2, r2
+    dec     r1
+    and     r1, -16
+    jle     .exit
+    pxor    xmm0, xmm0
+.loop:
+    movdqu  xmm1, [r0 + r2]
+    movdqu  xmm2, [r0 + r2 + 1]
+    pcmpeqb xmm1, xmm0
+    pcmpeqb xmm2, xmm0
+    pand    xmm1, xmm2
+    pmovmskb r3d, xmm1
+    test    r3d, r3d
+    jnz     .found
+    add     r2, 16
+    cmp     r2, r1
+    jl      .loop
+    jmp     .exit
+.found:
+    bsf     r3d, r3d
+    add     r2, r3
+.exit:
+    mov     retrd, r2d
+%ifdef X86_32
+    pop     r3
+%endif
+    ret
+
+%ifdef HAVE_AVX2
+;***********************************************************************
+;int32_t WelsScanZeroPair_avx2 (const uint8_t* kpSrc, int32_t iSrcLen);
+;   as WelsScanZeroPair_sse2 over whole 32 byte blocks
+;***********************************************************************
+WELS_EXTERN WelsScanZeroPair_avx2
+%ifdef X86_32
+    push    r3
+    %assign push_num 1
+%else
+    %assign push_num 0
+%endif
+    LOAD_2_PARA
+    SIGN_EXTENSION r1, r1d
+    xor     r2, r2
+    dec     r1
+    and     r1, -32
+    jle     .exit
+    vpxor   ymm0, ymm0, ymm0
+.loop:
+    vpcmpeqb ymm1, ymm0, [r0 + r2]
+    vpcmpeqb ymm2, ymm0, [r0 + r2 + 1]
+    vpand   ymm1, ymm1, ymm2
+    vpmovmskb r3d, ymm1
+    test    r3d, r3d
+    jnz     .found
+    add     r2, 32
+    cmp     r2, r1
+    jl      .loop
+    jmp     .done
+.found:
+    bsf     r3d, r3d
+    add     r2, r3
+.done:
+    vzeroupper
+.exit:
+    mov     retrd, r2d
+%ifdef X86_32
+    pop     r3
+%endif
+    ret
+%endif
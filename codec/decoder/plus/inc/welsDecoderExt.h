@@ -108,10 +108,18 @@ virtual long EXTAPI GetOption (DECODER_OPTION eOptID, void* pOption);
  private:
 PWelsDecoderContext     m_pDecContext;
 welsCodecTrace*         m_pWelsTrace;
+int32_t                 m_iThreadCount;
+bool                    m_bSliceThreading;
+SDecPictureAllocator    m_sPicAllocator;
+SThreadPoolParam        m_sThreadPoolParam;
+bool                    m_bThreadPoolParam;
+SMemoryArenaParam       m_sMemoryArena;
 
 int32_t InitDecoder (const SDecodingParam* pParam);
 void UninitDecoder (void);
 int32_t ResetDecoder();
+DECODING_STATE DecodeFrameInternal (const unsigned char* kpSrc, const int kiSrcLen, unsigned char** ppDst,
+                                    SBufferInfo* pDstInfo);
 
 void OutputStatisticsLog (SDecoderStatistics& sDecoderStatistics);
 
@@ -58,6 +58,7 @@ extern "C" {
 #include "decoder_core.h"
 #include "manage_dec_ref.h"
 }
+#include "wels_decoder_thread.h"
 #include "error_code.h"
 #include "crt_util_safe_x.h" // Safe CRT routines like util for cross platforms
 #include <time.h>
@@ -88,7 +89,9 @@ namespace WelsDec {
 ***************************************************************************/
 CWelsDecoder::CWelsDecoder (void)
   : m_pDecContext (NULL),
-    m_pWelsTrace (NULL) {
+    m_pWelsTrace (NULL),
+    m_iThreadCount (0),
+    m_bSliceThreading (false) {
 #ifdef OUTPUT_BIT_STREAM
   char chFileName[1024] = { 0 };  //for .264
   int iBufUsed = 0;
@@ -101,6 +104,11 @@ CWelsDecoder::CWelsDecoder (void)
   int iCurUsedSize;
 #endif//OUTPUT_BIT_STREAM
 
+  memset (&m_sPicAllocator, 0, sizeof (m_sPicAllocator));
+  memset (&m_sThreadPoolParam, 0, sizeof (m_sThreadPoolParam));
+  m_sThreadPoolParam.iNumaNode = -1;
+  m_bThreadPoolParam = false;
+  memset (&m_sMemoryArena, 0, sizeof (m_sMemoryArena));
 
   m_pWelsTrace = new welsCodecTrace();
   if (m_pWelsTrace != NULL) {
@@ -250,11 +258,16 @@ int32_t CWelsDecoder::InitDecoder (const SDecodingParam* pParam) {
   if (NULL == m_pDecContext)
     return cmMallocMemeError;
   int32_t iCacheLineSize = 16;   // on chip cache line size in byte
-  m_pDecContext->pMemAlign = new CMemoryAlign (iCacheLineSize);
+  m_pDecContext->pMemAlign = new CMemoryAlign (iCacheLineSize, m_sMemoryArena.uiRegionSize, m_sMemoryArena.bHugePages);
   WELS_VERIFY_RETURN_PROC_IF (cmMallocMemeError, (NULL == m_pDecContext->pMemAlign), UninitDecoder())
 
   //fill in default value into context
   WelsDecoderDefaults (m_pDecContext, &m_pWelsTrace->m_sLogCtx);
+  m_pDecContext->iThreadCount = m_iThreadCount;
+  m_pDecContext->bSliceThreading = m_bSliceThreading;
+  m_pDecContext->sPicAllocator = m_sPicAllocator;
+  m_pDecContext->sThreadPoolParam = m_sThreadPoolParam;
+  m_pDecContext->bThreadPoolParam = m_bThreadPoolParam;
 
   //check param and update decoder context
   m_pDecContext->pParam = (SDecodingParam*) m_pDecContext->pMemAlign->WelsMallocz (sizeof (SDecodingParam),
@@ -292,8 +305,79 @@ long CWelsDecoder::SetOption (DECODER_OPTION eOptID, void* pOption) {
   int iVal = 0;
 
   if (m_pDecContext == NULL && eOptID != DECODER_OPTION_TRACE_LEVEL &&
-      eOptID != DECODER_OPTION_TRACE_CALLBACK && eOptID != DECODER_OPTION_TRACE_CALLBACK_CONTEXT)
+      eOptID != DECODER_OPTION_TRACE_CALLBACK && eOptID != DECODER_OPTION_TRACE_CALLBACK_CONTEXT
+      && eOptID != DECODER_OPTION_NUM_OF_THREADS && eOptID != DECODER_OPTION_PICTURE_ALLOCATOR
+      && eOptID != DECODER_OPTION_THREAD_POOL && eOptID != DECODER_OPTION_MEMORY_ARENA
+      && eOptID != DECODER_OPTION_SLICE_THREADING)
     return dsInitialOptExpected;
+  if (eOptID == DECODER_OPTION_NUM_OF_THREADS) {
+    if (pOption == NULL)
+      return cmInitParaError;
+    if (m_pDecContext != NULL) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsDecoder::SetOption():DECODER_OPTION_NUM_OF_THREADS: should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    iVal = * ((int*)pOption);
+    m_iThreadCount = WELS_CLIP3 (iVal, 1, MAX_THREADS_NUM);
+    return cmResultSuccess;
+  }
+  if (eOptID == DECODER_OPTION_SLICE_THREADING) {
+    if (pOption == NULL)
+      return cmInitParaError;
+    if (m_pDecContext != NULL) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsDecoder::SetOption():DECODER_OPTION_SLICE_THREADING: should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    iVal = * ((int*)pOption);
+    m_bSliceThreading = iVal ? true : false;
+    return cmResultSuccess;
+  }
+  if (eOptID == DECODER_OPTION_PICTURE_ALLOCATOR) {
+    if (m_pDecContext != NULL) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsDecoder::SetOption():DECODER_OPTION_PICTURE_ALLOCATOR: should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    if (pOption == NULL) {
+      memset (&m_sPicAllocator, 0, sizeof (m_sPicAllocator));
+      return cmResultSuccess;
+    }
+    const SDecPictureAllocator* pAllocator = static_cast<const SDecPictureAllocator*> (pOption);
+    if (pAllocator->pfGetBuffer == NULL || pAllocator->pfReleaseBuffer == NULL)
+      return cmInitParaError;
+    m_sPicAllocator = *pAllocator;
+    return cmResultSuccess;
+  }
+  if (eOptID == DECODER_OPTION_THREAD_POOL) {
+    if (m_pDecContext != NULL) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsDecoder::SetOption():DECODER_OPTION_THREAD_POOL: should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    if (pOption == NULL) {
+      m_bThreadPoolParam = false;
+      return cmResultSuccess;
+    }
+    const SThreadPoolParam* pPoolParam = static_cast<const SThreadPoolParam*> (pOption);
+    if (pPoolParam->iThreadNum < 0 || pPoolParam->iThreadNum > MAX_THREADS_NUM)
+      return cmInitParaError;
+    m_sThreadPoolParam = *pPoolParam;
+    m_bThreadPoolParam = true;
+    return cmResultSuccess;
+  }
+  if (eOptID == DECODER_OPTION_MEMORY_ARENA) {
+    if (m_pDecContext != NULL) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsDecoder::SetOption():DECODER_OPTION_MEMORY_ARENA: should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    if (pOption == NULL)
+      return cmInitParaError;
+    m_sMemoryArena = * (static_cast<const SMemoryArenaParam*> (pOption));
+    return cmResultSuccess;
+  }
   if (eOptID == DECODER_OPTION_END_OF_STREAM) { // Indicate bit-stream of the final frame to be decoded
     if (pOption == NULL)
       return cmInitParaError;
@@ -365,6 +449,12 @@ long CWelsDecoder::SetOption (DECODER_OPTION eOptID, void* pOption) {
 long CWelsDecoder::GetOption (DECODER_OPTION eOptID, void* pOption) {
   int iVal = 0;
 
+  // the defaults before set, so also before the initialization
+  if (DECODER_OPTION_THREAD_POOL == eOptID && pOption != NULL) {
+    * ((SThreadPoolParam*)pOption) = m_sThreadPoolParam;
+    return cmResultSuccess;
+  }
+
   if (m_pDecContext == NULL)
     return cmInitExpected;
 
@@ -437,6 +527,18 @@ long CWelsDecoder::GetOption (DECODER_OPTION eOptID, void* pOption) {
       pVuiSarInfo->bOverscanAppropriateFlag = m_pDecContext->pSps->sVui.bOverscanAppropriateFlag;
       return cmResultSuccess;
     }
+  } else if (DECODER_OPTION_NUM_OF_THREADS == eOptID) {
+    iVal = (NULL != m_pDecContext->pTaskManage) ? m_pDecContext->pTaskManage->GetThreadNum() : 1;
+    * ((int*)pOption) = iVal;
+    return cmResultSuccess;
+  } else if (DECODER_OPTION_SLICE_THREADING == eOptID) {
+    iVal = (NULL != m_pDecContext->pTaskManage) && m_pDecContext->pTaskManage->IsSliceThreading();
+    * ((int*)pOption) = iVal;
+    return cmResultSuccess;
+  } else if (DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER == eOptID) {
+    iVal = (NULL != m_pDecContext->pTaskManage) ? m_pDecContext->pTaskManage->GetPendingNum() : 0;
+    * ((int*)pOption) = iVal;
+    return cmResultSuccess;
   } else if (DECODER_OPTION_PROFILE == eOptID) {
     if (!m_pDecContext->pSps) {
       return cmInitExpected;
@@ -451,6 +553,25 @@ long CWelsDecoder::GetOption (DECODER_OPTION eOptID, void* pOption) {
     iVal = (int) m_pDecContext->pSps->uiLevelIdc;
     * ((int*)pOption) = iVal;
     return cmResultSuccess;
+  } else if (DECODER_OPTION_GET_STAGE_TIMING == eOptID) {
+#ifdef WELS_STAGE_TIMING
+    SDecoderStageTiming* pStageTiming = static_cast<SDecoderStageTiming*> (pOption);
+    const int64_t* kpStageTime = m_pDecContext->iStageTime;
+    pStageTiming->uiNalParseUs = kpStageTime[DEC_STAGE_NAL_PARSE];
+    pStageTiming->uiEntropyDecodeUs = kpStageTime[DEC_STAGE_ENTROPY_DECODE];
+    // the MC and the deblocking along with the reconstruction are timed within the reconstruction of the slices
+    pStageTiming->uiReconstructionUs = WELS_MAX (kpStageTime[DEC_STAGE_RECONSTRUCTION] - kpStageTime[DEC_STAGE_MC]
+                                       - kpStageTime[DEC_STAGE_DEBLOCKING], 0);
+    pStageTiming->uiMcUs = kpStageTime[DEC_STAGE_MC];
+    pStageTiming->uiDeblockingUs = kpStageTime[DEC_STAGE_DEBLOCKING];
+    pStageTiming->uiErrorConcealmentUs = kpStageTime[DEC_STAGE_ERROR_CONCEALMENT];
+    return cmResultSuccess;
+#else
+    return cmUnsupportedData;
+#endif
+  } else if (DECODER_OPTION_MEMORY_USAGE == eOptID) {
+    m_pDecContext->pMemAlign->WelsGetTagUsage (static_cast<SMemoryUsage*> (pOption));
+    return cmResultSuccess;
   }
 
   return cmInitParaError;
@@ -464,12 +585,17 @@ DECODING_STATE CWelsDecoder::DecodeFrameNoDelay (const unsigned char* kpSrc,
   //SBufferInfo sTmpBufferInfo;
   //unsigned char* ppTmpDst[3] = {NULL, NULL, NULL};
 
-  iRet = (int) DecodeFrame2 (kpSrc, kiSrcLen, ppDst, pDstInfo);
+  iRet = (int) DecodeFrameInternal (kpSrc, kiSrcLen, ppDst, pDstInfo);
   //memcpy (&sTmpBufferInfo, pDstInfo, sizeof (SBufferInfo));
   //ppTmpDst[0] = ppDst[0];
   //ppTmpDst[1] = ppDst[1];
   //ppTmpDst[2] = ppDst[2];
-  iRet |= DecodeFrame2 (NULL, 0, ppDst, pDstInfo);
+  iRet |= DecodeFrameInternal (NULL, 0, ppDst, pDstInfo);
+  if ((m_pDecContext != NULL) && (m_pDecContext->pTaskManage != NULL)) { // the picture is waited for, no delay
+    ppDst[0] = ppDst[1] = ppDst[2] = NULL;
+    pDstInfo->iBufferStatus = 0;
+    m_pDecContext->pTaskManage->GetOutput (ppDst, pDstInfo, true);
+  }
   //if ((pDstInfo->iBufferStatus == 0) && (sTmpBufferInfo.iBufferStatus == 1)) {
   //memcpy (pDstInfo, &sTmpBufferInfo, sizeof (SBufferInfo));
   //ppDst[0] = ppTmpDst[0];
@@ -484,6 +610,23 @@ DECODING_STATE CWelsDecoder::DecodeFrame2 (const unsigned char* kpSrc,
     const int kiSrcLen,
     unsigned char** ppDst,
     SBufferInfo* pDstInfo) {
+  DECODING_STATE eRet = DecodeFrameInternal (kpSrc, kiSrcLen, ppDst, pDstInfo);
+
+  // frame level multi-threading: pictures are output in decoding order once the reconstruction finished, with
+  // a delay of thread number frames; all of them are flushed one by one at the end of stream. Slice threading
+  // outputs each picture as soon as it is decoded
+  if ((m_pDecContext != NULL) && (m_pDecContext->pTaskManage != NULL)) {
+    ppDst[0] = ppDst[1] = ppDst[2] = NULL;
+    pDstInfo->iBufferStatus = 0;
+    m_pDecContext->pTaskManage->GetOutput (ppDst, pDstInfo, (kiSrcLen <= 0) || (kpSrc == NULL));
+  }
+  return eRet;
+}
+
+DECODING_STATE CWelsDecoder::DecodeFrameInternal (const unsigned char* kpSrc,
+    const int kiSrcLen,
+    unsigned char** ppDst,
+    SBufferInfo* pDstInfo) {
   if (m_pDecContext == NULL || m_pDecContext->pParam == NULL) {
     if (m_pWelsTrace != NULL) {
       WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR, "Call DecodeFrame2 without Initialize.\n");
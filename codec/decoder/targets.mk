@@ -19,6 +19,7 @@ DECODER_CPP_SRCS=\
 	$(DECODER_SRCDIR)/core/src/parse_mb_syn_cavlc.cpp\
 	$(DECODER_SRCDIR)/core/src/pic_queue.cpp\
 	$(DECODER_SRCDIR)/core/src/rec_mb.cpp\
+	$(DECODER_SRCDIR)/core/src/wels_decoder_thread.cpp\
 	$(DECODER_SRCDIR)/plus/src/welsDecoderExt.cpp\
 
 DECODER_OBJS += $(DECODER_CPP_SRCS:.cpp=.$(OBJ))
@@ -26,6 +27,7 @@ DECODER_OBJS += $(DECODER_CPP_SRCS:.cpp=.$(OBJ))
 DECODER_ASM_SRCS=\
 	$(DECODER_SRCDIR)/core/x86/dct.asm\
 	$(DECODER_SRCDIR)/core/x86/intra_pred.asm\
+	$(DECODER_SRCDIR)/core/x86/nal_scan.asm\
 
 DECODER_OBJSASM += $(DECODER_ASM_SRCS:.asm=.$(OBJ))
 ifeq ($(ASM_ARCH), x86)
@@ -46,6 +48,7 @@ OBJS += $(DECODER_OBJSARM)
 DECODER_ASM_ARM64_SRCS=\
 	$(DECODER_SRCDIR)/core/arm64/block_add_aarch64_neon.S\
 	$(DECODER_SRCDIR)/core/arm64/intra_pred_aarch64_neon.S\
+	$(DECODER_SRCDIR)/core/arm64/nal_scan_aarch64_neon.S\
 
 DECODER_OBJSARM64 += $(DECODER_ASM_ARM64_SRCS:.S=.$(OBJ))
 ifeq ($(ASM_ARCH), arm64)
@@ -0,0 +1,103 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    buffer_pool.h
+ *
+ * \brief   pool of the large encoder buffers (pictures, bitstream buffers), kept across the reinitializations of the
+ *          encoder so that a resolution switch reuses the buffers of the previous settings instead of reallocating
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELS_BUFFER_POOL_H__
+#define WELS_BUFFER_POOL_H__
+
+#include "typedefs.h"
+#include "macros.h"
+#include "memory_align.h"
+#include "utils.h"
+
+using namespace WelsCommon;
+
+namespace WelsEnc {
+
+/*
+ *  CWelsBufferPool: buffers released are kept idle and handed out again for requests of a compatible size, till
+ *  Trim() frees them. Like CMemoryAlign, it is used by one encoder context at a time.
+ */
+class CWelsBufferPool {
+ public:
+  CWelsBufferPool (SLogContext* pLogCtx = NULL);
+  virtual ~CWelsBufferPool();
+
+  void*    Acquire (const uint32_t kuiSize, const char* kpTag);
+  void*    Acquirez (const uint32_t kuiSize, const char* kpTag);
+  // false if pBuffer was not acquired from the pool, it is left to the caller to free then
+  bool     Release (void* pBuffer, const char* kpTag);
+  // free the idle buffers, called once the encoder is initialized so that only the buffers of its settings are kept
+  void     Trim();
+
+  uint32_t GetMemoryUsage() const;
+  uint32_t GetIdleNum() const;
+  uint32_t GetReusedNum() const {
+    return m_uiReusedNum;
+  }
+
+ private:
+  typedef struct TagBufferEntry {
+    void*       pBuffer;
+    uint32_t    uiSize;
+    bool        bInUse;
+  } SBufferEntry;
+
+  bool     ExpandEntries();
+
+  CMemoryAlign*         m_pMa;
+  SLogContext*          m_pLogCtx;
+  SBufferEntry*         m_pEntries;
+  int32_t               m_iEntryNum;
+  int32_t               m_iEntryCapacity;
+  uint32_t              m_uiReusedNum;      // requests served by an idle buffer
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsBufferPool);
+};
+
+// buffer from pPool if any, otherwise from pMa; freed by WelsPoolFree() with the same pPool and pMa, a buffer
+// unknown to pPool is freed through pMa
+void* WelsPoolMalloc (CWelsBufferPool* pPool, CMemoryAlign* pMa, const uint32_t kuiSize, const char* kpTag);
+void* WelsPoolMallocz (CWelsBufferPool* pPool, CMemoryAlign* pMa, const uint32_t kuiSize, const char* kpTag);
+void  WelsPoolFree (CWelsBufferPool* pPool, CMemoryAlign* pMa, void* pBuffer, const char* kpTag);
+
+} // namespace WelsEnc
+
+#endif//WELS_BUFFER_POOL_H__
@@ -55,6 +55,7 @@
 #include "wels_func_ptr_def.h"
 #include "crt_util_safe_x.h"
 #include "utils.h"
+#include "buffer_pool.h"
 
 #include "mt_defs.h" // for multiple threadin,
 #include "WelsThreadLib.h"
@@ -64,6 +65,7 @@ namespace WelsEnc {
 
 class IWelsTaskManage;
 class IWelsReferenceStrategy;
+class CWelsWavefrontEncoder;
 
 /*
  *  reference list for each quality layer in SVC
@@ -139,6 +141,7 @@ typedef struct TagWelsEncCtx {
   SSliceThreading*  pSliceThreading;
   IWelsTaskManage*  pTaskManage; //was planning to put it under CWelsH264SVCEncoder but it may be updated (lock/no lock) when param is changed
   IWelsReferenceStrategy* pReferenceStrategy;
+  CWelsWavefrontEncoder*  pWavefront;     // MB rows of single slice layers coded in wavefront order when not NULL
 
   // pointers
   SPicture*         pEncPic;                // pointer to current picture to be encoded
@@ -166,6 +169,7 @@ typedef struct TagWelsEncCtx {
 
 // Rate control routine
   SWelsSvcRc*       pWelsSvcRc;
+  STwoPassRc*       pTwoPassRc;     // NULL unless two-pass rate control is enabled
   bool              bCheckWindowStatusRefreshFlag;
   int64_t           iCheckWindowStartTs;
   int64_t           iCheckWindowCurrentTs;
@@ -173,6 +177,9 @@ typedef struct TagWelsEncCtx {
   int32_t           iCheckWindowIntervalShift;
   bool              bCheckWindowShiftResetFlag;
   int32_t           iGlobalQp;      // global qp
+  int64_t           iLookaheadCost[MAX_LOOKAHEAD_DEPTH + 1]; // costs of the frame to be coded and of the frames after it
+  int32_t           iLookaheadNum;  // number of costs valid, 0 without lookahead
+  const SPreparedSource* pPreparedSource; // pictures and VAA of the next frame prepared ahead of the coding, or NULL
 
 // VAA
   SVAAFrameInfo*    pVaa;           // VAA information of reference
@@ -213,6 +220,7 @@ typedef struct TagWelsEncCtx {
   SParaSetOffset    sPSOVector;
   SParaSetOffset*   pPSOVector;
   CMemoryAlign*     pMemAlign;
+  CWelsBufferPool*  pBufferPool;  // large buffers, owned by the caller and kept across the reinitializations
 
 #if defined(STAT_OUTPUT)
 // overall stat pData, refer to SStatData in stat.h, in case avc to use stat[0][0]
@@ -73,10 +73,13 @@ void GomValidCheck (const int32_t kiMbWidth, const int32_t kiMbHeight, int32_t*
  * \brief   initialize Wels avc encoder core library
  * \param   ppCtx       sWelsEncCtx**
  * \param   para        SWelsSvcCodingParam*
+ * \param   pBufferPool pool of the large buffers kept by the caller across reinitializations, NULL if none
+ * \param   pTwoPassRc  two-pass rate control state taken over from the context reset, NULL to start it
  * \return  successful - 0; otherwise none 0 for failed
  */
 int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pPara, SLogContext* pLogCtx,
-                            SExistingParasetList* pExistingParasetList);
+                            SExistingParasetList* pExistingParasetList, CWelsBufferPool* pBufferPool,
+                            STwoPassRc* pTwoPassRc);
 
 /*!
  * \brief   uninitialize Wels encoder core library
@@ -97,6 +100,23 @@ int32_t WelsEncoderEncodeExt (sWelsEncCtx*, SFrameBSInfo* pFbi, const SSourcePic
 
 int32_t WelsEncoderEncodeParameterSets (sWelsEncCtx* pCtx, void* pDst);
 
+/*!
+ * \brief   set the lookahead costs used by the rate control of the next frame
+ *
+ * \param   pCtx        sWelsEncCtx*, encoder context
+ * \param   kpCost      costs of the next frame and of the frames following it, in coding order
+ * \param   kiNum       number of costs, 0 to disable
+ */
+void WelsEncoderSetLookahead (sWelsEncCtx* pCtx, const int64_t* kpCost, const int32_t kiNum);
+
+/*!
+ * \brief   set the source of the next frame as prepared by CWelsPreProcessAhead
+ *
+ * \param   pCtx        sWelsEncCtx*, encoder context
+ * \param   kpPrepared  prepared source of the next frame, NULL to preprocess the source picture in the coding
+ */
+void WelsEncoderSetPreparedSource (sWelsEncCtx* pCtx, const SPreparedSource* kpPrepared);
+
 /*
  * Force coding IDR as follows
  */
@@ -119,6 +119,14 @@ typedef struct TagWelsSvcCodingParam: SEncParamExt {
 
   bool      bDeblockingParallelFlag;        // deblocking filter parallelization control flag
   int32_t   iBitsVaryPercentage;
+  const SThreadPoolParam* pThreadPoolParam; // thread pool of the encoding tasks, the global pool used when NULL
+  int32_t   iWavefrontThreadNum;            // threads deciding the MB rows of single slice layers, 0 when disabled
+  int32_t   iTwoPass;                       // 0: single pass, 1: first pass, 2: second pass of the rate control
+  char      sTwoPassStatsFile[MAX_FNAME_LEN]; // statistics file of the two-pass rate control
+  bool      bHierarchicalMe;                // motion search seeded by the search on the downsampled pictures
+  SMemoryArenaParam sMemoryArena;           // arena mode of the memory allocator, disabled when uiRegionSize is 0
+  int32_t   iParasetIdBase;                 // SPS/PPS ids in the bitstream are iParasetIdBase modulo iParasetIdStep,
+  int32_t   iParasetIdStep;                 // so that the simulcast layer encoders of a stream use ids of their own
 
   int8_t   iDecompStages;          // GOP size dependency
   int32_t  iMaxNumRefFrame;
@@ -226,6 +234,14 @@ typedef struct TagWelsSvcCodingParam: SEncParamExt {
 
     iDecompStages               = 0;    // GOP size dependency, unknown here and be revised later
     iBitsVaryPercentage = 10;
+    pThreadPoolParam            = NULL;
+    iWavefrontThreadNum         = 0;
+    iTwoPass                    = 0;
+    sTwoPassStatsFile[0]        = '\0';
+    bHierarchicalMe             = false;
+    memset (&sMemoryArena, 0, sizeof (sMemoryArena));
+    iParasetIdBase              = 0;
+    iParasetIdStep              = 1;
   }
 
   int32_t ParamBaseTranscode (const SEncParamBase& pCodingParam) {
@@ -90,6 +90,9 @@ class IWelsParametersetStrategy {
   virtual  void LoadPreviousStructure (SParaSetOffsetVariable* pParaSetOffsetVariable, int32_t* pPpsIdList) = 0;
 
   virtual int32_t GetSpsIdx (const int32_t iIdx) = 0;
+
+  // ids written in the bitstream are kiIdBase modulo kiIdStep, for the encoders sharing a bitstream
+  virtual void SetIdPartition (const int32_t kiIdBase, const int32_t kiIdStep) = 0;
 };
 
 
@@ -148,6 +151,8 @@ class  CWelsParametersetIdConstant : public IWelsParametersetStrategy {
   virtual int32_t GetSpsIdx (const int32_t iIdx) {
     return 0;
   };
+
+  virtual void SetIdPartition (const int32_t kiIdBase, const int32_t kiIdStep);
  protected:
 
   virtual void LoadPreviousSps (SExistingParasetList* pExistingParasetList, SWelsSPS* pSpsArray,
@@ -161,6 +166,9 @@ class  CWelsParametersetIdConstant : public IWelsParametersetStrategy {
 
   uint32_t m_iBasicNeededSpsNum;
   uint32_t m_iBasicNeededPpsNum;
+
+  int32_t m_iIdBase;
+  int32_t m_iIdStep;
 };
 
 /*
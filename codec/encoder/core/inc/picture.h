@@ -57,6 +57,20 @@ bool      bRefBlockFeatureCalculated; // flag of whether pre-process is done
 uint16_t **pFeatureValuePointerList;//uint16_t* pFeatureValuePointerList[WELS_MAX (LIST_SIZE_SUM_16x16, LIST_SIZE_MSE_16x16)]
 } SScreenBlockFeatureStorage; //should be stored with RefPic, one for each frame
 
+class CWelsBufferPool;
+
+#define HME_LEVEL_NUM 1
+/*
+ *  Source picture downsampled by 4 (level 0) for the hierarchical motion search, each further level by 2 again
+ */
+typedef struct TagHmePyramid {
+uint8_t*   pPlane[HME_LEVEL_NUM][3];  // chroma is only required by the downsampling
+int32_t    iStride[HME_LEVEL_NUM][3];
+int32_t    iWidth[HME_LEVEL_NUM];     // luma size, the MBs of the picture cover 4x4 blocks at level 0
+int32_t    iHeight[HME_LEVEL_NUM];
+bool       bValid;                    // built from the source of the picture
+} SHmePyramid; //stored with RefPic, one for each frame
+
 /*
  *  Reconstructed Picture definition
  *  It is used to express reference picture, also consequent reconstruction picture for output
@@ -64,6 +78,7 @@ uint16_t **pFeatureValuePointerList;//uint16_t* pFeatureValuePointerList[WELS_MA
 typedef struct TagPicture {
 /************************************payload pData*********************************/
 uint8_t*    pBuffer;    // pointer to the first allocated byte, basical offset of pBuffer, dimension:
+CWelsBufferPool* pBufferPool; // pool pBuffer is acquired from, NULL if allocated by the CMemoryAlign
 uint8_t*    pData[3];    // pointer to picture planes respectively
 int32_t    iLineSize[3];  // iLineSize of picture planes respectively
 
@@ -100,6 +115,9 @@ int32_t   iFrameAverageQp;
 /*******************************for screen reference frames****************************/
 SScreenBlockFeatureStorage* pScreenBlockFeatureStorage;
 
+/*******************************for hierarchical motion search****************************/
+SHmePyramid* pHmePyramid;
+
   /*
    *    set picture as unreferenced
    */
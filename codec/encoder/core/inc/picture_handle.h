@@ -42,6 +42,7 @@
 #include "picture.h"
 #include "typedefs.h"
 #include "memory_align.h"
+#include "buffer_pool.h"
 
 namespace WelsEnc {
 /*!
@@ -50,10 +51,11 @@ namespace WelsEnc {
  * \param   kiHeight                height of picture in pixels
  * \param   bNeedMbInfo             need pData allocation
  * \pram    iNeedFeatureStorage     need storage for FME
+ * \param   pBufferPool             pool of the pixel buffer, NULL to allocate it by pMa
  * \return  successful if effective picture pointer returned, otherwise failed with NULL
  */
 SPicture* AllocPicture (CMemoryAlign* pMa, const int32_t kiWidth, const int32_t kiHeight, bool bNeedMbInfo,
-                        int32_t iNeedFeatureStorage);
+                        int32_t iNeedFeatureStorage, CWelsBufferPool* pBufferPool);
 
 /*!
  * \brief   free picture pData planes
@@ -62,5 +64,12 @@ SPicture* AllocPicture (CMemoryAlign* pMa, const int32_t kiWidth, const int32_t
  */
 void FreePicture (CMemoryAlign* pMa, SPicture** ppPic);
 
+/*!
+ * \brief   alloc the pyramid of the hierarchical motion search for a picture, released by FreePicture()
+ * \param   pPic    picture allocated by AllocPicture()
+ * \return  0 if successful, otherwise failed
+ */
+int32_t RequestHmePyramid (CMemoryAlign* pMa, SPicture* pPic);
+
 }
 #endif//WELS_ENCODER_PICTURE_HANDLE_H__
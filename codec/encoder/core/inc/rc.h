@@ -47,6 +47,7 @@
 #include "codec_app_def.h"
 #include "svc_enc_macroblock.h"
 #include "slice.h"
+#include "crt_util_safe_x.h"
 
 namespace WelsEnc {
 
@@ -120,6 +121,7 @@ enum {
 //R-Q Model
 #define LINEAR_MODEL_DECAY_FACTOR 80 // *INT_MULTIPLY
 #define FRAME_CMPLX_RATIO_RANGE 20 // *INT_MULTIPLY
+#define LOOKAHEAD_RATIO_RANGE 50 // *INT_MULTIPLY
 #define SMOOTH_FACTOR_MIN_VALUE 2 // *INT_MULTIPLY
 //#define VGOP_BITS_MIN_RATIO 0.8
 //skip and padding
@@ -134,6 +136,11 @@ enum {
 
 #define _BITS_RANGE 0
 
+//two-pass
+#define TWO_PASS_STATS_MAGIC 0x53503257 // "W2PS"
+#define TWO_PASS_QCOMPRESS 0.6 // bits allocated in proportion to complexity^TWO_PASS_QCOMPRESS
+#define TWO_PASS_CORRECTION_RANGE 50 // *INT_MULTIPLY
+
 enum {
   EVEN_TIME_WINDOW  =0,
   ODD_TIME_WINDOW   =1,
@@ -239,6 +246,33 @@ int32_t   iActualBitRate; // TODO: to complete later
 float     fLatestFrameRate; // TODO: to complete later
 } SWelsSvcRc;
 
+// record of the statistics file, one per frame coded by the first pass
+typedef struct TagTwoPassFrameStats {
+int64_t   iTimeStamp;
+int32_t   iFrameBits;
+uint8_t   uiDid;
+uint8_t   uiTid;
+uint8_t   uiSliceType;
+uint8_t   uiQp; // average QP of the frame
+} STwoPassFrameStats;
+
+typedef struct TagTwoPassRc {
+int32_t   iPass;
+WelsFileHandle* pStatsFile; // first pass
+long long uiTimeStamp; // of the frame being coded
+
+//second pass
+STwoPassFrameStats* pStats;
+int64_t*  pComplexity; // frame bits * QStep of the first pass, *INT_MULTIPLY
+int32_t*  pTargetBits; // bits planned for the frames of pStats
+int32_t   iStatsNum;
+int32_t   iCurStats; // statistics of the frame being coded, -1 if none
+int32_t   iNextStats[MAX_DEPENDENCY_LAYER]; // where the search of the next frame of the layer starts
+int64_t   iTotalPlannedBits[MAX_DEPENDENCY_LAYER];
+int64_t   iPlannedBits[MAX_DEPENDENCY_LAYER]; // of the frames coded
+int64_t   iCodedBits[MAX_DEPENDENCY_LAYER];
+} STwoPassRc;
+
 typedef  void (*PWelsRCPictureInitFunc) (sWelsEncCtx* pCtx,long long uiTimeStamp);
 typedef  void (*PWelsRCPictureDelayJudgeFunc) (sWelsEncCtx* pCtx,long long uiTimeStamp,int32_t iDidIdx);
 typedef  void (*PWelsRCPictureInfoUpdateFunc) (sWelsEncCtx* pCtx, int32_t iLayerSize);
@@ -273,6 +307,8 @@ void RcTraceFrameBits (sWelsEncCtx* pEncCtx, long long uiTimeStamp);
 void WelsRcInitModule (sWelsEncCtx* pCtx, RC_MODES iRcMode);
 void WelsRcInitFuncPointers (sWelsEncCtx* pEncCtx, RC_MODES iRcMode);
 void WelsRcFreeMemory (sWelsEncCtx* pCtx);
+void RcInitTwoPass (sWelsEncCtx* pEncCtx);
+void RcFreeTwoPass (STwoPassRc** ppTwoPassRc);
 bool WelsRcCheckFrameStatus (sWelsEncCtx* pEncCtx,long long uiTimeStamp,int32_t iSpatialNum,int32_t iCurDid);
 bool WelsUpdateSkipFrameStatus();
 long long GetTimestampForRc(const long long uiTimeStamp, const long long uiLastTimeStamp, const float fFrameRate);
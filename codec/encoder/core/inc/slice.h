@@ -180,7 +180,7 @@ SSliceHeaderExt sSliceHeaderExt;
 
 SMVUnitXY       sMvStartMin;
 SMVUnitXY       sMvStartMax;
-SMVUnitXY       sMvc[5];
+SMVUnitXY       sMvc[6];
 uint8_t         uiMvcNum;
 uint8_t         sScaleShift;
 
@@ -66,6 +66,16 @@ uint8_t         uiFeatureStrategyIndex;// index of hash strategy
 bool bFMESwitchFlag;
 uint8_t uiFMEGoodFrameCount;
 int32_t iHighFreMbCount;
+
+/* for the incremental feature calculation, pFeatureOfBlock is kept as the features of pRefLuma across frames */
+uint8_t*        pRefLuma;               // luma of the reference calculated last, (iFrameWidth x iFrameHeight)
+uint32_t*       pTimesOfFeatureValue;   // times of every value in pFeatureOfBlock
+uint8_t*        pRowChanged;            // luma rows of the reference differing from pRefLuma
+int32_t         iFrameWidth;
+int32_t         iFrameHeight;
+int32_t         iListSize;
+bool            bRefLumaValid;
+int32_t         iScrollMvY[2];          // vertical scroll detected on the current and the previous frames
 } SFeatureSearchPreparation; //maintain only one
 
 typedef struct TagSliceBufferInfo {
@@ -125,6 +135,9 @@ bool                    bNeedAdjustingSlicing;
 
 SFeatureSearchPreparation* pFeatureSearchPreparation;
 
+SMVUnitXY*              pHmeMv;                 // motion vectors of the MBs found by the hierarchical motion search
+bool                    bHmeMvValid;            // pHmeMv is valid for the current picture
+
 SDqLayer*               pRefLayer;              // pointer to referencing dq_layer of current layer to be decoded
 };
 
@@ -96,11 +96,13 @@ int32_t InitSliceBsBuffer (SSlice* pSlice,
                            SBitStringAux* pBsWrite,
                            bool bIndependenceBsBuffer,
                            const int32_t iMaxSliceBufferSize,
-                           CMemoryAlign* pMa);
+                           CMemoryAlign* pMa,
+                           CWelsBufferPool* pBufferPool);
 
 void FreeSliceBuffer (SSlice*& pSliceList,
                       const int32_t kiMaxSliceNum,
                       CMemoryAlign* pMa,
+                      CWelsBufferPool* pBufferPool,
                       const char* kpTag);
 
 void InitSliceHeadWithBase (SSlice* pSlice, SSlice* pBaseSlice);
@@ -112,7 +114,8 @@ int32_t InitSliceList (SSlice*& pSliceList,
                        const int32_t kiMaxSliceNum,
                        const int32_t kiMaxSliceBufferSize,
                        const bool bIndependenceBsBuffer,
-                       CMemoryAlign* pMa);
+                       CMemoryAlign* pMa,
+                       CWelsBufferPool* pBufferPool);
 
 int32_t InitAllSlicesInThread (sWelsEncCtx* pCtx);
 
@@ -177,6 +180,13 @@ int32_t WelsMdInterMbLoop (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pMd,
 int32_t WelsMdInterMbLoopOverDynamicSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pMd,
     const int32_t kiSliceFirstMbXY); // for inter dynamic slice
 
+//wavefront coding of single slice layers, see CWelsWavefrontEncoder
+void WelsInitSliceWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice);
+void WelsInitRowMdWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pMd);
+int32_t WelsMdMbWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pMd, SMB* pCurMb); // MD and reconstruction
+int32_t WelsWriteMbWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, SMB* pCurMb, const int32_t kiCostLuma);
+void WelsFinishSliceWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice);
+
 
 bool DynSlcJudgeSliceBoundaryStepBack (void* pEncCtx, void* pSlice, SSliceCtx* pSliceCtx, SMB* pCurMb,
                                        SDynamicSlicingStack* pDss);
@@ -53,6 +53,8 @@ namespace WelsEnc {
 #define CAMERA_HIGHLAYER_MVD_RANGE (243)//mvd range;
 #define EXPANDED_MV_RANGE (504) //=512-8 rather than 511 to sacrifice same edge point but save complexity in assemblys
 #define EXPANDED_MVD_RANGE ((504+1)<<1)
+#define HME_FULL_SEARCH_RANGE (6) //integer pel margin of the full resolution search window around the hierarchical mv
+#define HME_PARTITION_SEARCH_RANGE (4) //the same for the partitions, around the 16x16 mv and their mvp
 
 enum {
 ME_DIA    = 0x01,  // LITTLE DIAMOND= 0x01
@@ -310,13 +312,13 @@ int32_t ReleaseScreenBlockFeatureStorage (CMemoryAlign* pMa, SScreenBlockFeature
 int32_t RequestFeatureSearchPreparation (CMemoryAlign* pMa, const int32_t kiFrameWidth,  const int32_t kiFrameHeight,
     const int32_t iNeedFeatureStorage,
     SFeatureSearchPreparation* pFeatureSearchPreparation);
-int32_t ReleaseFeatureSearchPreparation (CMemoryAlign* pMa, uint16_t*& pFeatureOfBlock);
+int32_t ReleaseFeatureSearchPreparation (CMemoryAlign* pMa, SFeatureSearchPreparation* pFeatureSearchPreparation);
 
 #define FMESWITCH_DEFAULT_GOODFRAME_NUM (2)
 #define FME_DEFAULT_FEATURE_INDEX (0)
 
 
-void PerformFMEPreprocess (SWelsFuncPtrList* pFunc, SPicture* pRef, uint16_t* pFeatureOfBlock,
+void PerformFMEPreprocess (SWelsFuncPtrList* pFunc, SPicture* pRef, SFeatureSearchPreparation* pFeatureSearchPreparation,
                            SScreenBlockFeatureStorage* pScreenBlockFeatureStorage);
 bool SetFeatureSearchIn (SWelsFuncPtrList* pFunc,  const SWelsME& sMe,
                          const SSlice* pSlice, SScreenBlockFeatureStorage* pRefFeatureStorage,
@@ -331,6 +333,9 @@ void UpdateFMESwitchNull (SDqLayer* pCurLayer);
 void WelsDiamondCrossFeatureSearch (SWelsFuncPtrList* pFuncList, SWelsME* pMe, SSlice* pSlice,
                                     const int32_t kiEncStride, const int32_t kiRefStride);
 
+// motion search of each MB on the downsampled pictures of pCurDqLayer, the results seed the full resolution search
+void WelsHierarchicalMotionSearch (SWelsFuncPtrList* pFuncList, SDqLayer* pCurDqLayer, const bool kbPSlice);
+
 //inline functions
 inline void SetMvWithinIntegerMvRange (const int32_t kiMbWidth, const int32_t kiMbHeight, const int32_t kiMbX,
                                        const int32_t kiMbY,
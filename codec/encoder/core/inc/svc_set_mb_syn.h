@@ -54,6 +54,8 @@ namespace WelsEnc {
 
 
 int32_t WelsWriteMbResidual (SWelsFuncPtrList* pFuncList, SMbCache* sMbCacheInfo, SMB* pCurMb, SBitStringAux* pBs);
+// true if the residual of the MB may not be representable in CAVLC, ahead of the writing
+bool WelsMbResidualMayOverflowCavlc (SMbCache* sMbCacheInfo, SMB* pCurMb);
 
 void WelsSpatialWriteSubMbPred (sWelsEncCtx* pEncCtx, SSlice* pSlice, SMB* pCurMb);
 
@@ -42,6 +42,7 @@
 #include "svc_enc_slice_segment.h"
 #include "svc_enc_frame.h"
 #include "expand_pic.h"
+#include "colorspace_convert.h"
 #include "rc.h"
 #include "IWelsVP.h"
 #include "mc.h"
@@ -126,6 +127,9 @@ typedef void (*PInterMdFunc) (sWelsEncCtx* pEncCtx, SWelsMD* pWelsMd, SSlice* sl
 
 typedef int32_t (*PSampleSadSatdCostFunc) (uint8_t*, int32_t, uint8_t*, int32_t);
 typedef void (*PSample4SadCostFunc) (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*);
+// sad of iNum candidates, the i-th one located at pSample2 + i * iStep
+typedef void (*PSampleNSadCostFunc) (uint8_t* pSample1, int32_t iStride1, uint8_t* pSample2, int32_t iStride2,
+                                     int32_t iStep, int32_t iNum, int32_t* pSad);
 typedef int32_t (*PIntraPred4x4Combined3Func) (uint8_t*, int32_t, uint8_t*, int32_t, uint8_t*, int32_t*, int32_t,
     int32_t, int32_t);
 typedef int32_t (*PIntraPred16x16Combined3Func) (uint8_t*, int32_t, uint8_t*, int32_t, int32_t*, int32_t, uint8_t*);
@@ -163,6 +167,7 @@ typedef struct TagSampleDealingFunc {
   PSampleSadSatdCostFunc            pfSampleSad[MAX_BLOCK_TYPE];
   PSampleSadSatdCostFunc            pfSampleSatd[MAX_BLOCK_TYPE];
   PSample4SadCostFunc                 pfSample4Sad[MAX_BLOCK_TYPE];
+  PSampleNSadCostFunc                 pfSampleNSad[MAX_BLOCK_TYPE];      // NULL if not accelerated
   PIntraPred4x4Combined3Func      pfIntra4x4Combined3Satd;
   PIntraPred16x16Combined3Func  pfIntra16x16Combined3Satd;
   PIntraPred16x16Combined3Func  pfIntra16x16Combined3Sad;
@@ -197,6 +202,7 @@ class IWelsParametersetStrategy;
 
 struct TagWelsFuncPointerList {
   SExpandPicFunc sExpandPicFunc;
+  SColorspaceConvertFunc sColorspaceConvertFunc;
   PFillInterNeighborCacheFunc       pfFillInterNeighborCache;
 
   PGetVarianceFromIntraVaaFunc  pfGetVarianceFromIntraVaa;
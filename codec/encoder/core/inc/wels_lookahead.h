@@ -0,0 +1,92 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_lookahead.h
+ *
+ * \brief   lookahead analysis for the rate control: the source pictures are downsampled and their costs are estimated
+ *          from the VAA statistics before they are coded
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELS_LOOKAHEAD_H__
+#define WELS_LOOKAHEAD_H__
+
+#include "typedefs.h"
+#include "macros.h"
+#include "codec_app_def.h"
+#include "memory_align.h"
+#include "IWelsVP.h"
+
+using namespace WelsCommon;
+
+namespace WelsEnc {
+
+/*
+ *  CWelsLookahead: costs of the source pictures, each one relative to the picture analyzed before it. Independent of
+ *  the encoding context, the analysis may run on another thread than the encoding.
+ */
+class CWelsLookahead {
+ public:
+  CWelsLookahead();
+  virtual ~CWelsLookahead();
+
+  static CWelsLookahead* CreateLookahead (const int32_t kiSrcWidth, const int32_t kiSrcHeight);
+  static void DestroyLookahead (CWelsLookahead** ppLookahead);
+
+  // cost of kpSrcPic, the sum over the MBs of the smaller of the inter SAD against the picture analyzed before and of
+  // the intra cost estimated from the variance
+  int64_t Analyze (const SSourcePicture* kpSrcPic);
+  // the next picture is analyzed as the first one, with intra costs only
+  void    Reset();
+
+ private:
+  int32_t Init (const int32_t kiSrcWidth, const int32_t kiSrcHeight);
+  void    Uninit();
+
+  IWelsVP*              m_pInterfaceVp;
+  CMemoryAlign*         m_pMemAlign;
+  uint8_t*              m_pPlane[2][3];         // current and previous downsampled pictures
+  int32_t               m_iStride[3];
+  int32_t               m_iWidth;               // luma size analyzed, multiple of 16, 0 if too small to be analyzed
+  int32_t               m_iHeight;
+  int32_t               m_iCur;
+  bool                  m_bHasRef;
+  SVAACalcResult        m_sVaaResult;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsLookahead);
+};
+
+} // namespace WelsEnc
+
+#endif//WELS_LOOKAHEAD_H__
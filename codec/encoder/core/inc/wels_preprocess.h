@@ -49,6 +49,7 @@
 #include "wels_const.h"
 #include "IWelsVP.h"
 #include "param_svc.h"
+#include "memory_align.h"
 
 namespace WelsEnc {
 
@@ -115,19 +116,52 @@ typedef struct SVAAFrameInfoExt_t: public SVAAFrameInfo {
   uint8_t*    pVaaBlockStaticIdc[16];//real memory,
 } SVAAFrameInfoExt;
 
+/*
+ *  settings of the encoder the source pictures are prepared for, a picture prepared for other ones is prepared again
+ */
+typedef struct TagPrepareSettings {
+  int32_t       iSrcWidth;
+  int32_t       iSrcHeight;
+  int32_t       iSpatialLayerNum;
+  int32_t       iVideoWidth[MAX_DEPENDENCY_LAYER];
+  int32_t       iVideoHeight[MAX_DEPENDENCY_LAYER];
+  int32_t       iActualWidth[MAX_DEPENDENCY_LAYER];
+  int32_t       iActualHeight[MAX_DEPENDENCY_LAYER];
+  int32_t       iUsageType;
+  bool          bEnableDenoise;
+  bool          bEnableBackgroundDetection;
+  bool          bEnableAdaptiveQuant;
+} SPrepareSettings;
+
+/*
+ *  source picture prepared ahead of its coding by CWelsPreProcessAhead: the spatial pictures of the layers, and the VAA
+ *  statistics of each layer against the picture prepared before, as they are calculated for a P frame coded on it
+ */
+typedef struct TagPreparedSource {
+  SPrepareSettings      sSettings;
+  SPicture*             pSpatialPic[MAX_DEPENDENCY_LAYER];
+  SVAACalcResult        sVaaCalcInfo[MAX_DEPENDENCY_LAYER];
+  SMotionTextureUnit*   pMotionTextureUnit[MAX_DEPENDENCY_LAYER];
+  bool                  bVaaCalculated[MAX_DEPENDENCY_LAYER];
+  int64_t               iIndex;       // order of preparation, the VAA statistics are against the picture of iIndex - 1
+} SPreparedSource;
+
 class CWelsPreProcess {
  public:
   CWelsPreProcess (sWelsEncCtx* pEncCtx);
   virtual  ~CWelsPreProcess();
 
   static CWelsPreProcess* CreatePreProcess (sWelsEncCtx* pEncCtx);
+  static void GetPrepareSettings (const SWelsSvcCodingParam* kpParam, SPrepareSettings* pSettings);
 
   virtual SPicture* GetCurrentOrigFrame (int32_t iDIdx) = 0;
  public:
   int32_t WelsPreprocessReset (sWelsEncCtx* pEncCtx, int32_t iWidth, int32_t iHeight);
   int32_t AllocSpatialPictures (sWelsEncCtx* pCtx, SWelsSvcCodingParam* pParam);
   void    FreeSpatialPictures (sWelsEncCtx* pCtx);
-  int32_t BuildSpatialPicList (sWelsEncCtx* pEncCtx, const SSourcePicture* kpSrcPic);
+  // the spatial pictures and the VAA statistics are taken from kpPrepared, if not NULL and prepared for the settings
+  int32_t BuildSpatialPicList (sWelsEncCtx* pEncCtx, const SSourcePicture* kpSrcPic,
+                               const SPreparedSource* kpPrepared = NULL);
   int32_t AnalyzeSpatialPic (sWelsEncCtx* pEncCtx, const int32_t kiDIdx);
   int32_t UpdateSpatialPictures (sWelsEncCtx* pEncCtx, SWelsSvcCodingParam* pParam, const int8_t iCurTid,
                                  const int32_t d_idx);
@@ -135,6 +169,8 @@ class CWelsPreProcess {
   void    AnalyzePictureComplexity (sWelsEncCtx* pCtx, SPicture* pCurPicture, SPicture* pRefPicture,
                                     const int32_t kiDependencyId, const bool kbCalculateBGD);
   int32_t UpdateBlockIdcForScreen (uint8_t*  pCurBlockStaticPointer, const SPicture* kpRefPic, const SPicture* kpSrcPic);
+  // downsample the MB aligned source picture into the pyramid of the hierarchical motion search
+  void    BuildHmePyramid (const SPicture* kpSrcPic, SHmePyramid* pPyramid);
 
 
   void UpdateSrcList (SPicture* pCurPicture, const int32_t kiCurDid, SPicture** pShortRefList,
@@ -158,7 +194,11 @@ class CWelsPreProcess {
 
  private:
   int32_t SingleLayerPreprocess (sWelsEncCtx* pEncCtx, const SSourcePicture* kpSrc, Scaled_Picture* m_sScaledPicture);
+  void    CopyPreparedPicture (const SPicture* kpSrc, SPicture* pDst);
+  bool    TakePreparedVaa (SVAAFrameInfo* pVaaInfo, const int32_t kiDidx, SPicture* pCurPicture, SPicture* pRefPicture,
+                           bool bCalculateSQDiff, bool bCalculateBGD);
 
+ protected:
   void  BilateralDenoising (SPicture* pSrc, const int32_t iWidth, const int32_t iHeight);
 
   int32_t DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth, int32_t iSrcHeight,
@@ -174,10 +214,11 @@ class CWelsPreProcess {
   void    SetRefMbType (sWelsEncCtx* pCtx, uint32_t** pRefMbTypeArray, int32_t iRefPicType);
 
   int32_t ColorspaceConvert (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic, const SSourcePicture* kpSrc,
-                             const int32_t kiWidth, const int32_t kiHeight);
+                             const int32_t kiTargetWidth, const int32_t kiTargetHeight);
   void WelsMoveMemoryWrapper (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic, const SSourcePicture* kpSrc,
                               const int32_t kiWidth, const int32_t kiHeight);
 
+ private:
   /*!
   * \brief  exchange two picture pData planes
   * \param  ppPic1      picture pointer to picture 1
@@ -197,6 +238,8 @@ class CWelsPreProcess {
  private:
   Scaled_Picture   m_sScaledPicture;
   SPicture*        m_pLastSpatialPicture[MAX_DEPENDENCY_LAYER][2];
+  int64_t          m_iLastPreparedIndex[MAX_DEPENDENCY_LAYER][2]; // iIndex of the prepared source of the pictures, or -1
+  const SPreparedSource* m_pPrepared;   // source of the picture being coded if prepared for the settings, or NULL
   bool             m_bInitDone;
   uint8_t          m_uiSpatialPicNum[MAX_DEPENDENCY_LAYER];
  protected:
@@ -245,6 +288,39 @@ class CWelsPreProcessScreen : public CWelsPreProcess {
   void SaveBestRefToVaa (SRefInfoParam& sRefSaved, SRefInfoParam* pVaaBestRef);
 };
 
+/*
+ *  CWelsPreProcessAhead: the spatial pictures of the source pictures and their VAA statistics, prepared before the
+ *  pictures are coded. Independent of the encoding context as the lookahead is, with a VP interface and buffers of its
+ *  own, the preparation may run on another thread than the coding.
+ */
+class CWelsPreProcessAhead : public CWelsPreProcessVideo {
+ public:
+  CWelsPreProcessAhead();
+  virtual ~CWelsPreProcessAhead();
+
+  static CWelsPreProcessAhead* CreatePreProcessAhead (const SWelsSvcCodingParam* kpParam);
+  static void DestroyPreProcessAhead (CWelsPreProcessAhead** ppPreProcess);
+
+  // settings of the pictures prepared from now on, taken while the encoder codes no picture
+  void    SetParam (const SWelsSvcCodingParam* kpParam);
+  // prepare kpSrcPic, of I420 format, into pPrepared, the pictures in the order of their coding; 0 if prepared
+  int32_t Prepare (const SSourcePicture* kpSrcPic, SPreparedSource* pPrepared);
+  void    FreePrepared (SPreparedSource* pPrepared);
+
+ private:
+  int32_t Init (const SWelsSvcCodingParam* kpParam);
+  int32_t AllocPrepared (SPreparedSource* pPrepared, const SPrepareSettings& kSettings);
+
+  CMemoryAlign*         m_pMemAlign;
+  SWelsSvcCodingParam   m_sParam;
+  SPrepareSettings      m_sSettings;
+  Scaled_Picture        m_sScaledPic;
+  const SPreparedSource* m_pLastPrepared;    // picture prepared before, the reference of the VAA statistics
+  int64_t               m_iIndex;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsPreProcessAhead);
+};
+
 
 }
 
@@ -0,0 +1,184 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_task_wavefront.h
+ *
+ * \brief   wavefront coding of single slice layers: the MB rows are mode-decided and reconstructed by tasks on the
+ *          thread pool, each MB waiting for the top-right MB of the row above, while the MB layer syntax of the
+ *          slice is written in raster order on the calling thread as the rows progress
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELS_TASK_WAVEFRONT_H__
+#define WELS_TASK_WAVEFRONT_H__
+
+#include "typedefs.h"
+#include "WelsTask.h"
+#include "WelsThreadLib.h"
+#include "WelsThreadPool.h"
+#include "encoder_context.h"
+#include "md.h"
+
+namespace WelsEnc {
+
+/*
+ *  SWavefrontMbSyn: what the writing of a MB needs from the MB cache of the row context which decided it
+ */
+typedef struct TagWavefrontMbSyn {
+  ALIGNED_DECLARE (SDCTCoeff, sDct, 16);                // pDct of the row context points here during the MD
+  ALIGNED_DECLARE (SMVComponentUnit, sMvComponents, 16);
+  ALIGNED_DECLARE (int8_t, iNonZeroCoeffCount[48], 16);
+  SMVUnitXY     sMbMvp[MB_BLOCK4x4_NUM];
+  bool          bPrevIntra4x4PredModeFlag[16];
+  int8_t        iRemIntra4x4PredModeFlag[16];
+  bool          bMbTypeSkip[4];
+  uint8_t       uiLumaI16x16Mode;
+  uint8_t       uiChmaI8x8Mode;
+  int32_t       iCostLuma;
+} SWavefrontMbSyn;
+
+/*
+ *  SWavefrontRowCtx: state of the MD of one thread, prepared from the slice coded at the start of each slice
+ */
+typedef struct TagWavefrontRowCtx {
+  SSlice*       pSlice;                 // copy of the slice coded, with its own MB cache
+  SMbCache      sMbCache;               // MB cache owned by the context, restored in pSlice on each copy
+  SWelsMD*      pMd;
+} SWavefrontRowCtx;
+
+class CWelsWavefrontEncoder;
+
+/*
+ *  CWelsWavefrontRowTask: MD and reconstruction of the MB rows claimed, on a thread of the pool
+ */
+class CWelsWavefrontRowTask : public WelsCommon::IWelsTask, public WelsCommon::IWelsTaskSink {
+ public:
+  CWelsWavefrontRowTask (CWelsWavefrontEncoder* pEncoder);
+  virtual ~CWelsWavefrontRowTask();
+
+  //IWelsTask
+  virtual int Execute();
+
+  //IWelsTaskSink
+  virtual int OnTaskExecuted();
+  virtual int OnTaskCancelled();
+
+ private:
+  friend class CWelsWavefrontEncoder;
+
+  CWelsWavefrontEncoder*        m_pEncoder;
+  bool                          m_bQueued;      // queued to the thread pool and not executed yet, under the lock
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsWavefrontRowTask);
+};
+
+/*
+ *  CWelsWavefrontEncoder: owned by the encoder context when wavefront threads are configured, all the interfaces
+ *  are called on the encoding thread
+ */
+class CWelsWavefrontEncoder {
+ public:
+  CWelsWavefrontEncoder();
+  virtual ~CWelsWavefrontEncoder();
+
+  static CWelsWavefrontEncoder* CreateWavefrontEncoder (sWelsEncCtx* pCtx, const int32_t kiThreadNum);
+  static void DestroyWavefrontEncoder (CWelsWavefrontEncoder** ppEncoder);
+
+  // whether the slice of the current layer is coded in wavefront order
+  bool      IsEnabled (sWelsEncCtx* pCtx);
+  // MB layer of the slice, its header written already, same as the MB loops of svc_encode_slice.cpp
+  int32_t   CodeSlice (SSlice* pSlice);
+
+ private:
+  friend class CWelsWavefrontRowTask;
+
+  int32_t   Init (sWelsEncCtx* pCtx, const int32_t kiThreadNum);
+  void      Uninit();
+
+  void      PrepareRowCtx (SWavefrontRowCtx* pRow, SSlice* pSlice);
+  // claimed in increasing order by the tasks and by the calling thread, -1 once all rows are claimed
+  int32_t   ClaimRow();
+  void      CodeRow (SWavefrontRowCtx* pRow, const int32_t kiRow);
+  int32_t   WriteRow (const int32_t kiRow);
+  void      Publish (volatile int32_t* pProgress, const int32_t kiValue);
+  // false if the slice has been aborted in the meantime
+  bool      Wait (volatile int32_t* pProgress, const int32_t kiValue);
+
+  // called by the tasks
+  void      RunTask();
+  void      OnTaskDone (CWelsWavefrontRowTask* pTask);
+
+  SWavefrontMbSyn* GetMbSyn (const int32_t kiMbX, const int32_t kiMbY) {
+    return &m_pMbSyn[ (kiMbY % m_iRingRows) * m_iMaxMbWidth + kiMbX];
+  }
+
+  sWelsEncCtx*                  m_pCtx;
+  WelsCommon::CWelsThreadPool*  m_pThreadPool;
+  int32_t                       m_iThreadNum;
+  bool                          m_bLayerEnabled[MAX_DEPENDENCY_LAYER];
+
+  CWelsWavefrontRowTask*        m_pTasks[MAX_THREADS_NUM];
+  SWavefrontRowCtx              m_sRowCtx[MAX_THREADS_NUM + 1]; // the first one is used by the calling thread
+  int32_t                       m_iRowCtxNum;   // contexts in use by the slice, under the lock
+
+  // MB syntax of the last m_iRingRows rows, a row is decided only once the one m_iRingRows above is written
+  SWavefrontMbSyn*              m_pMbSyn;
+  int32_t                       m_iRingRows;
+  int32_t                       m_iMaxMbWidth;
+  int32_t                       m_iMaxMbHeight;
+  volatile int32_t*             m_pDecidedMbs;  // MBs decided in each row
+
+  // slice being coded
+  SSlice*                       m_pSlice;
+  int32_t                       m_iMbWidth;
+  int32_t                       m_iMbHeight;
+  volatile int32_t              m_iNextRow;
+  volatile int32_t              m_iWrittenRows;
+  volatile int32_t              m_iAbort;
+  volatile int32_t              m_iWaiterNum;
+  bool                          m_bActive;      // tasks starting join the slice, under the lock
+  int32_t                       m_iRunningNum;
+
+  WELS_MUTEX                    m_hMutex;
+  WELS_COND                     m_hCond;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsWavefrontEncoder);
+};
+
+// whether WelsCodeOneSlice() hands the slice of the current layer to pCtx->pWavefront
+bool WelsWavefrontEnabled (sWelsEncCtx* pCtx);
+
+} // namespace WelsEnc
+
+#endif//WELS_TASK_WAVEFRONT_H__
@@ -0,0 +1,182 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    buffer_pool.cpp
+ *
+ * \brief   pool of the large encoder buffers, kept across the reinitializations of the encoder
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include <string.h>
+#include "buffer_pool.h"
+
+namespace WelsEnc {
+
+// the buffers outlive the encoder context, so they are aligned independently of the cache line size it detects
+#define BUFFER_POOL_ALIGNMENT       (64)
+#define BUFFER_POOL_INIT_ENTRY_NUM  (32)
+// an idle buffer is not reused for a request smaller than 1/BUFFER_POOL_MAX_WASTE_RATIO of its size, 4 keeps the
+// buffers of a resolution reused when switching to the half of it and back
+#define BUFFER_POOL_MAX_WASTE_RATIO (4)
+
+CWelsBufferPool::CWelsBufferPool (SLogContext* pLogCtx)
+  : m_pMa (NULL),
+    m_pLogCtx (pLogCtx),
+    m_pEntries (NULL),
+    m_iEntryNum (0),
+    m_iEntryCapacity (0),
+    m_uiReusedNum (0) {
+  m_pMa = new CMemoryAlign (BUFFER_POOL_ALIGNMENT);
+}
+
+CWelsBufferPool::~CWelsBufferPool() {
+  if (NULL == m_pMa)
+    return;
+  for (int32_t i = 0; i < m_iEntryNum; i++) {
+    m_pMa->WelsFree (m_pEntries[i].pBuffer, "CWelsBufferPool::pBuffer");
+  }
+  m_pMa->WelsFree (m_pEntries, "CWelsBufferPool::m_pEntries");
+  m_pEntries = NULL;
+  m_iEntryNum = m_iEntryCapacity = 0;
+  WELS_DELETE_OP (m_pMa);
+}
+
+bool CWelsBufferPool::ExpandEntries() {
+  const int32_t kiCapacity = (m_iEntryCapacity > 0) ? (m_iEntryCapacity << 1) : BUFFER_POOL_INIT_ENTRY_NUM;
+  SBufferEntry* pEntries = static_cast<SBufferEntry*> (m_pMa->WelsMallocz (kiCapacity * sizeof (SBufferEntry),
+                           "CWelsBufferPool::m_pEntries"));
+  if (NULL == pEntries)
+    return false;
+  if (m_iEntryNum > 0)
+    memcpy (pEntries, m_pEntries, m_iEntryNum * sizeof (SBufferEntry));
+  m_pMa->WelsFree (m_pEntries, "CWelsBufferPool::m_pEntries");
+  m_pEntries = pEntries;
+  m_iEntryCapacity = kiCapacity;
+  return true;
+}
+
+void* CWelsBufferPool::Acquire (const uint32_t kuiSize, const char* kpTag) {
+  if (NULL == m_pMa)
+    return NULL;
+
+  // the smallest idle buffer large enough
+  int32_t iBest = -1;
+  for (int32_t i = 0; i < m_iEntryNum; i++) {
+    const SBufferEntry* kpEntry = &m_pEntries[i];
+    if (!kpEntry->bInUse && kpEntry->uiSize >= kuiSize
+        && kpEntry->uiSize <= static_cast<uint64_t> (kuiSize) * BUFFER_POOL_MAX_WASTE_RATIO
+        && (iBest < 0 || kpEntry->uiSize < m_pEntries[iBest].uiSize)) {
+      iBest = i;
+    }
+  }
+  if (iBest >= 0) {
+    m_pEntries[iBest].bInUse = true;
+    ++ m_uiReusedNum;
+    return m_pEntries[iBest].pBuffer;
+  }
+
+  if (m_iEntryNum == m_iEntryCapacity && !ExpandEntries())
+    return NULL;
+  void* pBuffer = m_pMa->WelsMalloc (kuiSize, kpTag);
+  if (NULL == pBuffer)
+    return NULL;
+  m_pEntries[m_iEntryNum].pBuffer = pBuffer;
+  m_pEntries[m_iEntryNum].uiSize  = kuiSize;
+  m_pEntries[m_iEntryNum].bInUse  = true;
+  ++ m_iEntryNum;
+  return pBuffer;
+}
+
+void* CWelsBufferPool::Acquirez (const uint32_t kuiSize, const char* kpTag) {
+  void* pBuffer = Acquire (kuiSize, kpTag);
+  if (NULL != pBuffer)
+    memset (pBuffer, 0, kuiSize);
+  return pBuffer;
+}
+
+bool CWelsBufferPool::Release (void* pBuffer, const char* kpTag) {
+  if (NULL == pBuffer)
+    return true;
+  for (int32_t i = 0; i < m_iEntryNum; i++) {
+    if (m_pEntries[i].pBuffer == pBuffer) {
+      assert (m_pEntries[i].bInUse);
+      m_pEntries[i].bInUse = false;
+      return true;
+    }
+  }
+  if (NULL != m_pLogCtx)
+    WelsLog (m_pLogCtx, WELS_LOG_ERROR, "CWelsBufferPool::Release(), %s (0x%p) was not acquired from the pool",
+             (NULL != kpTag) ? kpTag : "buffer", pBuffer);
+  return false;
+}
+
+void CWelsBufferPool::Trim() {
+  int32_t iKept = 0;
+  for (int32_t i = 0; i < m_iEntryNum; i++) {
+    if (m_pEntries[i].bInUse) {
+      m_pEntries[iKept++] = m_pEntries[i];
+    } else {
+      m_pMa->WelsFree (m_pEntries[i].pBuffer, "CWelsBufferPool::pBuffer");
+    }
+  }
+  m_iEntryNum = iKept;
+}
+
+uint32_t CWelsBufferPool::GetMemoryUsage() const {
+  return (NULL != m_pMa) ? m_pMa->WelsGetMemoryUsage() : 0;
+}
+
+uint32_t CWelsBufferPool::GetIdleNum() const {
+  uint32_t uiIdleNum = 0;
+  for (int32_t i = 0; i < m_iEntryNum; i++) {
+    if (!m_pEntries[i].bInUse)
+      ++ uiIdleNum;
+  }
+  return uiIdleNum;
+}
+
+void* WelsPoolMalloc (CWelsBufferPool* pPool, CMemoryAlign* pMa, const uint32_t kuiSize, const char* kpTag) {
+  return (NULL != pPool) ? pPool->Acquire (kuiSize, kpTag) : pMa->WelsMalloc (kuiSize, kpTag);
+}
+
+void* WelsPoolMallocz (CWelsBufferPool* pPool, CMemoryAlign* pMa, const uint32_t kuiSize, const char* kpTag) {
+  return (NULL != pPool) ? pPool->Acquirez (kuiSize, kpTag) : pMa->WelsMallocz (kuiSize, kpTag);
+}
+
+void WelsPoolFree (CWelsBufferPool* pPool, CMemoryAlign* pMa, void* pBuffer, const char* kpTag) {
+  if (NULL == pPool || !pPool->Release (pBuffer, kpTag))
+    pMa->WelsFree (pBuffer, kpTag);
+}
+
+} // namespace WelsEnc
@@ -191,6 +191,7 @@ int32_t InitFunctionPointers (sWelsEncCtx* pEncCtx, SWelsSvcCodingParam* pParam,
 #endif
 
   InitExpandPictureFunc (& (pFuncList->sExpandPicFunc), uiCpuFlag);
+  InitColorspaceConvertFunc (& (pFuncList->sColorspaceConvertFunc), uiCpuFlag);
 
   /* Intra_Prediction_fn*/
   WelsInitIntraPredFuncs (pFuncList, uiCpuFlag);
@@ -225,6 +226,7 @@ int32_t InitFunctionPointers (sWelsEncCtx* pEncCtx, SWelsSvcCodingParam* pParam,
   pFuncList->pParametersetStrategy = IWelsParametersetStrategy::CreateParametersetStrategy (pParam->eSpsPpsIdStrategy,
                                      pParam->bSimulcastAVC, pParam->iSpatialLayerNum);
   WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, (NULL == pFuncList->pParametersetStrategy))
+  pFuncList->pParametersetStrategy->SetIdPartition (pParam->iParasetIdBase, pParam->iParasetIdStep);
 
   return iReturn;
 }
@@ -55,6 +55,7 @@
 #include "slice_multi_threading.h"
 #include "measure_time.h"
 #include "svc_set_mb_syn.h"
+#include "wels_task_wavefront.h"
 
 namespace WelsEnc {
 
@@ -345,6 +346,16 @@ int32_t ParamValidation (SLogContext* pLogCtx, SWelsSvcCodingParam* pCfg) {
     WelsLog (pLogCtx, WELS_LOG_ERROR, "ParamValidation(),Invalid iRCMode = %d", pCfg->iRCMode);
     return ENC_RETURN_UNSUPPORTED_PARA;
   }
+  if (pCfg->iTwoPass > 0) {
+    if ((pCfg->iRCMode != RC_QUALITY_MODE) && (pCfg->iRCMode != RC_BITRATE_MODE)) {
+      WelsLog (pLogCtx, WELS_LOG_WARNING, "ParamValidation(), two-pass rate control disabled for iRCMode = %d",
+               pCfg->iRCMode);
+      pCfg->iTwoPass = 0;
+    } else if ('\0' == pCfg->sTwoPassStatsFile[0]) {
+      WelsLog (pLogCtx, WELS_LOG_ERROR, "ParamValidation(), no statistics file for pass %d", pCfg->iTwoPass);
+      return ENC_RETURN_INVALIDINPUT;
+    }
+  }
   //bitrate setting validation
   if (pCfg->iRCMode != RC_OFF_MODE) {
     int32_t  iTotalBitrate = 0;
@@ -920,21 +931,21 @@ int32_t   InitMbListD (sWelsEncCtx** ppCtx) {
   return 0;
 }
 
-void FreeSliceInLayer (SDqLayer* pDq, CMemoryAlign* pMa) {
+void FreeSliceInLayer (SDqLayer* pDq, CMemoryAlign* pMa, CWelsBufferPool* pBufferPool) {
   int32_t iIdx = 0;
   for (; iIdx < MAX_THREADS_NUM; iIdx ++) {
     FreeSliceBuffer (pDq->sSliceBufferInfo[iIdx].pSliceBuffer,
                      pDq->sSliceBufferInfo[iIdx].iMaxSliceNum,
-                     pMa, "pSliceBuffer");
+                     pMa, pBufferPool, "pSliceBuffer");
   }
 }
 
-void FreeDqLayer (SDqLayer*& pDq, CMemoryAlign* pMa) {
+void FreeDqLayer (SDqLayer*& pDq, CMemoryAlign* pMa, CWelsBufferPool* pBufferPool) {
   if (NULL == pDq) {
     return;
   }
 
-  FreeSliceInLayer (pDq, pMa);
+  FreeSliceInLayer (pDq, pMa, pBufferPool);
 
   if (pDq->ppSliceInLayer) {
     pMa->WelsFree (pDq->ppSliceInLayer, "ppSliceInLayer");
@@ -952,11 +963,16 @@ void FreeDqLayer (SDqLayer*& pDq, CMemoryAlign* pMa) {
   }
 
   if (pDq->pFeatureSearchPreparation) {
-    ReleaseFeatureSearchPreparation (pMa, pDq->pFeatureSearchPreparation->pFeatureOfBlock);
+    ReleaseFeatureSearchPreparation (pMa, pDq->pFeatureSearchPreparation);
     pMa->WelsFree (pDq->pFeatureSearchPreparation, "pFeatureSearchPreparation");
     pDq->pFeatureSearchPreparation = NULL;
   }
 
+  if (pDq->pHmeMv) {
+    pMa->WelsFree (pDq->pHmeMv, "pHmeMv");
+    pDq->pHmeMv = NULL;
+  }
+
   UninitSlicePEncCtx (pDq, pMa);
   pDq->iMaxSliceNum = 0;
 
@@ -1033,8 +1049,13 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx, SExistingParasetList* p
     WELS_VERIFY_RETURN_IF (1, (NULL == pRefList))
     do {
       pRefList->pRef[i] = AllocPicture (pMa, kiWidth, kiHeight, true,
-                                        (iDlayerIndex == iDlayerCount - 1) ? kiNeedFeatureStorage : 0); // to use actual size of current layer
+                                        (iDlayerIndex == iDlayerCount - 1) ? kiNeedFeatureStorage : 0, // to use actual size of current layer
+                                        (*ppCtx)->pBufferPool);
       WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pRefList->pRef[i]), FreeRefList (pRefList, pMa, iNumRef))
+      if (pParam->bHierarchicalMe) {
+        WELS_VERIFY_RETURN_PROC_IF (1, (0 != RequestHmePyramid (pMa, pRefList->pRef[i])), FreeRefList (pRefList, pMa,
+                                    iNumRef))
+      }
       ++ i;
     } while (i < 1 + iNumRef);
 
@@ -1059,7 +1080,7 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx, SExistingParasetList* p
     pParamInternal->bEncCurFrmAsIdrFlag = true;  // make sure first frame is IDR
     // pDq layers list
     pDqLayer = (SDqLayer*)pMa->WelsMallocz (sizeof (SDqLayer), "pDqLayer");
-    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pDqLayer), FreeDqLayer (pDqLayer, pMa))
+    WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pDqLayer), FreeDqLayer (pDqLayer, pMa, (*ppCtx)->pBufferPool))
 
     pDqLayer->bNeedAdjustingSlicing = false;
 
@@ -1075,7 +1096,7 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx, SExistingParasetList* p
     iResult = InitSliceInLayer (*ppCtx, pDqLayer, iDlayerIndex, pMa);
     if (iResult) {
       WelsLog (& (*ppCtx)->sLogCtx, WELS_LOG_WARNING, "InitDqLayers(), InitSliceInLayer failed(%d)!", iResult);
-      FreeDqLayer (pDqLayer, pMa);
+      FreeDqLayer (pDqLayer, pMa, (*ppCtx)->pBufferPool);
       return iResult;
     }
 
@@ -1115,6 +1136,11 @@ static inline int32_t InitDqLayers (sWelsEncCtx** ppCtx, SExistingParasetList* p
       pDqLayer->pFeatureSearchPreparation = NULL;
     }
 
+    if (pParam->bHierarchicalMe) {
+      pDqLayer->pHmeMv = static_cast<SMVUnitXY*> (pMa->WelsMallocz (kiMbW * kiMbH * sizeof (SMVUnitXY), "pHmeMv"));
+      WELS_VERIFY_RETURN_IF (1, NULL == pDqLayer->pHmeMv)
+    }
+
     (*ppCtx)->ppDqLayerList[iDlayerIndex] = pDqLayer;
 
     ++ iDlayerIndex;
@@ -1603,7 +1629,7 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx, SExistingParasetList* pExistingPa
   // Output
   (*ppCtx)->pOut = (SWelsEncoderOutput*)pMa->WelsMallocz (sizeof (SWelsEncoderOutput), "SWelsEncoderOutput");
   WELS_VERIFY_RETURN_IF (1, (NULL == (*ppCtx)->pOut))
-  (*ppCtx)->pOut->pBsBuffer = (uint8_t*)pMa->WelsMallocz (iCountBsLen, "pOut->pBsBuffer");
+  (*ppCtx)->pOut->pBsBuffer = (uint8_t*)WelsPoolMallocz ((*ppCtx)->pBufferPool, pMa, iCountBsLen, "pOut->pBsBuffer");
   WELS_VERIFY_RETURN_IF (1, (NULL == (*ppCtx)->pOut->pBsBuffer))
   (*ppCtx)->pOut->uiSize = iCountBsLen;
   (*ppCtx)->pOut->sNalList = (SWelsNalRaw*)pMa->WelsMallocz (iCountNals * sizeof (SWelsNalRaw), "pOut->sNalList");
@@ -1614,7 +1640,7 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx, SExistingParasetList* pExistingPa
   (*ppCtx)->pOut->iNalIndex     = 0;
   (*ppCtx)->pOut->iLayerBsIndex = 0;
 
-  (*ppCtx)->pFrameBs = (uint8_t*)pMa->WelsMalloc (iTotalLength, "pFrameBs");
+  (*ppCtx)->pFrameBs = (uint8_t*)WelsPoolMalloc ((*ppCtx)->pBufferPool, pMa, iTotalLength, "pFrameBs");
   WELS_VERIFY_RETURN_IF (1, (NULL == (*ppCtx)->pFrameBs))
   (*ppCtx)->iFrameBsSize = iTotalLength;
   (*ppCtx)->iPosBsBuffer = 0;
@@ -1632,6 +1658,10 @@ int32_t RequestMemorySvc (sWelsEncCtx** ppCtx, SExistingParasetList* pExistingPa
     WelsLog (& (*ppCtx)->sLogCtx, WELS_LOG_WARNING, "RequestMemorySvc(), RequestMtResource failed!");
     return 1;
   }
+  if (pParam->iWavefrontThreadNum > 0) {
+    (*ppCtx)->pWavefront = CWelsWavefrontEncoder::CreateWavefrontEncoder (*ppCtx, pParam->iWavefrontThreadNum);
+    WELS_VERIFY_RETURN_IF (1, (NULL == (*ppCtx)->pWavefront))
+  }
 
   (*ppCtx)->pReferenceStrategy = IWelsReferenceStrategy::CreateReferenceStrategy ((*ppCtx), pParam->iUsageType,
                                  pParam->bEnableLongTermReference);
@@ -1800,7 +1830,7 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
     if (NULL != pCtx->pOut) {
       // bs pBuffer
       if (NULL != pCtx->pOut->pBsBuffer) {
-        pMa->WelsFree (pCtx->pOut->pBsBuffer, "pOut->pBsBuffer");
+        WelsPoolFree (pCtx->pBufferPool, pMa, pCtx->pOut->pBsBuffer, "pOut->pBsBuffer");
         pCtx->pOut->pBsBuffer = NULL;
       }
       // NALs list
@@ -1820,13 +1850,15 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
     if (pParam != NULL && pParam->iMultipleThreadIdc > 1)
       ReleaseMtResource (ppCtx);
 
+    CWelsWavefrontEncoder::DestroyWavefrontEncoder (&pCtx->pWavefront);
+
     if (NULL != pCtx->pReferenceStrategy) {
       WELS_DELETE_OP (pCtx->pReferenceStrategy);
     }
 
     // frame bitstream pBuffer
     if (NULL != pCtx->pFrameBs) {
-      pMa->WelsFree (pCtx->pFrameBs, "pFrameBs");
+      WelsPoolFree (pCtx->pBufferPool, pMa, pCtx->pFrameBs, "pFrameBs");
       pCtx->pFrameBs = NULL;
     }
     for (int32_t iIdx = 0; iIdx < MAX_THREADS_NUM; iIdx++) {
@@ -1897,7 +1929,7 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
         SDqLayer* pDq = pCtx->ppDqLayerList[ilayer];
         // pDq layers
         if (NULL != pDq) {
-          FreeDqLayer (pDq, pMa);
+          FreeDqLayer (pDq, pMa, pCtx->pBufferPool);
           pCtx->ppDqLayerList[ilayer] = NULL;
         }
         ++ ilayer;
@@ -1957,6 +1989,7 @@ void FreeMemorySvc (sWelsEncCtx** ppCtx) {
       pMa->WelsFree (pCtx->pWelsSvcRc, "pWelsSvcRc");
       pCtx->pWelsSvcRc = NULL;
     }
+    RcFreeTwoPass (&pCtx->pTwoPassRc);
 
     /* MVD cost tables for Inter */
     if (NULL != pCtx->pMvdCostTable) {
@@ -2262,7 +2295,8 @@ void WelsUninitEncoderExt (sWelsEncCtx** ppCtx) {
  * \return  successful - 0; otherwise none 0 for failed
  */
 int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingParam, SLogContext* pLogCtx,
-                            SExistingParasetList* pExistingParasetList) {
+                            SExistingParasetList* pExistingParasetList, CWelsBufferPool* pBufferPool,
+                            STwoPassRc* pTwoPassRc) {
   sWelsEncCtx* pCtx      = NULL;
   int32_t iRet           = 0;
   int16_t iSliceNum      = 1;    // number of slices used
@@ -2271,12 +2305,14 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
   if (NULL == ppCtx || NULL == pCodingParam) {
     WelsLog (pLogCtx, WELS_LOG_ERROR, "WelsInitEncoderExt(), NULL == ppCtx(0x%p) or NULL == pCodingParam(0x%p).",
              (void*)ppCtx, (void*)pCodingParam);
+    RcFreeTwoPass (&pTwoPassRc);
     return 1;
   }
 
   iRet = ParamValidationExt (pLogCtx, pCodingParam);
   if (iRet != 0) {
     WelsLog (pLogCtx, WELS_LOG_ERROR, "WelsInitEncoderExt(), ParamValidationExt failed return %d.", iRet);
+    RcFreeTwoPass (&pTwoPassRc);
     return iRet;
   }
   iRet = pCodingParam->DetermineTemporalSettings();
@@ -2284,11 +2320,13 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
     WelsLog (pLogCtx, WELS_LOG_ERROR,
              "WelsInitEncoderExt(), DetermineTemporalSettings failed return %d (check in/out frame rate and temporal layer setting! -- in/out = 2^x, x <= temppral_layer_num)",
              iRet);
+    RcFreeTwoPass (&pTwoPassRc);
     return iRet;
   }
   iRet = GetMultipleThreadIdc (pLogCtx, pCodingParam, iSliceNum, iCacheLineSize, uiCpuFeatureFlags);
   if (iRet != 0) {
     WelsLog (pLogCtx, WELS_LOG_ERROR, "WelsInitEncoderExt(), GetMultipleThreadIdc failed return %d.", iRet);
+    RcFreeTwoPass (&pTwoPassRc);
     return iRet;
   }
 
@@ -2297,12 +2335,18 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
 
   pCtx = static_cast<sWelsEncCtx*> (malloc (sizeof (sWelsEncCtx)));
 
-  WELS_VERIFY_RETURN_IF (1, (NULL == pCtx))
+  if (NULL == pCtx) {
+    RcFreeTwoPass (&pTwoPassRc);
+    return 1;
+  }
   memset (pCtx, 0, sizeof (sWelsEncCtx));
 
   pCtx->sLogCtx = *pLogCtx;
+  pCtx->pBufferPool = pBufferPool;
+  pCtx->pTwoPassRc = pTwoPassRc;
 
-  pCtx->pMemAlign = new CMemoryAlign (iCacheLineSize);
+  pCtx->pMemAlign = new CMemoryAlign (iCacheLineSize, pCodingParam->sMemoryArena.uiRegionSize,
+                                      pCodingParam->sMemoryArena.bHugePages);
   WELS_VERIFY_RETURN_PROC_IF (1, (NULL == pCtx->pMemAlign), WelsUninitEncoderExt (&pCtx))
 
   iRet = AllocCodingParam (&pCtx->pSvcParam, pCtx->pMemAlign);
@@ -2331,6 +2375,8 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
   if (pCodingParam->iEntropyCodingModeFlag)
     WelsCabacInit (pCtx);
   WelsRcInitModule (pCtx,  pCtx->pSvcParam->iRCMode);
+  if (NULL == pCtx->pTwoPassRc)
+    RcInitTwoPass (pCtx);
 
   pCtx->pVpp = CWelsPreProcess::CreatePreProcess (pCtx);
   if (pCtx->pVpp == NULL) {
@@ -2345,10 +2391,18 @@ int32_t WelsInitEncoderExt (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPar
     return iRet;
   }
 
+  // buffers of the previous settings not reused so far are not kept
+  if (NULL != pBufferPool) {
+    WelsLog (pLogCtx, WELS_LOG_INFO, "WelsInitEncoderExt(), %u buffers reused in total, %u idle ones freed",
+             pBufferPool->GetReusedNum(), pBufferPool->GetIdleNum());
+    pBufferPool->Trim();
+  }
+
 #if defined(MEMORY_MONITOR)
   WelsLog (pLogCtx, WELS_LOG_INFO, "WelsInitEncoderExt() exit, overall memory usage: %llu bytes",
            static_cast<unsigned long long> (sizeof (sWelsEncCtx) /* requested size from malloc() or new operator */
-               + pCtx->pMemAlign->WelsGetMemoryUsage())  /* requested size from CMemoryAlign::WelsMalloc() */
+               + pCtx->pMemAlign->WelsGetMemoryUsage()  /* requested size from CMemoryAlign::WelsMalloc() */
+               + (pBufferPool ? pBufferPool->GetMemoryUsage() : 0))  /* buffers from the pool */
           );
 #endif//MEMORY_MONITOR
 
@@ -2714,14 +2768,19 @@ void PreprocessSliceCoding (sWelsEncCtx* pCtx) {
             pFeatureSearchPreparation->iHighFreMbCount * 100 / kiMbSize, pCtx->pVaa->sVaaCalcInfo.iFrameSad / kiMbSize,
             pVaaExt->sScrollDetectInfo.bScrollDetectFlag);
 
+        //hints of the shift between the references for the incremental feature calculation
+        const SScrollDetectionParam& ksScrollInfo = pVaaExt->sScrollDetectInfo;
+        pFeatureSearchPreparation->iScrollMvY[1] = pFeatureSearchPreparation->iScrollMvY[0];
+        pFeatureSearchPreparation->iScrollMvY[0] = (ksScrollInfo.bScrollDetectFlag && 0 == ksScrollInfo.iScrollMvX) ?
+            ksScrollInfo.iScrollMvY : 0;
+
         //PerformFMEPreprocess
         SScreenBlockFeatureStorage* pScreenBlockFeatureStorage = pCurLayer->pRefPic->pScreenBlockFeatureStorage;
         pFeatureSearchPreparation->pRefBlockFeature = pScreenBlockFeatureStorage;
         if (pFeatureSearchPreparation->bFMESwitchFlag
             && !pScreenBlockFeatureStorage->bRefBlockFeatureCalculated) {
           SPicture* pRef = (pCtx->pSvcParam->bEnableLongTermReference ? pCurLayer->pRefOri[0] : pCurLayer->pRefPic);
-          PerformFMEPreprocess (pFuncList, pRef, pFeatureSearchPreparation->pFeatureOfBlock,
-                                pScreenBlockFeatureStorage);
+          PerformFMEPreprocess (pFuncList, pRef, pFeatureSearchPreparation, pScreenBlockFeatureStorage);
         }
 
         //assign ME pointer
@@ -2747,6 +2806,11 @@ void PreprocessSliceCoding (sWelsEncCtx* pCtx) {
     }
   }
 
+  if (pCtx->pSvcParam->bHierarchicalMe) {
+    pCtx->pVpp->BuildHmePyramid (pCtx->pEncPic, pCurLayer->pDecPic->pHmePyramid);
+    WelsHierarchicalMotionSearch (pFuncList, pCurLayer, P_SLICE == pCtx->eSliceType);
+  }
+
   // update some layer dependent variable to save judgements in mb-level
   pCurLayer->bSatdInMdFlag = ((pFuncList->sSampleDealingFuncs.pfMeCost == pFuncList->sSampleDealingFuncs.pfSampleSatd)
                               && (pFuncList->sSampleDealingFuncs.pfMdCost == pFuncList->sSampleDealingFuncs.pfSampleSatd));
@@ -3054,6 +3118,21 @@ int32_t ForceCodingIDR (sWelsEncCtx* pCtx, int32_t iLayerId) {
   return 0;
 }
 
+void WelsEncoderSetLookahead (sWelsEncCtx* pCtx, const int64_t* kpCost, const int32_t kiNum) {
+  if (NULL == pCtx)
+    return;
+  pCtx->iLookaheadNum = WELS_CLIP3 (kiNum, 0, MAX_LOOKAHEAD_DEPTH + 1);
+  for (int32_t i = 0; i < pCtx->iLookaheadNum; i++) {
+    pCtx->iLookaheadCost[i] = kpCost[i];
+  }
+}
+
+void WelsEncoderSetPreparedSource (sWelsEncCtx* pCtx, const SPreparedSource* kpPrepared) {
+  if (NULL == pCtx)
+    return;
+  pCtx->pPreparedSource = kpPrepared;
+}
+
 int32_t WelsEncoderEncodeParameterSets (sWelsEncCtx* pCtx, void* pDst) {
   if (NULL == pCtx || NULL == pDst) {
     return ENC_RETURN_UNEXPECTED;
@@ -3470,11 +3549,16 @@ int32_t WelsEncoderEncodeExt (sWelsEncCtx* pCtx, SFrameBSInfo* pFbi, const SSour
     pFbi->sLayerInfo[iNalIdx].iNalCount  = 0;
   }
   // perform csc/denoise/downsample/padding, generate spatial layers
-  iSpatialNum = pCtx->pVpp->BuildSpatialPicList (pCtx, pSrcPic);
+  iSpatialNum = pCtx->pVpp->BuildSpatialPicList (pCtx, pSrcPic, pCtx->pPreparedSource);
   if (iSpatialNum == -1) {
     WelsLog (& (pCtx->sLogCtx), WELS_LOG_ERROR, "Failed in allocating memory in BuildSpatialPicList");
     return ENC_RETURN_MEMALLOCERR;
   }
+  if (pCtx->iEncoderError != ENC_RETURN_SUCCESS) {
+    WelsLog (& (pCtx->sLogCtx), WELS_LOG_ERROR, "Source picture of color format %d not converted in BuildSpatialPicList",
+             pSrcPic->iColorFormat);
+    return pCtx->iEncoderError;
+  }
 
   if (pCtx->pFuncList->pfRc.pfWelsUpdateMaxBrWindowStatus) {
     pCtx->pFuncList->pfRc.pfWelsUpdateMaxBrWindowStatus (pCtx, iSpatialNum, pFbi->uiTimeStamp);
@@ -4158,6 +4242,15 @@ int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNewPa
   }
 
   pOldParam = (*ppCtx)->pSvcParam;
+  // the thread pool is bound to the encoder instance, it can not be changed by the parameters
+  pNewParam->pThreadPoolParam = pOldParam->pThreadPoolParam;
+  pNewParam->iWavefrontThreadNum = pOldParam->iWavefrontThreadNum;
+  pNewParam->iTwoPass = pOldParam->iTwoPass;
+  memcpy (pNewParam->sTwoPassStatsFile, pOldParam->sTwoPassStatsFile, sizeof (pNewParam->sTwoPassStatsFile)); // confirmed_safe_unsafe_usage
+  pNewParam->bHierarchicalMe = pOldParam->bHierarchicalMe;
+  pNewParam->sMemoryArena = pOldParam->sMemoryArena;
+  pNewParam->iParasetIdBase = pOldParam->iParasetIdBase;
+  pNewParam->iParasetIdStep = pOldParam->iParasetIdStep;
 
   if (pOldParam->iUsageType != pNewParam->iUsageType) {
     WelsLog (& (*ppCtx)->sLogCtx, WELS_LOG_ERROR,
@@ -4273,6 +4366,7 @@ int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNewPa
 
   if (bNeedReset) {
     SLogContext sLogCtx = (*ppCtx)->sLogCtx;
+    CWelsBufferPool* pBufferPool = (*ppCtx)->pBufferPool;
 
     int32_t iOldSpsPpsIdStrategy = pOldParam->eSpsPpsIdStrategy;
     SParaSetOffsetVariable sTmpPsoVariable[PARA_SET_TYPE];
@@ -4300,10 +4394,14 @@ int32_t WelsEncoderParamAdjust (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pNewPa
       }
     }
 
+    // the two-pass rate control goes on with the statistics file and the bits planned at the initialization
+    STwoPassRc* pTwoPassRc = (*ppCtx)->pTwoPassRc;
+    (*ppCtx)->pTwoPassRc = NULL;
+
     WelsUninitEncoderExt (ppCtx);
 
     /* Update new parameters */
-    if (WelsInitEncoderExt (ppCtx, pNewParam, &sLogCtx, pExistingParasetList))
+    if (WelsInitEncoderExt (ppCtx, pNewParam, &sLogCtx, pExistingParasetList, pBufferPool, pTwoPassRc))
       return 1;
     //if WelsInitEncoderExt succeed
     //for LTR or SPS,PPS ID update
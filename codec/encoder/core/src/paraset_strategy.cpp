@@ -208,16 +208,18 @@ CWelsParametersetIdConstant::CWelsParametersetIdConstant (const bool bSimulcastA
 
   m_iBasicNeededSpsNum = 1;
   m_iBasicNeededPpsNum = (1 + m_iSpatialLayerNum);
+
+  SetIdPartition (0, 1);
 }
 
 CWelsParametersetIdConstant::~CWelsParametersetIdConstant() {
 }
 
 int32_t CWelsParametersetIdConstant::GetPpsIdOffset (const int32_t iPpsId) {
-  return 0;
+  return m_iIdBase;
 };
 int32_t CWelsParametersetIdConstant::GetSpsIdOffset (const int32_t iPpsId, const int32_t iSpsId) {
-  return 0;
+  return m_iIdBase;
 };
 
 int32_t* CWelsParametersetIdConstant::GetSpsIdOffsetList (const int iParasetType) {
@@ -260,6 +262,19 @@ void CWelsParametersetIdConstant::LoadPrevious (SExistingParasetList* pExistingP
 
 void CWelsParametersetIdConstant::Update (const uint32_t kuiId, const int iParasetType) {
   memset (&m_sParaSetOffset, 0, sizeof (SParaSetOffset));
+  SetIdPartition (m_iIdBase, m_iIdStep);
+}
+
+void CWelsParametersetIdConstant::SetIdPartition (const int32_t kiIdBase, const int32_t kiIdStep) {
+  m_iIdBase = kiIdBase;
+  m_iIdStep = kiIdStep;
+  for (int32_t k = 0; k < PARA_SET_TYPE; k++) {
+    SParaSetOffsetVariable* pParaSetOffsetVariable = &m_sParaSetOffset.sParaSetOffsetVariable[k];
+    for (int32_t i = 0; i < MAX_DQ_LAYER_NUM; i++) {
+      pParaSetOffsetVariable->iParaSetIdDelta[i] = kiIdBase;
+    }
+    pParaSetOffsetVariable->uiNextParaSetIdToUseInBs = kiIdBase;
+  }
 }
 
 uint32_t CWelsParametersetIdConstant::GenerateNewSps (sWelsEncCtx* pCtx, const bool kbUseSubsetSps,
@@ -337,7 +352,8 @@ void CWelsParametersetIdIncreasing::DebugPps (const int32_t kiPpsId) {
 
 void ParasetIdAdditionIdAdjust (SParaSetOffsetVariable* sParaSetOffsetVariable,
                                 const int32_t kiCurEncoderParaSetId,
-                                const uint32_t kuiMaxIdInBs) { //paraset_type = 0: SPS; =1: PPS
+                                const uint32_t kuiMaxIdInBs,
+                                const uint32_t kuiIdBase, const uint32_t kuiIdStep) { //paraset_type = 0: SPS; =1: PPS
   //SPS_ID in avc_sps and pSubsetSps will be different using this
   //SPS_ID case example:
   //1st enter:  next_spsid_in_bs == 0; spsid == 0; delta==0;            //actual spsid_in_bs == 0
@@ -360,9 +376,9 @@ void ParasetIdAdditionIdAdjust (SParaSetOffsetVariable* sParaSetOffsetVariable,
 
   //prepare for next update:
   //   find the next avaibable iId
-  ++uiNextIdInBs;
+  uiNextIdInBs += kuiIdStep;
   if (uiNextIdInBs >= kuiMaxIdInBs) {
-    uiNextIdInBs = 0;//ensure the SPS_ID wound not exceed MAX_SPS_COUNT
+    uiNextIdInBs = kuiIdBase;//ensure the SPS_ID wound not exceed MAX_SPS_COUNT
   }
   //   update next_id
   sParaSetOffsetVariable->uiNextParaSetIdToUseInBs = uiNextIdInBs;
@@ -376,7 +392,8 @@ void CWelsParametersetIdIncreasing::Update (const uint32_t kuiId, const int iPar
 
   ParasetIdAdditionIdAdjust (& (m_sParaSetOffset.sParaSetOffsetVariable[iParasetType]),
                              kuiId,
-                             (iParasetType != PARA_SET_TYPE_PPS) ? MAX_SPS_COUNT : MAX_PPS_COUNT);
+                             (iParasetType != PARA_SET_TYPE_PPS) ? MAX_SPS_COUNT : MAX_PPS_COUNT,
+                             m_iIdBase, m_iIdStep);
 }
 //((SPS_PPS_LISTING != pEncCtx->pSvcParam->eSpsPpsIdStrategy) ? (&
 //  (pEncCtx->sPSOVector.sParaSetOffsetVariable[PARA_SET_TYPE_PPS].iParaSetIdDelta[0])) : NULL)
@@ -708,6 +725,7 @@ void CWelsParametersetSpsListingPpsIncreasing::Update (const uint32_t kuiId, con
 
   ParasetIdAdditionIdAdjust (& (m_sParaSetOffset.sParaSetOffsetVariable[iParasetType]),
                              kuiId,
-                             (iParasetType != PARA_SET_TYPE_PPS) ? MAX_SPS_COUNT : MAX_PPS_COUNT);
+                             (iParasetType != PARA_SET_TYPE_PPS) ? MAX_SPS_COUNT : MAX_PPS_COUNT,
+                             m_iIdBase, m_iIdStep);
 }
 }
@@ -49,7 +49,7 @@ namespace WelsEnc {
  * \return  successful if effective picture pointer returned, otherwise failed with NULL
  */
 SPicture* AllocPicture (CMemoryAlign* pMa, const int32_t kiWidth , const int32_t kiHeight,
-                        bool bNeedMbInfo, int32_t iNeedFeatureStorage) {
+                        bool bNeedMbInfo, int32_t iNeedFeatureStorage, CWelsBufferPool* pBufferPool) {
   SPicture* pPic = NULL;
   int32_t iPicWidth = 0;
   int32_t iPicHeight = 0;
@@ -73,7 +73,8 @@ SPicture* AllocPicture (CMemoryAlign* pMa, const int32_t kiWidth , const int32_t
   iLumaSize         = iPicWidth * iPicHeight;
   iChromaSize       = iPicChromaWidth * iPicChromaHeight;
 
-  pPic->pBuffer = (uint8_t*)pMa->WelsMalloc (iLumaSize /* luma */
+  pPic->pBufferPool = pBufferPool;
+  pPic->pBuffer = (uint8_t*)WelsPoolMalloc (pBufferPool, pMa, iLumaSize /* luma */
                   + (iChromaSize << 1) /* Cb,Cr */
                   , "pPic->pBuffer");
   WELS_VERIFY_RETURN_PROC_IF (NULL, NULL == pPic->pBuffer, FreePicture (pMa, &pPic));
@@ -131,7 +132,7 @@ void FreePicture (CMemoryAlign* pMa, SPicture** ppPic) {
     SPicture* pPic = *ppPic;
 
     if (NULL != pPic->pBuffer) {
-      pMa->WelsFree (pPic->pBuffer, "pPic->pBuffer");
+      WelsPoolFree (pPic->pBufferPool, pMa, pPic->pBuffer, "pPic->pBuffer");
       pPic->pBuffer = NULL;
     }
     pPic->pBuffer          = NULL;
@@ -175,10 +176,43 @@ void FreePicture (CMemoryAlign* pMa, SPicture** ppPic) {
       pPic->pScreenBlockFeatureStorage = NULL;
     }
 
+    if (pPic->pHmePyramid) {
+      for (int32_t iLevel = 0; iLevel < HME_LEVEL_NUM; iLevel++) {
+        pMa->WelsFree (pPic->pHmePyramid->pPlane[iLevel][0], "pHmePyramid->pPlane");
+      }
+      pMa->WelsFree (pPic->pHmePyramid, "pPic->pHmePyramid");
+      pPic->pHmePyramid = NULL;
+    }
+
     pMa->WelsFree (*ppPic, "pPic");
     *ppPic = NULL;
   }
 }
 
+int32_t RequestHmePyramid (CMemoryAlign* pMa, SPicture* pPic) {
+  SHmePyramid* pPyramid = static_cast<SHmePyramid*> (pMa->WelsMallocz (sizeof (SHmePyramid), "pPic->pHmePyramid"));
+  WELS_VERIFY_RETURN_IF (1, NULL == pPyramid);
+  pPic->pHmePyramid = pPyramid;
+
+  // the levels are of the MB aligned picture, downsampled from the padded source
+  const int32_t kiMbAlignedWidth  = WELS_ALIGN (pPic->iWidthInPixel, MB_WIDTH_LUMA);
+  const int32_t kiMbAlignedHeight = WELS_ALIGN (pPic->iHeightInPixel, MB_HEIGHT_LUMA);
+  for (int32_t iLevel = 0; iLevel < HME_LEVEL_NUM; iLevel++) {
+    pPyramid->iWidth[iLevel]     = kiMbAlignedWidth >> (2 + iLevel);
+    pPyramid->iHeight[iLevel]    = kiMbAlignedHeight >> (2 + iLevel);
+    pPyramid->iStride[iLevel][0] = WELS_ALIGN (pPyramid->iWidth[iLevel], 32);
+    pPyramid->iStride[iLevel][1] = pPyramid->iStride[iLevel][2] = WELS_ALIGN (pPyramid->iWidth[iLevel] >> 1, 16);
+    const int32_t kiLumaSize   = pPyramid->iStride[iLevel][0] * pPyramid->iHeight[iLevel];
+    const int32_t kiChromaSize = pPyramid->iStride[iLevel][1] * (pPyramid->iHeight[iLevel] >> 1);
+    uint8_t* pBuffer = static_cast<uint8_t*> (pMa->WelsMallocz (kiLumaSize + (kiChromaSize << 1),
+                       "pHmePyramid->pPlane"));
+    WELS_VERIFY_RETURN_IF (1, NULL == pBuffer);
+    pPyramid->pPlane[iLevel][0] = pBuffer;
+    pPyramid->pPlane[iLevel][1] = pBuffer + kiLumaSize;
+    pPyramid->pPlane[iLevel][2] = pBuffer + kiLumaSize + kiChromaSize;
+  }
+  return 0;
+}
+
 } // namespace WelsEnc
 
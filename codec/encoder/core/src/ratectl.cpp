@@ -45,6 +45,7 @@
 #include "encoder_context.h"
 #include "utils.h"
 #include "svc_enc_golomb.h"
+#include "wels_task_wavefront.h"
 
 
 namespace WelsEnc {
@@ -541,6 +542,25 @@ void RcInitSliceInformation (sWelsEncCtx* pEncCtx) {
   }
 }
 
+// scale the target bits of the frame by its cost relative to the average cost of the lookahead window, so bits are
+// saved ahead of the scene cuts and fades instead of being taken from the frames after them
+void RcAdjustTargetBitsByLookahead (sWelsEncCtx* pEncCtx) {
+  SWelsSvcRc* pWelsSvcRc        = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
+  const int32_t kiCostNum       = pEncCtx->iLookaheadNum;
+  int64_t iCostSum              = 0;
+
+  if (kiCostNum < 2 || pWelsSvcRc->iTargetBits <= 0)
+    return;
+  for (int32_t i = 0; i < kiCostNum; i++) {
+    iCostSum += pEncCtx->iLookaheadCost[i];
+  }
+  if (iCostSum <= 0)
+    return;
+  const int64_t kiRatio = WELS_CLIP3 (WELS_DIV_ROUND64 (pEncCtx->iLookaheadCost[0] * kiCostNum * INT_MULTIPLY, iCostSum),
+                                      INT_MULTIPLY - LOOKAHEAD_RATIO_RANGE, INT_MULTIPLY + LOOKAHEAD_RATIO_RANGE);
+  pWelsSvcRc->iTargetBits = static_cast<int32_t> (WELS_DIV_ROUND64 (pWelsSvcRc->iTargetBits * kiRatio, INT_MULTIPLY));
+}
+
 void RcDecideTargetBits (sWelsEncCtx* pEncCtx) {
   SWelsSvcRc* pWelsSvcRc        = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
   SRCTemporal* pTOverRc         = &pWelsSvcRc->pTemporalOverRc[pEncCtx->uiTemporalId];
@@ -559,6 +579,7 @@ void RcDecideTargetBits (sWelsEncCtx* pEncCtx) {
                                            && (pEncCtx->pSvcParam->bEnableFrameSkip == false))) {
       pWelsSvcRc->iCurrentBitsLevel = BITS_EXCEEDED;
     }
+    RcAdjustTargetBitsByLookahead (pEncCtx);
     pWelsSvcRc->iTargetBits = WELS_CLIP3 (pWelsSvcRc->iTargetBits, pTOverRc->iMinBitsTl, pTOverRc->iMaxBitsTl);
   }
   pWelsSvcRc->iRemainingWeights -= pTOverRc->iTlayerWeight;
@@ -1134,6 +1155,225 @@ int32_t RcCalculateCascadingQp (struct TagWelsEncCtx* pEncCtx, int32_t iQp) {
   return iTemporalQp;
 }
 
+static int32_t RcTwoPassReadStats (STwoPassRc* pTwoPassRc, WelsFileHandle* pFile) {
+  STwoPassFrameStats sStats;
+  uint32_t uiHeader[2];
+  int32_t iStatsNum = 0;
+
+  if ((WelsFread (uiHeader, sizeof (uiHeader), 1, pFile) != 1) || (uiHeader[0] != TWO_PASS_STATS_MAGIC)
+      || (uiHeader[1] != sizeof (STwoPassFrameStats)))
+    return 1;
+  while (WelsFread (&sStats, sizeof (sStats), 1, pFile) == 1)
+    iStatsNum++;
+  if ((0 == iStatsNum) || WelsFseek (pFile, sizeof (uiHeader), WELS_FILE_SEEK_SET))
+    return 1;
+
+  pTwoPassRc->pStats = static_cast<STwoPassFrameStats*> (WelsMallocz (iStatsNum * sizeof (STwoPassFrameStats),
+                       "pTwoPassRc->pStats"));
+  pTwoPassRc->pComplexity = static_cast<int64_t*> (WelsMallocz (iStatsNum * sizeof (int64_t),
+                            "pTwoPassRc->pComplexity"));
+  pTwoPassRc->pTargetBits = static_cast<int32_t*> (WelsMallocz (iStatsNum * sizeof (int32_t),
+                            "pTwoPassRc->pTargetBits"));
+  if ((NULL == pTwoPassRc->pStats) || (NULL == pTwoPassRc->pComplexity) || (NULL == pTwoPassRc->pTargetBits))
+    return 1;
+  if (WelsFread (pTwoPassRc->pStats, sizeof (STwoPassFrameStats), iStatsNum, pFile) != iStatsNum)
+    return 1;
+  pTwoPassRc->iStatsNum = iStatsNum;
+  return 0;
+}
+
+// distribute the bits of each layer over the whole clip: the frames get bits in proportion to their complexity raised
+// to TWO_PASS_QCOMPRESS, so the complex frames are coded with a higher QP but not with the same bits as the others
+static void RcTwoPassPlanBits (sWelsEncCtx* pEncCtx, STwoPassRc* pTwoPassRc) {
+  SWelsSvcCodingParam* pParam = pEncCtx->pSvcParam;
+  int32_t i;
+
+  for (int32_t iDid = 0; iDid < pParam->iSpatialLayerNum; iDid++) {
+    double dWeightSum = 0.0;
+    int64_t iFirstTimeStamp = 0;
+    int64_t iLastTimeStamp = 0;
+    int32_t iFrameNum = 0;
+    for (i = 0; i < pTwoPassRc->iStatsNum; i++) {
+      const STwoPassFrameStats* kpStats = &pTwoPassRc->pStats[i];
+      if (kpStats->uiDid != iDid)
+        continue;
+      pTwoPassRc->pComplexity[i] = static_cast<int64_t> (WELS_MAX (kpStats->iFrameBits, 1)) * RcConvertQp2QStep (
+                                     WELS_MIN (kpStats->uiQp, 51));
+      dWeightSum += pow (static_cast<double> (pTwoPassRc->pComplexity[i]), TWO_PASS_QCOMPRESS);
+      if (0 == iFrameNum)
+        iFirstTimeStamp = kpStats->iTimeStamp;
+      iLastTimeStamp = kpStats->iTimeStamp;
+      iFrameNum++;
+    }
+    if (0 == iFrameNum)
+      continue;
+
+    // duration of the clip, the frames skipped by the first pass included
+    const double kdFrameRate = WELS_MAX (pParam->sDependencyLayers[iDid].fOutputFrameRate, 1.0f);
+    const double kdDuration = WELS_MAX (iFrameNum / kdFrameRate, (iLastTimeStamp - iFirstTimeStamp) / 1000.0 + 1.0 / kdFrameRate);
+    const double kdTotalBits = pParam->sSpatialLayers[iDid].iSpatialBitrate * kdDuration;
+    for (i = 0; i < pTwoPassRc->iStatsNum; i++) {
+      if (pTwoPassRc->pStats[i].uiDid != iDid)
+        continue;
+      pTwoPassRc->pTargetBits[i] = static_cast<int32_t> (kdTotalBits * pow (static_cast<double> (pTwoPassRc->pComplexity[i]),
+                                   TWO_PASS_QCOMPRESS) / dWeightSum);
+      pTwoPassRc->iTotalPlannedBits[iDid] += pTwoPassRc->pTargetBits[i];
+    }
+  }
+}
+
+// the state is not carved from the memory of the encoding context: WelsEncoderParamAdjust() hands it over to the context
+// it resets to, so the statistics file is opened and the bits are planned once per encoder
+void RcInitTwoPass (sWelsEncCtx* pEncCtx) {
+  SWelsSvcCodingParam* pParam = pEncCtx->pSvcParam;
+  STwoPassRc* pTwoPassRc = NULL;
+
+  if (pParam->iTwoPass <= 0)
+    return;
+  pTwoPassRc = static_cast<STwoPassRc*> (WelsMallocz (sizeof (STwoPassRc), "pTwoPassRc"));
+  if (NULL == pTwoPassRc) {
+    WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_ERROR, "RcInitTwoPass(), out of memory, two-pass rate control disabled");
+    return;
+  }
+  pTwoPassRc->iPass = pParam->iTwoPass;
+  pTwoPassRc->iCurStats = -1;
+  pEncCtx->pTwoPassRc = pTwoPassRc;
+
+  if (1 == pTwoPassRc->iPass) {
+    const uint32_t kuiHeader[2] = {TWO_PASS_STATS_MAGIC, sizeof (STwoPassFrameStats)};
+    pTwoPassRc->pStatsFile = WelsFopen (pParam->sTwoPassStatsFile, "wb");
+    if ((NULL == pTwoPassRc->pStatsFile) || (WelsFwrite (kuiHeader, sizeof (kuiHeader), 1, pTwoPassRc->pStatsFile) != 1)) {
+      WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_ERROR, "RcInitTwoPass(), can not write the statistics file %s",
+               pParam->sTwoPassStatsFile);
+      RcFreeTwoPass (&pEncCtx->pTwoPassRc);
+    }
+    return;
+  }
+
+  WelsFileHandle* pFile = WelsFopen (pParam->sTwoPassStatsFile, "rb");
+  const int32_t kiReturn = (NULL != pFile) ? RcTwoPassReadStats (pTwoPassRc, pFile) : 1;
+  if (NULL != pFile)
+    WelsFclose (pFile);
+  if (kiReturn) {
+    WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_ERROR,
+             "RcInitTwoPass(), invalid statistics file %s, encoded in a single pass", pParam->sTwoPassStatsFile);
+    RcFreeTwoPass (&pEncCtx->pTwoPassRc);
+    return;
+  }
+  RcTwoPassPlanBits (pEncCtx, pTwoPassRc);
+  WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_INFO, "RcInitTwoPass(), %d frames of statistics read from %s",
+           pTwoPassRc->iStatsNum, pParam->sTwoPassStatsFile);
+}
+
+void RcFreeTwoPass (STwoPassRc** ppTwoPassRc) {
+  STwoPassRc* pTwoPassRc = *ppTwoPassRc;
+
+  if (NULL == pTwoPassRc)
+    return;
+  if (NULL != pTwoPassRc->pStatsFile)
+    WelsFclose (pTwoPassRc->pStatsFile);
+  WelsFree (pTwoPassRc->pStats, "pTwoPassRc->pStats");
+  WelsFree (pTwoPassRc->pComplexity, "pTwoPassRc->pComplexity");
+  WelsFree (pTwoPassRc->pTargetBits, "pTwoPassRc->pTargetBits");
+  WelsFree (pTwoPassRc, "pTwoPassRc");
+  *ppTwoPassRc = NULL;
+}
+
+// statistics of the frame of the current layer, searched forward from the last frame found since the frames are coded
+// in the same order by the two passes; -1 for a frame the first pass skipped
+static int32_t RcTwoPassFindStats (STwoPassRc* pTwoPassRc, const int32_t kiDid, const long long uiTimeStamp) {
+  for (int32_t i = pTwoPassRc->iNextStats[kiDid]; i < pTwoPassRc->iStatsNum; i++) {
+    const STwoPassFrameStats* kpStats = &pTwoPassRc->pStats[i];
+    if (kpStats->uiDid != kiDid)
+      continue;
+    if (kpStats->iTimeStamp > uiTimeStamp)
+      break;
+    if (kpStats->iTimeStamp == uiTimeStamp) {
+      pTwoPassRc->iNextStats[kiDid] = i + 1;
+      return i;
+    }
+  }
+  return -1;
+}
+
+// second pass: the target bits of the frame are the bits planned, corrected by the bits coded beyond or below the plan
+// so far; returns false when the frame is rate controlled as in a single pass
+static bool RcTwoPassDecideTargetBits (sWelsEncCtx* pEncCtx, long long uiTimeStamp) {
+  STwoPassRc* pTwoPassRc = pEncCtx->pTwoPassRc;
+  SWelsSvcRc* pWelsSvcRc = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
+  const int32_t kiDid   = pEncCtx->uiDependencyId;
+
+  if (NULL == pTwoPassRc)
+    return false;
+  pTwoPassRc->uiTimeStamp = uiTimeStamp;
+  pTwoPassRc->iCurStats = (2 == pTwoPassRc->iPass) ? RcTwoPassFindStats (pTwoPassRc, kiDid, uiTimeStamp) : -1;
+  if (pTwoPassRc->iCurStats < 0)
+    return false;
+
+  int64_t iTargetBits = pTwoPassRc->pTargetBits[pTwoPassRc->iCurStats];
+  const int64_t kiRemainingBits = pTwoPassRc->iTotalPlannedBits[kiDid] - pTwoPassRc->iPlannedBits[kiDid];
+  if (kiRemainingBits > 0) {
+    int64_t iRatio = WELS_DIV_ROUND64 ((kiRemainingBits + pTwoPassRc->iPlannedBits[kiDid] - pTwoPassRc->iCodedBits[kiDid])
+                                       * INT_MULTIPLY, kiRemainingBits);
+    iRatio = WELS_CLIP3 (iRatio, INT_MULTIPLY - TWO_PASS_CORRECTION_RANGE, INT_MULTIPLY + TWO_PASS_CORRECTION_RANGE);
+    iTargetBits = WELS_DIV_ROUND64 (iTargetBits * iRatio, INT_MULTIPLY);
+  }
+  pWelsSvcRc->iTargetBits = static_cast<int32_t> (WELS_MAX (iTargetBits, 1));
+  return true;
+}
+
+// second pass: QP of the frame from its complexity in the first pass and its target bits
+static void RcTwoPassCalculateQp (sWelsEncCtx* pEncCtx) {
+  STwoPassRc* pTwoPassRc = pEncCtx->pTwoPassRc;
+  SWelsSvcRc* pWelsSvcRc = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
+  SRCTemporal* pTOverRc  = &pWelsSvcRc->pTemporalOverRc[pEncCtx->uiTemporalId];
+  const int32_t kiMinQp  = (pEncCtx->eSliceType == I_SLICE) ? pWelsSvcRc->iMinQp : pTOverRc->iMinQp;
+  const int32_t kiMaxQp  = (pEncCtx->eSliceType == I_SLICE) ? pWelsSvcRc->iMaxQp : pTOverRc->iMaxQp;
+
+  const int64_t kiQStep = WELS_DIV_ROUND64 (pTwoPassRc->pComplexity[pTwoPassRc->iCurStats], pWelsSvcRc->iTargetBits);
+  int32_t iLumaQp = RcConvertQStep2Qp (static_cast<int32_t> (WELS_CLIP3 (kiQStep, RcConvertQp2QStep (0),
+                                       RcConvertQp2QStep (51))));
+  iLumaQp = WELS_CLIP3 (iLumaQp, kiMinQp, kiMaxQp);
+  pWelsSvcRc->iMinFrameQp = WELS_CLIP3 (iLumaQp - pWelsSvcRc->iFrameDeltaQpLower, kiMinQp, kiMaxQp);
+  pWelsSvcRc->iMaxFrameQp = WELS_CLIP3 (iLumaQp + pWelsSvcRc->iFrameDeltaQpUpper, kiMinQp, kiMaxQp);
+
+  if (pEncCtx->eSliceType == I_SLICE) {
+    pWelsSvcRc->iInitialQp = iLumaQp;
+  } else if (pEncCtx->pSvcParam->bEnableAdaptiveQuant) {
+    iLumaQp =  WELS_DIV_ROUND (iLumaQp * INT_MULTIPLY - pEncCtx->pVaa->sAdaptiveQuantParam.iAverMotionTextureIndexToDeltaQp,
+                               INT_MULTIPLY);
+    iLumaQp = WELS_CLIP3 (iLumaQp, pWelsSvcRc->iMinFrameQp, pWelsSvcRc->iMaxFrameQp);
+  }
+  pWelsSvcRc->iQStep = RcConvertQp2QStep (iLumaQp);
+  pWelsSvcRc->iLastCalculatedQScale = iLumaQp;
+  pEncCtx->iGlobalQp = iLumaQp;
+}
+
+// first pass: write the statistics of the frame coded; second pass: account the bits planned and coded
+static void RcTwoPassUpdate (sWelsEncCtx* pEncCtx) {
+  STwoPassRc* pTwoPassRc = pEncCtx->pTwoPassRc;
+  SWelsSvcRc* pWelsSvcRc = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
+  const int32_t kiDid   = pEncCtx->uiDependencyId;
+
+  if (NULL == pTwoPassRc)
+    return;
+  if (1 == pTwoPassRc->iPass) {
+    STwoPassFrameStats sStats;
+    memset (&sStats, 0, sizeof (sStats));
+    sStats.iTimeStamp  = pTwoPassRc->uiTimeStamp;
+    sStats.iFrameBits  = pWelsSvcRc->iFrameDqBits;
+    sStats.uiDid       = pEncCtx->uiDependencyId;
+    sStats.uiTid       = pEncCtx->uiTemporalId;
+    sStats.uiSliceType = pEncCtx->eSliceType;
+    sStats.uiQp        = pWelsSvcRc->iAverageFrameQp;
+    WelsFwrite (&sStats, sizeof (sStats), 1, pTwoPassRc->pStatsFile);
+  } else if (pTwoPassRc->iCurStats >= 0) {
+    pTwoPassRc->iPlannedBits[kiDid] += pTwoPassRc->pTargetBits[pTwoPassRc->iCurStats];
+    pTwoPassRc->iCodedBits[kiDid] += pWelsSvcRc->iFrameDqBits;
+    pTwoPassRc->iCurStats = -1;
+  }
+}
+
 void  WelsRcPictureInitGom (sWelsEncCtx* pEncCtx, long long uiTimeStamp) {
   SWelsSvcRc* pWelsSvcRc           = &pEncCtx->pWelsSvcRc[pEncCtx->uiDependencyId];
   const int32_t kiSliceNum         = pEncCtx->pCurDqLayer->iMaxSliceNum;
@@ -1156,15 +1396,18 @@ void  WelsRcPictureInitGom (sWelsEncCtx* pEncCtx, long long uiTimeStamp) {
   } else {
     RcDecideTargetBits (pEncCtx);
   }
-  //turn off GOM QP when slicenum is larger 1
-  if ((kiSliceNum > 1) || ((pEncCtx->pSvcParam->iRCMode == RC_BITRATE_MODE)
-                           && (pEncCtx->eSliceType == I_SLICE))) {
+  const bool kbTwoPassPlanned = RcTwoPassDecideTargetBits (pEncCtx, uiTimeStamp);
+  //turn off GOM QP when slicenum is larger 1, or when MB rows are decided ahead of the bits written in wavefront order
+  if ((kiSliceNum > 1) || WelsWavefrontEnabled (pEncCtx) || ((pEncCtx->pSvcParam->iRCMode == RC_BITRATE_MODE)
+      && (pEncCtx->eSliceType == I_SLICE))) {
     pWelsSvcRc->bEnableGomQp = false;
   } else
     pWelsSvcRc->bEnableGomQp = true;
 
   //decide globe_qp
-  if (pEncCtx->eSliceType == I_SLICE) {
+  if (kbTwoPassPlanned) {
+    RcTwoPassCalculateQp (pEncCtx);
+  } else if (pEncCtx->eSliceType == I_SLICE) {
     RcCalculateIdrQp (pEncCtx);
   } else {
     RcCalculatePictureQp (pEncCtx);
@@ -1185,6 +1428,7 @@ void  WelsRcPictureInfoUpdateGom (sWelsEncCtx* pEncCtx, int32_t iLayerSize) {
     RcUpdateIntraComplexity (pEncCtx);
   }
   pWelsSvcRc->iRemainingBits -= pWelsSvcRc->iFrameDqBits;
+  RcTwoPassUpdate (pEncCtx);
 
   if (pEncCtx->pSvcParam->bEnableFrameSkip /*&&
       pEncCtx->uiDependencyId == pEncCtx->pSvcParam->iSpatialLayerNum - 1*/) {
@@ -360,6 +360,8 @@ void WelsInitSampleSadFunc (SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag) {
   pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_8x4] = WelsSampleSadFour8x4_c;
   pFuncList->sSampleDealingFuncs.pfSample4Sad[BLOCK_4x8] = WelsSampleSadFour4x8_c;
 
+  memset (pFuncList->sSampleDealingFuncs.pfSampleNSad, 0, sizeof (pFuncList->sSampleDealingFuncs.pfSampleNSad));
+
   pFuncList->sSampleDealingFuncs.pfIntra4x4Combined3Satd   = NULL;
   pFuncList->sSampleDealingFuncs.pfIntra8x8Combined3Satd   = NULL;
   pFuncList->sSampleDealingFuncs.pfIntra8x8Combined3Sad    = NULL;
@@ -410,6 +412,8 @@ void WelsInitSampleSadFunc (SWelsFuncPtrList* pFuncList, uint32_t uiCpuFlag) {
     pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_16x8]  = WelsSampleSatd16x8_avx2;
     pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_8x16]  = WelsSampleSatd8x16_avx2;
     pFuncList->sSampleDealingFuncs.pfSampleSatd[BLOCK_8x8]   = WelsSampleSatd8x8_avx2;
+    // WelsSampleSad*_avx2, WelsSampleSadFour16x*_avx2 and WelsSampleNSad*_avx2 are not installed till they are
+    // verified against the C reference and measured against the SSE2 kernels on an AVX2 host
   }
 #endif
 #endif //(X86_ASM)
@@ -339,7 +339,8 @@ int32_t RequestMtResource (sWelsEncCtx** ppCtx, SWelsSvcCodingParam* pCodingPara
   int32_t iThreadBufferNum = WELS_MIN ((*ppCtx)->pTaskManage->GetThreadPoolThreadNum(), MAX_THREADS_NUM);
 
   for (iIdx = 0; iIdx < iThreadBufferNum; iIdx++) {
-    pSmt->pThreadBsBuffer[iIdx] = (uint8_t*)pMa->WelsMallocz (iCountBsLen, "pSmt->pThreadBsBuffer");
+    pSmt->pThreadBsBuffer[iIdx] = (uint8_t*)WelsPoolMallocz ((*ppCtx)->pBufferPool, pMa, iCountBsLen,
+                                  "pSmt->pThreadBsBuffer");
     WELS_VERIFY_RETURN_IF (1, (NULL == pSmt->pThreadBsBuffer[iIdx]))
   }
   iReturn = WelsMutexInit (&pSmt->mutexThreadBsBufferUsage);
@@ -405,7 +406,7 @@ void ReleaseMtResource (sWelsEncCtx** ppCtx) {
 
   for (int i = 0; i < MAX_THREADS_NUM; i++) {
     if (pSmt->pThreadBsBuffer[i]) {
-      pMa->WelsFree (pSmt->pThreadBsBuffer[i], "pSmt->pThreadBsBuffer");
+      WelsPoolFree ((*ppCtx)->pBufferPool, pMa, pSmt->pThreadBsBuffer[i], "pSmt->pThreadBsBuffer");
       pSmt->pThreadBsBuffer[i] = NULL;
     }
   }
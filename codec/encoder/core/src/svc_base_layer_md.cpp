@@ -975,6 +975,22 @@ static inline void InitMe (const SWelsMD& sWelsMd, const int32_t iBlockSize, uin
   sWelsMe.pRefFeatureStorage = pRefFeatureStorage;
 }
 
+// with a valid hierarchical mv, the full resolution search is confined to the box spanned by ksMv and the mvp,
+// widened by kiMargin integer pels and clipped to the slice range; the caller restores the slice range after the search
+static inline void SetHmeSearchWindow (SSlice* pSlice, const SMVUnitXY ksMv, const SMVUnitXY ksMvp,
+                                       const int32_t kiMargin) {
+  const SMVUnitXY ksMvStartMin = pSlice->sMvStartMin;
+  const SMVUnitXY ksMvStartMax = pSlice->sMvStartMax;
+  const int32_t kiMvX  = (2 + ksMv.iMvX) >> 2;
+  const int32_t kiMvY  = (2 + ksMv.iMvY) >> 2;
+  const int32_t kiMvpX = (2 + ksMvp.iMvX) >> 2;
+  const int32_t kiMvpY = (2 + ksMvp.iMvY) >> 2;
+  pSlice->sMvStartMin.iMvX = WELS_CLIP3 (WELS_MIN (kiMvX, kiMvpX) - kiMargin, ksMvStartMin.iMvX, ksMvStartMax.iMvX);
+  pSlice->sMvStartMin.iMvY = WELS_CLIP3 (WELS_MIN (kiMvY, kiMvpY) - kiMargin, ksMvStartMin.iMvY, ksMvStartMax.iMvY);
+  pSlice->sMvStartMax.iMvX = WELS_CLIP3 (WELS_MAX (kiMvX, kiMvpX) + kiMargin, ksMvStartMin.iMvX, ksMvStartMax.iMvX);
+  pSlice->sMvStartMax.iMvY = WELS_CLIP3 (WELS_MAX (kiMvY, kiMvpY) + kiMargin, ksMvStartMin.iMvY, ksMvStartMax.iMvY);
+}
+
 int32_t WelsMdP16x16 (SWelsFuncPtrList* pFunc, SDqLayer* pCurLayer, SWelsMD* pWelsMd, SSlice* pSlice, SMB* pCurMb) {
   SMbCache* pMbCache = &pSlice->sMbCacheInfo;
   SWelsME* pMe16x16 = &pWelsMd->sMe.sMe16x16;
@@ -1011,9 +1027,19 @@ int32_t WelsMdP16x16 (SWelsFuncPtrList* pFunc, SDqLayer* pCurLayer, SWelsMD* pWe
       ++ pSlice->uiMvcNum;
     }
   }
+  //hierarchical motion search predictor
+  if (pCurLayer->bHmeMvValid) {
+    pSlice->sMvc[pSlice->uiMvcNum++] = pCurLayer->pHmeMv[pCurMb->iMbXY];
+  }
 
   PredMv (&pMbCache->sMvComponents, 0, 4, 0, & (pMe16x16->sMvp));
+  const SMVUnitXY ksMvStartMin = pSlice->sMvStartMin;
+  const SMVUnitXY ksMvStartMax = pSlice->sMvStartMax;
+  if (pCurLayer->bHmeMvValid)
+    SetHmeSearchWindow (pSlice, pCurLayer->pHmeMv[pCurMb->iMbXY], pMe16x16->sMvp, HME_FULL_SEARCH_RANGE);
   pFunc->pfMotionSearch[0] (pFunc, pCurLayer, pMe16x16, pSlice);
+  pSlice->sMvStartMin = ksMvStartMin;
+  pSlice->sMvStartMax = ksMvStartMax;
 
   pCurMb->sP16x16Mv = pMe16x16->sMv;
   pCurLayer->pDecPic->sMvList[pCurMb->iMbXY] = pMe16x16->sMv;
@@ -1027,6 +1053,8 @@ int32_t WelsMdP16x8 (SWelsFuncPtrList* pFunc, SDqLayer* pCurDqLayer, SWelsMD* pW
   SWelsME* sMe16x8;
   int32_t i = 0, iPixelY;
   int32_t iCostP16x8 = 0;
+  const SMVUnitXY ksMvStartMin = pSlice->sMvStartMin;
+  const SMVUnitXY ksMvStartMax = pSlice->sMvStartMax;
   do {
     sMe16x8 = &pWelsMd->sMe.sMe16x8[i];
     iPixelY = (i << 3);
@@ -1043,7 +1071,13 @@ int32_t WelsMdP16x8 (SWelsFuncPtrList* pFunc, SDqLayer* pCurDqLayer, SWelsMD* pW
     pSlice->uiMvcNum = 1;
 
     PredInter16x8Mv (pMbCache, i << 3, 0, & (sMe16x8->sMvp));
+    if (pCurDqLayer->bHmeMvValid) {
+      pSlice->sMvc[pSlice->uiMvcNum++] = pWelsMd->sMe.sMe16x16.sMv;
+      SetHmeSearchWindow (pSlice, pWelsMd->sMe.sMe16x16.sMv, sMe16x8->sMvp, HME_PARTITION_SEARCH_RANGE);
+    }
     pFunc->pfMotionSearch[0] (pFunc, pCurDqLayer, sMe16x8, pSlice);
+    pSlice->sMvStartMin = ksMvStartMin;
+    pSlice->sMvStartMax = ksMvStartMax;
     UpdateP16x8Motion2Cache (pMbCache, i << 3, pWelsMd->uiRef, & (sMe16x8->sMv));
     iCostP16x8 += sMe16x8->uiSatdCost;
     ++i;
@@ -1055,6 +1089,8 @@ int32_t WelsMdP8x16 (SWelsFuncPtrList* pFunc, SDqLayer* pCurLayer, SWelsMD* pWel
   SWelsME* sMe8x16;
   int32_t i = 0, iPixelX;
   int32_t iCostP8x16 = 0;
+  const SMVUnitXY ksMvStartMin = pSlice->sMvStartMin;
+  const SMVUnitXY ksMvStartMax = pSlice->sMvStartMax;
   do {
     iPixelX = (i << 3);
     sMe8x16 = &pWelsMd->sMe.sMe8x16[i];
@@ -1071,7 +1107,13 @@ int32_t WelsMdP8x16 (SWelsFuncPtrList* pFunc, SDqLayer* pCurLayer, SWelsMD* pWel
     pSlice->uiMvcNum = 1;
 
     PredInter8x16Mv (pMbCache, i << 2, 0, & (sMe8x16->sMvp));
+    if (pCurLayer->bHmeMvValid) {
+      pSlice->sMvc[pSlice->uiMvcNum++] = pWelsMd->sMe.sMe16x16.sMv;
+      SetHmeSearchWindow (pSlice, pWelsMd->sMe.sMe16x16.sMv, sMe8x16->sMvp, HME_PARTITION_SEARCH_RANGE);
+    }
     pFunc->pfMotionSearch[0] (pFunc, pCurLayer, sMe8x16, pSlice);
+    pSlice->sMvStartMin = ksMvStartMin;
+    pSlice->sMvStartMax = ksMvStartMax;
     UpdateP8x16Motion2Cache (pMbCache, i << 2, pWelsMd->uiRef, & (sMe8x16->sMv));
     iCostP8x16 += sMe8x16->uiSatdCost;
     ++i;
@@ -1085,6 +1127,8 @@ int32_t WelsMdP8x8 (SWelsFuncPtrList* pFunc, SDqLayer* pCurDqLayer, SWelsMD* pWe
   SWelsME* sMe8x8;
   int32_t i, iIdxX, iIdxY, iPixelX, iPixelY, iStrideEnc, iStrideRef;
   int32_t iCostP8x8 = 0;
+  const SMVUnitXY ksMvStartMin = pSlice->sMvStartMin;
+  const SMVUnitXY ksMvStartMax = pSlice->sMvStartMax;
   for (i = 0; i < 4; i++) {
     iIdxX = i & 1;
     iIdxY = i >> 1;
@@ -1109,7 +1153,13 @@ int32_t WelsMdP8x8 (SWelsFuncPtrList* pFunc, SDqLayer* pCurDqLayer, SWelsMD* pWe
     pSlice->uiMvcNum = 1;
 
     PredMv (&pMbCache->sMvComponents, i << 2, 2, pWelsMd->uiRef, & (sMe8x8->sMvp));
+    if (pCurDqLayer->bHmeMvValid) {
+      pSlice->sMvc[pSlice->uiMvcNum++] = pWelsMd->sMe.sMe16x16.sMv;
+      SetHmeSearchWindow (pSlice, pWelsMd->sMe.sMe16x16.sMv, sMe8x8->sMvp, HME_PARTITION_SEARCH_RANGE);
+    }
     pFunc->pfMotionSearch[pWelsMd->iBlock8x8StaticIdc[i]] (pFunc, pCurDqLayer, sMe8x8, pSlice);
+    pSlice->sMvStartMin = ksMvStartMin;
+    pSlice->sMvStartMax = ksMvStartMax;
     UpdateP8x8Motion2Cache (pMbCache, i << 2, pWelsMd->uiRef, & (sMe8x8->sMv));
     iCostP8x8 += sMe8x8->uiSatdCost;
 //    sMe8x8++;
@@ -46,6 +46,7 @@
 #include "svc_set_mb_syn.h"
 #include "decode_mb_aux.h"
 #include "svc_mode_decision.h"
+#include "wels_task_wavefront.h"
 
 namespace WelsEnc {
 //#define ENC_TRACE
@@ -705,15 +706,14 @@ int32_t WelsPSliceMdEncDynamic (sWelsEncCtx* pEncCtx, SSlice* pSlice, const bool
   return WelsMdInterMbLoopOverDynamicSlice (pEncCtx, pSlice, &sMd, kiSliceFirstMbXY);
 }
 
-int32_t WelsCodePSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
-  //pSlice-level init should be outside and before this function
+// MD switch of P slices, returns whether the current layer is the highest spatial one
+static bool WelsInitInterMdFunc (sWelsEncCtx* pEncCtx) {
   SDqLayer* pCurLayer = pEncCtx->pCurDqLayer;
 
   const bool kbBaseAvail = pCurLayer->bBaseLayerAvailableFlag;
   const bool kbHighestSpatial = pEncCtx->pSvcParam->iSpatialLayerNum ==
                                 (pCurLayer->sLayerInfo.sNalHeaderExt.uiDependencyId + 1);
 
-  //MD switch
   if (kbBaseAvail && kbHighestSpatial) {
     //initial pMd pointer
     pEncCtx->pFuncList->pfInterMd = WelsMdInterMbEnhancelayer;
@@ -721,25 +721,20 @@ int32_t WelsCodePSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
     //initial pMd pointer
     pEncCtx->pFuncList->pfInterMd = WelsMdInterMb;
   }
+  return kbHighestSpatial;
+}
+
+int32_t WelsCodePSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
+  //pSlice-level init should be outside and before this function
+  const bool kbHighestSpatial = WelsInitInterMdFunc (pEncCtx);
+
   return WelsPSliceMdEnc (pEncCtx, pSlice, kbHighestSpatial);
 }
 
 int32_t WelsCodePOverDynamicSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
   //pSlice-level init should be outside and before this function
-  SDqLayer* pCurLayer = pEncCtx->pCurDqLayer;
+  const bool kbHighestSpatial = WelsInitInterMdFunc (pEncCtx);
 
-  const bool kbBaseAvail = pCurLayer->bBaseLayerAvailableFlag;
-  const bool kbHighestSpatial = pEncCtx->pSvcParam->iSpatialLayerNum ==
-                                (pCurLayer->sLayerInfo.sNalHeaderExt.uiDependencyId + 1);
-
-  //MD switch
-  if (kbBaseAvail && kbHighestSpatial) {
-    //initial pMd pointer
-    pEncCtx->pFuncList->pfInterMd = WelsMdInterMbEnhancelayer;
-  } else {
-    //initial pMd pointer
-    pEncCtx->pFuncList->pfInterMd = WelsMdInterMb;
-  }
   return WelsPSliceMdEncDynamic (pEncCtx, pSlice, kbHighestSpatial);
 }
 
@@ -892,13 +887,14 @@ int32_t InitSliceBsBuffer (SSlice* pSlice,
                            SBitStringAux* pBsWrite,
                            bool bIndependenceBsBuffer,
                            const int32_t iMaxSliceBufferSize,
-                           CMemoryAlign* pMa) {
+                           CMemoryAlign* pMa,
+                           CWelsBufferPool* pBufferPool) {
   pSlice->sSliceBs.uiSize  = iMaxSliceBufferSize;
   pSlice->sSliceBs.uiBsPos = 0;
 
   if (bIndependenceBsBuffer) {
     pSlice->pSliceBsa      = &pSlice->sSliceBs.sBsWrite;
-    pSlice->sSliceBs.pBs   = (uint8_t*)pMa->WelsMallocz (iMaxSliceBufferSize, "sSliceBs.pBs");
+    pSlice->sSliceBs.pBs   = (uint8_t*)WelsPoolMallocz (pBufferPool, pMa, iMaxSliceBufferSize, "sSliceBs.pBs");
     if (NULL == pSlice->sSliceBs.pBs) {
       return ENC_RETURN_MEMALLOCERR;
     }
@@ -910,7 +906,8 @@ int32_t InitSliceBsBuffer (SSlice* pSlice,
 }
 
 //free slice bs buffer
-void FreeSliceBuffer (SSlice*& pSliceList, const int32_t kiMaxSliceNum, CMemoryAlign* pMa, const char* kpTag) {
+void FreeSliceBuffer (SSlice*& pSliceList, const int32_t kiMaxSliceNum, CMemoryAlign* pMa,
+                      CWelsBufferPool* pBufferPool, const char* kpTag) {
   if (NULL != pSliceList) {
     int32_t iSliceIdx = 0;
     while (iSliceIdx < kiMaxSliceNum) {
@@ -919,7 +916,7 @@ void FreeSliceBuffer (SSlice*& pSliceList, const int32_t kiMaxSliceNum, CMemoryA
 
       //slice bs buffer
       if (NULL != pSlice->sSliceBs.pBs) {
-        pMa->WelsFree (pSlice->sSliceBs.pBs, "sSliceBs.pBs");
+        WelsPoolFree (pBufferPool, pMa, pSlice->sSliceBs.pBs, "sSliceBs.pBs");
         pSlice->sSliceBs.pBs = NULL;
       }
       ++ iSliceIdx;
@@ -934,7 +931,8 @@ int32_t InitSliceList (SSlice*& pSliceList,
                        const int32_t kiMaxSliceNum,
                        const int32_t kiMaxSliceBufferSize,
                        const bool bIndependenceBsBuffer,
-                       CMemoryAlign* pMa) {
+                       CMemoryAlign* pMa,
+                       CWelsBufferPool* pBufferPool) {
   int32_t iSliceIdx               = 0;
   int32_t iRet                    = 0;
 
@@ -957,7 +955,8 @@ int32_t InitSliceList (SSlice*& pSliceList,
                               pBsWrite,
                               bIndependenceBsBuffer,
                               kiMaxSliceBufferSize,
-                              pMa);
+                              pMa,
+                              pBufferPool);
     if (ENC_RETURN_SUCCESS != iRet) {
       return iRet;
     }
@@ -1051,7 +1050,8 @@ int32_t InitSliceThreadInfo (sWelsEncCtx* pCtx,
                           iMaxSliceNum,
                           pCtx->iSliceBufferSize[kiDlayerIndex],
                           pDqLayer->bSliceBsBufferFlag,
-                          pMa);
+                          pMa,
+                          pCtx->pBufferPool);
     if (ENC_RETURN_SUCCESS != iRet) {
       return iRet;
     }
@@ -1213,7 +1213,7 @@ int32_t ReallocateSliceList (sWelsEncCtx* pCtx,
   for (iSliceIdx = 0; iSliceIdx < kiMaxSliceNumOld; iSliceIdx++) {
     pSlice = pNewSliceList + iSliceIdx;
     if (NULL == pSlice) {
-      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "pSliceBuffer");
+      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "pSliceBuffer");
       return ENC_RETURN_MEMALLOCERR;
     }
 
@@ -1224,14 +1224,14 @@ int32_t ReallocateSliceList (sWelsEncCtx* pCtx,
 
   pBaseSlice = &pSliceList[0];
   if (NULL == pBaseSlice) {
-    FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "ReallocateSliceList()::InitSliceBsBuffer()");
+    FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "ReallocateSliceList()::InitSliceBsBuffer()");
     return ENC_RETURN_MEMALLOCERR;
   }
 
   for (iSliceIdx = kiMaxSliceNumOld; iSliceIdx < kiMaxSliceNumNew; iSliceIdx++) {
     pSlice = pNewSliceList + iSliceIdx;
     if (NULL == pSlice) {
-      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "pSliceBuffer");
+      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "pSliceBuffer");
       return ENC_RETURN_MEMALLOCERR;
     }
 
@@ -1244,15 +1244,16 @@ int32_t ReallocateSliceList (sWelsEncCtx* pCtx,
                               & pCtx->pOut->sBsWrite,
                               bIndependenceBsBuffer,
                               iMaxSliceBufferSize,
-                              pMA);
+                              pMA,
+                              pCtx->pBufferPool);
     if (ENC_RETURN_SUCCESS != iRet) {
-      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "pSliceBuffer");
+      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "pSliceBuffer");
       return iRet;
     }
 
     iRet = AllocateSliceMBBuffer (pSlice, pMA);
     if (ENC_RETURN_SUCCESS != iRet) {
-      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "pSliceBuffer");
+      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "pSliceBuffer");
       return iRet;
     }
 
@@ -1261,7 +1262,7 @@ int32_t ReallocateSliceList (sWelsEncCtx* pCtx,
 
     iRet = InitSliceRC (pSlice, pCtx->iGlobalQp);
     if (ENC_RETURN_SUCCESS != iRet) {
-      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, "pSliceBuffer");
+      FreeSliceBuffer(pNewSliceList, kiMaxSliceNumNew, pMA, pCtx->pBufferPool, "pSliceBuffer");
       return iRet;
     }
   }
@@ -1647,7 +1648,12 @@ int32_t WelsCodeOneSlice (sWelsEncCtx* pEncCtx, SSlice* pCurSlice, const int32_t
 
   pCurSlice->uiLastMbQp = pCurLayer->sLayerInfo.pPpsP->iPicInitQp + pCurSlice->sSliceHeaderExt.sSliceHeader.iSliceQpDelta;
 
-  int32_t iEncReturn = g_pWelsSliceCoding[pNalHeadExt->bIdrFlag][kiDynamicSliceFlag] (pEncCtx, pCurSlice);
+  int32_t iEncReturn;
+  if (WelsWavefrontEnabled (pEncCtx)) {
+    iEncReturn = pEncCtx->pWavefront->CodeSlice (pCurSlice);
+  } else {
+    iEncReturn = g_pWelsSliceCoding[pNalHeadExt->bIdrFlag][kiDynamicSliceFlag] (pEncCtx, pCurSlice);
+  }
   if (ENC_RETURN_SUCCESS != iEncReturn)
     return iEncReturn;
 
@@ -1877,6 +1883,95 @@ TRY_REENCODING:
   return iEncReturn;
 }
 
+///////////////
+//  wavefront coding of single slice layers: MD and reconstruction of MBs run on the row contexts of
+//  CWelsWavefrontEncoder, while the writing of the MBs follows in raster order on the slice itself
+///////////////
+void WelsInitSliceWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
+  if (P_SLICE == pEncCtx->eSliceType)
+    WelsInitInterMdFunc (pEncCtx);
+  if (pEncCtx->pSvcParam->iEntropyCodingModeFlag)
+    WelsInitSliceCabac (pEncCtx, pSlice);
+  pSlice->iMbSkipRun = 0;
+}
+
+void WelsInitRowMdWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pWelsMd) {
+  SWelsMD* pMd = (SWelsMD*)pWelsMd;
+
+  pMd->uiRef          = pSlice->sSliceHeaderExt.sSliceHeader.uiRefIndex;
+  pMd->bMdUsingSad    = pEncCtx->pSvcParam->iSpatialLayerNum ==
+                        (pEncCtx->pCurDqLayer->sLayerInfo.sNalHeaderExt.uiDependencyId + 1);
+  // reset on each row so that the result does not depend on which context coded the previous rows
+  memset (&pMd->sMe, 0, sizeof (pMd->sMe));
+}
+
+int32_t WelsMdMbWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pWelsMd, SMB* pCurMb) {
+  SWelsMD* pMd          = (SWelsMD*)pWelsMd;
+  SDqLayer* pCurLayer   = pEncCtx->pCurDqLayer;
+  SMbCache* pMbCache    = &pSlice->sMbCacheInfo;
+  const int32_t kiSliceFirstMbXY = pSlice->sSliceHeaderExt.sSliceHeader.iFirstMbInSlice;
+  const bool kbCavlc    = !pEncCtx->pSvcParam->iEntropyCodingModeFlag;
+  const uint8_t kuiChromaQpIndexOffset = pCurLayer->sLayerInfo.pPpsP->uiChromaQpIndexOffset;
+
+  pEncCtx->pFuncList->pfRc.pfWelsRcMbInit (pEncCtx, pCurMb, pSlice);
+  WelsMdIntraInit (pEncCtx, pCurMb, pMbCache, kiSliceFirstMbXY);
+
+  if (I_SLICE == pEncCtx->eSliceType) {
+    for (;;) {
+      pMd->iLambda = g_kiQpCostTable[pCurMb->uiLumaQp];
+      WelsMdIntraMb (pEncCtx, pMd, pCurMb, pMbCache);
+      UpdateNonZeroCountCache (pCurMb, pMbCache);
+      // the writing can not be redone here, so the CAVLC overflow is detected ahead
+      if (! (kbCavlc && (pCurMb->uiLumaQp < 50) && WelsMbResidualMayOverflowCavlc (pMbCache, pCurMb)))
+        break;
+      UpdateQpForOverflow (pCurMb, kuiChromaQpIndexOffset);
+    }
+    pCurMb->uiSliceIdc = pSlice->iSliceIdx;
+    pEncCtx->pFuncList->pfMdBackgroundInfoUpdate (pCurLayer, pCurMb, pMbCache->bCollocatedPredFlag, I_SLICE);
+  } else {
+    const int32_t kiMvdInterTableStride = pEncCtx->iMvdCostTableStride;
+    uint16_t* pMvdCostTable = &pEncCtx->pMvdCostTable[pEncCtx->iMvdCostTableSize];
+
+    WelsMdInterInit (pEncCtx, pSlice, pCurMb, kiSliceFirstMbXY);
+    for (;;) {
+      WelsInitInterMDStruc (pCurMb, pMvdCostTable, kiMvdInterTableStride, pMd);
+      pEncCtx->pFuncList->pfInterMd (pEncCtx, pMd, pSlice, pCurMb, pMbCache);
+      WelsMdInterSaveSadAndRefMbType ((pCurLayer->pDecPic->uiRefMbType), pMbCache, pCurMb, pMd);
+      pEncCtx->pFuncList->pfMdBackgroundInfoUpdate (pCurLayer, pCurMb, pMbCache->bCollocatedPredFlag,
+          pEncCtx->pRefPic->iPictureType);
+      UpdateNonZeroCountCache (pCurMb, pMbCache);
+      if (! (kbCavlc && (pCurMb->uiLumaQp < 50) && WelsMbResidualMayOverflowCavlc (pMbCache, pCurMb)))
+        break;
+      UpdateQpForOverflow (pCurMb, kuiChromaQpIndexOffset);
+    }
+    pCurMb->uiSliceIdc = pSlice->iSliceIdx;
+    OutputPMbWithoutConstructCsRsNoCopy (pEncCtx, pCurLayer, pSlice, pCurMb);
+  }
+  return ENC_RETURN_SUCCESS;
+}
+
+int32_t WelsWriteMbWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice, SMB* pCurMb, const int32_t kiCostLuma) {
+  // the bits of the MB are counted from here, as the MB init of RC did on the row context
+  pSlice->sSlicingOverRc.iBsPosSlice = pEncCtx->pFuncList->pfGetBsPosition (pSlice);
+
+  int32_t iEncReturn = pEncCtx->pFuncList->pfWelsSpatialWriteMbSyn (pEncCtx, pSlice, pCurMb);
+  if (ENC_RETURN_SUCCESS != iEncReturn)
+    return iEncReturn;
+
+#if defined(MB_TYPES_CHECK)
+  WelsCountMbType (pEncCtx->sPerInfo.iMbCount, pEncCtx->eSliceType, pCurMb);
+#endif//MB_TYPES_CHECK
+
+  pEncCtx->pFuncList->pfRc.pfWelsRcMbInfoUpdate (pEncCtx, pCurMb, kiCostLuma, pSlice);
+  return ENC_RETURN_SUCCESS;
+}
+
+void WelsFinishSliceWavefront (sWelsEncCtx* pEncCtx, SSlice* pSlice) {
+  if (pSlice->iMbSkipRun) {
+    BsWriteUE (pSlice->pSliceBsa, pSlice->iMbSkipRun);
+  }
+}
+
 // Only for inter dynamic slicing
 int32_t WelsMdInterMbLoopOverDynamicSlice (sWelsEncCtx* pEncCtx, SSlice* pSlice, void* pWelsMd,
     const int32_t kiSliceFirstMbXY) {
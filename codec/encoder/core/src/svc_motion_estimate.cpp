@@ -402,6 +402,29 @@ bool CheckDirectionalMvFalse (PSampleSadSatdCostFunc pSad, SWelsME* vpMe,
 /////////////////////////
 // Cross Search Basics
 /////////////////////////
+#define LINE_SEARCH_NSAD_BATCH (16)
+// search the candidates [iTargetPos, kiMaxPos) of a line kiStep apart with the N candidates sad
+static inline void LineSearchWithNSad (PSampleNSadCostFunc pNSad, uint8_t* pEncMb, const int32_t kiEncStride,
+                                       uint8_t* pRef, const int32_t kiRefStride, const int32_t kiStep,
+                                       int32_t iTargetPos, const int32_t kiMaxPos, const int32_t kiFixedMvd,
+                                       const uint16_t* pMvdCost, uint32_t& uiBestCost, int32_t& iBestPos) {
+  int32_t iSadCosts[LINE_SEARCH_NSAD_BATCH];
+  while (iTargetPos < kiMaxPos) {
+    const int32_t kiNum = WELS_MIN (LINE_SEARCH_NSAD_BATCH, kiMaxPos - iTargetPos);
+    pNSad (pEncMb, kiEncStride, pRef, kiRefStride, kiStep, kiNum, iSadCosts);
+    for (int32_t i = 0; i < kiNum; ++ i) {
+      const uint32_t kuiSadCost = iSadCosts[i] + (kiFixedMvd + pMvdCost[i * (1 << 2)]);
+      if (kuiSadCost < uiBestCost) {
+        uiBestCost = kuiSadCost;
+        iBestPos = iTargetPos + i;
+      }
+    }
+    pRef += kiNum * kiStep;
+    pMvdCost += kiNum * (1 << 2);
+    iTargetPos += kiNum;
+  }
+}
+
 #if defined (X86_ASM)
 void CalcMvdCostx8_c (uint16_t* pMvdCost, const int32_t kiStartMv, uint16_t* pMvdTable, const uint16_t kiFixedCost) {
   uint16_t* pBaseCost  = pMvdCost;
@@ -434,6 +457,7 @@ void VerticalFullSearchUsingSSE41 (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
   const int32_t kiEdgeBlocks = kIsBlock16x16 ? 16 : 8;
   PSampleSadHor8Func pSampleSadHor8 = pFuncList->pfSampleSadHor8[kIsBlock16x16];
   PSampleSadSatdCostFunc pSad = pFuncList->sSampleDealingFuncs.pfSampleSad[pMe->uiBlockSize];
+  PSampleNSadCostFunc pNSad = pFuncList->sSampleDealingFuncs.pfSampleNSad[pMe->uiBlockSize];
   PTransposeMatrixBlockFunc TransposeMatrixBlock = kIsBlock16x16 ? TransposeMatrixBlock16x16_sse2 :
       TransposeMatrixBlock8x8_mmx;
   PTransposeMatrixBlocksFunc TransposeMatrixBlocks = kIsBlock16x16 ? TransposeMatrixBlocksx16_sse2 :
@@ -453,7 +477,7 @@ void VerticalFullSearchUsingSSE41 (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
   TransposeMatrixBlocks (&uiMatrixRef[0][0], kiMatrixStride, pRef, kiRefStride, kiBlocksNum);
   ENFORCE_STACK_ALIGN_1D (uint16_t, uiBaseCost, 8, 16);
   int32_t iTargetPos   = iMinPos;
-  int16_t iBestPos    = pMe->sMv.iMvX;
+  int32_t iBestPos    = pMe->sMv.iMvX;
   uint32_t uiBestCost   = pMe->uiSadCost;
   uint32_t uiCostMin;
   int32_t iIndexMinPos;
@@ -475,6 +499,11 @@ void VerticalFullSearchUsingSSE41 (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
   if (kiRemainingVectors > 0) {
     kpEncMb = pMe->pEncMb;
     pRef = &pMe->pColoRefMb[ (iTargetPos - kiCurMeBlockPix) * kiRefStride];
+    if (NULL != pNSad) {
+      LineSearchWithNSad (pNSad, kpEncMb, kiEncStride, pRef, kiRefStride, kiRefStride, iTargetPos, iMaxPos, iFixedMvd,
+                          &pMvdCost[iStartMv * (1 << 2)], uiBestCost, iBestPos);
+      iTargetPos = iMaxPos;
+    }
     while (iTargetPos < iMaxPos) {
       const uint16_t uiMvdCost = pMvdCost[iStartMv * (1 << 2)];
       uint32_t uiSadCost = pSad (kpEncMb, kiEncStride, pRef, kiRefStride) + (iFixedMvd + uiMvdCost);
@@ -512,12 +541,13 @@ void HorizontalFullSearchUsingSSE41 (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
   const int32_t kIsBlock16x16 = pMe->uiBlockSize == BLOCK_16x16;
   PSampleSadHor8Func pSampleSadHor8 = pFuncList->pfSampleSadHor8[kIsBlock16x16];
   PSampleSadSatdCostFunc pSad = pFuncList->sSampleDealingFuncs.pfSampleSad[pMe->uiBlockSize];
+  PSampleNSadCostFunc pNSad = pFuncList->sSampleDealingFuncs.pfSampleNSad[pMe->uiBlockSize];
   ENFORCE_STACK_ALIGN_1D (uint16_t, uiBaseCost, 8, 16);
   const int32_t kiNumVector = iMaxPos - iMinPos;
   int32_t iCountLoop8 = kiNumVector >> 3;
   const int32_t kiRemainingLoop8 = kiNumVector & 7;
   int32_t iTargetPos   = iMinPos;
-  int16_t iBestPos    = pMe->sMv.iMvX;
+  int32_t iBestPos    = pMe->sMv.iMvX;
   uint32_t uiBestCost   = pMe->uiSadCost;
   uint32_t uiCostMin;
   int32_t iIndexMinPos;
@@ -535,6 +565,11 @@ void HorizontalFullSearchUsingSSE41 (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
     -- iCountLoop8;
   }
   if (kiRemainingLoop8 > 0) {
+    if (NULL != pNSad) {
+      LineSearchWithNSad (pNSad, kpEncMb, kiEncStride, pRef, kiRefStride, 1, iTargetPos, iMaxPos, iFixedMvd,
+                          &pMvdCost[iStartMv * (1 << 2)], uiBestCost, iBestPos);
+      iTargetPos = iMaxPos;
+    }
     while (iTargetPos < iMaxPos) {
       const uint16_t uiMvdCost = pMvdCost[iStartMv * (1 << 2)];
       uint32_t uiSadCost = pSad (kpEncMb, kiEncStride, pRef, kiRefStride) + (iFixedMvd + uiMvdCost);
@@ -561,6 +596,7 @@ void LineFullSearch_c (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
                        const int16_t iMinMv, const int16_t iMaxMv,
                        const bool bVerticalSearch) {
   PSampleSadSatdCostFunc pSad = pFuncList->sSampleDealingFuncs.pfSampleSad[pMe->uiBlockSize];
+  PSampleNSadCostFunc pNSad = pFuncList->sSampleDealingFuncs.pfSampleNSad[pMe->uiBlockSize];
   const int32_t kiCurMeBlockPixX = pMe->iCurMeBlockPixX;
   const int32_t kiCurMeBlockPixY = pMe->iCurMeBlockPixY;
   int32_t iMinPos, iMaxPos;
@@ -588,15 +624,20 @@ void LineFullSearch_c (SWelsFuncPtrList* pFuncList, SWelsME* pMe,
   uint32_t uiBestCost    = 0xFFFFFFFF;
   int32_t iBestPos       = 0;
 
-  for (int32_t iTargetPos = iMinPos; iTargetPos < iMaxPos; ++ iTargetPos) {
-    uint8_t* const kpEncMb  = pMe->pEncMb;
-    uint32_t uiSadCost = pSad (kpEncMb, kiEncStride, pRef, kiRefStride) + (iFixedMvd + *pMvdCost);
-    if (uiSadCost < uiBestCost) {
-      uiBestCost  = uiSadCost;
-      iBestPos  = iTargetPos;
+  if (NULL != pNSad) {
+    LineSearchWithNSad (pNSad, pMe->pEncMb, kiEncStride, pRef, kiRefStride, iStride, iMinPos, iMaxPos, iFixedMvd,
+                        pMvdCost, uiBestCost, iBestPos);
+  } else {
+    for (int32_t iTargetPos = iMinPos; iTargetPos < iMaxPos; ++ iTargetPos) {
+      uint8_t* const kpEncMb  = pMe->pEncMb;
+      uint32_t uiSadCost = pSad (kpEncMb, kiEncStride, pRef, kiRefStride) + (iFixedMvd + *pMvdCost);
+      if (uiSadCost < uiBestCost) {
+        uiBestCost  = uiSadCost;
+        iBestPos  = iTargetPos;
+      }
+      pRef += iStride;
+      pMvdCost += 4;
     }
-    pRef += iStride;
-    pMvdCost += 4;
   }
 
   if (uiBestCost < pMe->uiSadCost) {
@@ -650,21 +691,53 @@ int32_t RequestFeatureSearchPreparation (CMemoryAlign* pMa, const int32_t kiFram
     iListOfFeatureOfBlock = sizeof (uint16_t) * kiFrameSize +
                             (kiFrameWidth - kiMarginSize) * sizeof (uint32_t) + kiFrameWidth * 8 * sizeof (uint8_t);
   }
+  const int32_t kiListSize = (0 == kiFeatureStrategyIndex) ? (bFme8x8 ? LIST_SIZE_SUM_8x8 : LIST_SIZE_SUM_16x16) : 256;
+
+  pFeatureSearchPreparation->pRefLuma = NULL;
+  pFeatureSearchPreparation->pTimesOfFeatureValue = NULL;
+  pFeatureSearchPreparation->pRowChanged = NULL;
   pFeatureSearchPreparation->pFeatureOfBlock =
     (uint16_t*)pMa->WelsMallocz (iListOfFeatureOfBlock, "pFeatureOfBlock");
   WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == (pFeatureSearchPreparation->pFeatureOfBlock))
+  pFeatureSearchPreparation->pRefLuma = (uint8_t*)pMa->WelsMalloc (kiFrameWidth * kiFrameHeight, "pRefLuma");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == (pFeatureSearchPreparation->pRefLuma))
+  pFeatureSearchPreparation->pTimesOfFeatureValue = (uint32_t*)pMa->WelsMalloc (kiListSize * sizeof (uint32_t),
+      "pFeatureSearchPreparation->pTimesOfFeatureValue");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == (pFeatureSearchPreparation->pTimesOfFeatureValue))
+  pFeatureSearchPreparation->pRowChanged = (uint8_t*)pMa->WelsMalloc (kiFrameHeight, "pRowChanged");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == (pFeatureSearchPreparation->pRowChanged))
 
   pFeatureSearchPreparation->uiFeatureStrategyIndex = kiFeatureStrategyIndex;
   pFeatureSearchPreparation->bFMESwitchFlag = true;
   pFeatureSearchPreparation->uiFMEGoodFrameCount = FMESWITCH_DEFAULT_GOODFRAME_NUM;
   pFeatureSearchPreparation->iHighFreMbCount = 0;
+  pFeatureSearchPreparation->iFrameWidth = kiFrameWidth;
+  pFeatureSearchPreparation->iFrameHeight = kiFrameHeight;
+  pFeatureSearchPreparation->iListSize = kiListSize;
+  pFeatureSearchPreparation->bRefLumaValid = false;
+  pFeatureSearchPreparation->iScrollMvY[0] = pFeatureSearchPreparation->iScrollMvY[1] = 0;
 
   return ENC_RETURN_SUCCESS;
 }
-int32_t ReleaseFeatureSearchPreparation (CMemoryAlign* pMa, uint16_t*& pFeatureOfBlock) {
-  if (pMa && pFeatureOfBlock) {
-    pMa->WelsFree (pFeatureOfBlock, "pFeatureOfBlock");
-    pFeatureOfBlock = NULL;
+int32_t ReleaseFeatureSearchPreparation (CMemoryAlign* pMa, SFeatureSearchPreparation* pFeatureSearchPreparation) {
+  if (pMa && pFeatureSearchPreparation) {
+    if (pFeatureSearchPreparation->pFeatureOfBlock) {
+      pMa->WelsFree (pFeatureSearchPreparation->pFeatureOfBlock, "pFeatureOfBlock");
+      pFeatureSearchPreparation->pFeatureOfBlock = NULL;
+    }
+    if (pFeatureSearchPreparation->pRefLuma) {
+      pMa->WelsFree (pFeatureSearchPreparation->pRefLuma, "pRefLuma");
+      pFeatureSearchPreparation->pRefLuma = NULL;
+    }
+    if (pFeatureSearchPreparation->pTimesOfFeatureValue) {
+      pMa->WelsFree (pFeatureSearchPreparation->pTimesOfFeatureValue, "pFeatureSearchPreparation->pTimesOfFeatureValue");
+      pFeatureSearchPreparation->pTimesOfFeatureValue = NULL;
+    }
+    if (pFeatureSearchPreparation->pRowChanged) {
+      pMa->WelsFree (pFeatureSearchPreparation->pRowChanged, "pRowChanged");
+      pFeatureSearchPreparation->pRowChanged = NULL;
+    }
+    pFeatureSearchPreparation->bRefLumaValid = false;
     return ENC_RETURN_SUCCESS;
   }
   return ENC_RETURN_UNEXPECTED;
@@ -830,7 +903,137 @@ void FillQpelLocationByFeatureValue_c (uint16_t* pFeatureOfBlock, const int32_t
   }
 }
 
+// recalculate the feature rows [kiFirstRow, kiEndRow), the times of the values replaced are taken off if kbCounted
+static inline void RecalculateFeatureRows (SWelsFuncPtrList* pFunc, uint8_t* pRefData, const int32_t kiRefStride,
+    const int32_t kiWidth, const int32_t kiIs16x16, const int32_t kiFirstRow, const int32_t kiEndRow, const bool kbCounted,
+    uint16_t* pFeatureOfBlock, uint32_t* pTimesOfFeatureValue) {
+  uint16_t* pFeature = pFeatureOfBlock + kiFirstRow * kiWidth;
+  if (kbCounted) {
+    const int32_t kiNum = (kiEndRow - kiFirstRow) * kiWidth;
+    for (int32_t i = 0; i < kiNum; i++)
+      pTimesOfFeatureValue[pFeature[i]]--;
+  }
+  (pFunc->pfCalculateBlockFeatureOfFrame[kiIs16x16]) (pRefData + kiFirstRow * kiRefStride, kiWidth,
+      kiEndRow - kiFirstRow, kiRefStride, pFeature, pTimesOfFeatureValue);
+}
+
+// shift of the luma rows between pRefLuma and the reference, among the vertical scroll detected, 0 if not scrolled
+static int32_t DetectRefLumaShift (SFeatureSearchPreparation* pFeatureSearchPreparation, uint8_t* pRefData,
+                                   const int32_t kiRefStride, const int32_t kiHeight) {
+  const int32_t kiLumaWidth = pFeatureSearchPreparation->iFrameWidth;
+  const int32_t kiLumaHeight = pFeatureSearchPreparation->iFrameHeight;
+  const int32_t kiSampleStep = 16;
+  int32_t iBestShift = 0;
+  int32_t iBestMatch = 0;
+  for (int32_t i = -1; i < 4; i++) {
+    // the current frame is not scrolled as the previous one against their references, so both are tried in both ways
+    const int32_t kiShift = (i < 0) ? 0 : ((i & 1) ? -pFeatureSearchPreparation->iScrollMvY[i >> 1] :
+                                           pFeatureSearchPreparation->iScrollMvY[i >> 1]);
+    if ((i >= 0 && (0 == kiShift || kiShift == iBestShift)) || WELS_ABS (kiShift) >= WELS_MIN (kiHeight, kiLumaHeight >> 1))
+      continue;
+    int32_t iMatch = 0;
+    for (int32_t y = WELS_MAX (0, -kiShift); y < WELS_MIN (kiLumaHeight, kiLumaHeight - kiShift); y += kiSampleStep) {
+      if (0 == memcmp (pRefData + y * kiRefStride, pFeatureSearchPreparation->pRefLuma + (y + kiShift) * kiLumaWidth,
+                       kiLumaWidth))
+        iMatch++;
+    }
+    if (iMatch > iBestMatch) {
+      iBestMatch = iMatch;
+      iBestShift = kiShift;
+    }
+  }
+  return iBestShift;
+}
+
+// shift pRefLuma and the features of it, the rows uncovered are calculated from the reference
+static void ShiftFeatureOfBlock (SWelsFuncPtrList* pFunc, uint8_t* pRefData, const int32_t kiRefStride,
+                                 const int32_t kiWidth, const int32_t kiHeight, const int32_t kiIs16x16, const int32_t kiShift,
+                                 SFeatureSearchPreparation* pFeatureSearchPreparation) {
+  uint16_t* pFeatureOfBlock = pFeatureSearchPreparation->pFeatureOfBlock;
+  uint32_t* pTimesOfFeatureValue = pFeatureSearchPreparation->pTimesOfFeatureValue;
+  uint8_t* pRefLuma = pFeatureSearchPreparation->pRefLuma;
+  const int32_t kiLumaWidth = pFeatureSearchPreparation->iFrameWidth;
+  const int32_t kiLumaHeight = pFeatureSearchPreparation->iFrameHeight;
+  const int32_t kiAbsShift = WELS_ABS (kiShift);
+  // the rows shifted out are not counted any more
+  const int32_t kiDroppedRow = (kiShift > 0) ? 0 : (kiHeight - kiAbsShift);
+  for (int32_t i = kiDroppedRow * kiWidth; i < (kiDroppedRow + kiAbsShift) * kiWidth; i++)
+    pTimesOfFeatureValue[pFeatureOfBlock[i]]--;
+  if (kiShift > 0) {
+    memmove (pFeatureOfBlock, pFeatureOfBlock + kiAbsShift * kiWidth, (kiHeight - kiAbsShift) * kiWidth * sizeof (uint16_t));
+    memmove (pRefLuma, pRefLuma + kiAbsShift * kiLumaWidth, (kiLumaHeight - kiAbsShift) * kiLumaWidth);
+    memset (pFeatureSearchPreparation->pRowChanged + kiLumaHeight - kiAbsShift, 1, kiAbsShift);
+    RecalculateFeatureRows (pFunc, pRefData, kiRefStride, kiWidth, kiIs16x16, kiHeight - kiAbsShift, kiHeight, false,
+                            pFeatureOfBlock, pTimesOfFeatureValue);
+  } else {
+    memmove (pFeatureOfBlock + kiAbsShift * kiWidth, pFeatureOfBlock, (kiHeight - kiAbsShift) * kiWidth * sizeof (uint16_t));
+    memmove (pRefLuma + kiAbsShift * kiLumaWidth, pRefLuma, (kiLumaHeight - kiAbsShift) * kiLumaWidth);
+    memset (pFeatureSearchPreparation->pRowChanged, 1, kiAbsShift);
+    RecalculateFeatureRows (pFunc, pRefData, kiRefStride, kiWidth, kiIs16x16, 0, kiAbsShift, false,
+                            pFeatureOfBlock, pTimesOfFeatureValue);
+  }
+}
+
+// calculate the features of the reference in pFeatureSearchPreparation, only the rows of the blocks changed since the
+// reference calculated last are calculated again
+static void UpdateFeatureOfBlock (SWelsFuncPtrList* pFunc, uint8_t* pRefData, const int32_t kiRefStride,
+                                  const int32_t kiWidth, const int32_t kiHeight, const int32_t kiIs16x16,
+                                  SFeatureSearchPreparation* pFeatureSearchPreparation) {
+  uint16_t* pFeatureOfBlock = pFeatureSearchPreparation->pFeatureOfBlock;
+  uint32_t* pTimesOfFeatureValue = pFeatureSearchPreparation->pTimesOfFeatureValue;
+  uint8_t* pRefLuma = pFeatureSearchPreparation->pRefLuma;
+  uint8_t* pRowChanged = pFeatureSearchPreparation->pRowChanged;
+  const int32_t kiLumaWidth = pFeatureSearchPreparation->iFrameWidth;
+  const int32_t kiLumaHeight = pFeatureSearchPreparation->iFrameHeight;
+  const int32_t kiBlockSize = kiIs16x16 ? 16 : 8;
+  int32_t y;
+
+  if (!pFeatureSearchPreparation->bRefLumaValid) {
+    memset (pTimesOfFeatureValue, 0, sizeof (uint32_t) * pFeatureSearchPreparation->iListSize);
+    RecalculateFeatureRows (pFunc, pRefData, kiRefStride, kiWidth, kiIs16x16, 0, kiHeight, false, pFeatureOfBlock,
+                            pTimesOfFeatureValue);
+    for (y = 0; y < kiLumaHeight; y++)
+      memcpy (pRefLuma + y * kiLumaWidth, pRefData + y * kiRefStride, kiLumaWidth);
+    pFeatureSearchPreparation->bRefLumaValid = true;
+    return;
+  }
+
+  memset (pRowChanged, 0, kiLumaHeight);
+  const int32_t kiShift = DetectRefLumaShift (pFeatureSearchPreparation, pRefData, kiRefStride, kiHeight);
+  if (kiShift) {
+    ShiftFeatureOfBlock (pFunc, pRefData, kiRefStride, kiWidth, kiHeight, kiIs16x16, kiShift, pFeatureSearchPreparation);
+  }
+  for (y = 0; y < kiLumaHeight; y++) {
+    if (!pRowChanged[y])
+      pRowChanged[y] = (0 != memcmp (pRefData + y * kiRefStride, pRefLuma + y * kiLumaWidth, kiLumaWidth));
+  }
+
+  // a feature row is calculated again when any of the block rows is changed
+  int32_t iNextChanged = 0;
+  int32_t iFirstRow = -1;
+  for (y = 0; y <= kiHeight; y++) {
+    bool bChanged = false;
+    if (y < kiHeight) {
+      while (iNextChanged < kiLumaHeight && (iNextChanged < y || !pRowChanged[iNextChanged]))
+        iNextChanged++;
+      bChanged = (iNextChanged < y + kiBlockSize);
+    }
+    if (bChanged && iFirstRow < 0) {
+      iFirstRow = y;
+    } else if (!bChanged && iFirstRow >= 0) {
+      RecalculateFeatureRows (pFunc, pRefData, kiRefStride, kiWidth, kiIs16x16, iFirstRow, y, true, pFeatureOfBlock,
+                              pTimesOfFeatureValue);
+      iFirstRow = -1;
+    }
+  }
+  for (y = 0; y < kiLumaHeight; y++) {
+    if (pRowChanged[y])
+      memcpy (pRefLuma + y * kiLumaWidth, pRefData + y * kiRefStride, kiLumaWidth);
+  }
+}
+
 bool CalculateFeatureOfBlock (SWelsFuncPtrList* pFunc, SPicture* pRef,
+                              SFeatureSearchPreparation* pFeatureSearchPreparation,
                               SScreenBlockFeatureStorage* pScreenBlockFeatureStorage) {
   uint16_t* pFeatureOfBlock = pScreenBlockFeatureStorage->pFeatureOfBlockPointer;
   uint32_t* pTimesOfFeatureValue = pScreenBlockFeatureStorage->pTimesOfFeatureValue;
@@ -850,9 +1053,17 @@ bool CalculateFeatureOfBlock (SWelsFuncPtrList* pFunc, SPicture* pRef,
   const int32_t kiHeight = pRef->iHeightInPixel - iEdgeDiscard;
   const int32_t kiActualListSize = pScreenBlockFeatureStorage->iActualListSize;
 
-  memset (pTimesOfFeatureValue, 0, sizeof (int32_t)*kiActualListSize);
-  (pFunc->pfCalculateBlockFeatureOfFrame[iIs16x16]) (pRefData, iWidth, kiHeight, iRefStride, pFeatureOfBlock,
-      pTimesOfFeatureValue);
+  if (NULL != pFeatureSearchPreparation->pRefLuma && pRef->iWidthInPixel == pFeatureSearchPreparation->iFrameWidth
+      && pRef->iHeightInPixel == pFeatureSearchPreparation->iFrameHeight
+      && kiActualListSize == pFeatureSearchPreparation->iListSize) {
+    UpdateFeatureOfBlock (pFunc, pRefData, iRefStride, iWidth, kiHeight, iIs16x16, pFeatureSearchPreparation);
+    memcpy (pTimesOfFeatureValue, pFeatureSearchPreparation->pTimesOfFeatureValue, sizeof (uint32_t) * kiActualListSize);
+  } else {
+    pFeatureSearchPreparation->bRefLumaValid = false;
+    memset (pTimesOfFeatureValue, 0, sizeof (int32_t)*kiActualListSize);
+    (pFunc->pfCalculateBlockFeatureOfFrame[iIs16x16]) (pRefData, iWidth, kiHeight, iRefStride, pFeatureOfBlock,
+        pTimesOfFeatureValue);
+  }
 
   //assign pLocationOfFeature pointer
   pFunc->pfInitializeHashforFeature (pTimesOfFeatureValue, pBuf, kiActualListSize,
@@ -864,11 +1075,11 @@ bool CalculateFeatureOfBlock (SWelsFuncPtrList* pFunc, SPicture* pRef,
   return true;
 }
 
-void PerformFMEPreprocess (SWelsFuncPtrList* pFunc, SPicture* pRef, uint16_t* pFeatureOfBlock,
+void PerformFMEPreprocess (SWelsFuncPtrList* pFunc, SPicture* pRef, SFeatureSearchPreparation* pFeatureSearchPreparation,
                            SScreenBlockFeatureStorage* pScreenBlockFeatureStorage) {
-  pScreenBlockFeatureStorage->pFeatureOfBlockPointer = pFeatureOfBlock;
+  pScreenBlockFeatureStorage->pFeatureOfBlockPointer = pFeatureSearchPreparation->pFeatureOfBlock;
   pScreenBlockFeatureStorage->bRefBlockFeatureCalculated = CalculateFeatureOfBlock (pFunc, pRef,
-      pScreenBlockFeatureStorage);
+      pFeatureSearchPreparation, pScreenBlockFeatureStorage);
 
   if (pScreenBlockFeatureStorage->bRefBlockFeatureCalculated) {
     uint32_t uiRefPictureAvgQstepx16 = QStepx16ByQp[WelsMedian (0, pRef->iFrameAverageQp, 51)];
@@ -1083,5 +1294,92 @@ void WelsDiamondCrossFeatureSearch (SWelsFuncPtrList* pFunc, SWelsME* pMe, SSlic
 }
 
 
+/////////////////////////
+// Hierarchical Motion Search
+/////////////////////////
+#define HME_STEP_NUM (8) // steps of the small diamond, each moves the mv by one pel of the 1/4 scale
+// evaluates the block at ksMv, the mv length is the cost of the motion field irregularity
+static inline void HmeCheckMv (PSampleSadSatdCostFunc pSad, uint8_t* pCur, const int32_t kiCurStride,
+                               uint8_t* pRef, const int32_t kiRefStride, const SMVUnitXY ksMv, SMVUnitXY& sBestMv,
+                               int32_t& iBestCost) {
+  const int32_t kiCost = pSad (pCur, kiCurStride, pRef + ksMv.iMvY * kiRefStride + ksMv.iMvX, kiRefStride)
+                         + WELS_ABS (ksMv.iMvX) + WELS_ABS (ksMv.iMvY);
+  if (kiCost < iBestCost) {
+    iBestCost = kiCost;
+    sBestMv = ksMv;
+  }
+}
+
+void WelsHierarchicalMotionSearch (SWelsFuncPtrList* pFuncList, SDqLayer* pCurDqLayer, const bool kbPSlice) {
+  pCurDqLayer->bHmeMvValid = false;
+  if (!kbPSlice || NULL == pCurDqLayer->pHmeMv || NULL == pCurDqLayer->pRefPic)
+    return;
+  const SHmePyramid* kpCur = pCurDqLayer->pDecPic->pHmePyramid;
+  const SHmePyramid* kpRef = pCurDqLayer->pRefPic->pHmePyramid;
+  if (NULL == kpCur || NULL == kpRef || !kpCur->bValid || !kpRef->bValid
+      || kpCur->iWidth[0] != kpRef->iWidth[0] || kpCur->iHeight[0] != kpRef->iHeight[0])
+    return;
+
+  static const int8_t kiDiamondX[4] = { 0, 0, -1, 1 };
+  static const int8_t kiDiamondY[4] = { -1, 1, 0, 0 };
+  PSampleSadSatdCostFunc pSad = pFuncList->sSampleDealingFuncs.pfSampleSad[BLOCK_4x4];
+  const int32_t kiMbWidth  = pCurDqLayer->iMbWidth;
+  const int32_t kiMbHeight = pCurDqLayer->iMbHeight;
+  const int32_t kiStride   = kpCur->iStride[0][0];
+  SMVUnitXY* pHmeMv = pCurDqLayer->pHmeMv;
+
+  for (int32_t iMbY = 0; iMbY < kiMbHeight; ++ iMbY) {
+    for (int32_t iMbX = 0; iMbX < kiMbWidth; ++ iMbX) {
+      // 1/4 scale: the MB is a 4x4 block
+      const int32_t kiMbXy = iMbY * kiMbWidth + iMbX;
+      const int32_t kiPosX = iMbX << 2;
+      const int32_t kiPosY = iMbY << 2;
+      SMVUnitXY sMinMv, sMaxMv, sMv, sBestMv;
+      sMinMv.iMvX = -kiPosX;
+      sMinMv.iMvY = -kiPosY;
+      sMaxMv.iMvX = kpCur->iWidth[0] - 3 - kiPosX; // exclusive, as CheckMvInRange takes it
+      sMaxMv.iMvY = kpCur->iHeight[0] - 3 - kiPosY;
+      uint8_t* pCur = kpCur->pPlane[0][0] + kiPosY * kiStride + kiPosX;
+      uint8_t* pRef = kpRef->pPlane[0][0] + kiPosY * kiStride + kiPosX;
+      int32_t iBestCost = INT_MAX;
+      sBestMv.iMvX = sBestMv.iMvY = 0;
+      HmeCheckMv (pSad, pCur, kiStride, pRef, kiStride, sBestMv, sBestMv, iBestCost);
+
+      // the candidates are the mv this MB got in the previous picture, still in pHmeMv till it is overwritten below,
+      // and the mvs of the left, top and top-right MBs of this picture; they are stored in quarter pel of the full
+      // resolution, so >> 4 back to the 1/4 scale
+      const int32_t kiCandidates[4] = { kiMbXy, iMbX > 0 ? kiMbXy - 1 : -1, iMbY > 0 ? kiMbXy - kiMbWidth : -1,
+                                        (iMbY > 0 && iMbX < kiMbWidth - 1) ? kiMbXy - kiMbWidth + 1 : -1
+                                      };
+      for (int32_t i = 0; i < 4; ++ i) {
+        if (kiCandidates[i] < 0)
+          continue;
+        sMv.iMvX = pHmeMv[kiCandidates[i]].iMvX >> 4;
+        sMv.iMvY = pHmeMv[kiCandidates[i]].iMvY >> 4;
+        if ((sMv.iMvX != sBestMv.iMvX || sMv.iMvY != sBestMv.iMvY) && CheckMvInRange (sMv, sMinMv, sMaxMv))
+          HmeCheckMv (pSad, pCur, kiStride, pRef, kiStride, sMv, sBestMv, iBestCost);
+      }
+
+      // then the small diamond around the best till it stays in the middle
+      for (int32_t iStep = 0; iStep < HME_STEP_NUM; ++ iStep) {
+        const SMVUnitXY ksCenter = sBestMv;
+        for (int32_t i = 0; i < 4; ++ i) {
+          sMv.iMvX = ksCenter.iMvX + kiDiamondX[i];
+          sMv.iMvY = ksCenter.iMvY + kiDiamondY[i];
+          if (CheckMvInRange (sMv, sMinMv, sMaxMv))
+            HmeCheckMv (pSad, pCur, kiStride, pRef, kiStride, sMv, sBestMv, iBestCost);
+        }
+        if (ksCenter.iMvX == sBestMv.iMvX && ksCenter.iMvY == sBestMv.iMvY)
+          break;
+      }
+
+      // full resolution in quarter pel
+      pHmeMv[kiMbXy].iMvX = sBestMv.iMvX * (1 << 4);
+      pHmeMv[kiMbXy].iMvY = sBestMv.iMvY * (1 << 4);
+    }
+  }
+  pCurDqLayer->bHmeMvValid = true;
+}
+
 } // namespace WelsEnc
 
@@ -419,4 +419,56 @@ int32_t WelsWriteMbResidual (SWelsFuncPtrList* pFuncList, SMbCache* sMbCacheInfo
   return 0;
 }
 
+// checks the levels WelsWriteMbResidual() would write, levels below 1032 always fit the 12 bits suffix of
+// level_prefix 15, so a MB passing the check never overflows in CAVLC writing
+bool WelsMbResidualMayOverflowCavlc (SMbCache* sMbCacheInfo, SMB* pCurMb) {
+  const int32_t kiMaxLevel      = 1031;
+  const Mb_Type kuiMbType       = pCurMb->uiMbType;
+  const int32_t kiCbpChroma     = pCurMb->uiCbp >> 4;
+  const int32_t kiCbpLuma       = pCurMb->uiCbp & 0x0F;
+  const int8_t* kpNonZeroCount  = sMbCacheInfo->iNonZeroCoeffCount;
+  const SDCTCoeff* kpDct        = sMbCacheInfo->pDct;
+  int32_t i, j;
+
+  if (IS_SKIP (kuiMbType) || (0 == pCurMb->uiCbp && !IS_INTRA16x16 (kuiMbType)))
+    return false;
+
+  if (IS_INTRA16x16 (kuiMbType)) {
+    for (j = 0; j < 16; j++) {
+      if (WELS_ABS (kpDct->iLumaI16x16Dc[j]) > kiMaxLevel)
+        return true;
+    }
+  }
+  if (kiCbpLuma) {
+    for (i = 0; i < 16; i++) {
+      // blocks are stored in the same order as the 8x8 scan used by WelsWriteMbResidual()
+      if ((IS_INTRA16x16 (kuiMbType) || (kiCbpLuma & (1 << (i >> 2))))
+          && kpNonZeroCount[g_kuiCache48CountScan4Idx[i]] > 0) {
+        for (j = 0; j < 16; j++) {
+          if (WELS_ABS (kpDct->iLumaBlock[i][j]) > kiMaxLevel)
+            return true;
+        }
+      }
+    }
+  }
+  if (kiCbpChroma) {
+    for (j = 0; j < 4; j++) {
+      if (WELS_ABS (kpDct->iChromaDc[0][j]) > kiMaxLevel || WELS_ABS (kpDct->iChromaDc[1][j]) > kiMaxLevel)
+        return true;
+    }
+    if (kiCbpChroma & 0x02) {
+      for (i = 0; i < 8; i++) {
+        // Cr counts are 24 entries after the Cb ones
+        if (kpNonZeroCount[g_kuiCache48CountScan4Idx[16 + (i & 0x03)] + ((i >> 2) * 24)] > 0) {
+          for (j = 0; j < 16; j++) {
+            if (WELS_ABS (kpDct->iChromaBlock[i][j]) > kiMaxLevel)
+              return true;
+          }
+        }
+      }
+    }
+  }
+  return false;
+}
+
 } // namespace WelsEnc
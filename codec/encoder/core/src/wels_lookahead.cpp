@@ -0,0 +1,213 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_lookahead.cpp
+ *
+ * \brief   lookahead analysis for the rate control
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "wels_lookahead.h"
+
+namespace WelsEnc {
+
+CWelsLookahead::CWelsLookahead()
+  : m_pInterfaceVp (NULL),
+    m_pMemAlign (NULL),
+    m_iWidth (0),
+    m_iHeight (0),
+    m_iCur (0),
+    m_bHasRef (false) {
+  memset (m_pPlane, 0, sizeof (m_pPlane));
+  memset (m_iStride, 0, sizeof (m_iStride));
+  memset (&m_sVaaResult, 0, sizeof (m_sVaaResult));
+}
+
+CWelsLookahead::~CWelsLookahead() {
+  Uninit();
+}
+
+CWelsLookahead* CWelsLookahead::CreateLookahead (const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  CWelsLookahead* pLookahead = new CWelsLookahead();
+  if (NULL == pLookahead)
+    return NULL;
+  if (pLookahead->Init (kiSrcWidth, kiSrcHeight)) {
+    delete pLookahead;
+    return NULL;
+  }
+  return pLookahead;
+}
+
+void CWelsLookahead::DestroyLookahead (CWelsLookahead** ppLookahead) {
+  if (ppLookahead && *ppLookahead) {
+    delete *ppLookahead;
+    *ppLookahead = NULL;
+  }
+}
+
+int32_t CWelsLookahead::Init (const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  // half resolution, the MBs partially out of the picture are not analyzed
+  m_iWidth  = (kiSrcWidth >> 1) & ~15;
+  m_iHeight = (kiSrcHeight >> 1) & ~15;
+  if (m_iWidth < 16 || m_iHeight < 16) {
+    m_iWidth = m_iHeight = 0;
+    return 0;
+  }
+
+  WelsCreateVpInterface ((void**) &m_pInterfaceVp, WELSVP_INTERFACE_VERION);
+  m_pMemAlign = new CMemoryAlign (16);
+  if (NULL == m_pInterfaceVp || NULL == m_pMemAlign)
+    return 1;
+
+  const int32_t kiMbNum = (m_iWidth >> 4) * (m_iHeight >> 4);
+  m_iStride[0] = WELS_ALIGN (m_iWidth, 32);
+  m_iStride[1] = m_iStride[2] = WELS_ALIGN (m_iWidth >> 1, 32);
+  for (int32_t i = 0; i < 2; i++) {
+    for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+      const int32_t kiPlaneHeight = iPlane ? (m_iHeight >> 1) : m_iHeight;
+      m_pPlane[i][iPlane] = static_cast<uint8_t*> (m_pMemAlign->WelsMallocz (m_iStride[iPlane] * kiPlaneHeight,
+                            "CWelsLookahead::m_pPlane"));
+      if (NULL == m_pPlane[i][iPlane])
+        return 1;
+    }
+  }
+  m_sVaaResult.pSad8x8 = static_cast<int32_t (*)[4]> (m_pMemAlign->WelsMallocz (kiMbNum * 4 * sizeof (int32_t),
+                         "CWelsLookahead::pSad8x8"));
+  m_sVaaResult.pSum16x16 = static_cast<int32_t*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (int32_t),
+                           "CWelsLookahead::pSum16x16"));
+  m_sVaaResult.pSumOfSquare16x16 = static_cast<int32_t*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (int32_t),
+                                   "CWelsLookahead::pSumOfSquare16x16"));
+  if (NULL == m_sVaaResult.pSad8x8 || NULL == m_sVaaResult.pSum16x16 || NULL == m_sVaaResult.pSumOfSquare16x16)
+    return 1;
+
+  SVAACalcParam sCalcParam;
+  memset (&sCalcParam, 0, sizeof (sCalcParam));
+  sCalcParam.iCalcVar    = 1;
+  sCalcParam.pCalcResult = &m_sVaaResult;
+  m_pInterfaceVp->Set (METHOD_VAA_STATISTICS, &sCalcParam);
+  Reset();
+  return 0;
+}
+
+void CWelsLookahead::Uninit() {
+  if (m_pMemAlign) {
+    for (int32_t i = 0; i < 2; i++) {
+      for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+        m_pMemAlign->WelsFree (m_pPlane[i][iPlane], "CWelsLookahead::m_pPlane");
+        m_pPlane[i][iPlane] = NULL;
+      }
+    }
+    m_pMemAlign->WelsFree (m_sVaaResult.pSad8x8, "CWelsLookahead::pSad8x8");
+    m_pMemAlign->WelsFree (m_sVaaResult.pSum16x16, "CWelsLookahead::pSum16x16");
+    m_pMemAlign->WelsFree (m_sVaaResult.pSumOfSquare16x16, "CWelsLookahead::pSumOfSquare16x16");
+    memset (&m_sVaaResult, 0, sizeof (m_sVaaResult));
+    delete m_pMemAlign;
+    m_pMemAlign = NULL;
+  }
+  if (m_pInterfaceVp) {
+    WelsDestroyVpInterface (m_pInterfaceVp, WELSVP_INTERFACE_VERION);
+    m_pInterfaceVp = NULL;
+  }
+}
+
+void CWelsLookahead::Reset() {
+  m_iCur    = 0;
+  m_bHasRef = false;
+}
+
+int64_t CWelsLookahead::Analyze (const SSourcePicture* kpSrcPic) {
+  if (0 == m_iWidth || NULL == kpSrcPic || kpSrcPic->iPicWidth <= m_iWidth || kpSrcPic->iPicHeight <= m_iHeight) {
+    Reset();
+    return 0;
+  }
+
+  SPixMap sSrcPixMap;
+  SPixMap sCurPixMap;
+  SPixMap sRefPixMap;
+  memset (&sSrcPixMap, 0, sizeof (sSrcPixMap));
+  memset (&sCurPixMap, 0, sizeof (sCurPixMap));
+  for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+    sSrcPixMap.pPixel[iPlane]  = kpSrcPic->pData[iPlane];
+    sSrcPixMap.iStride[iPlane] = kpSrcPic->iStride[iPlane];
+    sCurPixMap.pPixel[iPlane]  = m_pPlane[m_iCur][iPlane];
+    sCurPixMap.iStride[iPlane] = m_iStride[iPlane];
+  }
+  sSrcPixMap.iSizeInBits       = sizeof (uint8_t) * 8;
+  sSrcPixMap.sRect.iRectWidth  = kpSrcPic->iPicWidth;
+  sSrcPixMap.sRect.iRectHeight = kpSrcPic->iPicHeight;
+  sSrcPixMap.eFormat           = VIDEO_FORMAT_I420;
+  sCurPixMap.iSizeInBits       = sizeof (uint8_t) * 8;
+  sCurPixMap.sRect.iRectWidth  = m_iWidth;
+  sCurPixMap.sRect.iRectHeight = m_iHeight;
+  sCurPixMap.eFormat           = VIDEO_FORMAT_I420;
+  if (m_pInterfaceVp->Process (METHOD_DOWNSAMPLE, &sSrcPixMap, &sCurPixMap) != RET_SUCCESS) {
+    Reset();
+    return 0;
+  }
+
+  // the first picture is compared with itself for the variances
+  sRefPixMap = sCurPixMap;
+  if (m_bHasRef) {
+    for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+      sRefPixMap.pPixel[iPlane] = m_pPlane[1 - m_iCur][iPlane];
+    }
+  }
+  m_pInterfaceVp->Process (METHOD_VAA_STATISTICS, &sCurPixMap, &sRefPixMap);
+
+  const int32_t kiMbNum = (m_iWidth >> 4) * (m_iHeight >> 4);
+  int64_t iCost = 0;
+  for (int32_t i = 0; i < kiMbNum; i++) {
+    // sum of the absolute deviations approximated by 256 times the standard deviation
+    const int64_t kiSum         = m_sVaaResult.pSum16x16[i];
+    const int64_t kiSumOfSquare = m_sVaaResult.pSumOfSquare16x16[i];
+    const int64_t kiSquareDev   = WELS_MAX (0, (kiSumOfSquare << 8) - kiSum * kiSum);
+    const int32_t kiIntraCost = static_cast<int32_t> (sqrt (static_cast<double> (kiSquareDev)));
+    if (m_bHasRef) {
+      const int32_t kiInterCost = m_sVaaResult.pSad8x8[i][0] + m_sVaaResult.pSad8x8[i][1] + m_sVaaResult.pSad8x8[i][2] +
+                                  m_sVaaResult.pSad8x8[i][3];
+      iCost += WELS_MIN (kiIntraCost, kiInterCost);
+    } else {
+      iCost += kiIntraCost;
+    }
+  }
+
+  m_iCur    = 1 - m_iCur;
+  m_bHasRef = true;
+  return iCost;
+}
+
+} // namespace WelsEnc
@@ -53,7 +53,8 @@ namespace WelsEnc {
 
 //***** entry API declaration ************************************************************************//
 
-int32_t WelsInitScaledPic (SWelsSvcCodingParam* pParam,  Scaled_Picture*  pScaledPic, CMemoryAlign* pMemoryAlign);
+int32_t WelsInitScaledPic (SWelsSvcCodingParam* pParam,  Scaled_Picture*  pScaledPic, CMemoryAlign* pMemoryAlign,
+                           CWelsBufferPool* pBufferPool);
 bool  JudgeNeedOfScaling (SWelsSvcCodingParam* pParam, Scaled_Picture* pScaledPic);
 void    FreeScaledPic (Scaled_Picture*  pScaledPic, CMemoryAlign* pMemoryAlign);
 void  WelsMoveMemory_c (uint8_t* pDstY, uint8_t* pDstU, uint8_t* pDstV,  int32_t iDstStrideY, int32_t iDstStrideUV,
@@ -109,22 +110,53 @@ CWelsPreProcess::CWelsPreProcess (sWelsEncCtx* pEncCtx) {
   m_pInterfaceVp = NULL;
   m_bInitDone = false;
   m_pEncCtx = pEncCtx;
+  m_pPrepared = NULL;
   memset (&m_sScaledPicture, 0, sizeof (m_sScaledPicture));
+  memset (m_pLastSpatialPicture, 0, sizeof (m_pLastSpatialPicture));
+  memset (m_iLastPreparedIndex, -1, sizeof (m_iLastPreparedIndex));
   memset (m_pSpatialPic, 0, sizeof (m_pSpatialPic));
   memset (m_uiSpatialLayersInTemporal, 0, sizeof (m_uiSpatialLayersInTemporal));
   memset (m_uiSpatialPicNum, 0, sizeof (m_uiSpatialPicNum));
 }
 
 CWelsPreProcess::~CWelsPreProcess() {
-  FreeScaledPic (&m_sScaledPicture,  m_pEncCtx->pMemAlign);
+  // no encoding context for CWelsPreProcessAhead, which frees its own scaled picture
+  if (m_pEncCtx)
+    FreeScaledPic (&m_sScaledPicture,  m_pEncCtx->pMemAlign);
   WelsPreprocessDestroy();
 }
 
+void CWelsPreProcess::GetPrepareSettings (const SWelsSvcCodingParam* kpParam, SPrepareSettings* pSettings) {
+  // compared as a whole, the padding included
+  memset (pSettings, 0, sizeof (SPrepareSettings));
+  pSettings->iSrcWidth        = kpParam->SUsedPicRect.iWidth;
+  pSettings->iSrcHeight       = kpParam->SUsedPicRect.iHeight;
+  pSettings->iSpatialLayerNum = kpParam->iSpatialLayerNum;
+  for (int32_t i = 0; i < kpParam->iSpatialLayerNum; i++) {
+    pSettings->iVideoWidth[i]   = kpParam->sSpatialLayers[i].iVideoWidth;
+    pSettings->iVideoHeight[i]  = kpParam->sSpatialLayers[i].iVideoHeight;
+    pSettings->iActualWidth[i]  = kpParam->sDependencyLayers[i].iActualWidth;
+    pSettings->iActualHeight[i] = kpParam->sDependencyLayers[i].iActualHeight;
+  }
+  pSettings->iUsageType                 = kpParam->iUsageType;
+  pSettings->bEnableDenoise             = kpParam->bEnableDenoise;
+  pSettings->bEnableBackgroundDetection = kpParam->bEnableBackgroundDetection;
+  pSettings->bEnableAdaptiveQuant       = kpParam->bEnableAdaptiveQuant;
+}
+
 int32_t CWelsPreProcess::WelsPreprocessCreate() {
   if (m_pInterfaceVp == NULL) {
     WelsCreateVpInterface ((void**) &m_pInterfaceVp, WELSVP_INTERFACE_VERION);
     if (!m_pInterfaceVp)
       goto exit;
+
+    if (m_pEncCtx->pSvcParam->iMultipleThreadIdc > 1) {
+      // the strategies split the pictures into jobs on the threads of the encoding tasks
+      SVpThreadingParam sThreading;
+      sThreading.iThreadNum       = m_pEncCtx->pSvcParam->iMultipleThreadIdc;
+      sThreading.pThreadPoolParam = (void*)m_pEncCtx->pSvcParam->pThreadPoolParam;
+      m_pInterfaceVp->SpecialFeature (VP_FEATURE_THREADING, &sThreading, NULL);
+    }
   } else
     goto exit;
 
@@ -158,7 +190,7 @@ int32_t CWelsPreProcess::WelsPreprocessReset (sWelsEncCtx* pCtx, int32_t iWidth,
   if (pCtx) {
     FreeScaledPic (&m_sScaledPicture, pCtx->pMemAlign);
     iRet = InitLastSpatialPictures (pCtx);
-    iRet = WelsInitScaledPic (pCtx->pSvcParam, &m_sScaledPicture, pCtx->pMemAlign);
+    iRet = WelsInitScaledPic (pCtx->pSvcParam, &m_sScaledPicture, pCtx->pMemAlign, pCtx->pBufferPool);
   }
 
   return iRet;
@@ -180,7 +212,7 @@ int32_t CWelsPreProcess::AllocSpatialPictures (sWelsEncCtx* pCtx, SWelsSvcCoding
 
     m_uiSpatialPicNum[iDlayerIndex] = kuiRefNumInTemporal;
     do {
-      SPicture* pPic = AllocPicture (pMa, kiPicWidth, kiPicHeight, false, 0);
+      SPicture* pPic = AllocPicture (pMa, kiPicWidth, kiPicHeight, false, 0, pCtx->pBufferPool);
       WELS_VERIFY_RETURN_IF (1, (NULL == pPic))
       m_pSpatialPic[iDlayerIndex][i] = pPic;
       ++ i;
@@ -215,7 +247,8 @@ void CWelsPreProcess::FreeSpatialPictures (sWelsEncCtx* pCtx) {
   }
 }
 
-int32_t CWelsPreProcess::BuildSpatialPicList (sWelsEncCtx* pCtx, const SSourcePicture* kpSrcPic) {
+int32_t CWelsPreProcess::BuildSpatialPicList (sWelsEncCtx* pCtx, const SSourcePicture* kpSrcPic,
+    const SPreparedSource* kpPrepared) {
   SWelsSvcCodingParam* pSvcParam = pCtx->pSvcParam;
   int32_t iSpatialNum = 0;
   int32_t iWidth = ((kpSrcPic->iPicWidth >> 1) << 1);
@@ -241,6 +274,14 @@ int32_t CWelsPreProcess::BuildSpatialPicList (sWelsEncCtx* pCtx, const SSourcePi
   if (m_pInterfaceVp == NULL)
     return -1;
 
+  m_pPrepared = NULL;
+  if (kpPrepared && kpPrepared->iIndex >= 0 && pSvcParam->iUsageType != SCREEN_CONTENT_REAL_TIME) {
+    SPrepareSettings sSettings;
+    GetPrepareSettings (pSvcParam, &sSettings);
+    if (!memcmp (&sSettings, &kpPrepared->sSettings, sizeof (sSettings)))
+      m_pPrepared = kpPrepared;
+  }
+
   pCtx->pVaa->bSceneChangeFlag = pCtx->pVaa->bIdrPeriodFlag = false;
 
   iSpatialNum = SingleLayerPreprocess (pCtx, kpSrcPic, &m_sScaledPicture);
@@ -294,7 +335,8 @@ int32_t CWelsPreProcess::AnalyzeSpatialPic (sWelsEncCtx* pCtx, const int32_t kiD
     SPicture* pLastPic = m_pLastSpatialPicture[kiDidx][0];
     bool bCalculateSQDiff = ((pLastPic->pData[0] == pRefPic->pData[0]) && bNeededMbAq);
 
-    VaaCalculation (pCtx->pVaa, pCurPic, pRefPic, bCalculateSQDiff, bCalculateVar, bCalculateBGD);
+    if (bCalculateVar || !TakePreparedVaa (pCtx->pVaa, kiDidx, pCurPic, pRefPic, bCalculateSQDiff, bCalculateBGD))
+      VaaCalculation (pCtx->pVaa, pCurPic, pRefPic, bCalculateSQDiff, bCalculateVar, bCalculateBGD);
 
     if (pSvcParam->bEnableBackgroundDetection) {
       BackgroundDetection (pCtx->pVaa, pCurPic, pRefPic, bCalculateBGD && pRefPic->iPictureType != I_SLICE);
@@ -316,7 +358,22 @@ int32_t CWelsPreProcess::UpdateSpatialPictures (sWelsEncCtx* pCtx, SWelsSvcCodin
   if (pCtx->pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME)
     return 0;
 
+  if (m_iLastPreparedIndex[kiDidx][1] >= 0 && pParam->bEnableBackgroundDetection) {
+    // the background MBs are coded with the pixels of the reference copied into the picture, which then differs from
+    // the one prepared the VAA statistics of the next picture are against
+    const SPicture* kpCurPic = m_pLastSpatialPicture[kiDidx][1];
+    const int32_t kiMbNum = ((kpCurPic->iWidthInPixel + 15) >> 4) * ((kpCurPic->iHeightInPixel + 15) >> 4);
+    for (int32_t i = 0; i < kiMbNum; i++) {
+      if (pCtx->pVaa->pVaaBackgroundMbFlag[i]) {
+        m_iLastPreparedIndex[kiDidx][1] = -1;
+        break;
+      }
+    }
+  }
   WelsExchangeSpatialPictures (&m_pLastSpatialPicture[kiDidx][1], &m_pLastSpatialPicture[kiDidx][0]);
+  const int64_t kiLastPreparedIndex = m_iLastPreparedIndex[kiDidx][1];
+  m_iLastPreparedIndex[kiDidx][1] = m_iLastPreparedIndex[kiDidx][0];
+  m_iLastPreparedIndex[kiDidx][0] = kiLastPreparedIndex;
 
   const int32_t kiCurPos = GetCurPicPosition (kiDidx);
   if (iCurTid < kiCurPos || pParam->iDecompStages == 0) {
@@ -372,23 +429,37 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
   pSrcPic = pScaledPicture->pScaledInputPicture ? pScaledPicture->pScaledInputPicture : GetCurrentOrigFrame (
               iDependencyId);
 
-  WelsMoveMemoryWrapper (pSvcParam, pSrcPic, kpSrc, iSrcWidth, iSrcHeight);
-
-  if (pSvcParam->bEnableDenoise)
-    BilateralDenoising (pSrcPic, iSrcWidth, iSrcHeight);
-
-  // different scaling in between input picture and dst highest spatial picture.
   int32_t iShrinkWidth  = iSrcWidth;
   int32_t iShrinkHeight = iSrcHeight;
-  pDstPic = pSrcPic;
-  if (pScaledPicture->pScaledInputPicture) {
-    // for highest downsampling
+  if (m_pPrepared) {
+    // converted, denoised, downsampled and padded ahead of the coding
     pDstPic = GetCurrentOrigFrame (iDependencyId);
-    iShrinkWidth = pScaledPicture->iScaledWidth[iDependencyId];
-    iShrinkHeight = pScaledPicture->iScaledHeight[iDependencyId];
+    CopyPreparedPicture (m_pPrepared->pSpatialPic[iDependencyId], pDstPic);
+  } else {
+    if (VIDEO_FORMAT_I420 != (kpSrc->iColorFormat & (~VIDEO_FORMAT_VFlip))) {
+      if (ColorspaceConvert (pSvcParam, pSrcPic, kpSrc, iSrcWidth, iSrcHeight)) {
+        // nothing to encode, the caller returns the error instead of the frame
+        pCtx->iEncoderError = ENC_RETURN_INVALIDINPUT;
+        return 0;
+      }
+    } else {
+      WelsMoveMemoryWrapper (pSvcParam, pSrcPic, kpSrc, iSrcWidth, iSrcHeight);
+    }
+
+    if (pSvcParam->bEnableDenoise)
+      BilateralDenoising (pSrcPic, iSrcWidth, iSrcHeight);
+
+    // different scaling in between input picture and dst highest spatial picture.
+    pDstPic = pSrcPic;
+    if (pScaledPicture->pScaledInputPicture) {
+      // for highest downsampling
+      pDstPic = GetCurrentOrigFrame (iDependencyId);
+      iShrinkWidth = pScaledPicture->iScaledWidth[iDependencyId];
+      iShrinkHeight = pScaledPicture->iScaledHeight[iDependencyId];
+    }
+    DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth, iTargetHeight,
+                       false);
   }
-  DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth, iTargetHeight,
-                     false);
 
   if (pSvcParam->bEnableSceneChangeDetect && !pCtx->pVaa->bIdrPeriodFlag) {
     if (pSvcParam->iUsageType == SCREEN_CONTENT_REAL_TIME) {
@@ -425,6 +496,7 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
   }
 
   m_pLastSpatialPicture[iDependencyId][1] = GetCurrentOrigFrame (iDependencyId);
+  m_iLastPreparedIndex[iDependencyId][1] = m_pPrepared ? m_pPrepared->iIndex : -1;
   -- iDependencyId;
 
 
@@ -448,8 +520,11 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
       pDstPic = GetCurrentOrigFrame (iDependencyId); // small
       iShrinkWidth = pScaledPicture->iScaledWidth[iDependencyId];
       iShrinkHeight = pScaledPicture->iScaledHeight[iDependencyId];
-      DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth, iTargetHeight,
-                         true);
+      if (m_pPrepared)
+        CopyPreparedPicture (m_pPrepared->pSpatialPic[iDependencyId], pDstPic);
+      else
+        DownsamplePadding (pSrcPic, pDstPic, iSrcWidth, iSrcHeight, iShrinkWidth, iShrinkHeight, iTargetWidth,
+                           iTargetHeight, true);
 
       if ((iTemporalId != INVALID_TEMPORAL_ID)) {
         WelsUpdateSpatialIdxMap (pCtx, iActualSpatialNum, pDstPic, iDependencyId);
@@ -457,6 +532,7 @@ int32_t CWelsPreProcess::SingleLayerPreprocess (sWelsEncCtx* pCtx, const SSource
       }
 
       m_pLastSpatialPicture[iDependencyId][1] = pDstPic;
+      m_iLastPreparedIndex[iDependencyId][1] = m_pPrepared ? m_pPrepared->iIndex : -1;
 
       iClosestDid = iDependencyId;
       -- iDependencyId;
@@ -503,11 +579,12 @@ bool JudgeNeedOfScaling (SWelsSvcCodingParam* pParam, Scaled_Picture* pScaledPic
   return bNeedDownsampling;
 }
 
-int32_t  WelsInitScaledPic (SWelsSvcCodingParam* pParam,  Scaled_Picture*  pScaledPicture, CMemoryAlign* pMemoryAlign) {
+int32_t  WelsInitScaledPic (SWelsSvcCodingParam* pParam,  Scaled_Picture*  pScaledPicture, CMemoryAlign* pMemoryAlign,
+                            CWelsBufferPool* pBufferPool) {
   bool bInputPicNeedScaling = JudgeNeedOfScaling (pParam, pScaledPicture);
   if (bInputPicNeedScaling) {
     pScaledPicture->pScaledInputPicture = AllocPicture (pMemoryAlign, pParam->SUsedPicRect.iWidth,
-                                          pParam->SUsedPicRect.iHeight, false, 0);
+                                          pParam->SUsedPicRect.iHeight, false, 0, pBufferPool);
     if (pScaledPicture->pScaledInputPicture == NULL)
       return -1;
 
@@ -539,6 +616,7 @@ int32_t CWelsPreProcess::InitLastSpatialPictures (sWelsEncCtx* pCtx) {
   SWelsSvcCodingParam* pParam   = pCtx->pSvcParam;
   const int32_t kiDlayerCount   = pParam->iSpatialLayerNum;
   int32_t iDlayerIndex          = 0;
+  memset (m_iLastPreparedIndex, -1, sizeof (m_iLastPreparedIndex));
   if (pParam->iUsageType == SCREEN_CONTENT_REAL_TIME) {
     for (; iDlayerIndex < MAX_DEPENDENCY_LAYER; iDlayerIndex++) {
       m_pLastSpatialPicture[iDlayerIndex][0] = m_pLastSpatialPicture[iDlayerIndex][1] = NULL;
@@ -557,10 +635,36 @@ int32_t CWelsPreProcess::InitLastSpatialPictures (sWelsEncCtx* pCtx) {
 }
 //*********************************************************************************************************/
 
+/*
+ *  ColorspaceConvert: NV12 and 32 bit RGB sources converted straight into pDstPic, padded as the I420 copy is
+ *  @return: 0 - converted; 1 - color format not supported or picture not valid
+ */
 int32_t CWelsPreProcess::ColorspaceConvert (SWelsSvcCodingParam* pSvcParam, SPicture* pDstPic,
-    const SSourcePicture* kpSrc, const int32_t kiWidth, const int32_t kiHeight) {
-  return 1;
-  //not support yet
+    const SSourcePicture* kpSrc, const int32_t kiTargetWidth, const int32_t kiTargetHeight) {
+  const int32_t kiSrcWidth  = WELS_MIN (kpSrc->iPicWidth, kiTargetWidth) & (~1);
+  const int32_t kiSrcHeight = WELS_MIN (kpSrc->iPicHeight, kiTargetHeight) & (~1);
+  const int32_t kiSrcLeft   = pSvcParam->SUsedPicRect.iLeft;
+  const int32_t kiSrcTop    = pSvcParam->SUsedPicRect.iTop;
+  uint8_t* pDst[3]             = { pDstPic->pData[0], pDstPic->pData[1], pDstPic->pData[2] };
+  const int32_t kiDstStride[3] = { pDstPic->iLineSize[0], pDstPic->iLineSize[1], pDstPic->iLineSize[2] };
+
+  if (pDst[0] == NULL || pDst[1] == NULL || pDst[2] == NULL)
+    return 1;
+  if (kiSrcWidth <= 0 || kiSrcHeight <= 0 || (kiSrcWidth * kiSrcHeight > (MAX_MBS_PER_FRAME << 8)))
+    return 1;
+  if (kiSrcTop >= kiSrcHeight || kiSrcLeft >= kiSrcWidth)
+    return 1;
+  if (kiTargetWidth <= 0 || kiTargetHeight <= 0 || kiTargetWidth > kiDstStride[0])
+    return 1;
+  if (WelsConvertToI420 (&m_pEncCtx->pFuncList->sColorspaceConvertFunc, kpSrc, kiSrcLeft, kiSrcTop, kiSrcWidth,
+                         kiSrcHeight, pDst, kiDstStride))
+    return 1;
+
+  if (kiTargetWidth > kiSrcWidth || kiTargetHeight > kiSrcHeight) {
+    Padding (pDst[0], pDst[1], pDst[2], kiDstStride[0], kiDstStride[1], kiSrcWidth, kiTargetWidth, kiSrcHeight,
+             kiTargetHeight);
+  }
+  return 0;
 }
 
 void CWelsPreProcess::BilateralDenoising (SPicture* pSrc, const int32_t kiWidth, const int32_t kiHeight) {
@@ -614,6 +718,41 @@ SPicture* CWelsPreProcessVideo::GetCurrentOrigFrame (int32_t iDIdx) {
   return m_pSpatialPic[iDIdx][GetCurPicPosition (iDIdx)];
 }
 
+void CWelsPreProcess::BuildHmePyramid (const SPicture* kpSrcPic, SHmePyramid* pPyramid) {
+  if (NULL == pPyramid)
+    return;
+  SPixMap sSrcPixMap;
+  SPixMap sDstPixMap;
+  memset (&sSrcPixMap, 0, sizeof (sSrcPixMap));
+  memset (&sDstPixMap, 0, sizeof (sDstPixMap));
+  for (int32_t i = 0; i < 3; i++) {
+    sSrcPixMap.pPixel[i]  = kpSrcPic->pData[i];
+    sSrcPixMap.iStride[i] = kpSrcPic->iLineSize[i];
+  }
+  sSrcPixMap.iSizeInBits       = g_kiPixMapSizeInBits;
+  sSrcPixMap.sRect.iRectWidth  = pPyramid->iWidth[0] << 2;
+  sSrcPixMap.sRect.iRectHeight = pPyramid->iHeight[0] << 2;
+  sSrcPixMap.eFormat           = VIDEO_FORMAT_I420;
+
+  pPyramid->bValid = true;
+  // level 0 straight from the source (the downsampling halves it twice through its own buffer), each further one by 2
+  for (int32_t iLevel = 0; iLevel < HME_LEVEL_NUM; iLevel++) {
+    for (int32_t i = 0; i < 3; i++) {
+      sDstPixMap.pPixel[i]  = pPyramid->pPlane[iLevel][i];
+      sDstPixMap.iStride[i] = pPyramid->iStride[iLevel][i];
+    }
+    sDstPixMap.iSizeInBits       = g_kiPixMapSizeInBits;
+    sDstPixMap.sRect.iRectWidth  = pPyramid->iWidth[iLevel];
+    sDstPixMap.sRect.iRectHeight = pPyramid->iHeight[iLevel];
+    sDstPixMap.eFormat           = VIDEO_FORMAT_I420;
+    if (m_pInterfaceVp->Process (METHOD_DOWNSAMPLE, &sSrcPixMap, &sDstPixMap) != RET_SUCCESS) {
+      pPyramid->bValid = false;
+      return;
+    }
+    sSrcPixMap = sDstPixMap;
+  }
+}
+
 int32_t CWelsPreProcess::DownsamplePadding (SPicture* pSrc, SPicture* pDstPic,  int32_t iSrcWidth, int32_t iSrcHeight,
     int32_t iShrinkWidth, int32_t iShrinkHeight, int32_t iTargetWidth, int32_t iTargetHeight, bool bForceCopy) {
   int32_t iRet = 0;
@@ -696,12 +835,76 @@ void CWelsPreProcess::VaaCalculation (SVAAFrameInfo* pVaaInfo, SPicture* pCurPic
     calc_param.iCalcBgd = bCalculateBGD;
     calc_param.iCalcSsd = bCalculateSQDiff;
     calc_param.pCalcResult = &pVaaInfo->sVaaCalcInfo;
+    // the ssd is for adaptive quantization only, which takes the motion and texture index from the same pass
+    calc_param.pMotionTextureUnit = pVaaInfo->sAdaptiveQuantParam.pMotionTextureUnit;
 
     m_pInterfaceVp->Set (iMethodIdx, &calc_param);
     m_pInterfaceVp->Process (iMethodIdx, &sCurPixMap, &sRefPixMap);
   }
 }
 
+void CWelsPreProcess::CopyPreparedPicture (const SPicture* kpSrc, SPicture* pDst) {
+  // the area written by the preprocessing, the picture padded to the size of the layer
+  const int32_t kiWidth  = pDst->iWidthInPixel;
+  const int32_t kiHeight = pDst->iHeightInPixel;
+  for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+    const int32_t kiPlaneWidth  = iPlane ? ((kiWidth + 1) >> 1) : kiWidth;
+    const int32_t kiPlaneHeight = iPlane ? ((kiHeight + 1) >> 1) : kiHeight;
+    const uint8_t* pSrc = kpSrc->pData[iPlane];
+    uint8_t* pDstData = pDst->pData[iPlane];
+    for (int32_t i = 0; i < kiPlaneHeight; i++) {
+      memcpy (pDstData, pSrc, kiPlaneWidth);
+      pSrc += kpSrc->iLineSize[iPlane];
+      pDstData += pDst->iLineSize[iPlane];
+    }
+  }
+}
+
+/*
+ *  TakePreparedVaa: the VAA statistics prepared ahead if they are of the pictures compared, as VaaCalculation() gives
+ *  them with the same flags
+ *  @return: true - taken; false - to be calculated
+ */
+bool CWelsPreProcess::TakePreparedVaa (SVAAFrameInfo* pVaaInfo, const int32_t kiDidx, SPicture* pCurPicture,
+                                       SPicture* pRefPicture, bool bCalculateSQDiff, bool bCalculateBGD) {
+  if (NULL == m_pPrepared || !m_pPrepared->bVaaCalculated[kiDidx])
+    return false;
+  // the pictures copied from the prepared source and from the one prepared just before, not coded in between
+  if (pCurPicture != m_pLastSpatialPicture[kiDidx][1] || m_iLastPreparedIndex[kiDidx][1] != m_pPrepared->iIndex)
+    return false;
+  if (pRefPicture != m_pLastSpatialPicture[kiDidx][0] || m_iLastPreparedIndex[kiDidx][0] != m_pPrepared->iIndex - 1)
+    return false;
+  const SPrepareSettings& kSettings = m_pPrepared->sSettings;
+  if ((bCalculateSQDiff && !kSettings.bEnableAdaptiveQuant) || (bCalculateBGD && !kSettings.bEnableBackgroundDetection))
+    return false;
+
+  const SVAACalcResult* kpPrepared = &m_pPrepared->sVaaCalcInfo[kiDidx];
+  SVAACalcResult* pResult = &pVaaInfo->sVaaCalcInfo;
+  const int32_t kiMbNum = (pCurPicture->iWidthInPixel >> 4) * (pCurPicture->iHeightInPixel >> 4);
+  memcpy (pResult->pSad8x8, kpPrepared->pSad8x8, kiMbNum * sizeof (pResult->pSad8x8[0]));
+  if (bCalculateSQDiff) {
+    memcpy (pResult->pSum16x16, kpPrepared->pSum16x16, kiMbNum * sizeof (int32_t));
+    memcpy (pResult->pSumOfSquare16x16, kpPrepared->pSumOfSquare16x16, kiMbNum * sizeof (int32_t));
+    memcpy (pResult->pSsd16x16, kpPrepared->pSsd16x16, kiMbNum * sizeof (int32_t));
+  }
+  if (bCalculateBGD) {
+    memcpy (pResult->pSumOfDiff8x8, kpPrepared->pSumOfDiff8x8, kiMbNum * sizeof (pResult->pSumOfDiff8x8[0]));
+    memcpy (pResult->pMad8x8, kpPrepared->pMad8x8, kiMbNum * sizeof (pResult->pMad8x8[0]));
+  }
+  pResult->pCurY = pCurPicture->pData[0];
+  pResult->pRefY = pRefPicture->pData[0];
+  pResult->iFrameSad = kpPrepared->iFrameSad;
+  pResult->pMotionTextureUnit = NULL;
+  if (bCalculateSQDiff && pVaaInfo->sAdaptiveQuantParam.pMotionTextureUnit) {
+    memcpy (pVaaInfo->sAdaptiveQuantParam.pMotionTextureUnit, m_pPrepared->pMotionTextureUnit[kiDidx],
+            kiMbNum * sizeof (SMotionTextureUnit));
+    pResult->pMotionTextureUnit = pVaaInfo->sAdaptiveQuantParam.pMotionTextureUnit;
+    pResult->iMotionIndexSum = kpPrepared->iMotionIndexSum;
+    pResult->iTextureIndexSum = kpPrepared->iTextureIndexSum;
+  }
+  return true;
+}
+
 void CWelsPreProcess::BackgroundDetection (SVAAFrameInfo* pVaaInfo, SPicture* pCurPicture, SPicture* pRefPicture,
     bool bDetectFlag) {
   if (bDetectFlag) {
@@ -1445,6 +1648,192 @@ bool CWelsPreProcess::GetSceneChangeFlag (ESceneChangeIdc eSceneChangeIdc) {
   return ((eSceneChangeIdc == LARGE_CHANGED_SCENE) ? true : false);
 }
 
+//*********************************************************************************************************/
+CWelsPreProcessAhead::CWelsPreProcessAhead()
+  : CWelsPreProcessVideo (NULL),
+    m_pMemAlign (NULL),
+    m_pLastPrepared (NULL),
+    m_iIndex (0) {
+  memset (&m_sParam, 0, sizeof (m_sParam));
+  memset (&m_sSettings, 0, sizeof (m_sSettings));
+  memset (&m_sScaledPic, 0, sizeof (m_sScaledPic));
+}
+
+CWelsPreProcessAhead::~CWelsPreProcessAhead() {
+  if (m_pMemAlign) {
+    FreeScaledPic (&m_sScaledPic, m_pMemAlign);
+    delete m_pMemAlign;
+    m_pMemAlign = NULL;
+  }
+}
+
+CWelsPreProcessAhead* CWelsPreProcessAhead::CreatePreProcessAhead (const SWelsSvcCodingParam* kpParam) {
+  CWelsPreProcessAhead* pPreProcess = new CWelsPreProcessAhead();
+  if (NULL == pPreProcess)
+    return NULL;
+  if (pPreProcess->Init (kpParam)) {
+    delete pPreProcess;
+    return NULL;
+  }
+  return pPreProcess;
+}
+
+void CWelsPreProcessAhead::DestroyPreProcessAhead (CWelsPreProcessAhead** ppPreProcess) {
+  if (ppPreProcess && *ppPreProcess) {
+    delete *ppPreProcess;
+    *ppPreProcess = NULL;
+  }
+}
+
+int32_t CWelsPreProcessAhead::Init (const SWelsSvcCodingParam* kpParam) {
+  // not split into jobs on the threads of the encoding tasks, the preparation runs along with them
+  WelsCreateVpInterface ((void**) &m_pInterfaceVp, WELSVP_INTERFACE_VERION);
+  m_pMemAlign = new CMemoryAlign (16);
+  if (NULL == m_pInterfaceVp || NULL == m_pMemAlign)
+    return 1;
+  SetParam (kpParam);
+  return 0;
+}
+
+void CWelsPreProcessAhead::SetParam (const SWelsSvcCodingParam* kpParam) {
+  m_sParam = *kpParam;
+}
+
+int32_t CWelsPreProcessAhead::AllocPrepared (SPreparedSource* pPrepared, const SPrepareSettings& kSettings) {
+  FreePrepared (pPrepared);
+  pPrepared->sSettings = kSettings;
+  for (int32_t i = 0; i < kSettings.iSpatialLayerNum; i++) {
+    const int32_t kiMbNum = ((kSettings.iVideoWidth[i] + 15) >> 4) * ((kSettings.iVideoHeight[i] + 15) >> 4);
+    SVAACalcResult* pResult = &pPrepared->sVaaCalcInfo[i];
+    pPrepared->pSpatialPic[i] = AllocPicture (m_pMemAlign, kSettings.iVideoWidth[i], kSettings.iVideoHeight[i], false, 0,
+                                NULL);
+    pResult->pSad8x8 = static_cast<int32_t (*)[4]> (m_pMemAlign->WelsMallocz (kiMbNum * 4 * sizeof (int32_t),
+                       "pPrepared->sVaaCalcInfo.pSad8x8"));
+    pResult->pSsd16x16 = static_cast<int32_t*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (int32_t),
+                         "pPrepared->sVaaCalcInfo.pSsd16x16"));
+    pResult->pSum16x16 = static_cast<int32_t*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (int32_t),
+                         "pPrepared->sVaaCalcInfo.pSum16x16"));
+    pResult->pSumOfSquare16x16 = static_cast<int32_t*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (int32_t),
+                                 "pPrepared->sVaaCalcInfo.pSumOfSquare16x16"));
+    pResult->pSumOfDiff8x8 = static_cast<int32_t (*)[4]> (m_pMemAlign->WelsMallocz (kiMbNum * 4 * sizeof (int32_t),
+                             "pPrepared->sVaaCalcInfo.pSumOfDiff8x8"));
+    pResult->pMad8x8 = static_cast<uint8_t (*)[4]> (m_pMemAlign->WelsMallocz (kiMbNum * 4 * sizeof (uint8_t),
+                       "pPrepared->sVaaCalcInfo.pMad8x8"));
+    pPrepared->pMotionTextureUnit[i] = static_cast<SMotionTextureUnit*> (m_pMemAlign->WelsMallocz (kiMbNum * sizeof (
+                                         SMotionTextureUnit), "pPrepared->pMotionTextureUnit"));
+    if (NULL == pPrepared->pSpatialPic[i] || NULL == pResult->pSad8x8 || NULL == pResult->pSsd16x16
+        || NULL == pResult->pSum16x16 || NULL == pResult->pSumOfSquare16x16 || NULL == pResult->pSumOfDiff8x8
+        || NULL == pResult->pMad8x8 || NULL == pPrepared->pMotionTextureUnit[i]) {
+      FreePrepared (pPrepared);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+void CWelsPreProcessAhead::FreePrepared (SPreparedSource* pPrepared) {
+  if (pPrepared == m_pLastPrepared)
+    m_pLastPrepared = NULL;
+  for (int32_t i = 0; i < MAX_DEPENDENCY_LAYER; i++) {
+    SVAACalcResult* pResult = &pPrepared->sVaaCalcInfo[i];
+    if (pPrepared->pSpatialPic[i])
+      FreePicture (m_pMemAlign, &pPrepared->pSpatialPic[i]);
+    m_pMemAlign->WelsFree (pResult->pSad8x8, "pPrepared->sVaaCalcInfo.pSad8x8");
+    m_pMemAlign->WelsFree (pResult->pSsd16x16, "pPrepared->sVaaCalcInfo.pSsd16x16");
+    m_pMemAlign->WelsFree (pResult->pSum16x16, "pPrepared->sVaaCalcInfo.pSum16x16");
+    m_pMemAlign->WelsFree (pResult->pSumOfSquare16x16, "pPrepared->sVaaCalcInfo.pSumOfSquare16x16");
+    m_pMemAlign->WelsFree (pResult->pSumOfDiff8x8, "pPrepared->sVaaCalcInfo.pSumOfDiff8x8");
+    m_pMemAlign->WelsFree (pResult->pMad8x8, "pPrepared->sVaaCalcInfo.pMad8x8");
+    m_pMemAlign->WelsFree (pPrepared->pMotionTextureUnit[i], "pPrepared->pMotionTextureUnit");
+  }
+  memset (pPrepared, 0, sizeof (SPreparedSource));
+  pPrepared->iIndex = -1;
+}
+
+/*
+ *  Prepare: the pictures of the layers as SingleLayerPreprocess() builds them, and their VAA statistics against the
+ *  picture prepared before as AnalyzeSpatialPic() calculates them for a P frame with this reference
+ *  @return: 0 - prepared; 1 - to be preprocessed in the coding
+ */
+int32_t CWelsPreProcessAhead::Prepare (const SSourcePicture* kpSrcPic, SPreparedSource* pPrepared) {
+  SWelsSvcCodingParam* pParam = &m_sParam;
+  const int32_t kiSrcWidth  = kpSrcPic->iPicWidth & (~1);
+  const int32_t kiSrcHeight = kpSrcPic->iPicHeight & (~1);
+  pPrepared->iIndex = -1;
+  if (pParam->iUsageType == SCREEN_CONTENT_REAL_TIME || kpSrcPic->iColorFormat != videoFormatI420
+      || kiSrcWidth < 16 || kiSrcHeight < 16) {
+    m_pLastPrepared = NULL;
+    return 1;
+  }
+
+  // as WelsPreprocessReset() sets it in the coding
+  pParam->SUsedPicRect.iLeft   = 0;
+  pParam->SUsedPicRect.iTop    = 0;
+  pParam->SUsedPicRect.iWidth  = kiSrcWidth;
+  pParam->SUsedPicRect.iHeight = kiSrcHeight;
+  SPrepareSettings sSettings;
+  GetPrepareSettings (pParam, &sSettings);
+  if (memcmp (&sSettings, &m_sSettings, sizeof (sSettings))) {
+    FreeScaledPic (&m_sScaledPic, m_pMemAlign);
+    if (WelsInitScaledPic (pParam, &m_sScaledPic, m_pMemAlign, NULL)) {
+      memset (&m_sSettings, 0, sizeof (m_sSettings));
+      m_pLastPrepared = NULL;
+      return 1;
+    }
+    m_sSettings = sSettings;
+  }
+  if (memcmp (&sSettings, &pPrepared->sSettings, sizeof (sSettings)) || NULL == pPrepared->pSpatialPic[0]) {
+    if (AllocPrepared (pPrepared, sSettings)) {
+      m_pLastPrepared = NULL;
+      return 1;
+    }
+  }
+
+  int32_t iDependencyId = pParam->iSpatialLayerNum - 1;
+  SPicture* pSrcPic = m_sScaledPic.pScaledInputPicture ? m_sScaledPic.pScaledInputPicture :
+                      pPrepared->pSpatialPic[iDependencyId];
+  SPicture* pDstPic = pSrcPic;
+  int32_t iShrinkWidth  = kiSrcWidth;
+  int32_t iShrinkHeight = kiSrcHeight;
+  WelsMoveMemoryWrapper (pParam, pSrcPic, kpSrcPic, kiSrcWidth, kiSrcHeight);
+  if (pParam->bEnableDenoise)
+    BilateralDenoising (pSrcPic, kiSrcWidth, kiSrcHeight);
+  if (m_sScaledPic.pScaledInputPicture) {
+    pDstPic = pPrepared->pSpatialPic[iDependencyId];
+    iShrinkWidth  = m_sScaledPic.iScaledWidth[iDependencyId];
+    iShrinkHeight = m_sScaledPic.iScaledHeight[iDependencyId];
+  }
+  DownsamplePadding (pSrcPic, pDstPic, kiSrcWidth, kiSrcHeight, iShrinkWidth, iShrinkHeight,
+                     pParam->sSpatialLayers[iDependencyId].iVideoWidth, pParam->sSpatialLayers[iDependencyId].iVideoHeight,
+                     false);
+  for (-- iDependencyId; iDependencyId >= 0; -- iDependencyId) {
+    const int32_t kiClosestDid = iDependencyId + 1;
+    DownsamplePadding (pPrepared->pSpatialPic[kiClosestDid], pPrepared->pSpatialPic[iDependencyId],
+                       m_sScaledPic.iScaledWidth[kiClosestDid], m_sScaledPic.iScaledHeight[kiClosestDid],
+                       m_sScaledPic.iScaledWidth[iDependencyId], m_sScaledPic.iScaledHeight[iDependencyId],
+                       pParam->sSpatialLayers[iDependencyId].iVideoWidth, pParam->sSpatialLayers[iDependencyId].iVideoHeight,
+                       true);
+  }
+
+  const bool kbLastPrepared = (NULL != m_pLastPrepared && m_pLastPrepared->iIndex == m_iIndex - 1
+                               && !memcmp (&sSettings, &m_pLastPrepared->sSettings, sizeof (sSettings)));
+  for (int32_t i = 0; i < pParam->iSpatialLayerNum; i++) {
+    pPrepared->bVaaCalculated[i] = kbLastPrepared;
+    if (kbLastPrepared) {
+      SVAAFrameInfo sVaaInfo;
+      memset (&sVaaInfo, 0, sizeof (sVaaInfo));
+      sVaaInfo.sVaaCalcInfo = pPrepared->sVaaCalcInfo[i];
+      sVaaInfo.sAdaptiveQuantParam.pMotionTextureUnit = pPrepared->pMotionTextureUnit[i];
+      VaaCalculation (&sVaaInfo, pPrepared->pSpatialPic[i], m_pLastPrepared->pSpatialPic[i], pParam->bEnableAdaptiveQuant,
+                      false, pParam->bEnableBackgroundDetection);
+      pPrepared->sVaaCalcInfo[i] = sVaaInfo.sVaaCalcInfo;
+    }
+  }
+  pPrepared->iIndex = m_iIndex ++;
+  m_pLastPrepared = pPrepared;
+  return 0;
+}
+
 
 //*********************************************************************************************************/
 } // namespace WelsEnc
@@ -99,13 +99,18 @@ WelsErrorType CWelsTaskManageBase::Init (sWelsEncCtx* pEncCtx) {
 
   int32_t iReturn = ENC_RETURN_SUCCESS;
   //fprintf(stdout, "m_pThreadPool = &(CWelsThreadPool::GetInstance, this=%x\n", this);
-  iReturn = CWelsThreadPool::SetThreadNum (m_iThreadNum);
-  m_pThreadPool = (CWelsThreadPool::AddReference());
-  if ((iReturn != ENC_RETURN_SUCCESS) && pEncCtx) {
-    WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_WARNING, "Set Thread Num to %d did not succeed, current thread num in use: %d",
-             m_iThreadNum, m_pThreadPool->GetThreadNum());
+  if (NULL != m_pEncCtx->pSvcParam->pThreadPoolParam) {
+    m_pThreadPool = CWelsThreadPool::AddReference (m_pEncCtx->pSvcParam->pThreadPoolParam, m_iThreadNum);
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pThreadPool)
+  } else {
+    iReturn = CWelsThreadPool::SetThreadNum (m_iThreadNum);
+    m_pThreadPool = (CWelsThreadPool::AddReference());
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pThreadPool)
+    if ((iReturn != ENC_RETURN_SUCCESS) && pEncCtx) {
+      WelsLog (& (pEncCtx->sLogCtx), WELS_LOG_WARNING, "Set Thread Num to %d did not succeed, current thread num in use: %d",
+               m_iThreadNum, m_pThreadPool->GetThreadNum());
+    }
   }
-  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pThreadPool)
   //fprintf(stdout, "m_pThreadPool = &(CWelsThreadPool::GetInstance3\n");
 
   iReturn = ENC_RETURN_SUCCESS;
@@ -0,0 +1,461 @@
+/*!
+ * \copy
+ *     Copyright (c)  2009-2015, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ *
+ * \file    wels_task_wavefront.cpp
+ *
+ * \brief   wavefront coding of single slice layers
+ *
+ * \date    10/18/2026 Created
+ *
+ *************************************************************************************
+ */
+
+#include <string.h>
+
+#include "typedefs.h"
+#include "utils.h"
+#include "memory_align.h"
+#include "svc_encode_slice.h"
+#include "wels_task_wavefront.h"
+
+namespace WelsEnc {
+
+//////////////////////////////////////////////////////////////////////
+// CWelsWavefrontRowTask
+//////////////////////////////////////////////////////////////////////
+
+CWelsWavefrontRowTask::CWelsWavefrontRowTask (CWelsWavefrontEncoder* pEncoder)
+  : IWelsTask (this),
+    m_pEncoder (pEncoder),
+    m_bQueued (false) {
+}
+
+CWelsWavefrontRowTask::~CWelsWavefrontRowTask() {
+}
+
+int CWelsWavefrontRowTask::Execute() {
+  m_pEncoder->RunTask();
+  return ENC_RETURN_SUCCESS;
+}
+
+int CWelsWavefrontRowTask::OnTaskExecuted() {
+  m_pEncoder->OnTaskDone (this);
+  return ENC_RETURN_SUCCESS;
+}
+
+int CWelsWavefrontRowTask::OnTaskCancelled() {
+  m_pEncoder->OnTaskDone (this);
+  return ENC_RETURN_SUCCESS;
+}
+
+//////////////////////////////////////////////////////////////////////
+// CWelsWavefrontEncoder
+//////////////////////////////////////////////////////////////////////
+
+CWelsWavefrontEncoder::CWelsWavefrontEncoder()
+  : m_pCtx (NULL),
+    m_pThreadPool (NULL),
+    m_iThreadNum (0),
+    m_iRowCtxNum (0),
+    m_pMbSyn (NULL),
+    m_iRingRows (0),
+    m_iMaxMbWidth (0),
+    m_iMaxMbHeight (0),
+    m_pDecidedMbs (NULL),
+    m_pSlice (NULL),
+    m_iMbWidth (0),
+    m_iMbHeight (0),
+    m_iNextRow (0),
+    m_iWrittenRows (0),
+    m_iAbort (0),
+    m_iWaiterNum (0),
+    m_bActive (false),
+    m_iRunningNum (0) {
+  memset (m_bLayerEnabled, 0, sizeof (m_bLayerEnabled));
+  memset (m_pTasks, 0, sizeof (m_pTasks));
+  memset (m_sRowCtx, 0, sizeof (m_sRowCtx));
+  WelsMutexInit (&m_hMutex);
+  WelsCondInit (&m_hCond);
+}
+
+CWelsWavefrontEncoder::~CWelsWavefrontEncoder() {
+  WelsCondDestroy (&m_hCond);
+  WelsMutexDestroy (&m_hMutex);
+}
+
+CWelsWavefrontEncoder* CWelsWavefrontEncoder::CreateWavefrontEncoder (sWelsEncCtx* pCtx, const int32_t kiThreadNum) {
+  if (NULL == pCtx) {
+    return NULL;
+  }
+
+  CWelsWavefrontEncoder* pEncoder;
+  pEncoder = WELS_NEW_OP (CWelsWavefrontEncoder(), CWelsWavefrontEncoder);
+  WELS_VERIFY_RETURN_IF (NULL, NULL == pEncoder)
+
+  if (ENC_RETURN_SUCCESS != pEncoder->Init (pCtx, kiThreadNum)) {
+    pEncoder->Uninit();
+    WELS_DELETE_OP (pEncoder);
+  }
+  return pEncoder;
+}
+
+void CWelsWavefrontEncoder::DestroyWavefrontEncoder (CWelsWavefrontEncoder** ppEncoder) {
+  if (NULL != ppEncoder && NULL != *ppEncoder) {
+    (*ppEncoder)->Uninit();
+    WELS_DELETE_OP (*ppEncoder);
+  }
+}
+
+int32_t CWelsWavefrontEncoder::Init (sWelsEncCtx* pCtx, const int32_t kiThreadNum) {
+  SWelsSvcCodingParam* pParam = pCtx->pSvcParam;
+  CMemoryAlign* pMa           = pCtx->pMemAlign;
+
+  m_pCtx = pCtx;
+  m_iThreadNum = WELS_CLIP3 (kiThreadNum, 1, MAX_THREADS_NUM);
+
+  // the rows of screen content depend on each other through the feature search of the whole picture
+  for (int32_t iDid = 0; iDid < pParam->iSpatialLayerNum; iDid++) {
+    const SSpatialLayerConfig* kpLayer = &pParam->sSpatialLayers[iDid];
+    const int32_t kiMbWidth  = (kpLayer->iVideoWidth + 15) >> 4;
+    const int32_t kiMbHeight = (kpLayer->iVideoHeight + 15) >> 4;
+    m_bLayerEnabled[iDid] = (SM_SINGLE_SLICE == kpLayer->sSliceArgument.uiSliceMode)
+                            && (SCREEN_CONTENT_REAL_TIME != pParam->iUsageType) && (kiMbHeight > 1);
+    if (m_bLayerEnabled[iDid]) {
+      m_iMaxMbWidth  = WELS_MAX (m_iMaxMbWidth, kiMbWidth);
+      m_iMaxMbHeight = WELS_MAX (m_iMaxMbHeight, kiMbHeight);
+    }
+  }
+  if (0 == m_iMaxMbHeight) {
+    WelsLog (& (pCtx->sLogCtx), WELS_LOG_WARNING,
+             "CWelsWavefrontEncoder::Init(), no layer coded in a single slice, wavefront threads unused");
+    return ENC_RETURN_SUCCESS;
+  }
+
+  if (NULL != pParam->pThreadPoolParam) {
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference (pParam->pThreadPoolParam, m_iThreadNum);
+  } else {
+    if (WELS_THREAD_ERROR_OK != WelsCommon::CWelsThreadPool::SetThreadNum (m_iThreadNum)) {
+      WelsLog (& (pCtx->sLogCtx), WELS_LOG_INFO,
+               "CWelsWavefrontEncoder::Init(), thread pool created already, thread number %d ignored", m_iThreadNum);
+    }
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference();
+  }
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pThreadPool)
+  m_iThreadNum = WELS_MIN (m_iThreadNum, m_pThreadPool->GetThreadNum());
+
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    m_pTasks[i] = WELS_NEW_OP (CWelsWavefrontRowTask (this), CWelsWavefrontRowTask);
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pTasks[i])
+  }
+  for (int32_t i = 0; i <= m_iThreadNum; i++) {
+    SWavefrontRowCtx* pRow = &m_sRowCtx[i];
+    pRow->pSlice = (SSlice*)pMa->WelsMallocz (sizeof (SSlice), "pRow->pSlice");
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == pRow->pSlice)
+    pRow->pMd = (SWelsMD*)pMa->WelsMallocz (sizeof (SWelsMD), "pRow->pMd");
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == pRow->pMd)
+    WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, AllocMbCacheAligned (&pRow->sMbCache, pMa))
+  }
+
+  // one more row than the threads deciding rows ahead of the writing, and one more for the row being written
+  m_iRingRows = WELS_MIN (m_iThreadNum + 2, m_iMaxMbHeight);
+  m_pMbSyn = (SWavefrontMbSyn*)pMa->WelsMallocz (m_iRingRows * m_iMaxMbWidth * sizeof (SWavefrontMbSyn),
+             "m_pMbSyn");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pMbSyn)
+  m_pDecidedMbs = (volatile int32_t*)pMa->WelsMallocz (m_iMaxMbHeight * sizeof (int32_t), "m_pDecidedMbs");
+  WELS_VERIFY_RETURN_IF (ENC_RETURN_MEMALLOCERR, NULL == m_pDecidedMbs)
+
+  WelsLog (& (pCtx->sLogCtx), WELS_LOG_INFO, "CWelsWavefrontEncoder::Init(), %d threads, %d rows of MB syntax",
+           m_iThreadNum, m_iRingRows);
+  return ENC_RETURN_SUCCESS;
+}
+
+void CWelsWavefrontEncoder::Uninit() {
+  CMemoryAlign* pMa = m_pCtx->pMemAlign;
+
+  // tasks queued by former slices may be still pending on the pool
+  WelsMutexLock (&m_hMutex);
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    while (NULL != m_pTasks[i] && m_pTasks[i]->m_bQueued) {
+      WelsCondWait (&m_hCond, &m_hMutex);
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+  for (int32_t i = 0; i < m_iThreadNum; i++) {
+    WELS_DELETE_OP (m_pTasks[i]);
+  }
+
+  for (int32_t i = 0; i <= m_iThreadNum; i++) {
+    SWavefrontRowCtx* pRow = &m_sRowCtx[i];
+    FreeMbCache (&pRow->sMbCache, pMa);
+    if (NULL != pRow->pSlice) {
+      pMa->WelsFree (pRow->pSlice, "pRow->pSlice");
+      pRow->pSlice = NULL;
+    }
+    if (NULL != pRow->pMd) {
+      pMa->WelsFree (pRow->pMd, "pRow->pMd");
+      pRow->pMd = NULL;
+    }
+  }
+  if (NULL != m_pMbSyn) {
+    pMa->WelsFree (m_pMbSyn, "m_pMbSyn");
+    m_pMbSyn = NULL;
+  }
+  if (NULL != m_pDecidedMbs) {
+    pMa->WelsFree ((void*)m_pDecidedMbs, "m_pDecidedMbs");
+    m_pDecidedMbs = NULL;
+  }
+
+  if (NULL != m_pThreadPool) {
+    m_pThreadPool->RemoveInstance();
+    m_pThreadPool = NULL;
+  }
+}
+
+bool CWelsWavefrontEncoder::IsEnabled (sWelsEncCtx* pCtx) {
+  const SDqLayer* kpCurLayer = pCtx->pCurDqLayer;
+  return (NULL != m_pThreadPool) && m_bLayerEnabled[pCtx->uiDependencyId]
+         && (kpCurLayer->iMbWidth <= m_iMaxMbWidth) && (kpCurLayer->iMbHeight <= m_iMaxMbHeight);
+}
+
+void CWelsWavefrontEncoder::PrepareRowCtx (SWavefrontRowCtx* pRow, SSlice* pSlice) {
+  SSlice* pRowSlice = pRow->pSlice;
+
+  memcpy (pRowSlice, pSlice, sizeof (SSlice));
+  memcpy (&pRowSlice->sMbCacheInfo, &pRow->sMbCache, sizeof (SMbCache));
+  // the bits position read by the MB init of RC refers to the copy, it is taken again when the MB is written
+  pRowSlice->pSliceBsa = &pRowSlice->sSliceBs.sBsWrite;
+}
+
+int32_t CWelsWavefrontEncoder::ClaimRow() {
+  for (;;) {
+    const int32_t kiRow = m_iNextRow;
+    if (kiRow >= m_iMbHeight) {
+      return -1;
+    }
+    if (WelsAtomicCompareExchange (&m_iNextRow, kiRow + 1, kiRow) == kiRow) {
+      return kiRow;
+    }
+  }
+}
+
+void CWelsWavefrontEncoder::Publish (volatile int32_t* pProgress, const int32_t kiValue) {
+  // the exchange is a full barrier, so either the waiter sees the value or the waiter number is seen here
+  WelsAtomicExchange (pProgress, kiValue);
+  if (m_iWaiterNum > 0) {
+    WelsMutexLock (&m_hMutex);
+    WelsCondBroadcast (&m_hCond);
+    WelsMutexUnlock (&m_hMutex);
+  }
+}
+
+bool CWelsWavefrontEncoder::Wait (volatile int32_t* pProgress, const int32_t kiValue) {
+  if (*pProgress >= kiValue) {
+    WelsMemoryBarrier();
+    return true;
+  }
+
+  WelsMutexLock (&m_hMutex);
+  WelsAtomicAdd (&m_iWaiterNum, 1);
+  while (*pProgress < kiValue && 0 == m_iAbort) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  WelsAtomicAdd (&m_iWaiterNum, -1);
+  WelsMutexUnlock (&m_hMutex);
+  return 0 == m_iAbort;
+}
+
+void CWelsWavefrontEncoder::CodeRow (SWavefrontRowCtx* pRow, const int32_t kiRow) {
+  SMB* pMbList = m_pCtx->pCurDqLayer->sMbDataP + kiRow * m_iMbWidth;
+  SMbCache* pMbCache = &pRow->pSlice->sMbCacheInfo;
+
+  // the MB syntax of the row m_iRingRows above has to be written before its slots are reused
+  if (!Wait (&m_iWrittenRows, kiRow - m_iRingRows + 1)) {
+    return;
+  }
+
+  WelsInitRowMdWavefront (m_pCtx, pRow->pSlice, pRow->pMd);
+  for (int32_t iMbX = 0; iMbX < m_iMbWidth; iMbX++) {
+    // the top-right MB is the last neighbour referred to by the MD
+    if (kiRow > 0 && !Wait (&m_pDecidedMbs[kiRow - 1], WELS_MIN (iMbX + 2, m_iMbWidth))) {
+      return;
+    }
+
+    SWavefrontMbSyn* pSyn = GetMbSyn (iMbX, kiRow);
+    pMbCache->pDct = &pSyn->sDct;
+    WelsMdMbWavefront (m_pCtx, pRow->pSlice, pRow->pMd, &pMbList[iMbX]);
+
+    memcpy (&pSyn->sMvComponents, &pMbCache->sMvComponents, sizeof (SMVComponentUnit));
+    memcpy (pSyn->iNonZeroCoeffCount, pMbCache->iNonZeroCoeffCount, sizeof (pSyn->iNonZeroCoeffCount));
+    memcpy (pSyn->sMbMvp, pMbCache->sMbMvp, sizeof (pSyn->sMbMvp));
+    memcpy (pSyn->bPrevIntra4x4PredModeFlag, pMbCache->pPrevIntra4x4PredModeFlag,
+            sizeof (pSyn->bPrevIntra4x4PredModeFlag));
+    memcpy (pSyn->iRemIntra4x4PredModeFlag, pMbCache->pRemIntra4x4PredModeFlag, sizeof (pSyn->iRemIntra4x4PredModeFlag));
+    memcpy (pSyn->bMbTypeSkip, pMbCache->bMbTypeSkip, sizeof (pSyn->bMbTypeSkip));
+    pSyn->uiLumaI16x16Mode  = pMbCache->uiLumaI16x16Mode;
+    pSyn->uiChmaI8x8Mode    = pMbCache->uiChmaI8x8Mode;
+    pSyn->iCostLuma         = pRow->pMd->iCostLuma;
+
+    Publish (&m_pDecidedMbs[kiRow], iMbX + 1);
+  }
+}
+
+int32_t CWelsWavefrontEncoder::WriteRow (const int32_t kiRow) {
+  SMB* pMbList = m_pCtx->pCurDqLayer->sMbDataP + kiRow * m_iMbWidth;
+  SMbCache* pMbCache = &m_pSlice->sMbCacheInfo;
+
+  for (int32_t iMbX = 0; iMbX < m_iMbWidth; iMbX++) {
+    if (!Wait (&m_pDecidedMbs[kiRow], iMbX + 1)) {
+      return ENC_RETURN_UNEXPECTED;
+    }
+
+    SWavefrontMbSyn* pSyn = GetMbSyn (iMbX, kiRow);
+    pMbCache->pDct = &pSyn->sDct;
+    memcpy (&pMbCache->sMvComponents, &pSyn->sMvComponents, sizeof (SMVComponentUnit));
+    memcpy (pMbCache->iNonZeroCoeffCount, pSyn->iNonZeroCoeffCount, sizeof (pSyn->iNonZeroCoeffCount));
+    memcpy (pMbCache->sMbMvp, pSyn->sMbMvp, sizeof (pSyn->sMbMvp));
+    memcpy (pMbCache->pPrevIntra4x4PredModeFlag, pSyn->bPrevIntra4x4PredModeFlag,
+            sizeof (pSyn->bPrevIntra4x4PredModeFlag));
+    memcpy (pMbCache->pRemIntra4x4PredModeFlag, pSyn->iRemIntra4x4PredModeFlag, sizeof (pSyn->iRemIntra4x4PredModeFlag));
+    memcpy (pMbCache->bMbTypeSkip, pSyn->bMbTypeSkip, sizeof (pSyn->bMbTypeSkip));
+    pMbCache->uiLumaI16x16Mode  = pSyn->uiLumaI16x16Mode;
+    pMbCache->uiChmaI8x8Mode    = pSyn->uiChmaI8x8Mode;
+
+    // CAVLC overflows are avoided by the MD, the writing may still fail on a full buffer
+    const int32_t kiEncReturn = WelsWriteMbWavefront (m_pCtx, m_pSlice, &pMbList[iMbX], pSyn->iCostLuma);
+    if (ENC_RETURN_SUCCESS != kiEncReturn) {
+      return kiEncReturn;
+    }
+  }
+  return ENC_RETURN_SUCCESS;
+}
+
+int32_t CWelsWavefrontEncoder::CodeSlice (SSlice* pSlice) {
+  SDCTCoeff* pSliceDct = pSlice->sMbCacheInfo.pDct;
+  int32_t iEncReturn = ENC_RETURN_SUCCESS;
+  int32_t iQueuedNum = 0;
+
+  m_pSlice        = pSlice;
+  m_iMbWidth      = m_pCtx->pCurDqLayer->iMbWidth;
+  m_iMbHeight     = m_pCtx->pCurDqLayer->iMbHeight;
+  m_iNextRow      = 0;
+  m_iWrittenRows  = 0;
+  m_iAbort        = 0;
+  memset ((void*)m_pDecidedMbs, 0, m_iMbHeight * sizeof (int32_t));
+
+  WelsInitSliceWavefront (m_pCtx, pSlice);
+  // the contexts are prepared before any task starts, the slice is written from now on
+  for (int32_t i = 0; i <= m_iThreadNum; i++) {
+    PrepareRowCtx (&m_sRowCtx[i], pSlice);
+  }
+
+  WelsMutexLock (&m_hMutex);
+  m_bActive = true;
+  m_iRowCtxNum = 1;
+  m_iRunningNum = 0;
+  // the calling thread decides rows as well when none of the tasks took them
+  for (int32_t i = 0; i < m_iThreadNum && iQueuedNum < m_iMbHeight - 1; i++) {
+    CWelsWavefrontRowTask* pTask = m_pTasks[i];
+    if (!pTask->m_bQueued) {
+      pTask->m_bQueued = true;
+      if (WELS_THREAD_ERROR_OK != m_pThreadPool->QueueTask (pTask)) {
+        pTask->m_bQueued = false;
+        break;
+      }
+      ++ iQueuedNum;
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+
+  for (int32_t iRow = 0; iRow < m_iMbHeight; iRow++) {
+    // rows are claimed in order, so the row is claimed by the calling thread or by a running task
+    if (WelsAtomicCompareExchange (&m_iNextRow, iRow + 1, iRow) == iRow) {
+      CodeRow (&m_sRowCtx[0], iRow);
+    }
+    iEncReturn = WriteRow (iRow);
+    if (ENC_RETURN_SUCCESS != iEncReturn) {
+      break;
+    }
+    Publish (&m_iWrittenRows, iRow + 1);
+  }
+  pSlice->sMbCacheInfo.pDct = pSliceDct;
+
+  WelsMutexLock (&m_hMutex);
+  if (ENC_RETURN_SUCCESS != iEncReturn) {
+    m_iAbort = 1;
+    WelsCondBroadcast (&m_hCond);
+  }
+  m_bActive = false;
+  while (m_iRunningNum > 0) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  WelsMutexUnlock (&m_hMutex);
+
+  if (ENC_RETURN_SUCCESS != iEncReturn) {
+    return iEncReturn;
+  }
+  WelsFinishSliceWavefront (m_pCtx, pSlice);
+  return ENC_RETURN_SUCCESS;
+}
+
+void CWelsWavefrontEncoder::RunTask() {
+  WelsMutexLock (&m_hMutex);
+  if (!m_bActive) {
+    // queued for a former slice which did not need it
+    WelsMutexUnlock (&m_hMutex);
+    return;
+  }
+  SWavefrontRowCtx* pRow = &m_sRowCtx[m_iRowCtxNum++];
+  ++ m_iRunningNum;
+  WelsMutexUnlock (&m_hMutex);
+
+  int32_t iRow;
+  while (0 == m_iAbort && (iRow = ClaimRow()) >= 0) {
+    CodeRow (pRow, iRow);
+  }
+
+  WelsMutexLock (&m_hMutex);
+  -- m_iRunningNum;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+void CWelsWavefrontEncoder::OnTaskDone (CWelsWavefrontRowTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  pTask->m_bQueued = false;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+bool WelsWavefrontEnabled (sWelsEncCtx* pCtx) {
+  return (NULL != pCtx->pWavefront) && pCtx->pWavefront->IsEnabled (pCtx);
+}
+
+} // namespace WelsEnc
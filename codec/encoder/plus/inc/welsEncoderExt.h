@@ -49,6 +49,9 @@
 #include "param_svc.h"
 #include "extern.h"
 #include "cpu.h"
+#include "WelsThreadPool.h"
+#include "WelsThread.h"
+#include "wels_lookahead.h"
 
 //#define OUTPUT_BIT_STREAM
 //#define DUMP_SRC_PICTURE
@@ -56,7 +59,134 @@
 
 class ISVCEncoder;
 namespace WelsEnc {
-class CWelsH264SVCEncoder : public ISVCEncoder {
+class CWelsH264SVCEncoder;
+
+/*
+ *  CWelsLayerEncodingTask: encoding of one simulcast layer by the encoder of the layer
+ */
+class CWelsLayerEncodingTask : public WelsCommon::IWelsTask {
+ public:
+  CWelsLayerEncodingTask (WelsCommon::IWelsTaskSink* pSink, CWelsH264SVCEncoder* pEncoder);
+  virtual ~CWelsLayerEncodingTask() {}
+
+  void SetSource (const SSourcePicture* kpSrcPic);
+  virtual int Execute();
+
+  CWelsH264SVCEncoder* GetEncoder() {
+    return m_pEncoder;
+  }
+  const SFrameBSInfo* GetBsInfo() const {
+    return &m_sBsInfo;
+  }
+  int GetResult() const {
+    return m_iResult;
+  }
+
+ private:
+  CWelsH264SVCEncoder*  m_pEncoder;
+  const SSourcePicture* m_pSrcPic;
+  SFrameBSInfo          m_sBsInfo;
+  int                   m_iResult;
+};
+
+#define MAX_ASYNC_FRAME_NUM 16
+
+/*
+ *  CWelsAsyncEncoder: frames submitted are copied and encoded in the order of submission, on a thread of its own when
+ *  asynchronous, and once the frames of the lookahead window after them are submitted when the lookahead is enabled.
+ *  When asynchronous, the frames are analyzed by the lookahead and preprocessed on a second thread, ahead of their
+ *  encoding.
+ */
+class CWelsAsyncEncoder : public WelsCommon::CWelsThread {
+ public:
+  CWelsAsyncEncoder (CWelsH264SVCEncoder* pEncoder, const SEncAsyncParam& kParam, const int32_t kiLookaheadDepth);
+  virtual ~CWelsAsyncEncoder();
+
+  int32_t Init (const int32_t kiSrcWidth, const int32_t kiSrcHeight);
+  void    Uninit();
+
+  // submit kpSrcPic if not NULL, output the oldest frame encoded when polled
+  int     EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo);
+  // wait for the frames submitted to be encoded
+  void    Sync();
+  // wait for the encoding thread to be idle, the frames of the lookahead window are kept
+  void    WaitIdle();
+
+  virtual void ExecuteTask();
+
+ private:
+  // thread of the preparation of the frames, running ahead of the encoding thread
+  class CPrepareThread : public WelsCommon::CWelsThread {
+   public:
+    explicit CPrepareThread (CWelsAsyncEncoder* pOwner) : m_pOwner (pOwner) {}
+    void Signal() {
+      SignalThread();
+    }
+    virtual void ExecuteTask() {
+      m_pOwner->ExecutePrepare();
+    }
+   private:
+    CWelsAsyncEncoder* m_pOwner;
+  };
+
+  typedef struct TagAsyncFrame {
+    SSourcePicture  sSrcPic;
+    uint8_t*        pSrcBuf;
+    int32_t         iSrcBufSize;
+    SFrameBSInfo    sBsInfo;
+    uint8_t*        pBsBuf;         // copy of the bitstream of a frame polled
+    int32_t         iBsBufSize;
+    int32_t*        pNalLen;
+    int32_t         iNalLenNum;
+    int32_t         iResult;
+    int64_t         iLookaheadCost;
+    SPreparedSource sPrepared;      // spatial pictures and VAA statistics of the source, valid if bPrepared
+    bool            bPrepared;
+  } SAsyncFrame;
+
+  int32_t CopySource (SAsyncFrame* pFrame, const SSourcePicture* kpSrcPic);
+  int32_t CopyBitstream (SAsyncFrame* pFrame);
+  void    FreeFrame (SAsyncFrame* pFrame);
+  // under the lock, pop the oldest frame encoded as the output held till the next call
+  SAsyncFrame* PopOutput();
+  // under the lock, whether the next frame has enough frames submitted after it or the frames are flushed
+  bool    CanEncodeNext();
+  // under the lock, encode the next frame, the lock is released during the encoding
+  void    EncodeNext();
+  // under the lock, wait till no more than kiMaxPendingNum frames are left to be encoded, and all the frames are
+  // prepared if kbPrepared
+  void    WaitForFrames (const int32_t kiMaxPendingNum, const bool kbPrepared = false);
+  // lookahead analysis and preprocessing of a frame, out of the lock
+  void    PrepareFrame (SAsyncFrame* pFrame);
+  void    ExecutePrepare();
+  // under the lock with both threads idle, the preprocessing ahead follows the coding parameters
+  void    UpdatePrepareParam();
+
+  CWelsH264SVCEncoder*  m_pEncoder;
+  SEncAsyncParam        m_sParam;
+  int32_t               m_iLookaheadDepth;
+  CWelsLookahead*       m_pLookahead;
+  CWelsPreProcessAhead* m_pPreProcess;
+  CPrepareThread*       m_pPrepareThread;
+  SColorspaceConvertFunc m_sConvertFunc;
+  SAsyncFrame           m_sFrames[MAX_ASYNC_FRAME_NUM + MAX_LOOKAHEAD_DEPTH + 1];
+  int32_t               m_iFrameNum;
+  int32_t               m_iHead;        // oldest frame submitted and not output
+  int32_t               m_iHeldNum;     // frames submitted and not output
+  int32_t               m_iDoneNum;     // frames encoded from m_iHead on, not output yet
+  int32_t               m_iPreparedNum; // frames prepared from m_iHead on, the ones encoded included
+  bool                  m_bStarted;     // encoding and preparing threads running
+  bool                  m_bFlushing;    // frames encoded without waiting for the lookahead window
+  bool                  m_bPrepareSource; // frames preprocessed ahead by m_pPreProcess
+  bool                  m_bParamChanged;  // options set, the coding parameters taken again before the next frame
+
+  WELS_MUTEX            m_hFrameMutex;
+  WELS_COND             m_hFrameCond;
+
+  DISALLOW_COPY_AND_ASSIGN (CWelsAsyncEncoder);
+};
+
+class CWelsH264SVCEncoder : public ISVCEncoder, public WelsCommon::IWelsTaskSink {
  public:
   CWelsH264SVCEncoder();
   virtual ~CWelsH264SVCEncoder();
@@ -77,6 +207,14 @@ class CWelsH264SVCEncoder : public ISVCEncoder {
    */
   virtual int EXTAPI EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo);
   virtual int        EncodeFrameInternal (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo);
+  // encoding of kpSrcPic on the calling thread, whether the encoder is asynchronous or not
+  int                EncodeFrameSync (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo);
+  // lookahead costs used by the rate control of the next frame encoded
+  void               SetLookahead (const int64_t* kpCost, const int32_t kiNum);
+  // source of the next frame encoded as prepared ahead, NULL to preprocess it in the encoding
+  void               SetPreparedSource (const SPreparedSource* kpPrepared);
+  // parameters of the encoding context, NULL if not initialized or encoded by the simulcast layer encoders
+  const SWelsSvcCodingParam* GetCodingParam() const;
 
   /*
    * return: 0 - success; otherwise - failed;
@@ -96,8 +234,23 @@ class CWelsH264SVCEncoder : public ISVCEncoder {
   virtual int EXTAPI SetOption (ENCODER_OPTION opt_id, void* option);
   virtual int EXTAPI GetOption (ENCODER_OPTION opt_id, void* option);
 
+  //IWelsTaskSink
+  virtual int OnTaskExecuted();
+  virtual int OnTaskCancelled();
+
+  const CWelsBufferPool* GetBufferPool() const {
+    return m_pBufferPool;
+  }
+
  private:
   int InitializeInternal (SWelsSvcCodingParam* argv);
+  int InitializeAsyncEncoder (const int32_t kiSrcWidth, const int32_t kiSrcHeight);
+  // simulcast layers encoded concurrently, by the encoders of m_pLayerEncoders
+  int  InitializeLayerEncoders (const SEncParamExt* pParam);
+  void UninitializeLayerEncoders();
+  int  EncodeLayers (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo);
+  int  SetLayerEncodersOption (ENCODER_OPTION eOptionId, void* pOption);
+  int  GetLayerEncodersOption (ENCODER_OPTION eOptionId, void* pOption);
   void TraceParamInfo(SEncParamExt *pParam);
   void LogStatistics (const int64_t kiCurrentFrameTs,int32_t iMaxDid);
   void UpdateStatistics(SFrameBSInfo* pBsInfo, const int64_t kiCurrentFrameMs);
@@ -110,6 +263,30 @@ class CWelsH264SVCEncoder : public ISVCEncoder {
 
   int32_t           m_iCspInternal;
   bool              m_bInitialFlag;
+  SThreadPoolParam  m_sThreadPoolParam;
+  bool              m_bThreadPoolParam;
+
+  bool              m_bLayerThreading;
+  int32_t           m_iWavefrontThreadNum;
+  int32_t           m_iLayerEncoderNum;     // > 0 when the simulcast layers are encoded by m_pLayerEncoders
+  int32_t           m_iParasetIdBase;       // SPS/PPS ids of a layer encoder, see SWelsSvcCodingParam::iParasetIdBase
+  int32_t           m_iParasetIdStep;
+  CWelsH264SVCEncoder*    m_pLayerEncoders[MAX_SPATIAL_LAYER_NUM];
+  CWelsLayerEncodingTask* m_pLayerTasks[MAX_SPATIAL_LAYER_NUM];
+  WelsCommon::CWelsThreadPool* m_pThreadPool;
+  WelsCommon::CWelsLock m_cWaitTaskNumLock;
+  WELS_EVENT        m_hTaskEvent;
+  WELS_MUTEX        m_hEventMutex;
+  int32_t           m_iWaitTaskNum;
+
+  SEncAsyncParam    m_sAsyncParam;
+  int32_t           m_iLookaheadDepth;
+  CWelsAsyncEncoder* m_pAsyncEncoder;   // not NULL when the frames are encoded asynchronously or after a lookahead
+  int32_t           m_iTwoPass;
+  char              m_sTwoPassStatsFile[MAX_FNAME_LEN];
+  bool              m_bHierarchicalMe;
+  SMemoryArenaParam m_sMemoryArena;
+  CWelsBufferPool*  m_pBufferPool;      // pictures and bitstream buffers kept across the reinitializations by SetOption()
 
 #ifdef OUTPUT_BIT_STREAM
   FILE*             m_pFileBs;
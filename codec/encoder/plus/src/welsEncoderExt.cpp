@@ -65,7 +65,27 @@ CWelsH264SVCEncoder::CWelsH264SVCEncoder()
     m_iMaxPicWidth (0),
     m_iMaxPicHeight (0),
     m_iCspInternal (0),
-    m_bInitialFlag (false) {
+    m_bInitialFlag (false),
+    m_bThreadPoolParam (false),
+    m_bLayerThreading (false),
+    m_iWavefrontThreadNum (0),
+    m_iLayerEncoderNum (0),
+    m_iParasetIdBase (0),
+    m_iParasetIdStep (1),
+    m_pThreadPool (NULL),
+    m_iWaitTaskNum (0),
+    m_iLookaheadDepth (0),
+    m_pAsyncEncoder (NULL),
+    m_iTwoPass (0),
+    m_bHierarchicalMe (false),
+    m_pBufferPool (NULL) {
+  memset (&m_sThreadPoolParam, 0, sizeof (m_sThreadPoolParam));
+  m_sThreadPoolParam.iNumaNode = -1;
+  memset (m_sTwoPassStatsFile, 0, sizeof (m_sTwoPassStatsFile));
+  memset (&m_sAsyncParam, 0, sizeof (m_sAsyncParam));
+  memset (&m_sMemoryArena, 0, sizeof (m_sMemoryArena));
+  memset (m_pLayerEncoders, 0, sizeof (m_pLayerEncoders));
+  memset (m_pLayerTasks, 0, sizeof (m_pLayerTasks));
 #ifdef REC_FRAME_COUNT
   int32_t m_uiCountFrameNum = 0;
 #endif//REC_FRAME_COUNT
@@ -155,6 +175,11 @@ CWelsH264SVCEncoder::~CWelsH264SVCEncoder() {
 
   Uninitialize();
 
+  if (m_pBufferPool) {
+    delete m_pBufferPool;
+    m_pBufferPool = NULL;
+  }
+
   if (m_pWelsTrace) {
     delete m_pWelsTrace;
     m_pWelsTrace = NULL;
@@ -204,7 +229,18 @@ int CWelsH264SVCEncoder::Initialize (const SEncParamBase* argv) {
     return cmInitParaError;
   }
 
-  return InitializeInternal (&sConfig);
+  const int32_t kiReturn = InitializeInternal (&sConfig);
+  return (kiReturn == cmResultSuccess) ? InitializeAsyncEncoder (argv->iPicWidth, argv->iPicHeight) : kiReturn;
+}
+
+/*
+ *  The layer encoders keep the SPS/PPS ids of the layers apart, as the single encoding context does: the ids written by
+ *  the encoder of layer i are i modulo the number of layers. The listing strategies pick the ids from the parameter
+ *  sets already sent, which the layer encoders do not share, so they are left to the single encoding context.
+ */
+static bool IsLayerEncodersParam (const SEncParamExt* kpParam) {
+  return kpParam->bSimulcastAVC && kpParam->iSpatialLayerNum > 1 && kpParam->iSpatialLayerNum <= MAX_SPATIAL_LAYER_NUM
+         && (CONSTANT_ID == kpParam->eSpsPpsIdStrategy || INCREASING_ID == kpParam->eSpsPpsIdStrategy);
 }
 
 int CWelsH264SVCEncoder::InitializeExt (const SEncParamExt* argv) {
@@ -221,6 +257,12 @@ int CWelsH264SVCEncoder::InitializeExt (const SEncParamExt* argv) {
     return cmInitParaError;
   }
 
+  // the statistics of two-pass rate control are of a single encoding context
+  if (m_bLayerThreading && (0 == m_iTwoPass) && IsLayerEncodersParam (argv)) {
+    const int32_t kiReturn = InitializeLayerEncoders (argv);
+    return (kiReturn == cmResultSuccess) ? InitializeAsyncEncoder (argv->iPicWidth, argv->iPicHeight) : kiReturn;
+  }
+
   SWelsSvcCodingParam sConfig;
   // Convert SEncParamExt into WelsSVCParamConfig here..
   if (sConfig.ParamTranscode (*argv)) {
@@ -231,7 +273,8 @@ int CWelsH264SVCEncoder::InitializeExt (const SEncParamExt* argv) {
     return cmInitParaError;
   }
 
-  return InitializeInternal (&sConfig);
+  const int32_t kiReturn = InitializeInternal (&sConfig);
+  return (kiReturn == cmResultSuccess) ? InitializeAsyncEncoder (argv->iPicWidth, argv->iPicHeight) : kiReturn;
 }
 
 int CWelsH264SVCEncoder::InitializeInternal (SWelsSvcCodingParam* pCfg) {
@@ -331,8 +374,24 @@ int CWelsH264SVCEncoder::InitializeInternal (SWelsSvcCodingParam* pCfg) {
   m_iMaxPicWidth  = pCfg->iPicWidth;
   m_iMaxPicHeight = pCfg->iPicHeight;
 
+  pCfg->pThreadPoolParam = m_bThreadPoolParam ? &m_sThreadPoolParam : NULL;
+  pCfg->iWavefrontThreadNum = m_iWavefrontThreadNum;
+  pCfg->iTwoPass = m_iTwoPass;
+  WelsStrncpy (pCfg->sTwoPassStatsFile, MAX_FNAME_LEN, m_sTwoPassStatsFile);
+  pCfg->bHierarchicalMe = m_bHierarchicalMe;
+  pCfg->sMemoryArena = m_sMemoryArena;
+  pCfg->iParasetIdBase = m_iParasetIdBase;
+  pCfg->iParasetIdStep = m_iParasetIdStep;
+
+  if (NULL == m_pBufferPool) {
+    m_pBufferPool = new CWelsBufferPool (&m_pWelsTrace->m_sLogCtx);
+    if (NULL == m_pBufferPool) {
+      return cmMallocMemeError;
+    }
+  }
+
   TraceParamInfo (pCfg);
-  if (WelsInitEncoderExt (&m_pEncContext, pCfg, &m_pWelsTrace->m_sLogCtx, NULL)) {
+  if (WelsInitEncoderExt (&m_pEncContext, pCfg, &m_pWelsTrace->m_sLogCtx, NULL, m_pBufferPool, NULL)) {
     WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR, "CWelsH264SVCEncoder::Initialize(), WelsInitEncoderExt failed.");
     WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_DEBUG,
              "Problematic Input Base Param: iUsageType=%d, Resolution=%dx%d, FR=%f, TLayerNum=%d, DLayerNum=%d",
@@ -347,6 +406,24 @@ int CWelsH264SVCEncoder::InitializeInternal (SWelsSvcCodingParam* pCfg) {
   return cmResultSuccess;
 }
 
+int CWelsH264SVCEncoder::InitializeAsyncEncoder (const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  if (m_sAsyncParam.iMaxFramesInFlight <= 0 && m_iLookaheadDepth <= 0) {
+    return cmResultSuccess;
+  }
+  m_pAsyncEncoder = new CWelsAsyncEncoder (this, m_sAsyncParam, m_iLookaheadDepth);
+  if (NULL == m_pAsyncEncoder || m_pAsyncEncoder->Init (kiSrcWidth, kiSrcHeight) != cmResultSuccess) {
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR,
+             "CWelsH264SVCEncoder::InitializeAsyncEncoder(), failed in starting the encoding thread or the lookahead.");
+    Uninitialize();
+    return cmMallocMemeError;
+  }
+  WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+           "CWelsH264SVCEncoder::InitializeAsyncEncoder(), iMaxFramesInFlight = %d, iLookaheadDepth = %d, frames %s",
+           m_sAsyncParam.iMaxFramesInFlight, m_iLookaheadDepth,
+           m_sAsyncParam.pfOnFrameEncoded ? "called back" : "polled");
+  return cmResultSuccess;
+}
+
 /*
  *  SVC Encoder Uninitialization
  */
@@ -358,10 +435,24 @@ int32_t CWelsH264SVCEncoder::Uninitialize() {
   WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO, "CWelsH264SVCEncoder::Uninitialize(), openh264 codec version = %s.",
            VERSION_NUMBER);
 
+  // frames pending are encoded before, the ones not polled yet are dropped
+  if (m_pAsyncEncoder) {
+    delete m_pAsyncEncoder;
+    m_pAsyncEncoder = NULL;
+  }
+
+  if (m_iLayerEncoderNum > 0) {
+    UninitializeLayerEncoders();
+  }
+
   if (NULL != m_pEncContext) {
     WelsUninitEncoderExt (&m_pEncContext);
     m_pEncContext = NULL;
   }
+  // nothing left to reuse the buffers released, the settings of the next initialization are not known
+  if (m_pBufferPool) {
+    m_pBufferPool->Trim();
+  }
 
   m_bInitialFlag = false;
 
@@ -373,13 +464,27 @@ int32_t CWelsH264SVCEncoder::Uninitialize() {
  *  SVC core encoding
  */
 int CWelsH264SVCEncoder::EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo) {
+  if (m_pAsyncEncoder) {
+    // NULL source picture to poll the frames pending
+    if (! (m_bInitialFlag && pBsInfo)) {
+      return cmInitParaError;
+    }
+    if (kpSrcPic && kpSrcPic->iColorFormat != videoFormatI420 && !WelsCanConvertToI420 (kpSrcPic->iColorFormat))
+      return cmInitParaError;
+    return m_pAsyncEncoder->EncodeFrame (kpSrcPic, pBsInfo);
+  }
   if (! (kpSrcPic && m_bInitialFlag && pBsInfo)) {
     return cmInitParaError;
   }
-  if (kpSrcPic->iColorFormat != videoFormatI420)
+  if (kpSrcPic->iColorFormat != videoFormatI420 && !WelsCanConvertToI420 (kpSrcPic->iColorFormat))
     return cmInitParaError;
 
-  const int32_t kiEncoderReturn = EncodeFrameInternal (kpSrcPic, pBsInfo);
+  return EncodeFrameSync (kpSrcPic, pBsInfo);
+}
+
+int CWelsH264SVCEncoder::EncodeFrameSync (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo) {
+  const int32_t kiEncoderReturn = (m_iLayerEncoderNum > 0) ? EncodeLayers (kpSrcPic, pBsInfo) :
+                                  EncodeFrameInternal (kpSrcPic, pBsInfo);
 
   if (kiEncoderReturn != cmResultSuccess) {
     return kiEncoderReturn;
@@ -394,6 +499,30 @@ int CWelsH264SVCEncoder::EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSIn
   return kiEncoderReturn;
 }
 
+void CWelsH264SVCEncoder::SetLookahead (const int64_t* kpCost, const int32_t kiNum) {
+  if (m_iLayerEncoderNum > 0) {
+    for (int32_t iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      m_pLayerEncoders[iLayer]->SetLookahead (kpCost, kiNum);
+    }
+    return;
+  }
+  WelsEncoderSetLookahead (m_pEncContext, kpCost, kiNum);
+}
+
+void CWelsH264SVCEncoder::SetPreparedSource (const SPreparedSource* kpPrepared) {
+  if (m_iLayerEncoderNum > 0) {
+    return;
+  }
+  WelsEncoderSetPreparedSource (m_pEncContext, kpPrepared);
+}
+
+const SWelsSvcCodingParam* CWelsH264SVCEncoder::GetCodingParam() const {
+  if (m_iLayerEncoderNum > 0 || NULL == m_pEncContext || !m_bInitialFlag) {
+    return NULL;
+  }
+  return m_pEncContext->pSvcParam;
+}
+
 
 int CWelsH264SVCEncoder ::EncodeFrameInternal (const SSourcePicture*  pSrcPic, SFrameBSInfo* pBsInfo) {
   const int64_t kiBeforeFrameUs = WelsTime();
@@ -406,6 +535,9 @@ int CWelsH264SVCEncoder ::EncodeFrameInternal (const SSourcePicture*  pSrcPic, S
              kiEncoderReturn);
     WelsUninitEncoderExt (&m_pEncContext);
     return cmMallocMemeError;
+  } else if (kiEncoderReturn == ENC_RETURN_INVALIDINPUT) {
+    // the source picture is refused, the encoder goes on with the next one
+    return cmInitParaError;
   } else if ((kiEncoderReturn != ENC_RETURN_SUCCESS) && (kiEncoderReturn == ENC_RETURN_CORRECTED)) {
     WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR, "unexpected return(%d) from EncodeFrameInternal()!",
              kiEncoderReturn);
@@ -466,13 +598,812 @@ int CWelsH264SVCEncoder ::EncodeFrameInternal (const SSourcePicture*  pSrcPic, S
 }
 
 int CWelsH264SVCEncoder::EncodeParameterSets (SFrameBSInfo* pBsInfo) {
+  if (m_pAsyncEncoder) {
+    m_pAsyncEncoder->Sync();
+  }
+  if (m_iLayerEncoderNum > 0) {
+    int32_t iLayerNum = 0;
+    for (int32_t iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      SFrameBSInfo sLayerBsInfo;
+      memset (&sLayerBsInfo, 0, sizeof (SFrameBSInfo));
+      const int32_t kiReturn = m_pLayerEncoders[iLayer]->EncodeParameterSets (&sLayerBsInfo);
+      if (kiReturn != cmResultSuccess) {
+        return kiReturn;
+      }
+      for (int32_t i = 0; i < sLayerBsInfo.iLayerNum && iLayerNum < MAX_LAYER_NUM_OF_FRAME; i++) {
+        pBsInfo->sLayerInfo[iLayerNum] = sLayerBsInfo.sLayerInfo[i];
+        pBsInfo->sLayerInfo[iLayerNum].uiSpatialId = iLayer;
+        ++ iLayerNum;
+      }
+    }
+    pBsInfo->iLayerNum = iLayerNum;
+    return cmResultSuccess;
+  }
   return WelsEncoderEncodeParameterSets (m_pEncContext, pBsInfo);
 }
 
+/*
+ *  Simulcast layers encoded concurrently: the layers of simulcast AVC do not refer to each other, so each of them is
+ *  encoded by an encoder of its own, with its own reference lists, rate control and bitstream buffer. The lower layers
+ *  are encoded on the thread pool while the top one is encoded on the calling thread, and the NALs are output in the
+ *  order of the layers. Every layer carries its own SPS/PPS as a stream of a separate encoder would.
+ */
+CWelsLayerEncodingTask::CWelsLayerEncodingTask (WelsCommon::IWelsTaskSink* pSink, CWelsH264SVCEncoder* pEncoder)
+  : IWelsTask (pSink),
+    m_pEncoder (pEncoder),
+    m_pSrcPic (NULL),
+    m_iResult (cmResultSuccess) {
+  memset (&m_sBsInfo, 0, sizeof (m_sBsInfo));
+}
+
+void CWelsLayerEncodingTask::SetSource (const SSourcePicture* kpSrcPic) {
+  m_pSrcPic = kpSrcPic;
+  m_iResult = cmUnknownReason; // kept if the task is cancelled
+}
+
+int CWelsLayerEncodingTask::Execute() {
+  m_iResult = m_pEncoder->EncodeFrame (m_pSrcPic, &m_sBsInfo);
+  return m_iResult;
+}
+
+static void GetLayerParam (const SEncParamExt* kpParam, const int32_t kiLayer, SEncParamExt* pLayerParam) {
+  *pLayerParam = *kpParam;
+  pLayerParam->iSpatialLayerNum     = 1;
+  pLayerParam->sSpatialLayers[0]    = kpParam->sSpatialLayers[kiLayer];
+  pLayerParam->iTargetBitrate       = kpParam->sSpatialLayers[kiLayer].iSpatialBitrate;
+  pLayerParam->iMaxBitrate          = kpParam->sSpatialLayers[kiLayer].iMaxSpatialBitrate;
+  // iMultipleThreadIdc is not kept: the slice threads of a layer would wait on the pool threads running the other
+  // layers, so the slices of each layer are encoded on the thread of the layer
+  pLayerParam->iMultipleThreadIdc   = 1;
+}
+
+int CWelsH264SVCEncoder::InitializeLayerEncoders (const SEncParamExt* pParam) {
+  if (m_bInitialFlag) {
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+             "CWelsH264SVCEncoder::InitializeLayerEncoders(), reinitialize, m_bInitialFlag= %d.",
+             m_bInitialFlag);
+    Uninitialize();
+  }
+
+  if (pParam->iMultipleThreadIdc != 1) {
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::InitializeLayerEncoders(), iMultipleThreadIdc= %d ignored, the slices of each layer are encoded on the thread of the layer.",
+             pParam->iMultipleThreadIdc);
+  }
+  WelsEventOpen (&m_hTaskEvent);
+  WelsMutexInit (&m_hEventMutex);
+  m_iLayerEncoderNum = pParam->iSpatialLayerNum;
+  for (int32_t iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+    CWelsH264SVCEncoder* pEncoder = new CWelsH264SVCEncoder();
+    m_pLayerEncoders[iLayer] = pEncoder;
+    if (NULL == pEncoder || NULL == pEncoder->m_pWelsTrace) {
+      UninitializeLayerEncoders();
+      return cmMallocMemeError;
+    }
+    // logs of the layer encoders go to the trace of this instance
+    pEncoder->m_pWelsTrace->m_sLogCtx = m_pWelsTrace->m_sLogCtx;
+    pEncoder->m_bHierarchicalMe = m_bHierarchicalMe;
+    pEncoder->m_sMemoryArena = m_sMemoryArena;
+    pEncoder->m_iParasetIdBase = iLayer;
+    pEncoder->m_iParasetIdStep = m_iLayerEncoderNum;
+
+    SEncParamExt sLayerParam;
+    GetLayerParam (pParam, iLayer, &sLayerParam);
+    if (pEncoder->InitializeExt (&sLayerParam) != cmResultSuccess) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR,
+               "CWelsH264SVCEncoder::InitializeLayerEncoders(), initialization of layer %d failed.", iLayer);
+      UninitializeLayerEncoders();
+      return cmInitParaError;
+    }
+    m_pLayerTasks[iLayer] = new CWelsLayerEncodingTask (this, pEncoder);
+    if (NULL == m_pLayerTasks[iLayer]) {
+      UninitializeLayerEncoders();
+      return cmMallocMemeError;
+    }
+  }
+
+  const int32_t kiThreadNum = m_iLayerEncoderNum - 1;
+  if (m_bThreadPoolParam) {
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference (&m_sThreadPoolParam, kiThreadNum);
+  } else {
+    WelsCommon::CWelsThreadPool::SetThreadNum (kiThreadNum);
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference();
+  }
+  if (NULL == m_pThreadPool) {
+    UninitializeLayerEncoders();
+    return cmMallocMemeError;
+  }
+
+  m_iMaxPicWidth  = pParam->iPicWidth;
+  m_iMaxPicHeight = pParam->iPicHeight;
+  m_bInitialFlag  = true;
+  WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+           "CWelsH264SVCEncoder::InitializeLayerEncoders(), %d simulcast layers encoded concurrently, %d pool threads.",
+           m_iLayerEncoderNum, m_pThreadPool->GetThreadNum());
+  return cmResultSuccess;
+}
+
+void CWelsH264SVCEncoder::UninitializeLayerEncoders() {
+  if (NULL != m_pThreadPool) {
+    m_pThreadPool->RemoveInstance();
+    m_pThreadPool = NULL;
+  }
+  for (int32_t iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+    if (NULL != m_pLayerTasks[iLayer]) {
+      delete m_pLayerTasks[iLayer];
+      m_pLayerTasks[iLayer] = NULL;
+    }
+    if (NULL != m_pLayerEncoders[iLayer]) {
+      m_pLayerEncoders[iLayer]->Uninitialize();
+      delete m_pLayerEncoders[iLayer];
+      m_pLayerEncoders[iLayer] = NULL;
+    }
+  }
+  m_iLayerEncoderNum = 0;
+  WelsEventClose (&m_hTaskEvent);
+  WelsMutexDestroy (&m_hEventMutex);
+}
+
+int CWelsH264SVCEncoder::OnTaskExecuted() {
+  WelsCommon::CWelsAutoLock cAutoLock (m_cWaitTaskNumLock);
+  WelsEventSignal (&m_hTaskEvent, &m_hEventMutex, &m_iWaitTaskNum);
+  return cmResultSuccess;
+}
+
+int CWelsH264SVCEncoder::OnTaskCancelled() {
+  return OnTaskExecuted();
+}
+
+int CWelsH264SVCEncoder::EncodeLayers (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo) {
+  const int32_t kiTopLayer = m_iLayerEncoderNum - 1;
+  int32_t iLayer;
+
+  for (iLayer = 0; iLayer <= kiTopLayer; iLayer++) {
+    m_pLayerTasks[iLayer]->SetSource (kpSrcPic);
+  }
+  m_iWaitTaskNum = kiTopLayer;
+  for (iLayer = 0; iLayer < kiTopLayer; iLayer++) {
+    m_pThreadPool->QueueTask (m_pLayerTasks[iLayer]);
+  }
+  m_pLayerTasks[kiTopLayer]->Execute();
+  WelsEventWait (&m_hTaskEvent, &m_hEventMutex, m_iWaitTaskNum);
+
+  int32_t iReturn = cmResultSuccess;
+  int32_t iLayerNum = 0;
+  int32_t iFrameSize = 0;
+  EVideoFrameType eFrameType = videoFrameTypeSkip;
+  for (iLayer = 0; iLayer <= kiTopLayer; iLayer++) {
+    const CWelsLayerEncodingTask* kpTask = m_pLayerTasks[iLayer];
+    if (kpTask->GetResult() != cmResultSuccess) {
+      iReturn = kpTask->GetResult();
+      continue;
+    }
+    const SFrameBSInfo* kpLayerBsInfo = kpTask->GetBsInfo();
+    if (iLayerNum + kpLayerBsInfo->iLayerNum > MAX_LAYER_NUM_OF_FRAME) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_ERROR,
+               "CWelsH264SVCEncoder::EncodeLayers(), iLayerNum(%d) > MAX_LAYER_NUM_OF_FRAME(%d)!",
+               iLayerNum + kpLayerBsInfo->iLayerNum, MAX_LAYER_NUM_OF_FRAME);
+      return cmUnknownReason;
+    }
+    for (int32_t i = 0; i < kpLayerBsInfo->iLayerNum; i++) {
+      pBsInfo->sLayerInfo[iLayerNum] = kpLayerBsInfo->sLayerInfo[i];
+      pBsInfo->sLayerInfo[iLayerNum].uiSpatialId = iLayer;
+      ++ iLayerNum;
+    }
+    iFrameSize += kpLayerBsInfo->iFrameSizeInBytes;
+    if (kpLayerBsInfo->eFrameType != videoFrameTypeSkip) {
+      eFrameType = kpLayerBsInfo->eFrameType;
+    }
+  }
+
+  pBsInfo->iLayerNum = iLayerNum;
+  pBsInfo->iFrameSizeInBytes = iFrameSize;
+  pBsInfo->uiTimeStamp = m_pLayerTasks[kiTopLayer]->GetBsInfo()->uiTimeStamp;
+  pBsInfo->eFrameType = eFrameType;
+  for (int32_t k = 0; k < iLayerNum; k++) {
+    if (pBsInfo->eFrameType != pBsInfo->sLayerInfo[k].eFrameType) {
+      pBsInfo->eFrameType = videoFrameTypeIPMixed;
+    }
+  }
+  return iReturn;
+}
+
+int CWelsH264SVCEncoder::SetLayerEncodersOption (ENCODER_OPTION eOptionId, void* pOption) {
+  int32_t iLayer;
+  int32_t iReturn = cmResultSuccess;
+
+  switch (eOptionId) {
+  case ENCODER_OPTION_SVC_ENCODE_PARAM_BASE:
+    // single layer from now on
+    return Initialize (static_cast<const SEncParamBase*> (pOption));
+  case ENCODER_OPTION_SVC_ENCODE_PARAM_EXT: {
+    const SEncParamExt* kpParam = static_cast<const SEncParamExt*> (pOption);
+    if (!IsLayerEncodersParam (kpParam) || kpParam->iSpatialLayerNum != m_iLayerEncoderNum) {
+      return InitializeExt (kpParam);
+    }
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      SEncParamExt sLayerParam;
+      GetLayerParam (kpParam, iLayer, &sLayerParam);
+      iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, &sLayerParam);
+      if (iReturn != cmResultSuccess) {
+        return iReturn;
+      }
+    }
+    m_iMaxPicWidth  = kpParam->iPicWidth;
+    m_iMaxPicHeight = kpParam->iPicHeight;
+  }
+  break;
+  case ENCODER_OPTION_BITRATE:
+  case ENCODER_OPTION_MAX_BITRATE: {
+    const SBitrateInfo* kpInfo = static_cast<const SBitrateInfo*> (pOption);
+    SBitrateInfo sLayerInfo;
+    sLayerInfo.iLayer = SPATIAL_LAYER_0;
+    if (kpInfo->iLayer >= SPATIAL_LAYER_0 && kpInfo->iLayer < m_iLayerEncoderNum) {
+      sLayerInfo.iBitrate = kpInfo->iBitrate;
+      return m_pLayerEncoders[kpInfo->iLayer]->SetOption (eOptionId, &sLayerInfo);
+    }
+    if (kpInfo->iLayer != SPATIAL_LAYER_ALL) {
+      return cmInitParaError;
+    }
+    if (eOptionId == ENCODER_OPTION_MAX_BITRATE) {
+      for (iLayer = 0; iLayer < m_iLayerEncoderNum && iReturn == cmResultSuccess; iLayer++) {
+        iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, pOption);
+      }
+      return iReturn;
+    }
+    // keep the ratio between the layers, as WelsEncoderApplyBitRate() does
+    int32_t iLayerBitrate[MAX_SPATIAL_LAYER_NUM];
+    int64_t iOrigTotalBitrate = 0;
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      m_pLayerEncoders[iLayer]->GetOption (eOptionId, &sLayerInfo);
+      iLayerBitrate[iLayer] = sLayerInfo.iBitrate;
+      iOrigTotalBitrate += sLayerInfo.iBitrate;
+    }
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum && iReturn == cmResultSuccess; iLayer++) {
+      const float kfRatio = (iOrigTotalBitrate > 0) ? (iLayerBitrate[iLayer] / static_cast<float> (iOrigTotalBitrate)) :
+                            (1.0f / m_iLayerEncoderNum);
+      sLayerInfo.iBitrate = static_cast<int32_t> (kpInfo->iBitrate * kfRatio);
+      iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, &sLayerInfo);
+    }
+  }
+  break;
+  case ENCODER_LTR_RECOVERY_REQUEST: {
+    SLTRRecoverRequest sRequest = * (static_cast<SLTRRecoverRequest*> (pOption));
+    iLayer = sRequest.iLayerId;
+    if (iLayer < 0 || iLayer >= m_iLayerEncoderNum) {
+      return cmInitParaError;
+    }
+    sRequest.iLayerId = 0;
+    iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, &sRequest);
+  }
+  break;
+  case ENCODER_LTR_MARKING_FEEDBACK: {
+    SLTRMarkingFeedback sFeedback = * (static_cast<SLTRMarkingFeedback*> (pOption));
+    iLayer = sFeedback.iLayerId;
+    if (iLayer < 0 || iLayer >= m_iLayerEncoderNum) {
+      return cmInitParaError;
+    }
+    sFeedback.iLayerId = 0;
+    iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, &sFeedback);
+  }
+  break;
+  default:
+    // options applying to all the layers
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum && iReturn == cmResultSuccess; iLayer++) {
+      iReturn = m_pLayerEncoders[iLayer]->SetOption (eOptionId, pOption);
+    }
+    break;
+  }
+
+  return iReturn;
+}
+
+// add the memory usage of a layer encoder to the one of the other layers, the tags are matched by name
+static void MergeMemoryUsage (SMemoryUsage* pUsage, const SMemoryUsage* kpLayerUsage) {
+  pUsage->uiTotalBytes += kpLayerUsage->uiTotalBytes;
+  pUsage->uiPeakBytes  += kpLayerUsage->uiPeakBytes;
+  pUsage->uiArenaBytes += kpLayerUsage->uiArenaBytes;
+  pUsage->iRegionNum   += kpLayerUsage->iRegionNum;
+  for (int32_t i = 0; i < kpLayerUsage->iTagNum; i++) {
+    const SMemoryTagUsage* kpTagUsage = &kpLayerUsage->sTagUsage[i];
+    int32_t iTag = 0;
+    while (iTag < pUsage->iTagNum && strcmp (pUsage->sTagUsage[iTag].sTag, kpTagUsage->sTag))
+      iTag++;
+    if (iTag == pUsage->iTagNum) {
+      if (iTag < MAX_MEMORY_TAG_NUM) {
+        memcpy (&pUsage->sTagUsage[pUsage->iTagNum++], kpTagUsage, sizeof (SMemoryTagUsage));
+        continue;
+      }
+      iTag = 0; // counted to "others" as the tags beyond the limit of a single encoder
+    }
+    pUsage->sTagUsage[iTag].uiBytes     += kpTagUsage->uiBytes;
+    pUsage->sTagUsage[iTag].uiPeakBytes += kpTagUsage->uiPeakBytes;
+    pUsage->sTagUsage[iTag].uiBlockNum  += kpTagUsage->uiBlockNum;
+  }
+}
+
+int CWelsH264SVCEncoder::GetLayerEncodersOption (ENCODER_OPTION eOptionId, void* pOption) {
+  CWelsH264SVCEncoder* pTopEncoder = m_pLayerEncoders[m_iLayerEncoderNum - 1];
+  int32_t iLayer;
+
+  switch (eOptionId) {
+  case ENCODER_OPTION_SVC_ENCODE_PARAM_EXT: {
+    SEncParamExt* pParam = static_cast<SEncParamExt*> (pOption);
+    SEncParamExt sLayerParam;
+    pTopEncoder->GetOption (eOptionId, pParam);
+    pParam->iSpatialLayerNum = m_iLayerEncoderNum;
+    pParam->iTargetBitrate = 0;
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      m_pLayerEncoders[iLayer]->GetOption (eOptionId, &sLayerParam);
+      pParam->sSpatialLayers[iLayer] = sLayerParam.sSpatialLayers[0];
+      pParam->iTargetBitrate += sLayerParam.sSpatialLayers[0].iSpatialBitrate;
+    }
+  }
+  break;
+  case ENCODER_OPTION_BITRATE:
+  case ENCODER_OPTION_MAX_BITRATE: {
+    SBitrateInfo* pInfo = static_cast<SBitrateInfo*> (pOption);
+    SBitrateInfo sLayerInfo;
+    sLayerInfo.iLayer = SPATIAL_LAYER_0;
+    if (pInfo->iLayer >= SPATIAL_LAYER_0 && pInfo->iLayer < m_iLayerEncoderNum) {
+      m_pLayerEncoders[pInfo->iLayer]->GetOption (eOptionId, &sLayerInfo);
+      pInfo->iBitrate = sLayerInfo.iBitrate;
+    } else if (pInfo->iLayer == SPATIAL_LAYER_ALL) {
+      pInfo->iBitrate = 0;
+      for (iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+        m_pLayerEncoders[iLayer]->GetOption (eOptionId, &sLayerInfo);
+        pInfo->iBitrate += sLayerInfo.iBitrate;
+      }
+    } else {
+      return cmInitParaError;
+    }
+  }
+  break;
+  case ENCODER_OPTION_MEMORY_USAGE: {
+    SMemoryUsage* pUsage = static_cast<SMemoryUsage*> (pOption);
+    pTopEncoder->GetOption (eOptionId, pUsage);
+    for (iLayer = 0; iLayer < m_iLayerEncoderNum - 1; iLayer++) {
+      SMemoryUsage* pLayerUsage = new SMemoryUsage;
+      m_pLayerEncoders[iLayer]->GetOption (eOptionId, pLayerUsage);
+      MergeMemoryUsage (pUsage, pLayerUsage);
+      delete pLayerUsage;
+    }
+  }
+  break;
+  default:
+    // the top layer is representative of the others, as for the statistics of a single encoder
+    return pTopEncoder->GetOption (eOptionId, pOption);
+  }
+
+  return 0;
+}
+
+/*
+ *  Asynchronous encoding: EncodeFrame() copies the source picture into a frame of a ring and returns, the frames are
+ *  encoded in the order of submission by the thread of CWelsAsyncEncoder. The ring holds iMaxFramesInFlight frames
+ *  submitted and not output yet, plus the frame output to the application when polled, whose bitstream is kept
+ *  until the next call.
+ *  Lookahead: the cost of each frame is analyzed when it is submitted, a frame is encoded once the frames of the
+ *  lookahead window after it are submitted, with the costs of the window passed to the rate control. Without the
+ *  asynchronous encoding, the frames are analyzed and encoded on the calling thread.
+ *  Preparation: when asynchronous, the lookahead analysis and the preprocessing of the encoding (denoising,
+ *  downsampling into the spatial layers and the VAA statistics against the frame before) run on a thread of their own,
+ *  so that frame N+1 is prepared while frame N is encoded. A frame is encoded once prepared, m_iHeldNum >=
+ *  m_iPreparedNum >= m_iDoneNum.
+ */
+CWelsAsyncEncoder::CWelsAsyncEncoder (CWelsH264SVCEncoder* pEncoder, const SEncAsyncParam& kParam,
+                                      const int32_t kiLookaheadDepth)
+  : m_pEncoder (pEncoder),
+    m_sParam (kParam),
+    m_iLookaheadDepth (WELS_CLIP3 (kiLookaheadDepth, 0, MAX_LOOKAHEAD_DEPTH)),
+    m_pLookahead (NULL),
+    m_pPreProcess (NULL),
+    m_pPrepareThread (NULL),
+    m_iFrameNum (0),
+    m_iHead (0),
+    m_iHeldNum (0),
+    m_iDoneNum (0),
+    m_iPreparedNum (0),
+    m_bStarted (false),
+    m_bFlushing (false),
+    m_bPrepareSource (false),
+    m_bParamChanged (false) {
+  memset (m_sFrames, 0, sizeof (m_sFrames));
+  WelsMutexInit (&m_hFrameMutex);
+  WelsCondInit (&m_hFrameCond);
+}
+
+CWelsAsyncEncoder::~CWelsAsyncEncoder() {
+  Uninit();
+  WelsCondDestroy (&m_hFrameCond);
+  WelsMutexDestroy (&m_hFrameMutex);
+}
+
+int32_t CWelsAsyncEncoder::Init (const int32_t kiSrcWidth, const int32_t kiSrcHeight) {
+  const int32_t kiFramesInFlight = WELS_CLIP3 (m_sParam.iMaxFramesInFlight, 0, MAX_ASYNC_FRAME_NUM);
+  m_iFrameNum = WELS_MAX (kiFramesInFlight, m_iLookaheadDepth + 1) + 1;
+  m_iHead     = 0;
+  m_iHeldNum  = 0;
+  m_iDoneNum  = 0;
+  m_iPreparedNum = 0;
+  m_bFlushing = false;
+  InitColorspaceConvertFunc (&m_sConvertFunc, WelsCPUFeatureDetect (NULL));
+  if (m_iLookaheadDepth > 0) {
+    m_pLookahead = CWelsLookahead::CreateLookahead (kiSrcWidth, kiSrcHeight);
+    if (NULL == m_pLookahead) {
+      return cmMallocMemeError;
+    }
+  }
+  if (kiFramesInFlight > 0) {
+    m_pPrepareThread = new CPrepareThread (this);
+    if (NULL == m_pPrepareThread || WELS_THREAD_ERROR_OK != m_pPrepareThread->Start()) {
+      return cmMallocMemeError;
+    }
+    if (WELS_THREAD_ERROR_OK != Start()) {
+      return cmMallocMemeError;
+    }
+    m_bStarted = true;
+    // the coding parameters are taken before the first frame
+    m_bParamChanged = true;
+  }
+  return cmResultSuccess;
+}
+
+void CWelsAsyncEncoder::Uninit() {
+  Sync();
+  if (m_bStarted) {
+    Kill();
+    m_bStarted = false;
+  }
+  if (m_pPrepareThread) {
+    m_pPrepareThread->Kill();
+    delete m_pPrepareThread;
+    m_pPrepareThread = NULL;
+  }
+  for (int32_t i = 0; i < MAX_ASYNC_FRAME_NUM + MAX_LOOKAHEAD_DEPTH + 1; i++) {
+    FreeFrame (&m_sFrames[i]);
+  }
+  m_iHeldNum = m_iDoneNum = m_iPreparedNum = 0;
+  CWelsLookahead::DestroyLookahead (&m_pLookahead);
+  CWelsPreProcessAhead::DestroyPreProcessAhead (&m_pPreProcess);
+  m_bPrepareSource = false;
+}
+
+void CWelsAsyncEncoder::FreeFrame (SAsyncFrame* pFrame) {
+  if (pFrame->pSrcBuf) {
+    delete [] pFrame->pSrcBuf;
+    pFrame->pSrcBuf = NULL;
+  }
+  if (pFrame->pBsBuf) {
+    delete [] pFrame->pBsBuf;
+    pFrame->pBsBuf = NULL;
+  }
+  if (pFrame->pNalLen) {
+    delete [] pFrame->pNalLen;
+    pFrame->pNalLen = NULL;
+  }
+  if (m_pPreProcess) {
+    m_pPreProcess->FreePrepared (&pFrame->sPrepared);
+  }
+  pFrame->iSrcBufSize = pFrame->iBsBufSize = pFrame->iNalLenNum = 0;
+  pFrame->bPrepared = false;
+}
+
+int32_t CWelsAsyncEncoder::CopySource (SAsyncFrame* pFrame, const SSourcePicture* kpSrcPic) {
+  // other formats are converted in the copy, the lookahead and the encoder only see I420
+  const bool kbConvert         = (kpSrcPic->iColorFormat != videoFormatI420);
+  const int32_t kiWidth        = kbConvert ? (kpSrcPic->iPicWidth & (~1)) : kpSrcPic->iPicWidth;
+  const int32_t kiHeight       = kbConvert ? (kpSrcPic->iPicHeight & (~1)) : kpSrcPic->iPicHeight;
+  const int32_t kiChromaWidth  = (kiWidth + 1) >> 1;
+  const int32_t kiChromaHeight = (kiHeight + 1) >> 1;
+  const int32_t kiLumaSize     = kiWidth * kiHeight;
+  const int32_t kiChromaSize   = kiChromaWidth * kiChromaHeight;
+  if (kiWidth <= 0 || kiHeight <= 0) {
+    return cmInitParaError;
+  }
+  if (pFrame->iSrcBufSize < kiLumaSize + 2 * kiChromaSize) {
+    if (pFrame->pSrcBuf) {
+      delete [] pFrame->pSrcBuf;
+    }
+    pFrame->iSrcBufSize = kiLumaSize + 2 * kiChromaSize;
+    pFrame->pSrcBuf = new uint8_t[pFrame->iSrcBufSize];
+    if (NULL == pFrame->pSrcBuf) {
+      pFrame->iSrcBufSize = 0;
+      return cmMallocMemeError;
+    }
+  }
+
+  SSourcePicture* pSrcPic = &pFrame->sSrcPic;
+  *pSrcPic = *kpSrcPic;
+  pSrcPic->iColorFormat = videoFormatI420;
+  pSrcPic->iPicWidth  = kiWidth;
+  pSrcPic->iPicHeight = kiHeight;
+  pSrcPic->iStride[0] = kiWidth;
+  pSrcPic->iStride[1] = pSrcPic->iStride[2] = kiChromaWidth;
+  pSrcPic->iStride[3] = 0;
+  pSrcPic->pData[0] = pFrame->pSrcBuf;
+  pSrcPic->pData[1] = pSrcPic->pData[0] + kiLumaSize;
+  pSrcPic->pData[2] = pSrcPic->pData[1] + kiChromaSize;
+  pSrcPic->pData[3] = NULL;
+  if (kbConvert) {
+    return WelsConvertToI420 (&m_sConvertFunc, kpSrcPic, 0, 0, kiWidth, kiHeight, pSrcPic->pData, pSrcPic->iStride) ?
+           cmInitParaError : cmResultSuccess;
+  }
+  for (int32_t iPlane = 0; iPlane < 3; iPlane++) {
+    const int32_t kiPlaneWidth  = iPlane ? kiChromaWidth : kiWidth;
+    const int32_t kiPlaneHeight = iPlane ? kiChromaHeight : kiHeight;
+    const uint8_t* pSrc = kpSrcPic->pData[iPlane];
+    uint8_t* pDst = pSrcPic->pData[iPlane];
+    for (int32_t i = 0; i < kiPlaneHeight; i++) {
+      memcpy (pDst, pSrc, kiPlaneWidth);
+      pSrc += kpSrcPic->iStride[iPlane];
+      pDst += kiPlaneWidth;
+    }
+  }
+  return cmResultSuccess;
+}
+
+int32_t CWelsAsyncEncoder::CopyBitstream (SAsyncFrame* pFrame) {
+  SFrameBSInfo* pBsInfo = &pFrame->sBsInfo;
+  int32_t iBsSize = 0, iNalNum = 0;
+  int32_t iLayer, iNal;
+
+  for (iLayer = 0; iLayer < pBsInfo->iLayerNum; iLayer++) {
+    const SLayerBSInfo* kpLayerBsInfo = &pBsInfo->sLayerInfo[iLayer];
+    for (iNal = 0; iNal < kpLayerBsInfo->iNalCount; iNal++) {
+      iBsSize += kpLayerBsInfo->pNalLengthInByte[iNal];
+    }
+    iNalNum += kpLayerBsInfo->iNalCount;
+  }
+  if (pFrame->iBsBufSize < iBsSize) {
+    if (pFrame->pBsBuf) {
+      delete [] pFrame->pBsBuf;
+    }
+    pFrame->iBsBufSize = iBsSize;
+    pFrame->pBsBuf = new uint8_t[iBsSize];
+  }
+  if (pFrame->iNalLenNum < iNalNum) {
+    if (pFrame->pNalLen) {
+      delete [] pFrame->pNalLen;
+    }
+    pFrame->iNalLenNum = iNalNum;
+    pFrame->pNalLen = new int32_t[iNalNum];
+  }
+  if ((iBsSize > 0 && NULL == pFrame->pBsBuf) || (iNalNum > 0 && NULL == pFrame->pNalLen)) {
+    FreeFrame (pFrame);
+    pBsInfo->iLayerNum = 0;
+    return cmMallocMemeError;
+  }
+
+  // the layers point to the bitstream buffer of the encoding context, which the next frame overwrites
+  uint8_t* pBsBuf = pFrame->pBsBuf;
+  int32_t* pNalLen = pFrame->pNalLen;
+  for (iLayer = 0; iLayer < pBsInfo->iLayerNum; iLayer++) {
+    SLayerBSInfo* pLayerBsInfo = &pBsInfo->sLayerInfo[iLayer];
+    int32_t iLayerSize = 0;
+    for (iNal = 0; iNal < pLayerBsInfo->iNalCount; iNal++) {
+      pNalLen[iNal] = pLayerBsInfo->pNalLengthInByte[iNal];
+      iLayerSize += pNalLen[iNal];
+    }
+    memcpy (pBsBuf, pLayerBsInfo->pBsBuf, iLayerSize);
+    pLayerBsInfo->pBsBuf = pBsBuf;
+    pLayerBsInfo->pNalLengthInByte = pNalLen;
+    pBsBuf += iLayerSize;
+    pNalLen += pLayerBsInfo->iNalCount;
+  }
+  return cmResultSuccess;
+}
+
+CWelsAsyncEncoder::SAsyncFrame* CWelsAsyncEncoder::PopOutput() {
+  SAsyncFrame* pFrame = &m_sFrames[m_iHead];
+  m_iHead = (m_iHead + 1) % m_iFrameNum;
+  -- m_iHeldNum;
+  -- m_iPreparedNum;
+  -- m_iDoneNum;
+  return pFrame;
+}
+
+bool CWelsAsyncEncoder::CanEncodeNext() {
+  // the costs of the lookahead window are of the frames prepared
+  const int32_t kiPendingNum = m_iPreparedNum - m_iDoneNum;
+  return (kiPendingNum > 0) && (kiPendingNum > m_iLookaheadDepth || (m_bFlushing && m_iPreparedNum == m_iHeldNum));
+}
+
+void CWelsAsyncEncoder::PrepareFrame (SAsyncFrame* pFrame) {
+  if (m_pLookahead) {
+    pFrame->iLookaheadCost = m_pLookahead->Analyze (&pFrame->sSrcPic);
+  }
+  pFrame->bPrepared = m_bPrepareSource && (0 == m_pPreProcess->Prepare (&pFrame->sSrcPic, &pFrame->sPrepared));
+}
+
+void CWelsAsyncEncoder::ExecutePrepare() {
+  WelsMutexLock (&m_hFrameMutex);
+  while (m_iPreparedNum < m_iHeldNum) {
+    // the frames are popped once encoded, so not before prepared
+    SAsyncFrame* pFrame = &m_sFrames[(m_iHead + m_iPreparedNum) % m_iFrameNum];
+    WelsMutexUnlock (&m_hFrameMutex);
+    PrepareFrame (pFrame);
+    WelsMutexLock (&m_hFrameMutex);
+    ++ m_iPreparedNum;
+    if (CanEncodeNext()) {
+      SignalThread();
+    }
+    WelsCondBroadcast (&m_hFrameCond);
+  }
+  WelsMutexUnlock (&m_hFrameMutex);
+}
+
+void CWelsAsyncEncoder::UpdatePrepareParam() {
+  const SWelsSvcCodingParam* kpParam = m_pEncoder->GetCodingParam();
+  m_bParamChanged = false;
+  m_bPrepareSource = false;
+  if (NULL == kpParam) {
+    return;
+  }
+  if (m_pPreProcess) {
+    m_pPreProcess->SetParam (kpParam);
+  } else {
+    m_pPreProcess = CWelsPreProcessAhead::CreatePreProcessAhead (kpParam);
+  }
+  m_bPrepareSource = (NULL != m_pPreProcess);
+}
+
+void CWelsAsyncEncoder::EncodeNext() {
+  SAsyncFrame* pFrame = &m_sFrames[(m_iHead + m_iDoneNum) % m_iFrameNum];
+  int64_t iCost[MAX_LOOKAHEAD_DEPTH + 1];
+  int32_t iCostNum = 0;
+  if (m_pLookahead) {
+    iCostNum = WELS_MIN (m_iPreparedNum - m_iDoneNum, m_iLookaheadDepth + 1);
+    for (int32_t i = 0; i < iCostNum; i++) {
+      iCost[i] = m_sFrames[(m_iHead + m_iDoneNum + i) % m_iFrameNum].iLookaheadCost;
+    }
+  }
+  WelsMutexUnlock (&m_hFrameMutex);
+
+  if (m_pLookahead) {
+    m_pEncoder->SetLookahead (iCost, iCostNum);
+  }
+  if (pFrame->bPrepared) {
+    m_pEncoder->SetPreparedSource (&pFrame->sPrepared);
+  }
+  pFrame->iResult = m_pEncoder->EncodeFrameSync (&pFrame->sSrcPic, &pFrame->sBsInfo);
+  if (pFrame->bPrepared) {
+    m_pEncoder->SetPreparedSource (NULL);
+  }
+  if (m_sParam.pfOnFrameEncoded) {
+    m_sParam.pfOnFrameEncoded (m_sParam.pContext, pFrame->iResult, &pFrame->sBsInfo);
+  } else if (pFrame->iResult == cmResultSuccess) {
+    pFrame->iResult = CopyBitstream (pFrame);
+  }
+
+  WelsMutexLock (&m_hFrameMutex);
+  if (m_sParam.pfOnFrameEncoded) {
+    m_iHead = (m_iHead + 1) % m_iFrameNum;
+    -- m_iHeldNum;
+    -- m_iPreparedNum;
+  } else {
+    ++ m_iDoneNum;
+  }
+  WelsCondBroadcast (&m_hFrameCond);
+}
+
+void CWelsAsyncEncoder::WaitForFrames (const int32_t kiMaxPendingNum, const bool kbPrepared) {
+  if (m_bStarted && m_iHeldNum - m_iDoneNum > kiMaxPendingNum) {
+    // the thread keeps on encoding while it can, m_bFlushing may have just been set
+    SignalThread();
+  }
+  while (m_iHeldNum - m_iDoneNum > kiMaxPendingNum || (kbPrepared && m_iPreparedNum < m_iHeldNum)) {
+    if (m_bStarted) {
+      WelsCondWait (&m_hFrameCond, &m_hFrameMutex);
+    } else if (CanEncodeNext()) {
+      EncodeNext();
+    } else {
+      break;
+    }
+  }
+}
+
+int CWelsAsyncEncoder::EncodeFrame (const SSourcePicture* kpSrcPic, SFrameBSInfo* pBsInfo) {
+  const bool kbPolled = (NULL == m_sParam.pfOnFrameEncoded);
+  const int32_t kiMaxHeldNum = m_iFrameNum - 1;
+  SAsyncFrame* pOutput = NULL;
+  int32_t iReturn = cmResultSuccess;
+
+  // the frame output by the previous call is released from here on
+  WelsMutexLock (&m_hFrameMutex);
+  if (kpSrcPic) {
+    if (m_bParamChanged) {
+      // no frame is encoded or prepared while the parameters are taken
+      WaitForFrames (m_bFlushing ? 0 : m_iLookaheadDepth, true);
+      UpdatePrepareParam();
+    }
+    m_bFlushing = false;
+    if (m_iHeldNum == kiMaxHeldNum) {
+      // the oldest frame leaves the ring when encoded if called back, when output otherwise
+      WaitForFrames (kiMaxHeldNum - 1);
+      if (kbPolled) {
+        pOutput = PopOutput();
+      }
+    }
+    // the frame is not visible to the encoding thread until counted as held
+    SAsyncFrame* pFrame = &m_sFrames[(m_iHead + m_iHeldNum) % m_iFrameNum];
+    WelsMutexUnlock (&m_hFrameMutex);
+    iReturn = CopySource (pFrame, kpSrcPic);
+    if (iReturn == cmResultSuccess && !m_bStarted) {
+      PrepareFrame (pFrame);
+    }
+    WelsMutexLock (&m_hFrameMutex);
+    if (iReturn == cmResultSuccess) {
+      ++ m_iHeldNum;
+      if (m_bStarted) {
+        m_pPrepareThread->Signal();
+      } else {
+        ++ m_iPreparedNum;
+        while (CanEncodeNext()) {
+          EncodeNext();
+        }
+      }
+    }
+  } else {
+    // flush, till the oldest frame is encoded if polled, till all the frames are encoded otherwise
+    m_bFlushing = true;
+    WaitForFrames (kbPolled ? WELS_MAX (m_iHeldNum - 1, 0) : 0);
+  }
+  if (kbPolled && NULL == pOutput && m_iDoneNum > 0) {
+    pOutput = PopOutput();
+  }
+  WelsMutexUnlock (&m_hFrameMutex);
+
+  if (pOutput) {
+    *pBsInfo = pOutput->sBsInfo;
+    return (iReturn != cmResultSuccess) ? iReturn : pOutput->iResult;
+  }
+  pBsInfo->iLayerNum  = 0;
+  pBsInfo->eFrameType = videoFrameTypeInvalid;
+  pBsInfo->iFrameSizeInBytes = 0;
+  return iReturn;
+}
+
+void CWelsAsyncEncoder::Sync() {
+  WelsMutexLock (&m_hFrameMutex);
+  m_bFlushing = true;
+  WaitForFrames (0, true);
+  // the options may be set till the next frame
+  m_bParamChanged = m_bStarted;
+  WelsMutexUnlock (&m_hFrameMutex);
+}
+
+void CWelsAsyncEncoder::WaitIdle() {
+  // the thread stops with the frames of the lookahead window left to be encoded, unless flushing
+  WelsMutexLock (&m_hFrameMutex);
+  WaitForFrames (m_bFlushing ? 0 : m_iLookaheadDepth, true);
+  m_bParamChanged = m_bStarted;
+  WelsMutexUnlock (&m_hFrameMutex);
+}
+
+void CWelsAsyncEncoder::ExecuteTask() {
+  WelsMutexLock (&m_hFrameMutex);
+  while (CanEncodeNext()) {
+    EncodeNext();
+  }
+  WelsMutexUnlock (&m_hFrameMutex);
+}
+
 /*
  *  Force key frame
  */
 int CWelsH264SVCEncoder::ForceIntraFrame (bool bIDR, int iLayerId) {
+  if (m_pAsyncEncoder) {
+    m_pAsyncEncoder->Sync();
+  }
+  if (bIDR && m_iLayerEncoderNum > 0) {
+    for (int32_t iLayer = 0; iLayer < m_iLayerEncoderNum; iLayer++) {
+      if (iLayerId < 0 || iLayerId >= m_iLayerEncoderNum || iLayerId == iLayer) {
+        m_pLayerEncoders[iLayer]->ForceIntraFrame (true);
+      }
+    }
+    return 0;
+  }
   if (bIDR) {
     if (! (m_pEncContext && m_bInitialFlag)) {
       return 1;
@@ -688,8 +1619,29 @@ int CWelsH264SVCEncoder::SetOption (ENCODER_OPTION eOptionId, void* pOption) {
     return cmInitParaError;
   }
 
-  if ((NULL == m_pEncContext || false == m_bInitialFlag) && eOptionId != ENCODER_OPTION_TRACE_LEVEL
-      && eOptionId != ENCODER_OPTION_TRACE_CALLBACK && eOptionId != ENCODER_OPTION_TRACE_CALLBACK_CONTEXT) {
+  // options of this instance, not of the encoding context
+  const bool kbInstanceOption = (eOptionId == ENCODER_OPTION_TRACE_LEVEL) || (eOptionId == ENCODER_OPTION_TRACE_CALLBACK)
+                                || (eOptionId == ENCODER_OPTION_TRACE_CALLBACK_CONTEXT) || (eOptionId == ENCODER_OPTION_THREAD_POOL)
+                                || (eOptionId == ENCODER_OPTION_SIMULCAST_LAYER_THREADING)
+                                || (eOptionId == ENCODER_OPTION_WAVEFRONT_THREADS) || (eOptionId == ENCODER_OPTION_ASYNC_ENCODING)
+                                || (eOptionId == ENCODER_OPTION_RC_LOOKAHEAD) || (eOptionId == ENCODER_OPTION_TWO_PASS)
+                                || (eOptionId == ENCODER_OPTION_HIERARCHICAL_ME) || (eOptionId == ENCODER_OPTION_MEMORY_ARENA);
+  // the frames submitted are encoded at the resolution and with the layers they were submitted for, the other options
+  // apply to the frames not encoded yet, the ones of the lookahead window included
+  const bool kbLayersOption = (eOptionId == ENCODER_OPTION_SVC_ENCODE_PARAM_BASE)
+                              || (eOptionId == ENCODER_OPTION_SVC_ENCODE_PARAM_EXT) || (eOptionId == ENCODER_OPTION_SPS_PPS_ID_STRATEGY);
+  if (m_pAsyncEncoder) {
+    if (kbLayersOption) {
+      m_pAsyncEncoder->Sync();
+    } else {
+      m_pAsyncEncoder->WaitIdle();
+    }
+  }
+  if (m_iLayerEncoderNum > 0 && !kbInstanceOption) {
+    return SetLayerEncodersOption (eOptionId, pOption);
+  }
+
+  if ((NULL == m_pEncContext || false == m_bInitialFlag) && !kbInstanceOption) {
     return cmInitExpected;
   }
 
@@ -1179,6 +2131,112 @@ int CWelsH264SVCEncoder::SetOption (ENCODER_OPTION eOptionId, void* pOption) {
              "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_BITS_VARY_PERCENTAGE,iBitsVaryPercentage = %d", iValue);
   }
   break;
+  case ENCODER_OPTION_THREAD_POOL: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_THREAD_POOL, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    const SThreadPoolParam* pPoolParam = static_cast<const SThreadPoolParam*> (pOption);
+    if (pPoolParam->iThreadNum < 0 || pPoolParam->iThreadNum > MAX_THREADS_NUM) {
+      return cmInitParaError;
+    }
+    m_sThreadPoolParam = *pPoolParam;
+    m_bThreadPoolParam = true;
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_THREAD_POOL, iPoolId = %d, iThreadNum = %d, iNumaNode = %d",
+             pPoolParam->iPoolId, pPoolParam->iThreadNum, pPoolParam->iNumaNode);
+  }
+  break;
+  case ENCODER_OPTION_SIMULCAST_LAYER_THREADING: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_SIMULCAST_LAYER_THREADING, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_bLayerThreading = * ((bool*)pOption);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_SIMULCAST_LAYER_THREADING, m_bLayerThreading = %d",
+             m_bLayerThreading);
+  }
+  break;
+  case ENCODER_OPTION_WAVEFRONT_THREADS: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_WAVEFRONT_THREADS, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_iWavefrontThreadNum = WELS_CLIP3 (* ((int32_t*)pOption), 0, MAX_THREADS_NUM);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_WAVEFRONT_THREADS, m_iWavefrontThreadNum = %d",
+             m_iWavefrontThreadNum);
+  }
+  break;
+  case ENCODER_OPTION_ASYNC_ENCODING: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_ASYNC_ENCODING, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_sAsyncParam = * ((SEncAsyncParam*)pOption);
+    m_sAsyncParam.iMaxFramesInFlight = WELS_CLIP3 (m_sAsyncParam.iMaxFramesInFlight, 0, MAX_ASYNC_FRAME_NUM);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_ASYNC_ENCODING, iMaxFramesInFlight = %d",
+             m_sAsyncParam.iMaxFramesInFlight);
+  }
+  break;
+  case ENCODER_OPTION_RC_LOOKAHEAD: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_RC_LOOKAHEAD, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_iLookaheadDepth = WELS_CLIP3 (* ((int32_t*)pOption), 0, MAX_LOOKAHEAD_DEPTH);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_RC_LOOKAHEAD, m_iLookaheadDepth = %d",
+             m_iLookaheadDepth);
+  }
+  break;
+  case ENCODER_OPTION_TWO_PASS: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_TWO_PASS, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    const SEncTwoPassParam* kpTwoPassParam = (SEncTwoPassParam*)pOption;
+    m_iTwoPass = WELS_CLIP3 (kpTwoPassParam->iPass, 0, 2);
+    m_sTwoPassStatsFile[0] = '\0';
+    if (NULL != kpTwoPassParam->pStatsFileName)
+      WelsStrncpy (m_sTwoPassStatsFile, MAX_FNAME_LEN, kpTwoPassParam->pStatsFileName);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_TWO_PASS, m_iTwoPass = %d, stats file = %s",
+             m_iTwoPass, m_sTwoPassStatsFile);
+  }
+  break;
+  case ENCODER_OPTION_HIERARCHICAL_ME: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_HIERARCHICAL_ME, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_bHierarchicalMe = * ((bool*)pOption);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_HIERARCHICAL_ME, m_bHierarchicalMe = %d",
+             m_bHierarchicalMe);
+  }
+  break;
+  case ENCODER_OPTION_MEMORY_ARENA: {
+    if (m_bInitialFlag) {
+      WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_WARNING,
+               "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_MEMORY_ARENA, should be set before Initialize()!");
+      return cmInitParaError;
+    }
+    m_sMemoryArena = * ((SMemoryArenaParam*)pOption);
+    WelsLog (&m_pWelsTrace->m_sLogCtx, WELS_LOG_INFO,
+             "CWelsH264SVCEncoder::SetOption():ENCODER_OPTION_MEMORY_ARENA, uiRegionSize = %u, bHugePages = %d",
+             m_sMemoryArena.uiRegionSize, m_sMemoryArena.bHugePages);
+  }
+  break;
 
   default:
     return cmInitParaError;
@@ -1191,6 +2249,17 @@ int CWelsH264SVCEncoder::GetOption (ENCODER_OPTION eOptionId, void* pOption) {
   if (NULL == pOption) {
     return cmInitParaError;
   }
+  // the defaults before set, so also before the initialization
+  if (ENCODER_OPTION_THREAD_POOL == eOptionId) {
+    * ((SThreadPoolParam*)pOption) = m_sThreadPoolParam;
+    return cmResultSuccess;
+  }
+  if (m_pAsyncEncoder) {
+    m_pAsyncEncoder->WaitIdle();
+  }
+  if (m_iLayerEncoderNum > 0) {
+    return GetLayerEncodersOption (eOptionId, pOption);
+  }
   if (NULL == m_pEncContext || false == m_bInitialFlag) {
     return cmInitExpected;
   }
@@ -1294,6 +2363,10 @@ int CWelsH264SVCEncoder::GetOption (ENCODER_OPTION eOptionId, void* pOption) {
     * ((int32_t*)pOption) =  m_pEncContext->pSvcParam->iComplexityMode;
   }
   break;
+  case ENCODER_OPTION_MEMORY_USAGE: {
+    m_pEncContext->pMemAlign->WelsGetTagUsage (static_cast<SMemoryUsage*> (pOption));
+  }
+  break;
   default:
     return cmInitParaError;
   }
@@ -1,6 +1,7 @@
 ENCODER_SRCDIR=codec/encoder
 ENCODER_CPP_SRCS=\
 	$(ENCODER_SRCDIR)/core/src/au_set.cpp\
+	$(ENCODER_SRCDIR)/core/src/buffer_pool.cpp\
 	$(ENCODER_SRCDIR)/core/src/deblocking.cpp\
 	$(ENCODER_SRCDIR)/core/src/decode_mb_aux.cpp\
 	$(ENCODER_SRCDIR)/core/src/encode_mb_aux.cpp\
@@ -27,10 +28,12 @@ ENCODER_CPP_SRCS=\
 	$(ENCODER_SRCDIR)/core/src/svc_motion_estimate.cpp\
 	$(ENCODER_SRCDIR)/core/src/svc_set_mb_syn_cabac.cpp\
 	$(ENCODER_SRCDIR)/core/src/svc_set_mb_syn_cavlc.cpp\
+	$(ENCODER_SRCDIR)/core/src/wels_lookahead.cpp\
 	$(ENCODER_SRCDIR)/core/src/wels_preprocess.cpp\
 	$(ENCODER_SRCDIR)/core/src/wels_task_base.cpp\
 	$(ENCODER_SRCDIR)/core/src/wels_task_encoder.cpp\
 	$(ENCODER_SRCDIR)/core/src/wels_task_management.cpp\
+	$(ENCODER_SRCDIR)/core/src/wels_task_wavefront.cpp\
 	$(ENCODER_SRCDIR)/plus/src/welsEncoderExt.cpp\
 
 ENCODER_OBJS += $(ENCODER_CPP_SRCS:.cpp=.$(OBJ))
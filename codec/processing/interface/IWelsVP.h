@@ -168,6 +168,11 @@ typedef struct {
   SScrollDetectionParam sScrollResult; //results from scroll detection
 } SSceneChangeResult;
 
+typedef struct {
+  unsigned short    uiMotionIndex;
+  unsigned short    uiTextureIndex;
+} SMotionTextureUnit;
+
 typedef struct {
   unsigned char* pCurY;             // Y data of current frame
   unsigned char* pRefY;             // Y data of pRef frame for diff calc
@@ -178,6 +183,9 @@ typedef struct {
   int   (*pSumOfDiff8x8)[4];
   unsigned char (*pMad8x8)[4];
   int iFrameSad;                    // sad of frame
+  SMotionTextureUnit* pMotionTextureUnit; // motion and texture index of 16x16 if calculated along with ssd, else NULL
+  long long iMotionIndexSum;        // sum of the motion index of frame
+  long long iTextureIndexSum;       // sum of the texture index of frame
 } SVAACalcResult;
 
 typedef struct {
@@ -186,6 +194,7 @@ typedef struct {
   int iCalcSsd;
   int iReserved;
   SVAACalcResult*  pCalcResult;
+  SMotionTextureUnit* pMotionTextureUnit; // filled along with the ssd for adaptive quantization if not NULL
 } SVAACalcParam;
 
 typedef struct {
@@ -198,11 +207,6 @@ typedef enum {
   AQ_BITRATE_MODE    //Bitrate mode
 } EAQModes;
 
-typedef struct {
-  unsigned short    uiMotionIndex;
-  unsigned short    uiTextureIndex;
-} SMotionTextureUnit;
-
 typedef struct {
   int                  iAdaptiveQuantMode; // 0:quality mode, 1:bitrates mode
   SVAACalcResult*      pCalcResult;
@@ -238,6 +242,16 @@ typedef struct {
   int  iIdrFlag;
   SScrollDetectionParam sScrollResult;
 } SComplexityAnalysisScreenParam;
+
+typedef enum {
+  VP_FEATURE_THREADING = 1   // SpecialFeature() with pIn of SVpThreadingParam, pOut unused
+} EVpFeature;
+
+typedef struct {
+  int   iThreadNum;          // threads processing a picture, the calling thread included, 1 (default) for the latter only
+  void* pThreadPoolParam;    // SThreadPoolParam* of the pool of the other threads, NULL for the process-wide pool
+} SVpThreadingParam;
+
 /////////////////////////////////////////////////////////////////////////////////////////////
 
 typedef struct {
@@ -49,6 +49,14 @@ CAdaptiveQuantization::CAdaptiveQuantization (int32_t iCpuFlag) {
   m_pfVar   = NULL;
   WelsMemset (&m_sAdaptiveQuantParam, 0, sizeof (m_sAdaptiveQuantParam));
   WelsInitVarFunc (m_pfVar, m_CPUFlag);
+
+  m_pRefFrameY = m_pCurFrameY = NULL;
+  m_iRefStride = m_iCurStride = 0;
+  m_iMbWidth   = m_iMbHeight = 0;
+  m_bVaaCalcResult = false;
+  m_iAverageMotionIndex = m_iAverageTextureIndex = 0;
+  m_iPass   = 0;
+  m_iJobNum = 0;
 }
 
 CAdaptiveQuantization::~CAdaptiveQuantization() {
@@ -63,85 +71,40 @@ EResult CAdaptiveQuantization::Process (int32_t iType, SPixMap* pSrcPixMap, SPix
   int32_t iMbHeight = iHeight >> 4;
   int32_t iMbTotalNum    = iMbWidth * iMbHeight;
 
-  SMotionTextureUnit* pMotionTexture = NULL;
   SVAACalcResult*     pVaaCalcResults = NULL;
-  int32_t   iMotionTextureIndexToDeltaQp = 0;
   int32_t iAverMotionTextureIndexToDeltaQp = 0;  // double to uint32
   int64_t iAverageMotionIndex = 0;      // double to float
   int64_t iAverageTextureIndex = 0;
+  int32_t i = 0;
 
-  int64_t iQStep = 0;
-  int64_t iLumaMotionDeltaQp = 0;
-  int64_t iLumaTextureDeltaQp = 0;
+  m_pRefFrameY = (uint8_t*)pRefPixMap->pPixel[0];
+  m_pCurFrameY = (uint8_t*)pSrcPixMap->pPixel[0];
 
-  uint8_t* pRefFrameY = NULL, *pCurFrameY = NULL;
-  int32_t iRefStride = 0, iCurStride = 0;
-
-  uint8_t* pRefFrameTmp = NULL, *pCurFrameTmp = NULL;
-  int32_t i = 0, j = 0;
-
-  pRefFrameY = (uint8_t*)pRefPixMap->pPixel[0];
-  pCurFrameY = (uint8_t*)pSrcPixMap->pPixel[0];
-
-  iRefStride  = pRefPixMap->iStride[0];
-  iCurStride  = pSrcPixMap->iStride[0];
+  m_iRefStride  = pRefPixMap->iStride[0];
+  m_iCurStride  = pSrcPixMap->iStride[0];
+  m_iMbWidth    = iMbWidth;
+  m_iMbHeight   = iMbHeight;
+  m_iJobNum     = GetJobNum (iMbHeight, 2);
 
   /////////////////////////////////////// motion //////////////////////////////////
   //  motion MB residual variance
-  iAverageMotionIndex = 0;
-  iAverageTextureIndex = 0;
-  pMotionTexture = m_sAdaptiveQuantParam.pMotionTextureUnit;
+  //  filled by the VAA calculation of the same pictures already, else from the pictures
   pVaaCalcResults = m_sAdaptiveQuantParam.pCalcResult;
+  m_bVaaCalcResult = (pVaaCalcResults->pRefY == m_pRefFrameY && pVaaCalcResults->pCurY == m_pCurFrameY
+                      && pVaaCalcResults->pMotionTextureUnit == m_sAdaptiveQuantParam.pMotionTextureUnit);
 
-  if (pVaaCalcResults->pRefY == pRefFrameY && pVaaCalcResults->pCurY == pCurFrameY) {
-    int32_t iMbIndex = 0;
-    int32_t iSumDiff, iSQDiff, uiSum, iSQSum;
-    for (j = 0; j < iMbHeight; j ++) {
-      pRefFrameTmp  = pRefFrameY;
-      pCurFrameTmp  = pCurFrameY;
-      for (i = 0; i < iMbWidth; i++) {
-        iSumDiff =  pVaaCalcResults->pSad8x8[iMbIndex][0];
-        iSumDiff += pVaaCalcResults->pSad8x8[iMbIndex][1];
-        iSumDiff += pVaaCalcResults->pSad8x8[iMbIndex][2];
-        iSumDiff += pVaaCalcResults->pSad8x8[iMbIndex][3];
-
-        iSQDiff = pVaaCalcResults->pSsd16x16[iMbIndex];
-        uiSum = pVaaCalcResults->pSum16x16[iMbIndex];
-        iSQSum = pVaaCalcResults->pSumOfSquare16x16[iMbIndex];
-
-        iSumDiff = iSumDiff >> 8;
-        pMotionTexture->uiMotionIndex = (iSQDiff >> 8) - (iSumDiff * iSumDiff);
-
-        uiSum = uiSum >> 8;
-        pMotionTexture->uiTextureIndex = (iSQSum >> 8) - (uiSum * uiSum);
-
-        iAverageMotionIndex += pMotionTexture->uiMotionIndex;
-        iAverageTextureIndex += pMotionTexture->uiTextureIndex;
-        pMotionTexture++;
-        ++iMbIndex;
-        pRefFrameTmp += MB_WIDTH_LUMA;
-        pCurFrameTmp += MB_WIDTH_LUMA;
-      }
-      pRefFrameY += (iRefStride) << 4;
-      pCurFrameY += (iCurStride) << 4;
-    }
+  if (m_bVaaCalcResult) {
+    iAverageMotionIndex = pVaaCalcResults->iMotionIndexSum;
+    iAverageTextureIndex = pVaaCalcResults->iTextureIndexSum;
   } else {
-    for (j = 0; j < iMbHeight; j ++) {
-      pRefFrameTmp  = pRefFrameY;
-      pCurFrameTmp  = pCurFrameY;
-      for (i = 0; i < iMbWidth; i++) {
-        m_pfVar (pRefFrameTmp, iRefStride, pCurFrameTmp, iCurStride, pMotionTexture);
-        iAverageMotionIndex += pMotionTexture->uiMotionIndex;
-        iAverageTextureIndex += pMotionTexture->uiTextureIndex;
-        pMotionTexture++;
-        pRefFrameTmp += MB_WIDTH_LUMA;
-        pCurFrameTmp += MB_WIDTH_LUMA;
-
-      }
-      pRefFrameY += (iRefStride) << 4;
-      pCurFrameY += (iCurStride) << 4;
+    m_iPass = 0;
+    RunJobs (this, m_iJobNum);
+    for (i = 0; i < m_iJobNum; i++) {
+      iAverageMotionIndex += m_iBandMotionIndex[i];
+      iAverageTextureIndex += m_iBandTextureIndex[i];
     }
   }
+
   iAverageMotionIndex = WELS_DIV_ROUND64 (iAverageMotionIndex * AQ_INT_MULTIPLY, iMbTotalNum);
   iAverageTextureIndex = WELS_DIV_ROUND64 (iAverageTextureIndex * AQ_INT_MULTIPLY, iMbTotalNum);
   if ((iAverageMotionIndex <= AQ_PESN) && (iAverageMotionIndex >= -AQ_PESN)) {
@@ -152,7 +115,6 @@ EResult CAdaptiveQuantization::Process (int32_t iType, SPixMap* pSrcPixMap, SPix
   }
   //  motion mb residual map to QP
   //  texture mb original map to QP
-  iAverMotionTextureIndexToDeltaQp = 0;
   iAverageMotionIndex = WELS_DIV_ROUND64 (AVERAGE_TIME_MOTION * iAverageMotionIndex, AQ_TIME_INT_MULTIPLY);
 
   if (m_sAdaptiveQuantParam.iAdaptiveQuantMode == AQ_QUALITY_MODE) {
@@ -161,19 +123,83 @@ EResult CAdaptiveQuantization::Process (int32_t iType, SPixMap* pSrcPixMap, SPix
     iAverageTextureIndex = WELS_DIV_ROUND64 (AVERAGE_TIME_TEXTURE_BITRATEMODE * iAverageTextureIndex, AQ_TIME_INT_MULTIPLY);
   }
 
+  m_iAverageMotionIndex  = iAverageMotionIndex;
+  m_iAverageTextureIndex = iAverageTextureIndex;
+  m_iPass = 1;
+  RunJobs (this, m_iJobNum);
+  for (i = 0; i < m_iJobNum; i++) {
+    iAverMotionTextureIndexToDeltaQp += m_iBandDeltaQp[i];
+  }
+
+  m_sAdaptiveQuantParam.iAverMotionTextureIndexToDeltaQp = iAverMotionTextureIndexToDeltaQp / iMbTotalNum;
+
+  eReturn = RET_SUCCESS;
+
+  return eReturn;
+}
+
+void CAdaptiveQuantization::RunJob (int32_t iJobIdx) {
+  const int32_t kiMbRowStart = iJobIdx * m_iMbHeight / m_iJobNum;
+  const int32_t kiMbRowEnd   = (iJobIdx + 1) * m_iMbHeight / m_iJobNum;
+  if (m_iPass == 0) {
+    MotionTextureIndex (kiMbRowStart, kiMbRowEnd, &m_iBandMotionIndex[iJobIdx], &m_iBandTextureIndex[iJobIdx]);
+  } else {
+    m_iBandDeltaQp[iJobIdx] = MotionTextureIndexToDeltaQp (kiMbRowStart, kiMbRowEnd);
+  }
+}
+
+void CAdaptiveQuantization::MotionTextureIndex (int32_t iMbRowStart, int32_t iMbRowEnd, int64_t* pMotionIndexSum,
+    int64_t* pTextureIndexSum) {
+  SMotionTextureUnit* pMotionTexture = m_sAdaptiveQuantParam.pMotionTextureUnit + iMbRowStart * m_iMbWidth;
+  int64_t iAverageMotionIndex = 0;
+  int64_t iAverageTextureIndex = 0;
+
+  uint8_t* pRefFrameY = m_pRefFrameY + ((iMbRowStart * m_iRefStride) << 4);
+  uint8_t* pCurFrameY = m_pCurFrameY + ((iMbRowStart * m_iCurStride) << 4);
+  uint8_t* pRefFrameTmp = NULL, *pCurFrameTmp = NULL;
+  int32_t i = 0, j = 0;
+
+  for (j = iMbRowStart; j < iMbRowEnd; j ++) {
+    pRefFrameTmp  = pRefFrameY;
+    pCurFrameTmp  = pCurFrameY;
+    for (i = 0; i < m_iMbWidth; i++) {
+      m_pfVar (pRefFrameTmp, m_iRefStride, pCurFrameTmp, m_iCurStride, pMotionTexture);
+      iAverageMotionIndex += pMotionTexture->uiMotionIndex;
+      iAverageTextureIndex += pMotionTexture->uiTextureIndex;
+      pMotionTexture++;
+      pRefFrameTmp += MB_WIDTH_LUMA;
+      pCurFrameTmp += MB_WIDTH_LUMA;
+
+    }
+    pRefFrameY += (m_iRefStride) << 4;
+    pCurFrameY += (m_iCurStride) << 4;
+  }
+  *pMotionIndexSum = iAverageMotionIndex;
+  *pTextureIndexSum = iAverageTextureIndex;
+}
+
+int32_t CAdaptiveQuantization::MotionTextureIndexToDeltaQp (int32_t iMbRowStart, int32_t iMbRowEnd) {
+  SMotionTextureUnit* pMotionTexture = m_sAdaptiveQuantParam.pMotionTextureUnit + iMbRowStart * m_iMbWidth;
+  int32_t iMotionTextureIndexToDeltaQp = 0;
+  int32_t iAverMotionTextureIndexToDeltaQp = 0;
+
+  int64_t iQStep = 0;
+  int64_t iLumaMotionDeltaQp = 0;
+  int64_t iLumaTextureDeltaQp = 0;
+  int32_t i = 0, j = 0;
+
   int64_t iAQ_EPSN = - ((int64_t)AQ_PESN * AQ_TIME_INT_MULTIPLY * AQ_QSTEP_INT_MULTIPLY / AQ_INT_MULTIPLY);
-  pMotionTexture = m_sAdaptiveQuantParam.pMotionTextureUnit;
-  for (j = 0; j < iMbHeight; j ++) {
-    for (i = 0; i < iMbWidth; i++) {
+  for (j = iMbRowStart; j < iMbRowEnd; j ++) {
+    for (i = 0; i < m_iMbWidth; i++) {
       int64_t a = WELS_DIV_ROUND64 ((int64_t) (pMotionTexture->uiTextureIndex) * AQ_INT_MULTIPLY * AQ_TIME_INT_MULTIPLY,
-                                    iAverageTextureIndex);
+                                    m_iAverageTextureIndex);
       iQStep = WELS_DIV_ROUND64 ((a - AQ_TIME_INT_MULTIPLY) * AQ_QSTEP_INT_MULTIPLY, (a + MODEL_ALPHA));
       iLumaTextureDeltaQp = MODEL_TIME * iQStep;// range +- 6
 
       iMotionTextureIndexToDeltaQp = ((int32_t) (iLumaTextureDeltaQp / (AQ_TIME_INT_MULTIPLY)));
 
       a = WELS_DIV_ROUND64 (((int64_t)pMotionTexture->uiMotionIndex) * AQ_INT_MULTIPLY * AQ_TIME_INT_MULTIPLY,
-                            iAverageMotionIndex);
+                            m_iAverageMotionIndex);
       iQStep = WELS_DIV_ROUND64 ((a - AQ_TIME_INT_MULTIPLY) * AQ_QSTEP_INT_MULTIPLY, (a + MODEL_ALPHA));
       iLumaMotionDeltaQp = MODEL_TIME * iQStep;// range +- 6
 
@@ -182,18 +208,13 @@ EResult CAdaptiveQuantization::Process (int32_t iType, SPixMap* pSrcPixMap, SPix
         iMotionTextureIndexToDeltaQp += ((int32_t) (iLumaMotionDeltaQp / (AQ_TIME_INT_MULTIPLY)));
       }
 
-      m_sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp[j * iMbWidth + i] = (int8_t) (iMotionTextureIndexToDeltaQp /
+      m_sAdaptiveQuantParam.pMotionTextureIndexToDeltaQp[j * m_iMbWidth + i] = (int8_t) (iMotionTextureIndexToDeltaQp /
           AQ_QSTEP_INT_MULTIPLY);
       iAverMotionTextureIndexToDeltaQp += iMotionTextureIndexToDeltaQp;
       pMotionTexture++;
     }
   }
-
-  m_sAdaptiveQuantParam.iAverMotionTextureIndexToDeltaQp = iAverMotionTextureIndexToDeltaQp / iMbTotalNum;
-
-  eReturn = RET_SUCCESS;
-
-  return eReturn;
+  return iAverMotionTextureIndexToDeltaQp;
 }
 
 
@@ -74,7 +74,7 @@ VarFunc      SampleVariance16x16_AArch64_neon;
 WELSVP_EXTERN_C_END
 #endif
 
-class CAdaptiveQuantization : public IStrategy {
+class CAdaptiveQuantization : public IStrategy, public IJobRunner {
  public:
   CAdaptiveQuantization (int32_t iCpuFlag);
   ~CAdaptiveQuantization();
@@ -83,13 +83,33 @@ class CAdaptiveQuantization : public IStrategy {
   EResult Set (int32_t iType, void* pParam);
   EResult Get (int32_t iType, void* pParam);
 
+  // band of MB rows of the pass m_iPass, the indexes of the MBs then their delta QPs from the averages
+  void RunJob (int32_t iJobIdx);
+
  private:
   void WelsInitVarFunc (PVarFunc& pfVar, int32_t iCpuFlag);
+  void MotionTextureIndex (int32_t iMbRowStart, int32_t iMbRowEnd, int64_t* pMotionIndexSum, int64_t* pTextureIndexSum);
+  int32_t MotionTextureIndexToDeltaQp (int32_t iMbRowStart, int32_t iMbRowEnd);
 
  private:
   PVarFunc                      m_pfVar;
   int32_t                       m_CPUFlag;
   SAdaptiveQuantizationParam    m_sAdaptiveQuantParam;
+
+  uint8_t*                      m_pRefFrameY;
+  uint8_t*                      m_pCurFrameY;
+  int32_t                       m_iRefStride;
+  int32_t                       m_iCurStride;
+  int32_t                       m_iMbWidth;
+  int32_t                       m_iMbHeight;
+  bool                          m_bVaaCalcResult;
+  int64_t                       m_iAverageMotionIndex;
+  int64_t                       m_iAverageTextureIndex;
+  int32_t                       m_iPass;
+  int32_t                       m_iJobNum;
+  int64_t                       m_iBandMotionIndex[MAX_VP_JOB_NUM];
+  int64_t                       m_iBandTextureIndex[MAX_VP_JOB_NUM];
+  int32_t                       m_iBandDeltaQp[MAX_VP_JOB_NUM];
 };
 
 WELSVP_NAMESPACE_END
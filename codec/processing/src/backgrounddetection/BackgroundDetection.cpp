@@ -54,6 +54,7 @@ CBackgroundDetection::CBackgroundDetection (int32_t iCpuFlag) {
   m_eMethod = METHOD_BACKGROUND_DETECTION;
   WelsMemset (&m_BgdParam, 0, sizeof (m_BgdParam));
   m_iLargestFrameSize = 0;
+  m_iJobNum = 0;
 }
 
 CBackgroundDetection::~CBackgroundDetection() {
@@ -154,14 +155,14 @@ void CBackgroundDetection::GetOUParameters (SVAACalcResult* sVaaCalcInfo, int32_
                           WELS_MIN (WELS_MIN (iSubSD[0], iSubSD[1]), WELS_MIN (iSubSD[2], iSubSD[3]));
 }
 
-void CBackgroundDetection::ForegroundBackgroundDivision (vBGDParam* pBgdParam) {
+void CBackgroundDetection::ForegroundBackgroundDivision (vBGDParam* pBgdParam, int32_t iOURowStart,
+    int32_t iOURowEnd) {
   int32_t iPicWidthInOU         = pBgdParam->iBgdWidth  >> LOG2_BGD_OU_SIZE;
-  int32_t iPicHeightInOU        = pBgdParam->iBgdHeight >> LOG2_BGD_OU_SIZE;
   int32_t iPicWidthInMb         = (15 + pBgdParam->iBgdWidth) >> 4;
 
-  SBackgroundOU* pBackgroundOU = pBgdParam->pOU_array;
+  SBackgroundOU* pBackgroundOU = pBgdParam->pOU_array + iOURowStart * iPicWidthInOU;
 
-  for (int32_t j = 0; j < iPicHeightInOU; j ++) {
+  for (int32_t j = iOURowStart; j < iOURowEnd; j ++) {
     for (int32_t i = 0; i < iPicWidthInOU; i++) {
       GetOUParameters (pBgdParam->pCalcRes, (j * iPicWidthInMb + i) << (LOG2_BGD_OU_SIZE - LOG2_MB_SIZE), iPicWidthInMb,
                        pBackgroundOU);
@@ -372,11 +373,18 @@ void CBackgroundDetection::ForegroundDilationAndBackgroundErosion (vBGDParam* pB
   }
 }
 
+void CBackgroundDetection::RunJob (int32_t iJobIdx) {
+  const int32_t kiPicHeightInOU = m_BgdParam.iBgdHeight >> LOG2_BGD_OU_SIZE;
+  ForegroundBackgroundDivision (&m_BgdParam, iJobIdx * kiPicHeightInOU / m_iJobNum,
+                                (iJobIdx + 1) * kiPicHeightInOU / m_iJobNum);
+}
+
 void CBackgroundDetection::BackgroundDetection (vBGDParam* pBgdParam) {
-  // 1st step: foreground/background coarse division
-  ForegroundBackgroundDivision (pBgdParam);
+  // 1st step: foreground/background coarse division, each OU on its own
+  m_iJobNum = GetJobNum (pBgdParam->iBgdHeight >> LOG2_BGD_OU_SIZE, 2);
+  RunJobs (this, m_iJobNum);
 
-  // 2nd step: foreground dilation and background erosion
+  // 2nd step: foreground dilation and background erosion, in place on the flags of the neighbours so in order
   ForegroundDilationAndBackgroundErosion (pBgdParam);
 }
 
@@ -57,7 +57,7 @@ typedef struct {
   int32_t       iMaxDiffSubSd;
 } SBackgroundOU;
 
-class CBackgroundDetection : public IStrategy {
+class CBackgroundDetection : public IStrategy, public IJobRunner {
  public:
   CBackgroundDetection (int32_t iCpuFlag);
   ~CBackgroundDetection();
@@ -65,6 +65,9 @@ class CBackgroundDetection : public IStrategy {
   EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* pRef);
   EResult Set (int32_t iType, void* pParam);
 
+  // band of OU rows of the coarse division
+  void RunJob (int32_t iJobIdx);
+
  private:
   struct vBGDParam {
     uint8_t*   pCur[3];
@@ -78,6 +81,7 @@ class CBackgroundDetection : public IStrategy {
   } m_BgdParam;
 
   int32_t     m_iLargestFrameSize;
+  int32_t     m_iJobNum;
 
  private:
   inline SBackgroundOU* AllocateOUArrayMemory (int32_t iWidth, int32_t iHeight);
@@ -95,7 +99,7 @@ class CBackgroundDetection : public IStrategy {
 
   void    GetOUParameters (SVAACalcResult* sVaaCalcInfo, int32_t iMbIndex, int32_t iMbWidth,
                            SBackgroundOU* pBackgroundOU);
-  void    ForegroundBackgroundDivision (vBGDParam* pBgdParam);
+  void    ForegroundBackgroundDivision (vBGDParam* pBgdParam, int32_t iOURowStart, int32_t iOURowEnd);
   void    ForegroundDilationAndBackgroundErosion (vBGDParam* pBgdParam);
   void    BackgroundDetection (vBGDParam* pBgdParam);
 };
@@ -0,0 +1,265 @@
+/*!
+ * \copy
+ *     Copyright (c)  2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file        :  JobDispatcher.cpp
+ *
+ * \brief       :  jobs of the strategies run on the threads of a pool
+ *
+ * \date        :  10/18/2026 Created
+ *
+ * \description :
+ *
+ *************************************************************************************
+ */
+
+#include "JobDispatcher.h"
+#include "WelsThreadPool.h"
+
+WELSVP_NAMESPACE_BEGIN
+
+class CJobDispatcher::CJobTask : public WelsCommon::IWelsTask, public WelsCommon::IWelsTaskSink {
+ public:
+  CJobTask (CJobDispatcher* pDispatcher);
+  virtual ~CJobTask() {}
+
+  virtual int Execute();
+  virtual int OnTaskExecuted();
+  virtual int OnTaskCancelled();
+
+  CJobDispatcher* m_pDispatcher;
+  bool            m_bQueued;
+};
+
+CJobDispatcher::CJobTask::CJobTask (CJobDispatcher* pDispatcher)
+  : IWelsTask (this),
+    m_pDispatcher (pDispatcher),
+    m_bQueued (false) {
+}
+
+int CJobDispatcher::CJobTask::Execute() {
+  m_pDispatcher->RunTask();
+  return 0;
+}
+
+int CJobDispatcher::CJobTask::OnTaskExecuted() {
+  m_pDispatcher->OnTaskDone (this);
+  return 0;
+}
+
+int CJobDispatcher::CJobTask::OnTaskCancelled() {
+  m_pDispatcher->OnTaskDone (this);
+  return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+
+CJobDispatcher::CJobDispatcher()
+  : m_pThreadPool (NULL),
+    m_iThreadNum (1),
+    m_iTaskNum (0),
+    m_pRunner (NULL),
+    m_iJobNum (0),
+    m_iNextJob (0),
+    m_iWaiterNum (0),
+    m_bActive (false),
+    m_iRunningNum (0) {
+  WelsMemset (m_pTasks, 0, sizeof (m_pTasks));
+  WelsMutexInit (&m_hMutex);
+  WelsCondInit (&m_hCond);
+}
+
+CJobDispatcher::~CJobDispatcher() {
+  Uninit();
+  WelsCondDestroy (&m_hCond);
+  WelsMutexDestroy (&m_hMutex);
+}
+
+EResult CJobDispatcher::Init (const int32_t kiThreadNum, const SThreadPoolParam* pParam) {
+  Uninit();
+  if (kiThreadNum <= 1) {
+    return RET_SUCCESS;
+  }
+
+  const int32_t kiThreadNumClipped = WELS_MIN (kiThreadNum, MAX_VP_THREAD_NUM);
+  if (NULL != pParam) {
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference (pParam, kiThreadNumClipped);
+  } else {
+    // the size of the process-wide pool is kept when it is created already
+    WelsCommon::CWelsThreadPool::SetThreadNum (kiThreadNumClipped);
+    m_pThreadPool = WelsCommon::CWelsThreadPool::AddReference();
+  }
+  if (NULL == m_pThreadPool) {
+    return RET_OUTOFMEMORY;
+  }
+
+  // the calling thread runs jobs as well
+  m_iTaskNum = WELS_MIN (kiThreadNumClipped - 1, m_pThreadPool->GetThreadNum());
+  for (int32_t i = 0; i < m_iTaskNum; i++) {
+    m_pTasks[i] = new CJobTask (this);
+    if (NULL == m_pTasks[i]) {
+      Uninit();
+      return RET_OUTOFMEMORY;
+    }
+  }
+  m_iThreadNum = m_iTaskNum + 1;
+  return RET_SUCCESS;
+}
+
+void CJobDispatcher::Uninit() {
+  // tasks queued by former runs may be still pending on the pool
+  WelsMutexLock (&m_hMutex);
+  for (int32_t i = 0; i < m_iTaskNum; i++) {
+    while (NULL != m_pTasks[i] && m_pTasks[i]->m_bQueued) {
+      WelsCondWait (&m_hCond, &m_hMutex);
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+  for (int32_t i = 0; i < MAX_VP_THREAD_NUM; i++) {
+    if (NULL != m_pTasks[i]) {
+      delete m_pTasks[i];
+      m_pTasks[i] = NULL;
+    }
+  }
+  m_iTaskNum   = 0;
+  m_iThreadNum = 1;
+
+  if (NULL != m_pThreadPool) {
+    m_pThreadPool->RemoveInstance();
+    m_pThreadPool = NULL;
+  }
+}
+
+int32_t CJobDispatcher::GetJobNum (const int32_t kiUnitNum, const int32_t kiMinUnits) const {
+  if (m_iThreadNum <= 1) {
+    return 1;
+  }
+  const int32_t kiJobNum = WELS_MIN (m_iThreadNum * JOBS_PER_THREAD, kiUnitNum / WELS_MAX (kiMinUnits, 1));
+  return WELS_MAX (kiJobNum, 1);
+}
+
+void CJobDispatcher::Run (IJobRunner* pRunner, const int32_t kiJobNum) {
+  WelsMutexLock (&m_hMutex);
+  if (m_iTaskNum <= 0 || kiJobNum <= 1 || m_bActive) {
+    WelsMutexUnlock (&m_hMutex);
+    for (int32_t i = 0; i < kiJobNum; i++) {
+      pRunner->RunJob (i);
+    }
+    return;
+  }
+
+  m_bActive     = true;
+  m_pRunner     = pRunner;
+  m_iJobNum     = kiJobNum;
+  m_iNextJob    = 0;
+  m_iRunningNum = 0;
+  // the calling thread takes a job as well
+  for (int32_t i = 0, iQueuedNum = 0; i < m_iTaskNum && iQueuedNum < kiJobNum - 1; i++) {
+    CJobTask* pTask = m_pTasks[i];
+    if (!pTask->m_bQueued) {
+      pTask->m_bQueued = true;
+      if (WELS_THREAD_ERROR_OK != m_pThreadPool->QueueTask (pTask)) {
+        pTask->m_bQueued = false;
+        break;
+      }
+      ++ iQueuedNum;
+    }
+  }
+  WelsMutexUnlock (&m_hMutex);
+
+  RunJobs();
+
+  // the tasks not started yet find the run over, the running ones finish the jobs they took
+  WelsMutexLock (&m_hMutex);
+  m_bActive = false;
+  while (m_iRunningNum > 0) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  m_pRunner = NULL;
+  WelsMutexUnlock (&m_hMutex);
+}
+
+void CJobDispatcher::RunJobs() {
+  int32_t iJob;
+  // a job is taken once every job before it is taken, so the jobs waited for are running already
+  while ((iJob = WelsAtomicAdd (&m_iNextJob, 1) - 1) < m_iJobNum) {
+    m_pRunner->RunJob (iJob);
+  }
+}
+
+void CJobDispatcher::RunTask() {
+  WelsMutexLock (&m_hMutex);
+  if (!m_bActive) {
+    WelsMutexUnlock (&m_hMutex);
+    return;
+  }
+  ++ m_iRunningNum;
+  WelsMutexUnlock (&m_hMutex);
+
+  RunJobs();
+
+  WelsMutexLock (&m_hMutex);
+  -- m_iRunningNum;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+void CJobDispatcher::OnTaskDone (CJobTask* pTask) {
+  WelsMutexLock (&m_hMutex);
+  pTask->m_bQueued = false;
+  WelsCondBroadcast (&m_hCond);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+void CJobDispatcher::Publish (volatile int32_t* pProgress, const int32_t kiValue) {
+  // the exchange is a full barrier, so either the waiter sees the value or the waiter number is seen here
+  WelsAtomicExchange (pProgress, kiValue);
+  if (m_iWaiterNum > 0) {
+    WelsMutexLock (&m_hMutex);
+    WelsCondBroadcast (&m_hCond);
+    WelsMutexUnlock (&m_hMutex);
+  }
+}
+
+void CJobDispatcher::Wait (volatile int32_t* pProgress, const int32_t kiValue) {
+  if (*pProgress >= kiValue) {
+    WelsMemoryBarrier();
+    return;
+  }
+
+  WelsMutexLock (&m_hMutex);
+  WelsAtomicAdd (&m_iWaiterNum, 1);
+  while (*pProgress < kiValue) {
+    WelsCondWait (&m_hCond, &m_hMutex);
+  }
+  WelsAtomicAdd (&m_iWaiterNum, -1);
+  WelsMutexUnlock (&m_hMutex);
+}
+
+WELSVP_NAMESPACE_END
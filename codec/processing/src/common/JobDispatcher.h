@@ -0,0 +1,116 @@
+/*!
+ * \copy
+ *     Copyright (c)  2016, Cisco Systems
+ *     All rights reserved.
+ *
+ *     Redistribution and use in source and binary forms, with or without
+ *     modification, are permitted provided that the following conditions
+ *     are met:
+ *
+ *        * Redistributions of source code must retain the above copyright
+ *          notice, this list of conditions and the following disclaimer.
+ *
+ *        * Redistributions in binary form must reproduce the above copyright
+ *          notice, this list of conditions and the following disclaimer in
+ *          the documentation and/or other materials provided with the
+ *          distribution.
+ *
+ *     THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *     "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *     LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ *     FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ *     COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ *     INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ *     BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ *     LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *     CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ *     LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ *     ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ *     POSSIBILITY OF SUCH DAMAGE.
+ *
+ * \file        :  JobDispatcher.h
+ *
+ * \brief       :  jobs of the strategies run on the threads of a pool
+ *
+ * \date        :  10/18/2026 Created
+ *
+ * \description :  1. a strategy splits the processing of a picture into jobs, bands of rows mostly, run by the
+ *                    calling thread and the threads of the pool, in the order of their indexes
+ *
+ *************************************************************************************
+ */
+
+#ifndef WELSVP_JOBDISPATCHER_H
+#define WELSVP_JOBDISPATCHER_H
+
+#include "util.h"
+#include "WelsThreadLib.h"
+#include "codec_app_def.h"
+
+// the thread pool is only known to JobDispatcher.cpp, keeping the common thread headers out of the strategies
+namespace WelsCommon {
+class CWelsThreadPool;
+}
+
+WELSVP_NAMESPACE_BEGIN
+
+#define MAX_VP_THREAD_NUM     16
+#define JOBS_PER_THREAD       4  // bands per thread, for the balance of bands of different costs
+#define MAX_VP_JOB_NUM        (MAX_VP_THREAD_NUM * JOBS_PER_THREAD)
+
+class IJobRunner {
+ public:
+  virtual ~IJobRunner() {}
+  virtual void RunJob (int32_t iJobIdx) = 0;
+};
+
+class CJobDispatcher {
+ public:
+  CJobDispatcher();
+  ~CJobDispatcher();
+
+  // kiThreadNum threads including the calling one, of the pool of pParam or of the process-wide pool when NULL
+  EResult Init (const int32_t kiThreadNum, const SThreadPoolParam* pParam);
+  void    Uninit();
+
+  int32_t GetThreadNum() const {
+    return m_iThreadNum;
+  }
+  // number of jobs for kiUnitNum units (MB rows, pixel rows...) with kiMinUnits units per job at least, 1 unthreaded
+  int32_t GetJobNum (const int32_t kiUnitNum, const int32_t kiMinUnits) const;
+
+  // run the jobs 0 to kiJobNum - 1, started in order, returns once all of them are done; the jobs of a nested or
+  // concurrent call are run on the calling thread only
+  void    Run (IJobRunner* pRunner, const int32_t kiJobNum);
+
+  // progress of a job waited for by the jobs started after it
+  void    Publish (volatile int32_t* pProgress, const int32_t kiValue);
+  void    Wait (volatile int32_t* pProgress, const int32_t kiValue);
+
+ private:
+  class CJobTask;
+
+  void RunTask();
+  void RunJobs();
+  void OnTaskDone (CJobTask* pTask);
+
+ private:
+  WelsCommon::CWelsThreadPool* m_pThreadPool;
+  CJobTask*         m_pTasks[MAX_VP_THREAD_NUM];
+  int32_t           m_iThreadNum;
+  int32_t           m_iTaskNum;
+
+  IJobRunner*       m_pRunner;
+  int32_t           m_iJobNum;
+  volatile int32_t  m_iNextJob;
+  volatile int32_t  m_iWaiterNum;
+  bool              m_bActive;
+  int32_t           m_iRunningNum;
+
+  WELS_MUTEX        m_hMutex;
+  WELS_COND         m_hCond;
+};
+
+WELSVP_NAMESPACE_END
+
+#endif
@@ -92,9 +92,13 @@ CVpFrameWork::CVpFrameWork (uint32_t uiThreadsNum, EResult& eReturn) {
 
   for (int32_t i = 0; i < MAX_STRATEGY_NUM; i++) {
     m_pStgChain[i] = CreateStrategy (WelsStaticCast (EMethods, i + 1), uiCPUFlag);
+    if (m_pStgChain[i])
+      m_pStgChain[i]->m_pDispatcher = &m_cDispatcher;
+    WelsMutexInit (&m_mutes[i]);
   }
 
-  WelsMutexInit (&m_mutes);
+  if (uiThreadsNum > 1)
+    m_cDispatcher.Init (uiThreadsNum, NULL);
 
   eReturn = RET_SUCCESS;
 }
@@ -105,9 +109,8 @@ CVpFrameWork::~CVpFrameWork() {
       Uninit (m_pStgChain[i]->m_eMethod);
       delete m_pStgChain[i];
     }
+    WelsMutexDestroy (&m_mutes[i]);
   }
-
-  WelsMutexDestroy (&m_mutes);
 }
 
 EResult CVpFrameWork::Init (int32_t iType, void* pCfg) {
@@ -116,13 +119,13 @@ EResult CVpFrameWork::Init (int32_t iType, void* pCfg) {
 
   Uninit (iType);
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Init (0, pCfg);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -131,13 +134,13 @@ EResult CVpFrameWork::Uninit (int32_t iType) {
   EResult eReturn        = RET_SUCCESS;
   int32_t iCurIdx    = WelsStaticCast (int32_t, WelsVpGetValidMethod (iType)) - 1;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Uninit (0);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -162,13 +165,13 @@ EResult CVpFrameWork::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDst
   if (!CheckValid (eMethod, sSrcPic, sDstPic))
     return RET_INVALIDPARAM;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Process (0, &sSrcPic, &sDstPic);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -180,13 +183,13 @@ EResult CVpFrameWork::Get (int32_t iType, void* pParam) {
   if (!pParam)
     return RET_INVALIDPARAM;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Get (0, pParam);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -198,13 +201,13 @@ EResult CVpFrameWork::Set (int32_t iType, void* pParam) {
   if (!pParam)
     return RET_INVALIDPARAM;
 
-  WelsMutexLock (&m_mutes);
+  WelsMutexLock (&m_mutes[iCurIdx]);
 
   IStrategy* pStrategy = m_pStgChain[iCurIdx];
   if (pStrategy)
     eReturn = pStrategy->Set (0, pParam);
 
-  WelsMutexUnlock (&m_mutes);
+  WelsMutexUnlock (&m_mutes[iCurIdx]);
 
   return eReturn;
 }
@@ -212,6 +215,19 @@ EResult CVpFrameWork::Set (int32_t iType, void* pParam) {
 EResult CVpFrameWork::SpecialFeature (int32_t iType, void* pIn, void* pOut) {
   EResult eReturn        = RET_SUCCESS;
 
+  if (iType == VP_FEATURE_THREADING) {
+    SVpThreadingParam* pThreadingParam = (SVpThreadingParam*)pIn;
+    if (!pThreadingParam || pThreadingParam->iThreadNum < 1)
+      return RET_INVALIDPARAM;
+
+    // no strategy runs while the threads are changed
+    for (int32_t i = 0; i < MAX_STRATEGY_NUM; i++)
+      WelsMutexLock (&m_mutes[i]);
+    eReturn = m_cDispatcher.Init (pThreadingParam->iThreadNum, (const SThreadPoolParam*)pThreadingParam->pThreadPoolParam);
+    for (int32_t i = MAX_STRATEGY_NUM - 1; i >= 0; i--)
+      WelsMutexUnlock (&m_mutes[i]);
+  }
+
   return eReturn;
 }
 
@@ -45,6 +45,7 @@
 #include "IWelsVP.h"
 #include "util.h"
 #include "WelsThreadLib.h"
+#include "JobDispatcher.h"
 
 WELSVP_NAMESPACE_BEGIN
 
@@ -63,6 +64,7 @@ class IStrategy : public IWelsVP {
     m_eFormat  = VIDEO_FORMAT_I420;
     m_iIndex   = 0;
     m_bInit    = false;
+    m_pDispatcher = NULL;
   }
 
   virtual ~IStrategy() {}
@@ -88,11 +90,25 @@ class IStrategy : public IWelsVP {
   }
   virtual EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* pDst) = 0;
 
+  // jobs of a picture, run on the calling thread only without the dispatcher of the framework
+  int32_t GetJobNum (const int32_t kiUnitNum, const int32_t kiMinUnits) const {
+    return (NULL != m_pDispatcher) ? m_pDispatcher->GetJobNum (kiUnitNum, kiMinUnits) : 1;
+  }
+  void RunJobs (IJobRunner* pRunner, const int32_t kiJobNum) {
+    if (NULL != m_pDispatcher) {
+      m_pDispatcher->Run (pRunner, kiJobNum);
+    } else {
+      for (int32_t i = 0; i < kiJobNum; i++)
+        pRunner->RunJob (i);
+    }
+  }
+
  public:
   EMethods       m_eMethod;
   EVideoFormat m_eFormat;
   int32_t           m_iIndex;
   bool            m_bInit;
+  CJobDispatcher* m_pDispatcher;
 };
 
 class CVpFrameWork : public IWelsVP {
@@ -122,7 +138,9 @@ class CVpFrameWork : public IWelsVP {
  private:
   IStrategy* m_pStgChain[MAX_STRATEGY_NUM];
 
-  WELS_MUTEX m_mutes;
+  // one lock per strategy, so different strategies are run concurrently by different threads
+  WELS_MUTEX m_mutes[MAX_STRATEGY_NUM];
+  CJobDispatcher m_cDispatcher;
 };
 
 WELSVP_NAMESPACE_END
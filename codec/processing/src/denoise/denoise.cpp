@@ -48,9 +48,15 @@ CDenoiser::CDenoiser (int32_t iCpuFlag) {
   m_fSigmaGrey  = DENOISE_GRAY_SIGMA;
   m_uiType      = DENOISE_ALL_COMPONENT;
   InitDenoiseFunc (m_pfDenoise, m_CPUFlag);
+
+  WelsMemset (m_sPlane, 0, sizeof (m_sPlane));
+  m_pRowProgress     = NULL;
+  m_iRowProgressSize = 0;
 }
 
 CDenoiser::~CDenoiser() {
+  WelsFree ((void*)m_pRowProgress);
+  m_pRowProgress = NULL;
 }
 
 void CDenoiser::InitDenoiseFunc (SDenoiseFuncs& denoiser,  int32_t iCpuFlag) {
@@ -77,6 +83,31 @@ EResult CDenoiser::Process (int32_t iType, SPixMap* pSrc, SPixMap* dst) {
   int32_t iWidthUV = iWidthY >> 1;
   int32_t iHeightUV = iHeightY >> 1;
 
+  if (GetJobNum (iHeightY, 8) > 1) {
+    SetPlane (&m_sPlane[0], pSrcY, iWidthY, (m_uiType & DENOISE_Y_COMPONENT) ? iHeightY : 0, pSrc->iStride[0],
+              m_uiSpaceRadius, m_pfDenoise.pfBilateralLumaFilter8);
+    SetPlane (&m_sPlane[1], pSrcU, iWidthUV, (m_uiType & DENOISE_U_COMPONENT) ? iHeightUV : 0, pSrc->iStride[1],
+              UV_WINDOWS_RADIUS, m_pfDenoise.pfWaverageChromaFilter8);
+    SetPlane (&m_sPlane[2], pSrcV, iWidthUV, (m_uiType & DENOISE_V_COMPONENT) ? iHeightUV : 0, pSrc->iStride[2],
+              UV_WINDOWS_RADIUS, m_pfDenoise.pfWaverageChromaFilter8);
+
+    const int32_t kiJobNum = m_sPlane[0].iRowNum + m_sPlane[1].iRowNum + m_sPlane[2].iRowNum;
+    if (kiJobNum > m_iRowProgressSize) {
+      WelsFree ((void*)m_pRowProgress);
+      m_pRowProgress = (volatile int32_t*)WelsMalloc (kiJobNum * sizeof (int32_t));
+      if (NULL == m_pRowProgress) {
+        m_iRowProgressSize = 0;
+        return RET_OUTOFMEMORY;
+      }
+      m_iRowProgressSize = kiJobNum;
+    }
+    for (int32_t i = 0; i < kiJobNum; i++) {
+      m_pRowProgress[i] = 0;
+    }
+    RunJobs (this, kiJobNum);
+    return RET_SUCCESS;
+  }
+
   if (m_uiType & DENOISE_Y_COMPONENT)
     BilateralDenoiseLuma (pSrcY, iWidthY, iHeightY, pSrc->iStride[0]);
 
@@ -120,5 +151,53 @@ void CDenoiser::WaverageDenoiseChroma (uint8_t* pSrcUV, int32_t iWidth, int32_t
   }
 }
 
+void CDenoiser::SetPlane (SDenoisePlane* pPlane, uint8_t* pPixel, int32_t iWidth, int32_t iHeight, int32_t iStride,
+                          int32_t iRadius, DenoiseFilterFuncPtr pfFilter8) {
+  pPlane->pPixel    = pPixel;
+  pPlane->iWidth    = iWidth;
+  pPlane->iStride   = iStride;
+  pPlane->iRadius   = iRadius;
+  pPlane->iRowNum   = WELS_MAX (iHeight - 2 * iRadius, 0);
+  pPlane->pfFilter8 = pfFilter8;
+}
+
+/*
+ *  The filters are run in place, a row reads the rows above filtered and the rows below not filtered yet, so a block
+ *  waits for the row above to be done iRadius columns to its right. The row below writes as far as this row is done,
+ *  which is behind the columns this row reads then. With the rows taken in order the output is the one of the loops
+ *  above.
+ */
+void CDenoiser::RunJob (int32_t iJobIdx) {
+  volatile int32_t* pProgress = m_pRowProgress + iJobIdx;
+  SDenoisePlane* pPlane = &m_sPlane[0];
+  while (iJobIdx >= pPlane->iRowNum) {
+    iJobIdx -= pPlane->iRowNum;
+    ++ pPlane;
+  }
+
+  const int32_t kiWidth   = pPlane->iWidth;
+  const int32_t kiRadius  = pPlane->iRadius;
+  const int32_t kiStride  = pPlane->iStride;
+  const bool    kbWait    = iJobIdx > 0;  // the rows above the first one are not filtered
+  uint8_t* pRow = pPlane->pPixel + (kiRadius + iJobIdx) * kiStride;
+  int32_t w, iBlockNum = 0;
+
+  for (w = kiRadius; w < kiWidth - kiRadius - TAIL_OF_LINE8; w += 8) {
+    if (kbWait)
+      m_pDispatcher->Wait (pProgress - 1, WELS_MIN (w + 8 + kiRadius, kiWidth));
+    pPlane->pfFilter8 (pRow + w, kiStride);
+    if ((++ iBlockNum & 3) == 0)
+      m_pDispatcher->Publish (pProgress, w + 8);
+  }
+  for (w = w + TAIL_OF_LINE8; w < kiWidth - kiRadius; w++) {
+    if (kbWait)
+      m_pDispatcher->Wait (pProgress - 1, WELS_MIN (w + 1 + kiRadius, kiWidth));
+    Gauss3x3Filter (pRow + w, kiStride);
+  }
+  if (kbWait)
+    m_pDispatcher->Wait (pProgress - 1, kiWidth);
+  m_pDispatcher->Publish (pProgress, kiWidth);
+}
+
 
 WELSVP_NAMESPACE_END
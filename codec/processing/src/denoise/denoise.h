@@ -83,17 +83,31 @@ typedef  struct TagDenoiseFuncs {
   DenoiseFilterFuncPtr pfWaverageChromaFilter8;//on 8 samples
 } SDenoiseFuncs;
 
-class CDenoiser : public IStrategy {
+typedef struct {
+  uint8_t*             pPixel;
+  int32_t              iWidth;
+  int32_t              iStride;
+  int32_t              iRadius;
+  int32_t              iRowNum;       // rows filtered, one job each
+  DenoiseFilterFuncPtr pfFilter8;
+} SDenoisePlane;
+
+class CDenoiser : public IStrategy, public IJobRunner {
  public:
   CDenoiser (int32_t iCpuFlag);
   ~CDenoiser();
 
   EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* dst);
 
+  // one row of a plane, the rows of the planes in a wavefront
+  void RunJob (int32_t iJobIdx);
+
  private:
   void InitDenoiseFunc (SDenoiseFuncs& pf, int32_t cpu);
   void BilateralDenoiseLuma (uint8_t* p_y_data, int32_t width, int32_t height, int32_t stride);
   void WaverageDenoiseChroma (uint8_t* pSrcUV, int32_t width, int32_t height, int32_t stride);
+  void SetPlane (SDenoisePlane* pPlane, uint8_t* pPixel, int32_t iWidth, int32_t iHeight, int32_t iStride,
+                 int32_t iRadius, DenoiseFilterFuncPtr pfFilter8);
 
  private:
   float          m_fSigmaGrey;                  //sigma for grey scale similarity, suggestion 2.5-3
@@ -102,6 +116,10 @@ class CDenoiser : public IStrategy {
 
   SDenoiseFuncs m_pfDenoise;
   int32_t      m_CPUFlag;
+
+  SDenoisePlane     m_sPlane[3];
+  volatile int32_t* m_pRowProgress;             // columns of a row done, read by the row below
+  int32_t           m_iRowProgressSize;
 };
 
 WELSVP_NAMESPACE_END
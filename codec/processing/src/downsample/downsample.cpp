@@ -46,6 +46,9 @@ CDownsampling::CDownsampling (int32_t iCpuFlag) {
   WelsMemset (&m_pfDownsample, 0, sizeof (m_pfDownsample));
   InitDownsampleFuncs (m_pfDownsample, m_iCPUFlag);
   WelsMemset(m_pSampleBuffer,0,sizeof(m_pSampleBuffer));
+  WelsMemset (m_sPlane, 0, sizeof (m_sPlane));
+  m_iMode   = DOWNSAMPLE_HALF;
+  m_iJobNum = 0;
   m_bNoSampleBuffer = AllocateSampleBuffer();
 }
 
@@ -147,10 +150,10 @@ EResult CDownsampling::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDs
   int32_t iDstWidthY = pDstPixMap->sRect.iRectWidth;
   int32_t iDstHeightY = pDstPixMap->sRect.iRectHeight;
 
-  int32_t iSrcWidthUV = iSrcWidthY >> 1;
-  int32_t iSrcHeightUV = iSrcHeightY >> 1;
-  int32_t iDstWidthUV = iDstWidthY >> 1;
-  int32_t iDstHeightUV = iDstHeightY >> 1;
+  uint8_t* pSrc[3] = {(uint8_t*)pSrcPixMap->pPixel[0], (uint8_t*)pSrcPixMap->pPixel[1], (uint8_t*)pSrcPixMap->pPixel[2]};
+  uint8_t* pDst[3] = {(uint8_t*)pDstPixMap->pPixel[0], (uint8_t*)pDstPixMap->pPixel[1], (uint8_t*)pDstPixMap->pPixel[2]};
+  int32_t iSrcStride[3] = {pSrcPixMap->iStride[0], pSrcPixMap->iStride[1], pSrcPixMap->iStride[2]};
+  int32_t iDstStride[3] = {pDstPixMap->iStride[0], pDstPixMap->iStride[1], pDstPixMap->iStride[2]};
 
   if (iSrcWidthY <= iDstWidthY || iSrcHeightY <= iDstHeightY) {
     return RET_INVALIDPARAM;
@@ -158,117 +161,57 @@ EResult CDownsampling::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDs
   if ((iSrcWidthY >> 1) > MAX_SAMPLE_WIDTH || (iSrcHeightY >> 1) > MAX_SAMPLE_HEIGHT || m_bNoSampleBuffer) {
     if ((iSrcWidthY >> 1) == iDstWidthY && (iSrcHeightY >> 1) == iDstHeightY) {
       // use half average functions
-      DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0],
-          (uint8_t*)pSrcPixMap->pPixel[0], pSrcPixMap->iStride[0], iSrcWidthY, iSrcHeightY);
-      DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1],
-          (uint8_t*)pSrcPixMap->pPixel[1], pSrcPixMap->iStride[1], iSrcWidthUV, iSrcHeightUV);
-      DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2],
-          (uint8_t*)pSrcPixMap->pPixel[2], pSrcPixMap->iStride[2], iSrcWidthUV, iSrcHeightUV);
+      DownsamplePlanes (DOWNSAMPLE_HALF, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                        iSrcHeightY);
     } else if ((iSrcWidthY >> 2) == iDstWidthY && (iSrcHeightY >> 2) == iDstHeightY) {
-
-      m_pfDownsample.pfQuarterDownsampler ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0],
-                                           (uint8_t*)pSrcPixMap->pPixel[0], pSrcPixMap->iStride[0], iSrcWidthY, iSrcHeightY);
-
-      m_pfDownsample.pfQuarterDownsampler ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1],
-                                           (uint8_t*)pSrcPixMap->pPixel[1], pSrcPixMap->iStride[1], iSrcWidthUV, iSrcHeightUV);
-
-      m_pfDownsample.pfQuarterDownsampler ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2],
-                                           (uint8_t*)pSrcPixMap->pPixel[2], pSrcPixMap->iStride[2], iSrcWidthUV, iSrcHeightUV);
-
+      DownsamplePlanes (DOWNSAMPLE_QUARTER, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                        iSrcHeightY);
     } else if ((iSrcWidthY / 3) == iDstWidthY && (iSrcHeightY / 3) == iDstHeightY) {
-
-      m_pfDownsample.pfOneThirdDownsampler ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0],
-                                            (uint8_t*)pSrcPixMap->pPixel[0], pSrcPixMap->iStride[0], iSrcWidthY, iDstHeightY);
-
-      m_pfDownsample.pfOneThirdDownsampler ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1],
-                                            (uint8_t*)pSrcPixMap->pPixel[1], pSrcPixMap->iStride[1], iSrcWidthUV, iDstHeightUV);
-
-      m_pfDownsample.pfOneThirdDownsampler ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2],
-                                            (uint8_t*)pSrcPixMap->pPixel[2], pSrcPixMap->iStride[2], iSrcWidthUV, iDstHeightUV);
-
+      DownsamplePlanes (DOWNSAMPLE_ONE_THIRD, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                        iSrcHeightY);
     } else {
-      m_pfDownsample.pfGeneralRatioLuma ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0], iDstWidthY, iDstHeightY,
-                                         (uint8_t*)pSrcPixMap->pPixel[0], pSrcPixMap->iStride[0], iSrcWidthY, iSrcHeightY);
-
-      m_pfDownsample.pfGeneralRatioChroma ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1], iDstWidthUV, iDstHeightUV,
-                                           (uint8_t*)pSrcPixMap->pPixel[1], pSrcPixMap->iStride[1], iSrcWidthUV, iSrcHeightUV);
-
-      m_pfDownsample.pfGeneralRatioChroma ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2], iDstWidthUV, iDstHeightUV,
-                                           (uint8_t*)pSrcPixMap->pPixel[2], pSrcPixMap->iStride[2], iSrcWidthUV, iSrcHeightUV);
+      DownsamplePlanes (DOWNSAMPLE_GENERAL, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                        iSrcHeightY);
     }
   } else {
 
     int32_t iIdx = 0;
     int32_t iHalfSrcWidth = iSrcWidthY >> 1;
     int32_t iHalfSrcHeight = iSrcHeightY >> 1;
-    uint8_t* pSrcY = (uint8_t*)pSrcPixMap->pPixel[0];
-    uint8_t* pSrcU = (uint8_t*)pSrcPixMap->pPixel[1];
-    uint8_t* pSrcV = (uint8_t*)pSrcPixMap->pPixel[2];
-    int32_t iSrcStrideY = pSrcPixMap->iStride[0];
-    int32_t iSrcStrideU = pSrcPixMap->iStride[1];
-    int32_t iSrcStrideV = pSrcPixMap->iStride[2];
-
-    int32_t iDstStrideY = pDstPixMap->iStride[0];
-    int32_t iDstStrideU = pDstPixMap->iStride[1];
-    int32_t iDstStrideV = pDstPixMap->iStride[2];
+    uint8_t* pSample[3];
+    int32_t iSampleStride[3];
 
-    uint8_t* pDstY = (uint8_t*)m_pSampleBuffer[iIdx][0];
-    uint8_t* pDstU = (uint8_t*)m_pSampleBuffer[iIdx][1];
-    uint8_t* pDstV = (uint8_t*)m_pSampleBuffer[iIdx][2];
-    iIdx++;
     do {
       if ((iHalfSrcWidth == iDstWidthY) && (iHalfSrcHeight == iDstHeightY)) { //end
         // use half average functions
-        DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0],
-            (uint8_t*)pSrcY, iSrcStrideY, iSrcWidthY, iSrcHeightY);
-        DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1],
-            (uint8_t*)pSrcU, iSrcStrideU, iSrcWidthUV, iSrcHeightUV);
-        DownsampleHalfAverage ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2],
-            (uint8_t*)pSrcV, iSrcStrideV, iSrcWidthUV, iSrcHeightUV);
+        DownsamplePlanes (DOWNSAMPLE_HALF, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                          iSrcHeightY);
         break;
-      } else if ((iHalfSrcWidth > iDstWidthY) && (iHalfSrcHeight > iDstHeightY)){
+      } else if ((iHalfSrcWidth > iDstWidthY) && (iHalfSrcHeight > iDstHeightY)) {
         // use half average functions
-        iDstStrideY = WELS_ALIGN (iHalfSrcWidth, 32);
-        iDstStrideU = WELS_ALIGN (iHalfSrcWidth >> 1, 32);
-        iDstStrideV = WELS_ALIGN (iHalfSrcWidth >> 1, 32);
-        DownsampleHalfAverage ((uint8_t*)pDstY, iDstStrideY,
-            (uint8_t*)pSrcY, iSrcStrideY, iSrcWidthY, iSrcHeightY);
-        DownsampleHalfAverage ((uint8_t*)pDstU, iDstStrideU,
-            (uint8_t*)pSrcU, iSrcStrideU, iSrcWidthUV, iSrcHeightUV);
-        DownsampleHalfAverage ((uint8_t*)pDstV, iDstStrideV,
-            (uint8_t*)pSrcV, iSrcStrideV, iSrcWidthUV, iSrcHeightUV);
-
-        pSrcY = (uint8_t*)pDstY;
-        pSrcU = (uint8_t*)pDstU;
-        pSrcV = (uint8_t*)pDstV;
-
-
+        pSample[0] = m_pSampleBuffer[iIdx][0];
+        pSample[1] = m_pSampleBuffer[iIdx][1];
+        pSample[2] = m_pSampleBuffer[iIdx][2];
+        iSampleStride[0] = WELS_ALIGN (iHalfSrcWidth, 32);
+        iSampleStride[1] = WELS_ALIGN (iHalfSrcWidth >> 1, 32);
+        iSampleStride[2] = WELS_ALIGN (iHalfSrcWidth >> 1, 32);
+        DownsamplePlanes (DOWNSAMPLE_HALF, pSample, iSampleStride, iHalfSrcWidth, iHalfSrcHeight, pSrc, iSrcStride,
+                          iSrcWidthY, iSrcHeightY);
+
+        for (int32_t i = 0; i < 3; i++) {
+          pSrc[i] = pSample[i];
+          iSrcStride[i] = iSampleStride[i];
+        }
         iSrcWidthY = iHalfSrcWidth;
-        iSrcWidthUV = iHalfSrcWidth >> 1;
         iSrcHeightY = iHalfSrcHeight;
-        iSrcHeightUV = iHalfSrcHeight >> 1;
-
-        iSrcStrideY = iDstStrideY;
-        iSrcStrideU = iDstStrideU;
-        iSrcStrideV = iDstStrideV;
 
         iHalfSrcWidth >>= 1;
         iHalfSrcHeight >>= 1;
 
-        iIdx = iIdx % 2;
-        pDstY = (uint8_t*)m_pSampleBuffer[iIdx][0];
-        pDstU = (uint8_t*)m_pSampleBuffer[iIdx][1];
-        pDstV = (uint8_t*)m_pSampleBuffer[iIdx][2];
-        iIdx++;
+        iIdx = (iIdx + 1) % 2;
       } else {
-        m_pfDownsample.pfGeneralRatioLuma ((uint8_t*)pDstPixMap->pPixel[0], pDstPixMap->iStride[0], iDstWidthY, iDstHeightY,
-                                           (uint8_t*)pSrcY, iSrcStrideY, iSrcWidthY, iSrcHeightY);
-
-        m_pfDownsample.pfGeneralRatioChroma ((uint8_t*)pDstPixMap->pPixel[1], pDstPixMap->iStride[1], iDstWidthUV, iDstHeightUV,
-                                             (uint8_t*)pSrcU, iSrcStrideU,  iSrcWidthUV, iSrcHeightUV);
-
-        m_pfDownsample.pfGeneralRatioChroma ((uint8_t*)pDstPixMap->pPixel[2], pDstPixMap->iStride[2], iDstWidthUV, iDstHeightUV,
-                                             (uint8_t*)pSrcV, iSrcStrideV, iSrcWidthUV, iSrcHeightUV);
+        DownsamplePlanes (DOWNSAMPLE_GENERAL, pDst, iDstStride, iDstWidthY, iDstHeightY, pSrc, iSrcStride, iSrcWidthY,
+                          iSrcHeightY);
         break;
       }
     } while (true);
@@ -276,6 +219,71 @@ EResult CDownsampling::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* pDs
   return RET_SUCCESS;
 }
 
+void CDownsampling::DownsamplePlanes (int32_t iMode, uint8_t* pDst[3], int32_t iDstStride[3], int32_t iDstWidthY,
+                                      int32_t iDstHeightY, uint8_t* pSrc[3], int32_t iSrcStride[3], int32_t iSrcWidthY, int32_t iSrcHeightY) {
+  for (int32_t i = 0; i < 3; i++) {
+    SDownsamplePlane* pPlane = &m_sPlane[i];
+    const int32_t kiShift = i ? 1 : 0;
+    pPlane->pDst        = pDst[i];
+    pPlane->iDstStride  = iDstStride[i];
+    pPlane->iDstWidth   = iDstWidthY >> kiShift;
+    pPlane->iDstHeight  = iDstHeightY >> kiShift;
+    pPlane->pSrc        = pSrc[i];
+    pPlane->iSrcStride  = iSrcStride[i];
+    pPlane->iSrcWidth   = iSrcWidthY >> kiShift;
+    pPlane->iSrcHeight  = iSrcHeightY >> kiShift;
+    // the number of rows the whole plane call writes
+    if (iMode == DOWNSAMPLE_HALF)
+      pPlane->iDstRows = pPlane->iSrcHeight >> 1;
+    else if (iMode == DOWNSAMPLE_QUARTER)
+      pPlane->iDstRows = pPlane->iSrcHeight >> 2;
+    else
+      pPlane->iDstRows = pPlane->iDstHeight;
+  }
+  m_iMode = iMode;
+  // the general ratio downsamplers are not split into bands, the three planes done in parallel
+  m_iJobNum = (iMode == DOWNSAMPLE_GENERAL) ? (GetJobNum (3, 1) > 1 ? 3 : 1) : GetJobNum (m_sPlane[0].iDstRows, 8);
+  RunJobs (this, m_iJobNum);
+}
+
+void CDownsampling::RunJob (int32_t iJobIdx) {
+  if (m_iMode == DOWNSAMPLE_GENERAL) {
+    for (int32_t i = 0; i < 3; i++) {
+      if (m_iJobNum > 1 && i != iJobIdx)
+        continue;
+      SDownsamplePlane* pPlane = &m_sPlane[i];
+      PGeneralDownsampleFunc pfDownsample = i ? m_pfDownsample.pfGeneralRatioChroma : m_pfDownsample.pfGeneralRatioLuma;
+      pfDownsample (pPlane->pDst, pPlane->iDstStride, pPlane->iDstWidth, pPlane->iDstHeight,
+                    pPlane->pSrc, pPlane->iSrcStride, pPlane->iSrcWidth, pPlane->iSrcHeight);
+    }
+    return;
+  }
+
+  const int32_t kiRatio = (m_iMode == DOWNSAMPLE_HALF) ? 2 : (m_iMode == DOWNSAMPLE_QUARTER ? 4 : 3);
+  for (int32_t i = 0; i < 3; i++) {
+    SDownsamplePlane* pPlane = &m_sPlane[i];
+    const int32_t kiRowStart = iJobIdx * pPlane->iDstRows / m_iJobNum;
+    const int32_t kiRowEnd   = (iJobIdx + 1) * pPlane->iDstRows / m_iJobNum;
+    // the last band takes the odd source rows left over as the whole plane does
+    const int32_t kiSrcHeight = (iJobIdx == m_iJobNum - 1) ? pPlane->iSrcHeight - kiRowStart * kiRatio :
+                                (kiRowEnd - kiRowStart) * kiRatio;
+    uint8_t* pDst = pPlane->pDst + kiRowStart * pPlane->iDstStride;
+    uint8_t* pSrc = pPlane->pSrc + kiRowStart * kiRatio * pPlane->iSrcStride;
+
+    if (kiRowEnd == kiRowStart)
+      continue;
+    if (m_iMode == DOWNSAMPLE_HALF) {
+      DownsampleHalfAverage (pDst, pPlane->iDstStride, pSrc, pPlane->iSrcStride, pPlane->iSrcWidth, kiSrcHeight);
+    } else if (m_iMode == DOWNSAMPLE_QUARTER) {
+      m_pfDownsample.pfQuarterDownsampler (pDst, pPlane->iDstStride, pSrc, pPlane->iSrcStride, pPlane->iSrcWidth,
+                                           kiSrcHeight);
+    } else {
+      m_pfDownsample.pfOneThirdDownsampler (pDst, pPlane->iDstStride, pSrc, pPlane->iSrcStride, pPlane->iSrcWidth,
+                                            kiRowEnd - kiRowStart);
+    }
+  }
+}
+
 void CDownsampling::DownsampleHalfAverage (uint8_t* pDst, int32_t iDstStride,
         uint8_t* pSrc, int32_t iSrcStride, int32_t iSrcWidth, int32_t iSrcHeight) {
   if ((iSrcStride & 31) == 0) {
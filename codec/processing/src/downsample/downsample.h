@@ -175,16 +175,41 @@ WELSVP_EXTERN_C_END
 #endif
 
 
-class CDownsampling : public IStrategy {
+enum {
+  DOWNSAMPLE_HALF,
+  DOWNSAMPLE_QUARTER,
+  DOWNSAMPLE_ONE_THIRD,
+  DOWNSAMPLE_GENERAL
+};
+
+typedef struct {
+  uint8_t* pDst;
+  int32_t  iDstStride;
+  int32_t  iDstWidth;
+  int32_t  iDstHeight;
+  uint8_t* pSrc;
+  int32_t  iSrcStride;
+  int32_t  iSrcWidth;
+  int32_t  iSrcHeight;
+  int32_t  iDstRows;        // rows written by the dyadic downsamplers
+} SDownsamplePlane;
+
+class CDownsampling : public IStrategy, public IJobRunner {
  public:
   CDownsampling (int32_t iCpuFlag);
   ~CDownsampling();
 
   EResult Process (int32_t iType, SPixMap* pSrc, SPixMap* pDst);
 
+  // band of rows of all three planes, or one plane for the general ratio
+  void RunJob (int32_t iJobIdx);
+
  private:
   void InitDownsampleFuncs (SDownsampleFuncs& sDownsampleFunc, int32_t iCpuFlag);
 
+  void DownsamplePlanes (int32_t iMode, uint8_t* pDst[3], int32_t iDstStride[3], int32_t iDstWidthY, int32_t iDstHeightY,
+                         uint8_t* pSrc[3], int32_t iSrcStride[3], int32_t iSrcWidthY, int32_t iSrcHeightY);
+
   void DownsampleHalfAverage (uint8_t* pDst, int32_t iDstStride,
       uint8_t* pSrc, int32_t iSrcStride, int32_t iSrcWidth, int32_t iSrcHeight);
   bool AllocateSampleBuffer();
@@ -194,6 +219,10 @@ class CDownsampling : public IStrategy {
   int32_t  m_iCPUFlag;
   uint8_t  *m_pSampleBuffer[2][3];
   bool     m_bNoSampleBuffer;
+
+  SDownsamplePlane m_sPlane[3];
+  int32_t  m_iMode;
+  int32_t  m_iJobNum;
 };
 
 WELSVP_NAMESPACE_END
@@ -44,6 +44,13 @@ CVAACalculation::CVAACalculation (int32_t iCpuFlag) {
 
   WelsMemset (&m_sCalcParam, 0, sizeof (m_sCalcParam));
   WelsMemset (&m_sVaaFuncs, 0, sizeof (m_sVaaFuncs));
+  WelsMemset (m_iBandSad, 0, sizeof (m_iBandSad));
+  m_pCurData   = NULL;
+  m_pRefData   = NULL;
+  m_iPicWidth  = 0;
+  m_iPicHeight = 0;
+  m_iPicStride = 0;
+  m_iJobNum    = 0;
   InitVaaFuncs (m_sVaaFuncs, m_iCPUFlag);
 }
 
@@ -104,37 +111,116 @@ EResult CVAACalculation::Process (int32_t iType, SPixMap* pSrcPixMap, SPixMap* p
 
   SVAACalcResult* pResult = m_sCalcParam.pCalcResult;
 
+  pResult->pMotionTextureUnit = NULL;
   if (pCurData == NULL || pRefData == NULL) {
     return RET_INVALIDPARAM;
   }
 
   pResult->pCurY = pCurData;
   pResult->pRefY = pRefData;
+
+  m_pCurData   = pCurData;
+  m_pRefData   = pRefData;
+  m_iPicWidth  = iPicWidth;
+  m_iPicHeight = iPicHeight;
+  m_iPicStride = iPicStride;
+  m_iJobNum    = GetJobNum (iPicHeight >> 4, 2);
+  RunJobs (this, m_iJobNum);
+
+  // the statistics of the MBs are written by the bands, the SAD of the frame summed up here
+  pResult->iFrameSad = 0;
+  for (int32_t i = 0; i < m_iJobNum; i++) {
+    pResult->iFrameSad += m_iBandSad[i];
+  }
+  if (m_sCalcParam.iCalcSsd && m_sCalcParam.pMotionTextureUnit) {
+    pResult->pMotionTextureUnit = m_sCalcParam.pMotionTextureUnit;
+    pResult->iMotionIndexSum = pResult->iTextureIndexSum = 0;
+    for (int32_t i = 0; i < m_iJobNum; i++) {
+      pResult->iMotionIndexSum += m_iBandMotionIndex[i];
+      pResult->iTextureIndexSum += m_iBandTextureIndex[i];
+    }
+  }
+
+  return RET_SUCCESS;
+}
+
+void CVAACalculation::RunJob (int32_t iJobIdx) {
+  const int32_t kiMbHeight    = m_iPicHeight >> 4;
+  const int32_t kiMbRowStart  = iJobIdx * kiMbHeight / m_iJobNum;
+  const int32_t kiMbRowEnd    = (iJobIdx + 1) * kiMbHeight / m_iJobNum;
+  // the last band takes the rows below the last whole MB row as the whole picture does
+  const int32_t kiBandHeight  = (iJobIdx == m_iJobNum - 1) ? m_iPicHeight - (kiMbRowStart << 4) :
+                                (kiMbRowEnd - kiMbRowStart) << 4;
+  const int32_t kiMbOffset    = kiMbRowStart * (m_iPicWidth >> 4);
+  uint8_t* pCurData           = m_pCurData + (kiMbRowStart << 4) * m_iPicStride;
+  uint8_t* pRefData           = m_pRefData + (kiMbRowStart << 4) * m_iPicStride;
+  int32_t* pFrameSad          = &m_iBandSad[iJobIdx];
+
+  SVAACalcResult* pResult = m_sCalcParam.pCalcResult;
   if (m_sCalcParam.iCalcBgd) {
     if (m_sCalcParam.iCalcSsd) {
-      m_sVaaFuncs.pfVAACalcSadSsdBgd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                      (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16, pResult->pSsd16x16,
-                                      (int32_t*)pResult->pSumOfDiff8x8, (uint8_t*)pResult->pMad8x8);
+      m_sVaaFuncs.pfVAACalcSadSsdBgd (pCurData, pRefData, m_iPicWidth, kiBandHeight, m_iPicStride, pFrameSad,
+                                      (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                      pResult->pSumOfSquare16x16 + kiMbOffset, pResult->pSsd16x16 + kiMbOffset,
+                                      (int32_t*) (pResult->pSumOfDiff8x8 + kiMbOffset), (uint8_t*) (pResult->pMad8x8 + kiMbOffset));
     } else {
-      m_sVaaFuncs.pfVAACalcSadBgd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                   (int32_t*) (pResult->pSad8x8), (int32_t*) (pResult->pSumOfDiff8x8), (uint8_t*)pResult->pMad8x8);
+      m_sVaaFuncs.pfVAACalcSadBgd (pCurData, pRefData, m_iPicWidth, kiBandHeight, m_iPicStride, pFrameSad,
+                                   (int32_t*) (pResult->pSad8x8 + kiMbOffset), (int32_t*) (pResult->pSumOfDiff8x8 + kiMbOffset),
+                                   (uint8_t*) (pResult->pMad8x8 + kiMbOffset));
     }
   } else {
     if (m_sCalcParam.iCalcSsd) {
-      m_sVaaFuncs.pfVAACalcSadSsd (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                   (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16, pResult->pSsd16x16);
+      m_sVaaFuncs.pfVAACalcSadSsd (pCurData, pRefData, m_iPicWidth, kiBandHeight, m_iPicStride, pFrameSad,
+                                   (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                   pResult->pSumOfSquare16x16 + kiMbOffset, pResult->pSsd16x16 + kiMbOffset);
     } else {
       if (m_sCalcParam.iCalcVar) {
-        m_sVaaFuncs.pfVAACalcSadVar (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                     (int32_t*)pResult->pSad8x8, pResult->pSum16x16, pResult->pSumOfSquare16x16);
+        m_sVaaFuncs.pfVAACalcSadVar (pCurData, pRefData, m_iPicWidth, kiBandHeight, m_iPicStride, pFrameSad,
+                                     (int32_t*) (pResult->pSad8x8 + kiMbOffset), pResult->pSum16x16 + kiMbOffset,
+                                     pResult->pSumOfSquare16x16 + kiMbOffset);
       } else {
-        m_sVaaFuncs.pfVAACalcSad (pCurData, pRefData, iPicWidth, iPicHeight, iPicStride, &pResult->iFrameSad,
-                                  (int32_t*)pResult->pSad8x8);
+        m_sVaaFuncs.pfVAACalcSad (pCurData, pRefData, m_iPicWidth, kiBandHeight, m_iPicStride, pFrameSad,
+                                  (int32_t*) (pResult->pSad8x8 + kiMbOffset));
       }
     }
   }
 
-  return RET_SUCCESS;
+  // the statistics of the band are still in cache, so adaptive quantization takes them from here
+  if (m_sCalcParam.iCalcSsd && m_sCalcParam.pMotionTextureUnit) {
+    MotionTextureIndex (kiMbOffset, kiMbRowEnd * (m_iPicWidth >> 4), &m_iBandMotionIndex[iJobIdx],
+                        &m_iBandTextureIndex[iJobIdx]);
+  }
+}
+
+void CVAACalculation::MotionTextureIndex (int32_t iMbStart, int32_t iMbEnd, int64_t* pMotionIndexSum,
+    int64_t* pTextureIndexSum) {
+  SVAACalcResult* pResult = m_sCalcParam.pCalcResult;
+  SMotionTextureUnit* pMotionTexture = m_sCalcParam.pMotionTextureUnit;
+  int64_t iMotionIndexSum = 0;
+  int64_t iTextureIndexSum = 0;
+  int32_t iSumDiff, iSQDiff, uiSum, iSQSum;
+
+  for (int32_t i = iMbStart; i < iMbEnd; i++) {
+    iSumDiff =  pResult->pSad8x8[i][0];
+    iSumDiff += pResult->pSad8x8[i][1];
+    iSumDiff += pResult->pSad8x8[i][2];
+    iSumDiff += pResult->pSad8x8[i][3];
+
+    iSQDiff = pResult->pSsd16x16[i];
+    uiSum = pResult->pSum16x16[i];
+    iSQSum = pResult->pSumOfSquare16x16[i];
+
+    iSumDiff = iSumDiff >> 8;
+    pMotionTexture[i].uiMotionIndex = (iSQDiff >> 8) - (iSumDiff * iSumDiff);
+
+    uiSum = uiSum >> 8;
+    pMotionTexture[i].uiTextureIndex = (iSQSum >> 8) - (uiSum * uiSum);
+
+    iMotionIndexSum += pMotionTexture[i].uiMotionIndex;
+    iTextureIndexSum += pMotionTexture[i].uiTextureIndex;
+  }
+  *pMotionIndexSum = iMotionIndexSum;
+  *pTextureIndexSum = iTextureIndexSum;
 }
 
 EResult CVAACalculation::Set (int32_t iType, void* pParam) {
@@ -132,7 +132,7 @@ VAACalcSadSsdFunc       VAACalcSadSsd_AArch64_neon;
 WELSVP_EXTERN_C_END
 #endif
 
-class CVAACalculation : public IStrategy {
+class CVAACalculation : public IStrategy, public IJobRunner {
  public:
   CVAACalculation (int32_t iCpuFlag);
   ~CVAACalculation();
@@ -140,13 +140,27 @@ class CVAACalculation : public IStrategy {
   EResult Process (int32_t iType, SPixMap* pCurPixMap, SPixMap* pRefPixMap);
   EResult Set (int32_t iType, void* pParam);
 
+  // band of MB rows
+  void RunJob (int32_t iJobIdx);
+
  private:
   void InitVaaFuncs (SVaaFuncs& sVaaFunc, int32_t iCpuFlag);
+  void MotionTextureIndex (int32_t iMbStart, int32_t iMbEnd, int64_t* pMotionIndexSum, int64_t* pTextureIndexSum);
 
  private:
   SVaaFuncs      m_sVaaFuncs;
   int32_t       m_iCPUFlag;
   SVAACalcParam m_sCalcParam;
+
+  uint8_t*      m_pCurData;
+  uint8_t*      m_pRefData;
+  int32_t       m_iPicWidth;
+  int32_t       m_iPicHeight;
+  int32_t       m_iPicStride;
+  int32_t       m_iJobNum;
+  int32_t       m_iBandSad[MAX_VP_JOB_NUM];
+  int64_t       m_iBandMotionIndex[MAX_VP_JOB_NUM];
+  int64_t       m_iBandTextureIndex[MAX_VP_JOB_NUM];
 };
 
 WELSVP_NAMESPACE_END
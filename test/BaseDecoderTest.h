@@ -28,7 +28,8 @@ class BaseDecoderTest {
   };
 
   BaseDecoderTest();
-  int32_t SetUp();
+  int32_t SetUp (int32_t threadCount = 1, const SDecPictureAllocator* allocator = NULL,
+                 const SThreadPoolParam* threadPool = NULL, bool zeroCopy = false, bool sliceThreading = false);
   void TearDown();
   void DecodeFile (const char* fileName, Callback* cbk);
 
@@ -38,9 +39,13 @@ class BaseDecoderTest {
 
  private:
   void DecodeFrame (const uint8_t* src, size_t sliceSize, Callback* cbk);
+  void FlushFrames (Callback* cbk);
+
+  void DecodeFileInPlace (std::ifstream* file, Callback* cbk);
 
   std::ifstream file_;
   BufferedData buf_;
+  bool zeroCopy_;
   enum {
     OpenFile,
     Decoding,
@@ -1,4 +1,6 @@
 #include <fstream>
+#include <iterator>
+#include <vector>
 #include <gtest/gtest.h>
 #include "codec_def.h"
 #include "codec_app_def.h"
@@ -44,21 +46,41 @@ static void ReadFrame (std::ifstream* file, BufferedData* buf) {
 }
 
 BaseDecoderTest::BaseDecoderTest()
-  : decoder_ (NULL), decodeStatus_ (OpenFile) {}
+  : decoder_ (NULL), zeroCopy_ (false), decodeStatus_ (OpenFile) {}
 
-int32_t BaseDecoderTest::SetUp() {
+int32_t BaseDecoderTest::SetUp (int32_t threadCount, const SDecPictureAllocator* allocator,
+                                const SThreadPoolParam* threadPool, bool zeroCopy, bool sliceThreading) {
   long rv = WelsCreateDecoder (&decoder_);
   EXPECT_EQ (0, rv);
   EXPECT_TRUE (decoder_ != NULL);
   if (decoder_ == NULL) {
     return rv;
   }
+  if (threadCount > 1) {
+    rv = decoder_->SetOption (DECODER_OPTION_NUM_OF_THREADS, &threadCount);
+    EXPECT_EQ (0, rv);
+  }
+  if (sliceThreading) {
+    int32_t iSliceThreading = 1;
+    rv = decoder_->SetOption (DECODER_OPTION_SLICE_THREADING, &iSliceThreading);
+    EXPECT_EQ (0, rv);
+  }
+  if (allocator != NULL) {
+    rv = decoder_->SetOption (DECODER_OPTION_PICTURE_ALLOCATOR, (void*)allocator);
+    EXPECT_EQ (0, rv);
+  }
+  if (threadPool != NULL) {
+    rv = decoder_->SetOption (DECODER_OPTION_THREAD_POOL, (void*)threadPool);
+    EXPECT_EQ (0, rv);
+  }
 
   SDecodingParam decParam;
   memset (&decParam, 0, sizeof (SDecodingParam));
   decParam.uiTargetDqLayer = UCHAR_MAX;
   decParam.eEcActiveIdc = ERROR_CON_SLICE_COPY;
   decParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+  decParam.bZeroCopyInput = zeroCopy;
+  zeroCopy_ = zeroCopy;
 
   rv = decoder_->Initialize (&decParam);
   EXPECT_EQ (0, rv);
@@ -109,10 +131,51 @@ void BaseDecoderTest::DecodeFrame (const uint8_t* src, size_t sliceSize, Callbac
     cbk->onDecodeFrame (frame);
   }
 }
+
+void BaseDecoderTest::FlushFrames (Callback* cbk) {
+  int32_t iEndOfStreamFlag = 1;
+  decoder_->SetOption (DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
+
+  // Get pending last frame, and the frames still being decoded by the threads
+  int32_t iRemainingFrames = 0;
+  do {
+    DecodeFrame (NULL, 0, cbk);
+    if (::testing::Test::HasFatalFailure()) {
+      return;
+    }
+    decoder_->GetOption (DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER, &iRemainingFrames);
+  } while (iRemainingFrames > 0);
+}
+// the decoder may read the input in place, so the whole file stays in memory, with 4 readable bytes past its end
+void BaseDecoderTest::DecodeFileInPlace (std::ifstream* file, Callback* cbk) {
+  std::vector<uint8_t> data ((std::istreambuf_iterator<char> (*file)), std::istreambuf_iterator<char>());
+  const size_t size = data.size();
+  data.resize (size + 4, 0);
+
+  // frames start with {0, 0, 0, 1} as read by ReadFrame
+  size_t frameStart = 0;
+  for (size_t i = 1; i <= size; i++) {
+    if (i == size || (i + 4 <= size && data[i] == 0 && data[i + 1] == 0 && data[i + 2] == 0 && data[i + 3] == 1)) {
+      DecodeFrame (&data[frameStart], i - frameStart, cbk);
+      if (::testing::Test::HasFatalFailure()) {
+        return;
+      }
+      frameStart = i;
+    }
+  }
+
+  FlushFrames (cbk);
+}
+
 void BaseDecoderTest::DecodeFile (const char* fileName, Callback* cbk) {
   std::ifstream file (fileName, std::ios::in | std::ios::binary);
   ASSERT_TRUE (file.is_open());
 
+  if (zeroCopy_) {
+    DecodeFileInPlace (&file, cbk);
+    return;
+  }
+
   BufferedData buf;
   while (true) {
     ReadFrame (&file, &buf);
@@ -128,11 +191,7 @@ void BaseDecoderTest::DecodeFile (const char* fileName, Callback* cbk) {
     }
   }
 
-  int32_t iEndOfStreamFlag = 1;
-  decoder_->SetOption (DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
-
-  // Get pending last frame
-  DecodeFrame (NULL, 0, cbk);
+  FlushFrames (cbk);
 }
 
 bool BaseDecoderTest::Open (const char* fileName) {
@@ -162,13 +221,10 @@ bool BaseDecoderTest::DecodeNextFrame (Callback* cbk) {
       return false;
     }
     return true;
-  case EndOfStream: {
-    int32_t iEndOfStreamFlag = 1;
-    decoder_->SetOption (DECODER_OPTION_END_OF_STREAM, &iEndOfStreamFlag);
-    DecodeFrame (NULL, 0, cbk);
+  case EndOfStream:
+    FlushFrames (cbk);
     decodeStatus_ = End;
     break;
-  }
   case OpenFile:
   case End:
     break;
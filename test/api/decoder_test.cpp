@@ -134,3 +134,219 @@ static const FileParam kFileParamArray[] = {
 
 INSTANTIATE_TEST_CASE_P (DecodeFile, DecoderOutputTest,
                          ::testing::ValuesIn (kFileParamArray));
+
+class ThreadDecoderOutputTest : public DecoderOutputTest {
+ public:
+  virtual void SetUp() {
+    BaseDecoderTest::SetUp (4);
+    if (HasFatalFailure()) {
+      return;
+    }
+    SHA1Reset (&ctx_);
+  }
+};
+
+// frame level multi-threading must not change the output
+TEST_P (ThreadDecoderOutputTest, CompareOutput) {
+  FileParam p = GetParam();
+#if defined(ANDROID_NDK)
+  std::string filename = std::string ("/sdcard/") + p.fileName;
+  DecodeFile (filename.c_str(), this);
+#else
+  DecodeFile (p.fileName, this);
+#endif
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result (&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash (digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P (DecodeFile, ThreadDecoderOutputTest,
+                         ::testing::ValuesIn (kFileParamArray));
+
+class SliceThreadDecoderOutputTest : public DecoderOutputTest {
+ public:
+  virtual void SetUp() {
+    BaseDecoderTest::SetUp (4, NULL, NULL, false, true);
+    if (HasFatalFailure()) {
+      return;
+    }
+    int32_t iSliceThreading = 0;
+    EXPECT_EQ (cmResultSuccess, decoder_->GetOption (DECODER_OPTION_SLICE_THREADING, &iSliceThreading));
+    EXPECT_EQ (1, iSliceThreading);
+    SHA1Reset (&ctx_);
+  }
+  virtual void onDecodeFrame (const Frame& frame) {
+    // each picture is output by the call decoding it
+    int32_t iRemainingFrames = -1;
+    decoder_->GetOption (DECODER_OPTION_NUM_OF_FRAMES_REMAINING_IN_BUFFER, &iRemainingFrames);
+    EXPECT_EQ (0, iRemainingFrames);
+    DecoderOutputTest::onDecodeFrame (frame);
+  }
+};
+
+// the slices reconstructed in parallel without frame level multi-threading must not change the output
+TEST_P (SliceThreadDecoderOutputTest, CompareOutput) {
+  FileParam p = GetParam();
+#if defined(ANDROID_NDK)
+  std::string filename = std::string ("/sdcard/") + p.fileName;
+  DecodeFile (filename.c_str(), this);
+#else
+  DecodeFile (p.fileName, this);
+#endif
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result (&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash (digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P (DecodeFile, SliceThreadDecoderOutputTest,
+                         ::testing::ValuesIn (kFileParamArray));
+
+class ThreadPoolDecoderOutputTest : public DecoderOutputTest {
+ public:
+  virtual void SetUp() {
+    // the pool param started from the defaults, bound to no CPU
+    ISVCDecoder* pDecoder = NULL;
+    SThreadPoolParam sThreadPool;
+    memset (&sThreadPool, 0, sizeof (sThreadPool));
+    ASSERT_EQ (0, WelsCreateDecoder (&pDecoder));
+    EXPECT_EQ (cmResultSuccess, pDecoder->GetOption (DECODER_OPTION_THREAD_POOL, &sThreadPool));
+    WelsDestroyDecoder (pDecoder);
+    EXPECT_EQ (0, sThreadPool.iPoolId);
+    EXPECT_EQ (0, sThreadPool.iThreadNum);
+    EXPECT_EQ (-1, sThreadPool.iNumaNode);
+    EXPECT_EQ (0u, sThreadPool.uiCpuMask[0]);
+    sThreadPool.iPoolId = 1;
+    sThreadPool.iThreadNum = 2;
+    BaseDecoderTest::SetUp (4, NULL, &sThreadPool);
+    if (HasFatalFailure()) {
+      return;
+    }
+    SHA1Reset (&ctx_);
+  }
+};
+
+// decoding with a pool of less threads than the decoder
+TEST_P (ThreadPoolDecoderOutputTest, CompareOutput) {
+  FileParam p = GetParam();
+#if defined(ANDROID_NDK)
+  std::string filename = std::string ("/sdcard/") + p.fileName;
+  DecodeFile (filename.c_str(), this);
+#else
+  DecodeFile (p.fileName, this);
+#endif
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result (&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash (digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P (DecodeFile, ThreadPoolDecoderOutputTest,
+                         ::testing::ValuesIn (kFileParamArray));
+
+class AllocatorDecoderOutputTest : public DecoderOutputTest {
+ public:
+  virtual void SetUp() {
+    allocator_.pContext = this;
+    allocator_.pfGetBuffer = GetBuffer;
+    allocator_.pfReleaseBuffer = ReleaseBuffer;
+    buffers_ = 0;
+    BaseDecoderTest::SetUp (1, &allocator_);
+    if (HasFatalFailure()) {
+      return;
+    }
+    SHA1Reset (&ctx_);
+  }
+  virtual void TearDown() {
+    DecoderOutputTest::TearDown();
+    EXPECT_EQ (0, buffers_);
+  }
+  virtual void onDecodeFrame (const Frame& frame) {
+    EXPECT_TRUE (frame.y.stride % 32 == 0 && frame.y.stride == frame.u.stride * 2);
+    DecoderOutputTest::onDecodeFrame (frame);
+  }
+  static int GetBuffer (void* context, int width, int height, int padding, unsigned char* data[3], int stride[2],
+                        void** buffer) {
+    AllocatorDecoderOutputTest* self = static_cast<AllocatorDecoderOutputTest*> (context);
+    stride[0] = (width + padding * 2 + 63) & ~63;
+    stride[1] = stride[0] / 2;
+    int lumaSize = stride[0] * (height + padding * 2);
+    int chromaSize = lumaSize / 4;
+    unsigned char* buf = new unsigned char[lumaSize + chromaSize * 2 + 16];
+    // garbage content, the decoder must not depend on the initial samples
+    memset (buf, 0x5a, lumaSize + chromaSize * 2 + 16);
+    unsigned char* aligned = (unsigned char*) (((uintptr_t)buf + 15) & ~ (uintptr_t)15);
+    data[0] = aligned + padding * stride[0] + padding;
+    data[1] = aligned + lumaSize + (padding / 2) * stride[1] + padding / 2;
+    data[2] = data[1] + chromaSize;
+    *buffer = buf;
+    self->buffers_++;
+    return 0;
+  }
+  static void ReleaseBuffer (void* context, void* buffer) {
+    AllocatorDecoderOutputTest* self = static_cast<AllocatorDecoderOutputTest*> (context);
+    delete[] static_cast<unsigned char*> (buffer);
+    self->buffers_--;
+  }
+ protected:
+  SDecPictureAllocator allocator_;
+  int buffers_;
+};
+
+// decoding into application buffers must not change the output, and all the buffers must be released
+TEST_P (AllocatorDecoderOutputTest, CompareOutput) {
+  FileParam p = GetParam();
+#if defined(ANDROID_NDK)
+  std::string filename = std::string ("/sdcard/") + p.fileName;
+  DecodeFile (filename.c_str(), this);
+#else
+  DecodeFile (p.fileName, this);
+#endif
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result (&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash (digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P (DecodeFile, AllocatorDecoderOutputTest,
+                         ::testing::ValuesIn (kFileParamArray));
+
+class ZeroCopyDecoderOutputTest : public DecoderOutputTest {
+ public:
+  virtual void SetUp() {
+    BaseDecoderTest::SetUp (1, NULL, NULL, true);
+    if (HasFatalFailure()) {
+      return;
+    }
+    SHA1Reset (&ctx_);
+  }
+};
+
+// parsing the NALs without escapes in place must not change the output
+TEST_P (ZeroCopyDecoderOutputTest, CompareOutput) {
+  FileParam p = GetParam();
+#if defined(ANDROID_NDK)
+  std::string filename = std::string ("/sdcard/") + p.fileName;
+  DecodeFile (filename.c_str(), this);
+#else
+  DecodeFile (p.fileName, this);
+#endif
+
+  unsigned char digest[SHA_DIGEST_LENGTH];
+  SHA1Result (&ctx_, digest);
+  if (!HasFatalFailure()) {
+    CompareHash (digest, p.hashStr);
+  }
+}
+
+INSTANTIATE_TEST_CASE_P (DecodeFile, ZeroCopyDecoderOutputTest,
+                         ::testing::ValuesIn (kFileParamArray));
@@ -1166,6 +1166,833 @@ TEST_F (EncodeDecodeTestAPI, SimulcastAVC) {
 #endif
 }
 
+TEST_F (EncodeDecodeTestAPI, SimulcastAVCLayerThreading) {
+  int iSpatialLayerNum = WelsClip3 ((rand() % MAX_SPATIAL_LAYER_NUM), 2, MAX_SPATIAL_LAYER_NUM);
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 16, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 16, MAX_HEIGHT);
+  float fFrameRate = rand() + 0.5f;
+  int iSliceNum        = 1;
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (iSpatialLayerNum, iSliceNum, iWidth, iHeight, fFrameRate, &param_);
+  param_.bSimulcastAVC = true;
+
+  bool bLayerThreading = true;
+  int rv = encoder_->SetOption (ENCODER_OPTION_SIMULCAST_LAYER_THREADING, &bLayerThreading);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  // the option is taken before the initialization only
+  rv = encoder_->SetOption (ENCODER_OPTION_SIMULCAST_LAYER_THREADING, &bLayerThreading);
+  EXPECT_TRUE (rv != cmResultSuccess);
+
+  SEncParamExt sParam;
+  rv = encoder_->GetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sParam);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  EXPECT_EQ (sParam.iSpatialLayerNum, iSpatialLayerNum);
+  EXPECT_TRUE (sParam.bSimulcastAVC);
+
+  unsigned char*  pBsBuf[MAX_SPATIAL_LAYER_NUM];
+  int aLen[MAX_SPATIAL_LAYER_NUM] = {0};
+  ISVCDecoder* decoder[MAX_SPATIAL_LAYER_NUM];
+  int iIdx = 0;
+
+  for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+    pBsBuf[iIdx] = static_cast<unsigned char*> (malloc (iWidth * iHeight * 3 * sizeof (unsigned char) / 2));
+    ASSERT_TRUE (pBsBuf[iIdx] != NULL);
+
+    long rv = WelsCreateDecoder (&decoder[iIdx]);
+    ASSERT_EQ (0, rv);
+    ASSERT_TRUE (decoder[iIdx] != NULL);
+
+    SDecodingParam decParam;
+    memset (&decParam, 0, sizeof (SDecodingParam));
+    decParam.uiTargetDqLayer = UCHAR_MAX;
+    decParam.eEcActiveIdc = ERROR_CON_SLICE_COPY;
+    decParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+
+    rv = decoder[iIdx]->Initialize (&decParam);
+    ASSERT_EQ (0, rv);
+  }
+
+  const int iEncFrameNum = 10;
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    int iResult;
+    int iLayerLen = 0;
+    unsigned char* pData[3] = { NULL };
+
+    ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+    if (iFrame == iEncFrameNum / 2) {
+      encoder_->ForceIntraFrame (true);
+    }
+    EncodeOneFrame (0);
+    if (iFrame == 0 || iFrame == iEncFrameNum / 2) {
+      EXPECT_EQ (info.eFrameType, videoFrameTypeIDR);
+    }
+
+    for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+      aLen[iIdx] = 0;
+    }
+    for (int iLayer = 0; iLayer < info.iLayerNum; ++iLayer) {
+      iLayerLen = 0;
+      const SLayerBSInfo& layerInfo = info.sLayerInfo[iLayer];
+      for (int iNal = 0; iNal < layerInfo.iNalCount; ++iNal) {
+        iLayerLen += layerInfo.pNalLengthInByte[iNal];
+      }
+
+      iIdx = layerInfo.uiSpatialId;
+      ASSERT_TRUE (iIdx < iSpatialLayerNum);
+      memcpy ((pBsBuf[iIdx] + aLen[iIdx]), layerInfo.pBsBuf, iLayerLen * sizeof (unsigned char));
+      aLen[iIdx] += iLayerLen;
+    }
+
+    // every layer is a stream of its own
+    for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+      pData[0] = pData[1] = pData[2] = 0;
+      memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+
+      iResult = decoder[iIdx]->DecodeFrame2 (pBsBuf[iIdx], aLen[iIdx], pData, &dstBufInfo_);
+      EXPECT_TRUE (iResult == cmResultSuccess) << "iResult=" << iResult << "LayerIdx=" << iIdx;
+
+      iResult = decoder[iIdx]->DecodeFrame2 (NULL, 0, pData, &dstBufInfo_);
+      EXPECT_TRUE (iResult == cmResultSuccess) << "iResult=" << iResult << "LayerIdx=" << iIdx;
+      EXPECT_EQ (dstBufInfo_.iBufferStatus, 1) << "LayerIdx=" << iIdx;
+    }
+  }
+
+  for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+    free (pBsBuf[iIdx]);
+    decoder[iIdx]->Uninitialize();
+    WelsDestroyDecoder (decoder[iIdx]);
+  }
+}
+
+// a receiver of the merged stream keeps the parameter sets of all the layers and the slices of the layer it decodes
+TEST_F (EncodeDecodeTestAPI, SimulcastAVCLayerThreadingMergedStream) {
+  const int iSpatialLayerNum = 3;
+  const EParameterSetStrategy eStrategies[] = {CONSTANT_ID, INCREASING_ID};
+  for (size_t iStrategy = 0; iStrategy < sizeof (eStrategies) / sizeof (eStrategies[0]); iStrategy++) {
+    ISVCEncoder* pEncoder = NULL;
+    ASSERT_EQ (0, WelsCreateSVCEncoder (&pEncoder));
+    SEncParamExt sParam;
+    pEncoder->GetDefaultParams (&sParam);
+    prepareParam (iSpatialLayerNum, 1, 320, 192, 30.0f, &sParam);
+    sParam.bSimulcastAVC = true;
+    sParam.eSpsPpsIdStrategy = eStrategies[iStrategy];
+    bool bLayerThreading = true;
+    ASSERT_EQ (cmResultSuccess, pEncoder->SetOption (ENCODER_OPTION_SIMULCAST_LAYER_THREADING, &bLayerThreading));
+    ASSERT_EQ (cmResultSuccess, pEncoder->InitializeExt (&sParam));
+
+    ISVCDecoder* decoder[iSpatialLayerNum];
+    int iIdx;
+    for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+      ASSERT_EQ (0, WelsCreateDecoder (&decoder[iIdx]));
+      SDecodingParam decParam;
+      memset (&decParam, 0, sizeof (SDecodingParam));
+      decParam.uiTargetDqLayer = UCHAR_MAX;
+      decParam.eEcActiveIdc = ERROR_CON_DISABLE;
+      decParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+      ASSERT_EQ (0, decoder[iIdx]->Initialize (&decParam));
+    }
+    std::vector<unsigned char> vBs[iSpatialLayerNum];
+
+    const int iEncFrameNum = 8;
+    for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+      ASSERT_TRUE (InitialEncDec (sParam.iPicWidth, sParam.iPicHeight));
+      if (iFrame == iEncFrameNum / 2) {
+        pEncoder->ForceIntraFrame (true);
+      }
+      ASSERT_EQ (cmResultSuccess, pEncoder->EncodeFrame (&EncPic, &info));
+      for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+        vBs[iIdx].clear();
+      }
+      for (int iLayer = 0; iLayer < info.iLayerNum; ++iLayer) {
+        const SLayerBSInfo& layerInfo = info.sLayerInfo[iLayer];
+        const unsigned char* pNal = layerInfo.pBsBuf;
+        for (int iNal = 0; iNal < layerInfo.iNalCount; ++iNal) {
+          const int iNalType = pNal[4] & 0x1f;
+          for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+            if (iIdx == layerInfo.uiSpatialId || iNalType == 7 || iNalType == 8) {
+              vBs[iIdx].insert (vBs[iIdx].end(), pNal, pNal + layerInfo.pNalLengthInByte[iNal]);
+            }
+          }
+          pNal += layerInfo.pNalLengthInByte[iNal];
+        }
+      }
+
+      for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+        unsigned char* pData[3] = { NULL };
+        memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+        int iResult = decoder[iIdx]->DecodeFrame2 (&vBs[iIdx][0], (int)vBs[iIdx].size(), pData, &dstBufInfo_);
+        EXPECT_EQ (cmResultSuccess, iResult) << "LayerIdx=" << iIdx << " Frame=" << iFrame;
+        if (dstBufInfo_.iBufferStatus == 0) {
+          iResult = decoder[iIdx]->DecodeFrame2 (NULL, 0, pData, &dstBufInfo_);
+          EXPECT_EQ (cmResultSuccess, iResult) << "LayerIdx=" << iIdx << " Frame=" << iFrame;
+        }
+        ASSERT_EQ (1, dstBufInfo_.iBufferStatus) << "LayerIdx=" << iIdx << " Frame=" << iFrame;
+        EXPECT_EQ (sParam.sSpatialLayers[iIdx].iVideoWidth, dstBufInfo_.UsrData.sSystemBuffer.iWidth);
+        EXPECT_EQ (sParam.sSpatialLayers[iIdx].iVideoHeight, dstBufInfo_.UsrData.sSystemBuffer.iHeight);
+      }
+    }
+
+    for (iIdx = 0; iIdx < iSpatialLayerNum; iIdx++) {
+      decoder[iIdx]->Uninitialize();
+      WelsDestroyDecoder (decoder[iIdx]);
+    }
+    pEncoder->Uninitialize();
+    WelsDestroySVCEncoder (pEncoder);
+  }
+}
+
+// the pool param started from the defaults, bound to no CPU
+TEST_F (EncodeDecodeTestAPI, ThreadPoolDefaults) {
+  SThreadPoolParam sThreadPool;
+  memset (&sThreadPool, 0, sizeof (sThreadPool));
+  int rv = encoder_->GetOption (ENCODER_OPTION_THREAD_POOL, &sThreadPool);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  EXPECT_EQ (0, sThreadPool.iPoolId);
+  EXPECT_EQ (0, sThreadPool.iThreadNum);
+  EXPECT_EQ (-1, sThreadPool.iNumaNode);
+  EXPECT_EQ (0u, sThreadPool.uiCpuMask[0]);
+  sThreadPool.iThreadNum = 2;
+  rv = encoder_->SetOption (ENCODER_OPTION_THREAD_POOL, &sThreadPool);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 4, 320, 192, 30.0f, &param_);
+  param_.iMultipleThreadIdc = 4;
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iFrame = 0; iFrame < 4; iFrame++) {
+    EncodeOneFrame (0);
+    EXPECT_GT (info.iFrameSizeInBytes, 0);
+  }
+}
+
+static void AppendFrameBs (const SFrameBSInfo& kInfo, std::vector<unsigned char>* pBs) {
+  for (int iLayer = 0; iLayer < kInfo.iLayerNum; ++iLayer) {
+    const SLayerBSInfo& kLayerInfo = kInfo.sLayerInfo[iLayer];
+    int iLayerLen = 0;
+    for (int iNal = 0; iNal < kLayerInfo.iNalCount; ++iNal) {
+      iLayerLen += kLayerInfo.pNalLengthInByte[iNal];
+    }
+    pBs->insert (pBs->end(), kLayerInfo.pBsBuf, kLayerInfo.pBsBuf + iLayerLen);
+  }
+}
+
+TEST_F (EncodeDecodeTestAPI, WavefrontThreads) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 64, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 64, MAX_HEIGHT);
+  float fFrameRate = rand() + 0.5f;
+  int iSliceNum        = 1;
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, iSliceNum, iWidth, iHeight, fFrameRate, &param_);
+  param_.sSpatialLayers[0].sSliceArgument.uiSliceMode = SM_SINGLE_SLICE;
+
+  int iWavefrontThreadNum = 2 + rand() % 3;
+  int rv = encoder_->SetOption (ENCODER_OPTION_WAVEFRONT_THREADS, &iWavefrontThreadNum);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  // the option is taken before the initialization only
+  rv = encoder_->SetOption (ENCODER_OPTION_WAVEFRONT_THREADS, &iWavefrontThreadNum);
+  EXPECT_TRUE (rv != cmResultSuccess);
+
+  // with the rate control off the wavefront encoding is bit-exact with the serial one
+  ISVCEncoder* pSerialEncoder = NULL;
+  ASSERT_EQ (0, WelsCreateSVCEncoder (&pSerialEncoder));
+  rv = pSerialEncoder->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  std::vector<unsigned char> aBs[2];
+  SFrameBSInfo sSerialInfo;
+  const int iEncFrameNum = 10;
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    int iResult;
+    int len = 0;
+    unsigned char* pData[3] = { NULL };
+
+    // moving texture with noise, so that the MB rows take different modes and motion vectors
+    for (int i = 0; i < (int)buf_.Length(); i++) {
+      buf_.data()[i] = (unsigned char) ((((i + iFrame * 3) >> 3) * 37) + rand() % 16);
+    }
+    EncPic.uiTimeStamp = iFrame * 33;
+    if (iFrame == iEncFrameNum / 2) {
+      encoder_->ForceIntraFrame (true);
+      pSerialEncoder->ForceIntraFrame (true);
+    }
+    rv = encoder_->EncodeFrame (&EncPic, &info);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (info, &aBs[0]);
+    rv = pSerialEncoder->EncodeFrame (&EncPic, &sSerialInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (sSerialInfo, &aBs[1]);
+    if (iFrame == 0 || iFrame == iEncFrameNum / 2) {
+      EXPECT_EQ (info.eFrameType, videoFrameTypeIDR);
+    }
+    encToDecData (info, len);
+    pData[0] = pData[1] = pData[2] = 0;
+    memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+
+    iResult = decoder_->DecodeFrame2 (info.sLayerInfo[0].pBsBuf, len, pData, &dstBufInfo_);
+    EXPECT_TRUE (iResult == cmResultSuccess) << "iResult=" << iResult << " Frame=" << iFrame;
+    iResult = decoder_->DecodeFrame2 (NULL, 0, pData, &dstBufInfo_);
+    EXPECT_TRUE (iResult == cmResultSuccess) << "iResult=" << iResult << " Frame=" << iFrame;
+    EXPECT_EQ (dstBufInfo_.iBufferStatus, 1) << "Frame=" << iFrame;
+  }
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]) << iWidth << "x" << iHeight << " threads " << iWavefrontThreadNum;
+
+  pSerialEncoder->Uninitialize();
+  WelsDestroySVCEncoder (pSerialEncoder);
+}
+
+static void OnAsyncFrameEncoded (void* pContext, int iResult, const SFrameBSInfo* pBsInfo) {
+  EXPECT_EQ (iResult, cmResultSuccess);
+  AppendFrameBs (*pBsInfo, static_cast<std::vector<unsigned char>*> (pContext));
+}
+
+TEST_F (EncodeDecodeTestAPI, AsyncEncoding) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 16, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 16, MAX_HEIGHT);
+  float fFrameRate = rand() + 0.5f;
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, iWidth, iHeight, fFrameRate, &param_);
+  int rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  // the same frames encoded by a polled and a called back asynchronous encoder
+  std::vector<unsigned char> aBs[3];
+  ISVCEncoder* pAsyncEncoder[2];
+  SEncAsyncParam sAsyncParam;
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ (0, WelsCreateSVCEncoder (&pAsyncEncoder[i]));
+    memset (&sAsyncParam, 0, sizeof (sAsyncParam));
+    sAsyncParam.iMaxFramesInFlight = 1 + rand() % 4;
+    if (i == 1) {
+      sAsyncParam.pContext = &aBs[2];
+      sAsyncParam.pfOnFrameEncoded = OnAsyncFrameEncoded;
+    }
+    rv = pAsyncEncoder[i]->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    rv = pAsyncEncoder[i]->InitializeExt (&param_);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    // the option is taken before the initialization only
+    rv = pAsyncEncoder[i]->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+    EXPECT_TRUE (rv != cmResultSuccess);
+  }
+
+  const int iEncFrameNum = 10;
+  SFrameBSInfo sAsyncInfo;
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    const int kiLumaSize = EncPic.iPicWidth * EncPic.iPicHeight;
+    memset (buf_.data(), rand() % 256, kiLumaSize);
+    memset (buf_.data() + kiLumaSize, rand() % 256, kiLumaSize >> 1);
+    EncPic.uiTimeStamp = iFrame * 33;
+    if (iFrame == iEncFrameNum / 2) {
+      encoder_->ForceIntraFrame (true);
+      pAsyncEncoder[0]->ForceIntraFrame (true);
+      pAsyncEncoder[1]->ForceIntraFrame (true);
+    }
+    rv = encoder_->EncodeFrame (&EncPic, &info);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (info, &aBs[0]);
+
+    rv = pAsyncEncoder[0]->EncodeFrame (&EncPic, &sAsyncInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (sAsyncInfo, &aBs[1]);
+    rv = pAsyncEncoder[1]->EncodeFrame (&EncPic, &sAsyncInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    EXPECT_EQ (sAsyncInfo.iLayerNum, 0);
+  }
+  // flush
+  do {
+    rv = pAsyncEncoder[0]->EncodeFrame (NULL, &sAsyncInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (sAsyncInfo, &aBs[1]);
+  } while (sAsyncInfo.eFrameType != videoFrameTypeInvalid);
+  rv = pAsyncEncoder[1]->EncodeFrame (NULL, &sAsyncInfo);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]);
+  EXPECT_TRUE (aBs[0] == aBs[2]);
+  for (int i = 0; i < 2; i++) {
+    pAsyncEncoder[i]->Uninitialize();
+    WelsDestroySVCEncoder (pAsyncEncoder[i]);
+  }
+}
+
+TEST_F (EncodeDecodeTestAPI, AsyncEncodingPreparedSource) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 2)  + 1) << 2, 64, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 2)  + 1) << 2, 64, MAX_HEIGHT);
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (2, 1, iWidth, iHeight, 30.0f, &param_);
+  param_.bEnableDenoise = true;
+  param_.bEnableBackgroundDetection = (rand() % 2) != 0;
+  int rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  // the pictures and the VAA prepared ahead of coding give the bitstream of the synchronous encoder, moving and
+  // still content, both spatial layers and an option change in the middle of the stream alike
+  std::vector<unsigned char> aBs[2];
+  ISVCEncoder* pAsyncEncoder = NULL;
+  SEncAsyncParam sAsyncParam;
+  ASSERT_EQ (0, WelsCreateSVCEncoder (&pAsyncEncoder));
+  memset (&sAsyncParam, 0, sizeof (sAsyncParam));
+  sAsyncParam.iMaxFramesInFlight = 2 + rand() % 3;
+  rv = pAsyncEncoder->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  rv = pAsyncEncoder->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  const int iEncFrameNum = 12;
+  SFrameBSInfo sAsyncInfo;
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    // the left half moves, the right half stays
+    const int kiLumaSize = EncPic.iPicWidth * EncPic.iPicHeight;
+    for (int y = 0; y < EncPic.iPicHeight; y++) {
+      for (int x = 0; x < EncPic.iPicWidth; x++) {
+        const int kiShift = (x < (EncPic.iPicWidth >> 1)) ? iFrame * 3 : 0;
+        buf_.data()[y * EncPic.iPicWidth + x] = (unsigned char) (((x + kiShift) * 7 + y * 3 + ((x * y) & 15)) & 255);
+      }
+    }
+    memset (buf_.data() + kiLumaSize, 128 + iFrame, kiLumaSize >> 1);
+    EncPic.uiTimeStamp = iFrame * 33;
+    if (iFrame == iEncFrameNum / 2) {
+      param_.bEnableDenoise = false;
+      ASSERT_EQ (cmResultSuccess, encoder_->SetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &param_));
+      ASSERT_EQ (cmResultSuccess, pAsyncEncoder->SetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &param_));
+    }
+    rv = encoder_->EncodeFrame (&EncPic, &info);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (info, &aBs[0]);
+    rv = pAsyncEncoder->EncodeFrame (&EncPic, &sAsyncInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (sAsyncInfo, &aBs[1]);
+  }
+  // flush
+  do {
+    rv = pAsyncEncoder->EncodeFrame (NULL, &sAsyncInfo);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (sAsyncInfo, &aBs[1]);
+  } while (sAsyncInfo.eFrameType != videoFrameTypeInvalid);
+
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]) << iWidth << "x" << iHeight << " bgd " << param_.bEnableBackgroundDetection;
+  pAsyncEncoder->Uninitialize();
+  WelsDestroySVCEncoder (pAsyncEncoder);
+}
+
+TEST_F (EncodeDecodeTestAPI, NV12AndRgbInput) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 16, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 16, MAX_HEIGHT);
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, iWidth, iHeight, 30.0f, &param_);
+  int rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  // NV12 gives the bitstream of the same I420 frames, BGRA that of the same RGBA frames,
+  // converted by synchronous and asynchronous encoders alike
+  std::vector<unsigned char> aBs[6];
+  ISVCEncoder* pEncoder[5];
+  SEncAsyncParam sAsyncParam;
+  for (int i = 0; i < 5; i++) {
+    ASSERT_EQ (0, WelsCreateSVCEncoder (&pEncoder[i]));
+    if (i & 1) {
+      memset (&sAsyncParam, 0, sizeof (sAsyncParam));
+      sAsyncParam.iMaxFramesInFlight = 1 + rand() % 4;
+      rv = pEncoder[i]->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+      ASSERT_TRUE (rv == cmResultSuccess);
+    }
+    rv = pEncoder[i]->InitializeExt (&param_);
+    ASSERT_TRUE (rv == cmResultSuccess);
+  }
+
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  const int kiLumaSize = iWidth * iHeight;
+  std::vector<unsigned char> vNv12 (kiLumaSize * 3 / 2);
+  std::vector<unsigned char> vRgb[2];
+  vRgb[0].resize (kiLumaSize * 4);
+  vRgb[1].resize (kiLumaSize * 4);
+  SSourcePicture sNv12Pic = EncPic;
+  sNv12Pic.iColorFormat = videoFormatNV12;
+  sNv12Pic.iStride[1]   = iWidth;
+  sNv12Pic.pData[0]     = &vNv12[0];
+  sNv12Pic.pData[1]     = &vNv12[kiLumaSize];
+  sNv12Pic.pData[2]     = NULL;
+  SSourcePicture sRgbPic[2];
+  for (int i = 0; i < 2; i++) {
+    memset (&sRgbPic[i], 0, sizeof (SSourcePicture));
+    sRgbPic[i].iColorFormat = i ? videoFormatRGBA : videoFormatBGRA;
+    sRgbPic[i].iPicWidth    = iWidth;
+    sRgbPic[i].iPicHeight   = iHeight;
+    sRgbPic[i].iStride[0]   = iWidth * 4;
+    sRgbPic[i].pData[0]     = &vRgb[i][0];
+  }
+
+  const int iEncFrameNum = 6;
+  SFrameBSInfo sInfo;
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    // low amplitude noise, white noise would overflow the bitstream buffer of the large sizes
+    const int kiBase = rand() % 240;
+    unsigned char* pI420 = buf_.data();
+    for (int i = 0; i < kiLumaSize * 3 / 2; i++) {
+      pI420[i] = kiBase + rand() % 16;
+    }
+    memcpy (&vNv12[0], pI420, kiLumaSize);
+    for (int i = 0; i < (kiLumaSize >> 2); i++) {
+      vNv12[kiLumaSize + 2 * i]     = pI420[kiLumaSize + i];
+      vNv12[kiLumaSize + 2 * i + 1] = pI420[kiLumaSize + (kiLumaSize >> 2) + i];
+    }
+    for (int i = 0; i < kiLumaSize; i++) {
+      vRgb[0][4 * i]     = vRgb[1][4 * i + 2] = kiBase + rand() % 16;
+      vRgb[0][4 * i + 1] = vRgb[1][4 * i + 1] = kiBase + rand() % 16;
+      vRgb[0][4 * i + 2] = vRgb[1][4 * i]     = kiBase + rand() % 16;
+      vRgb[0][4 * i + 3] = vRgb[1][4 * i + 3] = kiBase + rand() % 16;
+    }
+    EncPic.uiTimeStamp = sNv12Pic.uiTimeStamp = sRgbPic[0].uiTimeStamp = sRgbPic[1].uiTimeStamp = iFrame * 33;
+
+    rv = encoder_->EncodeFrame (&EncPic, &info);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    AppendFrameBs (info, &aBs[0]);
+    const SSourcePicture* kpSrcPic[5] = { &sNv12Pic, &sNv12Pic, &sRgbPic[0], &sRgbPic[0], &sRgbPic[1] };
+    for (int i = 0; i < 5; i++) {
+      rv = pEncoder[i]->EncodeFrame (kpSrcPic[i], &sInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      AppendFrameBs (sInfo, &aBs[1 + i]);
+    }
+  }
+  for (int i = 1; i < 5; i += 2) {
+    do {
+      rv = pEncoder[i]->EncodeFrame (NULL, &sInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      AppendFrameBs (sInfo, &aBs[1 + i]);
+    } while (sInfo.eFrameType != videoFrameTypeInvalid);
+  }
+
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]);
+  EXPECT_TRUE (aBs[0] == aBs[2]);
+  EXPECT_FALSE (aBs[3].empty());
+  EXPECT_TRUE (aBs[3] == aBs[4]);
+  EXPECT_TRUE (aBs[3] == aBs[5]);
+
+  // a row shorter than the picture is refused without breaking the encoder
+  for (int i = 2; i < 4; i++) {
+    sRgbPic[0].iStride[0] = iWidth * 4 - 4;
+    EXPECT_TRUE (pEncoder[i]->EncodeFrame (&sRgbPic[0], &sInfo) != cmResultSuccess);
+    sRgbPic[0].iStride[0] = iWidth * 4;
+    sRgbPic[0].uiTimeStamp += 33;
+    rv = pEncoder[i]->EncodeFrame (&sRgbPic[0], &sInfo);
+    EXPECT_TRUE (rv == cmResultSuccess);
+  }
+
+  // packed YUV is not taken
+  EncPic.iColorFormat = videoFormatYUY2;
+  EXPECT_TRUE (encoder_->EncodeFrame (&EncPic, &info) != cmResultSuccess);
+  for (int i = 0; i < 5; i++) {
+    pEncoder[i]->Uninitialize();
+    WelsDestroySVCEncoder (pEncoder[i]);
+  }
+}
+
+TEST_F (EncodeDecodeTestAPI, RcLookahead) {
+  int iDepth       = 1 + rand() % 8;
+  // neither starved nor at the minimum QP, so the rate control has room to move the bits
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, 320, 192, 30.0f, &param_);
+  param_.iRCMode = RC_BITRATE_MODE;
+  param_.iTargetBitrate = param_.sSpatialLayers[0].iSpatialBitrate = 500000;
+
+  // the same frames encoded after a lookahead, synchronously and asynchronously, and without lookahead
+  std::vector<unsigned char> aBs[3];
+  ISVCEncoder* pLookaheadEncoder[2];
+  SEncAsyncParam sAsyncParam;
+  int rv;
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ (0, WelsCreateSVCEncoder (&pLookaheadEncoder[i]));
+    rv = pLookaheadEncoder[i]->SetOption (ENCODER_OPTION_RC_LOOKAHEAD, &iDepth);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    if (i == 1) {
+      memset (&sAsyncParam, 0, sizeof (sAsyncParam));
+      sAsyncParam.iMaxFramesInFlight = 1 + rand() % 4;
+      rv = pLookaheadEncoder[i]->SetOption (ENCODER_OPTION_ASYNC_ENCODING, &sAsyncParam);
+      ASSERT_TRUE (rv == cmResultSuccess);
+    }
+    rv = pLookaheadEncoder[i]->InitializeExt (&param_);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    // the option is taken before the initialization only
+    rv = pLookaheadEncoder[i]->SetOption (ENCODER_OPTION_RC_LOOKAHEAD, &iDepth);
+    EXPECT_TRUE (rv != cmResultSuccess);
+  }
+
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+
+  const int iEncFrameNum = 20;
+  int iOutputNum = 0;
+  SFrameBSInfo sLookaheadInfo;
+  SEncParamExt sOutParam;
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iFrame = 0; iFrame <= iEncFrameNum; iFrame++) {
+    const bool kbFlush = (iFrame == iEncFrameNum);
+    const int kiLumaSize = EncPic.iPicWidth * EncPic.iPicHeight;
+    // a scene cut every 5 frames
+    for (int i = 0; i < kiLumaSize; i++) {
+      buf_.data()[i] = (unsigned char) ((iFrame / 5) * 67 + i * (1 + iFrame / 5) + iFrame);
+    }
+    memset (buf_.data() + kiLumaSize, 128, kiLumaSize >> 1);
+    EncPic.uiTimeStamp = iFrame * 33;
+    if (iFrame == iEncFrameNum / 2) {
+      // querying the encoder does not encode the frames of the lookahead window before the next ones are seen
+      rv = pLookaheadEncoder[0]->GetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sOutParam);
+      EXPECT_TRUE (rv == cmResultSuccess);
+    }
+    do {
+      rv = pLookaheadEncoder[0]->EncodeFrame (kbFlush ? NULL : &EncPic, &sLookaheadInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      if (sLookaheadInfo.eFrameType == videoFrameTypeInvalid) {
+        // nothing output before the lookahead window is full
+        EXPECT_TRUE (kbFlush || iFrame < iDepth) << "Frame=" << iFrame;
+        break;
+      }
+      ++ iOutputNum;
+      std::vector<unsigned char> aFrameBs;
+      AppendFrameBs (sLookaheadInfo, &aFrameBs);
+      aBs[0].insert (aBs[0].end(), aFrameBs.begin(), aFrameBs.end());
+      if (!aFrameBs.empty()) {
+        unsigned char* pData[3] = { NULL };
+        memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+        rv = decoder_->DecodeFrame2 (&aFrameBs[0], (int)aFrameBs.size(), pData, &dstBufInfo_);
+        EXPECT_TRUE (rv == cmResultSuccess) << "rv=" << rv << " Frame=" << iOutputNum;
+      }
+    } while (kbFlush);
+    // the asynchronous encoder may hold more frames than the lookahead window
+    do {
+      rv = pLookaheadEncoder[1]->EncodeFrame (kbFlush ? NULL : &EncPic, &sLookaheadInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      AppendFrameBs (sLookaheadInfo, &aBs[1]);
+    } while (kbFlush && sLookaheadInfo.eFrameType != videoFrameTypeInvalid);
+    if (!kbFlush) {
+      rv = encoder_->EncodeFrame (&EncPic, &sLookaheadInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      AppendFrameBs (sLookaheadInfo, &aBs[2]);
+    }
+  }
+
+  EXPECT_EQ (iOutputNum, iEncFrameNum);
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]);
+  // the rate control saw the scene cuts coming
+  EXPECT_FALSE (aBs[0] == aBs[2]) << "Depth=" << iDepth;
+  for (int i = 0; i < 2; i++) {
+    pLookaheadEncoder[i]->Uninitialize();
+    WelsDestroySVCEncoder (pLookaheadEncoder[i]);
+  }
+}
+
+TEST_F (EncodeDecodeTestAPI, RcTwoPass) {
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, 320, 192, 30.0f, &param_);
+  param_.iRCMode = (rand() % 2) ? RC_BITRATE_MODE : RC_QUALITY_MODE;
+  param_.iTargetBitrate = param_.sSpatialLayers[0].iSpatialBitrate = 300000;
+
+  // the statistics file in the temporary directory
+#ifdef _WIN32
+  const char* kpTmpDir = getenv ("TEMP");
+#else
+  const char* kpTmpDir = getenv ("TMPDIR");
+  if (NULL == kpTmpDir)
+    kpTmpDir = "/tmp";
+#endif
+  char sStatsFile[256];
+  snprintf (sStatsFile, sizeof (sStatsFile), "%s/RcTwoPass_%d.stats", (NULL != kpTmpDir) ? kpTmpDir : ".", rand());
+
+  // the same frames encoded in a single pass, in the first pass and in the second pass; the encoder is reset by a
+  // parameter change in the middle of each, the two passes go on with the same statistics
+  const int iEncFrameNum = 30;
+  const int iResetFrame = 7;
+  std::vector<unsigned char> aBs[3];
+  SEncTwoPassParam sTwoPassParam;
+  SFrameBSInfo sTwoPassInfo;
+  uint32_t uiStatsHead[4] = {0};
+  int rv;
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+  for (int iPass = 0; iPass < 3; iPass++) {
+    ISVCEncoder* pTwoPassEncoder = NULL;
+    ASSERT_EQ (0, WelsCreateSVCEncoder (&pTwoPassEncoder));
+    sTwoPassParam.iPass = iPass;
+    sTwoPassParam.pStatsFileName = sStatsFile;
+    rv = pTwoPassEncoder->SetOption (ENCODER_OPTION_TWO_PASS, &sTwoPassParam);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    rv = pTwoPassEncoder->InitializeExt (&param_);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    // the option is taken before the initialization only
+    rv = pTwoPassEncoder->SetOption (ENCODER_OPTION_TWO_PASS, &sTwoPassParam);
+    EXPECT_TRUE (rv != cmResultSuccess);
+
+    for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+      if (iFrame == iResetFrame) {
+        SEncParamExt sResetParam = param_;
+        sResetParam.bEnableBackgroundDetection = !param_.bEnableBackgroundDetection;
+        rv = pTwoPassEncoder->SetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sResetParam);
+        ASSERT_TRUE (rv == cmResultSuccess);
+      }
+      const int kiLumaSize = EncPic.iPicWidth * EncPic.iPicHeight;
+      // a scene cut every 5 frames, the complexity of the scenes growing
+      for (int i = 0; i < kiLumaSize; i++) {
+        buf_.data()[i] = (unsigned char) ((iFrame / 5) * 67 + i * (1 + iFrame / 5) + iFrame);
+      }
+      memset (buf_.data() + kiLumaSize, 128, kiLumaSize >> 1);
+      EncPic.uiTimeStamp = iFrame * 33;
+      rv = pTwoPassEncoder->EncodeFrame (&EncPic, &sTwoPassInfo);
+      ASSERT_TRUE (rv == cmResultSuccess);
+      std::vector<unsigned char> aFrameBs;
+      AppendFrameBs (sTwoPassInfo, &aFrameBs);
+      aBs[iPass].insert (aBs[iPass].end(), aFrameBs.begin(), aFrameBs.end());
+      if (iPass == 2 && !aFrameBs.empty()) {
+        unsigned char* pData[3] = { NULL };
+        memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+        rv = decoder_->DecodeFrame2 (&aFrameBs[0], (int)aFrameBs.size(), pData, &dstBufInfo_);
+        EXPECT_TRUE (rv == cmResultSuccess) << "rv=" << rv << " Frame=" << iFrame;
+      }
+    }
+    // the statistics file is written till the first pass is uninitialized
+    pTwoPassEncoder->Uninitialize();
+    WelsDestroySVCEncoder (pTwoPassEncoder);
+    if (iPass == 1) {
+      FILE* pStatsFile = fopen (sStatsFile, "rb");
+      ASSERT_TRUE (pStatsFile != NULL);
+      ASSERT_EQ (1u, fread (uiStatsHead, sizeof (uiStatsHead), 1, pStatsFile));
+      fclose (pStatsFile);
+    }
+  }
+  EXPECT_EQ (0, remove (sStatsFile));
+
+  // the reset kept the records of the frames before it: the first record, after the two words of the header, starts
+  // with the time stamp of the first frame
+  EXPECT_EQ (0u, uiStatsHead[2]);
+  EXPECT_EQ (0u, uiStatsHead[3]);
+
+  // recording the statistics does not change the bitstream
+  EXPECT_FALSE (aBs[0].empty());
+  EXPECT_TRUE (aBs[0] == aBs[1]);
+  EXPECT_FALSE (aBs[2].empty());
+
+  // the second pass knows the complexity of the frames ahead and gets closer to the target
+  const double kdTargetBytes = param_.iTargetBitrate / 8.0 * iEncFrameNum / param_.fMaxFrameRate;
+  const double kdOnePassError = fabs (aBs[0].size() - kdTargetBytes);
+  const double kdTwoPassError = fabs (aBs[2].size() - kdTargetBytes);
+  EXPECT_LT (kdTwoPassError, kdOnePassError) << "target=" << kdTargetBytes << " one pass=" << aBs[0].size()
+      << " two pass=" << aBs[2].size();
+}
+
+TEST_F (EncodeDecodeTestAPI, HierarchicalMe) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 16, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 16, MAX_HEIGHT);
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, iWidth, iHeight, 30.0f, &param_);
+
+  bool bHierarchicalMe = true;
+  int rv = encoder_->SetOption (ENCODER_OPTION_HIERARCHICAL_ME, &bHierarchicalMe);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  // the option is taken before the initialization only
+  rv = encoder_->SetOption (ENCODER_OPTION_HIERARCHICAL_ME, &bHierarchicalMe);
+  EXPECT_TRUE (rv != cmResultSuccess);
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+
+  const int iEncFrameNum = 20;
+  for (int iFrame = 0; iFrame < iEncFrameNum; iFrame++) {
+    // a pattern moving fast, beyond the range of the full resolution search around the predictors
+    for (int y = 0; y < EncPic.iPicHeight; y++) {
+      for (int x = 0; x < EncPic.iPicWidth; x++) {
+        const int iX = x + iFrame * 13;
+        const int iY = y + iFrame * 7;
+        buf_.data()[y * EncPic.iPicWidth + x] = (unsigned char) (((iX >> 3) ^ (iY >> 3)) * 37 + iX + iY);
+      }
+    }
+    EncPic.uiTimeStamp = iFrame * 33;
+    rv = encoder_->EncodeFrame (&EncPic, &info);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    std::vector<unsigned char> aFrameBs;
+    AppendFrameBs (info, &aFrameBs);
+    if (!aFrameBs.empty()) {
+      unsigned char* pData[3] = { NULL };
+      memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+      rv = decoder_->DecodeFrame2 (&aFrameBs[0], (int)aFrameBs.size(), pData, &dstBufInfo_);
+      EXPECT_TRUE (rv == cmResultSuccess) << "rv=" << rv << " Frame=" << iFrame;
+    }
+  }
+}
+
+TEST_F (EncodeDecodeTestAPI, MemoryArena) {
+  int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 16, MAX_WIDTH);
+  int iHeight      = WelsClip3 ((((rand() % MAX_HEIGHT) >> 1)  + 1) << 1, 16, MAX_HEIGHT);
+  encoder_->GetDefaultParams (&param_);
+  prepareParam (1, 1, iWidth, iHeight, 30.0f, &param_);
+
+  SMemoryArenaParam sArena;
+  sArena.uiRegionSize = 1024 * 1024;
+  sArena.bHugePages = true;
+  int rv = encoder_->SetOption (ENCODER_OPTION_MEMORY_ARENA, &sArena);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  rv = encoder_->InitializeExt (&param_);
+  ASSERT_TRUE (rv == cmResultSuccess);
+  // the option is taken before the initialization only
+  rv = encoder_->SetOption (ENCODER_OPTION_MEMORY_ARENA, &sArena);
+  EXPECT_TRUE (rv != cmResultSuccess);
+  ASSERT_TRUE (InitialEncDec (param_.iPicWidth, param_.iPicHeight));
+
+  ISVCDecoder* pDecoder = NULL;
+  ASSERT_EQ (0, WelsCreateDecoder (&pDecoder));
+  ASSERT_TRUE (pDecoder != NULL);
+  rv = pDecoder->SetOption (DECODER_OPTION_MEMORY_ARENA, &sArena);
+  EXPECT_TRUE (rv == cmResultSuccess);
+  SDecodingParam decParam;
+  memset (&decParam, 0, sizeof (SDecodingParam));
+  decParam.uiTargetDqLayer = UCHAR_MAX;
+  decParam.eEcActiveIdc = ERROR_CON_SLICE_COPY;
+  decParam.sVideoProperty.eVideoBsType = VIDEO_BITSTREAM_DEFAULT;
+  ASSERT_EQ (0, pDecoder->Initialize (&decParam));
+
+  for (int iFrame = 0; iFrame < 10; iFrame++) {
+    EncodeOneFrame (0);
+    std::vector<unsigned char> aFrameBs;
+    AppendFrameBs (info, &aFrameBs);
+    if (!aFrameBs.empty()) {
+      unsigned char* pData[3] = { NULL };
+      memset (&dstBufInfo_, 0, sizeof (SBufferInfo));
+      rv = pDecoder->DecodeFrame2 (&aFrameBs[0], (int)aFrameBs.size(), pData, &dstBufInfo_);
+      EXPECT_TRUE (rv == cmResultSuccess) << "rv=" << rv << " Frame=" << iFrame;
+    }
+  }
+
+  SMemoryUsage* pUsage = new SMemoryUsage;
+  for (int iCodec = 0; iCodec < 2; iCodec++) {
+    rv = (iCodec == 0) ? encoder_->GetOption (ENCODER_OPTION_MEMORY_USAGE, pUsage)
+         : pDecoder->GetOption (DECODER_OPTION_MEMORY_USAGE, pUsage);
+    ASSERT_TRUE (rv == cmResultSuccess);
+    EXPECT_GT (pUsage->iRegionNum, 0);
+    EXPECT_GE (pUsage->uiArenaBytes, pUsage->iRegionNum * sArena.uiRegionSize);
+    EXPECT_GT (pUsage->iTagNum, 1);
+    EXPECT_GE (pUsage->uiPeakBytes, pUsage->uiTotalBytes);
+    unsigned int uiTagBytes = 0;
+    for (int i = 0; i < pUsage->iTagNum; i++)
+      uiTagBytes += pUsage->sTagUsage[i].uiBytes;
+    EXPECT_EQ (pUsage->uiTotalBytes, uiTagBytes);
+  }
+  delete pUsage;
+
+  pDecoder->Uninitialize();
+  WelsDestroyDecoder (pDecoder);
+}
+
 TEST_F (EncodeDecodeTestAPI, SimulcastAVC_SPS_PPS_LISTING) {
   int iSpatialLayerNum = WelsClip3 ((rand() % MAX_SPATIAL_LAYER_NUM), 2, MAX_SPATIAL_LAYER_NUM);;
   int iWidth       = WelsClip3 ((((rand() % MAX_WIDTH) >> 1)  + 1) << 1, 1 << iSpatialLayerNum, MAX_WIDTH);
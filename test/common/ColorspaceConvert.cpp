@@ -0,0 +1,181 @@
+#include <gtest/gtest.h>
+#include "colorspace_convert.h"
+#include "memory_align.h"
+#include "cpu.h"
+#include "cpu_core.h"
+#include "macros.h"
+
+#define COLORSPACE_CONVERT_TEST_NUM 10
+
+using namespace WelsCommon;
+
+static int32_t Avg2Anchor (int32_t iA, int32_t iB) {
+  return (iA + iB + 1) >> 1;
+}
+
+// BT.601 limited range of a B, G, R, A pixel
+static void BgraToYuvAnchor (const uint8_t* kpPix, uint8_t* pY) {
+  pY[0] = ((66 * kpPix[2] + 129 * kpPix[1] + 25 * kpPix[0] + 128) >> 8) + 16;
+}
+
+static void BgraToUVAnchor (const uint8_t* kpRow0, const uint8_t* kpRow1, uint8_t* pU, uint8_t* pV) {
+  int32_t iAvg[3];
+  for (int32_t j = 0; j < 3; j++)
+    iAvg[j] = Avg2Anchor (Avg2Anchor (kpRow0[j], kpRow1[j]), Avg2Anchor (kpRow0[4 + j], kpRow1[4 + j]));
+  pU[0] = ((-38 * iAvg[2] - 74 * iAvg[1] + 112 * iAvg[0] + 128) >> 8) + 128;
+  pV[0] = ((112 * iAvg[2] - 94 * iAvg[1] - 18 * iAvg[0] + 128) >> 8) + 128;
+}
+
+TEST (ColorspaceConvert, RowFunctions) {
+  SColorspaceConvertFunc sFuncs;
+  int32_t iCpuCores = 1;
+  InitColorspaceConvertVectorFunc (&sFuncs, WelsCPUFeatureDetect (&iCpuCores));
+  static const int16_t kiCoeff[3][8] = {
+    {  25, 129,  66,   0,  25, 129,  66,   0 },
+    { 112, -74, -38,   0, 112, -74, -38,   0 },
+    { -18, -94, 112,   0, -18, -94, 112,   0 }
+  };
+  const int32_t kiMaxWidth = 300;
+  ENFORCE_STACK_ALIGN_1D (uint8_t, uiSrc0, kiMaxWidth * 8, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, uiSrc1, kiMaxWidth * 8, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, uiAnchor, kiMaxWidth * 2, 16);
+  ENFORCE_STACK_ALIGN_1D (uint8_t, uiTest, kiMaxWidth * 2, 16);
+  for (int32_t iTestIdx = 0; iTestIdx < COLORSPACE_CONVERT_TEST_NUM; iTestIdx++) {
+    const int32_t kiWidth = 1 + rand() % kiMaxWidth;
+    for (int32_t i = 0; i < kiMaxWidth * 8; i++) {
+      uiSrc0[i] = rand() % 256;
+      uiSrc1[i] = rand() % 256;
+    }
+
+    memset (uiAnchor, 0, kiMaxWidth * 2);
+    memset (uiTest, 0, kiMaxWidth * 2);
+    WelsSplitUVRow_c (uiAnchor, uiAnchor + kiMaxWidth, uiSrc0, kiWidth);
+    sFuncs.pfSplitUVRow (uiTest, uiTest + kiMaxWidth, uiSrc0, kiWidth);
+    EXPECT_EQ (0, memcmp (uiAnchor, uiTest, kiMaxWidth * 2)) << "split, width " << kiWidth;
+
+    memset (uiTest, 0, kiMaxWidth * 2);
+    sFuncs.pfRgb32ToYRow (uiTest, uiSrc0, kiWidth, kiCoeff[0]);
+    for (int32_t i = 0; i < kiWidth; i++)
+      BgraToYuvAnchor (uiSrc0 + 4 * i, uiAnchor + i);
+    EXPECT_EQ (0, memcmp (uiAnchor, uiTest, kiWidth)) << "luma, width " << kiWidth;
+    EXPECT_EQ (0, uiTest[kiWidth]);
+
+    memset (uiTest, 0, kiMaxWidth * 2);
+    sFuncs.pfRgb32ToUVRow (uiTest, uiTest + kiMaxWidth, uiSrc0, uiSrc1, kiWidth, kiCoeff[1]);
+    for (int32_t i = 0; i < kiWidth; i++)
+      BgraToUVAnchor (uiSrc0 + 8 * i, uiSrc1 + 8 * i, uiAnchor + i, uiAnchor + kiMaxWidth + i);
+    EXPECT_EQ (0, memcmp (uiAnchor, uiTest, kiWidth)) << "u, width " << kiWidth;
+    EXPECT_EQ (0, memcmp (uiAnchor + kiMaxWidth, uiTest + kiMaxWidth, kiWidth)) << "v, width " << kiWidth;
+  }
+}
+
+TEST (ColorspaceConvert, Nv12ToI420) {
+  SColorspaceConvertFunc sFuncs;
+  int32_t iCpuCores = 1;
+  InitColorspaceConvertVectorFunc (&sFuncs, WelsCPUFeatureDetect (&iCpuCores));
+  for (int32_t iTestIdx = 0; iTestIdx < COLORSPACE_CONVERT_TEST_NUM; iTestIdx++) {
+    const int32_t kiWidth = 2 + (rand() % 200) * 2;
+    const int32_t kiHeight = 2 + (rand() % 100) * 2;
+    const int32_t kiSrcStride = kiWidth + (rand() % 32);
+    const bool kbFlip = (iTestIdx & 1) != 0;
+    uint8_t* pSrc = static_cast<uint8_t*> (WelsMallocz (kiSrcStride * kiHeight * 3 / 2, "pSrc"));
+    uint8_t* pDstBuff = static_cast<uint8_t*> (WelsMallocz (kiWidth * kiHeight * 3 / 2, "pDstBuff"));
+    ASSERT_TRUE (pSrc != NULL && pDstBuff != NULL);
+    for (int32_t i = 0; i < kiSrcStride * kiHeight * 3 / 2; i++)
+      pSrc[i] = rand() % 256;
+
+    SSourcePicture sSrc;
+    memset (&sSrc, 0, sizeof (sSrc));
+    sSrc.iColorFormat = videoFormatNV12 | (kbFlip ? videoFormatVFlip : 0);
+    sSrc.iPicWidth = kiWidth;
+    sSrc.iPicHeight = kiHeight;
+    sSrc.iStride[0] = sSrc.iStride[1] = kiSrcStride;
+    sSrc.pData[0] = pSrc;
+    sSrc.pData[1] = pSrc + kiSrcStride * kiHeight;
+    uint8_t* pDst[3] = { pDstBuff, pDstBuff + kiWidth * kiHeight, pDstBuff + kiWidth * kiHeight * 5 / 4 };
+    const int32_t kiDstStride[3] = { kiWidth, kiWidth >> 1, kiWidth >> 1 };
+    ASSERT_EQ (0, WelsConvertToI420 (&sFuncs, &sSrc, 0, 0, kiWidth, kiHeight, pDst, kiDstStride));
+
+    bool bSame = true;
+    for (int32_t j = 0; j < kiHeight && bSame; j++) {
+      const int32_t kiSrcRow = kbFlip ? kiHeight - 1 - j : j;
+      bSame = memcmp (pDst[0] + j * kiDstStride[0], sSrc.pData[0] + kiSrcRow * kiSrcStride, kiWidth) == 0;
+    }
+    for (int32_t j = 0; j < (kiHeight >> 1) && bSame; j++) {
+      const int32_t kiSrcRow = kbFlip ? (kiHeight >> 1) - 1 - j : j;
+      for (int32_t i = 0; i < (kiWidth >> 1) && bSame; i++) {
+        bSame = pDst[1][j * kiDstStride[1] + i] == sSrc.pData[1][kiSrcRow * kiSrcStride + 2 * i]
+                && pDst[2][j * kiDstStride[2] + i] == sSrc.pData[1][kiSrcRow * kiSrcStride + 2 * i + 1];
+      }
+    }
+    EXPECT_TRUE (bSame) << kiWidth << "x" << kiHeight << (kbFlip ? " flipped" : "");
+
+    // too short a destination stride is refused
+    const int32_t kiShortStride[3] = { kiWidth - 2, kiWidth >> 1, kiWidth >> 1 };
+    EXPECT_EQ (1, WelsConvertToI420 (&sFuncs, &sSrc, 0, 0, kiWidth, kiHeight, pDst, kiShortStride));
+
+    WELS_SAFE_FREE (pSrc, "pSrc");
+    WELS_SAFE_FREE (pDstBuff, "pDstBuff");
+  }
+}
+
+TEST (ColorspaceConvert, Rgb32ToI420) {
+  SColorspaceConvertFunc sFuncs;
+  int32_t iCpuCores = 1;
+  InitColorspaceConvertVectorFunc (&sFuncs, WelsCPUFeatureDetect (&iCpuCores));
+  static const EVideoFormatType keFormat[4] = { videoFormatBGRA, videoFormatRGBA, videoFormatARGB, videoFormatABGR };
+  // memory position of B, G and R for each format
+  static const int32_t kiPos[4][3] = { { 0, 1, 2 }, { 2, 1, 0 }, { 3, 2, 1 }, { 1, 2, 3 } };
+  for (int32_t iTestIdx = 0; iTestIdx < COLORSPACE_CONVERT_TEST_NUM; iTestIdx++) {
+    const int32_t kiFmt = iTestIdx & 3;
+    const int32_t kiWidth = 2 + (rand() % 200) * 2;
+    const int32_t kiHeight = 2 + (rand() % 100) * 2;
+    const int32_t kiSrcStride = kiWidth * 4;
+    uint8_t* pBgra = static_cast<uint8_t*> (WelsMallocz (kiSrcStride * kiHeight, "pBgra"));
+    uint8_t* pSrc = static_cast<uint8_t*> (WelsMallocz (kiSrcStride * kiHeight, "pSrc"));
+    uint8_t* pDstBuff = static_cast<uint8_t*> (WelsMallocz (kiWidth * kiHeight * 3 / 2, "pDstBuff"));
+    ASSERT_TRUE (pBgra != NULL && pSrc != NULL && pDstBuff != NULL);
+    for (int32_t i = 0; i < kiWidth * kiHeight; i++) {
+      for (int32_t k = 0; k < 4; k++)
+        pBgra[4 * i + k] = rand() % 256;
+      for (int32_t k = 0; k < 3; k++)
+        pSrc[4 * i + kiPos[kiFmt][k]] = pBgra[4 * i + k];
+      pSrc[4 * i + 6 - kiPos[kiFmt][0] - kiPos[kiFmt][1] - kiPos[kiFmt][2]] = pBgra[4 * i + 3];
+    }
+
+    SSourcePicture sSrc;
+    memset (&sSrc, 0, sizeof (sSrc));
+    sSrc.iColorFormat = keFormat[kiFmt];
+    sSrc.iPicWidth = kiWidth;
+    sSrc.iPicHeight = kiHeight;
+    sSrc.iStride[0] = kiSrcStride;
+    sSrc.pData[0] = pSrc;
+    uint8_t* pDst[3] = { pDstBuff, pDstBuff + kiWidth * kiHeight, pDstBuff + kiWidth * kiHeight * 5 / 4 };
+    const int32_t kiDstStride[3] = { kiWidth, kiWidth >> 1, kiWidth >> 1 };
+    ASSERT_EQ (0, WelsConvertToI420 (&sFuncs, &sSrc, 0, 0, kiWidth, kiHeight, pDst, kiDstStride));
+
+    bool bSame = true;
+    uint8_t uiAnchor[2];
+    for (int32_t j = 0; j < kiHeight && bSame; j++) {
+      for (int32_t i = 0; i < kiWidth && bSame; i++) {
+        BgraToYuvAnchor (pBgra + j * kiSrcStride + 4 * i, uiAnchor);
+        bSame = pDst[0][j * kiDstStride[0] + i] == uiAnchor[0];
+      }
+    }
+    for (int32_t j = 0; j < (kiHeight >> 1) && bSame; j++) {
+      for (int32_t i = 0; i < (kiWidth >> 1) && bSame; i++) {
+        const uint8_t* kpRow0 = pBgra + 2 * j * kiSrcStride + 8 * i;
+        BgraToUVAnchor (kpRow0, kpRow0 + kiSrcStride, uiAnchor, uiAnchor + 1);
+        bSame = pDst[1][j * kiDstStride[1] + i] == uiAnchor[0] && pDst[2][j * kiDstStride[2] + i] == uiAnchor[1];
+      }
+    }
+    EXPECT_TRUE (bSame) << "format " << keFormat[kiFmt] << ", " << kiWidth << "x" << kiHeight;
+
+    WELS_SAFE_FREE (pBgra, "pBgra");
+    WELS_SAFE_FREE (pSrc, "pSrc");
+    WELS_SAFE_FREE (pDstBuff, "pDstBuff");
+  }
+
+  EXPECT_FALSE (WelsCanConvertToI420 (videoFormatYUY2));
+  EXPECT_TRUE (WelsCanConvertToI420 (videoFormatBGRA | videoFormatVFlip));
+}
@@ -75,6 +75,116 @@ TEST (CThreadPoolTest, CThreadPoolTest) {
 }
 
 
+// tasks queued by the tasks running on the pool, beyond the capacity of the thread deque
+TEST (CThreadPoolTest, CThreadPoolTestQueueFromTask) {
+  const int32_t kiSpawnTaskNum = 8;
+  const int32_t kiSubTaskNum = 300;
+  CThreadPoolTest cThreadPoolTest;
+  CSpawnTask* aSpawnTasks[kiSpawnTaskNum];
+  IWelsTask* aSubTasks[kiSpawnTaskNum][kiSubTaskNum];
+  int32_t i, j;
+
+  CWelsThreadPool* pThreadPool = (CWelsThreadPool::AddReference());
+  ASSERT_TRUE (pThreadPool != NULL);
+
+  for (i = 0; i < kiSpawnTaskNum; i++) {
+    for (j = 0; j < kiSubTaskNum; j++) {
+      aSubTasks[i][j] = new CEmptyTask (&cThreadPoolTest);
+    }
+    aSpawnTasks[i] = new CSpawnTask (&cThreadPoolTest, pThreadPool, aSubTasks[i], kiSubTaskNum);
+  }
+
+  for (i = 0; i < kiSpawnTaskNum; i++) {
+    EXPECT_EQ (WELS_THREAD_ERROR_OK, pThreadPool->QueueTask (aSpawnTasks[i]));
+  }
+
+  while (cThreadPoolTest.GetTaskCount() < kiSpawnTaskNum * (1 + kiSubTaskNum)) {
+    WelsSleep (1);
+  }
+  EXPECT_EQ (kiSpawnTaskNum * (1 + kiSubTaskNum), cThreadPoolTest.GetTaskCount());
+
+  pThreadPool->RemoveInstance();
+
+  for (i = 0; i < kiSpawnTaskNum; i++) {
+    for (j = 0; j < kiSubTaskNum; j++) {
+      delete aSubTasks[i][j];
+    }
+    delete aSpawnTasks[i];
+  }
+}
+
+// pools owned by the instances, shared by the ones with the same pool id
+TEST (CThreadPoolTest, CThreadPoolTestPrivate) {
+  CThreadPoolTest cThreadPoolTest;
+  CSimpleTask* aTasks[TEST_TASK_NUM];
+  SThreadPoolParam sParam;
+  int32_t i;
+
+  memset (&sParam, 0, sizeof (sParam));
+  sParam.iNumaNode = -1;
+  sParam.uiCpuMask[0] = 1; // bound to the first CPU
+  CWelsThreadPool* pPrivate = CWelsThreadPool::AddReference (&sParam, 3);
+  ASSERT_TRUE (pPrivate != NULL);
+  EXPECT_EQ (3, pPrivate->GetThreadNum());
+  EXPECT_FALSE (CWelsThreadPool::IsReferenced());
+
+  CWelsThreadPool* pAnother = CWelsThreadPool::AddReference (&sParam, 3);
+  ASSERT_TRUE (pAnother != NULL);
+  EXPECT_TRUE (pAnother != pPrivate);
+  pAnother->RemoveInstance();
+
+  sParam.iPoolId = 7;
+  sParam.iThreadNum = 2;
+  sParam.uiCpuMask[0] = 0;
+  CWelsThreadPool* pShared = CWelsThreadPool::AddReference (&sParam, 5);
+  ASSERT_TRUE (pShared != NULL);
+  EXPECT_EQ (2, pShared->GetThreadNum());
+  EXPECT_EQ (pShared, CWelsThreadPool::AddReference (&sParam, 5));
+
+  CWelsThreadPool* pGlobal = CWelsThreadPool::AddReference();
+  ASSERT_TRUE (pGlobal != NULL);
+  EXPECT_TRUE (pGlobal != pShared && pGlobal != pPrivate);
+
+  for (i = 0; i < TEST_TASK_NUM; i++) {
+    aTasks[i] = new CSimpleTask (&cThreadPoolTest);
+    CWelsThreadPool* pPool = (i % 3 == 0) ? pPrivate : ((i % 3 == 1) ? pShared : pGlobal);
+    EXPECT_EQ (WELS_THREAD_ERROR_OK, pPool->QueueTask (aTasks[i]));
+  }
+  while (cThreadPoolTest.GetTaskCount() < TEST_TASK_NUM) {
+    WelsSleep (1);
+  }
+
+  pShared->RemoveInstance();
+  pShared->RemoveInstance();
+  pPrivate->RemoveInstance();
+  pGlobal->RemoveInstance();
+  EXPECT_FALSE (CWelsThreadPool::IsReferenced());
+
+  for (i = 0; i < TEST_TASK_NUM; i++) {
+    delete aTasks[i];
+  }
+}
+
+// the threads bound to a NUMA node only when given one
+TEST (CThreadPoolTest, CThreadPoolTestNumaNode) {
+  SThreadPoolParam sParam;
+  uint64_t uiNodeMask[WELS_CPU_MASK_WORDS];
+
+  memset (&sParam, 0, sizeof (sParam));
+  sParam.iNumaNode = -1;
+  CWelsThreadPool* pPool = CWelsThreadPool::AddReference (&sParam, 2);
+  ASSERT_TRUE (pPool != NULL);
+  EXPECT_FALSE (pPool->HasCpuAffinity());
+  pPool->RemoveInstance();
+
+  sParam.iNumaNode = 0;
+  pPool = CWelsThreadPool::AddReference (&sParam, 2);
+  ASSERT_TRUE (pPool != NULL);
+  EXPECT_EQ (WELS_THREAD_ERROR_OK == WelsQueryNumaNodeCpus (0, uiNodeMask, WELS_CPU_MASK_WORDS),
+             pPool->HasCpuAffinity());
+  pPool->RemoveInstance();
+}
+
 TEST (CThreadPoolTest, CThreadPoolTestMulti) {
   int iCallingNum = 10;
   WELS_THREAD_HANDLE mThreadID[30];
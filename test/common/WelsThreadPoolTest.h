@@ -75,5 +75,38 @@ class CSimpleTask : public IWelsTask {
   uint32_t m_uiID;
 };
 
+class CEmptyTask : public IWelsTask {
+ public:
+  CEmptyTask (WelsCommon::IWelsTaskSink* pSink) : IWelsTask (pSink) {
+  }
+
+  virtual int32_t Execute() {
+    return cmResultSuccess;
+  }
+};
+
+// queues its sub tasks into the pool it is running on
+class CSpawnTask : public IWelsTask {
+ public:
+  CSpawnTask (WelsCommon::IWelsTaskSink* pSink, CWelsThreadPool* pThreadPool, IWelsTask** ppSubTasks,
+              int32_t iSubTaskNum) : IWelsTask (pSink) {
+    m_pThreadPool = pThreadPool;
+    m_ppSubTasks = ppSubTasks;
+    m_iSubTaskNum = iSubTaskNum;
+  }
+
+  virtual int32_t Execute() {
+    for (int32_t i = 0; i < m_iSubTaskNum; i++) {
+      m_pThreadPool->QueueTask (m_ppSubTasks[i]);
+    }
+    return cmResultSuccess;
+  }
+
+ private:
+  CWelsThreadPool* m_pThreadPool;
+  IWelsTask** m_ppSubTasks;
+  int32_t m_iSubTaskNum;
+};
+
 #endif
 
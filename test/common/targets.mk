@@ -1,5 +1,6 @@
 COMMON_UNITTEST_SRCDIR=test/common
 COMMON_UNITTEST_CPP_SRCS=\
+	$(COMMON_UNITTEST_SRCDIR)/ColorspaceConvert.cpp\
 	$(COMMON_UNITTEST_SRCDIR)/CWelsListTest.cpp\
 	$(COMMON_UNITTEST_SRCDIR)/ExpandPicture.cpp\
 	$(COMMON_UNITTEST_SRCDIR)/WelsThreadPoolTest.cpp\
@@ -4,6 +4,8 @@
 #include "decoder_context.h"
 #include "decoder.h"
 #include "decoder_core.h"
+#include "au_parser.h"
+#include "cpu.h"
 #include "welsCodecTrace.h"
 #include "../../common/src/welsCodecTrace.cpp"
 
@@ -407,3 +409,45 @@ TEST_F (DecoderParseSyntaxTest, DecoderParseSyntaxTestAll) {
 }
 
 
+
+namespace {
+
+int32_t ScanNalEscape_ref (const uint8_t* kpSrc, int32_t iSrcLen) {
+  for (int32_t i = 0; i + 2 < iSrcLen; i++) {
+    if (0 == kpSrc[i] && 0 == kpSrc[i + 1] && kpSrc[i + 2] <= 0x03)
+      return i;
+  }
+  return iSrcLen;
+}
+
+} // anon ns
+
+#define GENERATE_SCANNALESCAPE(name, flag) \
+TEST (DecoderScanNalEscape, name) {\
+  const int32_t kiBufSize = 512;\
+  uint8_t uiBuf[kiBufSize];\
+  uint32_t uiCPUFlags = WelsCPUFeatureDetect (NULL);\
+  if ((uiCPUFlags & flag) == 0 && flag != 0)\
+    return;\
+  PScanNalEscapeFunc pfScan = (flag != 0) ? GetNalScanVectorFunc (flag) : WelsScanNalEscape_c;\
+  ASSERT_TRUE (pfScan != NULL);\
+  for (int32_t iRunTimes = 0; iRunTimes < 2000; iRunTimes++) {\
+    const int32_t kiZeroRate = 2 + (iRunTimes & 63);\
+    for (int32_t i = 0; i < kiBufSize; i++)\
+      uiBuf[i] = (rand() % kiZeroRate) ? (rand() & 0xff) : 0;\
+    const int32_t kiStart = rand() % 64;\
+    const int32_t kiLen = rand() % (kiBufSize - kiStart);\
+    EXPECT_EQ (ScanNalEscape_ref (uiBuf + kiStart, kiLen), pfScan (uiBuf + kiStart, kiLen));\
+  }\
+}
+
+GENERATE_SCANNALESCAPE (WelsScanNalEscape_c, 0)
+#if defined(X86_ASM)
+GENERATE_SCANNALESCAPE (WelsScanZeroPair_sse2, WELS_CPU_SSE2)
+#if defined(HAVE_AVX2)
+GENERATE_SCANNALESCAPE (WelsScanZeroPair_avx2, WELS_CPU_AVX2)
+#endif
+#endif
+#if defined(HAVE_NEON_AARCH64)
+GENERATE_SCANNALESCAPE (WelsScanZeroPair_AArch64_neon, WELS_CPU_NEON)
+#endif
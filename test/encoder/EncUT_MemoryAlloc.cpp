@@ -1,5 +1,7 @@
 #include "gtest/gtest.h"
 #include "memory_align.h"
+#include "buffer_pool.h"
+#include "welsEncoderExt.h"
 
 using namespace WelsCommon;
 
@@ -39,7 +41,7 @@ TEST (MemoryAlignTest, WelsMallocAndFreeOnceFunctionVerify) {
     const uint32_t kuiUsedCacheLineSize = ((kuiTestAlignSize == 0)
                                            || (kuiTestAlignSize & 0x0F)) ? (16) : (kuiTestAlignSize);
     const uint32_t kuiExtraAlignSize    = kuiUsedCacheLineSize - 1;
-    const uint32_t kuiExpectedSize      = sizeof (void**) + sizeof (int32_t) + kuiExtraAlignSize + uiSize;
+    const uint32_t kuiExpectedSize      = sizeof (void**) + sizeof (int32_t) + sizeof (uint32_t) + kuiExtraAlignSize + uiSize;
     uint8_t* pUnitTestData = static_cast<uint8_t*> (cTestMa.WelsMalloc (uiSize, strUnitTestTag));
     if (pUnitTestData != NULL) {
       ASSERT_TRUE ((((uintptr_t) (pUnitTestData)) & kuiExtraAlignSize) == 0);
@@ -54,3 +56,194 @@ TEST (MemoryAlignTest, WelsMallocAndFreeOnceFunctionVerify) {
     }
   }
 }
+
+TEST (MemoryAlignTest, ArenaCarvesBlocksFromRegions) {
+  const uint32_t kuiRegionSize = 256 * 1024;
+  const int32_t kiBlockNum = 300;
+  CMemoryAlign cTestMa (32, kuiRegionSize, false);
+  uint8_t* pBlocks[kiBlockNum];
+  for (int32_t i = 0; i < kiBlockNum; i++) {
+    pBlocks[i] = static_cast<uint8_t*> (cTestMa.WelsMallocz (1000 + i, "pSmallBlock"));
+    ASSERT_TRUE (pBlocks[i] != NULL);
+    ASSERT_TRUE ((((uintptr_t) pBlocks[i]) & 31) == 0);
+    EXPECT_EQ (0, pBlocks[i][0] | pBlocks[i][999 + i]);
+    memset (pBlocks[i], i, 1000 + i);
+  }
+  // too large to be carved
+  uint8_t* pLarge = static_cast<uint8_t*> (cTestMa.WelsMalloc (kuiRegionSize, "pLargeBlock"));
+  ASSERT_TRUE (pLarge != NULL);
+  for (int32_t i = 0; i < kiBlockNum; i++) {
+    ASSERT_EQ ((uint8_t) i, pBlocks[i][0]);
+    ASSERT_EQ ((uint8_t) i, pBlocks[i][999 + i]);
+  }
+
+  SMemoryUsage* pUsage = new SMemoryUsage;
+  cTestMa.WelsGetTagUsage (pUsage);
+  EXPECT_EQ (2, pUsage->iRegionNum);
+  EXPECT_EQ (2 * kuiRegionSize, pUsage->uiArenaBytes);
+  EXPECT_EQ (cTestMa.WelsGetMemoryUsage(), pUsage->uiTotalBytes);
+  ASSERT_EQ (3, pUsage->iTagNum);
+  EXPECT_STREQ ("others", pUsage->sTagUsage[0].sTag);
+  EXPECT_STREQ ("pSmallBlock", pUsage->sTagUsage[1].sTag);
+  EXPECT_EQ ((uint32_t) kiBlockNum, pUsage->sTagUsage[1].uiBlockNum);
+  EXPECT_STREQ ("pLargeBlock", pUsage->sTagUsage[2].sTag);
+  EXPECT_EQ (1u, pUsage->sTagUsage[2].uiBlockNum);
+  EXPECT_EQ (pUsage->uiTotalBytes, pUsage->sTagUsage[1].uiBytes + pUsage->sTagUsage[2].uiBytes);
+
+  // the full region is released with its last block, the one being carved is kept
+  for (int32_t i = 0; i < kiBlockNum; i++)
+    cTestMa.WelsFree (pBlocks[i], "pSmallBlock");
+  cTestMa.WelsFree (pLarge, "pLargeBlock");
+  cTestMa.WelsGetTagUsage (pUsage);
+  EXPECT_EQ (1, pUsage->iRegionNum);
+  EXPECT_EQ (0u, pUsage->uiTotalBytes);
+  EXPECT_EQ (0u, pUsage->sTagUsage[1].uiBlockNum);
+  EXPECT_EQ (pUsage->uiPeakBytes, pUsage->sTagUsage[1].uiPeakBytes + pUsage->sTagUsage[2].uiPeakBytes);
+  delete pUsage;
+}
+
+TEST (MemoryAlignTest, TagsMatchedByName) {
+  CMemoryAlign cTestMa (16);
+  char sTag[32] = "pNamedBuffer";
+  void* pFirst = cTestMa.WelsMalloc (64, "pNamedBuffer");
+  void* pSecond = cTestMa.WelsMalloc (128, sTag);
+  void* pThird = cTestMa.WelsMalloc (256, NULL);
+  SMemoryUsage* pUsage = new SMemoryUsage;
+  cTestMa.WelsGetTagUsage (pUsage);
+  ASSERT_EQ (2, pUsage->iTagNum);
+  EXPECT_EQ (1u, pUsage->sTagUsage[0].uiBlockNum);
+  EXPECT_EQ (2u, pUsage->sTagUsage[1].uiBlockNum);
+  EXPECT_EQ (0, pUsage->iRegionNum);
+  cTestMa.WelsFree (pFirst, "pNamedBuffer");
+  cTestMa.WelsFree (pSecond, sTag);
+  cTestMa.WelsFree (pThird, NULL);
+  delete pUsage;
+}
+
+TEST (MemoryAlignTest, TagsBeyondTheTable) {
+  CMemoryAlign cTestMa (16);
+  void* pBuffers[2][MAX_MEMORY_TAG_NUM + 8];
+  char sTag[32];
+  // the tags beyond MAX_MEMORY_TAG_NUM - 1 are counted to "others", the ones seen already are found again
+  for (int j = 0; j < 2; j++) {
+    for (int i = 0; i < MAX_MEMORY_TAG_NUM + 8; i++) {
+      snprintf (sTag, sizeof (sTag), "pTag%d", i);
+      pBuffers[j][i] = cTestMa.WelsMalloc (16, sTag);
+      ASSERT_TRUE (pBuffers[j][i] != NULL);
+    }
+  }
+  SMemoryUsage* pUsage = new SMemoryUsage;
+  cTestMa.WelsGetTagUsage (pUsage);
+  ASSERT_EQ (MAX_MEMORY_TAG_NUM, pUsage->iTagNum);
+  EXPECT_EQ (2u * 9, pUsage->sTagUsage[0].uiBlockNum);
+  for (int i = 1; i < MAX_MEMORY_TAG_NUM; i++) {
+    snprintf (sTag, sizeof (sTag), "pTag%d", i - 1);
+    EXPECT_STREQ (sTag, pUsage->sTagUsage[i].sTag);
+    EXPECT_EQ (2u, pUsage->sTagUsage[i].uiBlockNum);
+  }
+  for (int j = 0; j < 2; j++) {
+    for (int i = 0; i < MAX_MEMORY_TAG_NUM + 8; i++) {
+      cTestMa.WelsFree (pBuffers[j][i], NULL);
+    }
+  }
+  cTestMa.WelsGetTagUsage (pUsage);
+  EXPECT_EQ (0u, pUsage->uiTotalBytes);
+  delete pUsage;
+}
+
+//Tests of CWelsBufferPool Begin
+TEST (BufferPoolTest, ReuseReleasedBuffer) {
+  WelsEnc::CWelsBufferPool cPool;
+  const char* kpTag = "pUnitTestData";
+  uint8_t* pFirst = static_cast<uint8_t*> (cPool.Acquire (1000, kpTag));
+  uint8_t* pSecond = static_cast<uint8_t*> (cPool.Acquire (4000, kpTag));
+  ASSERT_TRUE (pFirst != NULL && pSecond != NULL);
+  ASSERT_TRUE ((((uintptr_t) pFirst) & 31) == 0);
+  const uint32_t kuiUsage = cPool.GetMemoryUsage();
+  cPool.Release (pFirst, kpTag);
+  cPool.Release (pSecond, kpTag);
+  EXPECT_EQ (2u, cPool.GetIdleNum());
+
+  // the smallest idle buffer large enough is handed out again, a buffer too large for the request is not
+  EXPECT_EQ (pSecond, cPool.Acquirez (2500, kpTag));
+  EXPECT_EQ (pFirst, cPool.Acquire (800, kpTag));
+  cPool.Release (pFirst, kpTag);
+  uint8_t* pThird = static_cast<uint8_t*> (cPool.Acquirez (200, kpTag));
+  ASSERT_TRUE (pThird != NULL);
+  EXPECT_TRUE (pThird != pFirst && pThird != pSecond);
+  EXPECT_EQ (0, pThird[0] | pThird[199]);
+  EXPECT_EQ (pFirst, cPool.Acquire (1000, kpTag));
+  EXPECT_EQ (3u, cPool.GetReusedNum());
+  EXPECT_GT (cPool.GetMemoryUsage(), kuiUsage);
+
+  // only the idle buffers are freed by the trimming
+  cPool.Release (pThird, kpTag);
+  cPool.Trim();
+  EXPECT_EQ (0u, cPool.GetIdleNum());
+  EXPECT_EQ (kuiUsage, cPool.GetMemoryUsage());
+  cPool.Release (pFirst, kpTag);
+  cPool.Release (pSecond, kpTag);
+}
+
+TEST (BufferPoolTest, ManyBuffers) {
+  WelsEnc::CWelsBufferPool cPool;
+  const char* kpTag = "pUnitTestData";
+  void* pBuffers[100];
+  for (int i = 0; i < 100; i++) {
+    pBuffers[i] = cPool.Acquire (64 + i, kpTag);
+    ASSERT_TRUE (pBuffers[i] != NULL);
+  }
+  for (int i = 0; i < 100; i++) {
+    cPool.Release (pBuffers[i], kpTag);
+  }
+  EXPECT_EQ (100u, cPool.GetIdleNum());
+  cPool.Trim();
+  EXPECT_EQ (0u, cPool.GetIdleNum());
+}
+
+TEST (BufferPoolTest, ForeignBufferFreedByCaller) {
+  WelsEnc::CWelsBufferPool cPool;
+  CMemoryAlign cTestMa (16);
+  const char* kpTag = "pUnitTestData";
+  void* pForeign = cTestMa.WelsMalloc (1000, kpTag);
+  ASSERT_TRUE (pForeign != NULL);
+  EXPECT_FALSE (cPool.Release (pForeign, kpTag));
+  EXPECT_EQ (0u, cPool.GetIdleNum());
+
+  // a buffer unknown to the pool is not leaked but freed through the memory allocator of the caller
+  WelsEnc::WelsPoolFree (&cPool, &cTestMa, pForeign, kpTag);
+  EXPECT_EQ (0u, cTestMa.WelsGetMemoryUsage());
+}
+
+TEST (BufferPoolTest, ReusedAcrossResolutionChange) {
+  WelsEnc::CWelsH264SVCEncoder* pEncoder = new WelsEnc::CWelsH264SVCEncoder();
+  SEncParamExt sParam;
+  pEncoder->GetDefaultParams (&sParam);
+  sParam.iPicWidth  = sParam.sSpatialLayers[0].iVideoWidth  = 640;
+  sParam.iPicHeight = sParam.sSpatialLayers[0].iVideoHeight = 480;
+  sParam.iTargetBitrate = sParam.sSpatialLayers[0].iSpatialBitrate = 1000000;
+  ASSERT_EQ (0, pEncoder->InitializeExt (&sParam));
+  const WelsEnc::CWelsBufferPool* kpPool = pEncoder->GetBufferPool();
+  ASSERT_TRUE (kpPool != NULL);
+  EXPECT_EQ (0u, kpPool->GetReusedNum());
+  const uint32_t kuiUsage = kpPool->GetMemoryUsage();
+
+  // the buffers of the larger resolution serve the smaller one and back, no idle buffer is left after each switch
+  uint32_t uiReusedNum = 0;
+  for (int i = 0; i < 2; i++) {
+    sParam.iPicWidth  = sParam.sSpatialLayers[0].iVideoWidth  = i ? 640 : 320;
+    sParam.iPicHeight = sParam.sSpatialLayers[0].iVideoHeight = i ? 480 : 240;
+    ASSERT_EQ (0, pEncoder->SetOption (ENCODER_OPTION_SVC_ENCODE_PARAM_EXT, &sParam));
+    EXPECT_GT (kpPool->GetReusedNum(), uiReusedNum);
+    EXPECT_EQ (0u, kpPool->GetIdleNum());
+    uiReusedNum = kpPool->GetReusedNum();
+  }
+  EXPECT_EQ (kuiUsage, kpPool->GetMemoryUsage());
+
+  // the buffers released are freed, not kept for an initialization that may never come
+  pEncoder->Uninitialize();
+  EXPECT_EQ (0u, kpPool->GetIdleNum());
+  EXPECT_LT (kpPool->GetMemoryUsage(), kuiUsage);
+  delete pEncoder;
+}
+//Tests of CWelsBufferPool End
@@ -313,6 +313,134 @@ TEST (EncMcAvg, PixelAvg) {
   }
 }
 
+static void WeightedPredAnchor (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                int32_t iOffset, int32_t iWidth, int32_t iHeight) {
+  for (int32_t y = 0; y < iHeight; y++) {
+    for (int32_t x = 0; x < iWidth; x++) {
+      if (iLog2Denom >= 1)
+        pDst[x] = Clip255 (((pDst[x] * iWeight + (1 << (iLog2Denom - 1))) >> iLog2Denom) + iOffset);
+      else
+        pDst[x] = Clip255 (pDst[x] * iWeight + iOffset);
+    }
+    pDst += iDstStride;
+  }
+}
+
+TEST (McWeightedPred, WeightedPred) {
+  static const int32_t kiSizes[][2] = {{16, 16}, {16, 8}, {8, 16}, {8, 8}, {8, 4}, {4, 8}, {4, 4}, {4, 2}, {2, 4}, {2, 2}};
+  SMcFunc sMcFunc;
+  for (int32_t k = 0; k < 2; k++) {
+    uint32_t uiCpuFlag = k == 0 ? 0 : WelsCPUFeatureDetect (NULL);
+    InitMcFunc (&sMcFunc, uiCpuFlag);
+    for (int32_t s = 0; s < (int32_t) (sizeof (kiSizes) / sizeof (kiSizes[0])); s++) {
+      for (int32_t n = 0; n < 16; n++) {
+        const int32_t kiWidth = kiSizes[s][0];
+        const int32_t kiHeight = kiSizes[s][1];
+        // extreme weights and offsets first, random ones then
+        const int32_t kiLog2Denom = n < 2 ? 7 * n : rand() % 8;
+        const int32_t kiWeight = n < 2 ? (n ? -128 : 127) : rand() % 256 - 128;
+        const int32_t kiOffset = n < 2 ? (n ? 127 : -128) : rand() % 256 - 128;
+        ENFORCE_STACK_ALIGN_2D (uint8_t, uDstAnchor, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 16);
+        ENFORCE_STACK_ALIGN_2D (uint8_t, uDstTest, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 16);
+        for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+          for (int32_t i = 0; i < MC_BUFF_DST_STRIDE; i++) {
+            uDstAnchor[j][i] = uDstTest[j][i] = (n == 0) ? 255 : rand() % 256;
+          }
+        }
+        WeightedPredAnchor (uDstAnchor[0], MC_BUFF_DST_STRIDE, kiLog2Denom, kiWeight, kiOffset, kiWidth, kiHeight);
+        sMcFunc.pfWeightedPred (uDstTest[0], MC_BUFF_DST_STRIDE, kiLog2Denom, kiWeight, kiOffset, kiWidth, kiHeight);
+        for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+          for (int32_t i = 0; i < MC_BUFF_DST_STRIDE; i++) {
+            ASSERT_EQ (uDstAnchor[j][i], uDstTest[j][i]);
+          }
+        }
+      }
+    }
+  }
+}
+
+#if defined(X86_ASM)
+typedef void (*PWeightedPredWidthFunc) (uint8_t* pDst, int32_t iDstStride, int32_t iLog2Denom, int32_t iWeight,
+                                        int32_t iOffset, int32_t iHeight);
+
+// the x86 kernels are not in the dispatch of InitMcFunc yet, so they are checked directly
+TEST (McWeightedPred, X86Kernels) {
+  static const struct {
+    PWeightedPredWidthFunc pfWeightedPred;
+    uint32_t uiCpuFlag;
+    int32_t iWidth;
+  } kKernels[] = {
+    { WeightedPredWidthEq4_sse2, WELS_CPU_SSE2, 4 },
+    { WeightedPredWidthEq8_sse2, WELS_CPU_SSE2, 8 },
+    { WeightedPredWidthEq16_sse2, WELS_CPU_SSE2, 16 },
+#ifdef HAVE_AVX2
+    { WeightedPredWidthEq16_avx2, WELS_CPU_AVX2, 16 },
+#endif
+  };
+  const uint32_t kuiCpuFlag = WelsCPUFeatureDetect (NULL);
+  for (int32_t k = 0; k < (int32_t) (sizeof (kKernels) / sizeof (kKernels[0])); k++) {
+    if (! (kuiCpuFlag & kKernels[k].uiCpuFlag))
+      continue;
+    for (int32_t iHeight = 2; iHeight <= 16; iHeight += 2) {
+      for (int32_t n = 0; n < 16; n++) {
+        const int32_t kiLog2Denom = n < 2 ? 7 * n : rand() % 8;
+        const int32_t kiWeight = n < 2 ? (n ? -128 : 127) : rand() % 256 - 128;
+        const int32_t kiOffset = n < 2 ? (n ? 127 : -128) : rand() % 256 - 128;
+        ENFORCE_STACK_ALIGN_2D (uint8_t, uDstAnchor, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 32);
+        ENFORCE_STACK_ALIGN_2D (uint8_t, uDstTest, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 32);
+        for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+          for (int32_t i = 0; i < MC_BUFF_DST_STRIDE; i++) {
+            uDstAnchor[j][i] = uDstTest[j][i] = (n == 0) ? 255 : rand() % 256;
+          }
+        }
+        WeightedPredAnchor (uDstAnchor[0], MC_BUFF_DST_STRIDE, kiLog2Denom, kiWeight, kiOffset, kKernels[k].iWidth,
+                            iHeight);
+        kKernels[k].pfWeightedPred (uDstTest[0], MC_BUFF_DST_STRIDE, kiLog2Denom, kiWeight, kiOffset, iHeight);
+        for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+          for (int32_t i = 0; i < MC_BUFF_DST_STRIDE; i++) {
+            ASSERT_EQ (uDstAnchor[j][i], uDstTest[j][i]);
+          }
+        }
+      }
+    }
+  }
+
+#ifdef HAVE_AVX2
+  if (kuiCpuFlag & WELS_CPU_AVX2) {
+    SMcFunc sMcFunc;
+    InitMcFunc (&sMcFunc, 0);
+    for (int32_t iMv = 1; iMv < 64; iMv++) {
+      const int32_t kiDx = iMv & 7, kiDy = iMv >> 3;
+      ENFORCE_STACK_ALIGN_1D (uint8_t, uABCD, 4, 16);
+      uABCD[0] = (8 - kiDx) * (8 - kiDy);
+      uABCD[1] = kiDx * (8 - kiDy);
+      uABCD[2] = (8 - kiDx) * kiDy;
+      uABCD[3] = kiDx * kiDy;
+      ENFORCE_STACK_ALIGN_2D (uint8_t, uSrc, MC_BUFF_HEIGHT, MC_BUFF_SRC_STRIDE, 16);
+      ENFORCE_STACK_ALIGN_2D (uint8_t, uDstAnchor, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 16);
+      ENFORCE_STACK_ALIGN_2D (uint8_t, uDstTest, MC_BUFF_HEIGHT, MC_BUFF_DST_STRIDE, 16);
+      for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+        for (int32_t i = 0; i < MC_BUFF_SRC_STRIDE; i++) {
+          uSrc[j][i] = rand() % 256;
+        }
+      }
+      memset (uDstAnchor, 0, MC_BUFF_HEIGHT * MC_BUFF_DST_STRIDE);
+      memset (uDstTest, 0, MC_BUFF_HEIGHT * MC_BUFF_DST_STRIDE);
+      for (int32_t iHeight = 4; iHeight <= 8; iHeight += 4) {
+        sMcFunc.pMcChromaFunc (uSrc[0], MC_BUFF_SRC_STRIDE, uDstAnchor[0], MC_BUFF_DST_STRIDE, kiDx, kiDy, 8, iHeight);
+        McChromaWidthEq8_avx2 (uSrc[0], MC_BUFF_SRC_STRIDE, uDstTest[0], MC_BUFF_DST_STRIDE, uABCD, iHeight);
+        for (int32_t j = 0; j < MC_BUFF_HEIGHT; j++) {
+          for (int32_t i = 0; i < MC_BUFF_DST_STRIDE; i++) {
+            ASSERT_EQ (uDstAnchor[j][i], uDstTest[j][i]);
+          }
+        }
+      }
+    }
+  }
+#endif
+}
+#endif
+
 #define DEF_HALFPEL_MCTEST(iW, iH, cpu_flags, name_suffix) \
 TEST (EncMcHalfpel, iW##x##iH##_##name_suffix) { \
     SMcFunc sMcFunc; \
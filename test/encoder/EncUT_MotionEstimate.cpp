@@ -438,7 +438,7 @@ class FeatureMotionEstimateTest : public ::testing::Test {
       }
 
       if (m_pFeatureSearchPreparation) {
-        ReleaseFeatureSearchPreparation (m_pMa, m_pFeatureSearchPreparation->pFeatureOfBlock);
+        ReleaseFeatureSearchPreparation (m_pMa, m_pFeatureSearchPreparation);
         m_pMa->WelsFree (m_pFeatureSearchPreparation, "m_pFeatureSearchPreparation");
         m_pFeatureSearchPreparation = NULL;
       }
@@ -529,7 +529,7 @@ TEST_F (FeatureMotionEstimateTest, TestFeatureSearch) {
       sMe.uiSadCost = sMe.uiSatdCost = kiMaxBlock16Sad;
 
       //begin FME process
-      PerformFMEPreprocess (&sFuncList, &sRef, m_pFeatureSearchPreparation->pFeatureOfBlock,
+      PerformFMEPreprocess (&sFuncList, &sRef, m_pFeatureSearchPreparation,
                             m_pScreenBlockFeatureStorage);
       m_pScreenBlockFeatureStorage->uiSadCostThreshold[BLOCK_8x8] = UINT_MAX;//to avoid early skip
       uint32_t uiMaxSearchPoint = INT_MAX;
@@ -563,3 +563,56 @@ TEST_F (FeatureMotionEstimateTest, TestFeatureSearch) {
   }
 }
 
+
+TEST_F (FeatureMotionEstimateTest, TestIncrementalFeatureCalculation) {
+  SWelsFuncPtrList sFuncList;
+  WelsInitSampleSadFunc (&sFuncList, 0); //test c functions
+  WelsInitMeFunc (&sFuncList, WelsCPUFeatureDetect (NULL), true);
+
+  const int32_t kiNeedFeatureStorage = ME_DIA_CROSS_FME;
+  ASSERT_TRUE (ENC_RETURN_SUCCESS == RequestFeatureSearchPreparation (m_pMa, m_iWidth, m_iHeight, kiNeedFeatureStorage,
+               m_pFeatureSearchPreparation));
+  ASSERT_TRUE (ENC_RETURN_SUCCESS == RequestScreenBlockFeatureStorage (m_pMa, m_iWidth, m_iHeight, kiNeedFeatureStorage,
+               m_pScreenBlockFeatureStorage));
+  // calculated from scratch for every reference
+  SFeatureSearchPreparation sFullPreparation;
+  ASSERT_TRUE (ENC_RETURN_SUCCESS == RequestFeatureSearchPreparation (m_pMa, m_iWidth, m_iHeight, kiNeedFeatureStorage,
+               &sFullPreparation));
+  SScreenBlockFeatureStorage sFullStorage;
+  ASSERT_TRUE (ENC_RETURN_SUCCESS == RequestScreenBlockFeatureStorage (m_pMa, m_iWidth, m_iHeight, kiNeedFeatureStorage,
+               &sFullStorage));
+
+  SPicture sRef;
+  InitRefPicForMeTest (&sRef);
+  for (int32_t i = 0; i < m_iWidth * m_iHeight; i++)
+    m_pRefData[i] = rand() & 0x0f;
+  const int32_t kiFeatureSize = (m_iWidth - 8) * (m_iHeight - 8);
+  for (int32_t iFrame = 0; iFrame < 8; iFrame++) {
+    if (iFrame & 1) {
+      // scrolled by a few rows, the scroll is detected on the frame after
+      const int32_t kiShift = 1 + (rand() % 6);
+      memmove (m_pRefData, m_pRefData + kiShift * m_iWidth, (m_iHeight - kiShift) * m_iWidth);
+      m_pFeatureSearchPreparation->iScrollMvY[0] = (iFrame & 2) ? kiShift : -kiShift;
+    } else {
+      m_pFeatureSearchPreparation->iScrollMvY[0] = 0;
+    }
+    // some pixels changed
+    for (int32_t i = rand() % 3; i > 0; i--)
+      m_pRefData[rand() % (m_iWidth * m_iHeight)] = rand() & 0xff;
+
+    PerformFMEPreprocess (&sFuncList, &sRef, m_pFeatureSearchPreparation, m_pScreenBlockFeatureStorage);
+    sFullPreparation.bRefLumaValid = false;
+    PerformFMEPreprocess (&sFuncList, &sRef, &sFullPreparation, &sFullStorage);
+    ASSERT_TRUE (m_pScreenBlockFeatureStorage->bRefBlockFeatureCalculated);
+    ASSERT_EQ (0, memcmp (m_pFeatureSearchPreparation->pFeatureOfBlock, sFullPreparation.pFeatureOfBlock,
+                          kiFeatureSize * sizeof (uint16_t))) << "iFrame = " << iFrame;
+    ASSERT_EQ (0, memcmp (m_pScreenBlockFeatureStorage->pTimesOfFeatureValue, sFullStorage.pTimesOfFeatureValue,
+                          LIST_SIZE_SUM_8x8 * sizeof (uint32_t))) << "iFrame = " << iFrame;
+    ASSERT_EQ (0, memcmp (m_pScreenBlockFeatureStorage->pLocationPointer, sFullStorage.pLocationPointer,
+                          2 * kiFeatureSize * sizeof (uint16_t))) << "iFrame = " << iFrame;
+    m_pFeatureSearchPreparation->iScrollMvY[1] = m_pFeatureSearchPreparation->iScrollMvY[0];
+  }
+
+  ReleaseFeatureSearchPreparation (m_pMa, &sFullPreparation);
+  ReleaseScreenBlockFeatureStorage (m_pMa, &sFullStorage);
+}
@@ -641,6 +641,11 @@ GENERATE_Sad8x8_UT (WelsSampleSatd8x8_avx2, WelsSampleSatd8x8_c, WELS_CPU_AVX2)
 GENERATE_Sad8x16_UT (WelsSampleSatd8x16_avx2, WelsSampleSatd8x16_c, WELS_CPU_AVX2)
 GENERATE_Sad16x8_UT (WelsSampleSatd16x8_avx2, WelsSampleSatd16x8_c, WELS_CPU_AVX2)
 GENERATE_Sad16x16_UT (WelsSampleSatd16x16_avx2, WelsSampleSatd16x16_c, WELS_CPU_AVX2)
+
+GENERATE_Sad8x8_UT (WelsSampleSad8x8_avx2, WelsSampleSad8x8_c, WELS_CPU_AVX2)
+GENERATE_Sad8x16_UT (WelsSampleSad8x16_avx2, WelsSampleSad8x16_c, WELS_CPU_AVX2)
+GENERATE_Sad16x8_UT (WelsSampleSad16x8_avx2, WelsSampleSad16x8_c, WELS_CPU_AVX2)
+GENERATE_Sad16x16_UT (WelsSampleSad16x16_avx2, WelsSampleSad16x16_c, WELS_CPU_AVX2)
 #endif //HAVE_AVX2
 #endif
 
@@ -703,6 +708,35 @@ GENERATE_SadFour_UT (WelsSampleSadFour8x8_sse2, WELS_CPU_SSE2, 8, 8)
 GENERATE_SadFour_UT (WelsSampleSadFour8x16_sse2, WELS_CPU_SSE2, 8, 16)
 GENERATE_SadFour_UT (WelsSampleSadFour16x8_sse2, WELS_CPU_SSE2, 16, 8)
 GENERATE_SadFour_UT (WelsSampleSadFour16x16_sse2, WELS_CPU_SSE2, 16, 16)
+#ifdef HAVE_AVX2
+GENERATE_SadFour_UT (WelsSampleSadFour16x8_avx2, WELS_CPU_AVX2, 16, 8)
+GENERATE_SadFour_UT (WelsSampleSadFour16x16_avx2, WELS_CPU_AVX2, 16, 16)
+#endif //HAVE_AVX2
+#endif
+
+#define GENERATE_SadN_UT(func, ref, CPUFLAGS, height) \
+TEST_F (SadSatdAssemblyFuncTest, func) { \
+  if (0 == (m_uiCpuFeatureFlag & CPUFLAGS)) \
+    return; \
+  for (int i = 0; i < (m_iStrideA << 5); i++) \
+    m_pPixSrcA[i] = rand() % 256; \
+  for (int i = 0; i < (m_iStrideB << 5); i++) \
+    m_pPixSrcB[i] = rand() % 256; \
+  const int32_t kiNum = 32 - height + 1; \
+  int32_t iSad[32]; \
+  func (m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB, 1, 16 - 1, iSad); \
+  for (int i = 0; i < 16 - 1; i++) \
+    EXPECT_EQ (ref (m_pPixSrcA, m_iStrideA, m_pPixSrcB + i, m_iStrideB), iSad[i]); \
+  func (m_pPixSrcA, m_iStrideA, m_pPixSrcB, m_iStrideB, m_iStrideB, kiNum, iSad); \
+  for (int i = 0; i < kiNum; i++) \
+    EXPECT_EQ (ref (m_pPixSrcA, m_iStrideA, m_pPixSrcB + i * m_iStrideB, m_iStrideB), iSad[i]); \
+}
+
+#if defined(X86_ASM) && defined(HAVE_AVX2) && !defined(X86_32_ASM)
+GENERATE_SadN_UT (WelsSampleNSad8x8_avx2, WelsSampleSad8x8_c, WELS_CPU_AVX2, 8)
+GENERATE_SadN_UT (WelsSampleNSad8x16_avx2, WelsSampleSad8x16_c, WELS_CPU_AVX2, 16)
+GENERATE_SadN_UT (WelsSampleNSad16x8_avx2, WelsSampleSad16x8_c, WELS_CPU_AVX2, 8)
+GENERATE_SadN_UT (WelsSampleNSad16x16_avx2, WelsSampleSad16x16_c, WELS_CPU_AVX2, 16)
 #endif
 
 #ifdef HAVE_NEON
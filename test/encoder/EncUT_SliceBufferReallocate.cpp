@@ -7,7 +7,7 @@
 #include "EncUT_SliceBufferReallocate.h"
 
 namespace WelsEnc {
-extern void FreeDqLayer (SDqLayer*& pDq, CMemoryAlign* pMa);
+extern void FreeDqLayer (SDqLayer*& pDq, CMemoryAlign* pMa, CWelsBufferPool* pBufferPool);
 extern void FreeMemorySvc (sWelsEncCtx** ppCtx);
 extern int32_t AcquireLayersNals (sWelsEncCtx** ppCtx,
                                   SWelsSvcCodingParam* pParam,
@@ -60,7 +60,7 @@ int32_t AllocateLayerBuffer (sWelsEncCtx* pCtx, const int32_t iLayerIdx) {
 
   int32_t iRet = InitSliceInLayer (pCtx, pDqLayer, iLayerIdx, pCtx->pMemAlign);
   if (ENC_RETURN_SUCCESS != iRet) {
-    FreeDqLayer (pDqLayer, pCtx->pMemAlign);
+    FreeDqLayer (pDqLayer, pCtx->pMemAlign, pCtx->pBufferPool);
     return ENC_RETURN_MEMALLOCERR;
   }
 
@@ -367,7 +367,7 @@ void CSliceBufferReallocatTest::InitLayerSliceBuffer (const int32_t iLayerIdx) {
 void CSliceBufferReallocatTest::UnInitLayerSliceBuffer (const int32_t iLayerIdx) {
   sWelsEncCtx* pCtx = &m_EncContext;
   if (NULL != pCtx->ppDqLayerList[iLayerIdx]) {
-    FreeDqLayer (pCtx->ppDqLayerList[iLayerIdx], pCtx->pMemAlign);
+    FreeDqLayer (pCtx->ppDqLayerList[iLayerIdx], pCtx->pMemAlign, pCtx->pBufferPool);
     pCtx->ppDqLayerList[iLayerIdx] = NULL;
   }
 }
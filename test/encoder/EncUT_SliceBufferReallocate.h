@@ -21,6 +21,7 @@ class CSliceBufferReallocatTest : public ::testing::Test { //WithParamInterface<
     int32_t iCacheLineSize = 16;
     m_EncContext.pMemAlign = new CMemoryAlign (iCacheLineSize);
     ASSERT_TRUE (NULL != m_EncContext.pMemAlign);
+    m_EncContext.pBufferPool = NULL;
 
     SWelsSvcCodingParam* pCodingParam = (SWelsSvcCodingParam*)m_EncContext.pMemAlign->WelsMalloc (sizeof (
                                           SWelsSvcCodingParam),
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+#include <string.h>
+#include "util.h"
+#include "macros.h"
+#include "memory.h"
+#include "IWelsVP.h"
+
+using namespace WelsVP;
+
+#define VP_TEST_THREAD_NUM 4
+
+// a picture with a stride wider than it, the planes each allocated on their own
+class CVpTestPicture {
+ public:
+  CVpTestPicture (int32_t iWidth, int32_t iHeight) {
+    memset (&m_sPixMap, 0, sizeof (m_sPixMap));
+    for (int32_t i = 0; i < 3; i++) {
+      const int32_t kiShift = i ? 1 : 0;
+      m_sPixMap.iStride[i] = WELS_ALIGN ((iWidth >> kiShift) + 8, 32);
+      m_iSize[i] = m_sPixMap.iStride[i] * (iHeight >> kiShift);
+      m_sPixMap.pPixel[i] = WelsMalloc (m_iSize[i]);
+      memset (m_sPixMap.pPixel[i], 0, m_iSize[i]);
+    }
+    m_sPixMap.iSizeInBits = 8;
+    m_sPixMap.sRect.iRectWidth = iWidth;
+    m_sPixMap.sRect.iRectHeight = iHeight;
+    m_sPixMap.eFormat = VIDEO_FORMAT_I420;
+  }
+  ~CVpTestPicture() {
+    for (int32_t i = 0; i < 3; i++)
+      WelsFree (m_sPixMap.pPixel[i]);
+  }
+
+  // random samples, close to the ones of kpRef on the left half when given
+  void Fill (const CVpTestPicture* kpRef) {
+    for (int32_t i = 0; i < 3; i++) {
+      uint8_t* pPixel = (uint8_t*)m_sPixMap.pPixel[i];
+      const uint8_t* kpRefPixel = kpRef ? (const uint8_t*)kpRef->m_sPixMap.pPixel[i] : NULL;
+      for (int32_t j = 0; j < m_iSize[i]; j++) {
+        if (kpRefPixel && (j % m_sPixMap.iStride[i]) < (m_sPixMap.iStride[i] >> 1))
+          pPixel[j] = WELS_CLIP3 (kpRefPixel[j] + rand() % 5 - 2, 0, 255);
+        else
+          pPixel[j] = rand() % 256;
+      }
+    }
+  }
+  void CopyFrom (const CVpTestPicture* kpSrc) {
+    for (int32_t i = 0; i < 3; i++)
+      memcpy (m_sPixMap.pPixel[i], kpSrc->m_sPixMap.pPixel[i], m_iSize[i]);
+  }
+  bool Equals (const CVpTestPicture* kpOther) const {
+    for (int32_t i = 0; i < 3; i++) {
+      if (memcmp (m_sPixMap.pPixel[i], kpOther->m_sPixMap.pPixel[i], m_iSize[i]))
+        return false;
+    }
+    return true;
+  }
+
+  SPixMap m_sPixMap;
+  int32_t m_iSize[3];
+};
+
+// the results of VAA for a picture of up to kiMbNum MBs
+class CVpTestVaaResult {
+ public:
+  CVpTestVaaResult (int32_t iMbNum) {
+    m_iMbNum = iMbNum;
+    memset (&m_sResult, 0, sizeof (m_sResult));
+    m_sResult.pSad8x8 = (int32_t (*)[4])WelsMalloc (iMbNum * 4 * sizeof (int32_t));
+    m_sResult.pSsd16x16 = (int32_t*)WelsMalloc (iMbNum * sizeof (int32_t));
+    m_sResult.pSum16x16 = (int32_t*)WelsMalloc (iMbNum * sizeof (int32_t));
+    m_sResult.pSumOfSquare16x16 = (int32_t*)WelsMalloc (iMbNum * sizeof (int32_t));
+    m_sResult.pSumOfDiff8x8 = (int32_t (*)[4])WelsMalloc (iMbNum * 4 * sizeof (int32_t));
+    m_sResult.pMad8x8 = (uint8_t (*)[4])WelsMalloc (iMbNum * 4 * sizeof (uint8_t));
+  }
+  ~CVpTestVaaResult() {
+    WelsFree (m_sResult.pSad8x8);
+    WelsFree (m_sResult.pSsd16x16);
+    WelsFree (m_sResult.pSum16x16);
+    WelsFree (m_sResult.pSumOfSquare16x16);
+    WelsFree (m_sResult.pSumOfDiff8x8);
+    WelsFree (m_sResult.pMad8x8);
+  }
+  bool Equals (const CVpTestVaaResult* kpOther) const {
+    const SVAACalcResult* kpRes = &kpOther->m_sResult;
+    return m_sResult.iFrameSad == kpRes->iFrameSad
+           && !memcmp (m_sResult.pSad8x8, kpRes->pSad8x8, m_iMbNum * 4 * sizeof (int32_t))
+           && !memcmp (m_sResult.pSsd16x16, kpRes->pSsd16x16, m_iMbNum * sizeof (int32_t))
+           && !memcmp (m_sResult.pSum16x16, kpRes->pSum16x16, m_iMbNum * sizeof (int32_t))
+           && !memcmp (m_sResult.pSumOfSquare16x16, kpRes->pSumOfSquare16x16, m_iMbNum * sizeof (int32_t))
+           && !memcmp (m_sResult.pSumOfDiff8x8, kpRes->pSumOfDiff8x8, m_iMbNum * 4 * sizeof (int32_t))
+           && !memcmp (m_sResult.pMad8x8, kpRes->pMad8x8, m_iMbNum * 4 * sizeof (uint8_t));
+  }
+
+  SVAACalcResult m_sResult;
+  int32_t m_iMbNum;
+};
+
+// the same processing on one thread and on VP_TEST_THREAD_NUM threads
+class VpThreadingTest : public ::testing::Test {
+ public:
+  virtual void SetUp() {
+    m_pVp[0] = m_pVp[1] = NULL;
+    ASSERT_EQ (RET_SUCCESS, WelsCreateVpInterface ((void**)&m_pVp[0], WELSVP_INTERFACE_VERION));
+    ASSERT_EQ (RET_SUCCESS, WelsCreateVpInterface ((void**)&m_pVp[1], WELSVP_INTERFACE_VERION));
+    SVpThreadingParam sThreading;
+    sThreading.iThreadNum = VP_TEST_THREAD_NUM;
+    sThreading.pThreadPoolParam = NULL;
+    ASSERT_EQ (RET_SUCCESS, m_pVp[1]->SpecialFeature (VP_FEATURE_THREADING, &sThreading, NULL));
+  }
+  virtual void TearDown() {
+    for (int32_t i = 0; i < 2; i++) {
+      if (m_pVp[i])
+        WelsDestroyVpInterface (m_pVp[i], WELSVP_INTERFACE_VERION);
+    }
+  }
+
+  void TestDownsample (int32_t iSrcWidth, int32_t iSrcHeight, int32_t iDstWidth, int32_t iDstHeight) {
+    CVpTestPicture cSrc (iSrcWidth, iSrcHeight);
+    CVpTestPicture cDst0 (iDstWidth, iDstHeight);
+    CVpTestPicture cDst1 (iDstWidth, iDstHeight);
+    cSrc.Fill (NULL);
+    ASSERT_EQ (RET_SUCCESS, m_pVp[0]->Process (METHOD_DOWNSAMPLE, &cSrc.m_sPixMap, &cDst0.m_sPixMap));
+    ASSERT_EQ (RET_SUCCESS, m_pVp[1]->Process (METHOD_DOWNSAMPLE, &cSrc.m_sPixMap, &cDst1.m_sPixMap));
+    EXPECT_TRUE (cDst0.Equals (&cDst1)) << iSrcWidth << "x" << iSrcHeight << " to " << iDstWidth << "x" << iDstHeight;
+  }
+
+  void TestVaa (int32_t iWidth, int32_t iHeight, int32_t iCalcVar, int32_t iCalcBgd, int32_t iCalcSsd) {
+    const int32_t kiMbNum = (iWidth >> 4) * (iHeight >> 4);
+    CVpTestPicture cCur (iWidth, iHeight);
+    CVpTestPicture cRef (iWidth, iHeight);
+    CVpTestVaaResult cResult0 (kiMbNum);
+    CVpTestVaaResult cResult1 (kiMbNum);
+    cRef.Fill (NULL);
+    cCur.Fill (&cRef);
+    RunVaa (&cCur, &cRef, &cResult0, &cResult1, iCalcVar, iCalcBgd, iCalcSsd);
+    EXPECT_TRUE (cResult0.Equals (&cResult1)) << iWidth << "x" << iHeight << " var " << iCalcVar << " bgd " << iCalcBgd
+        << " ssd " << iCalcSsd;
+  }
+
+  void RunVaa (CVpTestPicture* pCur, CVpTestPicture* pRef, CVpTestVaaResult* pResult0, CVpTestVaaResult* pResult1,
+               int32_t iCalcVar, int32_t iCalcBgd, int32_t iCalcSsd) {
+    CVpTestVaaResult* pResult[2] = {pResult0, pResult1};
+    for (int32_t i = 0; i < 2; i++) {
+      SVAACalcParam sParam;
+      memset (&sParam, 0, sizeof (sParam));
+      sParam.iCalcVar = iCalcVar;
+      sParam.iCalcBgd = iCalcBgd;
+      sParam.iCalcSsd = iCalcSsd;
+      sParam.pCalcResult = &pResult[i]->m_sResult;
+      ASSERT_EQ (RET_SUCCESS, m_pVp[i]->Set (METHOD_VAA_STATISTICS, &sParam));
+      ASSERT_EQ (RET_SUCCESS, m_pVp[i]->Process (METHOD_VAA_STATISTICS, &pCur->m_sPixMap, &pRef->m_sPixMap));
+    }
+  }
+
+  IWelsVP* m_pVp[2];
+};
+
+TEST_F (VpThreadingTest, Downsample) {
+  // the dyadic and one third downsamplers on the source directly
+  TestDownsample (3872, 1088, 1936, 544);
+  TestDownsample (3872, 1088, 968, 272);
+  TestDownsample (3872, 1088, 1290, 362);
+  TestDownsample (3872, 1088, 1000, 500);
+  // the halving stages through the sample buffers
+  TestDownsample (1280, 720, 640, 360);
+  TestDownsample (1280, 720, 320, 180);
+  TestDownsample (1280, 720, 500, 300);
+  TestDownsample (1278, 718, 638, 358);
+}
+
+TEST_F (VpThreadingTest, Denoise) {
+  const int32_t kiSize[][2] = {{1280, 720}, {352, 288}, {174, 98}};
+  for (uint32_t i = 0; i < sizeof (kiSize) / sizeof (kiSize[0]); i++) {
+    CVpTestPicture cPic0 (kiSize[i][0], kiSize[i][1]);
+    CVpTestPicture cPic1 (kiSize[i][0], kiSize[i][1]);
+    cPic0.Fill (NULL);
+    cPic1.CopyFrom (&cPic0);
+    ASSERT_EQ (RET_SUCCESS, m_pVp[0]->Process (METHOD_DENOISE, &cPic0.m_sPixMap, NULL));
+    ASSERT_EQ (RET_SUCCESS, m_pVp[1]->Process (METHOD_DENOISE, &cPic1.m_sPixMap, NULL));
+    EXPECT_TRUE (cPic0.Equals (&cPic1)) << kiSize[i][0] << "x" << kiSize[i][1];
+  }
+}
+
+TEST_F (VpThreadingTest, VaaCalculation) {
+  for (int32_t i = 0; i < 4; i++) {
+    TestVaa (1280, 720, i & 1, 0, i >> 1);
+    TestVaa (1280, 720, 0, 1, i >> 1);
+    TestVaa (352, 296, i & 1, 0, i >> 1);
+  }
+}
+
+TEST_F (VpThreadingTest, BackgroundDetectionAndAdaptiveQuantization) {
+  const int32_t kiWidth = 1280, kiHeight = 720;
+  const int32_t kiMbNum = (kiWidth >> 4) * (kiHeight >> 4);
+  CVpTestPicture cCur (kiWidth, kiHeight);
+  CVpTestPicture cRef (kiWidth, kiHeight);
+  CVpTestVaaResult cResult0 (kiMbNum);
+  CVpTestVaaResult cResult1 (kiMbNum);
+  CVpTestVaaResult* pResult[2] = {&cResult0, &cResult1};
+  int8_t* pBackgroundMbFlag[2];
+  int8_t* pDeltaQp[2];
+  SMotionTextureUnit* pMotionTexture[2];
+  SAdaptiveQuantizationParam sAqParam[2];
+
+  cRef.Fill (NULL);
+  cCur.Fill (&cRef);
+  RunVaa (&cCur, &cRef, &cResult0, &cResult1, 0, 1, 1);
+  for (int32_t i = 0; i < 2; i++) {
+    pBackgroundMbFlag[i] = (int8_t*)WelsMalloc (kiMbNum);
+    pDeltaQp[i] = (int8_t*)WelsMalloc (kiMbNum);
+    pMotionTexture[i] = (SMotionTextureUnit*)WelsMalloc (kiMbNum * sizeof (SMotionTextureUnit));
+    memset (pBackgroundMbFlag[i], 0, kiMbNum);
+
+    SBGDInterface sBgd;
+    sBgd.pBackgroundMbFlag = pBackgroundMbFlag[i];
+    sBgd.pCalcRes = &pResult[i]->m_sResult;
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Set (METHOD_BACKGROUND_DETECTION, &sBgd));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Process (METHOD_BACKGROUND_DETECTION, &cCur.m_sPixMap, &cRef.m_sPixMap));
+
+    memset (&sAqParam[i], 0, sizeof (sAqParam[i]));
+    sAqParam[i].iAdaptiveQuantMode = AQ_BITRATE_MODE;
+    sAqParam[i].pCalcResult = &pResult[i]->m_sResult;
+    sAqParam[i].pMotionTextureUnit = pMotionTexture[i];
+    sAqParam[i].pMotionTextureIndexToDeltaQp = pDeltaQp[i];
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Set (METHOD_ADAPTIVE_QUANT, &sAqParam[i]));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Process (METHOD_ADAPTIVE_QUANT, &cCur.m_sPixMap, &cRef.m_sPixMap));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Get (METHOD_ADAPTIVE_QUANT, &sAqParam[i]));
+  }
+  EXPECT_EQ (0, memcmp (pBackgroundMbFlag[0], pBackgroundMbFlag[1], kiMbNum));
+  EXPECT_EQ (0, memcmp (pMotionTexture[0], pMotionTexture[1], kiMbNum * sizeof (SMotionTextureUnit)));
+  EXPECT_EQ (0, memcmp (pDeltaQp[0], pDeltaQp[1], kiMbNum));
+  EXPECT_EQ (sAqParam[0].iAverMotionTextureIndexToDeltaQp, sAqParam[1].iAverMotionTextureIndexToDeltaQp);
+
+  for (int32_t i = 0; i < 2; i++) {
+    WelsFree (pBackgroundMbFlag[i]);
+    WelsFree (pDeltaQp[i]);
+    WelsFree (pMotionTexture[i]);
+  }
+}
+
+TEST_F (VpThreadingTest, AdaptiveQuantizationFromVaa) {
+  // the motion and texture index from the pictures on one thread, from the VAA statistics of the bands on threads
+  const int32_t kiWidth = 1280, kiHeight = 720;
+  const int32_t kiMbNum = (kiWidth >> 4) * (kiHeight >> 4);
+  CVpTestPicture cCur (kiWidth, kiHeight);
+  CVpTestPicture cRef (kiWidth, kiHeight);
+  CVpTestVaaResult cResult0 (kiMbNum);
+  CVpTestVaaResult cResult1 (kiMbNum);
+  CVpTestVaaResult* pResult[2] = {&cResult0, &cResult1};
+  int8_t* pDeltaQp[2];
+  SMotionTextureUnit* pMotionTexture[2];
+  SAdaptiveQuantizationParam sAqParam[2];
+
+  cRef.Fill (NULL);
+  cCur.Fill (&cRef);
+  for (int32_t i = 0; i < 2; i++) {
+    pDeltaQp[i] = (int8_t*)WelsMalloc (kiMbNum);
+    pMotionTexture[i] = (SMotionTextureUnit*)WelsMalloc (kiMbNum * sizeof (SMotionTextureUnit));
+
+    SVAACalcParam sParam;
+    memset (&sParam, 0, sizeof (sParam));
+    sParam.iCalcBgd = 1;
+    sParam.iCalcSsd = 1;
+    sParam.pCalcResult = &pResult[i]->m_sResult;
+    sParam.pMotionTextureUnit = i ? pMotionTexture[i] : NULL;
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Set (METHOD_VAA_STATISTICS, &sParam));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Process (METHOD_VAA_STATISTICS, &cCur.m_sPixMap, &cRef.m_sPixMap));
+    EXPECT_TRUE (pResult[i]->m_sResult.pMotionTextureUnit == sParam.pMotionTextureUnit);
+
+    memset (&sAqParam[i], 0, sizeof (sAqParam[i]));
+    sAqParam[i].iAdaptiveQuantMode = AQ_QUALITY_MODE;
+    sAqParam[i].pCalcResult = &pResult[i]->m_sResult;
+    sAqParam[i].pMotionTextureUnit = pMotionTexture[i];
+    sAqParam[i].pMotionTextureIndexToDeltaQp = pDeltaQp[i];
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Set (METHOD_ADAPTIVE_QUANT, &sAqParam[i]));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Process (METHOD_ADAPTIVE_QUANT, &cCur.m_sPixMap, &cRef.m_sPixMap));
+    EXPECT_EQ (RET_SUCCESS, m_pVp[i]->Get (METHOD_ADAPTIVE_QUANT, &sAqParam[i]));
+  }
+  EXPECT_TRUE (cResult0.Equals (&cResult1));
+  EXPECT_EQ (0, memcmp (pMotionTexture[0], pMotionTexture[1], kiMbNum * sizeof (SMotionTextureUnit)));
+  EXPECT_EQ (0, memcmp (pDeltaQp[0], pDeltaQp[1], kiMbNum));
+  EXPECT_EQ (sAqParam[0].iAverMotionTextureIndexToDeltaQp, sAqParam[1].iAverMotionTextureIndexToDeltaQp);
+
+  for (int32_t i = 0; i < 2; i++) {
+    WelsFree (pDeltaQp[i]);
+    WelsFree (pMotionTexture[i]);
+  }
+}
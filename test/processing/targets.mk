@@ -3,6 +3,7 @@ PROCESSING_UNITTEST_CPP_SRCS=\
 	$(PROCESSING_UNITTEST_SRCDIR)/ProcessUT_AdaptiveQuantization.cpp\
 	$(PROCESSING_UNITTEST_SRCDIR)/ProcessUT_DownSample.cpp\
 	$(PROCESSING_UNITTEST_SRCDIR)/ProcessUT_ScrollDetection.cpp\
+	$(PROCESSING_UNITTEST_SRCDIR)/ProcessUT_Threading.cpp\
 	$(PROCESSING_UNITTEST_SRCDIR)/ProcessUT_VaaCalc.cpp\
 
 PROCESSING_UNITTEST_OBJS += $(PROCESSING_UNITTEST_CPP_SRCS:.cpp=.$(OBJ))